@@ -0,0 +1,159 @@
+#pragma once
+
+#include <ichor/DependencyManager.h>
+#include <ichor/services/logging/Logger.h>
+#include <ichor/services/network/IBroadcastService.h>
+#include <ichor/services/network/IConnectionService.h>
+#include <ichor/services/network/IHostService.h>
+#include <ichor/services/network/tcp/IOUringTcpConnectionService.h>
+#include <ichor/services/network/tcp/IOUringTcpHostService.h>
+#include <ichor/dependency_management/AdvancedService.h>
+#include <ichor/dependency_management/DependencyRegister.h>
+#include <ichor/events/RunFunctionEvent.h>
+#include <ichor/ScopedServiceProxy.h>
+#include <chrono>
+
+using namespace Ichor;
+using namespace Ichor::v1;
+
+// clients connect in waves, so the listen backlog doesn't overflow
+constexpr uint64_t CONNECT_WAVE_SIZE = 500;
+
+inline std::chrono::steady_clock::time_point broadcastStart{};
+inline std::chrono::steady_clock::time_point broadcastEnd{};
+
+// Connects "Connections" clients to a host and sends "Messages" messages of "MessageSize" bytes to all of them, either with one broadcast per message or, with "Naive", with a copy and a coroutine per connection.
+// Quits once every client received every message.
+class TestService final : public AdvancedService<TestService> {
+public:
+    TestService(DependencyRegister &reg, Properties props) : AdvancedService(std::move(props)) {
+        reg.registerDependency<ILogger>(this, DependencyFlags::REQUIRED);
+        reg.registerDependency<IBroadcastService>(this, DependencyFlags::NONE);
+        reg.registerDependency<IConnectionService>(this, DependencyFlags::ALLOW_MULTIPLE);
+    }
+    ~TestService() final = default;
+
+private:
+    Task<tl::expected<void, Ichor::StartError>> start() final {
+        auto const &props = getProperties();
+        _connections = Ichor::v1::any_cast<uint64_t>(props.find("Connections")->second);
+        _messages = Ichor::v1::any_cast<uint64_t>(props.find("Messages")->second);
+        _messageSize = Ichor::v1::any_cast<uint64_t>(props.find("MessageSize")->second);
+        _naive = Ichor::v1::any_cast<bool>(props.find("Naive")->second);
+        _port = Ichor::v1::any_cast<uint16_t>(props.find("Port")->second);
+
+        GetThreadLocalManager().createServiceManager<IOUringTcpHostService, IHostService, IBroadcastService>(Properties{
+            {"Address", Ichor::v1::make_any<std::string>("127.0.0.1")},
+            {"Port", Ichor::v1::make_any<uint16_t>(_port)},
+            {"ListenBacklogSize", Ichor::v1::make_any<uint16_t>(static_cast<uint16_t>(CONNECT_WAVE_SIZE))},
+            // host side connections don't receive anything
+            {"BufferEntries", Ichor::v1::make_any<uint32_t>(2u)},
+            {"BufferEntrySize", Ichor::v1::make_any<uint32_t>(1024u)}});
+
+        co_return {};
+    }
+
+    Task<void> stop() final {
+        _hostConnections.clear();
+        co_return;
+    }
+
+    void addDependencyInstance(Ichor::ScopedServiceProxy<ILogger*> logger, IService &) {
+        _logger = std::move(logger);
+    }
+
+    void removeDependencyInstance(Ichor::ScopedServiceProxy<ILogger*>, IService&) {
+        _logger.reset();
+    }
+
+    void addDependencyInstance(Ichor::ScopedServiceProxy<IBroadcastService*> host, IService&) {
+        _host = std::move(host);
+        connectNextWave();
+    }
+
+    void removeDependencyInstance(Ichor::ScopedServiceProxy<IBroadcastService*>, IService&) {
+        _host.reset();
+    }
+
+    void addDependencyInstance(Ichor::ScopedServiceProxy<IConnectionService*> connection, IService&) {
+        if(connection->isClient()) {
+            connection->setReceiveHandler([this](std::span<uint8_t const> data) {
+                _received += data.size();
+                if(_received == _connections * _messages * _messageSize) {
+                    broadcastEnd = std::chrono::steady_clock::now();
+                    GetThreadLocalEventQueue().pushEvent<QuitEvent>(getServiceId());
+                }
+            });
+            return;
+        }
+
+        _hostConnections.emplace_back(std::move(connection));
+
+        if(_hostConnections.size() != _created) {
+            return;
+        }
+
+        if(_created < _connections) {
+            connectNextWave();
+            return;
+        }
+
+        GetThreadLocalEventQueue().pushEvent<RunFunctionEventAsync>(getServiceId(), [this]() -> AsyncGenerator<IchorBehaviour> {
+            auto msg = std::make_shared<std::vector<uint8_t> const>(_messageSize, static_cast<uint8_t>('a'));
+            broadcastStart = std::chrono::steady_clock::now();
+
+            for(uint64_t i = 0; i < _messages; i++) {
+                if(_naive) {
+                    for(auto &conn : _hostConnections) {
+                        GetThreadLocalEventQueue().pushEvent<RunFunctionEventAsync>(getServiceId(), [conn, msg]() -> AsyncGenerator<IchorBehaviour> {
+                            co_await conn->sendAsync(std::vector<uint8_t>(*msg));
+                            co_return {};
+                        });
+                    }
+                    continue;
+                }
+
+                if(_host == nullptr) {
+                    break;
+                }
+
+                auto ret = co_await _host->broadcastAsync(msg);
+                if(!ret || *ret != _connections) {
+                    ICHOR_LOG_ERROR(_logger, "broadcast failed");
+                    GetThreadLocalEventQueue().pushEvent<QuitEvent>(getServiceId());
+                    break;
+                }
+            }
+            co_return {};
+        });
+    }
+
+    void removeDependencyInstance(Ichor::ScopedServiceProxy<IConnectionService*>, IService&) {
+    }
+
+    void connectNextWave() {
+        auto wave = std::min(CONNECT_WAVE_SIZE, _connections - _created);
+
+        for(uint64_t i = 0; i < wave; i++) {
+            GetThreadLocalManager().createServiceManager<IOUringTcpConnectionService<IClientConnectionService>, IConnectionService, IClientConnectionService>(Properties{
+                {"Address", Ichor::v1::make_any<std::string>("127.0.0.1")},
+                {"Port", Ichor::v1::make_any<uint16_t>(_port)},
+                {"BufferEntries", Ichor::v1::make_any<uint32_t>(4u)},
+                {"BufferEntrySize", Ichor::v1::make_any<uint32_t>(4096u)}});
+        }
+        _created += wave;
+    }
+
+    friend DependencyRegister;
+
+    Ichor::ScopedServiceProxy<ILogger*> _logger {};
+    Ichor::ScopedServiceProxy<IBroadcastService*> _host {};
+    std::vector<Ichor::ScopedServiceProxy<IConnectionService*>> _hostConnections{};
+    uint64_t _connections{};
+    uint64_t _messages{};
+    uint64_t _messageSize{};
+    uint64_t _created{};
+    uint64_t _received{};
+    uint16_t _port{};
+    bool _naive{};
+};
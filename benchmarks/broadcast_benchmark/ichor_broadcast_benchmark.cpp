@@ -0,0 +1,90 @@
+#if defined(ICHOR_USE_LIBURING)
+
+#include "TestService.h"
+#include <ichor/event_queues/IOUringQueue.h>
+#include <ichor/services/logging/LoggerFactory.h>
+#include <ichor/services/logging/NullFrameworkLogger.h>
+#include <ichor/services/logging/NullLogger.h>
+#include <ichor/services/metrics/MemoryUsageFunctions.h>
+#include <ichor/ichor-mimalloc.h>
+#include <sys/resource.h>
+#include <iostream>
+#include "../../examples/common/lyra.hpp"
+
+int main(int argc, char *argv[]) {
+#if ICHOR_EXCEPTIONS_ENABLED
+    try {
+#endif
+        std::locale::global(std::locale("en_US.UTF-8"));
+#if ICHOR_EXCEPTIONS_ENABLED
+    } catch(std::runtime_error const &e) {
+        fmt::println("Couldn't set locale to en_US.UTF-8: {}", e.what());
+    }
+#endif
+
+    bool showHelp{};
+    uint64_t connections{10'000};
+    uint64_t messages{100};
+    uint64_t messageSize{128};
+
+    auto cli = lyra::help(showHelp)
+               | lyra::opt(connections, "connections")["-c"]["--connections"]("Amount of clients to send to")
+               | lyra::opt(messages, "messages")["-m"]["--messages"]("Amount of messages to send to every client")
+               | lyra::opt(messageSize, "size")["-s"]["--size"]("Size of every message in bytes");
+
+    auto result = cli.parse( { argc, argv } );
+    if (!result) {
+        fmt::print("Error in command line: {}\n", result.message());
+        return 1;
+    }
+
+    if (showHelp) {
+        std::cout << cli << "\n";
+        return 0;
+    }
+
+    // both ends of every connection live in this process
+    rlimit limit{};
+    if(getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+        if(limit.rlim_cur != RLIM_INFINITY && connections * 2 + 64 > limit.rlim_cur) {
+            connections = (limit.rlim_cur - 64) / 2;
+            fmt::println("open file limit too low, reduced connections to {}", connections);
+        }
+    }
+
+    for(bool naive : {false, true}) {
+        auto start = std::chrono::steady_clock::now();
+        auto queue = std::make_unique<IOUringQueue>();
+        if(!queue->createEventLoop(4096)) {
+            fmt::println("Couldn't create io_uring event loop");
+            return -1;
+        }
+        auto &dm = queue->createManager();
+        dm.createServiceManager<LoggerFactory<NullLogger>, ILoggerFactory>();
+        dm.createServiceManager<NullFrameworkLogger, IFrameworkLogger>();
+        dm.createServiceManager<TestService>(Properties{
+            {"Connections", Ichor::v1::make_any<uint64_t>(connections)},
+            {"Messages", Ichor::v1::make_any<uint64_t>(messages)},
+            {"MessageSize", Ichor::v1::make_any<uint64_t>(messageSize)},
+            {"Naive", Ichor::v1::make_any<bool>(naive)},
+            {"Port", Ichor::v1::make_any<uint16_t>(static_cast<uint16_t>(naive ? 8445 : 8446))}});
+        queue->start(CaptureSigInt);
+        auto end = std::chrono::steady_clock::now();
+        auto sendUs = std::chrono::duration_cast<std::chrono::microseconds>(broadcastEnd - broadcastStart).count();
+        fmt::println("{} {} to {:L} connections ran for {:L} µs with {:L} peak memory usage, sending took {:L} µs, {:L} messages/s", argv[0], naive ? "copy per connection" : "broadcast", connections,
+                     std::chrono::duration_cast<std::chrono::microseconds>(end - start).count(), getPeakRSS(), sendUs,
+                     std::floor(1'000'000. / static_cast<double>(sendUs) * static_cast<double>(connections * messages)));
+    }
+
+    return 0;
+}
+
+#else
+
+int main() {
+    return 0;
+}
+
+#endif
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <ichor/services/logging/Logger.h>
+#include <ichor/services/io/IAsyncFileIO.h>
+#include <ichor/dependency_management/AdvancedService.h>
+#include <ichor/dependency_management/DependencyRegister.h>
+#include <ichor/event_queues/IEventQueue.h>
+#include <ichor/events/RunFunctionEvent.h>
+#include <ichor/ScopedServiceProxy.h>
+#include <atomic>
+#include <random>
+
+#if defined(ICHOR_ENABLE_INTERNAL_DEBUGGING) || (defined(ICHOR_BUILDING_DEBUG) && (defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)))
+constexpr uint32_t READ_COUNT = 1'000;
+#elif defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+constexpr uint32_t READ_COUNT = 20'000;
+#else
+constexpr uint32_t READ_COUNT = 200'000;
+#endif
+constexpr uint32_t FILE_COUNT = 1'024;
+constexpr uint32_t FILE_SIZE = 4'096;
+
+using namespace Ichor;
+using namespace Ichor::v1;
+
+// summed over all threads
+inline std::atomic<uint64_t> failedReads{};
+
+// Keeps "InFlight" reads of randomly picked files going until READ_COUNT reads completed, then quits.
+class TestService final : public AdvancedService<TestService> {
+public:
+    TestService(DependencyRegister &reg, Properties props) : AdvancedService(std::move(props)) {
+        reg.registerDependency<ILogger>(this, DependencyFlags::REQUIRED);
+        reg.registerDependency<IEventQueue>(this, DependencyFlags::REQUIRED);
+        reg.registerDependency<IAsyncFileIO>(this, DependencyFlags::REQUIRED);
+        if(auto propIt = getProperties().find("InFlight"); propIt != getProperties().end()) {
+            _inFlight = Ichor::v1::any_cast<uint32_t>(propIt->second);
+        }
+        if(auto propIt = getProperties().find("Directory"); propIt != getProperties().end()) {
+            _directory = Ichor::v1::any_cast<std::string>(propIt->second);
+        }
+    }
+    ~TestService() final = default;
+
+private:
+    Task<tl::expected<void, Ichor::StartError>> start() final {
+        for(uint32_t i = 0; i < _inFlight; i++) {
+            _q->pushEvent<RunFunctionEventAsync>(getServiceId(), [this, seed = i]() -> AsyncGenerator<IchorBehaviour> {
+                std::minstd_rand rng{seed};
+                std::uniform_int_distribution<uint32_t> dist{0, FILE_COUNT - 1};
+                while(_started < READ_COUNT) {
+                    _started++;
+                    auto ret = co_await _io->readWholeFile(_directory / fmt::format("{}.bin", dist(rng)));
+                    if(!ret || ret->size() != FILE_SIZE) {
+                        failedReads.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    if(++_finished == READ_COUNT) {
+                        _q->pushEvent<QuitEvent>(getServiceId());
+                    }
+                }
+                co_return {};
+            });
+        }
+        co_return {};
+    }
+
+    Task<void> stop() final {
+        co_return;
+    }
+
+    void addDependencyInstance(Ichor::ScopedServiceProxy<ILogger*> logger, IService &) {
+        _logger = std::move(logger);
+    }
+
+    void removeDependencyInstance(Ichor::ScopedServiceProxy<ILogger*>, IService&) {
+        _logger.reset();
+    }
+
+    void addDependencyInstance(Ichor::ScopedServiceProxy<IEventQueue*> q, IService&) {
+        _q = std::move(q);
+    }
+
+    void removeDependencyInstance(Ichor::ScopedServiceProxy<IEventQueue*>, IService&) {
+        _q.reset();
+    }
+
+    void addDependencyInstance(Ichor::ScopedServiceProxy<IAsyncFileIO*> io, IService&) {
+        _io = std::move(io);
+    }
+
+    void removeDependencyInstance(Ichor::ScopedServiceProxy<IAsyncFileIO*>, IService&) {
+        _io.reset();
+    }
+
+    friend DependencyRegister;
+
+    Ichor::ScopedServiceProxy<ILogger*> _logger {};
+    Ichor::ScopedServiceProxy<IEventQueue*> _q {};
+    Ichor::ScopedServiceProxy<IAsyncFileIO*> _io {};
+    uint32_t _inFlight{64};
+    uint32_t _started{};
+    uint32_t _finished{};
+    std::filesystem::path _directory{};
+};
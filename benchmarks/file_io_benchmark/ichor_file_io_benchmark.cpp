@@ -0,0 +1,126 @@
+#include "TestService.h"
+#include <ichor/event_queues/PriorityQueue.h>
+#include <ichor/services/io/SharedOverThreadsAsyncFileIO.h>
+#ifdef ICHOR_USE_LIBURING
+#include <ichor/event_queues/IOUringQueue.h>
+#include <ichor/services/io/IOUringAsyncFileIO.h>
+#endif
+#include <ichor/services/logging/LoggerFactory.h>
+#include <ichor/services/logging/NullFrameworkLogger.h>
+#include <ichor/services/logging/NullLogger.h>
+#include <ichor/services/metrics/MemoryUsageFunctions.h>
+#include <ichor/ichor-mimalloc.h>
+#include <iostream>
+#include <fstream>
+#include <thread>
+#include <array>
+#include "../../examples/common/lyra.hpp"
+
+namespace {
+    void runQueue(bool liburing, uint32_t workers, uint32_t inFlight, std::string const &directory) {
+        std::unique_ptr<IEventQueue> queue;
+        if(liburing) {
+#ifdef ICHOR_USE_LIBURING
+            auto q = std::make_unique<IOUringQueue>(10, 10'000);
+            if(!q->createEventLoop()) {
+                fmt::println("Couldn't create event loop.");
+                std::terminate();
+            }
+            queue = std::move(q);
+#endif
+        } else {
+            queue = std::make_unique<PriorityQueue>();
+        }
+        auto &dm = queue->createManager();
+        dm.createServiceManager<LoggerFactory<NullLogger>, ILoggerFactory>();
+        dm.createServiceManager<NullFrameworkLogger, IFrameworkLogger>();
+        if(liburing) {
+#ifdef ICHOR_USE_LIBURING
+            dm.createServiceManager<IOUringAsyncFileIO, IAsyncFileIO>();
+#endif
+        } else {
+            dm.createServiceManager<SharedOverThreadsAsyncFileIO, IAsyncFileIO>(Properties{{"WorkerThreads", Ichor::v1::make_any<uint32_t>(workers)}});
+        }
+        dm.createServiceManager<TestService>(Properties{{"LogLevel", Ichor::v1::make_any<LogLevel>(LogLevel::LOG_WARN)},
+                                                        {"InFlight", Ichor::v1::make_any<uint32_t>(inFlight)},
+                                                        {"Directory", Ichor::v1::make_any<std::string>(directory)}});
+        queue->start(CaptureSigInt);
+    }
+}
+
+int main(int argc, char *argv[]) {
+#if ICHOR_EXCEPTIONS_ENABLED
+    try {
+#endif
+        std::locale::global(std::locale("en_US.UTF-8"));
+#if ICHOR_EXCEPTIONS_ENABLED
+    } catch(std::runtime_error const &e) {
+        fmt::println("Couldn't set locale to en_US.UTF-8: {}", e.what());
+    }
+#endif
+
+    bool showHelp{};
+    bool singleOnly{};
+    bool liburing{};
+    uint32_t workers{4};
+    uint32_t inFlight{64};
+    std::string directory{"ichor_file_io_benchmark_files"};
+
+    auto cli = lyra::help(showHelp)
+#ifdef ICHOR_USE_LIBURING
+               | lyra::opt(liburing)["-u"]["--liburing"]("Use io_uring as a queue and for file I/O")
+#endif
+               | lyra::opt(workers, "workers")["-w"]["--workers"]("Amount of worker threads for the blocking file I/O pool")
+               | lyra::opt(inFlight, "reads")["-i"]["--in-flight"]("Amount of reads in flight per thread")
+               | lyra::opt(directory, "directory")["-d"]["--directory"]("Directory to create the files to read in")
+               | lyra::opt(singleOnly)["-s"]["--single"]("Single core only");
+
+    auto result = cli.parse( { argc, argv } );
+    if (!result) {
+        fmt::print("Error in command line: {}\n", result.message());
+        return 1;
+    }
+
+    if (showHelp) {
+        std::cout << cli << "\n";
+        return 0;
+    }
+
+    std::filesystem::create_directories(directory);
+    {
+        std::string contents(FILE_SIZE, 'x');
+        for(uint32_t i = 0; i < FILE_COUNT; i++) {
+            std::ofstream out(std::filesystem::path{directory} / fmt::format("{}.bin", i), std::ios::binary);
+            out << contents;
+        }
+    }
+
+    {
+        auto start = std::chrono::steady_clock::now();
+        runQueue(liburing, workers, inFlight, directory);
+        auto end = std::chrono::steady_clock::now();
+        fmt::println("{} single threaded ran for {:L} µs with {:L} peak memory usage {:L} reads/s {:L} failed", argv[0], std::chrono::duration_cast<std::chrono::microseconds>(end - start).count(), getPeakRSS(),
+                     std::floor(1'000'000. / static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()) * READ_COUNT), failedReads.load());
+    }
+
+    if(!singleOnly) {
+        auto start = std::chrono::steady_clock::now();
+        std::array<std::thread, 8> threads{};
+        for (uint_fast32_t i = 0; i < threads.size(); i++) {
+            threads[i] = std::thread([&] {
+                runQueue(liburing, workers, inFlight, directory);
+            });
+        }
+        for (uint_fast32_t i = 0; i < threads.size(); i++) {
+            threads[i].join();
+        }
+        auto end = std::chrono::steady_clock::now();
+        fmt::println("{} multi threaded ran for {:L} µs with {:L} peak memory usage {:L} reads/s {:L} failed",
+                     argv[0], std::chrono::duration_cast<std::chrono::microseconds>(end - start).count(), getPeakRSS(),
+                     std::floor(1'000'000. / static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()) * READ_COUNT * 8.), failedReads.load());
+    }
+
+    std::filesystem::remove_all(directory);
+
+    return 0;
+}
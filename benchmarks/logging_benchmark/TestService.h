@@ -0,0 +1,88 @@
+#pragma once
+
+#include <ichor/services/logging/Logger.h>
+#include <ichor/services/logging/AsyncLogSink.h>
+#include <ichor/dependency_management/AdvancedService.h>
+#include <ichor/dependency_management/DependencyRegister.h>
+#include <ichor/event_queues/IEventQueue.h>
+#include <ichor/events/RunFunctionEvent.h>
+#include <ichor/ScopedServiceProxy.h>
+#include <atomic>
+#include <chrono>
+
+#if defined(ICHOR_ENABLE_INTERNAL_DEBUGGING) || (defined(ICHOR_BUILDING_DEBUG) && (defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)))
+constexpr uint32_t LOG_COUNT = 100;
+#elif defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+constexpr uint32_t LOG_COUNT = 500'000;
+#else
+constexpr uint32_t LOG_COUNT = 5'000'000;
+#endif
+
+using namespace Ichor;
+using namespace Ichor::v1;
+
+// summed over all threads
+inline std::atomic<uint64_t> loggingNs{};
+inline std::atomic<uint64_t> droppedLines{};
+
+// Logs LOG_COUNT lines from the event loop thread and only measures the time spent in the logging calls, then quits.
+class TestService final : public AdvancedService<TestService> {
+public:
+    TestService(DependencyRegister &reg, Properties props) : AdvancedService(std::move(props)) {
+        reg.registerDependency<ILogger>(this, DependencyFlags::REQUIRED);
+        reg.registerDependency<IEventQueue>(this, DependencyFlags::REQUIRED);
+        reg.registerDependency<IAsyncLogSink>(this, DependencyFlags::NONE);
+    }
+    ~TestService() final = default;
+
+private:
+    Task<tl::expected<void, Ichor::StartError>> start() final {
+        _q->pushEvent<RunFunctionEvent>(getServiceId(), [this]() {
+            auto start = std::chrono::steady_clock::now();
+            for(uint32_t i = 0; i < LOG_COUNT; i++) {
+                ICHOR_LOG_INFO(_logger, "request {} for {} took {} µs", i, std::string_view{"/some/path"}, 1.5);
+            }
+            auto end = std::chrono::steady_clock::now();
+            loggingNs.fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()), std::memory_order_relaxed);
+            if(_sink != nullptr) {
+                droppedLines.fetch_add(_sink->getDroppedCount(), std::memory_order_relaxed);
+            }
+            _q->pushEvent<QuitEvent>(getServiceId());
+        });
+        co_return {};
+    }
+
+    Task<void> stop() final {
+        co_return;
+    }
+
+    void addDependencyInstance(Ichor::ScopedServiceProxy<ILogger*> logger, IService &) {
+        _logger = std::move(logger);
+    }
+
+    void removeDependencyInstance(Ichor::ScopedServiceProxy<ILogger*>, IService&) {
+        _logger.reset();
+    }
+
+    void addDependencyInstance(Ichor::ScopedServiceProxy<IEventQueue*> q, IService&) {
+        _q = std::move(q);
+    }
+
+    void removeDependencyInstance(Ichor::ScopedServiceProxy<IEventQueue*>, IService&) {
+        _q.reset();
+    }
+
+    void addDependencyInstance(Ichor::ScopedServiceProxy<IAsyncLogSink*> sink, IService&) {
+        _sink = std::move(sink);
+    }
+
+    void removeDependencyInstance(Ichor::ScopedServiceProxy<IAsyncLogSink*>, IService&) {
+        _sink.reset();
+    }
+
+    friend DependencyRegister;
+
+    Ichor::ScopedServiceProxy<ILogger*> _logger {};
+    Ichor::ScopedServiceProxy<IEventQueue*> _q {};
+    Ichor::ScopedServiceProxy<IAsyncLogSink*> _sink {};
+};
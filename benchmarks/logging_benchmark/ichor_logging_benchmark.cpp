@@ -0,0 +1,121 @@
+#include "TestService.h"
+#include <ichor/event_queues/PriorityQueue.h>
+#include <ichor/services/logging/LoggerFactory.h>
+#include <ichor/services/logging/NullFrameworkLogger.h>
+#include <ichor/services/logging/NullLogger.h>
+#include <ichor/services/logging/AsyncLogger.h>
+#include <ichor/services/logging/BinaryLogger.h>
+#include <ichor/services/metrics/MemoryUsageFunctions.h>
+#include <ichor/ichor-mimalloc.h>
+#include <iostream>
+#include <thread>
+#include <array>
+#include "../../examples/common/lyra.hpp"
+
+enum class BenchLogger {
+    NULL_LOGGER,
+    ASYNC_DROP,
+    ASYNC_BLOCK,
+    BINARY_BLOCK,
+};
+
+static std::string_view benchLoggerName(BenchLogger logger) {
+    switch(logger) {
+        case BenchLogger::NULL_LOGGER:
+            return "null logger";
+        case BenchLogger::ASYNC_DROP:
+            return "async logger dropping";
+        case BenchLogger::ASYNC_BLOCK:
+            return "async logger blocking";
+        case BenchLogger::BINARY_BLOCK:
+            return "binary logger blocking";
+    }
+    return "";
+}
+
+static void createServices(DependencyManager &dm, BenchLogger logger, std::string const &logFile) {
+    dm.createServiceManager<NullFrameworkLogger, IFrameworkLogger>();
+    if(logger == BenchLogger::NULL_LOGGER) {
+        dm.createServiceManager<LoggerFactory<NullLogger>, ILoggerFactory>(Properties{{"DefaultLogLevel", Ichor::v1::make_any<LogLevel>(LogLevel::LOG_INFO)}});
+    } else {
+        dm.createServiceManager<AsyncLogSink, IAsyncLogSink>(Properties{
+            {"LogFile", Ichor::v1::make_any<std::string>(logFile)},
+            {"OverflowPolicy", Ichor::v1::make_any<AsyncLogOverflowPolicy>(logger == BenchLogger::ASYNC_DROP ? AsyncLogOverflowPolicy::DROP : AsyncLogOverflowPolicy::BLOCK)}});
+        if(logger == BenchLogger::BINARY_BLOCK) {
+            dm.createServiceManager<LoggerFactory<BinaryLogger>, ILoggerFactory>(Properties{{"DefaultLogLevel", Ichor::v1::make_any<LogLevel>(LogLevel::LOG_INFO)}});
+        } else {
+            dm.createServiceManager<LoggerFactory<AsyncLogger>, ILoggerFactory>(Properties{{"DefaultLogLevel", Ichor::v1::make_any<LogLevel>(LogLevel::LOG_INFO)}});
+        }
+    }
+    dm.createServiceManager<TestService>();
+}
+
+int main(int argc, char *argv[]) {
+#if ICHOR_EXCEPTIONS_ENABLED
+    try {
+#endif
+        std::locale::global(std::locale("en_US.UTF-8"));
+#if ICHOR_EXCEPTIONS_ENABLED
+    } catch(std::runtime_error const &e) {
+        fmt::println("Couldn't set locale to en_US.UTF-8: {}", e.what());
+    }
+#endif
+
+    bool showHelp{};
+    bool singleOnly{};
+    std::string logFile{"/dev/null"};
+
+    auto cli = lyra::help(showHelp)
+               | lyra::opt(singleOnly)["-s"]["--single"]("Single core only")
+               | lyra::opt(logFile, "file")["-f"]["--file"]("File the async logger writes to, defaults to /dev/null");
+
+    auto result = cli.parse( { argc, argv } );
+    if (!result) {
+        fmt::print("Error in command line: {}\n", result.message());
+        return 1;
+    }
+
+    if (showHelp) {
+        std::cout << cli << "\n";
+        return 0;
+    }
+
+    for(auto logger : {BenchLogger::NULL_LOGGER, BenchLogger::ASYNC_DROP, BenchLogger::ASYNC_BLOCK, BenchLogger::BINARY_BLOCK}) {
+        {
+            loggingNs = 0;
+            droppedLines = 0;
+            auto start = std::chrono::steady_clock::now();
+            auto queue = std::make_unique<PriorityQueue>();
+            auto &dm = queue->createManager();
+            createServices(dm, logger, logFile);
+            queue->start(CaptureSigInt);
+            auto end = std::chrono::steady_clock::now();
+            fmt::println("{} single threaded {} ran for {:L} µs with {:L} peak memory usage {:.1f} ns per log call, {:L} dropped", argv[0], benchLoggerName(logger), std::chrono::duration_cast<std::chrono::microseconds>(end - start).count(), getPeakRSS(),
+                         static_cast<double>(loggingNs.load()) / LOG_COUNT, droppedLines.load());
+        }
+
+        if(!singleOnly) {
+            loggingNs = 0;
+            droppedLines = 0;
+            auto start = std::chrono::steady_clock::now();
+            std::array<std::thread, 8> threads{};
+            std::array<PriorityQueue, threads.size()> queues{};
+            for (uint_fast32_t i = 0; i < queues.size(); i++) {
+                threads[i] = std::thread([&queues, &logFile, logger, i] {
+                    auto &dm = queues[i].createManager();
+                    createServices(dm, logger, logFile);
+                    queues[i].start(CaptureSigInt);
+                });
+            }
+            for (uint_fast32_t i = 0; i < queues.size(); i++) {
+                threads[i].join();
+            }
+            auto end = std::chrono::steady_clock::now();
+            fmt::println("{} multi threaded {} ran for {:L} µs with {:L} peak memory usage {:.1f} ns per log call, {:L} dropped",
+                         argv[0], benchLoggerName(logger), std::chrono::duration_cast<std::chrono::microseconds>(end - start).count(), getPeakRSS(),
+                         static_cast<double>(loggingNs.load()) / (LOG_COUNT * 8.), droppedLines.load());
+        }
+    }
+
+    return 0;
+}
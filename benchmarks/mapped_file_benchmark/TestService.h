@@ -0,0 +1,129 @@
+#pragma once
+
+#include <ichor/services/logging/Logger.h>
+#include <ichor/services/io/IAsyncFileIO.h>
+#include <ichor/services/io/IMappedFileService.h>
+#include <ichor/dependency_management/AdvancedService.h>
+#include <ichor/dependency_management/DependencyRegister.h>
+#include <ichor/event_queues/IEventQueue.h>
+#include <ichor/events/RunFunctionEvent.h>
+#include <ichor/ScopedServiceProxy.h>
+#include <atomic>
+
+#if defined(ICHOR_ENABLE_INTERNAL_DEBUGGING) || (defined(ICHOR_BUILDING_DEBUG) && (defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)))
+constexpr uint64_t FILE_SIZE = 8ull * 1024 * 1024;
+#else
+constexpr uint64_t FILE_SIZE = 256ull * 1024 * 1024;
+#endif
+
+using namespace Ichor;
+using namespace Ichor::v1;
+
+// summed over all threads
+inline std::atomic<uint64_t> failedLoads{};
+inline std::atomic<uint64_t> checksums{};
+
+// Loads "File" once, either with readWholeFile or by mapping it, touches every byte and quits.
+class TestService final : public AdvancedService<TestService> {
+public:
+    TestService(DependencyRegister &reg, Properties props) : AdvancedService(std::move(props)) {
+        if(auto propIt = getProperties().find("Mapped"); propIt != getProperties().end()) {
+            _mapped = Ichor::v1::any_cast<bool>(propIt->second);
+        }
+        if(auto propIt = getProperties().find("File"); propIt != getProperties().end()) {
+            _file = Ichor::v1::any_cast<std::string>(propIt->second);
+        }
+        reg.registerDependency<ILogger>(this, DependencyFlags::REQUIRED);
+        reg.registerDependency<IEventQueue>(this, DependencyFlags::REQUIRED);
+        if(_mapped) {
+            reg.registerDependency<IMappedFileService>(this, DependencyFlags::REQUIRED);
+        } else {
+            reg.registerDependency<IAsyncFileIO>(this, DependencyFlags::REQUIRED);
+        }
+    }
+    ~TestService() final = default;
+
+private:
+    Task<tl::expected<void, Ichor::StartError>> start() final {
+        _q->pushEvent<RunFunctionEventAsync>(getServiceId(), [this]() -> AsyncGenerator<IchorBehaviour> {
+            if(_mapped) {
+                auto ret = _map->map(_file, MappedFileHints::SEQUENTIAL | MappedFileHints::WILL_NEED);
+                if(!ret) {
+                    failedLoads.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    // kept until the service stops, so the other threads find the mapping still alive
+                    _mapping = std::move(*ret);
+                    checksums.fetch_add(checksum(_mapping->view()), std::memory_order_relaxed);
+                }
+            } else {
+                auto ret = co_await _io->readWholeFile(_file);
+                if(!ret) {
+                    failedLoads.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    _contents = std::move(*ret);
+                    checksums.fetch_add(checksum(_contents), std::memory_order_relaxed);
+                }
+            }
+            _q->pushEvent<QuitEvent>(getServiceId());
+            co_return {};
+        });
+        co_return {};
+    }
+
+    Task<void> stop() final {
+        _mapping.reset();
+        _contents.clear();
+        co_return;
+    }
+
+    static uint64_t checksum(std::string_view data) noexcept {
+        uint64_t sum{};
+        for(char c : data) {
+            sum += static_cast<unsigned char>(c);
+        }
+        return sum;
+    }
+
+    void addDependencyInstance(Ichor::ScopedServiceProxy<ILogger*> logger, IService &) {
+        _logger = std::move(logger);
+    }
+
+    void removeDependencyInstance(Ichor::ScopedServiceProxy<ILogger*>, IService&) {
+        _logger.reset();
+    }
+
+    void addDependencyInstance(Ichor::ScopedServiceProxy<IEventQueue*> q, IService&) {
+        _q = std::move(q);
+    }
+
+    void removeDependencyInstance(Ichor::ScopedServiceProxy<IEventQueue*>, IService&) {
+        _q.reset();
+    }
+
+    void addDependencyInstance(Ichor::ScopedServiceProxy<IAsyncFileIO*> io, IService&) {
+        _io = std::move(io);
+    }
+
+    void removeDependencyInstance(Ichor::ScopedServiceProxy<IAsyncFileIO*>, IService&) {
+        _io.reset();
+    }
+
+    void addDependencyInstance(Ichor::ScopedServiceProxy<IMappedFileService*> map, IService&) {
+        _map = std::move(map);
+    }
+
+    void removeDependencyInstance(Ichor::ScopedServiceProxy<IMappedFileService*>, IService&) {
+        _map.reset();
+    }
+
+    friend DependencyRegister;
+
+    Ichor::ScopedServiceProxy<ILogger*> _logger {};
+    Ichor::ScopedServiceProxy<IEventQueue*> _q {};
+    Ichor::ScopedServiceProxy<IAsyncFileIO*> _io {};
+    Ichor::ScopedServiceProxy<IMappedFileService*> _map {};
+    bool _mapped{};
+    std::filesystem::path _file{};
+    std::shared_ptr<MappedFile const> _mapping{};
+    std::string _contents{};
+};
@@ -0,0 +1,130 @@
+#include "TestService.h"
+#include <ichor/event_queues/PriorityQueue.h>
+#include <ichor/services/io/SharedOverThreadsAsyncFileIO.h>
+#include <ichor/services/io/MappedFileService.h>
+#ifdef ICHOR_USE_LIBURING
+#include <ichor/event_queues/IOUringQueue.h>
+#include <ichor/services/io/IOUringAsyncFileIO.h>
+#endif
+#include <ichor/services/logging/LoggerFactory.h>
+#include <ichor/services/logging/NullFrameworkLogger.h>
+#include <ichor/services/logging/NullLogger.h>
+#include <ichor/services/metrics/MemoryUsageFunctions.h>
+#include <ichor/ichor-mimalloc.h>
+#include <iostream>
+#include <fstream>
+#include <thread>
+#include <array>
+#include "../../examples/common/lyra.hpp"
+
+namespace {
+    void runQueue(bool liburing, bool mapped, std::string const &file) {
+        std::unique_ptr<IEventQueue> queue;
+        if(liburing) {
+#ifdef ICHOR_USE_LIBURING
+            auto q = std::make_unique<IOUringQueue>(10, 10'000);
+            if(!q->createEventLoop()) {
+                fmt::println("Couldn't create event loop.");
+                std::terminate();
+            }
+            queue = std::move(q);
+#endif
+        } else {
+            queue = std::make_unique<PriorityQueue>();
+        }
+        auto &dm = queue->createManager();
+        dm.createServiceManager<LoggerFactory<NullLogger>, ILoggerFactory>();
+        dm.createServiceManager<NullFrameworkLogger, IFrameworkLogger>();
+        if(mapped) {
+            dm.createServiceManager<MappedFileService, IMappedFileService>();
+        } else if(liburing) {
+#ifdef ICHOR_USE_LIBURING
+            dm.createServiceManager<IOUringAsyncFileIO, IAsyncFileIO>();
+#endif
+        } else {
+            dm.createServiceManager<SharedOverThreadsAsyncFileIO, IAsyncFileIO>();
+        }
+        dm.createServiceManager<TestService>(Properties{{"LogLevel", Ichor::v1::make_any<LogLevel>(LogLevel::LOG_WARN)},
+                                                        {"Mapped", Ichor::v1::make_any<bool>(mapped)},
+                                                        {"File", Ichor::v1::make_any<std::string>(file)}});
+        queue->start(CaptureSigInt);
+    }
+}
+
+int main(int argc, char *argv[]) {
+#if ICHOR_EXCEPTIONS_ENABLED
+    try {
+#endif
+        std::locale::global(std::locale("en_US.UTF-8"));
+#if ICHOR_EXCEPTIONS_ENABLED
+    } catch(std::runtime_error const &e) {
+        fmt::println("Couldn't set locale to en_US.UTF-8: {}", e.what());
+    }
+#endif
+
+    bool showHelp{};
+    bool singleOnly{};
+    bool liburing{};
+    bool mapped{};
+    std::string file{"ichor_mapped_file_benchmark.bin"};
+
+    auto cli = lyra::help(showHelp)
+#ifdef ICHOR_USE_LIBURING
+               | lyra::opt(liburing)["-u"]["--liburing"]("Use io_uring as a queue and for file I/O")
+#endif
+               | lyra::opt(mapped)["-m"]["--mapped"]("Map the file instead of reading it with readWholeFile")
+               | lyra::opt(file, "file")["-f"]["--file"]("File to create and load")
+               | lyra::opt(singleOnly)["-s"]["--single"]("Single core only");
+
+    auto result = cli.parse( { argc, argv } );
+    if (!result) {
+        fmt::print("Error in command line: {}\n", result.message());
+        return 1;
+    }
+
+    if (showHelp) {
+        std::cout << cli << "\n";
+        return 0;
+    }
+
+    {
+        std::string contents(1024*1024, 'x');
+        std::ofstream out(file, std::ios::binary);
+        for(uint64_t i = 0; i < FILE_SIZE / contents.size(); i++) {
+            out << contents;
+        }
+    }
+
+    {
+        auto start = std::chrono::steady_clock::now();
+        runQueue(liburing, mapped, file);
+        auto end = std::chrono::steady_clock::now();
+        fmt::println("{} single threaded ran for {:L} µs with {:L} peak memory usage {:L} MiB/s {:L} failed", argv[0], std::chrono::duration_cast<std::chrono::microseconds>(end - start).count(), getPeakRSS(),
+                     std::floor(1'000'000. / static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()) * static_cast<double>(FILE_SIZE / (1024*1024))), failedLoads.load());
+    }
+
+    if(!singleOnly) {
+        auto start = std::chrono::steady_clock::now();
+        std::array<std::thread, 8> threads{};
+        for (uint_fast32_t i = 0; i < threads.size(); i++) {
+            threads[i] = std::thread([&] {
+                runQueue(liburing, mapped, file);
+            });
+        }
+        for (uint_fast32_t i = 0; i < threads.size(); i++) {
+            threads[i].join();
+        }
+        auto end = std::chrono::steady_clock::now();
+        fmt::println("{} multi threaded ran for {:L} µs with {:L} peak memory usage {:L} MiB/s {:L} failed",
+                     argv[0], std::chrono::duration_cast<std::chrono::microseconds>(end - start).count(), getPeakRSS(),
+                     std::floor(1'000'000. / static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()) * static_cast<double>(FILE_SIZE / (1024*1024)) * 8.), failedLoads.load());
+    }
+
+    if(checksums.load() != FILE_SIZE * 'x' * (singleOnly ? 1 : 9)) {
+        fmt::println("checksum mismatch");
+    }
+
+    std::filesystem::remove(file);
+
+    return 0;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <ichor/dependency_management/AdvancedService.h>
+#include <ichor/dependency_management/DependencyRegister.h>
+#include <ichor/ScopedServiceProxy.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#if defined(ICHOR_ENABLE_INTERNAL_DEBUGGING) || (defined(ICHOR_BUILDING_DEBUG) && (defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)))
+constexpr uint32_t TABLE_SIZE = 10'000;
+#elif defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+constexpr uint32_t TABLE_SIZE = 100'000;
+#else
+constexpr uint32_t TABLE_SIZE = 4'000'000;
+#endif
+
+using namespace Ichor;
+using namespace Ichor::v1;
+
+template <uint32_t Layer>
+class ILayer {
+protected:
+    ~ILayer() = default;
+};
+
+/// Stands in for a service with an expensive start(), e.g. one that loads a table or warms a cache.
+/// Every service of a layer depends on the services of the layer below it, so the services of one layer are independent of each other.
+/// start() blocks, with the "ParallelStart" property the DependencyManager runs it on the worker pool.
+template <uint32_t Layer>
+class WarmupService final : public ILayer<Layer>, public AdvancedService<WarmupService<Layer>> {
+public:
+    WarmupService(DependencyRegister &reg, Properties props) : AdvancedService<WarmupService<Layer>>(std::move(props)) {
+        if constexpr (Layer > 0) {
+            reg.registerDependency<ILayer<Layer - 1>>(this, DependencyFlags::REQUIRED | DependencyFlags::ALLOW_MULTIPLE);
+        }
+        _latency = std::chrono::milliseconds{Ichor::v1::any_cast<uint64_t>(AdvancedService<WarmupService<Layer>>::getProperties()["LatencyMs"])};
+    }
+    ~WarmupService() final = default;
+
+    [[nodiscard]] uint64_t checksum() const noexcept {
+        return _checksum;
+    }
+
+private:
+    Task<tl::expected<void, Ichor::StartError>> start() final {
+        // emulates blocking io, such as reading the table from disk
+        if(_latency.count() > 0) {
+            std::this_thread::sleep_for(_latency);
+        }
+        std::vector<uint64_t> table(TABLE_SIZE);
+        uint64_t x = Layer;
+        for(auto &entry : table) {
+            // splitmix64
+            x += 0x9e3779b97f4a7c15ULL;
+            uint64_t z = x;
+            z = (z ^ (z >> 30u)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27u)) * 0x94d049bb133111ebULL;
+            entry = z ^ (z >> 31u);
+        }
+        for(auto const entry : table) {
+            _checksum ^= entry;
+        }
+        co_return {};
+    }
+
+    Task<void> stop() final {
+        co_return;
+    }
+
+    void addDependencyInstance(Ichor::ScopedServiceProxy<ILayer<Layer - 1>*>, IService &) requires (Layer > 0) {
+    }
+
+    void removeDependencyInstance(Ichor::ScopedServiceProxy<ILayer<Layer - 1>*>, IService&) requires (Layer > 0) {
+    }
+
+    friend DependencyRegister;
+
+    std::chrono::milliseconds _latency{};
+    uint64_t _checksum{};
+};
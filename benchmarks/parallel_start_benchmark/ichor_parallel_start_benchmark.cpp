@@ -0,0 +1,98 @@
+#include "WarmupService.h"
+#include <ichor/DependencyManager.h>
+#include <ichor/event_queues/PriorityQueue.h>
+#include <ichor/events/InternalEvents.h>
+#include <ichor/services/logging/NullFrameworkLogger.h>
+#include <ichor/services/metrics/MemoryUsageFunctions.h>
+#include <ichor/services/workers/WorkerPoolService.h>
+#include <ichor/ichor-mimalloc.h>
+#include <iostream>
+#include "../../examples/common/lyra.hpp"
+
+constexpr uint32_t SERVICES_PER_LAYER = 16;
+
+template <uint32_t Layer>
+void createLayer(ServiceBatch &batch, uint64_t latencyMs, bool parallel) {
+    for(uint32_t i = 0; i < SERVICES_PER_LAYER; i++) {
+        batch.createServiceManager<WarmupService<Layer>, ILayer<Layer>>(Properties{{"LatencyMs", Ichor::v1::make_any<uint64_t>(latencyMs)}, {"ParallelStart", Ichor::v1::make_any<bool>(parallel)}});
+    }
+}
+
+int main(int argc, char *argv[]) {
+#if ICHOR_EXCEPTIONS_ENABLED
+    try {
+#endif
+        std::locale::global(std::locale("en_US.UTF-8"));
+#if ICHOR_EXCEPTIONS_ENABLED
+    } catch(std::runtime_error const &e) {
+        fmt::println("Couldn't set locale to en_US.UTF-8: {}", e.what());
+    }
+#endif
+
+    bool showHelp{};
+    bool serialOnly{};
+    bool parallelOnly{};
+    uint32_t threads = std::max(std::thread::hardware_concurrency(), 1u);
+    uint64_t latencyMs{};
+
+    auto cli = lyra::help(showHelp)
+               | lyra::opt(serialOnly)["-s"]["--serial"]("Only start the services on the thread of the queue")
+               | lyra::opt(parallelOnly)["-p"]["--parallel"]("Only start the services of a layer in parallel on a WorkerPoolService")
+               | lyra::opt(threads, "threads")["-t"]["--threads"]("Amount of worker threads, defaults to the amount of cores")
+               | lyra::opt(latencyMs, "ms")["-l"]["--latency"]("Milliseconds every service blocks in start(), emulating io");
+
+    auto result = cli.parse( { argc, argv } );
+    if (!result) {
+        fmt::print("Error in command line: {}\n", result.message());
+        return 1;
+    }
+
+    if (showHelp) {
+        std::cout << cli << "\n";
+        return 0;
+    }
+
+    if(!serialOnly && !parallelOnly) {
+        serialOnly = true;
+        parallelOnly = true;
+    }
+
+    auto run = [&](bool parallel) {
+        auto queue = std::make_unique<PriorityQueue>();
+        auto &dm = queue->createManager();
+        std::chrono::steady_clock::time_point start{};
+        std::chrono::steady_clock::time_point ready{};
+
+        auto interceptor = dm.registerGlobalEventInterceptor<ServiceBatchStartedEvent>([&](ServiceBatchStartedEvent const &) -> bool {
+            ready = std::chrono::steady_clock::now();
+            dm.getEventQueue().pushEvent<QuitEvent>(ServiceIdType{0});
+            return (bool)AllowOthersHandling;
+        }, [](ServiceBatchStartedEvent const &, bool) {});
+
+        dm.createServiceManager<NullFrameworkLogger, IFrameworkLogger>();
+        auto batch = dm.createServiceBatch();
+        if(parallel) {
+            batch.createServiceManager<WorkerPoolService, IWorkerPool>(Properties{{"WorkerThreads", Ichor::v1::make_any<uint32_t>(threads)}});
+        }
+        createLayer<0>(batch, latencyMs, parallel);
+        createLayer<1>(batch, latencyMs, parallel);
+        createLayer<2>(batch, latencyMs, parallel);
+        createLayer<3>(batch, latencyMs, parallel);
+        dm.insertServiceBatch(std::move(batch));
+
+        start = std::chrono::steady_clock::now();
+        queue->start(CaptureSigInt);
+        fmt::println("{} {} started {} services in {:L} µs with {:L} peak memory usage", argv[0], parallel ? fmt::format("parallel ({} threads)", threads) : std::string{"serial"}, SERVICES_PER_LAYER * 4,
+                     std::chrono::duration_cast<std::chrono::microseconds>(ready - start).count(), getPeakRSS());
+    };
+
+    if(serialOnly) {
+        run(false);
+    }
+
+    if(parallelOnly) {
+        run(true);
+    }
+
+    return 0;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <ichor/DependencyManager.h>
 #include <ichor/services/logging/Logger.h>
@@ -20,6 +21,10 @@ constexpr uint32_t SERDE_COUNT = 5'000'000;
 using namespace Ichor;
 using namespace Ichor::v1;
 extern uint64_t sizeof_test;
+extern bool useAllocatingApi;
+// allocations made by the serialize/deserialize loop, summed over all threads
+extern std::atomic<uint64_t> loopAllocations;
+uint64_t threadAllocations() noexcept;
 
 class TestService final : public AdvancedService<TestService> {
 public:
@@ -65,15 +70,28 @@ private:
         ICHOR_LOG_ERROR(_logger, "handling DoWorkEvent");
         TestMsg msg{20, "five hundred"};
         sizeof_test = _serializer->serialize(msg).size();
+        auto allocationsBefore = threadAllocations();
         auto start = std::chrono::steady_clock::now();
-        for(uint64_t i = 0; i < SERDE_COUNT; i++) {
-            auto res = _serializer->serialize(msg);
-            auto msg2 = _serializer->deserialize(res);
-            if(msg2->id != msg.id || msg2->val != msg.val) {
-                ICHOR_LOG_ERROR(_logger, "serde incorrect!");
+        if(useAllocatingApi) {
+            for(uint64_t i = 0; i < SERDE_COUNT; i++) {
+                auto res = _serializer->serialize(msg);
+                auto msg2 = _serializer->deserialize(res);
+                if(msg2->id != msg.id || msg2->val != msg.val) {
+                    ICHOR_LOG_ERROR(_logger, "serde incorrect!");
+                }
+            }
+        } else {
+            std::vector<uint8_t> buf;
+            TestMsg msg2{};
+            for(uint64_t i = 0; i < SERDE_COUNT; i++) {
+                buf.clear();
+                if(!_serializer->serializeInto(msg, buf) || !_serializer->deserializeInto(buf, msg2) || msg2.id != msg.id || msg2.val != msg.val) {
+                    ICHOR_LOG_ERROR(_logger, "serde incorrect!");
+                }
             }
         }
         auto end = std::chrono::steady_clock::now();
+        loopAllocations.fetch_add(threadAllocations() - allocationsBefore, std::memory_order_relaxed);
         ICHOR_LOG_ERROR(_logger, "finished in {:L} µs", std::chrono::duration_cast<std::chrono::microseconds>(end-start).count());
         GetThreadLocalEventQueue().pushEvent<QuitEvent>(getServiceId());
         co_return {};
@@ -2,6 +2,7 @@
 #include <ichor/event_queues/PriorityQueue.h>
 #include <ichor/services/logging/LoggerFactory.h>
 #include <ichor/services/serialization/ISerializer.h>
+#include <ichor/services/serialization/GlazeBinarySerializer.h>
 #include <ichor/services/logging/NullLogger.h>
 #include <ichor/services/logging/NullFrameworkLogger.h>
 #include <ichor/services/metrics/MemoryUsageFunctions.h>
@@ -9,12 +10,78 @@
 #include <iostream>
 #include <thread>
 #include <array>
+#include <cstdlib>
+#include <new>
 #include "../../examples/common/TestMsgGlazeSerializer.h"
 #include "../../examples/common/lyra.hpp"
 
 uint64_t sizeof_test{};
+bool useAllocatingApi{};
+std::atomic<uint64_t> loopAllocations{};
 const uint32_t threadCount{8};
 
+#if defined(ICHOR_USE_SYSTEM_MIMALLOC) || defined(ICHOR_USE_MIMALLOC)
+// mimalloc replaces operator new, allocations are not counted
+constexpr bool countingAllocations = false;
+
+uint64_t threadAllocations() noexcept {
+    return 0;
+}
+#else
+constexpr bool countingAllocations = true;
+thread_local uint64_t allocationCount{};
+
+uint64_t threadAllocations() noexcept {
+    return allocationCount;
+}
+
+// gcc sees the malloc/free pair through the replaced operators and warns about a mismatch
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t size) {
+    allocationCount++;
+    if(size == 0) {
+        size = 1;
+    }
+    if(auto *ptr = std::malloc(size)) {
+        return ptr;
+    }
+#if ICHOR_EXCEPTIONS_ENABLED
+    throw std::bad_alloc{};
+#else
+    std::terminate();
+#endif
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+#endif
+
+namespace {
+    void createSerializer(DependencyManager &dm, bool binary) {
+        if(binary) {
+            dm.createServiceManager<GlazeBinarySerializer<TestMsg>, ISerializer<TestMsg>>();
+        } else {
+            dm.createServiceManager<TestMsgGlazeSerializer, ISerializer<TestMsg>>();
+        }
+    }
+
+    std::string allocationsPerMessage(uint64_t messages) {
+        if(!countingAllocations) {
+            return "n/a";
+        }
+        auto allocations = loopAllocations.exchange(0);
+        return fmt::format("{:.2f}", static_cast<double>(allocations) / static_cast<double>(messages));
+    }
+}
+
 int main(int argc, char *argv[]) {
 #if ICHOR_EXCEPTIONS_ENABLED
     try {
@@ -28,8 +95,11 @@ int main(int argc, char *argv[]) {
 
     bool showHelp{};
     bool singleOnly{};
+    bool binary{};
 
     auto cli = lyra::help(showHelp)
+               | lyra::opt(useAllocatingApi)["-a"]["--allocating"]("Use serialize()/deserialize(), which allocate a new buffer and message every call, instead of serializeInto()/deserializeInto()")
+               | lyra::opt(binary)["-b"]["--binary"]("Use the glaze binary (BEVE) serializer instead of JSON")
                | lyra::opt(singleOnly)["-s"]["--single"]("Single core only");
 
     auto result = cli.parse( { argc, argv } );
@@ -49,12 +119,12 @@ int main(int argc, char *argv[]) {
         auto &dm = queue->createManager();
         dm.createServiceManager<LoggerFactory<NullLogger>, ILoggerFactory>();
         dm.createServiceManager<NullFrameworkLogger, IFrameworkLogger>();
-        dm.createServiceManager<TestMsgGlazeSerializer, ISerializer<TestMsg>>();
+        createSerializer(dm, binary);
         dm.createServiceManager<TestService>();
         queue->start(CaptureSigInt);
         auto end = std::chrono::steady_clock::now();
-        fmt::println("{} single threaded glaze ran for {:L} µs with {:L} peak memory usage {:L} MB/s", argv[0], std::chrono::duration_cast<std::chrono::microseconds>(end - start).count(), getPeakRSS(),
-                     std::floor(1'000'000. / static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()) * SERDE_COUNT * static_cast<double>(sizeof_test) / 1'000'000.));
+        fmt::println("{} single threaded {} ran for {:L} µs with {:L} peak memory usage {:L} MB/s {} allocations/msg", argv[0], binary ? "beve" : "json", std::chrono::duration_cast<std::chrono::microseconds>(end - start).count(), getPeakRSS(),
+                     std::floor(1'000'000. / static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()) * SERDE_COUNT * static_cast<double>(sizeof_test) / 1'000'000.), allocationsPerMessage(SERDE_COUNT));
     }
 
     if(!singleOnly) {
@@ -62,11 +132,11 @@ int main(int argc, char *argv[]) {
         std::array<std::thread, threadCount> threads{};
         std::array<PriorityQueue, threadCount> queues{};
         for (uint_fast32_t i = 0, j = 0; i < threadCount; i++, j += 2) {
-            threads[i] = std::thread([&queues, i] {
+            threads[i] = std::thread([&queues, i, binary] {
                 auto &dm = queues[i].createManager();
                 dm.createServiceManager<LoggerFactory<NullLogger>, ILoggerFactory>();
                 dm.createServiceManager<NullFrameworkLogger, IFrameworkLogger>();
-                dm.createServiceManager<TestMsgGlazeSerializer, ISerializer<TestMsg>>();
+                createSerializer(dm, binary);
                 dm.createServiceManager<TestService>();
                 queues[i].start(CaptureSigInt);
             });
@@ -75,9 +145,9 @@ int main(int argc, char *argv[]) {
             threads[i].join();
         }
         auto end = std::chrono::steady_clock::now();
-        fmt::println("{} multi threaded glaze ran for {:L} µs with {:L} peak memory usage {:L} MB/s",
-                     argv[0], std::chrono::duration_cast<std::chrono::microseconds>(end - start).count(), getPeakRSS(),
-                     std::floor(1'000'000. / static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()) * SERDE_COUNT * threadCount * static_cast<double>(sizeof_test) / 1'000'000.));
+        fmt::println("{} multi threaded {} ran for {:L} µs with {:L} peak memory usage {:L} MB/s {} allocations/msg",
+                     argv[0], binary ? "beve" : "json", std::chrono::duration_cast<std::chrono::microseconds>(end - start).count(), getPeakRSS(),
+                     std::floor(1'000'000. / static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()) * SERDE_COUNT * threadCount * static_cast<double>(sizeof_test) / 1'000'000.), allocationsPerMessage(SERDE_COUNT * threadCount));
     }
 
     return 0;
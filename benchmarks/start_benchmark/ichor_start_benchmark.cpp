@@ -17,6 +17,22 @@ struct GlobalEventStatistics {
     int64_t max;
 };
 
+template <typename ServiceT>
+void createTestServices(DependencyManager &dm, bool batched) {
+    if(batched) {
+        auto batch = dm.createServiceBatch();
+        for (uint64_t i = 0; i < SERVICES_COUNT; i++) {
+            batch.createServiceManager<ServiceT>(Properties{{"Iteration", Ichor::v1::make_any<uint64_t>(i)}, {"LogLevel", Ichor::v1::make_any<LogLevel>(LogLevel::LOG_WARN)}});
+        }
+        dm.insertServiceBatch(std::move(batch));
+        return;
+    }
+
+    for (uint64_t i = 0; i < SERVICES_COUNT; i++) {
+        dm.createServiceManager<ServiceT>(Properties{{"Iteration", Ichor::v1::make_any<uint64_t>(i)}, {"LogLevel", Ichor::v1::make_any<LogLevel>(LogLevel::LOG_WARN)}});
+    }
+}
+
 int main(int argc, char *argv[]) {
 #if ICHOR_EXCEPTIONS_ENABLED
     try {
@@ -32,11 +48,13 @@ int main(int argc, char *argv[]) {
     bool singleOnly{};
     bool advancedOnly{};
     bool constructerOnly{};
+    bool batched{};
 
     auto cli = lyra::help(showHelp)
                | lyra::opt(singleOnly)["-s"]["--single"]("Single core only")
                | lyra::opt(advancedOnly)["-a"]["--advanced"]("Advanced Service only")
-               | lyra::opt(constructerOnly)["-c"]["--constructor"]("Constructor Injection only");
+               | lyra::opt(constructerOnly)["-c"]["--constructor"]("Constructor Injection only")
+               | lyra::opt(batched)["-b"]["--batch"]("Insert the services with a single ServiceBatch");
 
     auto result = cli.parse( { argc, argv } );
     if (!result) {
@@ -62,10 +80,7 @@ int main(int argc, char *argv[]) {
             auto &dm = queue->createManager();
             dm.createServiceManager<LoggerFactory<NullLogger>, ILoggerFactory>();
             dm.createServiceManager<NullFrameworkLogger, IFrameworkLogger>();
-            for (uint64_t i = 0; i < SERVICES_COUNT; i++) {
-                dm.createServiceManager<TestService>(Properties{{"Iteration", Ichor::v1::make_any<uint64_t>(i)},
-                                                                {"LogLevel",  Ichor::v1::make_any<LogLevel>(LogLevel::LOG_WARN)}});
-            }
+            createTestServices<TestService>(dm, batched);
             queue->start(CaptureSigInt);
             auto end = std::chrono::steady_clock::now();
             fmt::println("{} single threaded advanced injection ran for {:L} µs with {:L} peak memory usage", argv[0], std::chrono::duration_cast<std::chrono::microseconds>(end - start).count(), getPeakRSS());
@@ -76,13 +91,11 @@ int main(int argc, char *argv[]) {
             std::array<std::thread, 8> threads{};
             std::array<PriorityQueue, 8> queues{};
             for (uint_fast32_t i = 0, j = 0; i < 8; i++, j += 2) {
-                threads[i] = std::thread([&queues, i] {
+                threads[i] = std::thread([&queues, i, batched] {
                     auto &dm = queues[i].createManager();
                     dm.createServiceManager<LoggerFactory<NullLogger>, ILoggerFactory>();
                     dm.createServiceManager<NullFrameworkLogger, IFrameworkLogger>();
-                    for (uint64_t z = 0; z < SERVICES_COUNT; z++) {
-                        dm.createServiceManager<TestService>(Properties{{"Iteration", Ichor::v1::make_any<uint64_t>(z)}, {"LogLevel", Ichor::v1::make_any<LogLevel>(LogLevel::LOG_WARN)}});
-                    }
+                    createTestServices<TestService>(dm, batched);
                     queues[i].start(CaptureSigInt);
                 });
             }
@@ -138,10 +151,7 @@ int main(int argc, char *argv[]) {
 
             dm.createServiceManager<LoggerFactory<NullLogger>, ILoggerFactory>();
             dm.createServiceManager<NullFrameworkLogger, IFrameworkLogger>();
-            for (uint64_t i = 0; i < SERVICES_COUNT; i++) {
-                dm.createServiceManager<ConstructorInjectionTestService>(Properties{{"Iteration", Ichor::v1::make_any<uint64_t>(i)},
-                                                                {"LogLevel",  Ichor::v1::make_any<LogLevel>(LogLevel::LOG_WARN)}});
-            }
+            createTestServices<ConstructorInjectionTestService>(dm, batched);
             queue->start(CaptureSigInt);
 
             fmt::println("Global Event Statistics:");
@@ -161,13 +171,11 @@ int main(int argc, char *argv[]) {
             std::array<std::thread, 8> threads{};
             std::array<PriorityQueue, 8> queues{};
             for (uint_fast32_t i = 0, j = 0; i < 8; i++, j += 2) {
-                threads[i] = std::thread([&queues, i] {
+                threads[i] = std::thread([&queues, i, batched] {
                     auto &dm = queues[i].createManager();
                     dm.createServiceManager<LoggerFactory<NullLogger>, ILoggerFactory>();
                     dm.createServiceManager<NullFrameworkLogger, IFrameworkLogger>();
-                    for (uint64_t z = 0; z < SERVICES_COUNT; z++) {
-                        dm.createServiceManager<ConstructorInjectionTestService>(Properties{{"Iteration", Ichor::v1::make_any<uint64_t>(z)}, {"LogLevel", Ichor::v1::make_any<LogLevel>(LogLevel::LOG_WARN)}});
-                    }
+                    createTestServices<ConstructorInjectionTestService>(dm, batched);
                     queues[i].start(CaptureSigInt);
                 });
             }
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <ichor/DependencyManager.h>
+#include <ichor/services/logging/Logger.h>
+#include <ichor/services/network/ISSL.h>
+#include <ichor/services/network/IConnectionService.h>
+#include <ichor/services/network/IHostService.h>
+#include <ichor/services/network/tcp/IOUringTcpConnectionService.h>
+#include <ichor/services/network/tcp/IOUringTcpHostService.h>
+#include <ichor/dependency_management/AdvancedService.h>
+#include <ichor/dependency_management/DependencyRegister.h>
+#include <ichor/events/RunFunctionEvent.h>
+#include <ichor/ScopedServiceProxy.h>
+#include "../../test/SSLCerts.h"
+
+#if defined(ICHOR_ENABLE_INTERNAL_DEBUGGING) || (defined(ICHOR_BUILDING_DEBUG) && (defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)))
+constexpr uint32_t MESSAGE_COUNT = 100;
+#elif defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+constexpr uint32_t MESSAGE_COUNT = 2'000;
+#else
+constexpr uint32_t MESSAGE_COUNT = 20'000;
+#endif
+constexpr uint32_t MESSAGE_SIZE = 64 * 1024;
+
+using namespace Ichor;
+using namespace Ichor::v1;
+
+// Sends MESSAGE_COUNT messages over a loopback TLS connection and quits once the host side received everything
+class TestService final : public AdvancedService<TestService> {
+public:
+    TestService(DependencyRegister &reg, Properties props) : AdvancedService(std::move(props)) {
+        reg.registerDependency<ILogger>(this, DependencyFlags::REQUIRED);
+        reg.registerDependency<ISSL>(this, DependencyFlags::REQUIRED);
+        reg.registerDependency<IHostService>(this, DependencyFlags::NONE);
+        reg.registerDependency<IConnectionService>(this, DependencyFlags::ALLOW_MULTIPLE);
+    }
+    ~TestService() final = default;
+
+private:
+    Task<tl::expected<void, Ichor::StartError>> start() final {
+        auto const &props = getProperties();
+        _kernelOffload = Ichor::v1::any_cast<bool>(props.find("KernelOffload")->second);
+        _port = Ichor::v1::any_cast<uint16_t>(props.find("Port")->second);
+
+        std::vector<uint8_t> cert(ecdsa_p256_cert, ecdsa_p256_cert + sizeof(ecdsa_p256_cert));
+        std::vector<uint8_t> key(ecdsa_p256_private_key, ecdsa_p256_private_key + sizeof(ecdsa_p256_private_key));
+        auto serverContext = _ssl->createServerTLSContext(std::move(cert), std::move(key), {.allowKernelOffload = _kernelOffload});
+        auto clientContext = _ssl->createClientTLSContext({.allowUnknownCertificates = true, .allowKernelOffload = _kernelOffload});
+
+        if(!serverContext || !clientContext) {
+            ICHOR_LOG_ERROR(_logger, "Couldn't create TLS contexts");
+            co_return tl::unexpected(StartError::FAILED);
+        }
+
+        _clientContext = std::move(*clientContext);
+        GetThreadLocalManager().createServiceManager<IOUringTcpHostService, IHostService>(Properties{
+            {"Address", Ichor::v1::make_any<std::string>("127.0.0.1")},
+            {"Port", Ichor::v1::make_any<uint16_t>(_port)},
+            {"TLSContext", Ichor::v1::make_unformattable_any<std::shared_ptr<TLSContext>>(std::move(*serverContext))}});
+
+        co_return {};
+    }
+
+    Task<void> stop() final {
+        _clientContext.reset();
+        co_return;
+    }
+
+    void addDependencyInstance(Ichor::ScopedServiceProxy<ILogger*> logger, IService &) {
+        _logger = std::move(logger);
+    }
+
+    void removeDependencyInstance(Ichor::ScopedServiceProxy<ILogger*>, IService&) {
+        _logger.reset();
+    }
+
+    void addDependencyInstance(Ichor::ScopedServiceProxy<ISSL*> ssl, IService&) {
+        _ssl = std::move(ssl);
+    }
+
+    void removeDependencyInstance(Ichor::ScopedServiceProxy<ISSL*>, IService&) {
+        _ssl.reset();
+    }
+
+    void addDependencyInstance(Ichor::ScopedServiceProxy<IHostService*>, IService&) {
+        // the host is listening, connect to it
+        GetThreadLocalManager().createServiceManager<IOUringTcpConnectionService<IClientConnectionService>, IConnectionService, IClientConnectionService>(Properties{
+            {"Address", Ichor::v1::make_any<std::string>("127.0.0.1")},
+            {"Port", Ichor::v1::make_any<uint16_t>(_port)},
+            {"TLSContext", Ichor::v1::make_unformattable_any<std::shared_ptr<TLSContext>>(_clientContext)}});
+    }
+
+    void removeDependencyInstance(Ichor::ScopedServiceProxy<IHostService*>, IService&) {
+    }
+
+    void addDependencyInstance(Ichor::ScopedServiceProxy<IConnectionService*> connection, IService&) {
+        if(!connection->isClient()) {
+            connection->setReceiveHandler([this](std::span<uint8_t const> data) {
+                _received += data.size();
+                if(_received == static_cast<uint64_t>(MESSAGE_COUNT) * MESSAGE_SIZE) {
+                    GetThreadLocalEventQueue().pushEvent<QuitEvent>(getServiceId());
+                }
+            });
+            return;
+        }
+
+        _client = std::move(connection);
+        GetThreadLocalEventQueue().pushEvent<RunFunctionEventAsync>(getServiceId(), [this]() -> AsyncGenerator<IchorBehaviour> {
+            for(uint32_t i = 0; i < MESSAGE_COUNT && _client != nullptr; i++) {
+                auto ret = co_await _client->sendAsync(std::vector<uint8_t>(MESSAGE_SIZE, static_cast<uint8_t>(i)));
+                if(!ret) {
+                    ICHOR_LOG_ERROR(_logger, "send error: {}", ret.error());
+                    GetThreadLocalEventQueue().pushEvent<QuitEvent>(getServiceId());
+                    break;
+                }
+            }
+            co_return {};
+        });
+    }
+
+    void removeDependencyInstance(Ichor::ScopedServiceProxy<IConnectionService*> connection, IService&) {
+        if(connection->isClient()) {
+            _client.reset();
+        }
+    }
+
+    friend DependencyRegister;
+
+    Ichor::ScopedServiceProxy<ILogger*> _logger {};
+    Ichor::ScopedServiceProxy<ISSL*> _ssl {};
+    Ichor::ScopedServiceProxy<IConnectionService*> _client {};
+    std::shared_ptr<TLSContext> _clientContext{};
+    bool _kernelOffload{};
+    uint16_t _port{};
+    uint64_t _received{};
+};
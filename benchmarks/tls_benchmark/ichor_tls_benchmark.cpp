@@ -0,0 +1,76 @@
+#if defined(ICHOR_USE_LIBURING) && defined(ICHOR_USE_OPENSSL)
+
+#include "TestService.h"
+#include <ichor/event_queues/IOUringQueue.h>
+#include <ichor/services/logging/LoggerFactory.h>
+#include <ichor/services/logging/NullFrameworkLogger.h>
+#include <ichor/services/logging/NullLogger.h>
+#include <ichor/services/network/ssl/openssl/OpenSSLService.h>
+#include <ichor/services/metrics/MemoryUsageFunctions.h>
+#include <ichor/ichor-mimalloc.h>
+#include <iostream>
+#include "../../examples/common/lyra.hpp"
+
+int main(int argc, char *argv[]) {
+#if ICHOR_EXCEPTIONS_ENABLED
+    try {
+#endif
+        std::locale::global(std::locale("en_US.UTF-8"));
+#if ICHOR_EXCEPTIONS_ENABLED
+    } catch(std::runtime_error const &e) {
+        fmt::println("Couldn't set locale to en_US.UTF-8: {}", e.what());
+    }
+#endif
+
+    bool showHelp{};
+    bool kernelOnly{};
+    bool userOnly{};
+
+    auto cli = lyra::help(showHelp)
+               | lyra::opt(kernelOnly)["-k"]["--kernel"]("Only run with kernel TLS offload")
+               | lyra::opt(userOnly)["-u"]["--user"]("Only run with user space TLS");
+
+    auto result = cli.parse( { argc, argv } );
+    if (!result) {
+        fmt::print("Error in command line: {}\n", result.message());
+        return 1;
+    }
+
+    if (showHelp) {
+        std::cout << cli << "\n";
+        return 0;
+    }
+
+    // kernel TLS silently falls back to user space if the tls module isn't available, run with a debug logger to verify which one is used
+    for(bool kernelOffload : {false, true}) {
+        if((kernelOffload && userOnly) || (!kernelOffload && kernelOnly)) {
+            continue;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        auto queue = std::make_unique<IOUringQueue>();
+        if(!queue->createEventLoop()) {
+            fmt::println("Couldn't create io_uring event loop");
+            return -1;
+        }
+        auto &dm = queue->createManager();
+        dm.createServiceManager<LoggerFactory<NullLogger>, ILoggerFactory>();
+        dm.createServiceManager<NullFrameworkLogger, IFrameworkLogger>();
+        dm.createServiceManager<OpenSSLService, ISSL>();
+        dm.createServiceManager<TestService>(Properties{{"KernelOffload", Ichor::v1::make_any<bool>(kernelOffload)}, {"Port", Ichor::v1::make_any<uint16_t>(static_cast<uint16_t>(kernelOffload ? 8443 : 8444))}});
+        queue->start(CaptureSigInt);
+        auto end = std::chrono::steady_clock::now();
+        fmt::println("{} {} TLS ran for {:L} µs with {:L} peak memory usage {:L} MB/s", argv[0], kernelOffload ? "kernel" : "user space", std::chrono::duration_cast<std::chrono::microseconds>(end - start).count(), getPeakRSS(),
+                     std::floor(1'000'000. / static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()) * MESSAGE_COUNT * MESSAGE_SIZE / 1'000'000.));
+    }
+
+    return 0;
+}
+
+#else
+
+int main() {
+    return 0;
+}
+
+#endif
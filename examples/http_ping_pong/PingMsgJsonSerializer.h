@@ -19,24 +19,50 @@ class PingMsgJsonSerializer final : public ISerializer<PingMsg> {
 public:
     std::vector<uint8_t> serialize(PingMsg const &msg) final {
         std::vector<uint8_t> buf;
-        auto err = glz::write_json(msg, buf);
-        if(err) {
-            fmt::println("couldn't serialize {}", glz::nameof(err.ec));
+        if(!serializeInto(msg, buf)) {
             return {};
         }
-        buf.push_back('\0');
         return buf;
     }
+
+    // glaze writes from the start of the buffer, so anything already in it goes through _scratch
+    bool serializeInto(PingMsg const &msg, std::vector<uint8_t> &buffer) final {
+        auto &out = buffer.empty() ? buffer : _scratch;
+        auto err = glz::write_json(msg, out);
+        if(err) {
+            fmt::println("couldn't serialize {}", glz::nameof(err.ec));
+            out.clear();
+            return false;
+        }
+        // the glaze json reader requires null terminated input
+        out.push_back('\0');
+        if(&out == &_scratch) {
+            buffer.insert(buffer.end(), _scratch.begin(), _scratch.end());
+        }
+        return true;
+    }
+
     tl::optional<PingMsg> deserialize(std::span<uint8_t const> stream) final {
         PingMsg msg;
+        if(!deserializeInto(stream, msg)) {
+            return tl::nullopt;
+        }
+
+        return msg;
+    }
+
+    bool deserializeInto(std::span<uint8_t const> stream, PingMsg &msg) final {
         auto err = glz::read_json(msg, stream);
 
         if(err) {
             fmt::print("Glaze error {} at {}\n", (int)err.ec, err.location);
             fmt::print("json {}\n", (char*)stream.data());
-            return tl::nullopt;
+            return false;
         }
 
-        return msg;
+        return true;
     }
+
+private:
+    std::vector<uint8_t> _scratch;
 };
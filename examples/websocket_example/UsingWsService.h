@@ -52,7 +52,12 @@ private:
         ICHOR_LOG_INFO(_logger, "Removed serializer");
     }
 
-    void addDependencyInstance(Ichor::ScopedServiceProxy<IConnectionService*> connectionService, IService&) {
+    void addDependencyInstance(Ichor::ScopedServiceProxy<IConnectionService*> connectionService, IService &isvc) {
+        // plain tcp connections are connection services as well, only the upgraded ones are of interest
+        if(!connectionService->isClient() && !isvc.getProperties().contains("WsHostServiceId")) {
+            return;
+        }
+
         if(connectionService->isClient()) {
             _clientService = std::move(connectionService);
             ICHOR_LOG_INFO(_logger, "Inserted clientService");
@@ -24,12 +24,16 @@
 #include <ichor/event_queues/IOUringQueue.h>
 #include <ichor/services/network/tcp/IOUringTcpConnectionService.h>
 #include <ichor/services/network/tcp/IOUringTcpHostService.h>
+#include <ichor/services/network/http/HttpHostService.h>
+#include <ichor/services/network/ws/WsHostService.h>
+#include <ichor/services/network/ws/WsConnectionService.h>
 
 #define QIMPL IOUringQueue
 #define CONNIMPL IOUringTcpConnectionService
 #define HOSTIMPL IOUringTcpHostService
-#define WSHOSTIMPL
-#define WSCONNIMPL
+#define WSHOSTIMPL WsHostService
+#define WSHOSTINTERFACES IHostService, IWsHostService
+#define WSCONNIMPL WsConnectionService
 #else
 #include <ichor/services/network/boost/WsHostService.h>
 #include <ichor/services/network/boost/WsConnectionService.h>
@@ -37,6 +41,7 @@
 
 #define QIMPL BoostAsioQueue
 #define WSHOSTIMPL Boost::v1::WsHostService
+#define WSHOSTINTERFACES IHostService
 #define WSCONNIMPL Boost::v1::WsConnectionService
 #endif
 
@@ -113,8 +118,9 @@ int main(int argc, char *argv[]) {
 #ifdef URING_EXAMPLE
     dm.createServiceManager<HOSTIMPL, IHostService>(Properties{{"Address", Ichor::v1::make_any<std::string>("127.0.0.1"s)}, {"Port", Ichor::v1::make_any<uint16_t>(static_cast<uint16_t>(8001))}});
     dm.createServiceManager<ClientFactory<CONNIMPL<IClientConnectionService>, IClientConnectionService>, IClientFactory<IClientConnectionService>>();
+    dm.createServiceManager<HttpHostService, IHttpHostService>(Properties{{"Address", Ichor::v1::make_any<std::string>(address)}, {"Port", Ichor::v1::make_any<uint16_t>(static_cast<uint16_t>(8001))}});
 #endif
-    dm.createServiceManager<WSHOSTIMPL, IHostService>(Properties{{"Address", Ichor::v1::make_any<std::string>(address)}, {"Port", Ichor::v1::make_any<uint16_t>(static_cast<uint16_t>(8001))}}, priorityToEnsureHostStartingFirst);
+    dm.createServiceManager<WSHOSTIMPL, WSHOSTINTERFACES>(Properties{{"Address", Ichor::v1::make_any<std::string>(address)}, {"Port", Ichor::v1::make_any<uint16_t>(static_cast<uint16_t>(8001))}}, priorityToEnsureHostStartingFirst);
     dm.createServiceManager<ClientFactory<WSCONNIMPL<IConnectionService>>, IClientFactory<IConnectionService>>();
     dm.createServiceManager<UsingWsService>(Properties{{"Address", Ichor::v1::make_any<std::string>(address)}, {"Port", Ichor::v1::make_any<uint16_t>(static_cast<uint16_t>(8001))}});
     queue->start(CaptureSigInt);
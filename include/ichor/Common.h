@@ -2,6 +2,7 @@
 
 #include <ichor/ConstevalHash.h>
 #include <ichor/stl/Any.h>
+#include <ichor/Properties.h>
 #include <ankerl/unordered_dense.h>
 #include <string_view>
 
@@ -58,8 +59,6 @@ namespace Ichor {
             class Allocator = std::allocator<T>>
     using unordered_set = ankerl::unordered_dense::set<T, Hash, Eq, Allocator>;
 
-    using Properties = unordered_map<std::string, Ichor::v1::any, string_hash, std::equal_to<>>;
-
     inline constexpr bool PreventOthersHandling = false;
     inline constexpr bool AllowOthersHandling = true;
 
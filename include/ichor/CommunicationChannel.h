@@ -1,15 +1,44 @@
 #pragma once
 
 #include <ichor/DependencyManager.h>
+#include <ichor/events/SharedPayloadEvent.h>
+#include <ichor/events/RunFunctionEvent.h>
+#include <ichor/coroutines/Task.h>
+#include <ichor/coroutines/AsyncManualResetEvent.h>
 #include <ichor/stl/RealtimeReadWriteMutex.h>
+#include <ichor/ScopeGuard.h>
 #include <shared_mutex>
 #include <mutex>
+#include <functional>
+#include <type_traits>
 
 #ifdef DEBUG_CHANNEL
 #include <iostream>
 #endif
 
 namespace Ichor {
+    namespace Detail {
+        template <typename T>
+        struct CallResult {
+            using type = T;
+            static constexpr bool isTask = false;
+        };
+
+        template <typename T>
+        struct CallResult<Task<T>> {
+            using type = T;
+            static constexpr bool isTask = true;
+        };
+
+        // Shared by a call and the coroutine awaiting it, so the target never writes into a coroutine frame that may already be gone
+        template <typename T>
+        struct CallState {
+            AsyncManualResetEvent evt{};
+            tl::optional<tl::expected<T, CallError>> result{};
+            bool abandoned{}; // the awaiting coroutine was destroyed, only used on its thread
+        };
+    }
+
     class CommunicationChannel {
     public:
         void addManager(DependencyManager* manager) {
@@ -24,6 +53,8 @@ namespace Ichor {
             _managers.erase(manager->getId());
         }
 
+        /// Thread-safe. Constructs a separate EventT with copies of args for every manager, except the originating one.
+        /// Use broadcastPayload for large messages.
         template <typename EventT, typename... Args>
         requires Derived<EventT, Event>
         void broadcastEvent(DependencyManager &originatingManager, Args&&... args) {
@@ -36,13 +67,36 @@ namespace Ichor {
 #ifdef DEBUG_CHANNEL
                 std::cout << "Inserting event " << typeName<EventT>() << " from manager " << originatingManager->getId() << " into manager " << manager->getId() << std::endl;
 #endif
-                manager->getEventQueue().template pushEvent<EventT>(std::forward<Args>(args)...);
+                // not forwarded, args are used for every manager
+                manager->getEventQueue().template pushEvent<EventT>(args...);
 #ifdef DEBUG_CHANNEL
                 std::cout << "Inserted event " << typeName<EventT>() << " from manager " << originatingManager->getId() << " into manager " << manager->getId() << std::endl;
 #endif
             }
         }
 
+        /// Thread-safe. Constructs PayloadT once and sends every manager, except the originating one, a SharedPayloadEvent<PayloadT> referencing it.
+        /// The payload is never copied and each queue is woken up once, regardless of its size.
+        /// \param originatingService service id passed on as originatingService of the events
+        /// \param args arguments for the PayloadT constructor
+        template <typename PayloadT, typename... Args>
+        void broadcastPayload(DependencyManager &originatingManager, ServiceIdType originatingService, Args&&... args) {
+            broadcastSharedPayload<PayloadT>(originatingManager, originatingService, v1::make_atomic_reference_counted<PayloadT const>(std::forward<Args>(args)...));
+        }
+
+        /// Thread-safe. Same as broadcastPayload, for a payload that has already been constructed or is also kept by the caller.
+        template <typename PayloadT>
+        void broadcastSharedPayload(DependencyManager &originatingManager, ServiceIdType originatingService, v1::AtomicReferenceCountedPointer<PayloadT const> const &payload) {
+            std::shared_lock l(_mutex);
+            for(auto &[key, manager] : _managers) {
+                if(manager->getId() == originatingManager.getId()) {
+                    continue;
+                }
+
+                manager->getEventQueue().template pushEvent<SharedPayloadEvent<PayloadT>>(originatingService, payload);
+            }
+        }
+
         template <typename EventT, typename... Args>
         requires Derived<EventT, Event>
         void sendEventTo(uint64_t id, Args&&... args) {
@@ -59,7 +113,135 @@ namespace Ichor {
 
             manager->second->getEventQueue().pushEvent<EventT>(std::forward<Args>(args)...);
         }
+
+        /*
+         * Calls method on a started service implementing Interface in manager managerId, on the thread of that manager, and resumes the awaiting coroutine on its own thread with the result.
+         * The method may return a value, void or a Task, which is awaited on the target thread. Arguments are copied, so do not pass references to data owned by the caller.
+         *
+         * Calls are not sent one by one. Calls made before the first of them is flushed, by an event with INTERNAL_EVENT_PRIORITY, are sent to the target as a single event, and the results are returned as a single event as well.
+         * Neither the channel nor a queue is locked per call, only per batch.
+         *
+         * Has to be co_awaited from a coroutine on a thread of a manager in this channel, which has to keep running until the call finishes.
+         * Returns CallError::NO_SUCH_MANAGER if managerId is not part of this channel and CallError::NO_SUCH_SERVICE if it has no started Interface.
+         *
+         * auto count = co_await channel.call<ICounter>(otherManagerId, &ICounter::increment, 5);
+         */
+        template <typename Interface, typename Method, typename... Args>
+        requires std::is_member_function_pointer_v<Method>
+        Task<tl::expected<typename Detail::CallResult<std::invoke_result_t<Method, Interface&, std::decay_t<Args>&...>>::type, CallError>> call(uint64_t managerId, Method method, Args&&... args) {
+            using InvokeResult = std::invoke_result_t<Method, Interface&, std::decay_t<Args>&...>;
+            using ResultT = typename Detail::CallResult<InvokeResult>::type;
+
+            if constexpr (Detail::CallResult<InvokeResult>::isTask) {
+                return dispatch<ResultT>(managerId, [method, ...args = std::forward<Args>(args)]() mutable -> Task<tl::expected<ResultT, CallError>> {
+                    auto services = GetThreadLocalManager().template getStartedServices<Interface>();
+                    if(services.empty()) {
+                        co_return tl::unexpected(CallError::NO_SUCH_SERVICE);
+                    }
+                    if constexpr (std::is_void_v<ResultT>) {
+                        co_await std::invoke(method, *services[0], args...);
+                        co_return {};
+                    } else {
+                        co_return co_await std::invoke(method, *services[0], args...);
+                    }
+                });
+            } else {
+                return dispatch<ResultT>(managerId, [method, ...args = std::forward<Args>(args)]() mutable -> tl::expected<ResultT, CallError> {
+                    auto services = GetThreadLocalManager().template getStartedServices<Interface>();
+                    if(services.empty()) {
+                        return tl::unexpected(CallError::NO_SUCH_SERVICE);
+                    }
+                    if constexpr (std::is_void_v<ResultT>) {
+                        std::invoke(method, *services[0], args...);
+                        return {};
+                    } else {
+                        return std::invoke(method, *services[0], args...);
+                    }
+                });
+            }
+        }
+
+        /// Same as call, but runs fn on the thread of manager managerId instead of a method of a service.
+        /// fn may return a value, void or a Task, which is awaited on the target thread.
+        template <typename F>
+        Task<tl::expected<typename Detail::CallResult<std::invoke_result_t<F&>>::type, CallError>> runOn(uint64_t managerId, F fn) {
+            using InvokeResult = std::invoke_result_t<F&>;
+            using ResultT = typename Detail::CallResult<InvokeResult>::type;
+
+            if constexpr (Detail::CallResult<InvokeResult>::isTask) {
+                return dispatch<ResultT>(managerId, [fn = std::move(fn)]() mutable -> Task<tl::expected<ResultT, CallError>> {
+                    if constexpr (std::is_void_v<ResultT>) {
+                        co_await fn();
+                        co_return {};
+                    } else {
+                        co_return co_await fn();
+                    }
+                });
+            } else {
+                return dispatch<ResultT>(managerId, [fn = std::move(fn)]() mutable -> tl::expected<ResultT, CallError> {
+                    if constexpr (std::is_void_v<ResultT>) {
+                        fn();
+                        return {};
+                    } else {
+                        return fn();
+                    }
+                });
+            }
+        }
+
     private:
+        /// fn returns tl::expected<ResultT, CallError> or a Task of it and is run on the thread of managerId
+        template <typename ResultT, typename F>
+        Task<tl::expected<ResultT, CallError>> dispatch(uint64_t managerId, F fn) {
+            uint64_t const originId = GetThreadLocalManager().getId();
+            auto state = std::make_shared<Detail::CallState<ResultT>>();
+            // e.g. the service of the awaiting coroutine stopped, the reply must not resume it anymore
+            ScopeGuard sgAbandon{[state]() {
+                state->abandoned = true;
+            }};
+
+            // result is written on the target thread, it is only read after the reply went through the queue of this thread.
+            enqueueCall(managerId, [this, originId, state, fn = std::move(fn)](bool delivered) mutable {
+                if(!delivered) {
+                    state->result = tl::unexpected(CallError::NO_SUCH_MANAGER);
+                    if(!state->abandoned) {
+                        state->evt.set();
+                    }
+                    return;
+                }
+
+                if constexpr (Detail::CallResult<std::invoke_result_t<F&>>::isTask) {
+                    GetThreadLocalEventQueue().template pushEvent<RunFunctionEventAsync>(ServiceIdType{0}, [this, originId, state, fn = std::move(fn)]() mutable -> AsyncGenerator<IchorBehaviour> {
+                        state->result = co_await fn();
+                        reply(originId, std::move(state));
+                        co_return {};
+                    });
+                } else {
+                    state->result = fn();
+                    reply(originId, std::move(state));
+                }
+            });
+
+            co_await state->evt;
+
+            co_return std::move(*state->result);
+        }
+
+        template <typename ResultT>
+        void reply(uint64_t originId, std::shared_ptr<Detail::CallState<ResultT>> state) {
+            enqueueCall(originId, [state = std::move(state)](bool delivered) {
+                // if the origin manager is gone, so is the awaiting coroutine
+                if(delivered && !state->abandoned) {
+                    state->evt.set();
+                }
+            });
+        }
+
+        /// Not thread-safe, only touches state of the calling thread. Queues fn to be sent to managerId with the next batch.
+        /// fn is called with true on the thread of managerId, or with false on the calling thread if managerId is not part of this channel.
+        void enqueueCall(uint64_t managerId, std::function<void(bool)> fn);
+        void flushCalls(uint64_t managerId);
+
         unordered_map<uint64_t, DependencyManager*> _managers{};
         v1::RealtimeReadWriteMutex _mutex{};
     };
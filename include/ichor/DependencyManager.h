@@ -13,11 +13,13 @@
 #include <ichor/dependency_management/ILifecycleManager.h>
 #include <ichor/dependency_management/DependencyLifecycleManager.h>
 #include <ichor/dependency_management/LifecycleManager.h>
+#include <ichor/dependency_management/ServiceRegistry.h>
 #include <ichor/coroutines/AsyncManualResetEvent.h>
 #include <ichor/Callbacks.h>
 #include <ichor/dependency_management/DependencyRegistrations.h>
 #include <ichor/dependency_management/ConstructorInjectionService.h>
 #include <ichor/dependency_management/DependencyTrackers.h>
+#include <ichor/dependency_management/EventTrace.h>
 #include <ichor/event_queues/IEventQueue.h>
 #include <ichor/stl/ServiceProtectedPointer.h>
 #include <fmt/base.h>
@@ -45,6 +47,33 @@ namespace Ichor {
         static constexpr std::string_view NAME = typeName<InsertServiceEvent>();
     };
 
+    namespace Detail {
+        struct ServiceBatchEntry final {
+            std::unique_ptr<ILifecycleManager> mgr;
+            uint64_t priority;
+        };
+    }
+
+    /// Inserts all services of a ServiceBatch, replaces the InsertServiceEvent, DependencyRequestEvent and StartServiceEvent of every service in it
+    struct InsertServiceBatchEvent final : public Event {
+        InsertServiceBatchEvent(uint64_t _id, ServiceIdType _originatingService, uint64_t _priority, uint64_t _batchId, std::vector<Detail::ServiceBatchEntry> _entries) noexcept : Event(_id, _originatingService, _priority), batchId(_batchId), entries(std::move(_entries)) {}
+        ~InsertServiceBatchEvent() final = default;
+
+        [[nodiscard]] ICHOR_CONST_FUNC_ATTR constexpr std::string_view get_name() const noexcept final {
+            return NAME;
+        }
+        [[nodiscard]] ICHOR_CONST_FUNC_ATTR constexpr NameHashType get_type() const noexcept final {
+            return TYPE;
+        }
+
+        uint64_t batchId;
+        std::vector<Detail::ServiceBatchEntry> entries;
+        static constexpr NameHashType TYPE = typeNameHash<InsertServiceBatchEvent>();
+        static constexpr std::string_view NAME = typeName<InsertServiceBatchEvent>();
+    };
+
+    class ServiceBatch;
+
     struct EventWaiter final {
         explicit EventWaiter(ServiceIdType _waitingSvcId, uint64_t _eventType) : waitingSvcId(_waitingSvcId), eventType(_eventType) {
             events.emplace_back(_eventType, std::make_unique<AsyncManualResetEvent>());
@@ -232,7 +261,7 @@ namespace Ichor {
                 IService const *second{}; // non-owning; never-null when dereferenced via iterator
             };
 
-            using map_type = unordered_map<ServiceIdType, std::unique_ptr<ILifecycleManager>, ServiceIdHash>;
+            using map_type = Detail::ServiceRegistry;
 
             struct iterator {
                 using difference_type = std::ptrdiff_t;
@@ -240,7 +269,7 @@ namespace Ichor {
                 using value_type = ServicesView::value_type;
 
                 iterator() noexcept : _map(nullptr) {}
-                iterator(map_type const *map, map_type::const_iterator it) noexcept : _map(map), _it(it) {
+                iterator(map_type const *map, map_type::iterator it) noexcept : _map(map), _it(it) {
                     advance();
                 }
 
@@ -250,7 +279,7 @@ namespace Ichor {
                 value_type const *operator->() const noexcept { return &_current; }
 
                 iterator &operator++() noexcept {
-                    if (_map != nullptr && _it != _map->cend()) {
+                    if (_map != nullptr && _it != _map->end()) {
                         ++_it;
                         advance();
                     }
@@ -267,14 +296,14 @@ namespace Ichor {
                     if (_map == nullptr) {
                         return;
                     }
-                    if (_it != _map->cend()) {
+                    if (_it != _map->end()) {
                         _current.first = _it->first;
                         _current.second = _it->second->getIService();
                     }
                 }
 
                 map_type const *_map;
-                map_type::const_iterator _it{};
+                map_type::iterator _it{};
                 value_type _current{};
             };
 
@@ -282,13 +311,13 @@ namespace Ichor {
                 if (_map == nullptr) {
                     return iterator{};
                 }
-                return iterator{_map, _map->cbegin()};
+                return iterator{_map, _map->begin()};
             }
             [[nodiscard]] ICHOR_PURE_FUNC_ATTR iterator end() const noexcept {
                 if (_map == nullptr) {
                     return iterator{};
                 }
-                return iterator{_map, _map->cend()};
+                return iterator{_map, _map->end()};
             }
             [[nodiscard]] ICHOR_PURE_FUNC_ATTR bool empty() const noexcept { return begin() == end(); }
 
@@ -418,7 +447,7 @@ namespace Ichor {
             }
 
             uint64_t eventId = _eventQueue->getNextEventId();
-            _eventQueue->pushEventInternal(priority, std::unique_ptr<Event>{new EventT(std::forward<uint64_t>(eventId), std::forward<ServiceIdType>(originatingServiceId), std::forward<uint64_t>(priority), std::forward<Args>(args)...)});
+            _eventQueue->pushEventInternal(priority, IEventQueue::stamp(std::unique_ptr<Event>{new EventT(std::forward<uint64_t>(eventId), std::forward<ServiceIdType>(originatingServiceId), std::forward<uint64_t>(priority), std::forward<Args>(args)...)}));
             auto it = _eventWaiters.emplace(eventId, EventWaiter(originatingServiceId, EventT::TYPE));
             INTERNAL_DEBUG("pushPrioritisedEventAsync {}:{} {} events.size {}", eventId, typeName<EventT>(), originatingServiceId, it.first->second.events.size());
             co_await *it.first->second.events.begin()->second.get();
@@ -682,13 +711,13 @@ namespace Ichor {
             }
             std::vector<v1::NeverNull<Interface*>> ret{};
             std::function<void(v1::NeverNull<void*>, IService&)> f{[&ret](v1::NeverNull<void*> svc2, IService& /*isvc*/){ ret.push_back(reinterpret_cast<Interface*>(svc2.get())); }};
-            for(auto &[key, svc] : _services) {
-                if(svc->getServiceState() != ServiceState::ACTIVE) {
-                    continue;
+            _services.forEachProviding(typeNameHash<Interface>(), [&f](ServiceIdType, ILifecycleManager &svc) {
+                if(svc.getServiceState() != ServiceState::ACTIVE) {
+                    return;
                 }
-                svc->insertSelfInto(typeNameHash<Interface>(), ServiceIdType{0}, f);
-                svc->getDependees().erase(ServiceIdType{0});
-            }
+                svc.insertSelfInto(typeNameHash<Interface>(), ServiceIdType{0}, f);
+                svc.getDependees().erase(ServiceIdType{0});
+            });
 
             return ret;
         }
@@ -708,16 +737,10 @@ namespace Ichor {
             }
             std::vector<std::pair<Interface&, IService&>> ret{};
             std::function<void(v1::NeverNull<void*>, IService&)> f{[&ret](v1::NeverNull<void*> svc2, IService & isvc){ ret.emplace_back(*reinterpret_cast<Interface*>(svc2.get()), isvc); }};
-            for(auto &[key, svc] : _services) {
-                auto intf = std::find_if(svc->getInterfaces().begin(), svc->getInterfaces().end(), [](const Dependency &dep) {
-                    return dep.interfaceNameHash == typeNameHash<Interface>();
-                });
-                if(intf == svc->getInterfaces().end()) {
-                    continue;
-                }
-                svc->insertSelfInto(typeNameHash<Interface>(), ServiceIdType{0}, f);
-                svc->getDependees().erase(ServiceIdType{0});
-            }
+            _services.forEachProviding(typeNameHash<Interface>(), [&f](ServiceIdType, ILifecycleManager &svc) {
+                svc.insertSelfInto(typeNameHash<Interface>(), ServiceIdType{0}, f);
+                svc.getDependees().erase(ServiceIdType{0});
+            });
 
             return ret;
         }
@@ -736,6 +759,17 @@ namespace Ichor {
         /// \return view of [serviceId, service]
         [[nodiscard]] ServicesView getAllServices() const noexcept;
 
+        /// Amount of coroutines that are currently suspended, e.g. waiting on an event or IO.
+        /// Do not use in coroutines or other threads. Not thread-safe.
+        [[nodiscard]] uint64_t getSuspendedCoroutineCount() const noexcept;
+
+        /// Starts recording how long processing events, interceptors, event handlers and coroutine resumptions take, see exportChromeTrace().
+        /// Only the last \p capacity spans are kept. When disabled, the cost is one branch per span.
+        /// Do not use in coroutines or other threads. Not thread-safe.
+        void enableEventTracing(uint64_t capacity = 65'536);
+        /// Stops recording, recorded spans are no longer exported. Do not use in coroutines or other threads. Not thread-safe.
+        void disableEventTracing();
+
         /// Blocks until the queue is empty or the specified timeout has passed.
         /// Mainly useful for tests
         void runForOrQueueEmpty(std::chrono::milliseconds ms = 100ms) const noexcept;
@@ -758,9 +792,25 @@ namespace Ichor {
         /// \return immediately return void if service is already stopped, await if not, WaitError if quitting
         [[nodiscard]] Task<tl::expected<void, WaitError>> waitForServiceStopped(v1::NeverNull<IService*> svc);
 
+        /// Creates an empty batch. Services created through the batch are only known to this manager once the batch is passed to insertServiceBatch().
+        /// Same threading rules as createServiceManager().
+        [[nodiscard]] ServiceBatch createServiceBatch() noexcept;
+
+        /// Inserts all services of the batch with a single event. Services in the batch are injected into each other and started in dependency order while handling that event,
+        /// instead of through an InsertServiceEvent, StartServiceEvent and DependencyOnlineEvent each. Interceptors therefore see one InsertServiceBatchEvent instead.
+        /// Services that start asynchronously, or that wait for a service outside the batch, continue through the regular events.
+        /// Services are started in layers, a layer being the services whose providers in the batch are all in earlier layers. Services of a layer with the PropertyKeys::ParallelStart
+        /// property run start() up to its first suspension concurrently on an active IWorkerPool, which may be part of the batch, joining back before the next layer starts.
+        /// Until then their start() must not touch other services or this manager.
+        /// A ServiceBatchStartedEvent with the id of the batch is pushed once every service in the batch has started or was removed.
+        /// Same threading rules as createServiceManager().
+        /// \param batch
+        /// \return id of the batch, as in ServiceBatchStartedEvent
+        uint64_t insertServiceBatch(ServiceBatch &&batch);
+
     private:
         template<typename Impl, typename ReturnImpl, typename... Interfaces>
-        v1::ServiceProtectedPointer<ReturnImpl> internalCreateServiceManager(Properties&& properties, uint64_t priority = INTERNAL_EVENT_PRIORITY) {
+        v1::ServiceProtectedPointer<ReturnImpl> internalCreateServiceManager(Properties&& properties, uint64_t priority = INTERNAL_EVENT_PRIORITY, std::vector<Detail::ServiceBatchEntry> *batch = nullptr) {
             if constexpr (DO_INTERNAL_DEBUG || DO_HARDENING) {
                 if (_started.load(std::memory_order_acquire) && this != Detail::_local_dm) [[unlikely]] {
                     ICHOR_EMERGENCY_LOG1(_logger, "Function called from wrong thread.");
@@ -792,20 +842,25 @@ namespace Ichor {
 
                 Impl* impl = &cmpMgr->getService();
                 DependencyRegister const *reg = cmpMgr->getDependencyRegistry();
-                // Can't directly emplace mgr into _services as that would result into modifying the container while iterating.
-                _eventQueue->pushPrioritisedEvent<InsertServiceEvent>(serviceId, std::min(INTERNAL_INSERT_SERVICE_EVENT_PRIORITY, priority), std::move(cmpMgr));
-
-                bool startImmediately = true;
-                for (auto const &[key, registration] : reg->_registrations) {
-                    auto const &props = std::get<tl::optional<Properties>>(registration);
-                    if((std::get<Dependency>(registration).flags & DependencyFlags::REQUIRED) == DependencyFlags::REQUIRED) {
-                        startImmediately = false;
+                if(batch != nullptr) {
+                    // requested and started by the InsertServiceBatchEvent
+                    batch->emplace_back(std::move(cmpMgr), priority);
+                } else {
+                    // Can't directly emplace mgr into _services as that would result into modifying the container while iterating.
+                    _eventQueue->pushPrioritisedEvent<InsertServiceEvent>(serviceId, std::min(INTERNAL_INSERT_SERVICE_EVENT_PRIORITY, priority), std::move(cmpMgr));
+
+                    bool startImmediately = true;
+                    for (auto const &[key, registration] : reg->_registrations) {
+                        auto const &props = std::get<tl::optional<Properties>>(registration);
+                        if((std::get<Dependency>(registration).flags & DependencyFlags::REQUIRED) == DependencyFlags::REQUIRED) {
+                            startImmediately = false;
+                        }
+                        _eventQueue->pushPrioritisedEvent<DependencyRequestEvent>(serviceId, event_priority, std::get<Dependency>(registration), props.has_value() ? &props.value() : tl::optional<Properties const *>{});
                     }
-                    _eventQueue->pushPrioritisedEvent<DependencyRequestEvent>(serviceId, event_priority, std::get<Dependency>(registration), props.has_value() ? &props.value() : tl::optional<Properties const *>{});
-                }
 
-                if(startImmediately) {
-                    _eventQueue->pushPrioritisedEvent<StartServiceEvent>(serviceId, event_priority, serviceId);
+                    if(startImmediately) {
+                        _eventQueue->pushPrioritisedEvent<StartServiceEvent>(serviceId, event_priority, serviceId);
+                    }
                 }
 
                 if constexpr(IsConstructorInjector<Impl>) {
@@ -837,10 +892,14 @@ namespace Ichor {
                 }
 
                 Impl* impl = &cmpMgr->getService();
-                _eventQueue->pushPrioritisedEvent<InsertServiceEvent>(serviceId, std::min(INTERNAL_INSERT_SERVICE_EVENT_PRIORITY, priority), std::move(cmpMgr));
+                if(batch != nullptr) {
+                    batch->emplace_back(std::move(cmpMgr), priority);
+                } else {
+                    _eventQueue->pushPrioritisedEvent<InsertServiceEvent>(serviceId, std::min(INTERNAL_INSERT_SERVICE_EVENT_PRIORITY, priority), std::move(cmpMgr));
 
-                auto event_priority = std::min(INTERNAL_DEPENDENCY_EVENT_PRIORITY, priority);
-                _eventQueue->pushPrioritisedEvent<StartServiceEvent>(serviceId, event_priority, serviceId);
+                    auto event_priority = std::min(INTERNAL_DEPENDENCY_EVENT_PRIORITY, priority);
+                    _eventQueue->pushPrioritisedEvent<StartServiceEvent>(serviceId, event_priority, serviceId);
+                }
 
                 if constexpr(IsConstructorInjector<Impl>) {
                     return v1::ServiceProtectedPointer{static_cast<IService*>(impl)};
@@ -858,7 +917,7 @@ namespace Ichor {
         /// \param id
         template <typename Impl, typename Interface1, typename Interface2, typename... Interfaces>
         void logAddService(ServiceIdType id) {
-            if(_logger != nullptr && _logger->getLogLevel() <= LogLevel::LOG_DEBUG) {
+            if(MIN_LOG_LEVEL <= LogLevel::LOG_DEBUG && _logger != nullptr && _logger->getLogLevel() <= LogLevel::LOG_DEBUG) {
                 std::string out;
                 fmt::format_to(std::back_inserter(out), "added ServiceManager<{}, {}, ", typeName<Interface1>(), typeName<Interface2>());
                 (fmt::format_to(std::back_inserter(out), "{}, ", typeName<Interfaces>()), ...);
@@ -873,7 +932,7 @@ namespace Ichor {
         /// \param id
         template <typename Impl, typename Interface>
         void logAddService(ServiceIdType id) {
-            if(_logger != nullptr && _logger->getLogLevel() <= LogLevel::LOG_DEBUG) {
+            if(MIN_LOG_LEVEL <= LogLevel::LOG_DEBUG && _logger != nullptr && _logger->getLogLevel() <= LogLevel::LOG_DEBUG) {
                 ICHOR_LOG_DEBUG(_logger, "added ServiceManager<{}, {}> {}", typeName<Interface>(), typeName<Impl>(), id);
             }
         }
@@ -883,7 +942,7 @@ namespace Ichor {
         /// \param id
         template <typename Impl>
         void logAddService(ServiceIdType id) {
-            if(_logger != nullptr && _logger->getLogLevel() <= LogLevel::LOG_DEBUG) {
+            if(MIN_LOG_LEVEL <= LogLevel::LOG_DEBUG && _logger != nullptr && _logger->getLogLevel() <= LogLevel::LOG_DEBUG) {
                 ICHOR_LOG_DEBUG(_logger, "added ServiceManager<{}> {}", typeName<Impl>(), id);
             }
         }
@@ -925,6 +984,45 @@ namespace Ichor {
         bool finishWaitingService(ServiceIdType serviceId, uint64_t eventType, [[maybe_unused]] std::string_view eventName) noexcept;
         void checkIfCanQuit(std::vector<EventInterceptInfo> &allEventInterceptorsCopy, std::vector<EventInterceptInfo> &eventInterceptorsCopy) noexcept;
         bool hasDependencyWaiter(ServiceIdType serviceId, uint64_t eventType) noexcept;
+        /// Injects the IService of mgr and the active services mgr depends on into mgr, which starts mgr once its required dependencies are satisfied.
+        /// \return true if mgr started synchronously and still has to go online
+        bool injectDependenciesInto(ILifecycleManager &mgr, Event const &evt);
+        /// Starts mgr after dependencyOnline() returned StartBehaviour::STARTED
+        /// \return true if mgr started synchronously and still has to go online, if mgr suspended a DependencyOnlineEvent is pushed when it finishes
+        bool startAfterDependencyOnline(ILifecycleManager &mgr, Event const &evt);
+        /// Remainder of the DependencyOnlineEvent once mgr is ACTIVE: resumes waiters and injects mgr into the services depending on it.
+        /// \param pendingBatchMembers services of the batch being inserted that have not been started yet, with their index in the batch. Skipped as they inject their dependencies themselves
+        void serviceOnline(ILifecycleManager &mgr, Event const &evt, unordered_map<ServiceIdType, uint32_t, ServiceIdHash> const *pendingBatchMembers);
+        void handleInsertServiceBatch(InsertServiceBatchEvent &evt);
+        /// Starts services of the batch that don't depend on each other. Those with PropertyKeys::ParallelStart begin their start concurrently on an active IWorkerPool, if there is one.
+        void startBatchLayer(std::span<uint32_t const> layer, std::span<ILifecycleManager * const> members, InsertServiceBatchEvent &evt, unordered_map<ServiceIdType, uint32_t, ServiceIdHash> &pendingMembers);
+        /// Injects and starts a service of the batch, as its InsertServiceEvent and StartServiceEvent would have.
+        /// \return true if mgr started synchronously and still has to go online
+        bool startBatchMember(ILifecycleManager &mgr, Event const &evt, uint64_t priority);
+        /// Records the start of mgr in _deferredStarts instead of beginning it, once per service
+        void deferStart(ILifecycleManager &mgr, uint64_t eventPriority, bool afterDependencyOnline);
+        void finishStartingBatchMember(ServiceIdType serviceId);
+        [[nodiscard]] v1::TraceScope traceScope(v1::TraceSpanKind kind, Event const &evt, ServiceIdType serviceId) const noexcept {
+            if(_traceRing == nullptr) [[likely]] {
+                return {};
+            }
+            return startTraceScope(kind, evt, serviceId);
+        }
+        [[nodiscard]] v1::TraceScope startTraceScope(v1::TraceSpanKind kind, Event const &evt, ServiceIdType serviceId) const noexcept;
+        /// Keeps the current ring alive until the event being processed is done, spans of that event may still be writing to it
+        void retireTraceRing();
+
+        /// A start recorded by deferStart(), begun on the worker pool by startBatchLayer()
+        struct DeferredStart final {
+            ILifecycleManager *mgr;
+            AsyncGenerator<StartBehaviour> gen;
+            uint64_t eventPriority;
+            bool afterDependencyOnline; // continue as DependencyOnlineEvent instead of StartServiceEvent
+            bool finished{};
+            bool hasSuspended{};
+            uint64_t promiseId{};
+            StartBehaviour value{};
+        };
 
         struct [[nodiscard]] ScopedGenerator final {
             std::unique_ptr<IGenerator> generator;
@@ -933,7 +1031,7 @@ namespace Ichor {
             ScopedGenerator(std::unique_ptr<IGenerator> _generator, v1::ReferenceCountedPointer<Event> _event) : generator(std::move(_generator)), event(_event) {}
         };
 
-        unordered_map<ServiceIdType, std::unique_ptr<ILifecycleManager>, ServiceIdHash> _services{}; // key = service id
+        Detail::ServiceRegistry _services{};
         unordered_map<DependencyTrackerKey, std::vector<DependencyTrackerInfo>, DependencyTrackerKeyHash, std::equal_to<>> _dependencyRequestTrackers{}; // key = interface name hash
         unordered_map<uint64_t, std::vector<EventCallbackInfo>> _eventCallbacks{}; // key = event id
         unordered_map<uint64_t, std::vector<EventInterceptInfo>> _eventInterceptors{}; // key = event id
@@ -943,12 +1041,18 @@ namespace Ichor {
         unordered_map<ServiceIdType, EventWaiter, ServiceIdHash> _dependencyWaiters{}; // key = service id
         unordered_map<ServiceIdType, WaitingStopService, ServiceIdHash> _pendingStopsDueToCoroutine{}; // key = service which has to be stopped but has existing coroutines
         unordered_map<ServiceIdType, std::vector<WaitingStopService>, ServiceIdHash> _pendingStopsDueToDependencies{}; // key = service which others are waiting on to be stopped
+        unordered_map<uint64_t, uint64_t> _startingBatches{}; // key = batch id, value = amount of services in the batch that have not started yet
+        unordered_map<ServiceIdType, uint64_t, ServiceIdHash> _startingBatchMembers{}; // value = batch id
         IEventQueue * const _eventQueue;
         IFrameworkLogger *_logger{};
         std::atomic<bool> _started{false};
         CommunicationChannel *_communicationChannel{};
+        std::shared_ptr<v1::EventTraceRing> _traceRing{};
+        std::vector<std::shared_ptr<v1::EventTraceRing>> _retiredTraceRings{}; // replaced or disabled during an event, freed by a later event
+        std::vector<DeferredStart> *_deferredStarts{}; // set while injecting the services of a batch layer that start in parallel
         uint64_t _id{_managerIdCounter.fetch_add(1, std::memory_order_relaxed)};
         uint64_t _intercepterIdCounter{1};
+        uint64_t _batchIdCounter{1};
         bool _quitEventReceived{};
         bool _quitDone{};
         constinit static std::atomic<uint64_t> _managerIdCounter;
@@ -956,6 +1060,56 @@ namespace Ichor {
         friend class IEventQueue;
         friend class ILifecycleManager;
         friend class CommunicationChannel;
+        friend class ServiceBatch;
+    };
+
+    /// Services to insert into a DependencyManager together, see DependencyManager::insertServiceBatch()
+    /// auto batch = dm.createServiceBatch();
+    /// batch.createServiceManager<MyService, IMyService>(Properties{...});
+    /// dm.insertServiceBatch(std::move(batch));
+    class [[nodiscard]] ServiceBatch final {
+    public:
+        ServiceBatch(ServiceBatch const &) = delete;
+        ServiceBatch(ServiceBatch &&) noexcept = default;
+        ServiceBatch& operator=(ServiceBatch const &) = delete;
+        ServiceBatch& operator=(ServiceBatch &&) noexcept = default;
+
+        /// Same as DependencyManager::createServiceManager(), except that the service is only inserted with the batch
+        template<DerivedTemplated<AdvancedService> Impl, typename... Interfaces>
+        // msvc compiler bug, see https://developercommunity.visualstudio.com/t/c20-Friend-definition-of-class-with-re/10197302
+#if (!defined(WIN32) && !defined(_WIN32) && !defined(__WIN32)) || defined(__CYGWIN__)
+        requires ImplementsAll<Impl, Interfaces...>
+#endif
+        v1::ServiceProtectedPointer<Impl> createServiceManager(Properties&& properties = {}, uint64_t priority = INTERNAL_EVENT_PRIORITY) {
+            return _dm->internalCreateServiceManager<Impl, Impl, Interfaces...>(std::move(properties), priority, &_entries);
+        }
+
+        /// Same as DependencyManager::createServiceManager(), except that the service is only inserted with the batch
+        template<typename Impl, typename... Interfaces>
+        // msvc compiler bug, see https://developercommunity.visualstudio.com/t/c20-Friend-definition-of-class-with-re/10197302
+#if (!defined(WIN32) && !defined(_WIN32) && !defined(__WIN32)) || defined(__CYGWIN__)
+        requires ImplementsAll<Impl, Interfaces...>
+#endif
+        v1::ServiceProtectedPointer<IService> createServiceManager(Properties&& properties = {}, uint64_t priority = INTERNAL_EVENT_PRIORITY) {
+            return _dm->internalCreateServiceManager<ConstructorInjectionService<Impl>, IService, Interfaces...>(std::move(properties), priority, &_entries);
+        }
+
+        [[nodiscard]] ICHOR_PURE_FUNC_ATTR uint64_t getId() const noexcept {
+            return _id;
+        }
+
+        [[nodiscard]] ICHOR_PURE_FUNC_ATTR size_t size() const noexcept {
+            return _entries.size();
+        }
+
+    private:
+        ServiceBatch(DependencyManager *dm, uint64_t id) noexcept : _dm(dm), _id(id) {}
+
+        DependencyManager *_dm;
+        uint64_t _id;
+        std::vector<Detail::ServiceBatchEntry> _entries{};
+
+        friend class DependencyManager;
     };
 
 
@@ -81,6 +81,11 @@ namespace Ichor
         FAILED
     };
 
+    enum class CallError : uint_fast16_t {
+        NO_SUCH_MANAGER, // the target manager is not (or no longer) part of the communication channel
+        NO_SUCH_SERVICE, // the target manager has no started service implementing the interface
+    };
+
     // Necessary to prevent excessive events on the queue.
     // Every async call using this will end up adding an event to the queue on co_return/co_yield.
     enum class IchorBehaviour : uint_fast16_t {
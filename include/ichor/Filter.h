@@ -2,14 +2,48 @@
 
 #include <ichor/Common.h>
 #include <ichor/stl/ReferenceCountedPointer.h>
+#include <tl/optional.h>
+#include <functional>
 #include <string>
 
 namespace Ichor {
 
+    /// What a filter entry matches, in a form the DependencyManager can index services on, so that it only has to evaluate the filter against candidates that can match.
+    /// Filter entries can provide one through `FilterIndexKey indexKey() const noexcept`, entries that do not are evaluated against every candidate.
+    struct FilterIndexKey final {
+        enum class Kind : uint8_t {
+            NONE,
+            SERVICE_ID, // matches the service with id value
+            PROPERTY, // matches services with property nameHash of type typeHash whose hash is value
+        };
+
+        Kind kind{Kind::NONE};
+        uint64_t value{};
+        uint64_t nameHash{};
+        uint64_t typeHash{};
+        /// PROPERTY only, hashes a property of a candidate the same way value was hashed, nullopt if it is not of type typeHash
+        tl::optional<uint64_t> (*hashProperty)(v1::any const &) noexcept{};
+    };
+
+    namespace Detail {
+        template <typename T>
+        concept HashableFilterValue = requires(T const &t) {
+            { std::hash<T>{}(t) } -> std::convertible_to<std::size_t>;
+        };
+
+        template <HashableFilterValue T>
+        [[nodiscard]] tl::optional<uint64_t> hashFilterProperty(v1::any const &value) noexcept {
+            if(value.type_hash() != typeNameHash<T>()) {
+                return tl::nullopt;
+            }
+            return std::hash<T>{}(Ichor::v1::any_cast<T const &>(value));
+        }
+    }
+
     template <typename T, bool MissingOk>
     class PropertiesFilterEntry final {
     public:
-        PropertiesFilterEntry(std::string_view _key, T _val) noexcept : key(_key), val(std::move(_val)) {}
+        PropertiesFilterEntry(PropertyName _key, T _val) noexcept : key(_key), val(std::move(_val)) {}
 
         [[nodiscard]] bool matches(ILifecycleManager const &manager) const noexcept {
             auto const propVal = manager.getProperties().find(key);
@@ -25,20 +59,25 @@ namespace Ichor {
             return Ichor::v1::any_cast<T const &>(propVal->second) == val;
         }
 
+        // services without the property match as well if MissingOk, those cannot be looked up by value
+        [[nodiscard]] FilterIndexKey indexKey() const noexcept requires (!MissingOk && Detail::HashableFilterValue<T>) {
+            return FilterIndexKey{FilterIndexKey::Kind::PROPERTY, std::hash<T>{}(val), key.hash(), typeNameHash<T>(), &Detail::hashFilterProperty<T>};
+        }
+
         [[nodiscard]] std::string getDescription() const noexcept {
             std::string s;
             fmt::format_to(std::back_inserter(s), "PropertiesFilterEntry {}:{}", key, val);
             return s;
         }
 
-        std::string_view key;
+        PropertyName key;
         T val;
     };
 
     template <typename DepT, typename PropT, bool MissingOk>
     class DependencyPropertiesFilterEntry final {
     public:
-        DependencyPropertiesFilterEntry(std::string_view _key, PropT _val) noexcept : key(_key), val(std::move(_val)) {}
+        DependencyPropertiesFilterEntry(PropertyName _key, PropT _val) noexcept : key(_key), val(std::move(_val)) {}
 
         [[nodiscard]] bool matches(ILifecycleManager const &manager) const noexcept {
             auto registry = manager.getDependencyRegistry();
@@ -78,7 +117,7 @@ namespace Ichor {
             return s;
         }
 
-        std::string_view key;
+        PropertyName key;
         PropT val;
     };
 
@@ -90,6 +129,10 @@ namespace Ichor {
             return manager.serviceId() == id;
         }
 
+        [[nodiscard]] FilterIndexKey indexKey() const noexcept {
+            return FilterIndexKey{FilterIndexKey::Kind::SERVICE_ID, id.value};
+        }
+
         [[nodiscard]] std::string getDescription() const noexcept {
             std::string s;
             fmt::format_to(std::back_inserter(s), "ServiceIdFilterEntry {}", id);
@@ -104,6 +147,7 @@ namespace Ichor {
         virtual ~ITemplatedFilter() noexcept = default;
         [[nodiscard]] virtual bool compareTo(ILifecycleManager const &manager) const noexcept = 0;
         [[nodiscard]] virtual std::string getDescription() const noexcept = 0;
+        [[nodiscard]] virtual FilterIndexKey indexKey() const noexcept = 0;
     };
 
     template <typename T>
@@ -125,6 +169,14 @@ namespace Ichor {
             return entry.getDescription();
         }
 
+        [[nodiscard]] FilterIndexKey indexKey() const noexcept final {
+            if constexpr (requires { { entry.indexKey() } -> std::same_as<FilterIndexKey>; }) {
+                return entry.indexKey();
+            } else {
+                return {};
+            }
+        }
+
     private:
         T entry;
     };
@@ -148,8 +200,18 @@ namespace Ichor {
             return _templatedFilter->getDescription();
         }
 
+        /// Kind::NONE if the filter can only be evaluated through compareTo
+        [[nodiscard]] FilterIndexKey indexKey() const noexcept {
+            return _templatedFilter->indexKey();
+        }
+
         v1::ReferenceCountedPointer<ITemplatedFilter> _templatedFilter;
     };
+
+    namespace PropertyKeys {
+        /// Restricts which services a service is injected into, checked by the DependencyManager for every service that would otherwise receive it
+        inline constexpr PropertyKey<Ichor::Filter> Filter{"Filter"};
+    }
 }
 
 template <>
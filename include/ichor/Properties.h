@@ -0,0 +1,257 @@
+#pragma once
+
+#include <ichor/stl/Any.h>
+#include <cstdint>
+#include <initializer_list>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace Ichor {
+    /// FNV-1a, so that names hash the same at compile time and at runtime
+    [[nodiscard]] ICHOR_CONST_FUNC_ATTR constexpr uint64_t propertyNameHash(std::string_view name) noexcept {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for(char const c : name) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    class PropertyName;
+
+    namespace Detail {
+        /// Copies the name into a process-wide table, so that it can be referred to from any Properties for the rest of the program.
+        /// Thread-safe, each distinct name is only stored once.
+        [[nodiscard]] PropertyName internPropertyName(PropertyName name);
+
+        /// Prints that a typed get() found name with another type than requested. Only called in debug and hardening builds.
+        void warnPropertyTypeMismatch(PropertyName const &name, std::string_view storedType, std::string_view requestedType) noexcept;
+    }
+
+    /// Name of a property. Two names are equal if their hashes are, comparing them does not touch the characters.
+    /// Names created from string literals are hashed at compile time and refer to the literal.
+    /// Names created from any other string only refer to that string, Properties copies them into the table of Detail::internPropertyName on insertion.
+    class PropertyName final {
+    public:
+        template <std::size_t N>
+        consteval PropertyName(char const (&name)[N]) noexcept : PropertyName(std::string_view{name, N - 1}, true) {}
+
+        template <typename StringT>
+        requires (std::is_convertible_v<StringT const &, std::string_view> && !std::is_array_v<StringT>)
+        constexpr PropertyName(StringT const &name) noexcept : PropertyName(std::string_view{name}, false) {}
+
+        [[nodiscard]] constexpr std::string_view name() const noexcept {
+            return {_name, _size};
+        }
+
+        [[nodiscard]] constexpr uint64_t hash() const noexcept {
+            return _hash;
+        }
+
+        /// \return true if the characters outlive any Properties, either because the name was created from a literal or by Detail::internPropertyName
+        [[nodiscard]] constexpr bool interned() const noexcept {
+            return _interned;
+        }
+
+        [[nodiscard]] friend constexpr bool operator==(PropertyName const &a, PropertyName const &b) noexcept {
+            return a._hash == b._hash;
+        }
+
+    private:
+        friend PropertyName Detail::internPropertyName(PropertyName name);
+
+        constexpr PropertyName(std::string_view name, bool interned) noexcept : _name(name.data()), _hash(propertyNameHash(name)), _size(static_cast<uint32_t>(name.size())), _interned(interned) {}
+
+        char const *_name;
+        uint64_t _hash;
+        uint32_t _size;
+        bool _interned;
+    };
+
+    /// Compile-time property name that also carries the type of the value, for use with Properties::get and Properties::set.
+    /// inline constexpr PropertyKey<uint16_t> PortProperty{"Port"};
+    template <typename T>
+    class PropertyKey final {
+    public:
+        using value_type = T;
+
+        template <std::size_t N>
+        consteval PropertyKey(char const (&name)[N]) noexcept : _name(name) {}
+
+        [[nodiscard]] constexpr PropertyName const &name() const noexcept {
+            return _name;
+        }
+
+        constexpr operator PropertyName const &() const noexcept {
+            return _name;
+        }
+
+    private:
+        PropertyName _name;
+    };
+
+    struct PropertyEntry final {
+        PropertyName first;
+        v1::any second;
+    };
+
+    /// Properties of a service: a flat map from PropertyName to any, all entries are stored inline in a single allocation.
+    /// Empty Properties do not allocate and are as small as a vector, as there are a lot of them (e.g. in every dependency registration).
+    /// Lookups compare hashes of names only, typed keys are hashed at compile time.
+    /// Supports the subset of the unordered_map interface that was used when Properties was one, so string keys keep working.
+    /// Erasing moves the last entry into the erased slot, iteration order is unspecified.
+    class Properties final {
+    public:
+        using value_type = PropertyEntry;
+        using iterator = value_type*;
+        using const_iterator = value_type const*;
+        using size_type = std::size_t;
+
+        static constexpr uint32_t INITIAL_CAPACITY = 2;
+
+        Properties() noexcept = default;
+        Properties(std::initializer_list<value_type> entries);
+        Properties(Properties const &o);
+        Properties(Properties &&o) noexcept;
+        Properties& operator=(Properties const &o);
+        Properties& operator=(Properties &&o) noexcept;
+        ~Properties();
+
+        [[nodiscard]] iterator find(PropertyName key) noexcept {
+            return findByHash(key.hash());
+        }
+
+        [[nodiscard]] const_iterator find(PropertyName key) const noexcept {
+            return findByHash(key.hash());
+        }
+
+        /// For callers that only kept the PropertyName::hash() of a name
+        [[nodiscard]] iterator findByHash(uint64_t nameHash) noexcept {
+            for(uint32_t i = 0; i < _size; i++) {
+                if(_data[i].first.hash() == nameHash) {
+                    return _data + i;
+                }
+            }
+            return end();
+        }
+
+        [[nodiscard]] const_iterator findByHash(uint64_t nameHash) const noexcept {
+            return const_cast<Properties*>(this)->findByHash(nameHash);
+        }
+
+        [[nodiscard]] bool contains(PropertyName key) const noexcept {
+            return find(key) != end();
+        }
+
+        /// Constructs the value from args if key is not present yet
+        template <typename... Args>
+        std::pair<iterator, bool> emplace(PropertyName key, Args&&... args) {
+            if(auto it = find(key); it != end()) {
+                return {it, false};
+            }
+            return {append(key, v1::any(std::forward<Args>(args)...)), true};
+        }
+
+        std::pair<iterator, bool> insert_or_assign(PropertyName key, v1::any value) {
+            if(auto it = find(key); it != end()) {
+                it->second = std::move(value);
+                return {it, false};
+            }
+            return {append(key, std::move(value)), true};
+        }
+
+        /// Inserts an empty any if key is not present yet
+        v1::any& operator[](PropertyName key) {
+            return emplace(key).first->second;
+        }
+
+        /// \return 1 if key was present, 0 otherwise
+        size_type erase(PropertyName key) noexcept {
+            auto it = find(key);
+            if(it == end()) {
+                return 0;
+            }
+            erase(it);
+            return 1;
+        }
+
+        /// \return iterator to the entry that took the place of the erased one
+        iterator erase(const_iterator it) noexcept;
+
+        void clear() noexcept;
+        void reserve(size_type capacity);
+
+        [[nodiscard]] size_type size() const noexcept {
+            return _size;
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            return _size == 0;
+        }
+
+        /// \return the value of key, or nullptr if not present or not a T. Debug and hardening builds print a warning for the latter.
+        template <typename T>
+        [[nodiscard]] T const *get(PropertyKey<T> const &key) const noexcept {
+            auto it = find(key.name());
+            if(it == end()) {
+                return nullptr;
+            }
+            if(it->second.type_hash() != typeNameHash<T>()) [[unlikely]] {
+                if constexpr (DO_INTERNAL_DEBUG || DO_HARDENING) {
+                    Detail::warnPropertyTypeMismatch(key.name(), it->second.type_name(), typeName<T>());
+                }
+                return nullptr;
+            }
+            return it->second.template any_cast_ptr<T*>();
+        }
+
+        template <typename T>
+        [[nodiscard]] T *get(PropertyKey<T> const &key) noexcept {
+            return const_cast<T*>(std::as_const(*this).get(key));
+        }
+
+        /// Inserts or replaces the value of key with a T constructed from args. T requires an fmt::formatter, as with v1::make_any.
+        template <typename T, typename... Args>
+        T& set(PropertyKey<T> const &key, Args&&... args) {
+            auto it = insert_or_assign(key.name(), v1::make_any<T>(std::forward<Args>(args)...)).first;
+            return *it->second.template any_cast_ptr<T*>();
+        }
+
+        [[nodiscard]] iterator begin() noexcept { return _data; }
+        [[nodiscard]] iterator end() noexcept { return _data + _size; }
+        [[nodiscard]] const_iterator begin() const noexcept { return _data; }
+        [[nodiscard]] const_iterator end() const noexcept { return _data + _size; }
+        [[nodiscard]] const_iterator cbegin() const noexcept { return _data; }
+        [[nodiscard]] const_iterator cend() const noexcept { return _data + _size; }
+
+        friend iterator begin(Properties &p) noexcept { return p.begin(); }
+        friend iterator end(Properties &p) noexcept { return p.end(); }
+        friend const_iterator begin(Properties const &p) noexcept { return p.begin(); }
+        friend const_iterator end(Properties const &p) noexcept { return p.end(); }
+        friend const_iterator cbegin(Properties const &p) noexcept { return p.cbegin(); }
+        friend const_iterator cend(Properties const &p) noexcept { return p.cend(); }
+
+    private:
+        iterator append(PropertyName key, v1::any &&value);
+        void reallocate(uint32_t capacity);
+        void release() noexcept;
+        void moveFrom(Properties &o) noexcept;
+
+        value_type *_data{};
+        uint32_t _size{};
+        uint32_t _capacity{};
+    };
+}
+
+template <>
+struct fmt::formatter<Ichor::PropertyName> {
+    constexpr auto parse(format_parse_context& ctx) {
+        return ctx.end();
+    }
+
+    template <typename FormatContext>
+    auto format(const Ichor::PropertyName& name, FormatContext& ctx) const {
+        return fmt::format_to(ctx.out(), "{}", name.name());
+    }
+};
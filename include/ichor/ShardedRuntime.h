@@ -0,0 +1,124 @@
+#pragma once
+
+#include <ichor/DependencyManager.h>
+#include <ichor/CommunicationChannel.h>
+#include <functional>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace Ichor {
+    /// Thread-per-core runtime: one event queue and DependencyManager per shard, each running on its own thread and connected through a CommunicationChannel.
+    /// The same services are deployed as replicas on every shard. Replicas share nothing, work for a connection, tenant or any other key is routed to the shard owning that key.
+    ///
+    /// ShardedRuntime runtime{std::thread::hardware_concurrency()};
+    /// runtime.deployReplicas<LoggerFactory<CoutLogger>, ILoggerFactory>();
+    /// runtime.deployReplicas<SessionService, ISessionService>();
+    /// runtime.start();
+    /// runtime.pushEventToShard<RunFunctionEvent>(tenantId, ServiceIdType{0}, [](){ ... });
+    class ShardedRuntime final {
+    public:
+        /// Creates the queue of a shard. Called on the thread of that shard, so queues that have to be set up on their own thread (e.g. IOUringQueue::createEventLoop) can do so here.
+        using QueueFactory = std::function<std::unique_ptr<IEventQueue>(uint32_t shard)>;
+        using Deployment = std::function<void(DependencyManager &dm, uint32_t shard)>;
+
+        /// \param shardCount amount of shards and thus threads, at least 1
+        /// \param queueFactory creates the queue for each shard, defaults to a PriorityQueue
+        explicit ShardedRuntime(uint32_t shardCount, QueueFactory queueFactory = {});
+        ShardedRuntime(ShardedRuntime const &) = delete;
+        ShardedRuntime(ShardedRuntime &&) = delete;
+        ShardedRuntime& operator=(ShardedRuntime const &) = delete;
+        ShardedRuntime& operator=(ShardedRuntime &&) = delete;
+        /// Stops all shards and waits for their threads
+        ~ShardedRuntime();
+
+        /// Not thread-safe, call before start(). fn is called on the thread of every shard, before its queue starts, to create the services of that shard.
+        void deploy(Deployment fn);
+
+        /// Not thread-safe, call before start(). Creates one replica of ImplT on every shard, each with a copy of properties.
+        template<typename ImplT, typename... Interfaces>
+        void deployReplicas(Properties properties = {}) {
+            deploy([properties = std::move(properties)](DependencyManager &dm, uint32_t) {
+                dm.createServiceManager<ImplT, Interfaces...>(Properties{properties});
+            });
+        }
+
+        /// Starts a thread per shard and returns once every shard has its queue and DependencyManager, after which the other functions can be used from any thread.
+        void start(bool captureSigInt = DoNotCaptureSigInt);
+
+        /// Thread-safe. Pushes a QuitEvent into every shard.
+        void stop();
+
+        /// Waits until every shard has stopped
+        void join();
+
+        [[nodiscard]] uint32_t shardCount() const noexcept {
+            return static_cast<uint32_t>(_queues.size());
+        }
+
+        /// Thread-safe. Maps a key to a shard. The same key always maps to the same shard for a given shard count.
+        [[nodiscard]] uint32_t shardFor(uint64_t key) const noexcept {
+            // finalizer of murmur3, so that sequential ids are spread evenly as well
+            key ^= key >> 33;
+            key *= 0xff51afd7ed558ccdULL;
+            key ^= key >> 33;
+            key *= 0xc4ceb3fe1a85ec53ULL;
+            key ^= key >> 33;
+            return static_cast<uint32_t>(key % _queues.size());
+        }
+
+        [[nodiscard]] uint32_t shardFor(std::string_view key) const noexcept {
+            return shardFor(static_cast<uint64_t>(std::hash<std::string_view>{}(key)));
+        }
+
+        /// \return shard of the calling thread, or nullopt if the calling thread is not one of the shards of this runtime
+        [[nodiscard]] tl::optional<uint32_t> currentShard() const noexcept;
+
+        /// Thread-safe after start()
+        [[nodiscard]] IEventQueue& queue(uint32_t shard) const noexcept {
+            return *_queues[shard];
+        }
+
+        /// Thread-safe after start()
+        [[nodiscard]] DependencyManager& manager(uint32_t shard) const noexcept {
+            return *_managers[shard];
+        }
+
+        /// Channel that all shards are registered with, to broadcast to all other shards
+        [[nodiscard]] CommunicationChannel& channel() noexcept {
+            return _channel;
+        }
+
+        /// Thread-safe. Pushes an event into the queue of the shard owning key.
+        /// \return event id
+        template <typename EventT, typename KeyT, typename... Args>
+        requires Derived<EventT, Event>
+        uint64_t pushEventToShard(KeyT const &key, ServiceIdType originatingServiceId, Args&&... args) {
+            return queue(shardFor(key)).template pushEvent<EventT>(originatingServiceId, std::forward<Args>(args)...);
+        }
+
+        /*
+         * Runs fn on the thread of the given shard and resumes the caller on its own thread with the result of fn, so data owned by a shard is only ever touched on that shard.
+         * fn can return a value, void or a Task, which is awaited on the target shard. See CommunicationChannel::runOn, to call a service method on a shard use channel().call.
+         * Has to be co_awaited from a coroutine running on one of the shards.
+         */
+        template <typename F>
+        auto submitTo(uint32_t shard, F fn) {
+            return _channel.runOn(_managers[shard]->getId(), std::move(fn));
+        }
+
+        /// Same as submitTo, on the shard owning key
+        template <typename KeyT, typename F>
+        auto submitToShardOf(KeyT const &key, F fn) {
+            return submitTo(shardFor(key), std::move(fn));
+        }
+
+    private:
+        QueueFactory _queueFactory;
+        std::vector<Deployment> _deployments{};
+        std::vector<std::unique_ptr<IEventQueue>> _queues;
+        std::vector<DependencyManager*> _managers;
+        std::vector<std::thread> _threads{};
+        CommunicationChannel _channel{};
+    };
+}
@@ -138,6 +138,12 @@ namespace Ichor::Detail {
             return _id;
         }
 
+        /// Replaces the id counter of the calling thread, returning the previous one.
+        /// Used by the DependencyManager to give coroutines it starts on other threads ids that can't clash with those of its own thread.
+        static uint64_t exchange_id_counter(uint64_t counter) noexcept {
+            return std::exchange(_idCounter, counter == 0 ? 1 : counter);
+        }
+
         [[nodiscard]] constexpr uint64_t get_priority() const noexcept {
             return _priority;
         }
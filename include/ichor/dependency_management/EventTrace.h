@@ -0,0 +1,130 @@
+#pragma once
+
+#include <ichor/CoreTypes.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Ichor::v1 {
+    enum class TraceSpanKind : uint8_t {
+        EVENT, // processing of one event by the DependencyManager, includes the spans below
+        INTERCEPTOR, // one pre- or postIntercept call
+        CALLBACK, // one event handler, up to its first suspension
+        COROUTINE_RESUME, // one resumption of a suspended coroutine, up to its next suspension or completion
+    };
+
+    struct TraceSpan final {
+        uint64_t startNs{}; // steady clock
+        uint64_t durationNs{};
+        std::string_view eventName{};
+        std::string_view serviceName{};
+        ServiceIdType serviceId{};
+        uint64_t eventId{};
+        TraceSpanKind kind{};
+    };
+
+    /// Fixed size ring of spans, written by one DependencyManager thread and readable from any thread.
+    /// Names have to outlive the ring, which holds for the static type names of events and services.
+    class EventTraceRing final {
+    public:
+        EventTraceRing(uint64_t dmId, uint64_t capacity);
+
+        void record(TraceSpanKind kind, std::string_view eventName, std::string_view serviceName, ServiceIdType serviceId, uint64_t eventId, uint64_t startNs, uint64_t endNs) noexcept {
+            auto const head = _head.load(std::memory_order_relaxed);
+            // seqlock style: readers that copied this slot while it was being overwritten notice through _writing
+            _writing.store(head + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            auto &slot = _slots[head & _mask];
+            slot.startNs.store(startNs, std::memory_order_relaxed);
+            slot.durationNs.store(endNs - startNs, std::memory_order_relaxed);
+            slot.eventName.store(eventName.data(), std::memory_order_relaxed);
+            slot.serviceName.store(serviceName.data(), std::memory_order_relaxed);
+            slot.sizesAndKind.store(eventName.size() | (serviceName.size() << 24) | (static_cast<uint64_t>(kind) << 56), std::memory_order_relaxed);
+            slot.serviceId.store(serviceId.value, std::memory_order_relaxed);
+            slot.eventId.store(eventId, std::memory_order_relaxed);
+
+            _head.store(head + 1, std::memory_order_release);
+        }
+
+        /// Copies the spans that have not been overwritten yet, oldest first. Safe to call from any thread.
+        [[nodiscard]] std::vector<TraceSpan> snapshot() const;
+
+        [[nodiscard]] uint64_t getDmId() const noexcept {
+            return _dmId;
+        }
+
+        [[nodiscard]] uint64_t getCapacity() const noexcept {
+            return _mask + 1;
+        }
+
+        [[nodiscard]] static uint64_t now() noexcept {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+    private:
+        // one cache line per span
+        struct alignas(64) Slot final {
+            std::atomic<uint64_t> startNs;
+            std::atomic<uint64_t> durationNs;
+            std::atomic<char const *> eventName;
+            std::atomic<char const *> serviceName;
+            std::atomic<uint64_t> sizesAndKind; // 24 bits event name size, 32 bits service name size, 8 bits kind
+            std::atomic<uint64_t> serviceId;
+            std::atomic<uint64_t> eventId;
+        };
+
+        std::unique_ptr<Slot[]> _slots;
+        uint64_t _mask;
+        uint64_t _dmId;
+        std::atomic<uint64_t> _head{};
+        std::atomic<uint64_t> _writing{};
+    };
+
+    /// Records one span when going out of scope, does nothing if constructed without a ring.
+    /// The ring has to outlive the scope. The DependencyManager keeps rings replaced or disabled during an event alive until that event is done.
+    class [[nodiscard]] TraceScope final {
+    public:
+        TraceScope() noexcept = default;
+        TraceScope(EventTraceRing &ring, TraceSpanKind kind, std::string_view eventName, std::string_view serviceName, ServiceIdType serviceId, uint64_t eventId) noexcept
+            : _ring(&ring), _eventName(eventName), _serviceName(serviceName), _serviceId(serviceId), _eventId(eventId), _startNs(EventTraceRing::now()), _kind(kind) {}
+        TraceScope(TraceScope const &) = delete;
+        TraceScope(TraceScope &&) = delete;
+        TraceScope& operator=(TraceScope const &) = delete;
+        TraceScope& operator=(TraceScope &&) = delete;
+
+        ~TraceScope() {
+            finish();
+        }
+
+        /// Ends the span before the end of the scope
+        void finish() noexcept {
+            if(_ring != nullptr) [[unlikely]] {
+                _ring->record(_kind, _eventName, _serviceName, _serviceId, _eventId, _startNs, EventTraceRing::now());
+                _ring = nullptr;
+            }
+        }
+
+    private:
+        EventTraceRing *_ring{};
+        std::string_view _eventName{};
+        std::string_view _serviceName{};
+        ServiceIdType _serviceId{};
+        uint64_t _eventId{};
+        uint64_t _startNs{};
+        TraceSpanKind _kind{};
+    };
+
+    /// Renders the spans of every DependencyManager that has tracing enabled in the Chrome Trace Event JSON format.
+    /// Open the result in ui.perfetto.dev or chrome://tracing, every manager is shown as a thread. Safe to call from any thread.
+    [[nodiscard]] std::string exportChromeTrace();
+
+    namespace Detail {
+        void registerTraceRing(std::weak_ptr<EventTraceRing> ring);
+        /// Stops exporting the spans of ring
+        void unregisterTraceRing(EventTraceRing const *ring);
+    }
+}
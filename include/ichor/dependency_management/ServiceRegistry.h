@@ -0,0 +1,298 @@
+#pragma once
+
+#include <ichor/dependency_management/ILifecycleManager.h>
+#include <ichor/Filter.h>
+#include <algorithm>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace Ichor::Detail {
+    /// Owns the lifecycle managers of a DependencyManager.
+    /// Services are stored at a dense index in parallel arrays. The data used to decide whether two services can be injected into each other, the interfaces a service provides and the interfaces it depends on, is kept contiguous, so scans over all services only dereference the managers that match.
+    /// Removing a service moves the last service into its slot, so iteration order is unspecified and the container must not be modified while iterating.
+    /// Services are also indexed per interface, on the interfaces they depend on and, for the ones they provide, on the FilterIndexKey of their "Filter" property, so that finding the services to inject into each other is a lookup rather than a scan.
+    /// The Filter property is read once on insertion, changing it afterwards is not supported.
+    class ServiceRegistry final {
+        struct HashRange final {
+            uint32_t offset;
+            uint32_t size;
+        };
+
+        struct PropertyIndex final {
+            uint64_t nameHash;
+            uint64_t typeHash;
+            tl::optional<uint64_t> (*hashProperty)(v1::any const &) noexcept;
+            unordered_map<uint64_t, std::vector<ServiceIdType>> byValue;
+        };
+
+        /// Services providing one interface, split by the kind of their filter
+        struct ProviderIndex final {
+            std::vector<ServiceIdType> unindexed; // without filter, or with a filter that has no FilterIndexKey
+            unordered_map<ServiceIdType, std::vector<ServiceIdType>, ServiceIdHash> byServiceId;
+            std::vector<PropertyIndex> byProperty;
+        };
+
+    public:
+        /// Named like the pair of a map, as the registry replaced one
+        struct Entry final {
+            ServiceIdType first{};
+            ILifecycleManager *second{};
+        };
+
+        class iterator final {
+        public:
+            using value_type = Entry;
+            using reference = Entry&;
+            using pointer = Entry*;
+            using difference_type = std::ptrdiff_t;
+            using iterator_category = std::forward_iterator_tag;
+
+            iterator() noexcept = default;
+            iterator(ServiceRegistry const *registry, uint32_t index) noexcept : _registry(registry), _index(index) {
+                load();
+            }
+
+            [[nodiscard]] Entry &operator*() noexcept { return _current; }
+            [[nodiscard]] Entry const &operator*() const noexcept { return _current; }
+            [[nodiscard]] Entry *operator->() noexcept { return &_current; }
+            [[nodiscard]] Entry const *operator->() const noexcept { return &_current; }
+
+            iterator &operator++() noexcept {
+                ++_index;
+                load();
+                return *this;
+            }
+
+            iterator operator++(int) noexcept {
+                auto ret = *this;
+                ++(*this);
+                return ret;
+            }
+
+            friend bool operator==(iterator const &a, iterator const &b) noexcept {
+                return a._index == b._index;
+            }
+
+            [[nodiscard]] uint32_t index() const noexcept {
+                return _index;
+            }
+
+        private:
+            void load() noexcept {
+                if(_registry != nullptr && _index < _registry->_ids.size()) {
+                    _current.first = _registry->_ids[_index];
+                    _current.second = _registry->_managers[_index].get();
+                }
+            }
+
+            ServiceRegistry const *_registry{};
+            uint32_t _index{};
+            Entry _current{};
+        };
+
+        ServiceRegistry() = default;
+        ServiceRegistry(ServiceRegistry const &) = delete;
+        ServiceRegistry(ServiceRegistry &&) noexcept = default;
+        ServiceRegistry& operator=(ServiceRegistry const &) = delete;
+        ServiceRegistry& operator=(ServiceRegistry &&) noexcept = default;
+
+        /// Inserts mgr under its own serviceId()
+        /// \return iterator to the service and true if inserted, or to the existing service and false if the id is already present
+        std::pair<iterator, bool> emplace(std::unique_ptr<ILifecycleManager> mgr);
+        void erase(iterator it);
+        void clear() noexcept;
+
+        [[nodiscard]] iterator find(ServiceIdType id) const noexcept {
+            auto const idx = _indices.find(id);
+            if(idx == _indices.end()) {
+                return end();
+            }
+            return iterator{this, idx->second};
+        }
+
+        [[nodiscard]] bool contains(ServiceIdType id) const noexcept {
+            return _indices.contains(id);
+        }
+
+        [[nodiscard]] size_t size() const noexcept {
+            return _ids.size();
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            return _ids.empty();
+        }
+
+        [[nodiscard]] iterator begin() const noexcept {
+            return iterator{this, 0};
+        }
+
+        [[nodiscard]] iterator end() const noexcept {
+            return iterator{this, static_cast<uint32_t>(_ids.size())};
+        }
+
+        friend iterator begin(ServiceRegistry const &r) noexcept {
+            return r.begin();
+        }
+
+        friend iterator end(ServiceRegistry const &r) noexcept {
+            return r.end();
+        }
+
+        /// Calls fn(ServiceIdType, ILifecycleManager&), in registry order, for every service that registered a dependency on one of the interfaces of provider and that the filter of provider can match.
+        /// The index only rules out services, fn still has to evaluate the filter.
+        template <typename F>
+        void forEachInterestedIn(ServiceIdType provider, F &&fn) const {
+            auto const idx = _indices.find(provider);
+            if(idx == _indices.end()) {
+                return;
+            }
+            auto const provides = _provides[idx->second];
+            auto const &filterKey = _filterKeys[idx->second];
+
+            if(filterKey.kind == FilterIndexKey::Kind::SERVICE_ID) {
+                auto const target = _indices.find(ServiceIdType{filterKey.value});
+                if(target != _indices.end() && intersects(_interests[target->second], provides)) {
+                    fn(_ids[target->second], *_managers[target->second]);
+                }
+                return;
+            }
+
+            auto candidates = takeScratch();
+            for(auto const hash : hashes(provides)) {
+                if(auto const interested = _interested.find(hash); interested != _interested.end()) {
+                    appendIndices(candidates, interested->second);
+                }
+            }
+            forEachIndex(candidates, fn);
+            returnScratch(std::move(candidates));
+        }
+
+        /// Calls fn(ServiceIdType, ILifecycleManager&), in registry order, for every service that provides one of the interfaces in the registry of dependent and whose filter, if any, can match dependent.
+        /// The index only rules out services, fn still has to evaluate the filter.
+        template <typename F>
+        void forEachProvidingDependencyOf(ServiceIdType dependent, F &&fn) const {
+            auto const idx = _indices.find(dependent);
+            if(idx == _indices.end()) {
+                return;
+            }
+            auto const &properties = _managers[idx->second]->getProperties();
+
+            auto candidates = takeScratch();
+            for(auto const hash : hashes(_interests[idx->second])) {
+                auto const providers = _providers.find(hash);
+                if(providers == _providers.end()) {
+                    continue;
+                }
+                appendIndices(candidates, providers->second.unindexed);
+                if(auto const filtered = providers->second.byServiceId.find(dependent); filtered != providers->second.byServiceId.end()) {
+                    appendIndices(candidates, filtered->second);
+                }
+                for(auto const &propertyIndex : providers->second.byProperty) {
+                    auto const prop = properties.findByHash(propertyIndex.nameHash);
+                    if(prop == properties.end()) {
+                        continue;
+                    }
+                    auto const valueHash = propertyIndex.hashProperty(prop->second);
+                    if(!valueHash) {
+                        continue;
+                    }
+                    if(auto const filtered = propertyIndex.byValue.find(*valueHash); filtered != propertyIndex.byValue.end()) {
+                        appendIndices(candidates, filtered->second);
+                    }
+                }
+            }
+            forEachIndex(candidates, fn);
+            returnScratch(std::move(candidates));
+        }
+
+        /// Calls fn(ServiceIdType, ILifecycleManager&) for every service that provides interfaceHash
+        template <typename F>
+        void forEachProviding(NameHashType interfaceHash, F &&fn) const {
+            for(uint32_t i = 0; i < _ids.size(); i++) {
+                for(auto const hash : hashes(_provides[i])) {
+                    if(hash == interfaceHash) {
+                        fn(_ids[i], *_managers[i]);
+                        break;
+                    }
+                }
+            }
+        }
+
+        /// Calls fn(ServiceIdType, ILifecycleManager&) for every service that is not an internal manager (the DependencyManager, queues, etc)
+        template <typename F>
+        void forEachNonInternal(F &&fn) const {
+            for(uint32_t i = 0; i < _ids.size(); i++) {
+                if(!_internal[i]) {
+                    fn(_ids[i], *_managers[i]);
+                }
+            }
+        }
+
+    private:
+        // The candidate buffer is reused between lookups. It is moved out while in use, so a lookup from within fn gets its own.
+        [[nodiscard]] std::vector<uint32_t> takeScratch() const noexcept {
+            return std::move(_scratch);
+        }
+
+        void returnScratch(std::vector<uint32_t> &&candidates) const noexcept {
+            candidates.clear();
+            _scratch = std::move(candidates);
+        }
+
+        void appendIndices(std::vector<uint32_t> &indices, std::vector<ServiceIdType> const &ids) const {
+            for(auto const id : ids) {
+                indices.push_back(_indices.find(id)->second);
+            }
+        }
+
+        /// Visits indices in registry order, once each, as a service may be found through several of its interfaces.
+        /// Services inserted by fn are not visited.
+        template <typename F>
+        void forEachIndex(std::vector<uint32_t> &indices, F &fn) const {
+            std::sort(indices.begin(), indices.end());
+            indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+            for(auto const i : indices) {
+                fn(_ids[i], *_managers[i]);
+            }
+        }
+
+        void addToIndices(uint32_t idx);
+        void removeFromIndices(uint32_t idx);
+
+        [[nodiscard]] std::span<NameHashType const> hashes(HashRange range) const noexcept {
+            return std::span<NameHashType const>{_hashes.data() + range.offset, range.size};
+        }
+
+        [[nodiscard]] bool intersects(HashRange a, HashRange b) const noexcept {
+            for(auto const hashA : hashes(a)) {
+                for(auto const hashB : hashes(b)) {
+                    if(hashA == hashB) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        void compactHashes();
+
+        // hot, indexed by dense index
+        std::vector<ServiceIdType> _ids{};
+        std::vector<HashRange> _provides{};
+        std::vector<HashRange> _interests{};
+        std::vector<bool> _internal{};
+        std::vector<FilterIndexKey> _filterKeys{};
+        std::vector<NameHashType> _hashes{}; // storage of the HashRanges, erased services leave holes until compacted
+        uint64_t _unusedHashes{};
+
+        // indexed by interface
+        unordered_map<NameHashType, ProviderIndex> _providers{};
+        unordered_map<NameHashType, std::vector<ServiceIdType>> _interested{};
+        mutable std::vector<uint32_t> _scratch{};
+
+        // cold
+        std::vector<std::unique_ptr<ILifecycleManager>> _managers{};
+        unordered_map<ServiceIdType, uint32_t, ServiceIdHash> _indices{};
+    };
+}
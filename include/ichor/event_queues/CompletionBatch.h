@@ -0,0 +1,48 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <ichor/event_queues/IEventQueue.h>
+#include <ichor/events/RunFunctionEvent.h>
+
+namespace Ichor::Detail {
+    /// Hands work finished on other threads back to a queue in batches: only the first completion of a batch pushes an event, the rest piggyback on it.
+    /// T needs an evt member with a set() function, which gets called on the thread of the queue. Shared with the pushed events, so create it with std::make_shared.
+    template <typename T>
+    struct CompletionBatch : public std::enable_shared_from_this<CompletionBatch<T>> {
+        explicit CompletionBatch(IEventQueue &_queue) noexcept : queue(_queue) {}
+
+        // called from other threads
+        void complete(std::shared_ptr<T> work) {
+            bool schedule;
+            {
+                std::unique_lock lg{mutex};
+                schedule = completed.empty();
+                completed.emplace_back(std::move(work));
+            }
+
+            if(schedule) {
+                queue.pushEvent<RunFunctionEvent>(ServiceIdType{0}, [batch = this->shared_from_this()]() {
+                    batch->deliver();
+                });
+            }
+        }
+
+        void deliver() {
+            {
+                std::unique_lock lg{mutex};
+                std::swap(completed, delivering);
+            }
+            for(auto &work : delivering) {
+                work->evt.set();
+            }
+            delivering.clear();
+        }
+
+        IEventQueue &queue;
+        std::mutex mutex;
+        std::vector<std::shared_ptr<T>> completed;
+        std::vector<std::shared_ptr<T>> delivering; // only used on the thread of queue, keeps its capacity between batches
+    };
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#ifndef ICHOR_USE_EPOLL
+#error "Ichor has not been compiled with epoll support"
+#endif
+
+#include <ichor/stl/RealtimeReadWriteMutex.h>
+#include <ichor/stl/SectionalPriorityQueue.h>
+#include <ichor/event_queues/IEpollQueue.h>
+#include <ichor/event_queues/PriorityQueue.h>
+#include <ichor/Common.h>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Ichor {
+    /// Event queue built on epoll, for when io_uring is unavailable (e.g. disabled by seccomp in containers).
+    /// Services can register fds to get called on readiness (see IEpollQueue), EpollTimer uses a timerfd per timer.
+    /// Events pushed from the queue thread skip locking, other threads wake the loop through an eventfd.
+    class EpollQueue final : public IEpollQueue {
+    public:
+        EpollQueue();
+        /// \param quitTimeoutMs time to wait for services to stop after a sigint before quitting forcibly
+        explicit EpollQueue(uint64_t quitTimeoutMs);
+        ~EpollQueue() final;
+
+        void pushEventInternal(uint64_t priority, std::unique_ptr<Event> &&event) final;
+
+        [[nodiscard]] bool empty() const noexcept final;
+        [[nodiscard]] uint64_t size() const noexcept final;
+        [[nodiscard]] bool is_running() const noexcept final;
+        [[nodiscard]] ICHOR_CONST_FUNC_ATTR NameHashType get_queue_name_hash() const noexcept final;
+
+        bool start(bool captureSigInt) final;
+        [[nodiscard]] bool shouldQuit() final;
+        void quit() final;
+
+        tl::expected<void, v1::IOError> registerFd(int fd, uint32_t events, std::function<void(uint32_t)> handler) final;
+        tl::expected<void, v1::IOError> modifyFd(int fd, uint32_t events) final;
+        void unregisterFd(int fd) noexcept final;
+
+    private:
+        void wakeup() noexcept;
+        void moveOtherThreadEvents();
+        void shouldAddQuitEvent();
+
+        struct FdRegistration final {
+            // -1 once unregistered, entry gets erased after the current batch of epoll events has been handled
+            int fd;
+            std::function<void(uint32_t)> handler;
+        };
+
+        // only touched from the queue thread
+        v1::SectionalPriorityQueue<std::unique_ptr<Event>, PriorityQueueCompare> _eventQueue{};
+        // node based, handlers may register new fds while being called
+        std::unordered_map<uint64_t, FdRegistration> _registrations{};
+        unordered_map<int, uint64_t> _fdToRegistration{};
+        std::vector<uint64_t> _unregistered{};
+        uint64_t _nextRegistrationId{1};
+
+        mutable v1::RealtimeReadWriteMutex _otherThreadEventQueueMutex{};
+        std::vector<std::unique_ptr<Event>> _otherThreadEventQueue{};
+        std::atomic<uint64_t> _pendingEvents{};
+        std::atomic<std::thread::id> _threadId{};
+        std::atomic<bool> _quit{false};
+        std::atomic<bool> _running{false};
+        int _epollFd{-1};
+        int _eventFd{-1};
+        bool _quitEventSent{false};
+        std::chrono::steady_clock::time_point _whenQuitEventWasSent{};
+        uint64_t _quitTimeoutMs{5'000};
+    };
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#ifndef ICHOR_USE_EPOLL
+#error "Ichor has not been compiled with epoll support"
+#endif
+
+#include <ichor/stl/ErrnoUtils.h>
+#include <ichor/event_queues/IEventQueue.h>
+#include <tl/expected.h>
+#include <functional>
+
+namespace Ichor {
+    class IEpollQueue : public IEventQueue {
+    public:
+        ~IEpollQueue() override = default;
+
+        /// Watch an fd for readiness. Not thread-safe, only call from the thread running the queue.
+        /// \param fd file descriptor to watch, has to stay open until unregisterFd is called
+        /// \param events epoll event mask, e.g. EPOLLIN | EPOLLRDHUP. Level-triggered unless EPOLLET is passed.
+        /// \param handler called on the queue thread with the returned epoll events
+        /// \return the mapped errno of epoll_ctl on failure
+        virtual tl::expected<void, v1::IOError> registerFd(int fd, uint32_t events, std::function<void(uint32_t)> handler) = 0;
+        /// Change the event mask of a registered fd. Not thread-safe, only call from the thread running the queue.
+        virtual tl::expected<void, v1::IOError> modifyFd(int fd, uint32_t events) = 0;
+        /// Stop watching an fd, does not close it. Safe to call from within any handler, including the fd's own. Not thread-safe, only call from the thread running the queue.
+        virtual void unregisterFd(int fd) noexcept = 0;
+    };
+}
@@ -6,6 +6,9 @@
 #include <ichor/events/Event.h>
 #include <ichor/Concepts.h>
 #include <ichor/dependency_management/ILifecycleManager.h>
+#ifdef ICHOR_ENABLE_QUEUE_STATISTICS
+#include <ichor/event_queues/QueueStatistics.h>
+#endif
 
 namespace Ichor {
     class DependencyManager;
@@ -52,7 +55,7 @@ namespace Ichor {
             static_assert(EventT::NAME == typeName<EventT>(), "Event typeName wrong");
 
             uint64_t eventId = getNextEventId();
-            pushEventInternal(INTERNAL_EVENT_PRIORITY, std::unique_ptr<Event>{new EventT(std::forward<uint64_t>(eventId), std::forward<ServiceIdType>(originatingServiceId), INTERNAL_EVENT_PRIORITY, std::forward<Args>(args)...)});
+            pushEventInternal(INTERNAL_EVENT_PRIORITY, stamp(std::unique_ptr<Event>{new EventT(std::forward<uint64_t>(eventId), std::forward<ServiceIdType>(originatingServiceId), INTERNAL_EVENT_PRIORITY, std::forward<Args>(args)...)}));
             return eventId;
         }
 
@@ -71,7 +74,7 @@ namespace Ichor {
             static_assert(EventT::NAME == typeName<EventT>(), "Event typeName wrong");
 
             uint64_t eventId = getNextEventId();
-            pushEventInternal(priority, std::unique_ptr<Event>{new EventT(std::forward<uint64_t>(eventId), std::forward<ServiceIdType>(originatingServiceId), std::forward<uint64_t>(priority), std::forward<Args>(args)...)});
+            pushEventInternal(priority, stamp(std::unique_ptr<Event>{new EventT(std::forward<uint64_t>(eventId), std::forward<ServiceIdType>(originatingServiceId), std::forward<uint64_t>(priority), std::forward<Args>(args)...)}));
             return eventId;
         }
 
@@ -81,6 +84,27 @@ namespace Ichor {
             return _eventIdCounter.fetch_add(1, std::memory_order_relaxed);
         }
 
+#ifdef ICHOR_ENABLE_QUEUE_STATISTICS
+        /// Not thread-safe, only use from the thread of this queue, e.g. from a service or timer
+        /// \return queue wait and processing latencies of all events dispatched so far
+        [[nodiscard]] v1::QueueStatistics const& getStatistics() const noexcept {
+            return _statistics;
+        }
+
+        /// Not thread-safe, only use from the thread of this queue
+        void resetStatistics() noexcept {
+            _statistics.reset();
+        }
+
+        /// Not thread-safe, call before starting the queue or from the thread of this queue.
+        /// \param threshold events that waited longer than this trigger the alarm, e.g. the latency SLO of the application
+        /// \param alarm called right before the late event is processed, pass an empty function to disable
+        void setQueueWaitAlarm(std::chrono::nanoseconds threshold, v1::QueueWaitAlarm alarm) {
+            _queueWaitAlarmThresholdNs = static_cast<uint64_t>(threshold.count());
+            _queueWaitAlarm = std::move(alarm);
+        }
+#endif
+
     protected:
         friend class DependencyManager;
         [[nodiscard]] virtual bool shouldQuit() = 0;
@@ -91,8 +115,20 @@ namespace Ichor {
         void stopDm();
         void addInternalServiceManager(std::unique_ptr<ILifecycleManager> svc);
 
+        [[nodiscard]] static std::unique_ptr<Event> stamp(std::unique_ptr<Event> &&evt) noexcept {
+#ifdef ICHOR_ENABLE_QUEUE_STATISTICS
+            evt->enqueuedNs = v1::Detail::queueClockNs();
+#endif
+            return std::move(evt);
+        }
+
         std::unique_ptr<DependencyManager> _dm;
         std::atomic<uint64_t> _eventIdCounter{0};
+#ifdef ICHOR_ENABLE_QUEUE_STATISTICS
+        v1::QueueStatistics _statistics{};
+        v1::QueueWaitAlarm _queueWaitAlarm{};
+        uint64_t _queueWaitAlarmThresholdNs{};
+#endif
     };
 
     /// Get event queue associated with current thread. Terminates program if none available.
@@ -70,5 +70,10 @@ namespace Ichor {
         /// \param entries no. of entries in the to-be-created buffer. Cannot be 0, cannot be larger than 32768 and has to be a power of two
         /// \return
         [[nodiscard]] virtual tl::expected<IOUringBuf, v1::IOError> createProvidedBuffer(unsigned short entries, unsigned int entryBufferSize) noexcept = 0;
+        /// Registers a sparse fixed file table with the ring on first call, shared by everything using this queue.
+        /// Files opened with io_uring_prep_openat_direct or added with io_uring_prep_files_update, both with IORING_FILE_INDEX_ALLOC, get a slot in it.
+        /// Operations on a slot with IOSQE_FIXED_FILE skip looking up the file every time. Slots are freed with io_uring_prep_close_direct.
+        /// \return amount of slots in the table
+        [[nodiscard]] virtual tl::expected<unsigned int, v1::IOError> enableFixedFileTable() noexcept = 0;
     };
 }
@@ -52,6 +52,7 @@ namespace Ichor {
 
         [[nodiscard]] v1::Version getKernelVersion() const noexcept final;
         [[nodiscard]] tl::expected<IOUringBuf, v1::IOError> createProvidedBuffer(unsigned short entries, unsigned int entryBufferSize) noexcept final;
+        [[nodiscard]] tl::expected<unsigned int, v1::IOError> enableFixedFileTable() noexcept final;
 
     private:
         bool checkRingFlags(io_uring* ring);
@@ -71,6 +72,7 @@ namespace Ichor {
         unsigned int _entriesCount{};
         std::atomic<uint64_t> _pendingEvents{0};
         int _uringBufIdCounter{1};
+        unsigned int _fixedFileTableSize{};
         long long _pollTimeoutNs{};
         std::chrono::steady_clock::time_point _whenQuitEventWasSent{};
         std::atomic<bool> _quitEventSent{false};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <ichor/events/Event.h>
+#include <ichor/services/metrics/LatencyHistogram.h>
+#include <array>
+#include <chrono>
+#include <functional>
+#include <string_view>
+
+namespace Ichor::v1 {
+    /// Priority ranges that get their own histograms, lower priorities are handled first
+    enum class QueuePriorityBand : uint_fast16_t {
+        INTERNAL, // up to INTERNAL_DEPENDENCY_EVENT_PRIORITY, service insertion, dependency and coroutine events
+        HIGH, // above INTERNAL_DEPENDENCY_EVENT_PRIORITY, below INTERNAL_EVENT_PRIORITY
+        DEFAULT, // INTERNAL_EVENT_PRIORITY, used by pushEvent
+        LOW, // above INTERNAL_EVENT_PRIORITY
+    };
+
+    inline constexpr size_t QUEUE_PRIORITY_BAND_COUNT = 4;
+
+    [[nodiscard]] constexpr QueuePriorityBand priorityBand(uint64_t priority) noexcept {
+        if(priority <= INTERNAL_DEPENDENCY_EVENT_PRIORITY) {
+            return QueuePriorityBand::INTERNAL;
+        }
+        if(priority < INTERNAL_EVENT_PRIORITY) {
+            return QueuePriorityBand::HIGH;
+        }
+        if(priority == INTERNAL_EVENT_PRIORITY) {
+            return QueuePriorityBand::DEFAULT;
+        }
+        return QueuePriorityBand::LOW;
+    }
+
+    [[nodiscard]] constexpr std::string_view priorityBandName(QueuePriorityBand band) noexcept {
+        switch(band) {
+            case QueuePriorityBand::INTERNAL:
+                return "internal";
+            case QueuePriorityBand::HIGH:
+                return "high";
+            case QueuePriorityBand::DEFAULT:
+                return "default";
+            case QueuePriorityBand::LOW:
+                return "low";
+        }
+        return "unknown";
+    }
+
+    /// Latencies of the events dispatched by one queue, in ns, indexed by QueuePriorityBand.
+    /// Queue wait is the time between pushing an event and the queue handing it to the DependencyManager,
+    /// processing is the time the DependencyManager spent on it, up to the first suspension of coroutines.
+    struct QueueStatistics final {
+        std::array<LatencyHistogram, QUEUE_PRIORITY_BAND_COUNT> queueWaitNs{};
+        std::array<LatencyHistogram, QUEUE_PRIORITY_BAND_COUNT> processingNs{};
+        uint64_t queueWaitAlarms{}; // amount of events that waited longer than the alarm threshold
+
+        [[nodiscard]] LatencyHistogram const& queueWait(QueuePriorityBand band) const noexcept {
+            return queueWaitNs[static_cast<size_t>(band)];
+        }
+
+        [[nodiscard]] LatencyHistogram const& processing(QueuePriorityBand band) const noexcept {
+            return processingNs[static_cast<size_t>(band)];
+        }
+
+        void reset() noexcept {
+            for(auto &h : queueWaitNs) {
+                h.reset();
+            }
+            for(auto &h : processingNs) {
+                h.reset();
+            }
+            queueWaitAlarms = 0;
+        }
+    };
+
+    /// Called on the thread of the queue, right before the late event is processed
+    using QueueWaitAlarm = std::function<void(Event const &evt, std::chrono::nanoseconds waited)>;
+
+    namespace Detail {
+        [[nodiscard]] inline uint64_t queueClockNs() noexcept {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+    }
+}
@@ -26,5 +26,8 @@ namespace Ichor {
         uint64_t const id;
         ServiceIdType const originatingService;
         uint64_t const priority;
+#ifdef ICHOR_ENABLE_QUEUE_STATISTICS
+        uint64_t enqueuedNs{}; // steady clock, set when pushed into a queue
+#endif
     };
 }
@@ -133,6 +133,23 @@ namespace Ichor {
         static constexpr std::string_view NAME = typeName<StartServiceEvent>();
     };
 
+    /// Pushed once when every service of a ServiceBatch has started or was removed, see DependencyManager::insertServiceBatch()
+    struct ServiceBatchStartedEvent final : public Event {
+        constexpr ServiceBatchStartedEvent(uint64_t _id, ServiceIdType _originatingService, uint64_t _priority, uint64_t _batchId) noexcept : Event(_id, _originatingService, _priority), batchId(_batchId) {}
+        constexpr ~ServiceBatchStartedEvent() final = default;
+
+        [[nodiscard]] ICHOR_CONST_FUNC_ATTR constexpr std::string_view get_name() const noexcept final {
+            return NAME;
+        }
+        [[nodiscard]] ICHOR_CONST_FUNC_ATTR constexpr NameHashType get_type() const noexcept final {
+            return TYPE;
+        }
+
+        uint64_t const batchId;
+        static constexpr NameHashType TYPE = typeNameHash<ServiceBatchStartedEvent>();
+        static constexpr std::string_view NAME = typeName<ServiceBatchStartedEvent>();
+    };
+
     struct RemoveServiceEvent final : public Event {
         constexpr RemoveServiceEvent(uint64_t _id, ServiceIdType _originatingService, uint64_t _priority, ServiceIdType _serviceId) noexcept : Event(_id, _originatingService, _priority), serviceId(_serviceId) {}
         constexpr ~RemoveServiceEvent() final = default;
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <ichor/events/Event.h>
+#include <ichor/ConstevalHash.h>
+#include <ichor/stl/AtomicReferenceCountedPointer.h>
+
+namespace Ichor {
+    /// Carries an immutable payload shared between all queues it was broadcast to, see CommunicationChannel::broadcastPayload.
+    /// The payload is destroyed when the last queue is done with its event, which can be on any of those threads.
+    template <typename PayloadT>
+    struct SharedPayloadEvent final : public Event {
+        SharedPayloadEvent(uint64_t _id, ServiceIdType _originatingService, uint64_t _priority, v1::AtomicReferenceCountedPointer<PayloadT const> _payload) noexcept :
+                Event(_id, _originatingService, _priority), payload(std::move(_payload)) {}
+        ~SharedPayloadEvent() final = default;
+
+        [[nodiscard]] ICHOR_CONST_FUNC_ATTR constexpr std::string_view get_name() const noexcept final {
+            return NAME;
+        }
+        [[nodiscard]] ICHOR_CONST_FUNC_ATTR constexpr NameHashType get_type() const noexcept final {
+            return TYPE;
+        }
+
+        v1::AtomicReferenceCountedPointer<PayloadT const> const payload;
+        static constexpr NameHashType TYPE = typeNameHash<SharedPayloadEvent<PayloadT>>();
+        static constexpr std::string_view NAME = typeName<SharedPayloadEvent<PayloadT>>();
+    };
+}
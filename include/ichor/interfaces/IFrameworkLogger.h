@@ -9,6 +9,11 @@
 #include <ichor/stl/StringUtils.h>
 #endif
 
+// Index into LogLevel, set through the ICHOR_MIN_LOG_LEVEL CMake option
+#ifndef ICHOR_MIN_LOG_LEVEL
+#define ICHOR_MIN_LOG_LEVEL 0
+#endif
+
 namespace Ichor {
     class IFrameworkLogger {
     public:
@@ -25,16 +30,20 @@ namespace Ichor {
         ~IFrameworkLogger() = default;
     };
 
+    // Log statements below this level are discarded at compile time, including evaluating their arguments. Errors are always logged.
+    static constexpr LogLevel MIN_LOG_LEVEL = static_cast<LogLevel>(ICHOR_MIN_LOG_LEVEL);
+    static_assert(MIN_LOG_LEVEL <= LogLevel::LOG_ERROR, "ICHOR_MIN_LOG_LEVEL out of range");
+
     template <typename... T>
     auto make_args(T&&... args) {
         return fmt::make_format_args(args...);
     }
 
 #ifndef ICHOR_REMOVE_SOURCE_NAMES_FROM_LOGGING
-#define ICHOR_LOG_TRACE(logger, str, ...) { if(logger != nullptr && logger->getLogLevel() <= Ichor::LogLevel::LOG_TRACE) logger->trace(__FILE__, __LINE__, static_cast<const char *>(__FUNCTION__), str, Ichor::make_args(__VA_ARGS__)); }; static_assert(true, "")
-#define ICHOR_LOG_DEBUG(logger, str, ...) { if(logger != nullptr && logger->getLogLevel() <= Ichor::LogLevel::LOG_DEBUG) logger->debug(__FILE__, __LINE__, static_cast<const char *>(__FUNCTION__), str, Ichor::make_args(__VA_ARGS__)); }; static_assert(true, "")
-#define ICHOR_LOG_INFO(logger, str, ...) { if(logger != nullptr && logger->getLogLevel() <= Ichor::LogLevel::LOG_INFO) logger->info(__FILE__, __LINE__, static_cast<const char *>(__FUNCTION__), str, Ichor::make_args(__VA_ARGS__)); }; static_assert(true, "")
-#define ICHOR_LOG_WARN(logger, str, ...) { if(logger != nullptr && logger->getLogLevel() <= Ichor::LogLevel::LOG_WARN) logger->warn(__FILE__, __LINE__, static_cast<const char *>(__FUNCTION__), str, Ichor::make_args(__VA_ARGS__)); }; static_assert(true, "")
+#define ICHOR_LOG_TRACE(logger, str, ...) { if constexpr(Ichor::MIN_LOG_LEVEL <= Ichor::LogLevel::LOG_TRACE) { if(logger != nullptr && logger->getLogLevel() <= Ichor::LogLevel::LOG_TRACE) logger->trace(__FILE__, __LINE__, static_cast<const char *>(__FUNCTION__), str, Ichor::make_args(__VA_ARGS__)); } }; static_assert(true, "")
+#define ICHOR_LOG_DEBUG(logger, str, ...) { if constexpr(Ichor::MIN_LOG_LEVEL <= Ichor::LogLevel::LOG_DEBUG) { if(logger != nullptr && logger->getLogLevel() <= Ichor::LogLevel::LOG_DEBUG) logger->debug(__FILE__, __LINE__, static_cast<const char *>(__FUNCTION__), str, Ichor::make_args(__VA_ARGS__)); } }; static_assert(true, "")
+#define ICHOR_LOG_INFO(logger, str, ...) { if constexpr(Ichor::MIN_LOG_LEVEL <= Ichor::LogLevel::LOG_INFO) { if(logger != nullptr && logger->getLogLevel() <= Ichor::LogLevel::LOG_INFO) logger->info(__FILE__, __LINE__, static_cast<const char *>(__FUNCTION__), str, Ichor::make_args(__VA_ARGS__)); } }; static_assert(true, "")
+#define ICHOR_LOG_WARN(logger, str, ...) { if constexpr(Ichor::MIN_LOG_LEVEL <= Ichor::LogLevel::LOG_WARN) { if(logger != nullptr && logger->getLogLevel() <= Ichor::LogLevel::LOG_WARN) logger->warn(__FILE__, __LINE__, static_cast<const char *>(__FUNCTION__), str, Ichor::make_args(__VA_ARGS__)); } }; static_assert(true, "")
 #define ICHOR_LOG_ERROR(logger, str, ...) { if(logger != nullptr) logger->error(__FILE__, __LINE__, static_cast<const char *>(__FUNCTION__), str, Ichor::make_args(__VA_ARGS__)); }; static_assert(true, "")
 
 #define ICHOR_EMERGENCY_LOG1(logger, str) { if(logger != nullptr) { logger->error(__FILE__, __LINE__, static_cast<const char *>(__FUNCTION__), str, Ichor::make_args()); } const char *base = Ichor::v1::basename(__FILE__); fmt::print("[{}:{}] ", base, __LINE__); fmt::println(str); }; static_assert(true, "")
@@ -42,10 +51,10 @@ namespace Ichor {
 #define ICHOR_EMERGENCY_NO_LOGGER_LOG1(str) { const char *base = Ichor::v1::basename(__FILE__); fmt::print("[{}:{}] ", base, __LINE__); fmt::println(str); }; static_assert(true, "")
 #define ICHOR_EMERGENCY_NO_LOGGER_LOG2(str, ...) { const char *base = Ichor::v1::basename(__FILE__); fmt::print("[{}:{}] ", base, __LINE__); fmt::println(str, __VA_ARGS__); }; static_assert(true, "")
 #else
-#define ICHOR_LOG_TRACE(logger, str, ...) { if(logger != nullptr && logger->getLogLevel() <= Ichor::LogLevel::LOG_TRACE) logger->trace(nullptr, 0, nullptr, str, make_args(__VA_ARGS__)); }; static_assert(true, "")
-#define ICHOR_LOG_DEBUG(logger, str, ...) { if(logger != nullptr && logger->getLogLevel() <= Ichor::LogLevel::LOG_DEBUG) logger->debug(nullptr, 0, nullptr, str, make_args(__VA_ARGS__)); }; static_assert(true, "")
-#define ICHOR_LOG_INFO(logger, str, ...) { if(logger != nullptr && logger->getLogLevel() <= Ichor::LogLevel::LOG_INFO) logger->info(nullptr, 0, nullptr, str, make_args(__VA_ARGS__)); }; static_assert(true, "")
-#define ICHOR_LOG_WARN(logger, str, ...) { if(logger != nullptr && logger->getLogLevel() <= Ichor::LogLevel::LOG_WARN) logger->warn(nullptr, 0, nullptr, str, make_args(__VA_ARGS__)); }; static_assert(true, "")
+#define ICHOR_LOG_TRACE(logger, str, ...) { if constexpr(Ichor::MIN_LOG_LEVEL <= Ichor::LogLevel::LOG_TRACE) { if(logger != nullptr && logger->getLogLevel() <= Ichor::LogLevel::LOG_TRACE) logger->trace(nullptr, 0, nullptr, str, make_args(__VA_ARGS__)); } }; static_assert(true, "")
+#define ICHOR_LOG_DEBUG(logger, str, ...) { if constexpr(Ichor::MIN_LOG_LEVEL <= Ichor::LogLevel::LOG_DEBUG) { if(logger != nullptr && logger->getLogLevel() <= Ichor::LogLevel::LOG_DEBUG) logger->debug(nullptr, 0, nullptr, str, make_args(__VA_ARGS__)); } }; static_assert(true, "")
+#define ICHOR_LOG_INFO(logger, str, ...) { if constexpr(Ichor::MIN_LOG_LEVEL <= Ichor::LogLevel::LOG_INFO) { if(logger != nullptr && logger->getLogLevel() <= Ichor::LogLevel::LOG_INFO) logger->info(nullptr, 0, nullptr, str, make_args(__VA_ARGS__)); } }; static_assert(true, "")
+#define ICHOR_LOG_WARN(logger, str, ...) { if constexpr(Ichor::MIN_LOG_LEVEL <= Ichor::LogLevel::LOG_WARN) { if(logger != nullptr && logger->getLogLevel() <= Ichor::LogLevel::LOG_WARN) logger->warn(nullptr, 0, nullptr, str, make_args(__VA_ARGS__)); } }; static_assert(true, "")
 #define ICHOR_LOG_ERROR(logger, str, ...) { if(logger != nullptr) logger->error(nullptr, 0, nullptr, str, make_args(__VA_ARGS__)); }; static_assert(true, "")
 
 #define ICHOR_EMERGENCY_LOG1(logger, str) { if(logger != nullptr) { logger->error(nullptr, 0, nullptr, str, make_args()); } fmt::println(str); }; static_assert(true, "")
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <ichor/coroutines/Task.h>
+#include <ichor/stl/ErrnoUtils.h>
+#include <span>
+#include <tl/expected.h>
+
+namespace Ichor::v1 {
+    enum class FileOpenFlags : uint_fast16_t {
+        NONE = 0,
+        READ = 1,
+        WRITE = 2,
+        CREATE = 4, // create the file if it does not exist, with permissions 0644
+        TRUNCATE = 8, // discard the existing contents, requires WRITE
+        EXCLUSIVE = 16, // fail with an error if the file already exists, requires CREATE
+        DIRECT = 32, // bypass the page cache. Offsets, sizes and memory of all reads and writes have to be aligned to the logical block size. Ignored where unsupported.
+    };
+
+    static constexpr inline FileOpenFlags operator|(FileOpenFlags lhs, FileOpenFlags rhs) noexcept {
+        return static_cast<FileOpenFlags>(static_cast<uint_fast16_t>(lhs) | static_cast<uint_fast16_t>(rhs));
+    }
+
+    static constexpr inline FileOpenFlags operator&(FileOpenFlags lhs, FileOpenFlags rhs) noexcept {
+        return static_cast<FileOpenFlags>(static_cast<uint_fast16_t>(lhs) & static_cast<uint_fast16_t>(rhs));
+    }
+
+    /// Handle to an open file, obtained through IAsyncFileIO::open. Not thread-safe, use it from the thread of the service that opened it.
+    /// Operations can be in flight concurrently, the caller has to make sure they do not overlap if that matters.
+    /// Destroying the handle closes the file without waiting, call close() to observe errors. Handles outliving the service that created them only return IOError::SERVICE_STOPPED.
+    class IAsyncFile {
+    public:
+        virtual ~IAsyncFile() = default;
+
+        /*
+         * Reads into buffer, starting at offset in the file.
+         * Returns the amount of bytes read, which is only less than the size of the buffer when the end of the file was reached.
+         */
+        virtual Task<tl::expected<uint64_t, IOError>> read(std::span<char> buffer, uint64_t offset) = 0;
+
+        /*
+         * Writes all of buffer, starting at offset in the file. Extends the file if needed.
+         */
+        virtual Task<tl::expected<void, IOError>> write(std::span<char const> buffer, uint64_t offset) = 0;
+
+        /*
+         * Reads into multiple buffers, filling them in order as if they were one contiguous buffer.
+         * Returns the amount of bytes read, which is only less than the combined size of the buffers when the end of the file was reached.
+         */
+        virtual Task<tl::expected<uint64_t, IOError>> readv(std::span<std::span<char> const> buffers, uint64_t offset) = 0;
+
+        /*
+         * Writes multiple buffers back to back, starting at offset in the file.
+         */
+        virtual Task<tl::expected<void, IOError>> writev(std::span<std::span<char const> const> buffers, uint64_t offset) = 0;
+
+        /*
+         * Flushes data and metadata of the file to the storage device, like fsync.
+         */
+        virtual Task<tl::expected<void, IOError>> sync() = 0;
+
+        /*
+         * Flushes the data of the file and only the metadata needed to read it back, like fdatasync.
+         */
+        virtual Task<tl::expected<void, IOError>> dataSync() = 0;
+
+        /*
+         * Reserves disk space for the given range, extending the file size if the range ends beyond it, like fallocate without flags.
+         */
+        virtual Task<tl::expected<void, IOError>> allocate(uint64_t offset, uint64_t length) = 0;
+
+        /*
+         * Returns the current size of the file in bytes.
+         */
+        virtual Task<tl::expected<uint64_t, IOError>> size() = 0;
+
+        /*
+         * Closes the file. Any other operation after this returns IOError::BAD_FILE_DESCRIPTOR.
+         */
+        virtual Task<tl::expected<void, IOError>> close() = 0;
+    };
+}
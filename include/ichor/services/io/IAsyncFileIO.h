@@ -1,7 +1,11 @@
 #pragma once
 
 #include <ichor/coroutines/Task.h>
+#include <ichor/coroutines/AsyncGenerator.h>
+#include <ichor/services/io/IAsyncFile.h>
 #include <ichor/stl/ErrnoUtils.h>
+#include <memory>
+#include <span>
 #include <string>
 #include <string_view>
 #include <filesystem>
@@ -16,6 +20,19 @@ namespace Ichor::v1 {
          */
         virtual Task<tl::expected<std::string, IOError>> readWholeFile(std::filesystem::path const &file) = 0;
 
+        /*
+         * Reads a file in chunks, without holding more than a few chunks in memory. Useful for files that do not fit in RAM.
+         * Each yielded span is only valid until the generator is advanced. On error, the error is yielded and the generator ends.
+         * An empty file yields nothing.
+         */
+        virtual AsyncGenerator<tl::expected<std::span<char const>, IOError>> readFileStream(std::filesystem::path const &file) = 0;
+
+        /*
+         * Opens a file for positional reads and writes, for random access into large files. At least one of READ or WRITE is required.
+         * Keeping the file open avoids resolving the path for every operation.
+         */
+        virtual Task<tl::expected<std::unique_ptr<IAsyncFile>, IOError>> open(std::filesystem::path const &file, FileOpenFlags flags) = 0;
+
         /*
          * Copies the contents of one file to another. This function will also copy the permission bits of the original file to the destination file.
          * This function will overwrite the contents of to.
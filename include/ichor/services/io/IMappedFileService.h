@@ -0,0 +1,83 @@
+#pragma once
+
+#include <ichor/coroutines/Task.h>
+#include <ichor/stl/ErrnoUtils.h>
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <tl/expected.h>
+
+namespace Ichor::v1 {
+    /// Hints for the kernel on how a mapping is going to be used, applied with madvise. Ignored where unsupported.
+    enum class MappedFileHints : uint_fast16_t {
+        NONE = 0,
+        SEQUENTIAL = 1, // read ahead aggressively and drop pages soon after they were read
+        RANDOM = 2, // don't read ahead
+        WILL_NEED = 4, // start reading the whole file into the page cache in the background
+        HUGE_PAGES = 8, // back the mapping with transparent huge pages, needs file systems with large folio support for file mappings
+    };
+
+    static constexpr inline MappedFileHints operator|(MappedFileHints lhs, MappedFileHints rhs) noexcept {
+        return static_cast<MappedFileHints>(static_cast<uint_fast16_t>(lhs) | static_cast<uint_fast16_t>(rhs));
+    }
+
+    static constexpr inline MappedFileHints operator&(MappedFileHints lhs, MappedFileHints rhs) noexcept {
+        return static_cast<MappedFileHints>(static_cast<uint_fast16_t>(lhs) & static_cast<uint_fast16_t>(rhs));
+    }
+
+    /// Read-only view of a file mapped into memory, unmapped when the last reference goes away. Safe to read from any thread.
+    /// Changes made to the file by others while it is mapped are visible, truncating it makes reading past the new end crash with SIGBUS.
+    class MappedFile final {
+    public:
+        MappedFile(std::filesystem::path path, std::byte const *data, uint64_t size, void *nativeMapping) noexcept;
+        MappedFile(MappedFile const &) = delete;
+        MappedFile(MappedFile &&) = delete;
+        MappedFile& operator=(MappedFile const &) = delete;
+        MappedFile& operator=(MappedFile &&) = delete;
+        ~MappedFile();
+
+        [[nodiscard]] std::span<std::byte const> data() const noexcept {
+            return {_data, static_cast<size_t>(_size)};
+        }
+
+        [[nodiscard]] std::string_view view() const noexcept {
+            return {reinterpret_cast<char const *>(_data), static_cast<size_t>(_size)};
+        }
+
+        [[nodiscard]] uint64_t size() const noexcept {
+            return _size;
+        }
+
+        [[nodiscard]] std::filesystem::path const& path() const noexcept {
+            return _path;
+        }
+
+    private:
+        std::filesystem::path _path;
+        std::byte const *_data;
+        uint64_t _size;
+        void *_nativeMapping; // mapping handle on Windows, unused elsewhere
+    };
+
+    class IMappedFileService {
+    public:
+        /*
+         * Maps a file read-only. Mapping the same file again, from any thread, returns the existing mapping as long as it is still referenced,
+         * so large tables loaded by multiple DependencyManagers are only mapped once and share the page cache instead of each holding a copy.
+         * Hints of a later call are applied to the shared mapping as well.
+         * An empty file results in an empty mapping.
+         */
+        virtual tl::expected<std::shared_ptr<MappedFile const>, IOError> map(std::filesystem::path const &file, MappedFileHints hints = MappedFileHints::NONE) = 0;
+
+        /*
+         * Asks the kernel to read the given range of the mapping into the page cache, so that touching it later does not block on page faults.
+         * Does not block the event loop when running on an io_uring queue. A length of 0 means up to the end of the file.
+         */
+        virtual Task<tl::expected<void, IOError>> prefetch(std::shared_ptr<MappedFile const> file, uint64_t offset = 0, uint64_t length = 0) = 0;
+
+    protected:
+        ~IMappedFileService() = default;
+    };
+}
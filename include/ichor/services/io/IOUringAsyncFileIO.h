@@ -13,11 +13,23 @@
 struct io_uring;
 
 namespace Ichor::v1 {
+    /// Properties:
+    /// - "BufferSize" uint32_t, size of the chunks read and written per submission, defaults to 64 KiB, rounded up to a multiple of 4 KiB.
+    /// - "BufferBatchSize" uint32_t, amount of chunks in flight per file operation, also the amount of pooled buffers. Defaults to 64.
+    /// - "StreamReadAhead" uint32_t, amount of chunks readFileStream reads ahead of the consumer, defaults to 4.
+    /// - "RegisterBuffers" bool, register the pooled buffers with the ring to use READ_FIXED/WRITE_FIXED, defaults to true.
+    ///   Falls back to normal reads and writes if the ring already has buffers registered or the memlock limit is too low.
+    /// - "DirectIO" bool, open files for reading with O_DIRECT, bypassing the page cache. Defaults to false.
+    ///   Falls back to buffered I/O for file systems that do not support it.
+    /// - "FixedFiles" bool, add files opened through open() to the fixed file table of the ring, so their operations use IOSQE_FIXED_FILE. Defaults to true.
+    ///   Requires kernel >= 5.19, falls back to normal file descriptors if unsupported or when the table is full.
     class IOUringAsyncFileIO final : public IAsyncFileIO, public AdvancedService<IOUringAsyncFileIO> {
     public:
         IOUringAsyncFileIO(DependencyRegister &reg, Properties props);
 
         Task<tl::expected<std::string, IOError>> readWholeFile(std::filesystem::path const &file) final;
+        AsyncGenerator<tl::expected<std::span<char const>, IOError>> readFileStream(std::filesystem::path const &file) final;
+        Task<tl::expected<std::unique_ptr<IAsyncFile>, IOError>> open(std::filesystem::path const &file, FileOpenFlags flags) final;
         Task<tl::expected<void, IOError>> copyFile(std::filesystem::path const &from, std::filesystem::path const &to) final;
         Task<tl::expected<void, IOError>> removeFile(std::filesystem::path const &file) final;
         Task<tl::expected<void, IOError>> writeFile(std::filesystem::path const &file, std::string_view contents) final;
@@ -29,19 +41,55 @@ namespace Ichor::v1 {
         void removeDependencyInstance(Ichor::ScopedServiceProxy<ILogger*>, IService&) noexcept;
 
     private:
+        struct FileBuffer final {
+            char *data{};
+            int poolIndex{-1}; // -1 if allocated because the pool ran out
+        };
+
+        // State of one chunked read or copy, shared by its completion handlers. Defined in the .cpp.
+        struct FileTransfer;
+        struct FileTransferDeleter final {
+            void operator()(FileTransfer *transfer) const noexcept;
+        };
+        using FileTransferPtr = std::unique_ptr<FileTransfer, FileTransferDeleter>;
+
+        // IAsyncFile implementation and the state it and file transfers share with this service, so they can outlive it. Defined in the .cpp.
+        class AsyncFile;
+        struct AsyncFileContext;
+
         Task<tl::expected<void, Ichor::StartError>> start() final;
         Task<void> stop() final;
 
-        void recursiveSubmitReadWholeFile(AsyncManualResetEvent &evt, int &res, std::string &contents, uint64_t &sizeLeft, uint64_t offset, uint64_t fileSize, int fd, uint32_t maxSubmissions);
-        std::function<void(io_uring_cqe*)> createNewEventHandlerReadWholeFile(AsyncManualResetEvent &evt, int &res, std::string &contents, uint64_t &sizeLeft, uint64_t fileSize, int fd, uint32_t maxSubmissions, uint64_t offset, char *buf, bool isLastInBatch);
-        void recursiveSubmitCopyFile(AsyncManualResetEvent &evt, int &res, uint64_t &sizeLeft, uint64_t offset, uint64_t fileSize, int fromFd, int toFd, uint32_t maxSubmissions);
-        std::function<void(io_uring_cqe*)> createNewEventHandlerCopyFileReadPart(AsyncManualResetEvent &evt, int &res, uint64_t &sizeLeft, uint64_t fileSize, int fromFd, int toFd, uint32_t maxSubmissions, uint64_t offset, char *buf, bool isLastInBatch);
-        std::function<void(io_uring_cqe*)> createNewEventHandlerCopyFileWritePart(Ichor::AsyncManualResetEvent &evt, int &res, char *buf, bool isLastInBatch);
+        /// \return file descriptor or negative errno
+        Task<int> openFile(std::filesystem::path const &file, int flags, unsigned int mode);
+        Task<tl::expected<uint64_t, IOError>> fileSize(int fd);
+        void closeFile(int fd);
+
+        [[nodiscard]] FileBuffer acquireBuffer();
+        void releaseBuffer(FileBuffer &buf) noexcept;
+
+        /// \return 0 or negative errno
+        int startTransfer(FileTransfer &transfer, uint64_t fileSize, uint64_t maxSlots);
+        void submitTransfer(FileTransfer &transfer, uint32_t slot);
+        void handleTransferCompletion(FileTransfer &transfer, uint32_t slot, int res);
+        void finishChunk(FileTransfer &transfer, uint32_t slot);
+        bool assignNextChunk(FileTransfer &transfer, uint32_t slot);
 
         Ichor::ScopedServiceProxy<IIOUringQueue*> _q {};
         Ichor::ScopedServiceProxy<ILogger*> _logger {};
         uint32_t _bufferSize{64*1024};
         uint32_t _bufferBatchSize{64};
+        uint32_t _streamReadAhead{4};
+        bool _registerBuffers{true};
+        bool _directIO{};
+        bool _fixedFiles{true};
+        bool _buffersRegistered{};
         bool _shouldStop{};
+        char *_bufferMemory{}; // _bufferBatchSize buffers of _bufferSize, aligned for O_DIRECT
+        std::vector<int> _freeBuffers{};
+        std::shared_ptr<AsyncFileContext> _fileContext{};
+        std::vector<FileTransfer*> _transfers{}; // started and not yet destroyed
+        uint64_t _transfersInFlight{}; // submissions of all transfers
+        AsyncManualResetEvent _transfersDone{}; // set when stopping and the last submission completed
     };
 }
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <ichor/services/io/IMappedFileService.h>
+#include <ichor/dependency_management/AdvancedService.h>
+#include <ichor/dependency_management/DependencyRegister.h>
+#include <ichor/ScopedServiceProxy.h>
+#ifdef ICHOR_USE_LIBURING
+#include <ichor/event_queues/IIOUringQueue.h>
+#endif
+
+namespace Ichor::v1 {
+    /// Maps files with mmap, or MapViewOfFile on Windows. Mappings are shared by all instances in the process.
+    /// When running on an io_uring queue, prefetching is submitted as IORING_OP_MADVISE instead of calling madvise on the event loop.
+    class MappedFileService final : public IMappedFileService, public AdvancedService<MappedFileService> {
+    public:
+        MappedFileService(DependencyRegister &reg, Properties props);
+
+        tl::expected<std::shared_ptr<MappedFile const>, IOError> map(std::filesystem::path const &file, MappedFileHints hints) final;
+        Task<tl::expected<void, IOError>> prefetch(std::shared_ptr<MappedFile const> file, uint64_t offset, uint64_t length) final;
+
+#ifdef ICHOR_USE_LIBURING
+        void addDependencyInstance(Ichor::ScopedServiceProxy<IIOUringQueue*>, IService&) noexcept;
+        void removeDependencyInstance(Ichor::ScopedServiceProxy<IIOUringQueue*>, IService&) noexcept;
+#endif
+
+    private:
+        Task<tl::expected<void, Ichor::StartError>> start() final;
+        Task<void> stop() final;
+
+#ifdef ICHOR_USE_LIBURING
+        Ichor::ScopedServiceProxy<IIOUringQueue*> _q {};
+#endif
+    };
+}
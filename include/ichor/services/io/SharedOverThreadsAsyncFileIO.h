@@ -4,10 +4,8 @@
 #include <ichor/coroutines/AsyncManualResetEvent.h>
 #include <ichor/dependency_management/AdvancedService.h>
 #include <ichor/stl/ErrnoUtils.h>
-#include <queue>
-#include <mutex>
-#include <thread>
-#include <atomic>
+#include <functional>
+#include <memory>
 
 namespace Ichor::v1 {
     struct io_operation_submission final {
@@ -16,11 +14,16 @@ namespace Ichor::v1 {
         std::function<void(decltype(result)&)> fn;
     };
 
+    /// Runs blocking file I/O on a pool of worker threads, shared by all instances in the process.
+    /// Properties:
+    /// - "WorkerThreads" uint32_t, amount of worker threads, defaults to 4. Only the instance that starts the pool decides its size.
     class SharedOverThreadsAsyncFileIO final : public IAsyncFileIO, public AdvancedService<SharedOverThreadsAsyncFileIO> {
     public:
         SharedOverThreadsAsyncFileIO(Properties props);
 
         Task<tl::expected<std::string, IOError>> readWholeFile(std::filesystem::path const &file) final;
+        AsyncGenerator<tl::expected<std::span<char const>, IOError>> readFileStream(std::filesystem::path const &file) final;
+        Task<tl::expected<std::unique_ptr<IAsyncFile>, IOError>> open(std::filesystem::path const &file, FileOpenFlags flags) final;
         Task<tl::expected<void, IOError>> copyFile(std::filesystem::path const &from, std::filesystem::path const &to) final;
         Task<tl::expected<void, IOError>> removeFile(std::filesystem::path const &file) final;
         Task<tl::expected<void, IOError>> writeFile(std::filesystem::path const &file, std::string_view contents) final;
@@ -30,10 +33,16 @@ namespace Ichor::v1 {
         Task<tl::expected<void, Ichor::StartError>> start() final;
         Task<void> stop() final;
 
-        static std::atomic<bool> _initialized;
-        static std::mutex _io_mutex;
-        static std::queue<std::shared_ptr<io_operation_submission>> _evts;
-        std::atomic<bool> _should_stop{};
-        tl::optional<std::thread> _io_thread;
+        // Defined in the .cpp
+        struct CompletionBatch;
+        struct WorkerPool;
+        class AsyncFile;
+
+        /// Queues the submission for the worker threads, its evt is set on the queue of this instance once it has run
+        void submit(std::shared_ptr<io_operation_submission> submission);
+
+        static WorkerPool _pool;
+        uint32_t _workerThreads{4};
+        std::shared_ptr<CompletionBatch> _completions;
     };
 }
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <ichor/dependency_management/AdvancedService.h>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace Ichor::v1 {
+    enum class AsyncLogOverflowPolicy : uint_fast16_t {
+        // discard the line and count it, unless "ReportDrops" is false the writer reports the amount of dropped lines once there is space again
+        DROP,
+        // spin until the writer thread made enough space
+        BLOCK,
+    };
+
+    class IAsyncLogSink {
+    public:
+        /// Copies a fully formatted line, including line ending, into the ring of the current thread. Only call from the thread of the owning DependencyManager.
+        /// \param line bytes to write
+        /// \return false if the line was dropped
+        virtual bool push(std::string_view line) noexcept = 0;
+        [[nodiscard]] virtual uint64_t getDroppedCount() const noexcept = 0;
+    protected:
+        ~IAsyncLogSink() = default;
+    };
+
+    namespace Detail {
+        struct AsyncLogRing;
+    }
+
+    /// One per DependencyManager. Owns a single producer/single consumer byte ring that one writer thread, shared by all sinks in the process, drains in batches with writev.
+    /// Properties:
+    /// - "OverflowPolicy" AsyncLogOverflowPolicy, defaults to DROP
+    /// - "RingSize" uint64_t bytes, rounded up to a power of two, defaults to 1 MiB
+    /// - "LogFile" std::string path to append to, defaults to stdout
+    /// - "ReportDrops" bool write a text line with the amount of dropped lines after drops, defaults to true. Turn off for binary logs, e.g. BinaryLogger's.
+    class AsyncLogSink final : public IAsyncLogSink, public AdvancedService<AsyncLogSink> {
+    public:
+        AsyncLogSink(Properties props);
+        ~AsyncLogSink() final;
+
+        bool push(std::string_view line) noexcept final;
+        [[nodiscard]] uint64_t getDroppedCount() const noexcept final;
+
+    private:
+        Task<tl::expected<void, Ichor::StartError>> start() final;
+        Task<void> stop() final;
+
+        friend DependencyRegister;
+
+        std::shared_ptr<Detail::AsyncLogRing> _ring;
+        AsyncLogOverflowPolicy _policy{AsyncLogOverflowPolicy::DROP};
+        uint64_t _ringSize{1024 * 1024};
+        std::string _logFile;
+        bool _reportDrops{true};
+    };
+}
+
+template <>
+struct fmt::formatter<Ichor::v1::AsyncLogOverflowPolicy> {
+    constexpr auto parse(format_parse_context& ctx) {
+        return ctx.end();
+    }
+
+    template <typename FormatContext>
+    auto format(const Ichor::v1::AsyncLogOverflowPolicy& policy, FormatContext& ctx) const {
+        switch(policy) {
+            case Ichor::v1::AsyncLogOverflowPolicy::DROP:
+                return fmt::format_to(ctx.out(), "DROP");
+            case Ichor::v1::AsyncLogOverflowPolicy::BLOCK:
+                return fmt::format_to(ctx.out(), "BLOCK");
+        }
+        return fmt::format_to(ctx.out(), "error, please file a bug in Ichor");
+    }
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <ichor/dependency_management/AdvancedService.h>
+#include <ichor/services/logging/Logger.h>
+#include <ichor/services/logging/AsyncLogSink.h>
+#include <ichor/ScopedServiceProxy.h>
+
+namespace Ichor::v1 {
+    /// Formats on the calling thread and hands the result to IAsyncLogSink, so the event loop never waits on a terminal or disk.
+    /// fmt::format_args only references the arguments of the logging call, which is why formatting cannot be deferred to the writer thread.
+    class AsyncLogger final : public ILogger, public AdvancedService<AsyncLogger> {
+    public:
+        AsyncLogger(DependencyRegister &reg, Properties props);
+        ~AsyncLogger() final = default;
+
+        void trace(const char *filename_in, int line_in, const char *funcname_in, std::string_view format_str, fmt::format_args args) final;
+        void debug(const char *filename_in, int line_in, const char *funcname_in, std::string_view format_str, fmt::format_args args) final;
+        void info(const char *filename_in, int line_in, const char *funcname_in, std::string_view format_str, fmt::format_args args) final;
+        void warn(const char *filename_in, int line_in, const char *funcname_in, std::string_view format_str, fmt::format_args args) final;
+        void error(const char *filename_in, int line_in, const char *funcname_in, std::string_view format_str, fmt::format_args args) final;
+
+        void addDependencyInstance(Ichor::ScopedServiceProxy<IAsyncLogSink*> sink, IService &isvc) noexcept;
+        void removeDependencyInstance(Ichor::ScopedServiceProxy<IAsyncLogSink*> sink, IService &isvc) noexcept;
+
+        void setLogLevel(LogLevel level) noexcept final;
+        [[nodiscard]] LogLevel getLogLevel() const noexcept final;
+
+    private:
+        void log(const char *filename_in, int line_in, std::string_view format_str, fmt::format_args args);
+
+        friend DependencyRegister;
+
+        LogLevel _level{LogLevel::LOG_WARN};
+        Ichor::ScopedServiceProxy<IAsyncLogSink*> _sink {};
+    };
+}
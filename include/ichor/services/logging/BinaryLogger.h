@@ -0,0 +1,75 @@
+#pragma once
+
+#include <ichor/dependency_management/AdvancedService.h>
+#include <ichor/services/logging/Logger.h>
+#include <ichor/services/logging/AsyncLogSink.h>
+#include <ichor/ScopedServiceProxy.h>
+#include <tl/expected.h>
+#include <functional>
+#include <span>
+#include <string>
+
+namespace Ichor::v1 {
+    enum class BinaryLogArgType : uint8_t {
+        INT64,
+        UINT64,
+        BOOL,
+        CHAR,
+        DOUBLE,
+        // uint32_t size followed by the bytes
+        STRING,
+        POINTER,
+    };
+
+    /// Copies the format string and arguments of every log statement into IAsyncLogSink without formatting them. Use decodeBinaryLog to get the text back offline.
+    /// Use an AsyncLogSink with a "LogFile" that no other logger writes to and "ReportDrops" set to false, or use the BLOCK overflow policy.
+    ///
+    /// Records are in native endianness:
+    /// uint32_t size of the whole record, uint64_t nanoseconds since the unix epoch, uint8_t LogLevel, uint32_t line,
+    /// uint16_t size + filename, uint16_t size + format string, uint8_t amount of arguments, then per argument a BinaryLogArgType followed by its value.
+    /// When an argument is not one of the fmt builtin types, the message gets formatted on the calling thread and stored as "{}" with a single string argument.
+    class BinaryLogger final : public ILogger, public AdvancedService<BinaryLogger> {
+    public:
+        BinaryLogger(DependencyRegister &reg, Properties props);
+        ~BinaryLogger() final = default;
+
+        void trace(const char *filename_in, int line_in, const char *funcname_in, std::string_view format_str, fmt::format_args args) final;
+        void debug(const char *filename_in, int line_in, const char *funcname_in, std::string_view format_str, fmt::format_args args) final;
+        void info(const char *filename_in, int line_in, const char *funcname_in, std::string_view format_str, fmt::format_args args) final;
+        void warn(const char *filename_in, int line_in, const char *funcname_in, std::string_view format_str, fmt::format_args args) final;
+        void error(const char *filename_in, int line_in, const char *funcname_in, std::string_view format_str, fmt::format_args args) final;
+
+        void addDependencyInstance(Ichor::ScopedServiceProxy<IAsyncLogSink*> sink, IService &isvc) noexcept;
+        void removeDependencyInstance(Ichor::ScopedServiceProxy<IAsyncLogSink*> sink, IService &isvc) noexcept;
+
+        void setLogLevel(LogLevel level) noexcept final;
+        [[nodiscard]] LogLevel getLogLevel() const noexcept final;
+
+    private:
+        void log(LogLevel level, const char *filename_in, int line_in, std::string_view format_str, fmt::format_args args);
+
+        friend DependencyRegister;
+
+        LogLevel _level{LogLevel::LOG_WARN};
+        Ichor::ScopedServiceProxy<IAsyncLogSink*> _sink {};
+    };
+
+    struct DecodedLogRecord final {
+        uint64_t timestampNs{};
+        LogLevel level{};
+        std::string_view filename{};
+        uint32_t line{};
+        std::string message{};
+    };
+
+    enum class BinaryLogDecodeError : uint_fast16_t {
+        MALFORMED_RECORD,
+        UNKNOWN_ARGUMENT_TYPE,
+    };
+
+    /// Formats records written by BinaryLogger.
+    /// \param data contents of the log file, may end in a partially written record
+    /// \param fn called for every complete record, in order
+    /// \return amount of bytes consumed, to continue from when more data is available
+    tl::expected<uint64_t, BinaryLogDecodeError> decodeBinaryLog(std::span<char const> data, std::function<void(DecodedLogRecord const &)> const &fn);
+}
@@ -2,6 +2,7 @@
 
 #include <ichor/interfaces/IFrameworkLogger.h>
 #include <ichor/Enums.h>
+#include <ichor/Properties.h>
 
 namespace Ichor::v1 {
     class ILogger {
@@ -19,3 +20,10 @@ namespace Ichor::v1 {
         ~ILogger() = default;
     };
 }
+
+namespace Ichor::PropertyKeys {
+    /// Level of an ILogger or IFrameworkLogger
+    inline constexpr PropertyKey<Ichor::LogLevel> LogLevel{"LogLevel"};
+    /// Level of the loggers created by a LoggerFactory for services that do not request one
+    inline constexpr PropertyKey<Ichor::LogLevel> DefaultLogLevel{"DefaultLogLevel"};
+}
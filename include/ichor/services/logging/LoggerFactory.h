@@ -21,9 +21,8 @@ namespace Ichor::v1 {
         LoggerFactory(DependencyRegister &reg, Properties props) : AdvancedService<LoggerFactory<LogT>>(std::move(props)) {
             reg.registerDependency<IFrameworkLogger>(this, DependencyFlags::REQUIRED);
 
-            auto logLevelProp = AdvancedService<LoggerFactory<LogT>>::getProperties().find("DefaultLogLevel");
-            if(logLevelProp != end(AdvancedService<LoggerFactory<LogT>>::getProperties())) {
-                setDefaultLogLevel(Ichor::v1::any_cast<LogLevel>(logLevelProp->second));
+            if(auto const *logLevel = AdvancedService<LoggerFactory<LogT>>::getProperties().get(PropertyKeys::DefaultLogLevel); logLevel != nullptr) {
+                setDefaultLogLevel(*logLevel);
             }
         }
         ~LoggerFactory() final = default;
@@ -61,14 +60,15 @@ namespace Ichor::v1 {
             if (logger == end(_loggers)) {
                 auto requestedLevel = _defaultLevel;
                 if(evt.properties.has_value()) {
-                    auto requestedLevelIt = evt.properties.value()->find("LogLevel");
-                    requestedLevel = requestedLevelIt != end(*evt.properties.value()) ? Ichor::v1::any_cast<LogLevel>(requestedLevelIt->second) : requestedLevel;
+                    if(auto const *level = evt.properties.value()->get(PropertyKeys::LogLevel); level != nullptr) {
+                        requestedLevel = *level;
+                    }
                 }
 
                 Properties props{};
                 props.reserve(2);
-                props.template emplace<>("Filter", Ichor::v1::make_any<Filter>(ServiceIdFilterEntry{evt.originatingService}));
-                props.template emplace<>("LogLevel", Ichor::v1::make_any<LogLevel>(requestedLevel));
+                props.set(PropertyKeys::Filter, ServiceIdFilterEntry{evt.originatingService});
+                props.set(PropertyKeys::LogLevel, requestedLevel);
                 auto newLogger = GetThreadLocalManager().template createServiceManager<LogT, ILogger>(std::move(props), evt.priority);
                 _loggers.emplace(evt.originatingService, newLogger->getServiceId());
                 ICHOR_LOG_TRACE(_logger, "created logger for svcid {}", evt.originatingService);
@@ -3,48 +3,78 @@
 #include <ichor/dependency_management/AdvancedService.h>
 #include <ichor/dependency_management/DependencyRegistrations.h>
 #include <ichor/services/logging/Logger.h>
+#include <ichor/services/metrics/LatencyHistogram.h>
 #include <ichor/services/timer/ITimerFactory.h>
 #include <chrono>
+#include <memory>
+#include <vector>
 #include <ichor/ScopedServiceProxy.h>
 
 namespace Ichor::v1 {
 
-    struct StatisticEntry {
-        StatisticEntry() = default;
-        StatisticEntry(int64_t _timestamp, int64_t _processingTimeRequired) : timestamp(_timestamp), processingTimeRequired(_processingTimeRequired) {}
-        int64_t timestamp{};
-        int64_t processingTimeRequired{};
+    struct EventStatisticKey final {
+        uint64_t eventType{};
+        // service that pushed the event, which for RunFunctionEvents and timers is also the service whose code ran
+        ServiceIdType originatingService{};
+
+        bool operator==(EventStatisticKey const &) const noexcept = default;
     };
 
-    struct AveragedStatisticEntry {
-        AveragedStatisticEntry() = default;
-        AveragedStatisticEntry(int64_t _timestamp, int64_t _minProcessingTimeRequired, int64_t _maxProcessingTimeRequired, int64_t _avgProcessingTimeRequired, int64_t _occurrences) :
-            timestamp(_timestamp), minProcessingTimeRequired(_minProcessingTimeRequired), maxProcessingTimeRequired(_maxProcessingTimeRequired), avgProcessingTimeRequired(_avgProcessingTimeRequired),
-            occurrences(_occurrences) {}
-        int64_t timestamp{};
-        int64_t minProcessingTimeRequired{};
-        int64_t maxProcessingTimeRequired{};
-        int64_t avgProcessingTimeRequired{};
-        int64_t occurrences{};
+    struct EventStatisticKeyHash final {
+        using is_avalanching = void;
+
+        uint64_t operator()(EventStatisticKey const &key) const noexcept {
+            return ankerl::unordered_dense::detail::wyhash::mix(key.eventType, key.originatingService.value);
+        }
+    };
+
+    struct EventStatisticSummary final {
+        EventStatisticKey key{};
+        std::string_view eventName{};
+        uint64_t occurrences{};
+        uint64_t minProcessingTimeNs{};
+        uint64_t p50ProcessingTimeNs{};
+        uint64_t p99ProcessingTimeNs{};
+        uint64_t p999ProcessingTimeNs{};
+        uint64_t maxProcessingTimeNs{};
+        uint64_t avgProcessingTimeNs{};
     };
 
     class IEventStatisticsService {
     public:
-        [[nodiscard]] virtual const unordered_map<uint64_t, std::vector<StatisticEntry>>& getRecentStatistics() const noexcept = 0;
-        [[nodiscard]] virtual const unordered_map<uint64_t, std::vector<AveragedStatisticEntry>>& getAverageStatistics() const noexcept = 0;
+        /// Statistics of every interval that finished since starting
+        [[nodiscard]] virtual std::vector<EventStatisticSummary> getTotalStatistics() const = 0;
+        /// Statistics of the last finished interval, see "AveragingIntervalMs"
+        [[nodiscard]] virtual std::vector<EventStatisticSummary> getLastIntervalStatistics() const = 0;
+        /// \return histogram of processing times in ns for every finished interval since starting, nullptr if the combination has not been seen
+        [[nodiscard]] virtual LatencyHistogram const * getTotalHistogram(EventStatisticKey const &key) const noexcept = 0;
 
     protected:
         ~IEventStatisticsService() = default;
     };
 
+    /// Measures the processing time of every event per event type and originating service.
+    /// Memory use only depends on the amount of combinations seen, every combination uses three fixed size histograms.
+    /// Combinations of services that have been removed are dropped after an interval without events.
+    /// Properties:
+    /// - "ShowStatisticsOnStop" bool, required
+    /// - "AveragingIntervalMs" uint64_t, how often the current histograms are rolled into the totals, defaults to 500
     class EventStatisticsService final : public IEventStatisticsService, public AdvancedService<EventStatisticsService> {
     public:
         EventStatisticsService(DependencyRegister &reg, Properties props);
         ~EventStatisticsService() final = default;
 
-        const unordered_map<uint64_t, std::vector<StatisticEntry>>& getRecentStatistics() const noexcept final;
-        const unordered_map<uint64_t, std::vector<AveragedStatisticEntry>>& getAverageStatistics() const noexcept final;
+        [[nodiscard]] std::vector<EventStatisticSummary> getTotalStatistics() const final;
+        [[nodiscard]] std::vector<EventStatisticSummary> getLastIntervalStatistics() const final;
+        [[nodiscard]] LatencyHistogram const * getTotalHistogram(EventStatisticKey const &key) const noexcept final;
     private:
+        struct EventStatistics final {
+            std::string_view eventName;
+            LatencyHistogram current{};
+            LatencyHistogram lastInterval{};
+            LatencyHistogram total{};
+        };
+
         bool preInterceptEvent(Event const &evt);
         void postInterceptEvent(Event const &evt, bool processed);
 
@@ -54,7 +84,7 @@ namespace Ichor::v1 {
         void addDependencyInstance(Ichor::ScopedServiceProxy<ITimerFactory*> factory, IService &);
         void removeDependencyInstance(Ichor::ScopedServiceProxy<ITimerFactory*> factory, IService&);
 
-        void calculateAverage();
+        void finishInterval();
 
         Task<tl::expected<void, Ichor::StartError>> start() final;
         Task<void> stop() final;
@@ -62,9 +92,8 @@ namespace Ichor::v1 {
         friend DependencyRegister;
         friend DependencyManager;
 
-        unordered_map<uint64_t, std::vector<StatisticEntry>> _recentEventStatistics;
-        unordered_map<uint64_t, std::vector<AveragedStatisticEntry>> _averagedStatistics;
-        unordered_map<uint64_t, std::string_view> _eventTypeToNameMapper;
+        // histograms are a few KB, keep them out of the contiguous storage of the map
+        unordered_map<EventStatisticKey, std::unique_ptr<EventStatistics>, EventStatisticKeyHash> _statistics;
         std::chrono::time_point<std::chrono::steady_clock> _startProcessingTimestamp{};
         bool _showStatisticsOnStop{false};
         uint64_t _averagingIntervalMs{500};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Ichor::v1 {
+    enum class MetricType : uint_fast16_t {
+        COUNTER,
+        GAUGE,
+        HISTOGRAM,
+    };
+
+    struct MetricLabel final {
+        std::string_view name;
+        std::string_view value;
+    };
+
+    // Metrics have a single writer: the thread of the DependencyManager owning the registry.
+    // Updates are therefore plain relaxed load/store pairs, no read-modify-write, and the scrape path only ever reads.
+
+    class MetricCounter final {
+    public:
+        void inc(uint64_t n = 1) noexcept {
+            _value.store(_value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] uint64_t value() const noexcept {
+            return _value.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<uint64_t> _value{};
+    };
+
+    class MetricGauge final {
+    public:
+        void set(int64_t value) noexcept {
+            _value.store(value, std::memory_order_relaxed);
+        }
+
+        void inc(int64_t n = 1) noexcept {
+            _value.store(_value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+
+        void dec(int64_t n = 1) noexcept {
+            _value.store(_value.load(std::memory_order_relaxed) - n, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] int64_t value() const noexcept {
+            return _value.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<int64_t> _value{};
+    };
+
+    /// Histogram with fixed, inclusive upper bounds, rendered as cumulative "le" buckets.
+    class MetricHistogram final {
+    public:
+        explicit MetricHistogram(std::span<uint64_t const> upperBounds) : _upperBounds(upperBounds.begin(), upperBounds.end()), _counts(std::make_unique<std::atomic<uint64_t>[]>(upperBounds.size() + 1)) {}
+
+        void record(uint64_t value) noexcept {
+            size_t i{};
+            while(i < _upperBounds.size() && value > _upperBounds[i]) {
+                i++;
+            }
+            _counts[i].store(_counts[i].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            _sum.store(_sum.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] std::span<uint64_t const> upperBounds() const noexcept {
+            return _upperBounds;
+        }
+
+        /// \param index bucket index, upperBounds().size() being the +Inf bucket
+        /// \return non-cumulative amount of values recorded in the bucket
+        [[nodiscard]] uint64_t bucketCount(size_t index) const noexcept {
+            return _counts[index].load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] uint64_t sum() const noexcept {
+            return _sum.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::vector<uint64_t> _upperBounds;
+        std::unique_ptr<std::atomic<uint64_t>[]> _counts;
+        std::atomic<uint64_t> _sum{};
+    };
+
+    /// Bounds in ns from 1 µs to 10 s, useful for most latencies
+    inline constexpr uint64_t DEFAULT_LATENCY_BOUNDS_NS[] = {1'000, 10'000, 100'000, 1'000'000, 10'000'000, 100'000'000, 1'000'000'000, 10'000'000'000};
+
+    class IMetricsRegistry {
+    public:
+        /// Gets or creates a metric. The returned reference stays valid until the registry is stopped.
+        /// Requesting an existing name with another type terminates, the help text of the first registration is kept.
+        /// Only call these and update the returned metrics from the thread of the registry.
+        virtual MetricCounter& counter(std::string_view name, std::string_view help, std::span<MetricLabel const> labels = {}) = 0;
+        virtual MetricGauge& gauge(std::string_view name, std::string_view help, std::span<MetricLabel const> labels = {}) = 0;
+        /// Histograms with the same name have to use the same bounds, differing ones are left out when scraping
+        virtual MetricHistogram& histogram(std::string_view name, std::string_view help, std::span<uint64_t const> upperBounds = DEFAULT_LATENCY_BOUNDS_NS, std::span<MetricLabel const> labels = {}) = 0;
+
+    protected:
+        ~IMetricsRegistry() = default;
+    };
+}
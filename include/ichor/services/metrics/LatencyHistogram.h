@@ -0,0 +1,132 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+
+namespace Ichor::v1 {
+    /// Fixed size log-linear histogram, similar to HdrHistogram. Every power of two is split into SUB_BUCKET_HALF_COUNT linear buckets,
+    /// so a reported value is less than 1 / SUB_BUCKET_HALF_COUNT (6.25%) above the recorded one. Covers the full uint64_t range without allocating.
+    class LatencyHistogram final {
+    public:
+        static constexpr uint64_t SUB_BUCKET_BITS = 5;
+        static constexpr uint64_t SUB_BUCKET_COUNT = 1ull << SUB_BUCKET_BITS;
+        static constexpr uint64_t SUB_BUCKET_HALF_COUNT = SUB_BUCKET_COUNT / 2;
+        static constexpr uint64_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_HALF_COUNT + SUB_BUCKET_HALF_COUNT;
+
+        constexpr void record(uint64_t value) noexcept {
+            _counts[bucketIndex(value)]++;
+            _count++;
+            _sum += value;
+            if(value < _min) {
+                _min = value;
+            }
+            if(value > _max) {
+                _max = value;
+            }
+        }
+
+        constexpr void merge(LatencyHistogram const &o) noexcept {
+            if(o._count == 0) {
+                return;
+            }
+            for(uint64_t i = 0; i < BUCKET_COUNT; i++) {
+                _counts[i] += o._counts[i];
+            }
+            _count += o._count;
+            _sum += o._sum;
+            if(o._min < _min) {
+                _min = o._min;
+            }
+            if(o._max > _max) {
+                _max = o._max;
+            }
+        }
+
+        constexpr void reset() noexcept {
+            _counts = {};
+            _count = 0;
+            _sum = 0;
+            _min = std::numeric_limits<uint64_t>::max();
+            _max = 0;
+        }
+
+        [[nodiscard]] constexpr uint64_t count() const noexcept {
+            return _count;
+        }
+
+        [[nodiscard]] constexpr uint64_t min() const noexcept {
+            return _count == 0 ? 0 : _min;
+        }
+
+        [[nodiscard]] constexpr uint64_t max() const noexcept {
+            return _max;
+        }
+
+        [[nodiscard]] constexpr uint64_t mean() const noexcept {
+            return _count == 0 ? 0 : _sum / _count;
+        }
+
+        [[nodiscard]] constexpr uint64_t sum() const noexcept {
+            return _sum;
+        }
+
+        /// \param percentile between 0 and 100, e.g. 99.9
+        /// \return the highest value that falls in the same bucket as the requested percentile, capped to the recorded maximum
+        [[nodiscard]] constexpr uint64_t valueAtPercentile(double percentile) const noexcept {
+            if(_count == 0) {
+                return 0;
+            }
+            if(percentile <= 0.) {
+                return _min;
+            }
+            if(percentile > 100.) {
+                percentile = 100.;
+            }
+
+            auto target = static_cast<uint64_t>(percentile / 100. * static_cast<double>(_count) + 0.5);
+            if(target == 0) {
+                target = 1;
+            }
+
+            uint64_t seen{};
+            for(uint64_t i = 0; i < BUCKET_COUNT; i++) {
+                seen += _counts[i];
+                if(seen >= target) {
+                    auto const highest = bucketHighestValue(i);
+                    if(highest < _min) {
+                        return _min;
+                    }
+                    return highest > _max ? _max : highest;
+                }
+            }
+
+            return _max;
+        }
+
+        [[nodiscard]] static constexpr uint64_t bucketIndex(uint64_t value) noexcept {
+            if(value < SUB_BUCKET_COUNT) {
+                return value;
+            }
+            auto const shift = static_cast<uint64_t>(std::bit_width(value)) - SUB_BUCKET_BITS;
+            return shift * SUB_BUCKET_HALF_COUNT + (value >> shift);
+        }
+
+        [[nodiscard]] static constexpr uint64_t bucketHighestValue(uint64_t index) noexcept {
+            if(index < SUB_BUCKET_COUNT) {
+                return index;
+            }
+            auto const shift = index / SUB_BUCKET_HALF_COUNT - 1;
+            auto const subBucket = index % SUB_BUCKET_HALF_COUNT + SUB_BUCKET_HALF_COUNT;
+            return ((subBucket + 1) << shift) - 1;
+        }
+
+    private:
+        std::array<uint64_t, BUCKET_COUNT> _counts{};
+        uint64_t _count{};
+        uint64_t _sum{};
+        uint64_t _min{std::numeric_limits<uint64_t>::max()};
+        uint64_t _max{};
+    };
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <ichor/dependency_management/AdvancedService.h>
+#include <ichor/services/network/http/IHttpHostService.h>
+#include <ichor/ScopedServiceProxy.h>
+
+namespace Ichor::v1 {
+    /// Serves formatMetricsText() on every injected IHttpHostService, for Prometheus or any other OpenMetrics compatible scraper.
+    /// The response is rendered on the thread of the host, the threads being scraped are not involved.
+    /// Properties:
+    /// - "Route" std::string, defaults to "/metrics"
+    class MetricsHttpService final : public AdvancedService<MetricsHttpService> {
+    public:
+        MetricsHttpService(DependencyRegister &reg, Properties props);
+        ~MetricsHttpService() final = default;
+
+    private:
+        void addDependencyInstance(Ichor::ScopedServiceProxy<IHttpHostService*> host, IService &);
+        void removeDependencyInstance(Ichor::ScopedServiceProxy<IHttpHostService*> host, IService&);
+
+        Task<tl::expected<void, Ichor::StartError>> start() final;
+        Task<void> stop() final;
+
+        friend DependencyRegister;
+
+        // the route matcher refers to this
+        std::string _route{"/metrics"};
+        unordered_map<ServiceIdType, HttpRouteRegistration, ServiceIdHash> _routeRegistrations{};
+    };
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <ichor/dependency_management/AdvancedService.h>
+#include <ichor/dependency_management/DependencyRegistrations.h>
+#include <ichor/services/metrics/IMetricsRegistry.h>
+#include <ichor/services/timer/ITimerFactory.h>
+#include <array>
+#include <mutex>
+#include <variant>
+#include <ichor/ScopedServiceProxy.h>
+
+namespace Ichor::v1 {
+    /// Holds the metrics of one DependencyManager, create one in every manager that should be scraped.
+    /// Besides user defined metrics, it samples the manager's queue size, coroutine count, service states and, for io_uring queues, ring utilization.
+    /// Properties:
+    /// - "SampleIntervalMs" uint64_t, how often the framework internals are sampled, defaults to 1000
+    /// - "CountEvents" bool, count every dispatched event per type in ichor_events_total using an event interceptor, defaults to true
+    class MetricsRegistryService final : public IMetricsRegistry, public AdvancedService<MetricsRegistryService> {
+    public:
+        MetricsRegistryService(DependencyRegister &reg, Properties props);
+        ~MetricsRegistryService() final = default;
+
+        MetricCounter& counter(std::string_view name, std::string_view help, std::span<MetricLabel const> labels = {}) final;
+        MetricGauge& gauge(std::string_view name, std::string_view help, std::span<MetricLabel const> labels = {}) final;
+        MetricHistogram& histogram(std::string_view name, std::string_view help, std::span<uint64_t const> upperBounds = DEFAULT_LATENCY_BOUNDS_NS, std::span<MetricLabel const> labels = {}) final;
+
+    private:
+        struct MetricSeries final {
+            std::string labels; // rendered, e.g. {state="active"}, empty if no labels
+            std::variant<std::unique_ptr<MetricCounter>, std::unique_ptr<MetricGauge>, std::unique_ptr<MetricHistogram>> metric;
+        };
+
+        struct MetricFamily final {
+            std::string name;
+            std::string help;
+            MetricType type;
+            std::vector<MetricSeries> series;
+        };
+
+        // upperBounds is only used when creating a histogram series
+        MetricSeries& findOrCreateSeries(std::string_view name, std::string_view help, MetricType type, std::span<uint64_t const> upperBounds, std::span<MetricLabel const> labels);
+
+        bool preInterceptEvent(Event const &evt);
+        void postInterceptEvent(Event const &evt, bool processed);
+
+        void addDependencyInstance(Ichor::ScopedServiceProxy<ITimerFactory*> factory, IService &);
+        void removeDependencyInstance(Ichor::ScopedServiceProxy<ITimerFactory*> factory, IService&);
+
+        void sample();
+
+        Task<tl::expected<void, Ichor::StartError>> start() final;
+        Task<void> stop() final;
+
+        friend DependencyRegister;
+        friend DependencyManager;
+        friend std::string formatMetricsText();
+
+        // only taken when adding metrics and when scraping, updating metrics is lock-free
+        mutable std::mutex _familiesMutex{};
+        std::vector<MetricFamily> _families{};
+        unordered_map<uint64_t, MetricCounter*> _eventCounters{};
+        uint64_t _sampleIntervalMs{1'000};
+        bool _countEvents{true};
+        MetricGauge *_queueSize{};
+        MetricGauge *_coroutines{};
+        std::array<MetricGauge*, 7> _serviceStates{};
+#ifdef ICHOR_USE_LIBURING
+        MetricGauge *_sqEntries{};
+        MetricGauge *_sqInUse{};
+        MetricGauge *_cqReady{};
+#endif
+        EventInterceptorRegistration _interceptorRegistration{};
+        Ichor::ScopedServiceProxy<ITimerFactory*> _timerFactory {};
+    };
+
+    /// Renders the metrics of every started MetricsRegistryService in the Prometheus text exposition format (version 0.0.4).
+    /// Series with the same name and labels are summed over all registries, so every DependencyManager thread contributes to the same series.
+    /// Also adds process_resident_memory_bytes. Safe to call from any thread, does not block the threads owning the registries.
+    [[nodiscard]] std::string formatMetricsText();
+}
@@ -2,6 +2,7 @@
 
 #include <ichor/services/network/IConnectionService.h>
 #include <ichor/services/network/IClientFactory.h>
+#include <ichor/services/network/NetworkPropertyKeys.h>
 #include <ichor/services/logging/Logger.h>
 #include <ichor/DependencyManager.h>
 #include <ichor/Filter.h>
@@ -17,8 +18,7 @@ namespace Ichor::v1 {
         ~ClientFactory() final = default;
 
         ConnectionIdType createNewConnection(NeverNull<IService*> requestingSvc, Properties properties) final {
-            properties.erase("Filter");
-            properties.emplace("Filter", Ichor::v1::make_any<Filter>(ServiceIdFilterEntry{requestingSvc->getServiceId()}));
+            properties.set(PropertyKeys::Filter, ServiceIdFilterEntry{requestingSvc->getServiceId()});
             ConnectionIdType count = ++_connectionCounter;
 
             ICHOR_LOG_TRACE(_logger, "Creating new connection {}", count.value);
@@ -78,12 +78,12 @@ namespace Ichor::v1 {
                 co_return {};
             }
 
-            if(!evt.properties.value()->contains("Address")) {
+            if(!evt.properties.value()->contains(PropertyKeys::Address)) {
                 ICHOR_LOG_TRACE(_logger, "Missing address when creating new connection {}", evt.originatingService);
                 co_return {};
             }
 
-            if(!evt.properties.value()->contains("Port")) {
+            if(!evt.properties.value()->contains(PropertyKeys::Port)) {
                 ICHOR_LOG_TRACE(_logger, "Missing port when creating new connection {}", evt.originatingService);
                 co_return {};
             }
@@ -91,8 +91,7 @@ namespace Ichor::v1 {
             if(!_connections.contains(evt.originatingService)) {
                 fmt::println("{} creating {} for {}", typeName<ClientFactory<NetworkType, NetworkInterfaceType>>(), typeName<NetworkInterfaceType>(), evt.originatingService);
                 auto newProps = *evt.properties.value();
-                newProps.erase("Filter");
-                newProps.emplace("Filter", Ichor::v1::make_any<Filter>(ServiceIdFilterEntry{evt.originatingService}));
+                newProps.set(PropertyKeys::Filter, ServiceIdFilterEntry{evt.originatingService});
 
                 unordered_map<ConnectionIdType, ServiceIdType, ConnectionIdHash> newMap;
                 newMap.emplace(_connectionCounter++, GetThreadLocalManager().template createServiceManager<NetworkType, NetworkInterfaceType>(std::move(newProps), evt.priority)->getServiceId());
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <ichor/coroutines/Task.h>
+#include <ichor/stl/ErrnoUtils.h>
+#include <tl/expected.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Ichor::v1 {
+    /**
+     * Immutable message, shared between all connections it is sent to. Released when the last send using it has completed.
+     */
+    using SharedMessage = std::shared_ptr<std::vector<uint8_t> const>;
+
+    class IBroadcastService {
+    public:
+        /**
+         * Awaitable send of the same message to every connection of a host. Implementations avoid copying the message per connection where possible.
+         * @param msg message to send
+         * @return amount of connections the complete message has been sent to, IOError if the service is quitting
+         */
+        virtual Ichor::Task<tl::expected<uint64_t, IOError>> broadcastAsync(SharedMessage msg) = 0;
+
+    protected:
+        ~IBroadcastService() = default;
+    };
+}
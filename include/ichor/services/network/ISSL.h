@@ -1,9 +1,13 @@
 #pragma once
 
+#include <array>
 #include <chrono>
 #include <memory>
 #include <string_view>
 #include <functional>
+#include <span>
+#include <string>
+#include <vector>
 #include <tl/expected.h>
 #include <tl/optional.h>
 #include <ichor/stl/StrongTypedef.h>
@@ -80,6 +84,11 @@ namespace Ichor::v1 {
             return _id;
         }
 
+        /// \return true if the context was created with allowKernelOffload
+        [[nodiscard]] bool allowsKernelOffload() const {
+            return _allowKernelOffload;
+        }
+
 #if defined(ICHOR_USE_HARDENING) || defined(ICHOR_ENABLE_INTERNAL_DEBUGGING)
         [[nodiscard]] virtual TLSContextTypeType getType() const noexcept = 0;
 #endif
@@ -89,6 +98,7 @@ namespace Ichor::v1 {
 
         void *_ctx{};
         TLSContextIdType _id{};
+        bool _allowKernelOffload{};
     };
 
     struct TLSConnection {
@@ -116,7 +126,10 @@ namespace Ichor::v1 {
     };
 
     enum class TLSConnectionError {
-        UNKNOWN
+        UNKNOWN,
+        CLOSED,
+        PROTOCOL_ERROR,
+        UNSUPPORTED
     };
 
     enum class TLSHandshakeStatus {
@@ -137,9 +150,38 @@ namespace Ichor::v1 {
         std::function<bool(const TLSCertificateStore &)> certificateVerifyCallback{};
         TLSContextSecurityLevel securityLevel{};
         bool allowUnknownCertificates{};
+        // Server: keep a session cache and hand out tickets. Client: remember tickets per server name and offer them on the next connection.
+        bool sessionResumption{true};
+        // Server only: number of TLS 1.3 session tickets to send after a full handshake. 0 disables tickets.
+        uint32_t sessionTicketCount{1};
+        // Keep the traffic secrets of connections around, so the record layer can be handed to the kernel with TLSExportTrafficKeys.
+        bool allowKernelOffload{};
+    };
+
+    enum class TLSTrafficDirection {
+        SEND,
+        RECEIVE
+    };
+
+    enum class TLSCipher {
+        AES_128_GCM,
+        AES_256_GCM,
+        CHACHA20_POLY1305
+    };
+
+    // Everything needed to continue a TLS 1.3 record stream outside of the ISSL implementation, e.g. with kernel TLS
+    struct TLSTrafficKeys {
+        TLSCipher cipher{};
+        std::array<uint8_t, 32> key{};
+        uint32_t keyLength{};
+        std::array<uint8_t, 12> iv{};
+        // sequence number of the next record
+        uint64_t sequenceNumber{};
     };
 
     struct TLSCreateConnectionOptions {
+        // Client only: sent as SNI and used as key to look up a previous session for resumption.
+        std::string serverName{};
     };
 
     class ISSL {
@@ -152,6 +194,31 @@ namespace Ichor::v1 {
         [[nodiscard]] virtual tl::expected<std::vector<uint8_t>, bool> TLSRead(TLSConnection&) = 0;
         [[nodiscard]] virtual TLSHandshakeStatus TLSDoHandshake(TLSConnection&) = 0;
 
+        /// Feed ciphertext received from the network and append all plaintext that can be decrypted to plaintextOut.
+        /// Drives the handshake if it has not finished yet. Records produced in response (handshake messages, tickets, alerts) are appended to ciphertextOut and have to be sent.
+        /// Both output buffers are only appended to, so callers can reuse them across calls to prevent allocations.
+        /// \param ciphertext data as received from the network, may contain partial records
+        /// \param plaintextOut decrypted application data
+        /// \param ciphertextOut data to send to the peer
+        /// \return CLOSED if the peer sent a close_notify, PROTOCOL_ERROR/UNKNOWN on fatal errors
+        [[nodiscard]] virtual tl::expected<void, TLSConnectionError> TLSDecrypt(TLSConnection&, std::span<uint8_t const> ciphertext, std::vector<uint8_t> &plaintextOut, std::vector<uint8_t> &ciphertextOut) = 0;
+        /// Encrypt application data and append the resulting records to ciphertextOut.
+        /// \param plaintext application data
+        /// \param ciphertextOut data to send to the peer, only appended to
+        [[nodiscard]] virtual tl::expected<void, TLSConnectionError> TLSEncrypt(TLSConnection&, std::span<uint8_t const> plaintext, std::vector<uint8_t> &ciphertextOut) = 0;
+        /// Append any pending records (e.g. the ClientHello after the first TLSDoHandshake call) to ciphertextOut.
+        virtual void TLSDrainPending(TLSConnection&, std::vector<uint8_t> &ciphertextOut) = 0;
+        [[nodiscard]] virtual bool TLSIsHandshakeDone(TLSConnection&) = 0;
+        /// \return true if the handshake resumed an earlier session instead of doing a full handshake
+        [[nodiscard]] virtual bool TLSIsSessionReused(TLSConnection&) = 0;
+        /// Export the traffic keys for one direction, so that the record layer can be continued elsewhere.
+        /// Once the keys are in use elsewhere, TLSEncrypt (SEND) or TLSDecrypt (RECEIVE) must not be used anymore on this connection, as their sequence numbers would be out of date.
+        /// Keys can only be exported once per direction.
+        /// Requires a context created with allowKernelOffload, a finished handshake and, for SEND, no pending records.
+        /// RECEIVE also requires that all received ciphertext has been consumed, i.e. no partial record is buffered.
+        /// \return UNSUPPORTED if any of these conditions are not met
+        [[nodiscard]] virtual tl::expected<TLSTrafficKeys, TLSConnectionError> TLSExportTrafficKeys(TLSConnection&, TLSTrafficDirection) = 0;
+
     protected:
         ~ISSL() = default;
     };
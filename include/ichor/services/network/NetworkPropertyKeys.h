@@ -0,0 +1,29 @@
+#pragma once
+
+#include <ichor/CoreTypes.h>
+#include <ichor/Properties.h>
+#include <memory>
+#include <string>
+
+namespace Ichor::v1 {
+    struct SocketSendGuard;
+}
+
+// Typed keys of the properties shared by the network services, see the documentation of each service for which ones it uses.
+namespace Ichor::PropertyKeys {
+    inline constexpr PropertyKey<std::string> Address{"Address"};
+    inline constexpr PropertyKey<uint16_t> Port{"Port"};
+    /// Priority of the events inserted by the service
+    inline constexpr PropertyKey<uint64_t> Priority{"Priority"};
+    /// Already connected socket for a connection service, set by host services
+    inline constexpr PropertyKey<int> Socket{"Socket"};
+    /// Id of the host service that accepted a connection, set by host services
+    inline constexpr PropertyKey<ServiceIdType> TcpHostService{"TcpHostService"};
+    /// Send side of a plaintext io_uring connection, set by io_uring host services and shared with whoever broadcasts on the socket
+    inline constexpr PropertyKey<std::shared_ptr<v1::SocketSendGuard>> SendGuard{"SendGuard"};
+    inline constexpr PropertyKey<int64_t> TimeoutSendUs{"TimeoutSendUs"};
+    inline constexpr PropertyKey<int64_t> TimeoutRecvUs{"TimeoutRecvUs"};
+    inline constexpr PropertyKey<uint16_t> ListenBacklogSize{"ListenBacklogSize"};
+    inline constexpr PropertyKey<uint32_t> BufferEntries{"BufferEntries"};
+    inline constexpr PropertyKey<uint32_t> BufferEntrySize{"BufferEntrySize"};
+}
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <tl/optional.h>
+#include <functional>
 #include <vector>
 #include <ichor/Common.h>
+#include <ichor/CoreTypes.h>
 
 namespace Ichor::v1 {
     // Copied/modified from Boost.BEAST
@@ -188,6 +190,9 @@ namespace Ichor::v1 {
         std::vector<std::string> regex_params;
         std::string_view address;
         Ichor::unordered_map<std::string, std::string> headers;
+        // Set by a route handler responding with 101 Switching Protocols to take over the connection.
+        // Called with the service id of the connection, after the response has been sent and the host stopped reading from it.
+        std::function<void(ServiceIdType)> upgradeHandler;
     };
 
     struct HttpResponse {
@@ -5,6 +5,7 @@
 #include <ichor/services/network/http/IHttpConnectionService.h>
 #include <ichor/services/network/http/HttpInternal.h>
 #include <ichor/services/network/IConnectionService.h>
+#include <ichor/services/network/NetworkPropertyKeys.h>
 #include <ichor/services/logging/Logger.h>
 #include <ichor/event_queues/IEventQueue.h>
 #include <tl/expected.h>
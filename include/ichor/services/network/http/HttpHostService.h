@@ -4,6 +4,7 @@
 #include <ichor/services/network/http/HttpInternal.h>
 #include <ichor/services/network/IHostService.h>
 #include <ichor/services/network/IConnectionService.h>
+#include <ichor/services/network/NetworkPropertyKeys.h>
 #include <ichor/services/logging/Logger.h>
 #include <ichor/event_queues/IEventQueue.h>
 #include <tl/expected.h>
@@ -23,6 +24,8 @@ namespace Ichor::v1 {
      * - "TryConnectIntervalMs" uint64_t - with which interval in milliseconds to try (re)connecting (default: 100 ms)
      * - "TimeoutMs" uint64_t - with which interval in milliseconds to timeout for (re)connecting, after which the service stops itself (default: 10'000 ms)
      * - "Debug" bool - Enable verbose logging of requests and responses (default: false)
+     *
+     * Route handlers can take over a connection, e.g. for WebSockets, by responding with 101 Switching Protocols and setting HttpRequest::upgradeHandler.
      */
     class HttpHostService final : public IHttpHostService, public AdvancedService<HttpHostService> {
     public:
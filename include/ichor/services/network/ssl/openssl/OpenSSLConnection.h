@@ -3,6 +3,8 @@
 #include <ichor/services/network/ISSL.h>
 #include <openssl/ssl.h>
 #include <openssl/bio.h>
+#include <array>
+#include <string>
 
 namespace Ichor::v1 {
     class OpenSSLConnection final : public TLSConnection {
@@ -18,5 +20,20 @@ namespace Ichor::v1 {
 
         ::BIO *internalBio{};
         ::BIO *externalBio{};
+        // Client connections only, key into the session cache of the context
+        std::string serverName{};
+
+        // Only filled in if the context allows kernel offload, indexed by TLSTrafficDirection
+        struct TrafficState {
+            std::array<uint8_t, EVP_MAX_MD_SIZE> secret{};
+            size_t secretLength{};
+            // set once the Finished message went through in this direction, from then on records use the application traffic secret
+            bool applicationKeysActive{};
+            // a KeyUpdate replaced the secret, which OpenSSL doesn't expose
+            bool keysUpdated{};
+            uint64_t records{};
+            bool exported{};
+        };
+        std::array<TrafficState, 2> traffic{};
     };
 }
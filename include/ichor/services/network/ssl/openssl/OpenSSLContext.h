@@ -2,8 +2,10 @@
 
 #include <ichor/services/network/ISSL.h>
 #include <ichor/services/network/ssl/openssl/OpenSSLService.h>
+#include <ichor/Common.h>
 #include <openssl/ssl.h>
 #include <functional>
+#include <string>
 
 #if defined(ICHOR_ENABLE_INTERNAL_DEBUGGING)
 #define REFCOUNT_PARAM uint64_t &serviceContextRefCount
@@ -32,9 +34,19 @@ namespace Ichor::v1 {
         [[nodiscard]] TLSContextTypeType getType() const noexcept final;
 #endif
 
+        /// Client only: take the cached session for serverName, if any. TLS 1.3 tickets are meant to be used once, so the entry is removed.
+        /// \return session with ownership transferred to the caller, or nullptr
+        SSL_SESSION* takeSession(std::string_view serverName);
+        /// Client only: store a new session ticket for serverName, takes ownership of session
+        void storeSession(std::string_view serverName, SSL_SESSION *session);
+
+        /// Connections created afterwards track traffic secrets and record sequence numbers for TLSExportTrafficKeys
+        void setAllowKernelOffload(bool allow) noexcept;
+
         std::function<bool(const TLSCertificateStore &)> certificateVerifyCallback{};
 
     private:
+        unordered_map<std::string, SSL_SESSION*, string_hash, std::equal_to<>> _sessions{};
         REFCOUNT_MEMBER
         OpenSSLService &_svc;
     };
@@ -23,6 +23,13 @@ namespace Ichor::v1 {
 
         TLSHandshakeStatus TLSDoHandshake(TLSConnection &conn) final;
 
+        tl::expected<void, TLSConnectionError> TLSDecrypt(TLSConnection &conn, std::span<uint8_t const> ciphertext, std::vector<uint8_t> &plaintextOut, std::vector<uint8_t> &ciphertextOut) final;
+        tl::expected<void, TLSConnectionError> TLSEncrypt(TLSConnection &conn, std::span<uint8_t const> plaintext, std::vector<uint8_t> &ciphertextOut) final;
+        void TLSDrainPending(TLSConnection &conn, std::vector<uint8_t> &ciphertextOut) final;
+        bool TLSIsHandshakeDone(TLSConnection &conn) final;
+        bool TLSIsSessionReused(TLSConnection &conn) final;
+        tl::expected<TLSTrafficKeys, TLSConnectionError> TLSExportTrafficKeys(TLSConnection &conn, TLSTrafficDirection direction) final;
+
     private:
         friend DependencyRegister;
         friend DependencyManager;
@@ -43,5 +50,6 @@ namespace Ichor::v1 {
         TLSContextIdType _contextIdCounter{};
         TLSConnectionIdType _connectionIdCounter{};
         uint64_t _currentlyActiveContexts{};
+        std::unique_ptr<uint8_t[]> _readScratch{}; // room for one record of plaintext, reused by every TLSDecrypt
     };
 }
@@ -0,0 +1,40 @@
+#pragma once
+
+#ifndef ICHOR_USE_LIBURING
+#error "Ichor has not been compiled with io_uring support"
+#endif
+
+#include <ichor/event_queues/IIOUringQueue.h>
+#include <ichor/coroutines/Task.h>
+#include <ichor/stl/AsyncSingleThreadedMutex.h>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace Ichor::v1 {
+    /**
+     * Send side of a plaintext io_uring socket, shared between its IOUringTcpConnectionService and whoever else sends on the socket directly, e.g. a broadcast.
+     * Every send holds the mutex until all of its data has been sent, so sends never interleave on the stream.
+     * The connection sets closed before closing the socket. From then on the socket number may be reused and nothing may be submitted on it anymore.
+     */
+    struct SocketSendGuard final {
+        explicit SocketSendGuard(int _socket) noexcept : socket(_socket) {}
+
+        int socket;
+        bool closed{};
+        AsyncSingleThreadedMutex mutex{};
+    };
+
+    /**
+     * Sends data to every socket without copying it. All completion handlers share one state, so besides the io_uring events themselves nothing is allocated per socket.
+     * The sends are not linked, a failing socket does not affect the others. They are submitted together with everything else queued on the ring, or earlier once the ring is full.
+     * Each send holds the socket's guard, sockets that are busy sending something else are waited on before their send is submitted.
+     * Partial sends are continued until all data has been sent, an error occurred or the socket has been closed.
+     * @param q queue of the current thread
+     * @param origin service to attribute the io_uring events to
+     * @param sockets guards of plaintext sockets, may include kernel TLS sockets
+     * @param data has to outlive the returned task
+     * @return amount of sockets all data has been sent to
+     */
+    [[nodiscard]] Task<uint64_t> broadcastToSockets(IIOUringQueue &q, ServiceIdType origin, std::span<std::shared_ptr<SocketSendGuard> const> sockets, std::span<uint8_t const> data);
+}
@@ -5,8 +5,13 @@
 #endif
 
 #include <ichor/services/network/IConnectionService.h>
+#include <ichor/services/network/ISSL.h>
+#include <ichor/services/network/NetworkPropertyKeys.h>
 #include <ichor/services/logging/Logger.h>
 #include <ichor/event_queues/IIOUringQueue.h>
+#include <ichor/services/network/tcp/TcpConnectionMetrics.h>
+#include <ichor/services/network/tcp/IOUringBroadcast.h>
+#include <memory>
 #include <vector>
 #include <ichor/ScopedServiceProxy.h>
 
@@ -25,6 +30,15 @@ namespace Ichor::v1 {
      * - "TimeoutRecvUs" int64_t - Timeout in microseconds for recv calls (default 250'000)
      * - "BufferEntries" uint32_t - If kernel supports multishot, how many buffers to create for recv (default 8)
      * - "BufferEntrySize" uint32_t - If kernel supports multishot, how big one entry is for the allocated buffers (default 16'384)
+     * - "TLSContext" std::shared_ptr<TLSContext> - Encrypt the connection using this context, requires an ISSL service. Server or client role follows the context. (default: plaintext)
+     * - "TLSServerName" std::string - Client TLS connections only, server name to send as SNI and to resume earlier sessions with (default: none)
+     * - "SendGuard" std::shared_ptr<SocketSendGuard> - Guard of the existing socket, shared with the host service that broadcasts on it (default: a guard of our own)
+     *
+     * If the TLSContext was created with allowKernelOffload, the record layer is handed to the kernel (kTLS) after the handshake: sends always, receives on the server side only.
+     * Clients keep decrypting in user space, as servers send session tickets at any moment after the handshake, which a plain recv on a kTLS socket can't handle.
+     * If the kernel doesn't support it (e.g. the tls module isn't loaded), the connection continues with user space TLS.
+     *
+     * If an IMetricsRegistry is available, bytes sent and received on the socket and the amount of open connections are reported into it.
      */
     template <typename InterfaceT> requires DerivedAny<InterfaceT, IConnectionService, IHostConnectionService, IClientConnectionService>
     class IOUringTcpConnectionService final : public InterfaceT, public AdvancedService<IOUringTcpConnectionService<InterfaceT>> {
@@ -51,7 +65,21 @@ namespace Ichor::v1 {
         void addDependencyInstance(Ichor::ScopedServiceProxy<IIOUringQueue*>, IService&) noexcept;
         void removeDependencyInstance(Ichor::ScopedServiceProxy<IIOUringQueue*>, IService&) noexcept;
 
+        void addDependencyInstance(Ichor::ScopedServiceProxy<ISSL*>, IService&) noexcept;
+        void removeDependencyInstance(Ichor::ScopedServiceProxy<ISSL*>, IService&) noexcept;
+
+        void addDependencyInstance(Ichor::ScopedServiceProxy<IMetricsRegistry*>, IService&);
+        void removeDependencyInstance(Ichor::ScopedServiceProxy<IMetricsRegistry*>, IService&) noexcept;
+
         std::function<void(io_uring_cqe*)> createRecvHandler() noexcept;
+        void onReceived(std::span<uint8_t const> data);
+        void deliver(std::span<uint8_t const> data);
+        Task<tl::expected<void, IOError>> sendRaw(std::span<uint8_t const> data);
+        Task<void> flushTLSPending();
+        Task<tl::expected<void, IOError>> offloadTLSSend();
+        void finishKernelTLSReceiveSwitch();
+        bool installKernelTLS(TLSTrafficDirection direction);
+        void armRecv();
 
         friend DependencyRegister;
 
@@ -68,5 +96,26 @@ namespace Ichor::v1 {
         std::vector<decltype(_recvBuf)> _queuedMessages{};
         std::function<void(std::span<uint8_t const>)> _recvHandler;
         AsyncManualResetEvent _quitEvt;
+        // Held by every send until all of its data is out, so partial sends and TLS records with their implicit sequence numbers can't interleave
+        std::shared_ptr<SocketSendGuard> _sendGuard{};
+
+        Ichor::ScopedServiceProxy<ISSL*> _ssl {};
+        std::shared_ptr<TLSContext> _tlsContext{};
+        std::unique_ptr<TLSConnection> _tlsConnection{};
+        // Reused for every received/sent chunk, so steady state TLS traffic doesn't allocate
+        std::vector<uint8_t> _tlsPlaintext{};
+        std::vector<uint8_t> _tlsSendBuf{};
+        // Records produced while receiving (handshake, session tickets), have to go out before any newer record
+        std::vector<uint8_t> _tlsPendingOut{};
+        AsyncManualResetEvent _tlsHandshakeDone{};
+        bool _tlsFlushScheduled{};
+        // kernel TLS state, the ULP has to be installed once before either direction can be configured
+        bool _ktlsUlp{};
+        bool _ktlsSendAttempted{};
+        bool _ktlsSend{};
+        bool _ktlsReceiveSwitching{};
+        bool _ktlsReceive{};
+        uint64_t _recvUserData{};
+        Detail::TcpConnectionMetrics _metrics{};
     };
 }
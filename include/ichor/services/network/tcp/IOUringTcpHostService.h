@@ -5,8 +5,13 @@
 #endif
 
 #include <ichor/services/network/IHostService.h>
+#include <ichor/services/network/IBroadcastService.h>
+#include <ichor/services/network/IConnectionService.h>
+#include <ichor/services/network/ISSL.h>
+#include <ichor/services/network/NetworkPropertyKeys.h>
 #include <ichor/services/logging/Logger.h>
 #include <ichor/event_queues/IIOUringQueue.h>
+#include <ichor/services/network/tcp/IOUringBroadcast.h>
 #include <ichor/ScopedServiceProxy.h>
 
 namespace Ichor::v1 {
@@ -22,8 +27,11 @@ namespace Ichor::v1 {
      * - "TimeoutRecvUs" int64_t - Timeout in microseconds for recv calls (default 250'000)
      * - "BufferEntries" uint32_t - BufferEntries config to pass on to newly created connections (default: none)
      * - "BufferEntrySize" uint32_t - BufferEntrySize config to pass on to newly created connections (default: none)
+     * - "TLSContext" std::shared_ptr<TLSContext> - Server TLS context to pass on to newly created connections, making them TLS connections (default: none)
+     *
+     * Register as IBroadcastService as well to send one message to all connections. Plaintext connections send straight from the shared message, in turn with their own sends. TLS connections encrypt a copy each.
      */
-    class IOUringTcpHostService final : public IHostService, public AdvancedService<IOUringTcpHostService> {
+    class IOUringTcpHostService final : public IHostService, public IBroadcastService, public AdvancedService<IOUringTcpHostService> {
     public:
         IOUringTcpHostService(DependencyRegister &reg, Properties props);
         ~IOUringTcpHostService() final = default;
@@ -31,6 +39,8 @@ namespace Ichor::v1 {
         void setPriority(uint64_t priority) final;
         uint64_t getPriority() final;
 
+        Task<tl::expected<uint64_t, IOError>> broadcastAsync(SharedMessage msg) final;
+
     private:
         Task<tl::expected<void, Ichor::StartError>> start() final;
         Task<void> stop() final;
@@ -41,6 +51,9 @@ namespace Ichor::v1 {
         void addDependencyInstance(Ichor::ScopedServiceProxy<IIOUringQueue*>, IService&) noexcept;
         void removeDependencyInstance(Ichor::ScopedServiceProxy<IIOUringQueue*>, IService&) noexcept;
 
+        void addDependencyInstance(Ichor::ScopedServiceProxy<IHostConnectionService*>, IService&) noexcept;
+        void removeDependencyInstance(Ichor::ScopedServiceProxy<IHostConnectionService*>, IService&) noexcept;
+
         std::function<void(io_uring_cqe*)> createAcceptHandler() noexcept;
 
         friend DependencyRegister;
@@ -54,10 +67,17 @@ namespace Ichor::v1 {
         int64_t _recvTimeout{250'000};
 		tl::optional<uint32_t> _bufferEntries{};
 		tl::optional<uint32_t> _bufferEntrySize{};
+        std::shared_ptr<TLSContext> _tlsContext{};
         bool _quit;
         Ichor::ScopedServiceProxy<IIOUringQueue*> _q {};
         Ichor::ScopedServiceProxy<ILogger*> _logger {};
-        std::vector<ServiceIdType> _connections;
+        struct HostConnection final {
+            Ichor::ScopedServiceProxy<IHostConnectionService*> connection;
+            // broadcasts to plaintext connections go straight to the socket, nullptr for TLS connections
+            std::shared_ptr<SocketSendGuard> sendGuard;
+        };
+        // started connections accepted by this host
+        unordered_map<ServiceIdType, HostConnection, ServiceIdHash> _connections;
         AsyncManualResetEvent _quitEvt;
     };
 }
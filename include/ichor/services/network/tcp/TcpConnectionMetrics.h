@@ -0,0 +1,66 @@
+#pragma once
+
+#include <ichor/services/metrics/IMetricsRegistry.h>
+
+namespace Ichor::v1::Detail {
+    /// Shared by the TCP connection services to report into an optional IMetricsRegistry.
+    /// Does nothing until a registry is attached.
+    class TcpConnectionMetrics final {
+    public:
+        void attach(IMetricsRegistry &registry) {
+            _received = &registry.counter("ichor_tcp_bytes_received_total", "Bytes received on TCP connections");
+            _sent = &registry.counter("ichor_tcp_bytes_sent_total", "Bytes sent on TCP connections");
+            _connections = &registry.gauge("ichor_tcp_connections", "Open TCP connections");
+            if(_open) {
+                _connections->inc();
+            }
+        }
+
+        void detach() noexcept {
+            if(_open && _connections != nullptr) {
+                _connections->dec();
+            }
+            _received = nullptr;
+            _sent = nullptr;
+            _connections = nullptr;
+        }
+
+        void opened() noexcept {
+            if(_open) {
+                return;
+            }
+            _open = true;
+            if(_connections != nullptr) {
+                _connections->inc();
+            }
+        }
+
+        void closed() noexcept {
+            if(!_open) {
+                return;
+            }
+            _open = false;
+            if(_connections != nullptr) {
+                _connections->dec();
+            }
+        }
+
+        void received(uint64_t bytes) noexcept {
+            if(_received != nullptr) {
+                _received->inc(bytes);
+            }
+        }
+
+        void sent(uint64_t bytes) noexcept {
+            if(_sent != nullptr) {
+                _sent->inc(bytes);
+            }
+        }
+
+    private:
+        MetricCounter *_received{};
+        MetricCounter *_sent{};
+        MetricGauge *_connections{};
+        bool _open{};
+    };
+}
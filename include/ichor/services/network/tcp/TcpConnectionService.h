@@ -3,15 +3,21 @@
 #if (!defined(WIN32) && !defined(_WIN32) && !defined(__WIN32) && !defined(__APPLE__)) || defined(__CYGWIN__)
 
 #include <ichor/services/network/IConnectionService.h>
+#include <ichor/services/network/NetworkPropertyKeys.h>
 #include <ichor/services/logging/Logger.h>
 #include <ichor/services/timer/ITimerFactory.h>
+#include <ichor/services/network/tcp/TcpConnectionMetrics.h>
 #include <ichor/Concepts.h>
 #include <ichor/ScopedServiceProxy.h>
+#ifdef ICHOR_USE_EPOLL
+#include <ichor/event_queues/IEpollQueue.h>
+#endif
 
 namespace Ichor::v1 {
 
     /**
      * Service for managing a TCP connection
+     * On an EpollQueue, the socket is registered with the queue and read when it becomes readable. Otherwise, the socket is polled every 20 ms.
      *
      * Properties:
      * - "Address" std::string - What address to connect to (required if Socket is not present)
@@ -19,6 +25,8 @@ namespace Ichor::v1 {
      * - "Socket" int - An existing socket to manage (required if Address/Port are not present)
      * - "Priority" uint64_t - Which priority to use for inserted events (default INTERNAL_EVENT_PRIORITY)
      * - "TimeoutSendUs" int64_t - Timeout in microseconds for send calls (default 250'000)
+     *
+     * If an IMetricsRegistry is available, bytes sent and received and the amount of open connections are reported into it.
      */
     template <typename InterfaceT> requires DerivedAny<InterfaceT, IConnectionService, IHostConnectionService, IClientConnectionService>
     class TcpConnectionService final : public InterfaceT, public AdvancedService<TcpConnectionService<InterfaceT>> {
@@ -45,7 +53,16 @@ namespace Ichor::v1 {
         void addDependencyInstance(Ichor::ScopedServiceProxy<ITimerFactory*> logger, IService &isvc);
         void removeDependencyInstance(Ichor::ScopedServiceProxy<ITimerFactory*> logger, IService &isvc);
 
+        void addDependencyInstance(Ichor::ScopedServiceProxy<IMetricsRegistry*> registry, IService &isvc);
+        void removeDependencyInstance(Ichor::ScopedServiceProxy<IMetricsRegistry*> registry, IService &isvc);
+
+#ifdef ICHOR_USE_EPOLL
+        void addDependencyInstance(Ichor::ScopedServiceProxy<IEpollQueue*> q, IService &isvc);
+        void removeDependencyInstance(Ichor::ScopedServiceProxy<IEpollQueue*> q, IService &isvc);
+#endif
+
         void recvHandler();
+        void stopWatchingSocket() noexcept;
 
         friend DependencyRegister;
 
@@ -57,8 +74,13 @@ namespace Ichor::v1 {
         Ichor::ScopedServiceProxy<ILogger*> _logger {};
         Ichor::ScopedServiceProxy<ITimerFactory*> _timerFactory {};
         tl::optional<TimerRef> _timer{};
+#ifdef ICHOR_USE_EPOLL
+        Ichor::ScopedServiceProxy<IEpollQueue*> _epollQueue {};
+        bool _registeredWithEpoll{};
+#endif
         std::vector<std::vector<uint8_t>> _queuedMessages{};
         std::function<void(std::span<uint8_t const>)> _recvHandler;
+        Detail::TcpConnectionMetrics _metrics{};
     };
 }
 
@@ -3,9 +3,13 @@
 #if (!defined(WIN32) && !defined(_WIN32) && !defined(__WIN32) && !defined(__APPLE__)) || defined(__CYGWIN__)
 
 #include <ichor/services/network/IHostService.h>
+#include <ichor/services/network/NetworkPropertyKeys.h>
 #include <ichor/services/logging/Logger.h>
 #include <ichor/services/timer/ITimerFactory.h>
 #include <ichor/ScopedServiceProxy.h>
+#ifdef ICHOR_USE_EPOLL
+#include <ichor/event_queues/IEpollQueue.h>
+#endif
 
 namespace Ichor::v1 {
     struct NewSocketEvent final : public Ichor::Event {
@@ -26,6 +30,7 @@ namespace Ichor::v1 {
 
     /**
      * Service for creating a TCP host
+     * On an EpollQueue, the listening socket is registered with the queue and connections are accepted when it becomes readable. Otherwise, the socket is polled every 20 ms.
      *
      * Properties:
      * - "Address" std::string - What address to bind to (default INADDR_ANY)
@@ -51,8 +56,14 @@ namespace Ichor::v1 {
         void addDependencyInstance(Ichor::ScopedServiceProxy<ITimerFactory*> logger, IService &isvc);
         void removeDependencyInstance(Ichor::ScopedServiceProxy<ITimerFactory*> logger, IService &isvc);
 
+#ifdef ICHOR_USE_EPOLL
+        void addDependencyInstance(Ichor::ScopedServiceProxy<IEpollQueue*> q, IService &isvc);
+        void removeDependencyInstance(Ichor::ScopedServiceProxy<IEpollQueue*> q, IService &isvc);
+#endif
+
         AsyncGenerator<IchorBehaviour> handleEvent(NewSocketEvent const &evt);
         void acceptHandler();
+        void stopWatchingSocket() noexcept;
 
         friend DependencyRegister;
         friend DependencyManager;
@@ -66,6 +77,10 @@ namespace Ichor::v1 {
         Ichor::ScopedServiceProxy<ILogger*> _logger {};
         Ichor::ScopedServiceProxy<ITimerFactory*> _timerFactory {};
         tl::optional<TimerRef> _timer{};
+#ifdef ICHOR_USE_EPOLL
+        Ichor::ScopedServiceProxy<IEpollQueue*> _epollQueue {};
+        bool _registeredWithEpoll{};
+#endif
         std::vector<ServiceIdType> _connections;
         EventHandlerRegistration _newSocketEventHandlerRegistration{};
     };
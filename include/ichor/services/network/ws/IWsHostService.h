@@ -0,0 +1,21 @@
+#pragma once
+
+#include <ichor/services/network/IHostService.h>
+#include <ichor/services/network/IBroadcastService.h>
+#include <ichor/services/network/IConnectionService.h>
+#include <ichor/CoreTypes.h>
+
+namespace Ichor::v1 {
+    class IWsHostService : public IHostService, public IBroadcastService {
+    public:
+        /**
+         * Get the connection that has been upgraded to a websocket.
+         * @param connectionServiceId service id of the underlying IHostConnectionService
+         * @return the connection, or nullptr if it has gone away
+         */
+        [[nodiscard]] virtual IHostConnectionService* getUpgradedConnection(ServiceIdType connectionServiceId) noexcept = 0;
+
+    protected:
+        ~IWsHostService() = default;
+    };
+}
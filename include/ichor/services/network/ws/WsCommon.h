@@ -0,0 +1,93 @@
+#pragma once
+
+#include <tl/expected.h>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Ichor::v1 {
+    enum class WsOpcode : uint8_t {
+        CONTINUATION = 0x0,
+        TEXT = 0x1,
+        BINARY = 0x2,
+        CLOSE = 0x8,
+        PING = 0x9,
+        PONG = 0xA,
+    };
+
+    enum class WsCloseCode : uint16_t {
+        NORMAL = 1000,
+        GOING_AWAY = 1001,
+        PROTOCOL_ERROR = 1002,
+        UNSUPPORTED_DATA = 1003,
+        INVALID_PAYLOAD = 1007,
+        MESSAGE_TOO_BIG = 1009,
+    };
+
+    enum class WsFrameError : uint_fast16_t {
+        INCOMPLETE,
+        PROTOCOL_ERROR,
+        MESSAGE_TOO_BIG,
+    };
+
+    struct WsFrameHeader final {
+        uint64_t payloadLength;
+        uint32_t headerLength;
+        std::array<uint8_t, 4> mask;
+        WsOpcode opcode;
+        bool fin;
+        bool compressed; // RSV1, only valid on the first frame of a permessage-deflate message
+        bool masked;
+    };
+
+    constexpr std::string_view ICHOR_WS_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    constexpr uint32_t ICHOR_WS_MAX_HEADER_SIZE = 14;
+    // messages smaller than this are sent uncompressed, even if permessage-deflate has been negotiated
+    constexpr uint64_t ICHOR_WS_DEFLATE_THRESHOLD = 64;
+
+    /**
+     * Parses the header of the frame at the start of data. Does not check whether the complete payload is present.
+     * @param data received bytes
+     * @param allowCompressed whether permessage-deflate has been negotiated, RSV1 is a protocol error otherwise
+     * @return header or INCOMPLETE if more bytes are needed to parse the header, PROTOCOL_ERROR if the frame violates RFC 6455
+     */
+    [[nodiscard]] tl::expected<WsFrameHeader, WsFrameError> parseWsFrameHeader(std::span<uint8_t const> data, bool allowCompressed) noexcept;
+
+    /**
+     * Writes a frame header into out.
+     * @param mask nullptr for unmasked (server) frames, 4 bytes of masking key for client frames
+     * @return amount of bytes written
+     */
+    uint32_t writeWsFrameHeader(std::array<uint8_t, ICHOR_WS_MAX_HEADER_SIZE> &out, WsOpcode opcode, bool fin, bool compressed, uint64_t payloadLength, uint8_t const *mask) noexcept;
+
+    /**
+     * (Un)masks payload in place. Masking is symmetric, so this is used for both directions. Uses SIMD if available.
+     */
+    void applyWsMask(std::span<uint8_t> payload, std::array<uint8_t, 4> mask) noexcept;
+
+    /**
+     * Calculates the Sec-WebSocket-Accept value belonging to the given Sec-WebSocket-Key.
+     */
+    [[nodiscard]] std::string createWsAcceptKey(std::string_view key);
+
+    /**
+     * Checks if a comma separated header value, such as Connection or Sec-WebSocket-Extensions, contains the token. Case-insensitive, ignores parameters after a ';'.
+     */
+    [[nodiscard]] bool wsHeaderContainsToken(std::string_view value, std::string_view token) noexcept;
+
+#ifdef ICHOR_USE_ZLIB
+    /**
+     * Compresses a message for permessage-deflate, without context takeover. Appends to out.
+     */
+    [[nodiscard]] bool wsDeflate(std::span<uint8_t const> in, std::vector<uint8_t> &out);
+
+    /**
+     * Decompresses a permessage-deflate message, without context takeover. Appends to out.
+     * @return MESSAGE_TOO_BIG if the decompressed message would exceed maxSize, PROTOCOL_ERROR on invalid data
+     */
+    [[nodiscard]] tl::expected<void, WsFrameError> wsInflate(std::span<uint8_t const> in, std::vector<uint8_t> &out, uint64_t maxSize);
+#endif
+}
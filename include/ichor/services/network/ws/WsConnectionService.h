@@ -0,0 +1,105 @@
+#pragma once
+
+#include <ichor/services/network/ws/IWsHostService.h>
+#include <ichor/services/network/ws/WsCommon.h>
+#include <ichor/services/network/IConnectionService.h>
+#include <ichor/services/network/NetworkPropertyKeys.h>
+#include <ichor/services/logging/Logger.h>
+#include <ichor/event_queues/IEventQueue.h>
+#include <ichor/coroutines/AsyncManualResetEvent.h>
+#include <ichor/dependency_management/AdvancedService.h>
+#include <ichor/ScopedServiceProxy.h>
+#include <string>
+#include <vector>
+
+namespace Ichor::v1 {
+    /**
+     * Service for a WebSocket (RFC 6455) connection, speaking the protocol over another connection service, e.g. IOUringTcpConnectionService.
+     * Host side connections are created by WsHostService after an upgrade, client side connections do the opening handshake over an IClientConnectionService
+     * requested with the same properties, so a ClientFactory for the underlying connection type has to be present. The service starts once the handshake completed.
+     *
+     * Every complete message is passed to the receive handler as one span, which is only valid for the duration of the call.
+     * Unfragmented unmasked messages (i.e. client side) that arrived in one read point straight into the receive buffer. Masked payloads are unmasked into a per-thread scratch buffer, as receive buffers are read-only.
+     * Sent messages are framed without copying the payload, the header goes out as a separate iovec.
+     *
+     * Properties:
+     * - "Address" std::string - Client only, what address to connect to (required for clients)
+     * - "Port" uint16_t - Client only, what port to connect to (required for clients)
+     * - "Path" std::string - Client only, request target of the opening handshake (default: "/")
+     * - "WsHostServiceId" ServiceIdType - Host only, set by WsHostService
+     * - "ConnectionServiceId" ServiceIdType - Host only, id of the upgraded connection service, set by WsHostService
+     * - "Priority" uint64_t - What priority to insert events with (default: INTERNAL_EVENT_PRIORITY)
+     * - "PerMessageDeflate" bool - Use permessage-deflate (RFC 7692) without context takeover. Clients offer it, hosts get it set if it has been negotiated. Requires zlib. (default: false)
+     * - "MaxMessageSize" uint64_t - Close the connection when receiving bigger messages (default: 16 MiB)
+     * - "SendText" bool - Send messages as text frames instead of binary frames (default: false)
+     */
+    template <typename InterfaceT> requires DerivedAny<InterfaceT, IConnectionService, IHostConnectionService, IClientConnectionService>
+    class WsConnectionService final : public InterfaceT, public AdvancedService<WsConnectionService<InterfaceT>> {
+    public:
+        WsConnectionService(DependencyRegister &reg, Properties props);
+        ~WsConnectionService() final = default;
+
+        Task<tl::expected<void, IOError>> sendAsync(std::vector<uint8_t>&& msg) final;
+        Task<tl::expected<void, IOError>> sendAsync(std::vector<std::vector<uint8_t>>&& msgs) final;
+        void setPriority(uint64_t priority) final;
+        uint64_t getPriority() final;
+
+        [[nodiscard]] bool isClient() const noexcept final;
+
+        void setReceiveHandler(std::function<void(std::span<uint8_t const>)>) final;
+
+    private:
+        Task<tl::expected<void, Ichor::StartError>> start() final;
+        Task<void> stop() final;
+
+        void addDependencyInstance(Ichor::ScopedServiceProxy<ILogger*> logger, IService &isvc);
+        void removeDependencyInstance(Ichor::ScopedServiceProxy<ILogger*> logger, IService &isvc);
+
+        void addDependencyInstance(Ichor::ScopedServiceProxy<IEventQueue*> q, IService &isvc);
+        void removeDependencyInstance(Ichor::ScopedServiceProxy<IEventQueue*> q, IService &isvc);
+
+        void addDependencyInstance(Ichor::ScopedServiceProxy<IWsHostService*> h, IService &isvc);
+        void removeDependencyInstance(Ichor::ScopedServiceProxy<IWsHostService*> h, IService &isvc);
+
+        void addDependencyInstance(Ichor::ScopedServiceProxy<IClientConnectionService*> c, IService &isvc);
+        void removeDependencyInstance(Ichor::ScopedServiceProxy<IClientConnectionService*> c, IService &isvc);
+
+        [[nodiscard]] IConnectionService* connection() const noexcept;
+        void onReceive(std::span<uint8_t const> data);
+        void onHandshakeResponse(std::span<uint8_t const> data);
+        [[nodiscard]] bool handleFrame(WsFrameHeader const &header, std::span<uint8_t const> payload);
+        [[nodiscard]] bool deliver(std::span<uint8_t const> message, bool compressed);
+        std::vector<uint8_t> createFrameHeader(WsOpcode opcode, bool compressed, std::span<uint8_t> payload) noexcept;
+        Task<tl::expected<void, IOError>> sendControlFrame(WsOpcode opcode, std::vector<uint8_t> payload);
+        void close(WsCloseCode code);
+
+        friend DependencyRegister;
+
+        uint64_t _priority{INTERNAL_EVENT_PRIORITY};
+        uint64_t _maxMessageSize{16 * 1024 * 1024};
+        ServiceIdType _wsHostServiceId{};
+        ServiceIdType _connectionServiceId{};
+        bool _isClient{};
+        bool _perMessageDeflate{};
+        bool _sendText{};
+        bool _connected{};
+        bool _closing{};
+        bool _quit{};
+        bool _messageInProgress{};
+        bool _messageCompressed{};
+        Ichor::ScopedServiceProxy<ILogger*> _logger {};
+        Ichor::ScopedServiceProxy<IEventQueue*> _queue {};
+        Ichor::ScopedServiceProxy<IWsHostService*> _wsHost {};
+        Ichor::ScopedServiceProxy<IClientConnectionService*> _clientConnection {};
+        AsyncManualResetEvent _handshakeDone{};
+        std::string _handshakeKey{};
+        std::string _handshakeBuffer{};
+        // unconsumed bytes, either an incomplete frame or (host side) frames that have to be unmasked
+        std::vector<uint8_t> _recvBuffer{};
+        // payload of a fragmented message
+        std::vector<uint8_t> _messageBuffer{};
+        std::vector<uint8_t> _inflateBuffer{};
+        std::vector<std::vector<uint8_t>> _queuedMessages{};
+        std::function<void(std::span<uint8_t const>)> _recvHandler;
+    };
+}
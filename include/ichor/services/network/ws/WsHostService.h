@@ -0,0 +1,98 @@
+#pragma once
+
+#include <ichor/services/network/ws/IWsHostService.h>
+#include <ichor/services/network/http/IHttpHostService.h>
+#include <ichor/services/network/IConnectionService.h>
+#include <ichor/services/network/NetworkPropertyKeys.h>
+#include <ichor/services/logging/Logger.h>
+#include <ichor/event_queues/IEventQueue.h>
+#include <ichor/dependency_management/AdvancedService.h>
+#include <ichor/ScopedServiceProxy.h>
+#ifdef ICHOR_USE_LIBURING
+#include <ichor/event_queues/IIOUringQueue.h>
+#include <ichor/services/network/tcp/IOUringBroadcast.h>
+#endif
+
+namespace Ichor::v1 {
+    /**
+     * Service for creating a WebSocket (RFC 6455) server. Accepts upgrades through an IHttpHostService, e.g. the native HttpHostService on top of IOUringTcpHostService.
+     * Every upgraded connection becomes a WsConnectionService<IHostConnectionService>, registered as IConnectionService and IHostConnectionService with the "WsHostServiceId" property set.
+     * Register this service as IWsHostService, which connections use to find their upgraded connection.
+     *
+     * broadcastAsync encodes the frame once (and compresses it once, for connections that negotiated permessage-deflate) and shares it between all connections.
+     * On an io_uring queue, plaintext connections are sent to directly through their socket, in turn with their own sends.
+     *
+     * Properties:
+     * - "Path" std::string - Route to accept upgrade requests on (default: "/")
+     * - "Priority" uint64_t - What priority to insert events with (e.g. when getting a message from the client)
+     * - "PerMessageDeflate" bool - Accept permessage-deflate (RFC 7692) offers, without context takeover. Requires Ichor to be compiled with zlib. (default: false)
+     * - "MaxMessageSize" uint64_t - Close connections that send bigger messages (default: 16 MiB)
+     * - "SendText" bool - Send messages as text frames instead of binary frames (default: false)
+     */
+    class WsHostService final : public IWsHostService, public AdvancedService<WsHostService> {
+    public:
+        WsHostService(DependencyRegister &reg, Properties props);
+        ~WsHostService() final = default;
+
+        [[nodiscard]] IHostConnectionService* getUpgradedConnection(ServiceIdType connectionServiceId) noexcept final;
+        Task<tl::expected<uint64_t, IOError>> broadcastAsync(SharedMessage msg) final;
+
+        void setPriority(uint64_t priority) final;
+        uint64_t getPriority() final;
+
+    private:
+        Task<tl::expected<void, Ichor::StartError>> start() final;
+        Task<void> stop() final;
+
+        void addDependencyInstance(Ichor::ScopedServiceProxy<ILogger*> logger, IService &isvc);
+        void removeDependencyInstance(Ichor::ScopedServiceProxy<ILogger*> logger, IService &isvc);
+
+        void addDependencyInstance(Ichor::ScopedServiceProxy<IEventQueue*> q, IService &isvc);
+        void removeDependencyInstance(Ichor::ScopedServiceProxy<IEventQueue*> q, IService &isvc);
+
+        void addDependencyInstance(Ichor::ScopedServiceProxy<IHttpHostService*> h, IService &isvc);
+        void removeDependencyInstance(Ichor::ScopedServiceProxy<IHttpHostService*> h, IService &isvc);
+
+        void addDependencyInstance(Ichor::ScopedServiceProxy<IHostConnectionService*> c, IService &isvc);
+        void removeDependencyInstance(Ichor::ScopedServiceProxy<IHostConnectionService*> c, IService &isvc);
+
+#ifdef ICHOR_USE_LIBURING
+        void addDependencyInstance(Ichor::ScopedServiceProxy<IIOUringQueue*> q, IService &isvc);
+        void removeDependencyInstance(Ichor::ScopedServiceProxy<IIOUringQueue*> q, IService &isvc);
+#endif
+
+        HttpResponse handleUpgradeRequest(HttpRequest &req);
+        void createConnection(ServiceIdType connectionServiceId, bool perMessageDeflate);
+
+        friend DependencyRegister;
+
+        uint64_t _priority{INTERNAL_EVENT_PRIORITY};
+        uint64_t _maxMessageSize{16 * 1024 * 1024};
+        bool _perMessageDeflate{};
+        bool _sendText{};
+        bool _quit{};
+        std::string _path{"/"};
+        Ichor::ScopedServiceProxy<ILogger*> _logger {};
+        Ichor::ScopedServiceProxy<IEventQueue*> _queue {};
+        Ichor::ScopedServiceProxy<IHttpHostService*> _httpHost {};
+#ifdef ICHOR_USE_LIBURING
+        Ichor::ScopedServiceProxy<IIOUringQueue*> _uringQueue {};
+#endif
+        HttpRouteRegistration _routeRegistration{};
+        struct HostConnection final {
+            Ichor::ScopedServiceProxy<IHostConnectionService*> connection;
+#ifdef ICHOR_USE_LIBURING
+            // nullptr if the connection does TLS or doesn't run on io_uring
+            std::shared_ptr<SocketSendGuard> sendGuard;
+#endif
+        };
+        struct WsConnection final {
+            ServiceIdType wsServiceId;
+            bool perMessageDeflate;
+        };
+        // connections of TCP hosts, which may be upgraded later on
+        unordered_map<ServiceIdType, HostConnection, ServiceIdHash> _hostConnections;
+        // upgraded connection service id -> websocket connection
+        unordered_map<ServiceIdType, WsConnection, ServiceIdHash> _wsConnections;
+    };
+}
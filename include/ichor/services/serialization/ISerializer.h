@@ -2,6 +2,8 @@
 
 #include <vector>
 #include <span>
+#include <utility>
+#include <tl/optional.h>
 
 namespace Ichor::v1 {
 
@@ -11,6 +13,42 @@ namespace Ichor::v1 {
         virtual std::vector<uint8_t> serialize(T const &obj) = 0;
         virtual tl::optional<T> deserialize(std::span<uint8_t const> stream) = 0;
 
+        /*
+         * Appends the serialized form of obj to buffer. Reusing the same buffer for multiple messages means it only allocates when it has to grow.
+         * Returns false if obj could not be serialized, in which case buffer is left as it was.
+         * The default implementation appends the result of serialize(), override it to serialize in place.
+         */
+        virtual bool serializeInto(T const &obj, std::vector<uint8_t> &buffer) {
+            auto data = serialize(obj);
+            if(data.empty()) {
+                return false;
+            }
+            buffer.insert(buffer.end(), data.begin(), data.end());
+            return true;
+        }
+
+        /*
+         * Returns the exact amount of bytes serializeInto appends for obj, so callers can reserve space once.
+         * Returns nullopt for formats that can only know this by serializing, which is what the default implementation does.
+         */
+        virtual tl::optional<uint64_t> serializedSize(T const &) {
+            return tl::nullopt;
+        }
+
+        /*
+         * Deserializes stream into an existing object, so memory it already owns, like the capacity of strings and vectors, gets reused.
+         * Returns false if stream could not be deserialized, obj is valid but its contents are unspecified in that case.
+         * The default implementation moves the result of deserialize() into obj.
+         */
+        virtual bool deserializeInto(std::span<uint8_t const> stream, T &obj) {
+            auto msg = deserialize(stream);
+            if(!msg) {
+                return false;
+            }
+            obj = std::move(*msg);
+            return true;
+        }
+
     protected:
         ~ISerializer() = default;
     };
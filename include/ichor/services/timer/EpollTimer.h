@@ -0,0 +1,80 @@
+#pragma once
+
+#ifndef ICHOR_USE_EPOLL
+#error "Ichor has not been compiled with epoll support"
+#endif
+
+#include <ichor/services/timer/ITimer.h>
+#include <ichor/event_queues/IEpollQueue.h>
+#include <ichor/ScopedServiceProxy.h>
+#include <memory>
+#include <vector>
+
+namespace Ichor::v1 {
+    template <typename TIMER, typename QUEUE>
+    class TimerFactory;
+
+    /// Timer backed by a timerfd registered with an IEpollQueue. Callbacks run on the queue thread without an extra thread per timer.
+    class EpollTimer final : public ITimer {
+    public:
+        ///
+        /// \param timerId unique identifier for timer
+        /// \param svcId unique identifier for svc using this timer
+        EpollTimer(Ichor::ScopedServiceProxy<IEpollQueue*> queue, uint64_t timerId, ServiceIdType svcId) noexcept;
+        EpollTimer(EpollTimer const &) = delete;
+        EpollTimer(EpollTimer &&) noexcept = default;
+
+        ~EpollTimer() noexcept;
+
+        EpollTimer& operator=(EpollTimer const &) = delete;
+        EpollTimer& operator=(EpollTimer &&o) noexcept;
+
+        bool startTimer() final;
+        bool startTimer(bool fireImmediately) final;
+        bool stopTimer(std::function<void(void)> cb) final;
+
+        [[nodiscard]] TimerState getState() const noexcept final;
+
+        /// Sets coroutine based callback, adds some overhead compared to sync version. Executed when timer expires. Terminates program if timer is running.
+        /// \param fn callback
+        void setCallbackAsync(std::function<AsyncGenerator<IchorBehaviour>()> fn) final;
+
+        /// Set sync callback to execute when timer expires. Terminates program if timer is running.
+        /// \param fn callback
+        void setCallback(std::function<void()> fn) final;
+        void setInterval(uint64_t nanoseconds) noexcept final;
+
+        void setPriority(uint64_t priority) noexcept final;
+        [[nodiscard]] uint64_t getPriority() const noexcept final;
+        void setFireOnce(bool fireOnce) noexcept final;
+        [[nodiscard]] bool getFireOnce() const noexcept final;
+        [[nodiscard]] uint64_t getTimerId() const noexcept final;
+
+        [[nodiscard]] ServiceIdType getRequestingServiceId() const noexcept final;
+
+    private:
+        // TimerFactory keeps timers in a vector, the fd handler needs an address that survives moves
+        struct State final {
+            Ichor::ScopedServiceProxy<IEpollQueue*> q;
+            uint64_t timerId{};
+            ServiceIdType requestingServiceId{};
+            int fd{-1};
+            TimerState state{};
+            bool fireOnce{};
+            uint64_t intervalNanosec{1'000'000'000};
+            std::function<AsyncGenerator<IchorBehaviour>()> fnAsync{};
+            std::function<void()> fn{};
+            uint64_t priority{INTERNAL_EVENT_PRIORITY};
+        };
+
+        void release() noexcept;
+        static void arm(State &state) noexcept;
+        static void onExpired(State &state);
+        static void fire(State &state);
+
+        template <typename TIMER, typename QUEUE>
+        friend class TimerFactory;
+
+        std::unique_ptr<State> _state;
+    };
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#ifndef ICHOR_USE_EPOLL
+#error "Ichor has not been compiled with epoll support"
+#endif
+
+#include <ichor/services/timer/ITimerFactory.h>
+#include <ichor/services/timer/ITimerTimerFactory.h>
+#include <ichor/dependency_management/AdvancedService.h>
+#include <ichor/event_queues/IEpollQueue.h>
+#include <ichor/DependencyManager.h>
+#include <ichor/ScopedServiceProxy.h>
+
+namespace Ichor::v1 {
+    /// This class creates timer factories for requesting services, providing the requesting services' serviceId to the factory/timers
+    class EpollTimerFactoryFactory final :  public ITimerTimerFactory, public AdvancedService<EpollTimerFactoryFactory> {
+    public:
+        EpollTimerFactoryFactory(DependencyRegister &reg, Properties props);
+        ~EpollTimerFactoryFactory() final = default;
+
+        void addDependencyInstance(Ichor::ScopedServiceProxy<IEpollQueue*>, IService&) noexcept;
+        void removeDependencyInstance(Ichor::ScopedServiceProxy<IEpollQueue*>, IService&) noexcept;
+
+        std::vector<ServiceIdType> getCreatedTimerFactoryIds() const noexcept final;
+
+    private:
+        Task<tl::expected<void, Ichor::StartError>> start() final;
+        Task<void> stop() final;
+
+        AsyncGenerator<IchorBehaviour> handleDependencyRequest(v1::AlwaysNull<ITimerFactory*>, DependencyRequestEvent const &evt);
+        AsyncGenerator<IchorBehaviour> handleDependencyUndoRequest(v1::AlwaysNull<ITimerFactory*>, DependencyUndoRequestEvent const &evt);
+
+        friend DependencyManager;
+
+        Ichor::ScopedServiceProxy<IEpollQueue*> _q {};
+        DependencyTrackerRegistration _trackerRegistration{};
+        unordered_map<ServiceIdType, ServiceIdType, ServiceIdHash> _factories;
+        bool _quitting{};
+
+        Task<void> pushStopEventForTimerFactory(ServiceIdType requestingSvcId, ServiceIdType factoryId) noexcept;
+    };
+}
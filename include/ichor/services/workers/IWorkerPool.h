@@ -0,0 +1,37 @@
+#pragma once
+
+#include <ichor/coroutines/Task.h>
+#include <ichor/Properties.h>
+#include <cstdint>
+#include <functional>
+#include <span>
+
+namespace Ichor::PropertyKeys {
+    /// bool, lets the DependencyManager run start() of this service on an active IWorkerPool, concurrently with the other services of its insertServiceBatch() layer.
+    /// Until it first suspends, start() must then not touch other services or the DependencyManager, see DependencyManager::insertServiceBatch().
+    inline constexpr PropertyKey<bool> ParallelStart{"ParallelStart"};
+}
+
+namespace Ichor::v1 {
+    class IWorkerPool {
+    public:
+        /*
+         * Runs fn on one of the worker threads and resumes the caller on its own thread once fn has returned.
+         * Meant for work that would otherwise block the event loop, such as loading tables or warming caches in start().
+         * fn runs concurrently with the event loop, so it must not touch services, the DependencyManager or anything else owned by the thread of the caller, nor throw.
+         * Results are passed back through captures, which stay valid as the caller is suspended until fn has returned.
+         */
+        virtual Task<void> run(std::function<void()> fn) = 0;
+
+        /*
+         * Runs fns concurrently on the worker threads and the calling thread, returning once all of them have returned. Blocks the calling thread.
+         * Same rules for fns as for run(). Used by the DependencyManager to start services of a batch in parallel.
+         */
+        virtual void runAndWait(std::span<std::function<void()>> fns) = 0;
+
+        [[nodiscard]] virtual uint32_t getWorkerCount() const noexcept = 0;
+
+    protected:
+        ~IWorkerPool() = default;
+    };
+}
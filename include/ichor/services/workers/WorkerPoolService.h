@@ -0,0 +1,37 @@
+#pragma once
+
+#include <ichor/services/workers/IWorkerPool.h>
+#include <ichor/dependency_management/AdvancedService.h>
+#include <memory>
+
+namespace Ichor::PropertyKeys {
+    inline constexpr PropertyKey<uint32_t> WorkerThreads{"WorkerThreads"};
+}
+
+namespace Ichor::v1 {
+    /// Runs functions on worker threads owned by this instance, resuming the awaiting coroutine on the thread of its queue.
+    /// Services opt in by requesting an IWorkerPool. A start() suspended in run() does not block the queue, so blocking work offloaded by independent services overlaps.
+    /// Once active, it also runs start() of batch services that set "ParallelStart", see DependencyManager::insertServiceBatch().
+    /// Properties:
+    /// - "WorkerThreads" uint32_t, amount of worker threads, defaults to std::thread::hardware_concurrency()
+    class WorkerPoolService final : public IWorkerPool, public AdvancedService<WorkerPoolService> {
+    public:
+        WorkerPoolService(Properties props);
+
+        /// Runs fn on the calling thread if the pool is not started
+        Task<void> run(std::function<void()> fn) final;
+        /// Runs fns on the calling thread if the pool is not started
+        void runAndWait(std::span<std::function<void()>> fns) final;
+        [[nodiscard]] uint32_t getWorkerCount() const noexcept final;
+
+    private:
+        Task<tl::expected<void, Ichor::StartError>> start() final;
+        Task<void> stop() final;
+
+        // Defined in the .cpp
+        struct Workers;
+
+        uint32_t _workerCount{};
+        std::shared_ptr<Workers> _workers;
+    };
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <fmt/core.h>
+
+namespace Ichor::Detail {
+    /// Plain set of threads running queued jobs in FIFO order, shared by the worker pool and the file I/O services.
+    /// Job has to be movable and callable without arguments. Handing results back to a queue is up to the job, see CompletionBatch.
+    template <typename Job>
+    class WorkerThreads final {
+    public:
+        WorkerThreads() = default;
+        WorkerThreads(WorkerThreads const &) = delete;
+        WorkerThreads(WorkerThreads &&) = delete;
+        WorkerThreads& operator=(WorkerThreads const &) = delete;
+        WorkerThreads& operator=(WorkerThreads &&) = delete;
+
+        /// Starts at least one thread, named "<name>-<index>" where supported. Not thread safe with stop().
+        void start(uint32_t threadCount, [[maybe_unused]] std::string_view name) {
+            {
+                std::unique_lock lg{_mutex};
+                _stopping = false;
+            }
+            threadCount = std::max(threadCount, 1u);
+            _threads.reserve(threadCount);
+            for(uint32_t i = 0; i < threadCount; i++) {
+                _threads.emplace_back([this]() {
+                    run();
+                });
+#if defined(__linux__) || defined(__CYGWIN__)
+                pthread_setname_np(_threads.back().native_handle(), fmt::format("{}-{}", name, i).c_str());
+#endif
+            }
+        }
+
+        /// Runs the jobs that are still queued, there are coroutines waiting on them, then joins the threads.
+        void stop() {
+            {
+                std::unique_lock lg{_mutex};
+                _stopping = true;
+            }
+            _cv.notify_all();
+            for(auto &thread : _threads) {
+                thread.join();
+            }
+            _threads.clear();
+        }
+
+        void push(Job &&job) {
+            {
+                std::unique_lock lg{_mutex};
+                _jobs.emplace_back(std::move(job));
+            }
+            _cv.notify_one();
+        }
+
+        /// Runs the oldest queued job on the calling thread, if any. Lets a thread waiting on jobs help out instead of blocking.
+        bool runOne() {
+            std::unique_lock lg{_mutex};
+            if(_jobs.empty()) {
+                return false;
+            }
+
+            auto job = std::move(_jobs.front());
+            _jobs.pop_front();
+            lg.unlock();
+            job();
+            return true;
+        }
+
+    private:
+        void run() {
+            std::unique_lock lg{_mutex};
+            while(true) {
+                _cv.wait(lg, [this]() {
+                    return _stopping || !_jobs.empty();
+                });
+
+                if(_jobs.empty()) {
+                    return;
+                }
+
+                {
+                    auto job = std::move(_jobs.front());
+                    _jobs.pop_front();
+                    lg.unlock();
+                    job();
+                }
+                lg.lock();
+            }
+        }
+
+        std::vector<std::thread> _threads;
+        std::mutex _mutex;
+        std::condition_variable _cv;
+        std::deque<Job> _jobs;
+        bool _stopping{};
+    };
+}
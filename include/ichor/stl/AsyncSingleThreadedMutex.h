@@ -48,7 +48,7 @@ namespace Ichor::v1 {
 #endif
             if(_locked) {
                 _evts.push(std::make_unique<AsyncManualResetEvent>());
-                auto *evt = _evts.front().get();
+                auto *evt = _evts.back().get();
                 co_await *evt;
             }
 
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <atomic>
+#include <ichor/stl/ReferenceCountedPointer.h>
+
+namespace Ichor::v1 {
+
+    /// Reference counted pointer that can be copied and destroyed from multiple threads concurrently.
+    /// Uses the same control block as ReferenceCountedPointer, but updates the count atomically. Prefer ReferenceCountedPointer for data that stays on one thread.
+    /// Only the count is synchronized, use a const T to share data between threads without further locking.
+    template <typename T>
+    class [[nodiscard]] AtomicReferenceCountedPointer final {
+    public:
+        constexpr AtomicReferenceCountedPointer() noexcept = default;
+        AtomicReferenceCountedPointer(const AtomicReferenceCountedPointer &o) noexcept : _ptr(o._ptr) {
+            increment();
+        }
+        template <typename U> requires Constructible<T, U>
+        AtomicReferenceCountedPointer(const AtomicReferenceCountedPointer<U> &o) noexcept : _ptr(o._ptr) {
+            increment();
+        }
+        constexpr AtomicReferenceCountedPointer(AtomicReferenceCountedPointer &&o) noexcept : _ptr(o._ptr) {
+            o._ptr = nullptr;
+        }
+        template <typename U> requires Constructible<T, U>
+        constexpr AtomicReferenceCountedPointer(AtomicReferenceCountedPointer<U> &&o) noexcept : _ptr(o._ptr) {
+            o._ptr = nullptr;
+        }
+
+        explicit AtomicReferenceCountedPointer(T* p) : _ptr(new Detail::ReferenceCountedPointerDeleter(const_cast<std::remove_const_t<T>*>(p), [](void *ptr) { delete static_cast<T*>(ptr); })) {
+        }
+        template <typename... U> requires Constructible<T, U...>
+        explicit AtomicReferenceCountedPointer(U&&... args) : AtomicReferenceCountedPointer(new T(std::forward<U>(args)...)) {
+        }
+
+        ~AtomicReferenceCountedPointer() noexcept {
+            decrement();
+        }
+
+        AtomicReferenceCountedPointer& operator=(const AtomicReferenceCountedPointer &o) noexcept {
+            if(this == &o) [[unlikely]] {
+                return *this;
+            }
+
+            // increment first, o may only be kept alive by this
+            o.increment();
+            decrement();
+            _ptr = o._ptr;
+
+            return *this;
+        }
+
+        AtomicReferenceCountedPointer& operator=(AtomicReferenceCountedPointer &&o) noexcept {
+            if(this == &o) [[unlikely]] {
+                return *this;
+            }
+
+            decrement();
+            _ptr = o._ptr;
+            o._ptr = nullptr;
+
+            return *this;
+        }
+
+        AtomicReferenceCountedPointer& operator=(decltype(nullptr)) noexcept {
+            decrement();
+            _ptr = nullptr;
+
+            return *this;
+        }
+
+        [[nodiscard]] constexpr T& operator*() const noexcept ICHOR_LIFETIME_BOUND {
+            if constexpr (DO_INTERNAL_STL_DEBUG || DO_HARDENING) {
+                if (_ptr == nullptr) [[unlikely]] {
+                    std::terminate();
+                }
+            }
+            return *static_cast<T*>(_ptr->ptr.get());
+        }
+
+        [[nodiscard]] constexpr T* operator->() const noexcept ICHOR_LIFETIME_BOUND {
+            if constexpr (DO_INTERNAL_STL_DEBUG || DO_HARDENING) {
+                if (_ptr == nullptr) [[unlikely]] {
+                    std::terminate();
+                }
+            }
+            return static_cast<T*>(_ptr->ptr.get());
+        }
+
+        [[nodiscard]] constexpr bool operator==(decltype(nullptr)) const noexcept {
+            return _ptr == nullptr;
+        }
+
+        template <typename U>
+        [[nodiscard]] constexpr bool operator==(const AtomicReferenceCountedPointer<U> &o) const noexcept {
+            return _ptr == o._ptr;
+        }
+
+        /// Only a snapshot when other threads hold references as well
+        [[nodiscard]] uint64_t use_count() const noexcept {
+            if(_ptr == nullptr) {
+                return 0;
+            }
+
+            return std::atomic_ref<uint64_t>{_ptr->useCount}.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] constexpr bool has_value() const noexcept {
+            return _ptr != nullptr;
+        }
+
+        [[nodiscard]] constexpr T* get() const noexcept ICHOR_LIFETIME_BOUND {
+            if constexpr (DO_INTERNAL_STL_DEBUG || DO_HARDENING) {
+                if (_ptr == nullptr) [[unlikely]] {
+                    std::terminate();
+                }
+            }
+            return static_cast<T*>(_ptr->ptr.get());
+        }
+
+        constexpr void swap(AtomicReferenceCountedPointer<T> &o) noexcept {
+            auto *ptr = _ptr;
+            _ptr = o._ptr;
+            o._ptr = ptr;
+        }
+
+    private:
+        void increment() const noexcept {
+            if(_ptr != nullptr) {
+                std::atomic_ref<uint64_t>{_ptr->useCount}.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        void decrement() const noexcept {
+            // acq_rel so that the deleting thread sees all writes other threads made before releasing their reference
+            if(_ptr != nullptr && std::atomic_ref<uint64_t>{_ptr->useCount}.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                delete _ptr;
+            }
+        }
+
+        Detail::ReferenceCountedPointerBase *_ptr{};
+
+        template<typename>
+        friend class AtomicReferenceCountedPointer;
+    };
+
+    /// Unlike the constructor, also constructs T when no args are given
+    template <typename T, typename... Args>
+    AtomicReferenceCountedPointer<T> make_atomic_reference_counted(Args&&... args) {
+        return AtomicReferenceCountedPointer<T>(new T(std::forward<Args>(args)...));
+    }
+}
+
+namespace std {
+    template<typename T>
+    inline constexpr void swap(Ichor::v1::AtomicReferenceCountedPointer<T>& a, Ichor::v1::AtomicReferenceCountedPointer<T>& b) noexcept {
+        a.swap(b);
+    }
+}
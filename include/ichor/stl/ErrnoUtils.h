@@ -38,6 +38,7 @@ namespace Ichor::v1 {
         NO_SPACE_LEFT,
         IO_ERROR,
         BAD_FILE_DESCRIPTOR,
+        FILE_ALREADY_EXISTS,
         // sockets
         NOT_CONNECTED,
         NOT_A_SOCKET,
@@ -85,6 +86,8 @@ namespace Ichor::v1 {
             return IOError::NO_SPACE_LEFT;
         } else if(err == EBADF) {
             return IOError::BAD_FILE_DESCRIPTOR;
+        } else if(err == EEXIST) {
+            return IOError::FILE_ALREADY_EXISTS;
         } else if(err == EIO) {
             return IOError::IO_ERROR;
         } else if(err == ENOTCONN) {
@@ -160,6 +163,8 @@ struct fmt::formatter<Ichor::v1::IOError> {
                 return fmt::format_to(ctx.out(), "IO_ERROR");
             case Ichor::v1::IOError::BAD_FILE_DESCRIPTOR:
                 return fmt::format_to(ctx.out(), "BAD_FILE_DESCRIPTOR");
+            case Ichor::v1::IOError::FILE_ALREADY_EXISTS:
+                return fmt::format_to(ctx.out(), "FILE_ALREADY_EXISTS");
             case Ichor::v1::IOError::NOT_CONNECTED:
                 return fmt::format_to(ctx.out(), "NOT_CONNECTED");
             case Ichor::v1::IOError::NOT_A_SOCKET:
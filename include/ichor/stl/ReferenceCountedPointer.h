@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <type_traits>
 #include <memory>
@@ -54,7 +55,8 @@ namespace Ichor::v1 {
             constexpr ReferenceCountedPointerBase &operator=(ReferenceCountedPointerBase &&) = default;
             constexpr virtual ~ReferenceCountedPointerBase() noexcept = default;
             NeverNull<void*> ptr;
-            uint64_t useCount{};
+            // aligned for AtomicReferenceCountedPointer, which updates it through std::atomic_ref
+            alignas(std::atomic_ref<uint64_t>::required_alignment) uint64_t useCount{};
 
         protected:
             constexpr ReferenceCountedPointerBase(void* _ptr, uint64_t _useCount) noexcept : ptr(_ptr), useCount(_useCount) {
@@ -159,6 +159,13 @@ namespace Ichor::v1 {
         });
     }
 
+    // ASCII only, e.g. for HTTP header names
+    static constexpr bool CaseInsensitiveEquals(std::string_view a, std::string_view b) noexcept {
+        return a.size() == b.size() && std::equal(a.cbegin(), a.cend(), b.cbegin(), [](char const x, char const y) {
+            return (x >= 'A' && x <= 'Z' ? static_cast<char>(x - 'A' + 'a') : x) == (y >= 'A' && y <= 'Z' ? static_cast<char>(y - 'A' + 'a') : y);
+        });
+    }
+
     static constexpr tl::optional<Version> parseStringAsVersion(std::string_view str) {
         if(str.length() < 5) {
             return {};
@@ -0,0 +1,67 @@
+#include <ichor/CommunicationChannel.h>
+#include <algorithm>
+
+namespace {
+    struct PendingCalls {
+        Ichor::CommunicationChannel *channel;
+        uint64_t managerId;
+        std::vector<std::function<void(bool)>> calls;
+    };
+
+    // a thread rarely talks to more than a handful of managers, a linear search is fine.
+    // Entries only exist while a flush is scheduled, so channels and managers that went away leave nothing behind.
+    thread_local std::vector<PendingCalls> pendingCalls{};
+
+    std::vector<PendingCalls>::iterator findPendingCalls(Ichor::CommunicationChannel *channel, uint64_t managerId) {
+        return std::find_if(pendingCalls.begin(), pendingCalls.end(), [channel, managerId](PendingCalls const &pending) {
+            return pending.channel == channel && pending.managerId == managerId;
+        });
+    }
+}
+
+namespace Ichor {
+    void CommunicationChannel::enqueueCall(uint64_t managerId, std::function<void(bool)> fn) {
+        auto pending = findPendingCalls(this, managerId);
+        if(pending == pendingCalls.end()) {
+            pending = pendingCalls.insert(pendingCalls.end(), PendingCalls{this, managerId, {}});
+        }
+
+        pending->calls.emplace_back(std::move(fn));
+
+        if(pending->calls.size() == 1) {
+            // Calls made before the flush runs are sent along in the same batch. A lower priority would let a steady stream of events delay calls indefinitely.
+            GetThreadLocalEventQueue().pushPrioritisedEvent<RunFunctionEvent>(ServiceIdType{0}, INTERNAL_EVENT_PRIORITY, [this, managerId]() {
+                flushCalls(managerId);
+            });
+        }
+    }
+
+    void CommunicationChannel::flushCalls(uint64_t managerId) {
+        auto pending = findPendingCalls(this, managerId);
+        if(pending == pendingCalls.end()) {
+            return;
+        }
+
+        std::vector<std::function<void(bool)>> calls;
+        calls.swap(pending->calls);
+        pendingCalls.erase(pending);
+
+        {
+            std::shared_lock l(_mutex);
+            auto manager = _managers.find(managerId);
+
+            if(manager != end(_managers)) {
+                manager->second->getEventQueue().pushEvent<RunFunctionEvent>(ServiceIdType{0}, [calls = std::move(calls)]() {
+                    for(auto &call : calls) {
+                        call(true);
+                    }
+                });
+                return;
+            }
+        }
+
+        for(auto &call : calls) {
+            call(false);
+        }
+    }
+}
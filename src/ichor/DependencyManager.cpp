@@ -7,6 +7,7 @@
 #include <ichor/dependency_management/InternalService.h>
 #include <ichor/dependency_management/InternalServiceLifecycleManager.h>
 #include <ichor/dependency_management/IServiceInterestedLifecycleManager.h>
+#include <ichor/services/workers/IWorkerPool.h>
 #include <fmt/format.h>
 
 #if (defined(WIN32) || defined(_WIN32) || defined(__WIN32)) && !defined(__CYGWIN__)
@@ -22,6 +23,11 @@ thread_local Ichor::unordered_set<Ichor::ServiceIdType, Ichor::ServiceIdHash> Ic
 
 constinit thread_local Ichor::DependencyManager *Ichor::Detail::_local_dm = nullptr;
 
+namespace {
+    // amount of coroutine ids reserved for each start run on the worker pool, more than a start() creates before it first suspends
+    constexpr uint64_t PARALLEL_START_ID_RANGE = 1ull << 20;
+}
+
 #ifdef ICHOR_USE_BACKWARD
 #include <backward/backward.h>
 
@@ -32,7 +38,7 @@ namespace backward {
 
 Ichor::DependencyManager::DependencyManager(IEventQueue *eventQueue) : _eventQueue(eventQueue) {
     auto dmlm = std::make_unique<Detail::InternalServiceLifecycleManager<DependencyManager>>(this);
-    _services.emplace(dmlm->serviceId(), std::move(dmlm));
+    _services.emplace(std::move(dmlm));
 }
 
 void Ichor::DependencyManager::start() {
@@ -67,7 +73,8 @@ void Ichor::DependencyManager::processEvent(std::unique_ptr<Event> &uniqueEvt) {
     }
     // when this event needs to be stored in _scopedEvents, we move uniqueEvt and then re-assign evt.
     Event *evt = uniqueEvt.get();
-    if(_logger != nullptr && _logger->getLogLevel() == LogLevel::LOG_TRACE) {
+    auto eventTrace = traceScope(v1::TraceSpanKind::EVENT, *evt, evt->originatingService);
+    if(MIN_LOG_LEVEL <= LogLevel::LOG_TRACE && _logger != nullptr && _logger->getLogLevel() == LogLevel::LOG_TRACE) {
         auto const svcIt = _services.find(evt->originatingService);
         std::string_view svcName = "UNKNOWN";
         if(svcIt != _services.end()) {
@@ -97,6 +104,7 @@ void Ichor::DependencyManager::processEvent(std::unique_ptr<Event> &uniqueEvt) {
             // Make copy because the vector can be modified in the preIntercept() call.
             allEventInterceptorsCopy = interceptorsForAllEvents->second;
             for (EventInterceptInfo const &info: allEventInterceptorsCopy) {
+                auto interceptorTrace = traceScope(v1::TraceSpanKind::INTERCEPTOR, *evt, info.listeningServiceId);
                 if (!info.preIntercept(*evt)) {
                     allowProcessing = false;
                 }
@@ -107,6 +115,7 @@ void Ichor::DependencyManager::processEvent(std::unique_ptr<Event> &uniqueEvt) {
             // Make copy because the vector can be modified in the preIntercept() call.
             eventInterceptorsCopy = interceptorsForEvent->second;
             for (EventInterceptInfo const &info: eventInterceptorsCopy) {
+                auto interceptorTrace = traceScope(v1::TraceSpanKind::INTERCEPTOR, *evt, info.listeningServiceId);
                 if (!info.preIntercept(*evt)) {
                     allowProcessing = false;
                 }
@@ -134,55 +143,7 @@ void Ichor::DependencyManager::processEvent(std::unique_ptr<Event> &uniqueEvt) {
                     break;
                 }
 
-                finishWaitingService(depOnlineEvt->originatingService, DependencyOnlineEvent::TYPE, DependencyOnlineEvent::NAME);
-
-                if(!manager->getInterfaces().empty()) {
-                    auto const filterProp = manager->getProperties().find("Filter");
-                    const Filter *filter = nullptr;
-                    if (filterProp != cend(manager->getProperties())) {
-                        filter = Ichor::v1::any_cast<Filter *const>(&filterProp->second);
-                    }
-
-                    for (auto const &[serviceId, possibleDependentLifecycleManager] : _services) {
-                        if (serviceId == depOnlineEvt->originatingService || (filter != nullptr && !filter->compareTo(*possibleDependentLifecycleManager))) {
-                            INTERNAL_DEBUG("DependencyOnlineEvent {} {}:{} interested service is {}:{} skipping {} {}", evt->id, manager->serviceId(), manager->implementationName(), serviceId, possibleDependentLifecycleManager->implementationName(), serviceId == depOnlineEvt->originatingService, filter != nullptr);
-                            continue;
-                        }
-
-                        auto startBehaviour = possibleDependentLifecycleManager->dependencyOnline(manager.get());
-
-                        INTERNAL_DEBUG("DependencyOnlineEvent {} {}:{} interested service is {}:{} startBehaviour {}", evt->id, manager->serviceId(), manager->implementationName(), serviceId, possibleDependentLifecycleManager->implementationName(), startBehaviour);
-
-                        if(startBehaviour == StartBehaviour::DONE) {
-                            continue;
-                        }
-
-                        auto gen = possibleDependentLifecycleManager->startAfterDependencyOnline();
-                        gen.set_service_id(possibleDependentLifecycleManager->serviceId());
-                        gen.set_priority(std::min(possibleDependentLifecycleManager->getPriority(), INTERNAL_DEPENDENCY_EVENT_PRIORITY));
-                        auto it = gen.begin();
-
-                        INTERNAL_DEBUG("DependencyOnlineEvent {} {}:{} interested service is {}:{} {} {}", evt->id, manager->serviceId(), manager->implementationName(), serviceId, possibleDependentLifecycleManager->implementationName(), it.get_promise_id(), it.get_finished());
-
-                        if(!it.get_finished()) {
-                            if constexpr (DO_INTERNAL_DEBUG) {
-                                if (!it.get_has_suspended()) [[unlikely]] {
-                                    std::terminate();
-                                }
-                            }
-                            _scopedGenerators.emplace(it.get_promise_id(), ScopedGenerator{std::make_unique<AsyncGenerator<StartBehaviour>>(std::move(gen)), v1::make_reference_counted<DependencyOnlineEvent>(_eventQueue->getNextEventId(), serviceId, std::min(INTERNAL_DEPENDENCY_EVENT_PRIORITY, evt->priority))});
-                            // create new event that will be inserted upon finish of coroutine in ContinuableStartEvent
-                            // _scopedEvents.emplace(it.get_promise_id(), v1::make_reference_counted<DependencyOnlineEvent>(_eventQueue->getNextEventId(), serviceId, std::min(INTERNAL_DEPENDENCY_EVENT_PRIORITY, evt->priority)));
-                        } else if(it.get_value() == StartBehaviour::STARTED) {
-                            _eventQueue->pushPrioritisedEvent<DependencyOnlineEvent>(serviceId, std::min(INTERNAL_DEPENDENCY_EVENT_PRIORITY, evt->priority));
-                        }
-                    }
-                }
-
-                // If we're quitting, ensure newly started services are also stopped
-                if(_quitEventReceived) {
-                    _eventQueue->pushPrioritisedEvent<StopServiceEvent>(manager->serviceId(), std::min(INTERNAL_DEPENDENCY_EVENT_PRIORITY, evt->priority), manager->serviceId(), true);
-                }
+                serviceOnline(*manager, *evt, nullptr);
             }
                 break;
             case DependencyOfflineEvent::TYPE: {
@@ -215,13 +176,13 @@ void Ichor::DependencyManager::processEvent(std::unique_ptr<Event> &uniqueEvt) {
                     }
 
                     auto priority = std::min(depIt->second->getPriority(), INTERNAL_DEPENDENCY_EVENT_PRIORITY);
-                    auto depIts = depIt->second->interestedInDependencyGoingOffline(manager.get());
+                    auto depIts = depIt->second->interestedInDependencyGoingOffline(manager);
 
                     if(depIts.empty()) {
                         continue;
                     }
 
-                    auto gen = depIt->second->dependencyOffline(manager.get(), depIts);
+                    auto gen = depIt->second->dependencyOffline(manager, depIts);
                     gen.set_service_id(depIt->second->serviceId());
                     gen.set_priority(priority);
                     auto it = gen.begin();
@@ -259,7 +220,7 @@ void Ichor::DependencyManager::processEvent(std::unique_ptr<Event> &uniqueEvt) {
 
                     if(it.get_value() == StartBehaviour::STOPPED) [[unlikely]] {
                         INTERNAL_DEBUG("DependencyOfflineEvent {} {} {}:{} state {} dependee {}:{} state {} dependee stopped?", evt->id, evt->priority, evt->originatingService, manager->implementationName(), manager->getServiceState(), serviceId, depIt->second->implementationName(), depIt->second->getServiceState());
-                        // depIt->second->finishDependencyOffline(manager.get(), depIts);
+                        // depIt->second->finishDependencyOffline(manager, depIts);
                         // clearServiceRegistrations(allEventInterceptorsCopy, eventInterceptorsCopy, serviceId);
                         // //finishWaitingService(serviceId, StopServiceEvent::TYPE, StopServiceEvent::NAME);
                         // _eventQueue->pushPrioritisedEvent<DependencyOfflineEvent>(serviceId, priority, false);
@@ -268,7 +229,7 @@ void Ichor::DependencyManager::processEvent(std::unique_ptr<Event> &uniqueEvt) {
 
                     if(it.get_value() == StartBehaviour::DONE) {
                         INTERNAL_DEBUG("DependencyOfflineEvent {} {} {}:{} state {} dependee {}:{} state {} dependee removed", evt->id, evt->priority, evt->originatingService, manager->implementationName(), manager->getServiceState(), serviceId, depIt->second->implementationName(), depIt->second->getServiceState());
-                        depIt->second->finishDependencyOffline(manager.get(), depIts);
+                        depIt->second->finishDependencyOffline(manager, depIts);
                     }
 
                     if constexpr (DO_INTERNAL_DEBUG) {
@@ -363,74 +324,17 @@ void Ichor::DependencyManager::processEvent(std::unique_ptr<Event> &uniqueEvt) {
             case InsertServiceEvent::TYPE: {
                 auto *insertServiceEvt = static_cast<InsertServiceEvent *>(evt);
                 INTERNAL_DEBUG("InsertServiceEvent {} {} {}:{}", evt->id, evt->priority, evt->originatingService, insertServiceEvt->mgr->implementationName());
-                auto svcIt = _services.emplace(insertServiceEvt->originatingService, std::move(insertServiceEvt->mgr));
+                auto svcIt = _services.emplace(std::move(insertServiceEvt->mgr));
                 auto &cmpMgr = svcIt.first->second;
 
-                // If a service requests IService, we interpret it to mean a reference to itself, not just all services in existence.
-                Detail::IServiceInterestedLifecycleManager selfMgr{cmpMgr->getIService()};
-                {
-                    auto startBehaviour = cmpMgr->dependencyOnline(&selfMgr);
-
-                    if(startBehaviour == StartBehaviour::STARTED) {
-                        auto gen = cmpMgr->startAfterDependencyOnline();
-                        gen.set_service_id(cmpMgr->serviceId());
-                        gen.set_priority(std::min(cmpMgr->getPriority(), INTERNAL_DEPENDENCY_EVENT_PRIORITY));
-                        auto it = gen.begin();
-
-                        if(!it.get_finished()) {
-                            _scopedGenerators.emplace(it.get_promise_id(), ScopedGenerator{std::make_unique<AsyncGenerator<StartBehaviour>>(std::move(gen)), v1::make_reference_counted<DependencyOnlineEvent>(_eventQueue->getNextEventId(), cmpMgr->serviceId(), std::min(INTERNAL_DEPENDENCY_EVENT_PRIORITY, evt->priority))});
-                            // create new event that will be inserted upon finish of coroutine in ContinuableStartEvent
-                            // _scopedEvents.emplace(it.get_promise_id(), v1::make_reference_counted<DependencyOnlineEvent>(_eventQueue->getNextEventId(), cmpMgr->serviceId(), std::min(INTERNAL_DEPENDENCY_EVENT_PRIORITY, evt->priority)));
-                        } else if(it.get_value() == StartBehaviour::STARTED) {
-                            _eventQueue->pushPrioritisedEvent<DependencyOnlineEvent>(cmpMgr->serviceId(), std::min(INTERNAL_DEPENDENCY_EVENT_PRIORITY, evt->priority));
-                        }
-                    }
-                }
-
-                if(cmpMgr->getDependencyRegistry() == nullptr || cmpMgr->getDependencyRegistry()->empty()) {
-                    break;
-                }
-
-                // loop over all services, check if cmpMgr is interested in the active ones and inject them if so
-                for (auto &[key, mgr] : _services) {
-                    if (mgr->getServiceState() != ServiceState::ACTIVE || mgr->getInterfaces().empty()) {
-                        INTERNAL_DEBUG("InsertServiceEvent {} {}:{} interested service is {}:{} skipping {}", evt->id, cmpMgr->serviceId(), cmpMgr->implementationName(), key, mgr->implementationName(), mgr->getServiceState());
-                        continue;
-                    }
-
-                    auto const filterProp = mgr->getProperties().find("Filter");
-                    const Filter *filter = nullptr;
-                    if (filterProp != cend(mgr->getProperties())) {
-                        filter = Ichor::v1::any_cast<Filter * const>(&filterProp->second);
-                    }
-
-                    if (filter != nullptr && !filter->compareTo(*cmpMgr.get())) {
-                        continue;
-                    }
-
-                    auto startBehaviour = cmpMgr->dependencyOnline(mgr.get());
-
-                    INTERNAL_DEBUG("InsertServiceEvent {} {}:{} interested service is {}:{} startBehaviour {}", evt->id, cmpMgr->serviceId(), cmpMgr->implementationName(), key, mgr->implementationName(), startBehaviour);
-
-                    if(startBehaviour == StartBehaviour::DONE) {
-                        continue;
-                    }
-
-                    auto gen = cmpMgr->startAfterDependencyOnline();
-                    gen.set_service_id(cmpMgr->serviceId());
-                    gen.set_priority(std::min(cmpMgr->getPriority(), INTERNAL_DEPENDENCY_EVENT_PRIORITY));
-                    auto it = gen.begin();
-
-                    if(!it.get_finished()) {
-                        _scopedGenerators.emplace(it.get_promise_id(), ScopedGenerator{std::make_unique<AsyncGenerator<StartBehaviour>>(std::move(gen)), v1::make_reference_counted<DependencyOnlineEvent>(_eventQueue->getNextEventId(), cmpMgr->serviceId(), std::min(INTERNAL_DEPENDENCY_EVENT_PRIORITY, evt->priority))});
-                        // create new event that will be inserted upon finish of coroutine in ContinuableStartEvent
-                        // _scopedEvents.emplace(it.get_promise_id(), v1::make_reference_counted<DependencyOnlineEvent>(_eventQueue->getNextEventId(), cmpMgr->serviceId(), std::min(INTERNAL_DEPENDENCY_EVENT_PRIORITY, evt->priority)));
-                    } else if(it.get_value() == StartBehaviour::STARTED) {
-                        _eventQueue->pushPrioritisedEvent<DependencyOnlineEvent>(cmpMgr->serviceId(), std::min(INTERNAL_DEPENDENCY_EVENT_PRIORITY, evt->priority));
-                    }
+                if(injectDependenciesInto(*cmpMgr, *evt)) {
+                    _eventQueue->pushPrioritisedEvent<DependencyOnlineEvent>(cmpMgr->serviceId(), std::min(INTERNAL_DEPENDENCY_EVENT_PRIORITY, evt->priority));
                 }
             }
                 break;
+            case InsertServiceBatchEvent::TYPE:
+                handleInsertServiceBatch(*static_cast<InsertServiceBatchEvent *>(evt));
+                break;
             case StopServiceEvent::TYPE: {
                 auto *stopServiceEvt = static_cast<StopServiceEvent *>(evt);
                 ILifecycleManager *toStopService;
@@ -443,7 +347,7 @@ void Ichor::DependencyManager::processEvent(std::unique_ptr<Event> &uniqueEvt) {
                         break;
                     }
 
-                    toStopService = toStopServiceIt->second.get();
+                    toStopService = toStopServiceIt->second;
                 }
 
                 INTERNAL_DEBUG("StopServiceEvent {} {} {}:{} state {} dependees {} removeAfter {}", evt->id, evt->priority, stopServiceEvt->serviceId, toStopService->implementationName(), toStopService->getServiceState(), toStopService->getDependees().size(), stopServiceEvt->removeAfter);
@@ -547,7 +451,7 @@ void Ichor::DependencyManager::processEvent(std::unique_ptr<Event> &uniqueEvt) {
                                 }
                             }
 
-                            toStopService->finishDependencyOffline(pendingSvc->second.get(), pendingSvcInfo.deps);
+                            toStopService->finishDependencyOffline(pendingSvc->second, pendingSvcInfo.deps);
 
                             if(pendingSvc->second->getDependees().empty()) {
                                 INTERNAL_DEBUG("StopServiceEvent {} {} {}:{} state {} dependee {}:{} state {} queueing stop for {}:{}", evt->id, evt->priority, pendingSvc->second->serviceId(), pendingSvc->second->implementationName(), pendingSvc->second->getServiceState(), toStopService->serviceId(), toStopService->implementationName(), toStopService->getServiceState(), pendingSvc->second->serviceId(), pendingSvc->second->implementationName());
@@ -601,7 +505,7 @@ void Ichor::DependencyManager::processEvent(std::unique_ptr<Event> &uniqueEvt) {
                     break;
                 }
 
-                auto *toStartService = toStartServiceIt->second.get();
+                auto *toStartService = toStartServiceIt->second;
                 if (toStartService->getServiceState() == ServiceState::ACTIVE) {
                     INTERNAL_DEBUG("StartServiceEvent service {}:{} already started", toStartService->serviceId(), toStartService->implementationName());
                     break;
@@ -662,7 +566,7 @@ void Ichor::DependencyManager::processEvent(std::unique_ptr<Event> &uniqueEvt) {
                     break;
                 }
 
-                auto *toRemoveService = toRemoveServiceIt->second.get();
+                auto *toRemoveService = toRemoveServiceIt->second;
                 INTERNAL_DEBUG("RemoveServiceEvent {} {} {}:{} {}", evt->id, evt->priority, toRemoveService->serviceId(), toRemoveService->implementationName(), toRemoveService->getServiceState());
 
                 if(toRemoveService->getServiceState() != ServiceState::INSTALLED || !toRemoveService->getDependees().empty() || !toRemoveService->getDependencies().empty()) {
@@ -768,7 +672,9 @@ void Ichor::DependencyManager::processEvent(std::unique_ptr<Event> &uniqueEvt) {
                     INTERNAL_DEBUG("ContinuableEvent2 {}", genIt->second.generator->done());
 
                     if (!genIt->second.generator->done()) {
+                        auto resumeTrace = traceScope(v1::TraceSpanKind::COROUTINE_RESUME, *genIt->second.event, genIt->second.generator->get_service_id());
                         auto it = genIt->second.generator->begin_interface();
+                        resumeTrace.finish();
                         INTERNAL_DEBUG("ContinuableEvent it {} {} {}", it->get_finished(), it->get_op_state(), it->get_promise_state());
 
                         if (!it->get_finished() && it->get_promise_state() != state::value_not_ready_consumer_active) {
@@ -836,7 +742,9 @@ void Ichor::DependencyManager::processEvent(std::unique_ptr<Event> &uniqueEvt) {
 
                     StartBehaviour it_ret;
                     if (!genIt->second.generator->done()) {
+                        auto resumeTrace = traceScope(v1::TraceSpanKind::COROUTINE_RESUME, *genIt->second.event, genIt->second.generator->get_service_id());
                         auto it = genIt->second.generator->begin_interface();
+                        resumeTrace.finish();
                         INTERNAL_DEBUG("ContinuableStartEvent it {} {} {}", it->get_finished(), it->get_op_state(), it->get_promise_state());
 
                         if (!it->get_finished()) {
@@ -909,7 +817,7 @@ void Ichor::DependencyManager::processEvent(std::unique_ptr<Event> &uniqueEvt) {
                                     }
                                 }
 
-                                serviceIt->second->finishDependencyOffline(pendingSvc->second.get(), pendingSvcInfo.deps);
+                                serviceIt->second->finishDependencyOffline(pendingSvc->second, pendingSvcInfo.deps);
 
                                 if(pendingSvc->second->getDependees().empty()) {
                                     INTERNAL_DEBUG("Continuable StopServiceEvent {} {} {}:{} state {} dependee {}:{} state {} queueing stop for {}:{}", origEvt->id, origEvt->priority, pendingSvc->second->serviceId(), pendingSvc->second->implementationName(), pendingSvc->second->getServiceState(), serviceIt->second->serviceId(), serviceIt->second->implementationName(), serviceIt->second->getServiceState(), pendingSvc->second->serviceId(), pendingSvc->second->implementationName());
@@ -998,7 +906,7 @@ void Ichor::DependencyManager::processEvent(std::unique_ptr<Event> &uniqueEvt) {
                             if constexpr (DO_INTERNAL_DEBUG) {
                                 if(it_ret == StartBehaviour::STOPPED) [[unlikely]] {
                                     INTERNAL_DEBUG("ContinuableDependencyOfflineEvent {} {} {}:{} state {} dependee {}:{} state {} dependee stopped?", evt->id, evt->priority, originatingOfflineServiceIt->second->serviceId(), originatingOfflineServiceIt->second->implementationName(), originatingOfflineServiceIt->second->getServiceState(), serviceIt->second->serviceId(), serviceIt->second->implementationName(), serviceIt->second->getServiceState());
-                                    // serviceIt->second->finishDependencyOffline(originatingOfflineServiceIt->second.get(), origEvt->dependencyIterators);
+                                    // serviceIt->second->finishDependencyOffline(originatingOfflineServiceIt->second, origEvt->dependencyIterators);
                                     // clearServiceRegistrations(allEventInterceptorsCopy, eventInterceptorsCopy, origEvt->originatingService);
                                     // //finishWaitingService(origEvt->originatingService, StopServiceEvent::TYPE, StopServiceEvent::NAME);
                                     // // The dependee of originatingOfflineServiceId went offline during the async handling of the original
@@ -1013,7 +921,7 @@ void Ichor::DependencyManager::processEvent(std::unique_ptr<Event> &uniqueEvt) {
                             }
 
                             INTERNAL_DEBUG("ContinuableDependencyOfflineEvent {} {} {}:{} state {} dependee {}:{} state {} dependee DONE", evt->id, evt->priority, originatingOfflineServiceIt->second->serviceId(), originatingOfflineServiceIt->second->implementationName(), originatingOfflineServiceIt->second->getServiceState(), serviceIt->second->serviceId(), serviceIt->second->implementationName(), serviceIt->second->getServiceState());
-                            serviceIt->second->finishDependencyOffline(originatingOfflineServiceIt->second.get(), origEvt->dependencyIterators);
+                            serviceIt->second->finishDependencyOffline(originatingOfflineServiceIt->second, origEvt->dependencyIterators);
 
                             if(originatingOfflineServiceIt->second->getDependees().empty()) {
                                 INTERNAL_DEBUG("originatingOfflineService found waiting service {} {}", origEvt->originatingOfflineServiceId, originatingOfflineServiceIt->second->getServiceState());
@@ -1111,10 +1019,12 @@ void Ichor::DependencyManager::processEvent(std::unique_ptr<Event> &uniqueEvt) {
     }
 
     for (EventInterceptInfo const &info : allEventInterceptorsCopy) {
+        auto interceptorTrace = traceScope(v1::TraceSpanKind::INTERCEPTOR, *evt, info.listeningServiceId);
         info.postIntercept(*evt, allowProcessing && handlerAmount > 0);
     }
 
     for (EventInterceptInfo const &info : eventInterceptorsCopy) {
+        auto interceptorTrace = traceScope(v1::TraceSpanKind::INTERCEPTOR, *evt, info.listeningServiceId);
         info.postIntercept(*evt, allowProcessing && handlerAmount > 0);
     }
 
@@ -1151,7 +1061,7 @@ void Ichor::DependencyManager::stop() {
 }
 
 void Ichor::DependencyManager::addInternalServiceManager(std::unique_ptr<ILifecycleManager> svc) {
-    _services.emplace(svc->serviceId(), std::move(svc));
+    _services.emplace(std::move(svc));
 }
 
 void Ichor::DependencyManager::clearServiceRegistrations(std::vector<EventInterceptInfo> &allEventInterceptorsCopy, std::vector<EventInterceptInfo> &eventInterceptorsCopy, ServiceIdType svcId) {
@@ -1240,6 +1150,11 @@ void Ichor::DependencyManager::removeInternalService(std::vector<EventInterceptI
         }
     }
 
+    // a removed service no longer holds up the batch it was inserted with
+    if(!_startingBatchMembers.empty()) {
+        finishStartingBatchMember(svcId);
+    }
+
     auto depReg = svcIt->second->getDependencyRegistry();
     if(depReg != nullptr) {
         for(auto &dep : *depReg) {
@@ -1451,12 +1366,384 @@ bool Ichor::DependencyManager::hasDependencyWaiter(ServiceIdType serviceId, uint
     return false;
 }
 
+bool Ichor::DependencyManager::injectDependenciesInto(ILifecycleManager &cmpMgr, Event const &evt) {
+    bool startedSynchronously{};
+
+    // If a service requests IService, we interpret it to mean a reference to itself, not just all services in existence.
+    Detail::IServiceInterestedLifecycleManager selfMgr{cmpMgr.getIService()};
+    if(cmpMgr.dependencyOnline(&selfMgr) == StartBehaviour::STARTED) {
+        startedSynchronously = startAfterDependencyOnline(cmpMgr, evt);
+    }
+
+    if(cmpMgr.getDependencyRegistry() == nullptr || cmpMgr.getDependencyRegistry()->empty()) {
+        return startedSynchronously;
+    }
+
+    // loop over the services providing an interface cmpMgr depends on, inject the active ones
+    _services.forEachProvidingDependencyOf(cmpMgr.serviceId(), [&]([[maybe_unused]] ServiceIdType key, ILifecycleManager &provider) {
+        auto *mgr = &provider;
+        if (mgr->getServiceState() != ServiceState::ACTIVE || mgr->getInterfaces().empty()) {
+            INTERNAL_DEBUG("InsertServiceEvent {} {}:{} interested service is {}:{} skipping {}", evt.id, cmpMgr.serviceId(), cmpMgr.implementationName(), key, mgr->implementationName(), mgr->getServiceState());
+            return;
+        }
+
+        auto const *filter = mgr->getProperties().get(PropertyKeys::Filter);
+
+        if (filter != nullptr && !filter->compareTo(cmpMgr)) {
+            return;
+        }
+
+        auto startBehaviour = cmpMgr.dependencyOnline(mgr);
+
+        INTERNAL_DEBUG("InsertServiceEvent {} {}:{} interested service is {}:{} startBehaviour {}", evt.id, cmpMgr.serviceId(), cmpMgr.implementationName(), key, mgr->implementationName(), startBehaviour);
+
+        if(startBehaviour == StartBehaviour::DONE) {
+            return;
+        }
+
+        if(startAfterDependencyOnline(cmpMgr, evt)) {
+            startedSynchronously = true;
+        }
+    });
+
+    return startedSynchronously;
+}
+
+bool Ichor::DependencyManager::startAfterDependencyOnline(ILifecycleManager &mgr, Event const &evt) {
+    if(_deferredStarts != nullptr) {
+        deferStart(mgr, std::min(INTERNAL_DEPENDENCY_EVENT_PRIORITY, evt.priority), true);
+        return false;
+    }
+
+    auto gen = mgr.startAfterDependencyOnline();
+    gen.set_service_id(mgr.serviceId());
+    gen.set_priority(std::min(mgr.getPriority(), INTERNAL_DEPENDENCY_EVENT_PRIORITY));
+    auto it = gen.begin();
+
+    INTERNAL_DEBUG("startAfterDependencyOnline {} {}:{} {} {}", evt.id, mgr.serviceId(), mgr.implementationName(), it.get_promise_id(), it.get_finished());
+
+    if(!it.get_finished()) {
+        if constexpr (DO_INTERNAL_DEBUG) {
+            if (!it.get_has_suspended()) [[unlikely]] {
+                std::terminate();
+            }
+        }
+        // create new event that will be inserted upon finish of coroutine in ContinuableStartEvent
+        _scopedGenerators.emplace(it.get_promise_id(), ScopedGenerator{std::make_unique<AsyncGenerator<StartBehaviour>>(std::move(gen)), v1::make_reference_counted<DependencyOnlineEvent>(_eventQueue->getNextEventId(), mgr.serviceId(), std::min(INTERNAL_DEPENDENCY_EVENT_PRIORITY, evt.priority))});
+        return false;
+    }
+
+    return it.get_value() == StartBehaviour::STARTED;
+}
+
+void Ichor::DependencyManager::serviceOnline(ILifecycleManager &manager, Event const &evt, unordered_map<ServiceIdType, uint32_t, ServiceIdHash> const *pendingBatchMembers) {
+    auto const serviceId = manager.serviceId();
+
+    finishWaitingService(serviceId, DependencyOnlineEvent::TYPE, DependencyOnlineEvent::NAME);
+
+    if(!_startingBatchMembers.empty()) {
+        finishStartingBatchMember(serviceId);
+    }
+
+    if(!manager.getInterfaces().empty()) {
+        auto const *filter = manager.getProperties().get(PropertyKeys::Filter);
+
+        // only services that registered a dependency on one of the interfaces of manager and that its filter can match are visited
+        _services.forEachInterestedIn(serviceId, [&](ServiceIdType dependentId, ILifecycleManager &dependent) {
+            if (dependentId == serviceId || (filter != nullptr && !filter->compareTo(dependent))) {
+                INTERNAL_DEBUG("DependencyOnlineEvent {} {}:{} interested service is {}:{} skipping {} {}", evt.id, serviceId, manager.implementationName(), dependentId, dependent.implementationName(), dependentId == serviceId, filter != nullptr);
+                return;
+            }
+
+            if (pendingBatchMembers != nullptr && pendingBatchMembers->contains(dependentId)) {
+                return;
+            }
+
+            auto startBehaviour = dependent.dependencyOnline(&manager);
+
+            INTERNAL_DEBUG("DependencyOnlineEvent {} {}:{} interested service is {}:{} startBehaviour {}", evt.id, serviceId, manager.implementationName(), dependentId, dependent.implementationName(), startBehaviour);
+
+            if(startBehaviour == StartBehaviour::DONE) {
+                return;
+            }
+
+            if(startAfterDependencyOnline(dependent, evt)) {
+                _eventQueue->pushPrioritisedEvent<DependencyOnlineEvent>(dependentId, std::min(INTERNAL_DEPENDENCY_EVENT_PRIORITY, evt.priority));
+            }
+        });
+    }
+
+    // If we're quitting, ensure newly started services are also stopped
+    if(_quitEventReceived) {
+        _eventQueue->pushPrioritisedEvent<StopServiceEvent>(serviceId, std::min(INTERNAL_DEPENDENCY_EVENT_PRIORITY, evt.priority), serviceId, true);
+    }
+}
+
+void Ichor::DependencyManager::handleInsertServiceBatch(InsertServiceBatchEvent &evt) {
+    INTERNAL_DEBUG("InsertServiceBatchEvent {} {} batch {} size {}", evt.id, evt.priority, evt.batchId, evt.entries.size());
+    auto const count = static_cast<uint32_t>(evt.entries.size());
+
+    if(count == 0) {
+        _eventQueue->pushPrioritisedEvent<ServiceBatchStartedEvent>(ServiceIdType{0}, INTERNAL_EVENT_PRIORITY, evt.batchId);
+        return;
+    }
+
+    std::vector<ILifecycleManager*> members;
+    members.reserve(count);
+    // services of the batch that have not been started yet, with their index in the batch
+    unordered_map<ServiceIdType, uint32_t, ServiceIdHash> pendingMembers;
+    pendingMembers.reserve(count);
+
+    for(uint32_t i = 0; i < count; i++) {
+        auto *mgr = evt.entries[i].mgr.get();
+        _services.emplace(std::move(evt.entries[i].mgr));
+        members.push_back(mgr);
+        pendingMembers.emplace(mgr->serviceId(), i);
+        _startingBatchMembers.emplace(mgr->serviceId(), evt.batchId);
+    }
+    _startingBatches.emplace(evt.batchId, count);
+
+    // Order the batch so that services come after the services in the batch they depend on, by how many of those each one waits for (Kahn's algorithm).
+    // Edges come from the dependency index and ignore filters, a superfluous edge only costs ordering freedom.
+    std::vector<std::pair<uint32_t, uint32_t>> edges; // provider, dependent
+    std::vector<uint32_t> waitingFor(count);
+    for(uint32_t i = 0; i < count; i++) {
+        _services.forEachProvidingDependencyOf(members[i]->serviceId(), [&](ServiceIdType providerId, ILifecycleManager &) {
+            auto const provider = pendingMembers.find(providerId);
+            if(provider == pendingMembers.end() || provider->second == i) {
+                return;
+            }
+            edges.emplace_back(provider->second, i);
+            waitingFor[i]++;
+        });
+    }
+    std::sort(edges.begin(), edges.end());
+
+    std::vector<uint32_t> order;
+    order.reserve(count);
+    // layer of each service: 0 without providers in the batch, otherwise one more than its deepest provider. Services within a layer don't depend on each other.
+    std::vector<uint32_t> layers(count);
+    for(uint32_t i = 0; i < count; i++) {
+        if(waitingFor[i] == 0) {
+            order.push_back(i);
+        }
+    }
+    for(size_t next = 0; next < order.size(); next++) {
+        auto const provider = order[next];
+        for(auto edge = std::lower_bound(edges.begin(), edges.end(), std::pair<uint32_t, uint32_t>{provider, 0}); edge != edges.end() && edge->first == provider; ++edge) {
+            layers[edge->second] = std::max(layers[edge->second], layers[provider] + 1);
+            if(--waitingFor[edge->second] == 0) {
+                order.push_back(edge->second);
+            }
+        }
+    }
+    // the queue visits all services of a layer before those of the next one, so each layer is a consecutive range of order
+    auto const layeredCount = order.size();
+    // services in a dependency cycle keep their order in the batch, the cycle is resolved through the regular events as with separately created services
+    if(order.size() != count) {
+        for(uint32_t i = 0; i < count; i++) {
+            if(waitingFor[i] != 0) {
+                order.push_back(i);
+            }
+        }
+    }
+
+    // services in a cycle get a layer of their own each
+    for(size_t first = 0; first < order.size();) {
+        auto last = first + 1;
+        while(last < layeredCount && layers[order[last]] == layers[order[first]]) {
+            last++;
+        }
+        startBatchLayer(std::span<uint32_t const>{order}.subspan(first, last - first), members, evt, pendingMembers);
+        first = last;
+    }
+
+    // the dependency trackers handle these after the services they are for were inserted, as with createServiceManager()
+    for(uint32_t i = 0; i < count; i++) {
+        auto const *reg = members[i]->getDependencyRegistry();
+        if(reg == nullptr) {
+            continue;
+        }
+
+        auto const eventPriority = std::min(INTERNAL_DEPENDENCY_EVENT_PRIORITY, evt.entries[i].priority);
+        for (auto const &[key, registration] : *reg) {
+            auto const &props = std::get<tl::optional<Properties>>(registration);
+            _eventQueue->pushPrioritisedEvent<DependencyRequestEvent>(members[i]->serviceId(), eventPriority, std::get<Dependency>(registration), props.has_value() ? &props.value() : tl::optional<Properties const *>{});
+        }
+    }
+}
+
+void Ichor::DependencyManager::startBatchLayer(std::span<uint32_t const> layer, std::span<ILifecycleManager * const> members, InsertServiceBatchEvent &evt, unordered_map<ServiceIdType, uint32_t, ServiceIdHash> &pendingMembers) {
+    std::vector<uint32_t> parallel;
+    for(auto const i : layer) {
+        auto &mgr = *members[i];
+        if(auto const *parallelStart = mgr.getProperties().get(PropertyKeys::ParallelStart); parallelStart != nullptr && *parallelStart) {
+            parallel.push_back(i);
+            continue;
+        }
+
+        pendingMembers.erase(mgr.serviceId());
+        if(startBatchMember(mgr, evt, evt.entries[i].priority) && mgr.setInjected()) {
+            serviceOnline(mgr, evt, &pendingMembers);
+        }
+    }
+
+    // the other services of the layer went first, a pool among them can already take the starts
+    v1::IWorkerPool *pool{};
+    if(parallel.size() > 1) {
+        if(auto pools = getStartedServices<v1::IWorkerPool>(); !pools.empty()) {
+            pool = pools.front();
+        }
+    }
+
+    if(pool == nullptr) {
+        for(auto const i : parallel) {
+            auto &mgr = *members[i];
+            pendingMembers.erase(mgr.serviceId());
+            if(startBatchMember(mgr, evt, evt.entries[i].priority) && mgr.setInjected()) {
+                serviceOnline(mgr, evt, &pendingMembers);
+            }
+        }
+        return;
+    }
+
+    // inject all of them first, recording their starts instead of beginning them
+    std::vector<DeferredStart> starts;
+    starts.reserve(parallel.size());
+    _deferredStarts = &starts;
+    for(auto const i : parallel) {
+        pendingMembers.erase(members[i]->serviceId());
+        std::ignore = startBatchMember(*members[i], evt, evt.entries[i].priority);
+    }
+    _deferredStarts = nullptr;
+
+    // Run each start up to its first suspension on the pool. Coroutines created there see this manager as their own and get ids from a range of their own,
+    // so that the starts that suspended continue on this thread through the regular events.
+    auto const idBase = Detail::AsyncGeneratorPromiseBase::exchange_id_counter(0);
+    Detail::AsyncGeneratorPromiseBase::exchange_id_counter(idBase + starts.size() * PARALLEL_START_ID_RANGE);
+    std::vector<std::function<void()>> jobs;
+    jobs.reserve(starts.size());
+    for(size_t i = 0; i < starts.size(); i++) {
+        jobs.emplace_back([this, &start = starts[i], idCounter = idBase + i * PARALLEL_START_ID_RANGE]() {
+            auto *const previousDm = std::exchange(Detail::_local_dm, this);
+            auto const previousIdCounter = Detail::AsyncGeneratorPromiseBase::exchange_id_counter(idCounter);
+            {
+                auto it = start.gen.begin();
+                start.finished = it.get_finished();
+                start.hasSuspended = it.get_has_suspended();
+                start.promiseId = it.get_promise_id();
+                if(start.finished) {
+                    start.value = it.get_value();
+                }
+            }
+            Detail::AsyncGeneratorPromiseBase::exchange_id_counter(previousIdCounter);
+            Detail::_local_dm = previousDm;
+        });
+    }
+    pool->runAndWait(jobs);
+
+    for(auto &start : starts) {
+        auto &mgr = *start.mgr;
+        INTERNAL_DEBUG("InsertServiceBatchEvent {} {}:{} parallel start finished {} {}", evt.id, mgr.serviceId(), mgr.implementationName(), start.finished, mgr.getServiceState());
+
+        if(!start.finished) {
+            if constexpr (DO_INTERNAL_DEBUG || DO_INTERNAL_COROUTINE_DEBUG) {
+                if (!start.hasSuspended) [[unlikely]] {
+                    std::terminate();
+                }
+            }
+            v1::ReferenceCountedPointer<Event> continuation = start.afterDependencyOnline ?
+                v1::ReferenceCountedPointer<Event>{v1::make_reference_counted<DependencyOnlineEvent>(_eventQueue->getNextEventId(), mgr.serviceId(), start.eventPriority)} :
+                v1::ReferenceCountedPointer<Event>{v1::make_reference_counted<StartServiceEvent>(_eventQueue->getNextEventId(), mgr.serviceId(), start.eventPriority, mgr.serviceId())};
+            _scopedGenerators.emplace(start.promiseId, ScopedGenerator{std::make_unique<AsyncGenerator<StartBehaviour>>(std::move(start.gen)), std::move(continuation)});
+            continue;
+        }
+
+        bool const started = start.afterDependencyOnline ? start.value == StartBehaviour::STARTED : mgr.getServiceState() != ServiceState::INSTALLED;
+        if(started && mgr.setInjected()) {
+            serviceOnline(mgr, evt, &pendingMembers);
+        }
+    }
+}
+
+bool Ichor::DependencyManager::startBatchMember(ILifecycleManager &mgr, Event const &evt, uint64_t priority) {
+    bool startedSynchronously = injectDependenciesInto(mgr, evt);
+
+    // same as the StartServiceEvent createServiceManager() pushes for services without required dependencies
+    bool hasRequiredDependencies{};
+    if(auto const *reg = mgr.getDependencyRegistry(); reg != nullptr) {
+        hasRequiredDependencies = std::any_of(reg->begin(), reg->end(), [](auto const &registration) {
+            return (std::get<Dependency>(registration.second).flags & DependencyFlags::REQUIRED) == DependencyFlags::REQUIRED;
+        });
+    }
+
+    if(!hasRequiredDependencies && mgr.getServiceState() == ServiceState::INSTALLED) {
+        auto const eventPriority = std::min(INTERNAL_DEPENDENCY_EVENT_PRIORITY, priority);
+        if(_deferredStarts != nullptr) {
+            deferStart(mgr, eventPriority, false);
+            return false;
+        }
+
+        auto gen = mgr.start();
+        gen.set_service_id(mgr.serviceId());
+        gen.set_priority(std::min(mgr.getPriority(), INTERNAL_DEPENDENCY_EVENT_PRIORITY));
+        auto it = gen.begin();
+
+        if (!it.get_finished()) {
+            if constexpr (DO_INTERNAL_DEBUG || DO_INTERNAL_COROUTINE_DEBUG) {
+                if (!it.get_has_suspended()) [[unlikely]] {
+                    std::terminate();
+                }
+            }
+            // finished by ContinuableStartEvent as if a StartServiceEvent started it
+            _scopedGenerators.emplace(it.get_promise_id(), ScopedGenerator{std::make_unique<AsyncGenerator<StartBehaviour>>(std::move(gen)), v1::make_reference_counted<StartServiceEvent>(_eventQueue->getNextEventId(), mgr.serviceId(), eventPriority, mgr.serviceId())});
+        } else {
+            startedSynchronously = mgr.getServiceState() != ServiceState::INSTALLED;
+        }
+    }
+
+    INTERNAL_DEBUG("InsertServiceBatchEvent {} {}:{} started synchronously {} {}", evt.id, mgr.serviceId(), mgr.implementationName(), startedSynchronously, mgr.getServiceState());
+
+    return startedSynchronously;
+}
+
+void Ichor::DependencyManager::deferStart(ILifecycleManager &mgr, uint64_t eventPriority, bool afterDependencyOnline) {
+    // injecting more dependencies can find mgr startable again, it still starts once
+    if(std::any_of(_deferredStarts->begin(), _deferredStarts->end(), [&mgr](DeferredStart const &start) { return start.mgr == &mgr; })) {
+        return;
+    }
+
+    auto gen = afterDependencyOnline ? mgr.startAfterDependencyOnline() : mgr.start();
+    gen.set_service_id(mgr.serviceId());
+    gen.set_priority(std::min(mgr.getPriority(), INTERNAL_DEPENDENCY_EVENT_PRIORITY));
+    _deferredStarts->push_back(DeferredStart{&mgr, std::move(gen), eventPriority, afterDependencyOnline});
+}
+
+void Ichor::DependencyManager::finishStartingBatchMember(ServiceIdType serviceId) {
+    auto const member = _startingBatchMembers.find(serviceId);
+    if(member == _startingBatchMembers.end()) {
+        return;
+    }
+
+    auto const batch = _startingBatches.find(member->second);
+    _startingBatchMembers.erase(member);
+
+    if(--batch->second == 0) {
+        INTERNAL_DEBUG("ServiceBatchStartedEvent {}", batch->first);
+        _eventQueue->pushPrioritisedEvent<ServiceBatchStartedEvent>(ServiceIdType{0}, INTERNAL_EVENT_PRIORITY, batch->first);
+        _startingBatches.erase(batch);
+    }
+}
+
 void Ichor::DependencyManager::handleEventCompletion(Ichor::Event const &evt) {
     auto waitingIt = _eventWaiters.find(evt.id);
     if(waitingIt != end(_eventWaiters)) {
         INTERNAL_DEBUG("handleEventCompletion {}:{} {} events.size {}", evt.id, evt.get_name(), evt.originatingService, waitingIt->second.events.size());
 
+        auto const waitingSvcId = waitingIt->second.waitingSvcId;
         for(auto &asyncEvt : waitingIt->second.events) {
+            // resumes the coroutine awaiting this event
+            auto resumeTrace = traceScope(v1::TraceSpanKind::COROUTINE_RESUME, evt, waitingSvcId);
             asyncEvt.second->set();
         }
         // callback above may modify _eventWaiters, invalidating iterators.
@@ -1489,6 +1776,7 @@ std::pair<uint64_t, Ichor::Event*> Ichor::DependencyManager::broadcastEvent(std:
             continue;
         }
 
+        auto callbackTrace = traceScope(v1::TraceSpanKind::CALLBACK, *evt, callbackInfo.listeningServiceId);
         auto gen = callbackInfo.callback(*evt);
         gen.set_service_id(callbackInfo.listeningServiceId);
         gen.set_priority(service->second->getPriority());
@@ -1701,6 +1989,66 @@ Ichor::DependencyManager::ServicesView Ichor::DependencyManager::getAllServices(
     return ServicesView{&_services};
 }
 
+void Ichor::DependencyManager::enableEventTracing(uint64_t capacity) {
+    if constexpr (DO_INTERNAL_DEBUG || DO_HARDENING) {
+        if (this != Detail::_local_dm) [[unlikely]] {
+            ICHOR_EMERGENCY_LOG1(_logger, "Function called from wrong thread.");
+            std::terminate();
+        }
+    }
+
+    retireTraceRing();
+    _traceRing = std::make_shared<v1::EventTraceRing>(_id, capacity);
+    v1::Detail::registerTraceRing(_traceRing);
+}
+
+void Ichor::DependencyManager::disableEventTracing() {
+    if constexpr (DO_INTERNAL_DEBUG || DO_HARDENING) {
+        if (this != Detail::_local_dm) [[unlikely]] {
+            ICHOR_EMERGENCY_LOG1(_logger, "Function called from wrong thread.");
+            std::terminate();
+        }
+    }
+
+    retireTraceRing();
+}
+
+void Ichor::DependencyManager::retireTraceRing() {
+    if(_traceRing == nullptr) {
+        return;
+    }
+
+    // exports in progress keep the ring alive until they are done
+    v1::Detail::unregisterTraceRing(_traceRing.get());
+    // spans never outlive the event that started them, so the ring can go once the queue gets to the next one
+    if(_retiredTraceRings.empty()) {
+        _eventQueue->pushPrioritisedEvent<RunFunctionEvent>(ServiceIdType{0}, INTERNAL_EVENT_PRIORITY, [this]() {
+            _retiredTraceRings.clear();
+        });
+    }
+    _retiredTraceRings.emplace_back(std::move(_traceRing));
+}
+
+Ichor::v1::TraceScope Ichor::DependencyManager::startTraceScope(v1::TraceSpanKind kind, Event const &evt, ServiceIdType serviceId) const noexcept {
+    std::string_view serviceName{};
+    if(auto const svcIt = _services.find(serviceId); svcIt != _services.end()) {
+        serviceName = svcIt->second->implementationName();
+    }
+
+    return v1::TraceScope{*_traceRing, kind, evt.get_name(), serviceName, serviceId, evt.id};
+}
+
+uint64_t Ichor::DependencyManager::getSuspendedCoroutineCount() const noexcept {
+    if constexpr (DO_INTERNAL_DEBUG || DO_HARDENING) {
+        if (this != Detail::_local_dm) [[unlikely]] {
+            ICHOR_EMERGENCY_LOG1(_logger, "Function called from wrong thread.");
+            std::terminate();
+        }
+    }
+
+    return _scopedGenerators.size();
+}
+
 tl::optional<std::string_view> Ichor::DependencyManager::getImplementationNameFor(ServiceIdType serviceId) const noexcept {
     if constexpr (DO_INTERNAL_DEBUG || DO_HARDENING) {
         if (this != Detail::_local_dm) [[unlikely]] {
@@ -1758,6 +2106,32 @@ Ichor::Task<tl::expected<void, Ichor::WaitError>> Ichor::DependencyManager::wait
     co_return {};
 }
 
+Ichor::ServiceBatch Ichor::DependencyManager::createServiceBatch() noexcept {
+    return ServiceBatch{this, _batchIdCounter++};
+}
+
+uint64_t Ichor::DependencyManager::insertServiceBatch(ServiceBatch &&batch) {
+    if constexpr (DO_INTERNAL_DEBUG || DO_HARDENING) {
+        if (_started.load(std::memory_order_acquire) && this != Detail::_local_dm) [[unlikely]] {
+            ICHOR_EMERGENCY_LOG1(_logger, "Function called from wrong thread.");
+            std::terminate();
+        }
+        if (batch._dm != this) [[unlikely]] {
+            ICHOR_EMERGENCY_LOG1(_logger, "Batch was created by another manager.");
+            std::terminate();
+        }
+    }
+
+    uint64_t priority = INTERNAL_INSERT_SERVICE_EVENT_PRIORITY;
+    for(auto const &entry : batch._entries) {
+        priority = std::min(priority, entry.priority);
+    }
+
+    auto const batchId = batch._id;
+    _eventQueue->pushPrioritisedEvent<InsertServiceBatchEvent>(ServiceIdType{0}, priority, batchId, std::move(batch._entries));
+    return batchId;
+}
+
 void Ichor::DependencyManager::setCommunicationChannel(v1::NeverNull<Ichor::CommunicationChannel*> channel) {
     _communicationChannel = channel;
 }
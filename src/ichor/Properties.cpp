@@ -0,0 +1,136 @@
+#include <ichor/Properties.h>
+#include <ichor/Common.h>
+#include <ichor/interfaces/IFrameworkLogger.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+namespace {
+    std::mutex internedNamesMutex;
+    // node based, the strings never move
+    std::unordered_set<std::string, Ichor::string_hash, std::equal_to<>> internedNames;
+}
+
+void Ichor::Detail::warnPropertyTypeMismatch(PropertyName const &name, std::string_view storedType, std::string_view requestedType) noexcept {
+    ICHOR_EMERGENCY_NO_LOGGER_LOG2("Property {} has type {}, not the requested type {}", name, storedType, requestedType);
+}
+
+Ichor::PropertyName Ichor::Detail::internPropertyName(PropertyName name) {
+    if(name.interned()) {
+        return name;
+    }
+
+    std::lock_guard lg{internedNamesMutex};
+    auto it = internedNames.find(name.name());
+    if(it == internedNames.end()) {
+        it = internedNames.emplace(name.name()).first;
+    }
+
+    name._name = it->data();
+    name._interned = true;
+    return name;
+}
+
+// delegates to the default constructor, so the destructor frees the block and the added entries if interning a name throws
+Ichor::Properties::Properties(std::initializer_list<value_type> entries) : Properties() {
+    reserve(entries.size());
+    for(auto const &entry : entries) {
+        emplace(entry.first, entry.second);
+    }
+}
+
+// delegated for the same reason, should copying an entry ever throw
+Ichor::Properties::Properties(Properties const &o) : Properties() {
+    reserve(o._size);
+    std::uninitialized_copy(o.begin(), o.end(), _data);
+    _size = o._size;
+}
+
+Ichor::Properties::Properties(Properties &&o) noexcept {
+    moveFrom(o);
+}
+
+Ichor::Properties& Ichor::Properties::operator=(Properties const &o) {
+    if(this == &o) [[unlikely]] {
+        return *this;
+    }
+
+    clear();
+    reserve(o._size);
+    std::uninitialized_copy(o.begin(), o.end(), _data);
+    _size = o._size;
+    return *this;
+}
+
+Ichor::Properties& Ichor::Properties::operator=(Properties &&o) noexcept {
+    if(this == &o) [[unlikely]] {
+        return *this;
+    }
+
+    release();
+    moveFrom(o);
+    return *this;
+}
+
+Ichor::Properties::~Properties() {
+    release();
+}
+
+Ichor::Properties::iterator Ichor::Properties::erase(const_iterator it) noexcept {
+    auto *pos = _data + (it - _data);
+    auto *last = _data + _size - 1;
+    if(pos != last) {
+        *pos = std::move(*last);
+    }
+    std::destroy_at(last);
+    _size--;
+    return pos;
+}
+
+void Ichor::Properties::clear() noexcept {
+    std::destroy(begin(), end());
+    _size = 0;
+}
+
+void Ichor::Properties::reserve(size_type capacity) {
+    if(capacity > _capacity) {
+        reallocate(static_cast<uint32_t>(capacity));
+    }
+}
+
+Ichor::Properties::iterator Ichor::Properties::append(PropertyName key, v1::any &&value) {
+    if(_size == _capacity) {
+        reallocate(_capacity == 0 ? INITIAL_CAPACITY : _capacity * 2);
+    }
+
+    auto *entry = std::construct_at(_data + _size, value_type{Detail::internPropertyName(key), std::move(value)});
+    _size++;
+    return entry;
+}
+
+void Ichor::Properties::reallocate(uint32_t capacity) {
+    auto *data = std::allocator<value_type>{}.allocate(capacity);
+    std::uninitialized_move(begin(), end(), data);
+    std::destroy(begin(), end());
+    if(_data != nullptr) {
+        std::allocator<value_type>{}.deallocate(_data, _capacity);
+    }
+    _data = data;
+    _capacity = capacity;
+}
+
+void Ichor::Properties::release() noexcept {
+    clear();
+    if(_data != nullptr) {
+        std::allocator<value_type>{}.deallocate(_data, _capacity);
+        _data = nullptr;
+        _capacity = 0;
+    }
+}
+
+void Ichor::Properties::moveFrom(Properties &o) noexcept {
+    _data = std::exchange(o._data, nullptr);
+    _size = std::exchange(o._size, 0);
+    _capacity = std::exchange(o._capacity, 0);
+}
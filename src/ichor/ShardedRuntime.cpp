@@ -0,0 +1,98 @@
+#include <ichor/ShardedRuntime.h>
+#include <ichor/event_queues/PriorityQueue.h>
+#include <ichor/events/InternalEvents.h>
+#include <latch>
+
+namespace {
+    // a thread is a shard of at most one runtime
+    struct ShardOfThread final {
+        Ichor::ShardedRuntime const *runtime;
+        uint32_t shard;
+    };
+    constinit thread_local ShardOfThread shardOfThread{};
+}
+
+namespace Ichor {
+    ShardedRuntime::ShardedRuntime(uint32_t shardCount, QueueFactory queueFactory) : _queueFactory(std::move(queueFactory)), _queues(shardCount), _managers(shardCount) {
+        if(shardCount == 0) [[unlikely]] {
+            fmt::println("ShardedRuntime requires at least one shard");
+            std::terminate();
+        }
+
+        if(!_queueFactory) {
+            _queueFactory = [](uint32_t) -> std::unique_ptr<IEventQueue> {
+                return std::make_unique<PriorityQueue>();
+            };
+        }
+    }
+
+    ShardedRuntime::~ShardedRuntime() {
+        stop();
+        join();
+    }
+
+    void ShardedRuntime::deploy(Deployment fn) {
+        if(!_threads.empty()) [[unlikely]] {
+            fmt::println("ShardedRuntime::deploy has to be called before start()");
+            std::terminate();
+        }
+
+        _deployments.emplace_back(std::move(fn));
+    }
+
+    void ShardedRuntime::start(bool captureSigInt) {
+        if(!_threads.empty()) [[unlikely]] {
+            fmt::println("ShardedRuntime already started");
+            std::terminate();
+        }
+
+        std::latch created{static_cast<std::ptrdiff_t>(_queues.size())};
+        _threads.reserve(_queues.size());
+
+        for(uint32_t shard = 0; shard < _queues.size(); shard++) {
+            _threads.emplace_back([this, shard, captureSigInt, &created]() {
+                shardOfThread = ShardOfThread{this, shard};
+                _queues[shard] = _queueFactory(shard);
+                auto &dm = _queues[shard]->createManager();
+                _managers[shard] = &dm;
+                _channel.addManager(&dm);
+                created.count_down();
+
+                for(auto &deployment : _deployments) {
+                    deployment(dm, shard);
+                }
+
+                _queues[shard]->start(captureSigInt);
+                _channel.removeManager(&dm);
+            });
+        }
+
+        created.wait();
+    }
+
+    void ShardedRuntime::stop() {
+        if(_threads.empty()) {
+            return;
+        }
+
+        for(auto &queue : _queues) {
+            queue->pushEvent<QuitEvent>(ServiceIdType{0});
+        }
+    }
+
+    void ShardedRuntime::join() {
+        for(auto &thread : _threads) {
+            if(thread.joinable()) {
+                thread.join();
+            }
+        }
+    }
+
+    tl::optional<uint32_t> ShardedRuntime::currentShard() const noexcept {
+        if(shardOfThread.runtime != this) {
+            return tl::nullopt;
+        }
+
+        return shardOfThread.shard;
+    }
+}
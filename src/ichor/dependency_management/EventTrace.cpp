@@ -0,0 +1,134 @@
+#include <ichor/dependency_management/EventTrace.h>
+#include <fmt/format.h>
+#include <bit>
+#include <mutex>
+
+namespace {
+    std::mutex ringsMutex{};
+    std::vector<std::weak_ptr<Ichor::v1::EventTraceRing>> rings{};
+
+    std::string_view kindName(Ichor::v1::TraceSpanKind kind) {
+        switch(kind) {
+            case Ichor::v1::TraceSpanKind::EVENT:
+                return "event";
+            case Ichor::v1::TraceSpanKind::INTERCEPTOR:
+                return "interceptor";
+            case Ichor::v1::TraceSpanKind::CALLBACK:
+                return "callback";
+            case Ichor::v1::TraceSpanKind::COROUTINE_RESUME:
+                return "coroutine";
+        }
+        return "unknown";
+    }
+
+    void appendJsonString(std::string &out, std::string_view str) {
+        out += '"';
+        for(char c : str) {
+            if(c == '"' || c == '\\') {
+                out += '\\';
+                out += c;
+            } else if(static_cast<unsigned char>(c) < 0x20) {
+                fmt::format_to(std::back_inserter(out), "\\u{:04x}", static_cast<unsigned>(c));
+            } else {
+                out += c;
+            }
+        }
+        out += '"';
+    }
+}
+
+Ichor::v1::EventTraceRing::EventTraceRing(uint64_t dmId, uint64_t capacity) : _slots(std::make_unique<Slot[]>(std::bit_ceil(std::max<uint64_t>(capacity, 2)))), _mask(std::bit_ceil(std::max<uint64_t>(capacity, 2)) - 1), _dmId(dmId) {
+}
+
+std::vector<Ichor::v1::TraceSpan> Ichor::v1::EventTraceRing::snapshot() const {
+    auto const capacity = _mask + 1;
+    auto const head = _head.load(std::memory_order_acquire);
+    auto const first = head > capacity ? head - capacity : 0;
+
+    std::vector<TraceSpan> spans;
+    spans.reserve(head - first);
+
+    for(auto i = first; i < head; i++) {
+        auto const &slot = _slots[i & _mask];
+        auto const sizesAndKind = slot.sizesAndKind.load(std::memory_order_relaxed);
+        spans.emplace_back(TraceSpan{slot.startNs.load(std::memory_order_relaxed),
+                                     slot.durationNs.load(std::memory_order_relaxed),
+                                     std::string_view{slot.eventName.load(std::memory_order_relaxed), sizesAndKind & 0xFF'FFFF},
+                                     std::string_view{slot.serviceName.load(std::memory_order_relaxed), (sizesAndKind >> 24) & 0xFFFF'FFFF},
+                                     ServiceIdType{slot.serviceId.load(std::memory_order_relaxed)},
+                                     slot.eventId.load(std::memory_order_relaxed),
+                                     static_cast<TraceSpanKind>(sizesAndKind >> 56)});
+    }
+
+    // anything the writer started overwriting while copying may be torn
+    std::atomic_thread_fence(std::memory_order_acquire);
+    auto const writing = _writing.load(std::memory_order_relaxed);
+    auto const firstIntact = writing > capacity ? writing - capacity : 0;
+    if(firstIntact > first) {
+        spans.erase(spans.begin(), spans.begin() + static_cast<std::ptrdiff_t>(std::min(firstIntact - first, spans.size())));
+    }
+
+    return spans;
+}
+
+void Ichor::v1::Detail::registerTraceRing(std::weak_ptr<EventTraceRing> ring) {
+    std::lock_guard lg{ringsMutex};
+    std::erase_if(rings, [](std::weak_ptr<EventTraceRing> const &r) {
+        return r.expired();
+    });
+    rings.emplace_back(std::move(ring));
+}
+
+void Ichor::v1::Detail::unregisterTraceRing(EventTraceRing const *ring) {
+    std::lock_guard lg{ringsMutex};
+    std::erase_if(rings, [ring](std::weak_ptr<EventTraceRing> const &r) {
+        auto locked = r.lock();
+        return locked == nullptr || locked.get() == ring;
+    });
+}
+
+std::string Ichor::v1::exportChromeTrace() {
+    std::vector<std::shared_ptr<EventTraceRing>> lockedRings;
+    {
+        std::lock_guard lg{ringsMutex};
+        lockedRings.reserve(rings.size());
+        for(auto const &ring : rings) {
+            if(auto locked = ring.lock()) {
+                lockedRings.emplace_back(std::move(locked));
+            }
+        }
+    }
+
+    std::string out{R"({"displayTimeUnit":"ns","traceEvents":[)"};
+    bool first{true};
+    auto separator = [&out, &first]() {
+        if(!first) {
+            out += ',';
+        }
+        first = false;
+    };
+
+    for(auto const &ring : lockedRings) {
+        separator();
+        fmt::format_to(std::back_inserter(out), R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":"DepMan#{}"}}}})", ring->getDmId(), ring->getDmId());
+
+        for(auto const &span : ring->snapshot()) {
+            separator();
+            out += R"({"name":)";
+            // handlers are easier to find by the service, the event is part of the args
+            appendJsonString(out, span.kind == TraceSpanKind::EVENT || span.serviceName.empty() ? span.eventName : span.serviceName);
+            fmt::format_to(std::back_inserter(out), R"(,"cat":"{}","ph":"X","ts":{}.{:03},"dur":{}.{:03},"pid":1,"tid":{},"args":{{"event":)",
+                           kindName(span.kind), span.startNs / 1'000, span.startNs % 1'000, span.durationNs / 1'000, span.durationNs % 1'000, ring->getDmId());
+            appendJsonString(out, span.eventName);
+            fmt::format_to(std::back_inserter(out), R"(,"eventId":{},"serviceId":{})", span.eventId, span.serviceId.value);
+            if(!span.serviceName.empty()) {
+                out += R"(,"service":)";
+                appendJsonString(out, span.serviceName);
+            }
+            out += "}}";
+        }
+    }
+
+    out += "]}";
+    return out;
+}
@@ -0,0 +1,205 @@
+#include <ichor/dependency_management/ServiceRegistry.h>
+
+namespace {
+    void eraseId(std::vector<Ichor::ServiceIdType> &ids, Ichor::ServiceIdType id) noexcept {
+        auto const it = std::find(ids.begin(), ids.end(), id);
+        if(it == ids.end()) [[unlikely]] {
+            return;
+        }
+        *it = ids.back();
+        ids.pop_back();
+    }
+}
+
+namespace Ichor::Detail {
+    std::pair<ServiceRegistry::iterator, bool> ServiceRegistry::emplace(std::unique_ptr<ILifecycleManager> mgr) {
+        auto const id = mgr->serviceId();
+        auto const index = static_cast<uint32_t>(_ids.size());
+        auto [idx, inserted] = _indices.try_emplace(id, index);
+        if(!inserted) {
+            return {iterator{this, idx->second}, false};
+        }
+
+        bool const internal = mgr->isInternalManager();
+
+        HashRange provides{static_cast<uint32_t>(_hashes.size()), 0};
+        for(auto const &interface : mgr->getInterfaces()) {
+            _hashes.push_back(interface.interfaceNameHash);
+            provides.size++;
+        }
+
+        // Internal managers never depend on anything, and some of them do not support asking for their registry.
+        HashRange interests{static_cast<uint32_t>(_hashes.size()), 0};
+        if(!internal) {
+            if(auto const *registry = mgr->getDependencyRegistry(); registry != nullptr) {
+                for(auto const &[interfaceHash, registration] : *registry) {
+                    _hashes.push_back(interfaceHash);
+                    interests.size++;
+                }
+            }
+        }
+
+        FilterIndexKey filterKey{};
+        if(!internal) {
+            if(auto const *filter = mgr->getProperties().get(PropertyKeys::Filter); filter != nullptr) {
+                filterKey = filter->indexKey();
+            }
+        }
+
+        _ids.push_back(id);
+        _provides.push_back(provides);
+        _interests.push_back(interests);
+        _internal.push_back(internal);
+        _filterKeys.push_back(filterKey);
+        _managers.push_back(std::move(mgr));
+        addToIndices(index);
+
+        return {iterator{this, index}, true};
+    }
+
+    void ServiceRegistry::erase(iterator it) {
+        auto const index = it.index();
+        auto const last = static_cast<uint32_t>(_ids.size() - 1);
+        // destroyed once the registry is consistent again
+        auto erased = std::move(_managers[index]);
+
+        removeFromIndices(index);
+        _indices.erase(_ids[index]);
+        _unusedHashes += _provides[index].size + _interests[index].size;
+
+        if(index != last) {
+            _ids[index] = _ids[last];
+            _provides[index] = _provides[last];
+            _interests[index] = _interests[last];
+            _internal[index] = _internal[last];
+            _filterKeys[index] = _filterKeys[last];
+            _managers[index] = std::move(_managers[last]);
+            _indices[_ids[index]] = index;
+        }
+
+        _ids.pop_back();
+        _provides.pop_back();
+        _interests.pop_back();
+        _internal.pop_back();
+        _filterKeys.pop_back();
+        _managers.pop_back();
+
+        if(_unusedHashes > 64 && _unusedHashes > _hashes.size() / 2) {
+            compactHashes();
+        }
+    }
+
+    void ServiceRegistry::clear() noexcept {
+        // destroy the managers last, so that anything their destructors look up finds an empty registry
+        auto managers = std::move(_managers);
+        _managers.clear();
+        _indices.clear();
+        _ids.clear();
+        _provides.clear();
+        _interests.clear();
+        _internal.clear();
+        _filterKeys.clear();
+        _hashes.clear();
+        _unusedHashes = 0;
+        _providers.clear();
+        _interested.clear();
+    }
+
+    void ServiceRegistry::addToIndices(uint32_t idx) {
+        auto const id = _ids[idx];
+        auto const &filterKey = _filterKeys[idx];
+
+        for(auto const hash : hashes(_interests[idx])) {
+            _interested[hash].push_back(id);
+        }
+
+        for(auto const hash : hashes(_provides[idx])) {
+            auto &providers = _providers[hash];
+            switch(filterKey.kind) {
+                case FilterIndexKey::Kind::NONE:
+                    providers.unindexed.push_back(id);
+                    break;
+                case FilterIndexKey::Kind::SERVICE_ID:
+                    providers.byServiceId[ServiceIdType{filterKey.value}].push_back(id);
+                    break;
+                case FilterIndexKey::Kind::PROPERTY: {
+                    auto propertyIndex = std::find_if(providers.byProperty.begin(), providers.byProperty.end(), [&filterKey](PropertyIndex const &p) {
+                        return p.nameHash == filterKey.nameHash && p.typeHash == filterKey.typeHash;
+                    });
+                    if(propertyIndex == providers.byProperty.end()) {
+                        propertyIndex = providers.byProperty.insert(propertyIndex, PropertyIndex{filterKey.nameHash, filterKey.typeHash, filterKey.hashProperty, {}});
+                    }
+                    propertyIndex->byValue[filterKey.value].push_back(id);
+                }
+                    break;
+            }
+        }
+    }
+
+    void ServiceRegistry::removeFromIndices(uint32_t idx) {
+        auto const id = _ids[idx];
+        auto const &filterKey = _filterKeys[idx];
+
+        for(auto const hash : hashes(_interests[idx])) {
+            if(auto interested = _interested.find(hash); interested != _interested.end()) {
+                eraseId(interested->second, id);
+            }
+        }
+
+        // lists keyed on a service id or a property value mostly hold a single service, remove them once empty
+        for(auto const hash : hashes(_provides[idx])) {
+            auto providers = _providers.find(hash);
+            if(providers == _providers.end()) [[unlikely]] {
+                continue;
+            }
+            switch(filterKey.kind) {
+                case FilterIndexKey::Kind::NONE:
+                    eraseId(providers->second.unindexed, id);
+                    break;
+                case FilterIndexKey::Kind::SERVICE_ID: {
+                    auto filtered = providers->second.byServiceId.find(ServiceIdType{filterKey.value});
+                    if(filtered != providers->second.byServiceId.end()) {
+                        eraseId(filtered->second, id);
+                        if(filtered->second.empty()) {
+                            providers->second.byServiceId.erase(filtered);
+                        }
+                    }
+                }
+                    break;
+                case FilterIndexKey::Kind::PROPERTY:
+                    for(auto &propertyIndex : providers->second.byProperty) {
+                        if(propertyIndex.nameHash != filterKey.nameHash || propertyIndex.typeHash != filterKey.typeHash) {
+                            continue;
+                        }
+                        auto filtered = propertyIndex.byValue.find(filterKey.value);
+                        if(filtered != propertyIndex.byValue.end()) {
+                            eraseId(filtered->second, id);
+                            if(filtered->second.empty()) {
+                                propertyIndex.byValue.erase(filtered);
+                            }
+                        }
+                    }
+                    break;
+            }
+        }
+    }
+
+    void ServiceRegistry::compactHashes() {
+        std::vector<NameHashType> compacted;
+        compacted.reserve(_hashes.size() - _unusedHashes);
+
+        auto move = [this, &compacted](HashRange &range) {
+            auto const offset = static_cast<uint32_t>(compacted.size());
+            compacted.insert(compacted.end(), _hashes.begin() + range.offset, _hashes.begin() + range.offset + range.size);
+            range.offset = offset;
+        };
+
+        for(uint32_t i = 0; i < _ids.size(); i++) {
+            move(_provides[i]);
+            move(_interests[i]);
+        }
+
+        _hashes = std::move(compacted);
+        _unusedHashes = 0;
+    }
+}
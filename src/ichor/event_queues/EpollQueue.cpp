@@ -0,0 +1,302 @@
+#ifndef ICHOR_USE_EPOLL
+#error "Epoll not enabled."
+#endif
+
+#include <ichor/event_queues/EpollQueue.h>
+#include <ichor/DependencyManager.h>
+#include <ichor/dependency_management/InternalServiceLifecycleManager.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <csignal>
+#include <array>
+#include <mutex>
+
+namespace Ichor::Detail {
+    extern std::atomic<bool> sigintQuit;
+    extern std::atomic<bool> registeredSignalHandler;
+    void on_sigint([[maybe_unused]] int sig);
+}
+
+namespace {
+    // registration id 0 is reserved for the eventfd
+    constexpr uint64_t EVENTFD_REGISTRATION_ID = 0;
+    constexpr int MAX_EPOLL_EVENTS = 128;
+    // without events to process, wake up periodically to check for sigint
+    constexpr int IDLE_WAIT_MS = 500;
+}
+
+namespace Ichor {
+    EpollQueue::EpollQueue() : EpollQueue(5'000) {
+    }
+
+    EpollQueue::EpollQueue(uint64_t quitTimeoutMs) : _quitTimeoutMs(quitTimeoutMs) {
+        _epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if(_epollFd < 0) [[unlikely]] {
+            fmt::println("epoll_create1() failed, errno {}", errno);
+            std::terminate();
+        }
+
+        _eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if(_eventFd < 0) [[unlikely]] {
+            fmt::println("eventfd() failed, errno {}", errno);
+            std::terminate();
+        }
+
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u64 = EVENTFD_REGISTRATION_ID;
+        if(epoll_ctl(_epollFd, EPOLL_CTL_ADD, _eventFd, &ev) < 0) [[unlikely]] {
+            fmt::println("epoll_ctl() for eventfd failed, errno {}", errno);
+            std::terminate();
+        }
+    }
+
+    EpollQueue::~EpollQueue() {
+        if(_dm) {
+            stopDm();
+        }
+
+        ::close(_eventFd);
+        ::close(_epollFd);
+
+        if(Detail::registeredSignalHandler) {
+            if (::signal(SIGINT, SIG_DFL) == SIG_ERR) {
+                fmt::print("Couldn't unset signal handler\n");
+            }
+        }
+    }
+
+    void EpollQueue::pushEventInternal(uint64_t priority, std::unique_ptr<Event> &&event) {
+        if(!event) [[unlikely]] {
+#if ICHOR_EXCEPTIONS_ENABLED
+            throw std::runtime_error("Pushing nullptr");
+#else
+            fmt::println("Pushing nullptr");
+            std::terminate();
+#endif
+        }
+
+        _pendingEvents.fetch_add(1, std::memory_order_acq_rel);
+
+        if(std::this_thread::get_id() == _threadId.load(std::memory_order_acquire)) [[likely]] {
+            _eventQueue.push(std::move(event));
+            return;
+        }
+
+        bool wasEmpty;
+        {
+            std::lock_guard const l(_otherThreadEventQueueMutex);
+            wasEmpty = _otherThreadEventQueue.empty();
+            _otherThreadEventQueue.emplace_back(std::move(event));
+        }
+
+        // the loop takes all events at once, so only the first one needs to wake it up
+        if(wasEmpty) {
+            wakeup();
+        }
+    }
+
+    bool EpollQueue::empty() const noexcept {
+        return _pendingEvents.load(std::memory_order_acquire) == 0;
+    }
+
+    uint64_t EpollQueue::size() const noexcept {
+        return _pendingEvents.load(std::memory_order_acquire);
+    }
+
+    bool EpollQueue::is_running() const noexcept {
+        return !_quit.load(std::memory_order_acquire);
+    }
+
+    ICHOR_CONST_FUNC_ATTR NameHashType EpollQueue::get_queue_name_hash() const noexcept {
+        return typeNameHash<EpollQueue>();
+    }
+
+    bool EpollQueue::start(bool captureSigInt) {
+        if(!_dm) [[unlikely]] {
+            fmt::println("Please create a manager first!");
+            return false;
+        }
+
+        if(captureSigInt && !Ichor::Detail::registeredSignalHandler.exchange(true)) {
+            if (::signal(SIGINT, Ichor::Detail::on_sigint) == SIG_ERR) {
+                fmt::println("Couldn't set signal");
+                return false;
+            }
+        }
+
+        _threadId.store(std::this_thread::get_id(), std::memory_order_release);
+        // events pushed before starting
+        moveOtherThreadEvents();
+
+        addInternalServiceManager(std::make_unique<Detail::InternalServiceLifecycleManager<IEpollQueue>>(this));
+
+        startDm();
+
+        std::array<epoll_event, MAX_EPOLL_EVENTS> events{};
+
+        while(!shouldQuit()) [[likely]] {
+            auto ret = epoll_wait(_epollFd, events.data(), MAX_EPOLL_EVENTS, _eventQueue.empty() ? IDLE_WAIT_MS : 0);
+
+            if(ret < 0) [[unlikely]] {
+                if(errno != EINTR) {
+                    fmt::println("epoll_wait() failed, errno {}", errno);
+                    std::terminate();
+                }
+                ret = 0;
+            }
+
+            for(int i = 0; i < ret; i++) {
+                auto const id = events[static_cast<size_t>(i)].data.u64;
+
+                if(id == EVENTFD_REGISTRATION_ID) {
+                    uint64_t val;
+                    [[maybe_unused]] auto n = ::read(_eventFd, &val, sizeof(val));
+                    moveOtherThreadEvents();
+                    continue;
+                }
+
+                auto it = _registrations.find(id);
+                if(it == _registrations.end() || it->second.fd == -1) {
+                    continue;
+                }
+
+                it->second.handler(events[static_cast<size_t>(i)].events);
+            }
+
+            for(auto id : _unregistered) {
+                _registrations.erase(id);
+            }
+            _unregistered.clear();
+
+            shouldAddQuitEvent();
+
+            // only process what was queued before, events pushed while processing wait for the next round so fds do not starve
+            auto count = _eventQueue.size();
+            while(count > 0 && !shouldQuit()) {
+                auto evt = _eventQueue.pop();
+                processEvent(evt);
+                _pendingEvents.fetch_sub(1, std::memory_order_acq_rel);
+                count--;
+            }
+        }
+
+        stopDm();
+
+        _threadId.store(std::thread::id{}, std::memory_order_release);
+
+        return true;
+    }
+
+    bool EpollQueue::shouldQuit() {
+        bool const shouldQuit = Detail::sigintQuit.load(std::memory_order_acquire);
+
+        if (shouldQuit && _quitEventSent && std::chrono::steady_clock::now() - _whenQuitEventWasSent >= std::chrono::milliseconds(_quitTimeoutMs)) [[unlikely]] {
+            _quit.store(true, std::memory_order_release);
+        }
+
+        return _quit.load(std::memory_order_acquire);
+    }
+
+    void EpollQueue::quit() {
+        _quit.store(true, std::memory_order_release);
+
+        if(std::this_thread::get_id() != _threadId.load(std::memory_order_acquire)) {
+            wakeup();
+        }
+    }
+
+    tl::expected<void, v1::IOError> EpollQueue::registerFd(int fd, uint32_t events, std::function<void(uint32_t)> handler) {
+        if constexpr (DO_INTERNAL_DEBUG || DO_HARDENING) {
+            if(std::this_thread::get_id() != _threadId.load(std::memory_order_acquire)) [[unlikely]] {
+                fmt::println("registerFd() has to be called from the queue's thread");
+                std::terminate();
+            }
+        }
+
+        auto const id = _nextRegistrationId++;
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.u64 = id;
+
+        if(epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            return tl::unexpected(v1::mapErrnoToError(errno));
+        }
+
+        _registrations.emplace(id, FdRegistration{fd, std::move(handler)});
+        _fdToRegistration.emplace(fd, id);
+
+        return {};
+    }
+
+    tl::expected<void, v1::IOError> EpollQueue::modifyFd(int fd, uint32_t events) {
+        auto it = _fdToRegistration.find(fd);
+
+        if(it == _fdToRegistration.end()) {
+            return tl::unexpected(v1::IOError::BAD_FILE_DESCRIPTOR);
+        }
+
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.u64 = it->second;
+
+        if(epoll_ctl(_epollFd, EPOLL_CTL_MOD, fd, &ev) < 0) {
+            return tl::unexpected(v1::mapErrnoToError(errno));
+        }
+
+        return {};
+    }
+
+    void EpollQueue::unregisterFd(int fd) noexcept {
+        auto it = _fdToRegistration.find(fd);
+
+        if(it == _fdToRegistration.end()) {
+            return;
+        }
+
+        // may fail if the fd has been closed already, which removed it from the epoll set as well
+        epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+
+        // the handler may be executing right now, erase it after the current batch
+        if(auto regIt = _registrations.find(it->second); regIt != _registrations.end()) {
+            regIt->second.fd = -1;
+        }
+        _unregistered.push_back(it->second);
+        _fdToRegistration.erase(it);
+    }
+
+    void EpollQueue::wakeup() noexcept {
+        uint64_t val = 1;
+        if(::write(_eventFd, &val, sizeof(val)) < 0) [[unlikely]] {
+            // EAGAIN means the counter is saturated, the loop will wake up either way
+            if(errno != EAGAIN) {
+                fmt::println("write() to eventfd failed, errno {}", errno);
+                std::terminate();
+            }
+        }
+    }
+
+    void EpollQueue::moveOtherThreadEvents() {
+        std::vector<std::unique_ptr<Event>> evts;
+        {
+            std::lock_guard const l(_otherThreadEventQueueMutex);
+            evts.swap(_otherThreadEventQueue);
+        }
+
+        for(auto &evt : evts) {
+            _eventQueue.push(std::move(evt));
+        }
+    }
+
+    void EpollQueue::shouldAddQuitEvent() {
+        bool const shouldQuit = Detail::sigintQuit.load(std::memory_order_acquire);
+
+        if(shouldQuit && !_quitEventSent) {
+            _pendingEvents.fetch_add(1, std::memory_order_acq_rel);
+            _eventQueue.push(stamp(std::make_unique<QuitEvent>(getNextEventId(), ServiceIdType{0}, INTERNAL_EVENT_PRIORITY)));
+            _quitEventSent = true;
+            _whenQuitEventWasSent = std::chrono::steady_clock::now();
+        }
+    }
+}
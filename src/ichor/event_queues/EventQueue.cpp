@@ -39,7 +39,26 @@ namespace Ichor {
     }
 
     void IEventQueue::processEvent(std::unique_ptr<Event> &evt) {
+#ifdef ICHOR_ENABLE_QUEUE_STATISTICS
+        auto const startNs = v1::Detail::queueClockNs();
+        // events pushed on another thread may carry a slightly later timestamp than our clock read
+        auto const waitedNs = startNs > evt->enqueuedNs ? startNs - evt->enqueuedNs : 0;
+        auto const band = static_cast<size_t>(v1::priorityBand(evt->priority));
+        _statistics.queueWaitNs[band].record(waitedNs);
+
+        if(_queueWaitAlarmThresholdNs != 0 && waitedNs > _queueWaitAlarmThresholdNs) [[unlikely]] {
+            _statistics.queueWaitAlarms++;
+            if(_queueWaitAlarm) {
+                _queueWaitAlarm(*evt, std::chrono::nanoseconds{waitedNs});
+            }
+        }
+
+        _dm->processEvent(evt);
+
+        _statistics.processingNs[band].record(v1::Detail::queueClockNs() - startNs);
+#else
         _dm->processEvent(evt);
+#endif
     }
 
     void IEventQueue::stopDm() {
@@ -10,6 +10,8 @@
 #include <fmt/core.h>
 #include <unistd.h>
 #include <sys/mman.h>
+#include <sys/resource.h>
+#include <algorithm>
 #include <cstdlib>
 #include <ichor/event_queues/IIOUringQueue.h>
 #include <ichor/stl/LinuxUtils.h>
@@ -982,7 +984,7 @@ namespace Ichor {
         bool const shouldQuit = Detail::sigintQuit.load(std::memory_order_acquire);
 
         if(shouldQuit && !_quitEventSent.load(std::memory_order_acquire)) {
-            pushEventInternal(INTERNAL_EVENT_PRIORITY, std::make_unique<QuitEvent>(getNextEventId(), ServiceIdType{0}, INTERNAL_EVENT_PRIORITY));
+            pushEventInternal(INTERNAL_EVENT_PRIORITY, stamp(std::make_unique<QuitEvent>(getNextEventId(), ServiceIdType{0}, INTERNAL_EVENT_PRIORITY)));
             _quitEventSent.store(true, std::memory_order_release);
             _whenQuitEventWasSent = std::chrono::steady_clock::now();
         }
@@ -1045,6 +1047,32 @@ namespace Ichor {
 
         return IOUringBuf(_eventQueuePtr, bufRing, entriesBuf, entries, entryBufferSize, id);
     }
+
+    tl::expected<unsigned int, v1::IOError> IOUringQueue::enableFixedFileTable() noexcept {
+        if(_fixedFileTableSize != 0) {
+            return _fixedFileTableSize;
+        }
+
+        // IORING_FILE_INDEX_ALLOC
+        if(_kernelVersion < v1::Version{5, 19, 0}) {
+            return tl::unexpected(v1::IOError::KERNEL_TOO_OLD);
+        }
+
+        // the kernel refuses tables larger than the file descriptor limit
+        rlimit limit{};
+        if(getrlimit(RLIMIT_NOFILE, &limit) != 0) {
+            return tl::unexpected(v1::mapErrnoToError(errno));
+        }
+        auto size = static_cast<unsigned int>(std::min<rlim_t>(limit.rlim_cur, 4096));
+
+        auto ret = io_uring_register_files_sparse(_eventQueuePtr, size);
+        if(ret < 0) {
+            return tl::unexpected(v1::mapErrnoToError(-ret));
+        }
+
+        _fixedFileTableSize = size;
+        return _fixedFileTableSize;
+    }
 }
 
 #ifdef ICHOR_ENABLE_INTERNAL_URING_DEBUGGING
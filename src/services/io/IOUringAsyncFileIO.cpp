@@ -1,14 +1,395 @@
 #include <ichor/event_queues/IIOUringQueue.h>
 #include <ichor/services/io/IOUringAsyncFileIO.h>
+#include <ichor/DependencyManager.h>
 #include <ichor/ichor_liburing.h>
+#include <ichor/ScopeGuard.h>
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <climits>
+#include <cstring>
+#include <new>
 #include <ichor/ScopedServiceProxy.h>
 
+namespace {
+    // O_DIRECT requires offsets, lengths and memory to be aligned to the logical block size, 4 KiB covers all common devices
+    constexpr uint32_t DIRECT_IO_ALIGNMENT = 4096;
+
+    constexpr uint64_t alignUp(uint64_t value, uint64_t alignment) noexcept {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    constexpr uint64_t alignDown(uint64_t value, uint64_t alignment) noexcept {
+        return value & ~(alignment - 1);
+    }
+}
+
+struct Ichor::v1::IOUringAsyncFileIO::AsyncFileContext final {
+    IIOUringQueue *q{}; // nullptr once the service stopped
+    IIOUringQueue *queue{}; // stays set, the ring outlives the services using it. Only used to free fixed file slots after the service stopped.
+    IOUringAsyncFileIO *self{}; // nullptr once the service stopped
+    ServiceIdType serviceId{};
+    bool fixedFiles{};
+};
+
+struct Ichor::v1::IOUringAsyncFileIO::FileTransfer final {
+    enum class Kind : uint_fast8_t {
+        READ_TO_DESTINATION, // read straight into destination
+        READ_TO_BUFFERS, // read into pooled buffers, then copied into destination (O_DIRECT) or yielded by readFileStream if there is none
+        COPY_SPLICE, // splice from the file into a pipe and from the pipe into the other file, the data never enters user space
+        COPY_BUFFERED, // read into pooled buffers and write those out again, for kernels without splice support
+    };
+
+    // Every slot has at most one submission in flight and transfers one chunk at a time
+    struct Slot final {
+        uint64_t chunkStart{};
+        uint64_t offset{}; // next byte of the file to read, or to write when writing
+        uint64_t end{}; // end of the chunk
+        uint32_t pending{}; // bytes in the buffer or pipe that still have to be written
+        bool writing{};
+        bool ready{}; // readFileStream: the chunk is complete and can be yielded
+        uint64_t userData{}; // of the submission in flight, 0 if there is none
+        FileBuffer buffer{};
+        int pipe[2]{-1, -1};
+    };
+
+    FileTransfer(std::shared_ptr<AsyncFileContext> _ctx, Kind _kind, int _fromFd, uint32_t _chunkSize) noexcept : ctx(std::move(_ctx)), kind(_kind), fromFd(_fromFd), chunkSize(_chunkSize) {}
+    FileTransfer(FileTransfer const &) = delete;
+    FileTransfer(FileTransfer &&) = delete;
+    FileTransfer& operator=(FileTransfer const &) = delete;
+    FileTransfer& operator=(FileTransfer &&) = delete;
+
+    ~FileTransfer() {
+        // the owning coroutine can outlive the service, the pool and the ring are gone by then
+        auto *self = ctx->self;
+        for(auto &slot : slots) {
+            if(self != nullptr) {
+                self->releaseBuffer(slot.buffer);
+            } else if(slot.buffer.poolIndex < 0 && slot.buffer.data != nullptr) {
+                ::operator delete(slot.buffer.data, std::align_val_t{DIRECT_IO_ALIGNMENT});
+            }
+            if(slot.pipe[0] >= 0) {
+                ::close(slot.pipe[0]);
+                ::close(slot.pipe[1]);
+            }
+        }
+
+        if(self == nullptr) {
+            ::close(fromFd);
+            if(toFd >= 0) {
+                ::close(toFd);
+            }
+            return;
+        }
+
+        self->closeFile(fromFd);
+        if(toFd >= 0) {
+            self->closeFile(toFd);
+        }
+        std::erase(self->_transfers, this);
+    }
+
+    [[nodiscard]] bool isStream() const noexcept {
+        return kind == Kind::READ_TO_BUFFERS && destination == nullptr;
+    }
+
+    std::shared_ptr<AsyncFileContext> ctx;
+    Kind kind;
+    int fromFd;
+    int toFd{-1};
+    uint32_t chunkSize;
+    uint32_t inFlight{};
+    int res{};
+    bool direct{};
+    bool abandoned{}; // the owning coroutine is gone, delete when the last submission completes
+    uint64_t fileSize{};
+    uint64_t nextChunk{}; // start of the first chunk not yet assigned to a slot
+    char *destination{};
+    std::string contents{}; // destination of readWholeFile, owned here because the kernel writes into it until the last completion
+    AsyncManualResetEvent *evt{}; // lives in the owning coroutine
+    std::vector<Slot> slots;
+};
+
+void Ichor::v1::IOUringAsyncFileIO::FileTransferDeleter::operator()(FileTransfer *transfer) const noexcept {
+    transfer->evt = nullptr;
+    if(transfer->inFlight == 0) {
+        delete transfer;
+    } else {
+        // the kernel still writes into the buffers or destination, the last completion deletes it
+        transfer->abandoned = true;
+    }
+}
+
+class Ichor::v1::IOUringAsyncFileIO::AsyncFile final : public IAsyncFile {
+public:
+    AsyncFile(std::shared_ptr<AsyncFileContext> ctx, int fd, int slot) noexcept : _ctx(std::move(ctx)), _fd(fd), _slot(slot) {}
+    AsyncFile(AsyncFile const &) = delete;
+    AsyncFile(AsyncFile &&) = delete;
+    AsyncFile& operator=(AsyncFile const &) = delete;
+    AsyncFile& operator=(AsyncFile &&) = delete;
+
+    ~AsyncFile() final {
+        if(_fd < 0) {
+            return;
+        }
+
+        if(_ctx->q == nullptr) {
+            // nothing gets submitted on behalf of a stopped service anymore, free the slot synchronously
+            if(_slot >= 0) {
+                int removed = -1;
+                io_uring_register_files_update(_ctx->queue->getRing(), static_cast<unsigned>(_slot), &removed, 1);
+            }
+            ::close(_fd);
+            return;
+        }
+
+        if(_slot >= 0) {
+            auto *sqe = _ctx->q->getSqeWithData(_ctx->serviceId, [](io_uring_cqe *cqe) {
+                INTERNAL_IO_DEBUG("close_direct res: {} {}", cqe->res, cqe->res < 0 ? strerror(-cqe->res) : "");
+            });
+            io_uring_prep_close_direct(sqe, static_cast<unsigned>(_slot));
+        }
+        auto *sqe = _ctx->q->getSqeWithData(_ctx->serviceId, [](io_uring_cqe *cqe) {
+            INTERNAL_IO_DEBUG("close res: {} {}", cqe->res, cqe->res < 0 ? strerror(-cqe->res) : "");
+        });
+        io_uring_prep_close(sqe, _fd);
+    }
+
+    Task<tl::expected<uint64_t, IOError>> read(std::span<char> buffer, uint64_t offset) final {
+        uint64_t done{};
+        while(done < buffer.size()) {
+            auto res = co_await submit([&](io_uring_sqe *sqe) {
+                io_uring_prep_read(sqe, target(sqe), buffer.data() + done, static_cast<unsigned>(std::min<uint64_t>(buffer.size() - done, MAX_RW_COUNT)), offset + done);
+            });
+            if(!res) {
+                co_return tl::unexpected(res.error());
+            }
+            if(*res == 0) {
+                break;
+            }
+            done += static_cast<uint64_t>(*res);
+        }
+        co_return done;
+    }
+
+    Task<tl::expected<void, IOError>> write(std::span<char const> buffer, uint64_t offset) final {
+        uint64_t done{};
+        while(done < buffer.size()) {
+            auto res = co_await submit([&](io_uring_sqe *sqe) {
+                io_uring_prep_write(sqe, target(sqe), buffer.data() + done, static_cast<unsigned>(std::min<uint64_t>(buffer.size() - done, MAX_RW_COUNT)), offset + done);
+            });
+            if(!res) {
+                co_return tl::unexpected(res.error());
+            }
+            if(*res == 0) {
+                co_return tl::unexpected(IOError::IO_ERROR);
+            }
+            done += static_cast<uint64_t>(*res);
+        }
+        co_return {};
+    }
+
+    Task<tl::expected<uint64_t, IOError>> readv(std::span<std::span<char> const> buffers, uint64_t offset) final {
+        auto iovecs = toIovecs(buffers);
+        size_t first{};
+        uint64_t done{};
+        while(first < iovecs.size()) {
+            auto res = co_await submit([&](io_uring_sqe *sqe) {
+                io_uring_prep_readv(sqe, target(sqe), iovecs.data() + first, static_cast<unsigned>(std::min<size_t>(iovecs.size() - first, IOV_MAX)), offset + done);
+            });
+            if(!res) {
+                co_return tl::unexpected(res.error());
+            }
+            if(*res == 0) {
+                break;
+            }
+            done += static_cast<uint64_t>(*res);
+            advanceIovecs(iovecs, first, static_cast<uint64_t>(*res));
+        }
+        co_return done;
+    }
+
+    Task<tl::expected<void, IOError>> writev(std::span<std::span<char const> const> buffers, uint64_t offset) final {
+        auto iovecs = toIovecs(buffers);
+        size_t first{};
+        uint64_t done{};
+        while(first < iovecs.size()) {
+            auto res = co_await submit([&](io_uring_sqe *sqe) {
+                io_uring_prep_writev(sqe, target(sqe), iovecs.data() + first, static_cast<unsigned>(std::min<size_t>(iovecs.size() - first, IOV_MAX)), offset + done);
+            });
+            if(!res) {
+                co_return tl::unexpected(res.error());
+            }
+            if(*res == 0) {
+                co_return tl::unexpected(IOError::IO_ERROR);
+            }
+            done += static_cast<uint64_t>(*res);
+            advanceIovecs(iovecs, first, static_cast<uint64_t>(*res));
+        }
+        co_return {};
+    }
+
+    Task<tl::expected<void, IOError>> sync() final {
+        auto res = co_await submit([&](io_uring_sqe *sqe) {
+            io_uring_prep_fsync(sqe, target(sqe), 0);
+        });
+        if(!res) {
+            co_return tl::unexpected(res.error());
+        }
+        co_return {};
+    }
+
+    Task<tl::expected<void, IOError>> dataSync() final {
+        auto res = co_await submit([&](io_uring_sqe *sqe) {
+            io_uring_prep_fsync(sqe, target(sqe), IORING_FSYNC_DATASYNC);
+        });
+        if(!res) {
+            co_return tl::unexpected(res.error());
+        }
+        co_return {};
+    }
+
+    Task<tl::expected<void, IOError>> allocate(uint64_t offset, uint64_t length) final {
+        auto res = co_await submit([&](io_uring_sqe *sqe) {
+            io_uring_prep_fallocate(sqe, target(sqe), 0, offset, length);
+        });
+        if(!res) {
+            co_return tl::unexpected(res.error());
+        }
+        co_return {};
+    }
+
+    Task<tl::expected<uint64_t, IOError>> size() final {
+        struct statx x{};
+        // statx only takes regular file descriptors
+        auto res = co_await submit([&](io_uring_sqe *sqe) {
+            io_uring_prep_statx(sqe, _fd, "", AT_EMPTY_PATH, STATX_SIZE, &x);
+        });
+        if(!res) {
+            co_return tl::unexpected(res.error());
+        }
+        co_return x.stx_size;
+    }
+
+    Task<tl::expected<void, IOError>> close() final {
+        if(_slot >= 0) {
+            auto res = co_await submit([&](io_uring_sqe *sqe) {
+                io_uring_prep_close_direct(sqe, static_cast<unsigned>(_slot));
+            });
+            _slot = -1;
+            if(!res) {
+                co_return tl::unexpected(res.error());
+            }
+        }
+
+        auto res = co_await submit([&](io_uring_sqe *sqe) {
+            io_uring_prep_close(sqe, _fd);
+        });
+        _fd = -1;
+        if(!res) {
+            co_return tl::unexpected(res.error());
+        }
+        co_return {};
+    }
+
+private:
+    // the kernel caps single reads and writes at this size
+    static constexpr uint64_t MAX_RW_COUNT = 0x7FFF'F000;
+
+    template <typename Span>
+    static std::vector<iovec> toIovecs(std::span<Span const> buffers) {
+        std::vector<iovec> iovecs;
+        iovecs.reserve(buffers.size());
+        for(auto const &buffer : buffers) {
+            if(!buffer.empty()) {
+                iovecs.emplace_back(iovec{const_cast<char*>(buffer.data()), buffer.size()});
+            }
+        }
+        return iovecs;
+    }
+
+    // skips the bytes already transferred, so a short transfer can be resumed
+    static void advanceIovecs(std::vector<iovec> &iovecs, size_t &first, uint64_t transferred) noexcept {
+        while(transferred > 0 && first < iovecs.size()) {
+            auto &vec = iovecs[first];
+            if(transferred >= vec.iov_len) {
+                transferred -= vec.iov_len;
+                first++;
+            } else {
+                vec.iov_base = static_cast<char*>(vec.iov_base) + transferred;
+                vec.iov_len -= transferred;
+                transferred = 0;
+            }
+        }
+    }
+
+    // file to pass to the prep function, marks the sqe if that is a fixed file slot
+    int target(io_uring_sqe *sqe) const noexcept {
+        if(_slot >= 0) {
+            sqe->flags |= IOSQE_FIXED_FILE;
+            return _slot;
+        }
+        return _fd;
+    }
+
+    /// \param prep called synchronously with the sqe to fill in
+    /// \return result of the operation, negative results mapped to errors
+    template <typename Prep>
+    Task<tl::expected<int, IOError>> submit(Prep prep) {
+        if(_fd < 0) {
+            co_return tl::unexpected(IOError::BAD_FILE_DESCRIPTOR);
+        }
+        if(_ctx->q == nullptr) {
+            co_return tl::unexpected(IOError::SERVICE_STOPPED);
+        }
+
+        AsyncManualResetEvent evt;
+        int res{};
+        auto *sqe = _ctx->q->getSqeWithData(_ctx->serviceId, [&evt, &res](io_uring_cqe *cqe) {
+            INTERNAL_IO_DEBUG("file op res: {} {}", cqe->res, cqe->res < 0 ? strerror(-cqe->res) : "");
+            res = cqe->res;
+            evt.set();
+        });
+        prep(sqe);
+        co_await evt;
+
+        if(res < 0) {
+            co_return tl::unexpected(mapErrnoToError(-res));
+        }
+        co_return res;
+    }
+
+    std::shared_ptr<AsyncFileContext> _ctx;
+    int _fd;
+    int _slot; // index in the fixed file table of the ring, -1 if not registered
+};
 
 Ichor::v1::IOUringAsyncFileIO::IOUringAsyncFileIO(DependencyRegister &reg, Properties props) : AdvancedService(std::move(props)) {
     reg.registerDependency<IIOUringQueue>(this, DependencyFlags::REQUIRED);
     reg.registerDependency<ILogger>(this, DependencyFlags::REQUIRED);
+
+    if(auto propIt = getProperties().find("BufferSize"); propIt != getProperties().end()) {
+        _bufferSize = Ichor::v1::any_cast<uint32_t>(propIt->second);
+    }
+    if(auto propIt = getProperties().find("BufferBatchSize"); propIt != getProperties().end()) {
+        _bufferBatchSize = std::max(Ichor::v1::any_cast<uint32_t>(propIt->second), 1u);
+    }
+    if(auto propIt = getProperties().find("StreamReadAhead"); propIt != getProperties().end()) {
+        _streamReadAhead = std::max(Ichor::v1::any_cast<uint32_t>(propIt->second), 1u);
+    }
+    if(auto propIt = getProperties().find("RegisterBuffers"); propIt != getProperties().end()) {
+        _registerBuffers = Ichor::v1::any_cast<bool>(propIt->second);
+    }
+    if(auto propIt = getProperties().find("DirectIO"); propIt != getProperties().end()) {
+        _directIO = Ichor::v1::any_cast<bool>(propIt->second);
+    }
+    if(auto propIt = getProperties().find("FixedFiles"); propIt != getProperties().end()) {
+        _fixedFiles = Ichor::v1::any_cast<bool>(propIt->second);
+    }
+
+    // pool buffers are aligned for O_DIRECT regardless, aligning the size keeps every buffer in the pool aligned as well
+    _bufferSize = static_cast<uint32_t>(alignUp(std::max(_bufferSize, 1u), DIRECT_IO_ALIGNMENT));
 }
 
 
@@ -17,11 +398,75 @@ Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::IOUringAsyncFileIO
         fmt::println("Kernel version too old to use IOUringAsyncFileIO. Requires >= 5.5.0");
         co_return tl::unexpected(StartError::FAILED);
     }
+
+    _bufferMemory = static_cast<char*>(::operator new(uint64_t{_bufferSize} * _bufferBatchSize, std::align_val_t{DIRECT_IO_ALIGNMENT}));
+    _freeBuffers.reserve(_bufferBatchSize);
+    for(int i = static_cast<int>(_bufferBatchSize) - 1; i >= 0; i--) {
+        _freeBuffers.push_back(i);
+    }
+
+    if(_registerBuffers) {
+        std::vector<iovec> iovecs(_bufferBatchSize);
+        for(uint32_t i = 0; i < _bufferBatchSize; i++) {
+            iovecs[i].iov_base = _bufferMemory + uint64_t{i} * _bufferSize;
+            iovecs[i].iov_len = _bufferSize;
+        }
+        // only one set of buffers can be registered per ring, other users of the ring may have been first
+        auto ret = io_uring_register_buffers(_q->getRing(), iovecs.data(), _bufferBatchSize);
+        if(ret < 0) {
+            ICHOR_LOG_DEBUG(_logger, "Couldn't register buffers, using unregistered buffers: {}", mapErrnoToError(-ret));
+        } else {
+            _buffersRegistered = true;
+        }
+    }
+
+    _fileContext = std::make_shared<AsyncFileContext>(AsyncFileContext{*_q, *_q, this, getServiceId(), false});
+    if(_fixedFiles) {
+        auto ret = _q->enableFixedFileTable();
+        if(!ret) {
+            ICHOR_LOG_DEBUG(_logger, "Couldn't enable fixed file table, using regular file descriptors: {}", ret.error());
+        } else {
+            _fileContext->fixedFiles = true;
+        }
+    }
+
     co_return {};
 }
 
 Ichor::Task<void> Ichor::v1::IOUringAsyncFileIO::stop() {
     _shouldStop = true; // TODO stop() currently doesn't get called if there are any open coroutines. Perhaps change the Ichor architecture for that? Hmm.
+
+    // open files outlive the service, their operations fail from here on
+    _fileContext->q = nullptr;
+
+    // the kernel may still be reading into the pooled buffers, cancel what can be cancelled and wait for every completion before freeing them
+    if(_transfersInFlight > 0) {
+        for(auto *transfer : _transfers) {
+            for(auto const &slot : transfer->slots) {
+                if(slot.userData == 0) {
+                    continue;
+                }
+                auto *sqe = _q->getSqeWithData(this, [](io_uring_cqe *cqe) {
+                    INTERNAL_IO_DEBUG("cancel transfer res: {} {}", cqe->res, cqe->res < 0 ? strerror(-cqe->res) : "");
+                });
+                io_uring_prep_cancel64(sqe, slot.userData, 0);
+            }
+        }
+        co_await _transfersDone;
+        _transfersDone.reset();
+    }
+
+    _fileContext->self = nullptr;
+    _fileContext.reset();
+
+    if(_buffersRegistered) {
+        io_uring_unregister_buffers(_q->getRing());
+        _buffersRegistered = false;
+    }
+    _freeBuffers.clear();
+    ::operator delete(_bufferMemory, std::align_val_t{DIRECT_IO_ALIGNMENT});
+    _bufferMemory = nullptr;
+
     co_return;
 }
 
@@ -48,70 +493,58 @@ Ichor::Task<tl::expected<std::string, Ichor::v1::IOError>> Ichor::v1::IOUringAsy
         co_return tl::unexpected(IOError::SERVICE_STOPPED);
     }
 
-    AsyncManualResetEvent evt;
-
-    int res{};
-    auto *sqe = _q->getSqeWithData(this, [&evt, &res](io_uring_cqe *cqe) {
-        INTERNAL_IO_DEBUG("openat res: {} {}", cqe->res, cqe->res < 0 ? strerror(-cqe->res) : "");
-        res = cqe->res;
-        evt.set();
-    });
-    if(file_path.is_absolute()) {
-        io_uring_prep_openat(sqe, 0, file_path.c_str(), O_RDONLY | O_CLOEXEC, 0);
-    } else {
-        io_uring_prep_openat(sqe, AT_FDCWD, file_path.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    bool direct = _directIO;
+    int fd = co_await openFile(file_path, O_RDONLY | O_CLOEXEC | (direct ? O_DIRECT : 0), 0);
+    if(fd == -EINVAL && direct) {
+        // file system doesn't support O_DIRECT
+        direct = false;
+        fd = co_await openFile(file_path, O_RDONLY | O_CLOEXEC, 0);
     }
-    co_await evt;
     INTERNAL_IO_DEBUG("readWholeFile({}) 1", file_path);
 
-    if(_shouldStop) {
-        co_return tl::unexpected(IOError::SERVICE_STOPPED);
+    if(fd < 0) {
+        co_return tl::unexpected(mapErrnoToError(-fd));
     }
 
-    if(res < 0) {
-        co_return tl::unexpected(mapErrnoToError(-res));
+    FileTransferPtr transfer{new FileTransfer(_fileContext, direct ? FileTransfer::Kind::READ_TO_BUFFERS : FileTransfer::Kind::READ_TO_DESTINATION, fd, _bufferSize)};
+    transfer->direct = direct;
+
+    if(_shouldStop) {
+        co_return tl::unexpected(IOError::SERVICE_STOPPED);
     }
 
-    int fd = res;
-    struct statx x{};
-    res = 0;
-    evt.reset();
-    sqe = _q->getSqeWithData(this, [&evt, &res](io_uring_cqe *cqe) {
-        INTERNAL_IO_DEBUG("statx res: {} {}", cqe->res, cqe->res < 0 ? strerror(-cqe->res) : "");
-        res = cqe->res;
-        evt.set();
-    });
-    io_uring_prep_statx(sqe, fd, "", AT_EMPTY_PATH, STATX_SIZE, &x);
-    co_await evt;
-    INTERNAL_IO_DEBUG("readWholeFile({}) statx res: {} {}", file_path, res, x.stx_size);
+    auto size = co_await fileSize(fd);
+    INTERNAL_IO_DEBUG("readWholeFile({}) statx {}", file_path, size ? *size : 0);
 
     if(_shouldStop) {
         co_return tl::unexpected(IOError::SERVICE_STOPPED);
     }
 
-    if(res < 0) {
-        co_return tl::unexpected(mapErrnoToError(-res));
+    if(!size) {
+        co_return tl::unexpected(size.error());
     }
 
-    std::string contents;
+    auto &contents = transfer->contents;
 
-    if(x.stx_size == 0) {
+    if(*size == 0) {
         INTERNAL_IO_DEBUG("readWholeFile({}) 3", file_path);
-        co_return contents;
+        co_return std::string{};
     }
 
-    if(x.stx_size > contents.max_size()) {
-        ICHOR_LOG_ERROR(_logger, "Attempt to read file with size {} that is larger than string max size {}", x.stx_size, contents.max_size());
+    if(*size > contents.max_size()) {
+        ICHOR_LOG_ERROR(_logger, "Attempt to read file with size {} that is larger than string max size {}", *size, contents.max_size());
         co_return tl::unexpected(IOError::FILE_SIZE_TOO_BIG);
     }
 
-    uint32_t maxSubmissions = std::min(_bufferBatchSize, _q->getMaxEntriesCount());
-    uint64_t size_left = x.stx_size;
-    evt.reset();
-    contents.reserve(static_cast<size_t>(x.stx_size));
+    // the reads complete in any order, each one writes its own part of the preallocated string
+    contents.resize_and_overwrite(static_cast<size_t>(*size), [](char *, size_t n) noexcept {
+        return n;
+    });
+    transfer->destination = contents.data();
 
-    res = 0;
-    recursiveSubmitReadWholeFile(evt, res, contents, size_left, 0, x.stx_size, fd, maxSubmissions);
+    AsyncManualResetEvent evt;
+    transfer->evt = &evt;
+    startTransfer(*transfer, *size, std::min<uint64_t>(_bufferBatchSize, _q->getMaxEntriesCount()));
     co_await evt;
     INTERNAL_IO_DEBUG("readWholeFile({}) 4", file_path);
 
@@ -119,94 +552,222 @@ Ichor::Task<tl::expected<std::string, Ichor::v1::IOError>> Ichor::v1::IOUringAsy
         co_return tl::unexpected(IOError::SERVICE_STOPPED);
     }
 
-    if(res < 0) {
-        co_return tl::unexpected(mapErrnoToError(-res));
+    if(transfer->res < 0) {
+        co_return tl::unexpected(mapErrnoToError(-transfer->res));
     }
 
-    co_return contents;
+    co_return std::move(contents);
 }
 
-Ichor::Task<tl::expected<void, Ichor::v1::IOError>> Ichor::v1::IOUringAsyncFileIO::copyFile(const std::filesystem::path &from, const std::filesystem::path &to) {
-    INTERNAL_IO_DEBUG("copyFile({}, {})", from, to);
+Ichor::AsyncGenerator<tl::expected<std::span<char const>, Ichor::v1::IOError>> Ichor::v1::IOUringAsyncFileIO::readFileStream(std::filesystem::path const &file_path) {
+    INTERNAL_IO_DEBUG("readFileStream({})", file_path);
 
     if(_shouldStop) {
-        co_return tl::unexpected(IOError::SERVICE_STOPPED);
+        co_yield tl::unexpected(IOError::SERVICE_STOPPED);
+        co_return {};
+    }
+
+    bool direct = _directIO;
+    int fd = co_await openFile(file_path, O_RDONLY | O_CLOEXEC | (direct ? O_DIRECT : 0), 0);
+    if(fd == -EINVAL && direct) {
+        direct = false;
+        fd = co_await openFile(file_path, O_RDONLY | O_CLOEXEC, 0);
+    }
+
+    if(fd < 0) {
+        co_yield tl::unexpected(mapErrnoToError(-fd));
+        co_return {};
+    }
+
+    FileTransferPtr transfer{new FileTransfer(_fileContext, FileTransfer::Kind::READ_TO_BUFFERS, fd, _bufferSize)};
+    transfer->direct = direct;
+
+    if(_shouldStop) {
+        co_yield tl::unexpected(IOError::SERVICE_STOPPED);
+        co_return {};
+    }
+
+    auto size = co_await fileSize(fd);
+    INTERNAL_IO_DEBUG("readFileStream({}) statx {}", file_path, size ? *size : 0);
+
+    if(_shouldStop) {
+        co_yield tl::unexpected(IOError::SERVICE_STOPPED);
+        co_return {};
+    }
+
+    if(!size) {
+        co_yield tl::unexpected(size.error());
+        co_return {};
     }
 
-    if(_q->sqeSpaceLeft() < 2) {
-        _q->forceSubmit();
+    if(*size == 0) {
+        co_return {};
     }
 
     AsyncManualResetEvent evt;
+    transfer->evt = &evt;
+    startTransfer(*transfer, *size, std::min<uint64_t>(_streamReadAhead, _q->getMaxEntriesCount()));
 
-    int fromFd{-1};
-    int toFd{};
-    auto *sqe = _q->getSqeWithData(this, [&fromFd](io_uring_cqe *cqe) {
-        INTERNAL_IO_DEBUG("openat res: {} {}", cqe->res, cqe->res < 0 ? strerror(-cqe->res) : "");
-        fromFd = cqe->res;
-    });
-    sqe->flags |= IOSQE_IO_HARDLINK;
-    if(from.is_absolute()) {
-        io_uring_prep_openat(sqe, 0, from.c_str(), O_RDONLY | O_CLOEXEC, 0);
-    } else {
-        io_uring_prep_openat(sqe, AT_FDCWD, from.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    // chunks are yielded in order, slot i % slots.size() holds chunk i
+    for(uint64_t chunk = 0; chunk * transfer->chunkSize < *size; chunk++) {
+        auto const slotIndex = static_cast<uint32_t>(chunk % transfer->slots.size());
+        auto &slot = transfer->slots[slotIndex];
+
+        while(!slot.ready && transfer->res == 0 && !_shouldStop) {
+            evt.reset();
+            co_await evt;
+        }
+
+        if(_shouldStop) {
+            co_yield tl::unexpected(IOError::SERVICE_STOPPED);
+            co_return {};
+        }
+
+        if(transfer->res < 0) {
+            co_yield tl::unexpected(mapErrnoToError(-transfer->res));
+            co_return {};
+        }
+
+        co_yield std::span<char const>{slot.buffer.data, static_cast<size_t>(slot.end - slot.chunkStart)};
+
+        // the consumer is done with the chunk, reuse the buffer for the next one
+        if(assignNextChunk(*transfer, slotIndex)) {
+            submitTransfer(*transfer, slotIndex);
+        }
     }
-    sqe = _q->getSqeWithData(this, [&evt, &toFd](io_uring_cqe *cqe) {
-        INTERNAL_IO_DEBUG("openat res: {} {}", cqe->res, cqe->res < 0 ? strerror(-cqe->res) : "");
-        toFd = cqe->res;
-        evt.set();
-    });
-    if(to.is_absolute()) {
-        io_uring_prep_openat(sqe, 0, to.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH);
-    } else {
-        io_uring_prep_openat(sqe, AT_FDCWD, to.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH);
+
+    co_return {};
+}
+
+Ichor::Task<tl::expected<std::unique_ptr<Ichor::v1::IAsyncFile>, Ichor::v1::IOError>> Ichor::v1::IOUringAsyncFileIO::open(std::filesystem::path const &file_path, FileOpenFlags flags) {
+    INTERNAL_IO_DEBUG("open({})", file_path);
+
+    if(_shouldStop) {
+        co_return tl::unexpected(IOError::SERVICE_STOPPED);
+    }
+
+    bool read = (flags & FileOpenFlags::READ) == FileOpenFlags::READ;
+    bool write = (flags & FileOpenFlags::WRITE) == FileOpenFlags::WRITE;
+    if(!read && !write) {
+        co_return tl::unexpected(IOError::NOT_SUPPORTED);
+    }
+
+    int openFlags = O_CLOEXEC | (read && write ? O_RDWR : (write ? O_WRONLY : O_RDONLY));
+    if((flags & FileOpenFlags::CREATE) == FileOpenFlags::CREATE) {
+        openFlags |= O_CREAT;
+    }
+    if((flags & FileOpenFlags::TRUNCATE) == FileOpenFlags::TRUNCATE) {
+        openFlags |= O_TRUNC;
+    }
+    if((flags & FileOpenFlags::EXCLUSIVE) == FileOpenFlags::EXCLUSIVE) {
+        openFlags |= O_EXCL;
+    }
+    bool direct = (flags & FileOpenFlags::DIRECT) == FileOpenFlags::DIRECT;
+
+    int fd = co_await openFile(file_path, direct ? openFlags | O_DIRECT : openFlags, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if(fd == -EINVAL && direct) {
+        INTERNAL_IO_DEBUG("O_DIRECT not supported for {}, retrying without", file_path);
+        fd = co_await openFile(file_path, openFlags, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    }
+
+    if(fd < 0) {
+        co_return tl::unexpected(mapErrnoToError(-fd));
     }
-    co_await evt;
-    INTERNAL_IO_DEBUG("copyFile({}, {}) 1", from, to);
 
     if(_shouldStop) {
+        closeFile(fd);
         co_return tl::unexpected(IOError::SERVICE_STOPPED);
     }
 
+    int slot{-1};
+    if(_fileContext->fixedFiles) {
+        // the kernel writes the allocated slot back over the file descriptor
+        int slotFd = fd;
+        AsyncManualResetEvent evt;
+        int res{};
+        auto *sqe = _q->getSqeWithData(this, [&evt, &res](io_uring_cqe *cqe) {
+            INTERNAL_IO_DEBUG("files_update res: {} {}", cqe->res, cqe->res < 0 ? strerror(-cqe->res) : "");
+            res = cqe->res;
+            evt.set();
+        });
+        io_uring_prep_files_update(sqe, &slotFd, 1, IORING_FILE_INDEX_ALLOC);
+        co_await evt;
+
+        // a full table is not an error, the file just doesn't get the fast path
+        if(res == 1) {
+            slot = slotFd;
+        }
+
+        if(_shouldStop) {
+            if(slot >= 0) {
+                sqe = _q->getSqeWithData(this, [](io_uring_cqe *cqe) {
+                    INTERNAL_IO_DEBUG("close_direct res: {} {}", cqe->res, cqe->res < 0 ? strerror(-cqe->res) : "");
+                });
+                io_uring_prep_close_direct(sqe, static_cast<unsigned>(slot));
+            }
+            closeFile(fd);
+            co_return tl::unexpected(IOError::SERVICE_STOPPED);
+        }
+    }
+
+    co_return std::make_unique<AsyncFile>(_fileContext, fd, slot);
+}
+
+Ichor::Task<tl::expected<void, Ichor::v1::IOError>> Ichor::v1::IOUringAsyncFileIO::copyFile(const std::filesystem::path &from, const std::filesystem::path &to) {
+    INTERNAL_IO_DEBUG("copyFile({}, {})", from, to);
+
+    if(_shouldStop) {
+        co_return tl::unexpected(IOError::SERVICE_STOPPED);
+    }
+
+    int fromFd = co_await openFile(from, O_RDONLY | O_CLOEXEC, 0);
+
     if(fromFd < 0) {
         co_return tl::unexpected(mapErrnoToError(-fromFd));
     }
 
+    // splicing needs 5.7, before that every chunk passes through a buffer
+    auto kind = _q->getKernelVersion() >= Version{5, 7, 0} ? FileTransfer::Kind::COPY_SPLICE : FileTransfer::Kind::COPY_BUFFERED;
+    FileTransferPtr transfer{new FileTransfer(_fileContext, kind, fromFd, _bufferSize)};
+
+    if(_shouldStop) {
+        co_return tl::unexpected(IOError::SERVICE_STOPPED);
+    }
+
+    int toFd = co_await openFile(to, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH);
+    INTERNAL_IO_DEBUG("copyFile({}, {}) 1", from, to);
+
     if(toFd < 0) {
         co_return tl::unexpected(mapErrnoToError(-toFd));
     }
 
-    struct statx x{};
-    int res = 0;
-    evt.reset();
-    sqe = _q->getSqeWithData(this, [&evt, &res](io_uring_cqe *cqe) {
-        INTERNAL_IO_DEBUG("statx res: {} {}", cqe->res, cqe->res < 0 ? strerror(-cqe->res) : "");
-        res = cqe->res;
-        evt.set();
-    });
-    io_uring_prep_statx(sqe, fromFd, "", AT_EMPTY_PATH, STATX_SIZE, &x);
-    co_await evt;
-    INTERNAL_IO_DEBUG("copyFile({}, {}) statx res: {} {}", from, to, res, x.stx_size);
+    transfer->toFd = toFd;
 
     if(_shouldStop) {
         co_return tl::unexpected(IOError::SERVICE_STOPPED);
     }
 
-    if(res < 0) {
-        co_return tl::unexpected(mapErrnoToError(-res));
+    auto size = co_await fileSize(fromFd);
+    INTERNAL_IO_DEBUG("copyFile({}, {}) statx {}", from, to, size ? *size : 0);
+
+    if(_shouldStop) {
+        co_return tl::unexpected(IOError::SERVICE_STOPPED);
     }
 
-    if(x.stx_size == 0) {
+    if(!size) {
+        co_return tl::unexpected(size.error());
+    }
+
+    if(*size == 0) {
         INTERNAL_IO_DEBUG("copyFile({}, {}) 3", from, to);
         co_return {};
     }
 
-    uint32_t maxSubmissions = std::min(_bufferBatchSize, _q->getMaxEntriesCount());
-    uint64_t size_left = x.stx_size;
-    evt.reset();
-
-    res = 0;
-    recursiveSubmitCopyFile(evt, res, size_left, 0, x.stx_size, fromFd, toFd, maxSubmissions);
+    AsyncManualResetEvent evt;
+    transfer->evt = &evt;
+    if(auto ret = startTransfer(*transfer, *size, std::min<uint64_t>(_bufferBatchSize, _q->getMaxEntriesCount())); ret < 0) {
+        co_return tl::unexpected(mapErrnoToError(-ret));
+    }
     co_await evt;
     INTERNAL_IO_DEBUG("copyFile({}, {}) 4", from, to);
 
@@ -214,8 +775,8 @@ Ichor::Task<tl::expected<void, Ichor::v1::IOError>> Ichor::v1::IOUringAsyncFileI
         co_return tl::unexpected(IOError::SERVICE_STOPPED);
     }
 
-    if(res < 0) {
-        co_return tl::unexpected(mapErrnoToError(-res));
+    if(transfer->res < 0) {
+        co_return tl::unexpected(mapErrnoToError(-transfer->res));
     }
 
     co_return {};
@@ -301,6 +862,11 @@ Ichor::Task<tl::expected<void, Ichor::v1::IOError>> Ichor::v1::IOUringAsyncFileI
     io_uring_prep_write(sqe, fd, contents.data(), static_cast<unsigned>(contents.size()), std::numeric_limits<__u64>::max());
 
     co_await evt;
+    closeFile(fd);
+
+    if(res < 0) {
+        co_return tl::unexpected(mapErrnoToError(-res));
+    }
 
     co_return {};
 }
@@ -352,176 +918,289 @@ Ichor::Task<tl::expected<void, Ichor::v1::IOError>> Ichor::v1::IOUringAsyncFileI
     io_uring_prep_write(sqe, fd, contents.data(), static_cast<unsigned>(contents.size()), std::numeric_limits<__u64>::max());
 
     co_await evt;
+    closeFile(fd);
+
+    if(res < 0) {
+        co_return tl::unexpected(mapErrnoToError(-res));
+    }
 
     co_return {};
 }
 
-void Ichor::v1::IOUringAsyncFileIO::recursiveSubmitReadWholeFile(AsyncManualResetEvent &evt, int &res, std::string &contents, uint64_t &sizeLeft, uint64_t offset, uint64_t fileSize, int fd, uint32_t maxSubmissions) {
-    uint32_t submissions = maxSubmissions;
-    while(sizeLeft > 0 && submissions > 0) {
-        char* buf = new char[_bufferSize];
-        bool isLastInBatch = sizeLeft < _bufferSize || submissions == 1;
+Ichor::Task<int> Ichor::v1::IOUringAsyncFileIO::openFile(std::filesystem::path const &file, int flags, unsigned int mode) {
+    AsyncManualResetEvent evt;
+
+    int res{};
+    auto *sqe = _q->getSqeWithData(this, [&evt, &res](io_uring_cqe *cqe) {
+        INTERNAL_IO_DEBUG("openat res: {} {}", cqe->res, cqe->res < 0 ? strerror(-cqe->res) : "");
+        res = cqe->res;
+        evt.set();
+    });
+    if(file.is_absolute()) {
+        io_uring_prep_openat(sqe, 0, file.c_str(), flags, mode);
+    } else {
+        io_uring_prep_openat(sqe, AT_FDCWD, file.c_str(), flags, mode);
+    }
+    co_await evt;
+
+    co_return res;
+}
+
+Ichor::Task<tl::expected<uint64_t, Ichor::v1::IOError>> Ichor::v1::IOUringAsyncFileIO::fileSize(int fd) {
+    AsyncManualResetEvent evt;
 
-        auto *sqe = _q->getSqeWithData(this, createNewEventHandlerReadWholeFile(evt, res, contents, sizeLeft, fileSize, fd, maxSubmissions, offset, buf, isLastInBatch));
-        io_uring_prep_read(sqe, fd, buf, _bufferSize, offset);
-        INTERNAL_IO_DEBUG("add read");
+    struct statx x{};
+    int res{};
+    auto *sqe = _q->getSqeWithData(this, [&evt, &res](io_uring_cqe *cqe) {
+        INTERNAL_IO_DEBUG("statx res: {} {}", cqe->res, cqe->res < 0 ? strerror(-cqe->res) : "");
+        res = cqe->res;
+        evt.set();
+    });
+    io_uring_prep_statx(sqe, fd, "", AT_EMPTY_PATH, STATX_SIZE, &x);
+    co_await evt;
 
-        offset += _bufferSize;
-        if(sizeLeft > _bufferSize) {
-            sizeLeft -= _bufferSize;
-        } else {
-            sizeLeft = 0;
-        }
+    if(res < 0) {
+        co_return tl::unexpected(mapErrnoToError(-res));
+    }
+
+    co_return x.stx_size;
+}
 
-        submissions--;
+void Ichor::v1::IOUringAsyncFileIO::closeFile(int fd) {
+    if(_q == nullptr || _q->getKernelVersion() < Version{5, 6, 0}) {
+        ::close(fd);
+        return;
     }
+
+    auto *sqe = _q->getSqeWithData(this, [](io_uring_cqe *cqe) {
+        INTERNAL_IO_DEBUG("close res: {} {}", cqe->res, cqe->res < 0 ? strerror(-cqe->res) : "");
+    });
+    io_uring_prep_close(sqe, fd);
 }
 
-std::function<void(io_uring_cqe*)> Ichor::v1::IOUringAsyncFileIO::createNewEventHandlerReadWholeFile(AsyncManualResetEvent &evt, int &res, std::string &contents, uint64_t &sizeLeft, uint64_t fileSize, int fd, uint32_t maxSubmissions, uint64_t offset, char *buf, bool isLastInBatch) {
-    return [this, &evt, &res, &contents, &sizeLeft, fileSize, fd, buf, offset, isLastInBatch, maxSubmissions](io_uring_cqe *cqe) {
-        std::unique_ptr<char[]> uniqueBuf{buf};
-        INTERNAL_IO_DEBUG("read response {} {} {} {} {} {}", cqe->res, cqe->res < 0 ? strerror(-cqe->res) : "", _shouldStop, evt.is_set(), contents.size(), fileSize);
-        if(_shouldStop || res < 0) {
-            if(isLastInBatch && !evt.is_set()) {
-                evt.set();
-            }
-            return;
-        }
+Ichor::v1::IOUringAsyncFileIO::FileBuffer Ichor::v1::IOUringAsyncFileIO::acquireBuffer() {
+    if(!_freeBuffers.empty()) {
+        auto index = _freeBuffers.back();
+        _freeBuffers.pop_back();
+        return FileBuffer{_bufferMemory + uint64_t{static_cast<uint32_t>(index)} * _bufferSize, index};
+    }
 
-        if(cqe->res < 0) {
-            ICHOR_LOG_ERROR(_logger, "read failed with result {} res {}", cqe->res, res);
-            res = cqe->res;
-            if(isLastInBatch) {
-                evt.set();
-            }
-            return;
-        }
+    // more transfers running than the pool is sized for
+    return FileBuffer{static_cast<char*>(::operator new(_bufferSize, std::align_val_t{DIRECT_IO_ALIGNMENT})), -1};
+}
 
-        auto readBytes = static_cast<uint32_t>(cqe->res);
+void Ichor::v1::IOUringAsyncFileIO::releaseBuffer(FileBuffer &buf) noexcept {
+    if(buf.data == nullptr) {
+        return;
+    }
 
-        if(contents.size() >= fileSize) {
-            ICHOR_LOG_ERROR(_logger, "read contents already filled? with result {} res {} contents size {} statx size {}", cqe->res, res, contents.size(), fileSize);
-            res = -2;
-            if(isLastInBatch) {
-                evt.set();
-            }
-            return;
+    if(buf.poolIndex >= 0) {
+        if(_bufferMemory != nullptr) {
+            _freeBuffers.push_back(buf.poolIndex);
         }
+    } else {
+        ::operator delete(buf.data, std::align_val_t{DIRECT_IO_ALIGNMENT});
+    }
+    buf = {};
+}
 
-        contents.append(buf, readBytes);
+int Ichor::v1::IOUringAsyncFileIO::startTransfer(FileTransfer &transfer, uint64_t fileSize, uint64_t maxSlots) {
+    _transfers.push_back(&transfer);
+    transfer.fileSize = fileSize;
+    auto const slotCount = std::max<uint64_t>(1, std::min(maxSlots, (fileSize + transfer.chunkSize - 1) / transfer.chunkSize));
+    transfer.slots.resize(slotCount);
 
-        if(contents.size() == fileSize) {
-            if constexpr (DO_INTERNAL_DEBUG || DO_HARDENING) {
-                if (!isLastInBatch) {
-                    std::terminate();
-                }
+    for(auto &slot : transfer.slots) {
+        if(transfer.kind == FileTransfer::Kind::COPY_SPLICE) {
+            if(::pipe2(slot.pipe, O_CLOEXEC) != 0) {
+                return -errno;
             }
-            evt.set();
-            return;
+            // a chunk has to fit in the pipe, otherwise splicing into it blocks until the other end is read
+            fcntl(slot.pipe[1], F_SETPIPE_SZ, static_cast<int>(transfer.chunkSize));
+            auto pipeSize = fcntl(slot.pipe[1], F_GETPIPE_SZ);
+            if(pipeSize > 0 && static_cast<uint32_t>(pipeSize) < transfer.chunkSize) {
+                transfer.chunkSize = static_cast<uint32_t>(pipeSize);
+            }
+        } else if(transfer.kind != FileTransfer::Kind::READ_TO_DESTINATION) {
+            slot.buffer = acquireBuffer();
         }
+    }
 
-        if(readBytes < _bufferSize) {
-            uniqueBuf.reset();
-            auto *sqe = _q->getSqeWithData(this, createNewEventHandlerReadWholeFile(evt, res, contents, sizeLeft, fileSize, fd, maxSubmissions, offset + readBytes, buf, isLastInBatch));
-            io_uring_prep_read(sqe, fd, buf, _bufferSize -  readBytes, offset + readBytes);
-            INTERNAL_IO_DEBUG("add read");
+    for(uint32_t i = 0; i < transfer.slots.size(); i++) {
+        if(assignNextChunk(transfer, i)) {
+            submitTransfer(transfer, i);
         }
+    }
 
-        // contents.size() indicates we're not done but we're the last in the batch. Submit a new batch.
-        if(isLastInBatch) {
-            recursiveSubmitReadWholeFile(evt, res, contents, sizeLeft, offset + readBytes, fileSize, fd, maxSubmissions);
-        }
-    };
+    return 0;
 }
 
-void Ichor::v1::IOUringAsyncFileIO::recursiveSubmitCopyFile(AsyncManualResetEvent &evt, int &res, uint64_t &sizeLeft, uint64_t offset, uint64_t fileSize, int fromFd, int toFd, uint32_t maxSubmissions) {
-    uint32_t submissions = maxSubmissions;
-    while(sizeLeft > 0 && submissions > 0) {
-        char* buf = new char[_bufferSize];
-        bool isLastInBatch = sizeLeft < _bufferSize || submissions == 1;
+bool Ichor::v1::IOUringAsyncFileIO::assignNextChunk(FileTransfer &transfer, uint32_t slot) {
+    if(transfer.nextChunk >= transfer.fileSize) {
+        return false;
+    }
+
+    auto &s = transfer.slots[slot];
+    s.chunkStart = transfer.nextChunk;
+    s.offset = transfer.nextChunk;
+    s.end = std::min(transfer.fileSize, transfer.nextChunk + transfer.chunkSize);
+    s.ready = false;
+    transfer.nextChunk = s.end;
+    return true;
+}
 
-        auto *sqe = _q->getSqeWithData(this, createNewEventHandlerCopyFileReadPart(evt, res, sizeLeft, fileSize, fromFd, toFd, maxSubmissions, offset, buf, isLastInBatch));
-        io_uring_prep_read(sqe, fromFd, buf, _bufferSize, offset);
-        INTERNAL_IO_DEBUG("add read");
+void Ichor::v1::IOUringAsyncFileIO::submitTransfer(FileTransfer &transfer, uint32_t slot) {
+    auto &s = transfer.slots[slot];
 
-        offset += _bufferSize;
-        if(sizeLeft > _bufferSize) {
-            sizeLeft -= _bufferSize;
-        } else {
-            sizeLeft = 0;
-        }
+    // small enough for std::function to store without allocating
+    auto *sqe = _q->getSqeWithData(this, [transferPtr = &transfer, slot](io_uring_cqe *cqe) {
+        transferPtr->ctx->self->handleTransferCompletion(*transferPtr, slot, cqe->res);
+    });
+    s.userData = sqe->user_data;
+    transfer.inFlight++;
+    _transfersInFlight++;
 
-        submissions--;
+    if(transfer.direct && transfer.kind == FileTransfer::Kind::READ_TO_BUFFERS) {
+        // O_DIRECT needs an aligned offset, a short read is resumed from the start of its last block, which is read again
+        s.offset = alignDown(s.offset, DIRECT_IO_ALIGNMENT);
     }
-}
 
-std::function<void(io_uring_cqe*)> Ichor::v1::IOUringAsyncFileIO::createNewEventHandlerCopyFileReadPart(AsyncManualResetEvent &evt, int &res, uint64_t &sizeLeft, uint64_t fileSize, int fromFd, int toFd, uint32_t maxSubmissions, uint64_t offset, char *buf, bool isLastInBatch) {
-    return [this, &evt, &res, &sizeLeft, fileSize, fromFd, toFd, buf, offset, isLastInBatch, maxSubmissions](io_uring_cqe *cqe) {
-        std::unique_ptr<char[]> uniqueBuf{buf};
-        INTERNAL_IO_DEBUG("read response {} {} {} {} {}", cqe->res, cqe->res < 0 ? strerror(-cqe->res) : "", _shouldStop, evt.is_set(), fileSize);
-        if(_shouldStop || res < 0) {
-            if(isLastInBatch && !evt.is_set()) {
-                evt.set();
+    auto const bufferOffset = s.offset - s.chunkStart;
+    auto len = static_cast<uint32_t>(s.end - s.offset);
+
+    switch(transfer.kind) {
+        case FileTransfer::Kind::READ_TO_DESTINATION:
+            io_uring_prep_read(sqe, transfer.fromFd, transfer.destination + s.offset, len, s.offset);
+            break;
+        case FileTransfer::Kind::READ_TO_BUFFERS:
+            if(transfer.direct) {
+                // the tail of the file is read with an aligned length as well, the read stops at the end of the file
+                len = static_cast<uint32_t>(std::min<uint64_t>(alignUp(len, DIRECT_IO_ALIGNMENT), _bufferSize - bufferOffset));
             }
-            return;
+            if(_buffersRegistered && s.buffer.poolIndex >= 0) {
+                io_uring_prep_read_fixed(sqe, transfer.fromFd, s.buffer.data + bufferOffset, len, s.offset, s.buffer.poolIndex);
+            } else {
+                io_uring_prep_read(sqe, transfer.fromFd, s.buffer.data + bufferOffset, len, s.offset);
+            }
+            break;
+        case FileTransfer::Kind::COPY_SPLICE:
+            if(s.writing) {
+                io_uring_prep_splice(sqe, s.pipe[0], -1, transfer.toFd, static_cast<int64_t>(s.offset), s.pending, 0);
+            } else {
+                io_uring_prep_splice(sqe, transfer.fromFd, static_cast<int64_t>(s.offset), s.pipe[1], -1, len, 0);
+            }
+            break;
+        case FileTransfer::Kind::COPY_BUFFERED:
+            if(s.writing) {
+                if(_buffersRegistered && s.buffer.poolIndex >= 0) {
+                    io_uring_prep_write_fixed(sqe, transfer.toFd, s.buffer.data + bufferOffset, s.pending, s.offset, s.buffer.poolIndex);
+                } else {
+                    io_uring_prep_write(sqe, transfer.toFd, s.buffer.data + bufferOffset, s.pending, s.offset);
+                }
+            } else {
+                if(_buffersRegistered && s.buffer.poolIndex >= 0) {
+                    io_uring_prep_read_fixed(sqe, transfer.fromFd, s.buffer.data + bufferOffset, len, s.offset, s.buffer.poolIndex);
+                } else {
+                    io_uring_prep_read(sqe, transfer.fromFd, s.buffer.data + bufferOffset, len, s.offset);
+                }
+            }
+            break;
+    }
+}
+
+void Ichor::v1::IOUringAsyncFileIO::handleTransferCompletion(FileTransfer &transfer, uint32_t slot, int res) {
+    INTERNAL_IO_DEBUG("transfer completion {} {} {} {}", slot, res, res < 0 ? strerror(-res) : "", _shouldStop);
+    transfer.slots[slot].userData = 0;
+    transfer.inFlight--;
+    _transfersInFlight--;
+    // stop() resumes inside set() and frees the buffers, so this has to run last
+    ScopeGuard sgStop{[this] {
+        if(_shouldStop && _transfersInFlight == 0) {
+            _transfersDone.set();
         }
+    }};
 
-        if(cqe->res < 0) {
-            ICHOR_LOG_ERROR(_logger, "read failed with result {} res {}", cqe->res, res);
-            res = cqe->res;
-            if(isLastInBatch) {
-                evt.set();
-            }
-            return;
+    if(transfer.abandoned) {
+        if(transfer.inFlight == 0) {
+            delete &transfer;
         }
+        return;
+    }
 
-        auto readBytes = static_cast<uint32_t>(cqe->res);
-        bool isLastInWriteBatch = offset + readBytes == fileSize;
+    if(res == 0) {
+        // the file got truncated while reading it
+        res = -EIO;
+    }
 
-        {
-            // buf will be deleted in write handler
-            uniqueBuf.release();
-            auto *sqe = _q->getSqeWithData(this, createNewEventHandlerCopyFileWritePart(evt, res, buf, isLastInWriteBatch));
-            io_uring_prep_write(sqe, toFd, buf, readBytes, std::numeric_limits<__u64>::max());
-            INTERNAL_IO_DEBUG("add write");
+    if(res < 0 && transfer.res == 0) {
+        if(res != -ECANCELED) {
+            ICHOR_LOG_ERROR(_logger, "file transfer failed with result {}", mapErrnoToError(-res));
         }
+        transfer.res = res;
+    }
 
-        if(!isLastInWriteBatch && readBytes < _bufferSize) {
-            char *newBuf = new char[_bufferSize];
-            auto *sqe = _q->getSqeWithData(this, createNewEventHandlerCopyFileReadPart(evt, res, sizeLeft, fileSize, fromFd, toFd, maxSubmissions, offset + readBytes, newBuf, isLastInBatch));
-            io_uring_prep_read(sqe, fromFd, newBuf, _bufferSize -  readBytes, offset + readBytes);
-            INTERNAL_IO_DEBUG("add read");
+    if(transfer.res < 0 || _shouldStop) {
+        // streams wake up the consumer right away, whole file operations wait for the other slots to finish
+        if(transfer.evt != nullptr && (transfer.isStream() || transfer.inFlight == 0)) {
+            transfer.evt->set();
         }
+        return;
+    }
 
-        // contents.size() indicates we're not done but we're the last in the batch. Submit a new batch.
-        if(!isLastInWriteBatch && isLastInBatch) {
-            recursiveSubmitCopyFile(evt, res, sizeLeft, offset + readBytes, fileSize, fromFd, toFd, maxSubmissions);
-        }
-    };
-}
+    auto &s = transfer.slots[slot];
+    auto const transferred = static_cast<uint32_t>(res);
 
-std::function<void(io_uring_cqe*)> Ichor::v1::IOUringAsyncFileIO::createNewEventHandlerCopyFileWritePart(AsyncManualResetEvent &evt, int &res, char *buf, bool isLastInBatch) {
-    return [this, &evt, &res, buf, isLastInBatch](io_uring_cqe *cqe) {
-        std::unique_ptr<char[]> uniqueBuf{buf};
-        INTERNAL_IO_DEBUG("write response {} {} {} {}", cqe->res, cqe->res < 0 ? strerror(-cqe->res) : "", _shouldStop, evt.is_set());
-        if(_shouldStop || res < 0) {
-            if(isLastInBatch && !evt.is_set()) {
-                evt.set();
-            }
+    if(transfer.kind == FileTransfer::Kind::READ_TO_DESTINATION || transfer.kind == FileTransfer::Kind::READ_TO_BUFFERS) {
+        s.offset = std::min(s.offset + transferred, s.end);
+        if(s.offset < s.end) {
+            submitTransfer(transfer, slot);
             return;
         }
+        finishChunk(transfer, slot);
+        return;
+    }
 
-        if(cqe->res < 0) {
-            ICHOR_LOG_ERROR(_logger, "write failed with result {} res {}", cqe->res, res);
-            res = cqe->res;
-            if(isLastInBatch) {
-                evt.set();
-            }
-            return;
-        }
+    if(!s.writing) {
+        s.pending = transferred;
+        s.writing = true;
+        submitTransfer(transfer, slot);
+        return;
+    }
 
-        if(isLastInBatch) {
-            evt.set();
+    s.offset += transferred;
+    s.pending -= transferred;
+    if(s.pending == 0) {
+        s.writing = false;
+    }
+    if(s.offset < s.end) {
+        submitTransfer(transfer, slot);
+        return;
+    }
+    finishChunk(transfer, slot);
+}
+
+void Ichor::v1::IOUringAsyncFileIO::finishChunk(FileTransfer &transfer, uint32_t slot) {
+    auto &s = transfer.slots[slot];
+
+    if(transfer.isStream()) {
+        s.ready = true;
+        // resumes the stream inline, which may destroy the transfer
+        if(transfer.evt != nullptr) {
+            transfer.evt->set();
         }
-    };
+        return;
+    }
+
+    if(transfer.kind == FileTransfer::Kind::READ_TO_BUFFERS) {
+        std::memcpy(transfer.destination + s.chunkStart, s.buffer.data, s.end - s.chunkStart);
+    }
+
+    if(assignNextChunk(transfer, slot)) {
+        submitTransfer(transfer, slot);
+        return;
+    }
+
+    if(transfer.inFlight == 0 && transfer.evt != nullptr) {
+        transfer.evt->set();
+    }
 }
@@ -0,0 +1,279 @@
+#include <ichor/services/io/MappedFileService.h>
+#include <ichor/DependencyManager.h>
+#include <ichor/coroutines/AsyncManualResetEvent.h>
+#include <fmt/format.h>
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#if (defined(WIN32) || defined(_WIN32) || defined(__WIN32)) && !defined(__CYGWIN__)
+#include <windows.h>
+#include <memoryapi.h>
+#define ICHOR_WINDOWS_MAPPING
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#ifdef ICHOR_USE_LIBURING
+#include <ichor/ichor_liburing.h>
+#endif
+
+namespace {
+    // process-wide, so every DependencyManager thread shares one mapping per file
+    std::mutex mappingsMutex{};
+    std::unordered_map<std::string, std::weak_ptr<Ichor::v1::MappedFile const>> mappings{};
+
+#ifdef ICHOR_WINDOWS_MAPPING
+    Ichor::v1::IOError mapWindowsError(DWORD err) noexcept {
+        switch(err) {
+            case ERROR_FILE_NOT_FOUND:
+            case ERROR_PATH_NOT_FOUND:
+                return Ichor::v1::IOError::FILE_DOES_NOT_EXIST;
+            case ERROR_ACCESS_DENIED:
+                return Ichor::v1::IOError::NO_PERMISSION;
+            case ERROR_NOT_ENOUGH_MEMORY:
+                return Ichor::v1::IOError::NO_MEMORY_AVAILABLE;
+            default:
+                return Ichor::v1::IOError::FAILED;
+        }
+    }
+#else
+    void applyHints(Ichor::v1::MappedFile const &file, Ichor::v1::MappedFileHints hints) noexcept {
+        using Ichor::v1::MappedFileHints;
+        if(file.size() == 0) {
+            return;
+        }
+
+        // hints are best effort, failing to apply one does not make the mapping unusable
+        auto *addr = const_cast<std::byte*>(file.data().data());
+        if((hints & MappedFileHints::SEQUENTIAL) == MappedFileHints::SEQUENTIAL) {
+            ::madvise(addr, file.size(), MADV_SEQUENTIAL);
+        } else if((hints & MappedFileHints::RANDOM) == MappedFileHints::RANDOM) {
+            ::madvise(addr, file.size(), MADV_RANDOM);
+        }
+#ifdef MADV_HUGEPAGE
+        if((hints & MappedFileHints::HUGE_PAGES) == MappedFileHints::HUGE_PAGES) {
+            ::madvise(addr, file.size(), MADV_HUGEPAGE);
+        }
+#endif
+    }
+#endif
+}
+
+Ichor::v1::MappedFile::MappedFile(std::filesystem::path path, std::byte const *data, uint64_t size, void *nativeMapping) noexcept : _path(std::move(path)), _data(data), _size(size), _nativeMapping(nativeMapping) {
+}
+
+Ichor::v1::MappedFile::~MappedFile() {
+    if(_data == nullptr) {
+        return;
+    }
+#ifdef ICHOR_WINDOWS_MAPPING
+    UnmapViewOfFile(_data);
+    CloseHandle(_nativeMapping);
+#else
+    ::munmap(const_cast<std::byte*>(_data), static_cast<size_t>(_size));
+#endif
+}
+
+Ichor::v1::MappedFileService::MappedFileService(DependencyRegister &reg, Properties props) : AdvancedService(std::move(props)) {
+#ifdef ICHOR_USE_LIBURING
+    reg.registerDependency<IIOUringQueue>(this, DependencyFlags::NONE);
+#else
+    static_cast<void>(reg);
+#endif
+}
+
+Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::MappedFileService::start() {
+    co_return {};
+}
+
+Ichor::Task<void> Ichor::v1::MappedFileService::stop() {
+    co_return;
+}
+
+#ifdef ICHOR_USE_LIBURING
+void Ichor::v1::MappedFileService::addDependencyInstance(Ichor::ScopedServiceProxy<IIOUringQueue*> q, IService&) noexcept {
+    _q = std::move(q);
+}
+
+void Ichor::v1::MappedFileService::removeDependencyInstance(Ichor::ScopedServiceProxy<IIOUringQueue*>, IService&) noexcept {
+    _q.reset();
+}
+#endif
+
+tl::expected<std::shared_ptr<Ichor::v1::MappedFile const>, Ichor::v1::IOError> Ichor::v1::MappedFileService::map(std::filesystem::path const &file_path, MappedFileHints hints) {
+    INTERNAL_IO_DEBUG("map({})", file_path);
+
+#ifdef ICHOR_WINDOWS_MAPPING
+    std::error_code ec;
+    auto canonical = std::filesystem::canonical(file_path, ec);
+    if(ec) {
+        return tl::unexpected(mapWindowsError(static_cast<DWORD>(ec.value())));
+    }
+    auto key = canonical.string();
+
+    HANDLE file = CreateFileW(canonical.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE) {
+        return tl::unexpected(mapWindowsError(GetLastError()));
+    }
+    LARGE_INTEGER fileSize{};
+    if(GetFileSizeEx(file, &fileSize) == 0) {
+        auto err = GetLastError();
+        CloseHandle(file);
+        return tl::unexpected(mapWindowsError(err));
+    }
+    auto size = static_cast<uint64_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd == -1) {
+        return tl::unexpected(mapErrnoToError(errno));
+    }
+
+    struct stat st{};
+    if(::fstat(fd, &st) == -1) {
+        auto err = errno;
+        ::close(fd);
+        return tl::unexpected(mapErrnoToError(err));
+    }
+    auto size = static_cast<uint64_t>(st.st_size);
+    // the same file through any path, a file replaced with a different size gets a new mapping
+    auto key = fmt::format("{}:{}:{}", st.st_dev, st.st_ino, size);
+#endif
+
+    std::lock_guard lg{mappingsMutex};
+
+    if(auto it = mappings.find(key); it != mappings.end()) {
+        if(auto existing = it->second.lock()) {
+#ifdef ICHOR_WINDOWS_MAPPING
+            CloseHandle(file);
+#else
+            ::close(fd);
+            applyHints(*existing, hints);
+#endif
+            INTERNAL_IO_DEBUG("map({}) reusing existing mapping", file_path);
+            return existing;
+        }
+    }
+
+    std::shared_ptr<MappedFile const> mapped;
+    if(size == 0) {
+        // mapping zero bytes is an error
+        mapped = std::make_shared<MappedFile const>(file_path, nullptr, 0, nullptr);
+    } else {
+#ifdef ICHOR_WINDOWS_MAPPING
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        auto mappingErr = GetLastError();
+        CloseHandle(file);
+        if(mapping == nullptr) {
+            return tl::unexpected(mapWindowsError(mappingErr));
+        }
+        void *addr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if(addr == nullptr) {
+            auto err = GetLastError();
+            CloseHandle(mapping);
+            return tl::unexpected(mapWindowsError(err));
+        }
+        mapped = std::make_shared<MappedFile const>(file_path, static_cast<std::byte const*>(addr), size, mapping);
+#else
+        if(size > std::numeric_limits<size_t>::max()) {
+            ::close(fd);
+            return tl::unexpected(IOError::FILE_SIZE_TOO_BIG);
+        }
+        void *addr = ::mmap(nullptr, static_cast<size_t>(size), PROT_READ, MAP_SHARED, fd, 0);
+        auto err = errno;
+        // the mapping keeps its own reference to the file
+        ::close(fd);
+        if(addr == MAP_FAILED) {
+            return tl::unexpected(mapErrnoToError(err));
+        }
+        mapped = std::make_shared<MappedFile const>(file_path, static_cast<std::byte const*>(addr), size, nullptr);
+#endif
+    }
+
+#ifdef ICHOR_WINDOWS_MAPPING
+    if(size == 0) {
+        CloseHandle(file);
+    }
+#else
+    if(size == 0) {
+        ::close(fd);
+    }
+    applyHints(*mapped, hints);
+    if((hints & MappedFileHints::WILL_NEED) == MappedFileHints::WILL_NEED && size > 0) {
+        // only starts the readahead, it does not wait for it
+        ::madvise(const_cast<std::byte*>(mapped->data().data()), static_cast<size_t>(size), MADV_WILLNEED);
+    }
+#endif
+
+    std::erase_if(mappings, [](auto const &entry) {
+        return entry.second.expired();
+    });
+    mappings[std::move(key)] = mapped;
+
+    return mapped;
+}
+
+Ichor::Task<tl::expected<void, Ichor::v1::IOError>> Ichor::v1::MappedFileService::prefetch(std::shared_ptr<MappedFile const> file, uint64_t offset, uint64_t length) {
+    if(!file) {
+        co_return tl::unexpected(IOError::BAD_FILE_DESCRIPTOR);
+    }
+    if(offset >= file->size()) {
+        co_return {};
+    }
+    if(length == 0 || length > file->size() - offset) {
+        length = file->size() - offset;
+    }
+
+    auto *addr = const_cast<std::byte*>(file->data().data() + offset);
+#ifdef ICHOR_WINDOWS_MAPPING
+    WIN32_MEMORY_RANGE_ENTRY range{addr, static_cast<SIZE_T>(length)};
+    if(PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0) == 0) {
+        co_return tl::unexpected(mapWindowsError(GetLastError()));
+    }
+#else
+    // madvise requires a page aligned start
+    auto pageSize = static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+    auto misalignment = reinterpret_cast<uintptr_t>(addr) % pageSize;
+    addr -= misalignment;
+    length += misalignment;
+
+#ifdef ICHOR_USE_LIBURING
+    if(_q != nullptr && _q->getKernelVersion() >= Version{5, 6, 0}) {
+        // the length ends up in a 32-bit field of the sqe, larger ranges are split in page aligned chunks
+        constexpr uint64_t MAX_MADVISE_LENGTH = uint64_t{1} << 31;
+        AsyncManualResetEvent evt;
+        int res{};
+        uint64_t pending{};
+        for(uint64_t done = 0; done < length; done += MAX_MADVISE_LENGTH) {
+            auto *sqe = _q->getSqeWithData(this, [&evt, &res, &pending](io_uring_cqe *cqe) {
+                INTERNAL_IO_DEBUG("madvise res: {} {}", cqe->res, cqe->res < 0 ? strerror(-cqe->res) : "");
+                if(cqe->res < 0 && res == 0) {
+                    res = cqe->res;
+                }
+                if(--pending == 0) {
+                    evt.set();
+                }
+            });
+            pending++;
+            // the file is captured by this coroutine, it stays mapped until the kernel is done
+            io_uring_prep_madvise(sqe, addr + done, static_cast<off_t>(std::min(length - done, MAX_MADVISE_LENGTH)), MADV_WILLNEED);
+        }
+        co_await evt;
+
+        if(res < 0) {
+            co_return tl::unexpected(mapErrnoToError(-res));
+        }
+        co_return {};
+    }
+#endif
+
+    if(::madvise(addr, static_cast<size_t>(length), MADV_WILLNEED) != 0) {
+        co_return tl::unexpected(mapErrnoToError(errno));
+    }
+#endif
+
+    co_return {};
+}
@@ -1,76 +1,537 @@
-#include <atomic>
+#include <array>
 #include <functional>
-#include <chrono>
+#include <mutex>
+#include <vector>
 #include <fmt/core.h>
 #include <fstream>
 #include <ichor/services/io/SharedOverThreadsAsyncFileIO.h>
+#include <ichor/DependencyManager.h>
+#include <ichor/event_queues/CompletionBatch.h>
+#include <ichor/services/workers/WorkerThreads.h>
 #include <ichor/event_queues/IEventQueue.h>
 #include <ichor/events/RunFunctionEvent.h>
 #include <fmt/os.h>
 #include <ichor/ScopeGuard.h>
 #if (defined(WIN32) || defined(_WIN32) || defined(__WIN32)) && !defined(__CYGWIN__)
 #include <winbase.h>
+#include <fileapi.h>
 #include <errhandlingapi.h>
+#define ICHOR_WINDOWS_FILES
 #elif defined(__APPLE__)
 #include <copyfile.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
 #else
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/stat.h>
 #endif
 
-using namespace std::chrono_literals;
+namespace {
+    // blocking positional I/O used by the IAsyncFile handles, runs on the worker threads
+#ifdef ICHOR_WINDOWS_FILES
+    using NativeFile = HANDLE;
+
+    Ichor::v1::IOError mapWindowsError(DWORD err) noexcept {
+        switch(err) {
+            case ERROR_FILE_NOT_FOUND:
+            case ERROR_PATH_NOT_FOUND:
+                return Ichor::v1::IOError::FILE_DOES_NOT_EXIST;
+            case ERROR_ACCESS_DENIED:
+                return Ichor::v1::IOError::NO_PERMISSION;
+            case ERROR_FILE_EXISTS:
+            case ERROR_ALREADY_EXISTS:
+                return Ichor::v1::IOError::FILE_ALREADY_EXISTS;
+            case ERROR_INVALID_HANDLE:
+                return Ichor::v1::IOError::BAD_FILE_DESCRIPTOR;
+            case ERROR_DISK_FULL:
+            case ERROR_HANDLE_DISK_FULL:
+                return Ichor::v1::IOError::NO_SPACE_LEFT;
+            default:
+                return Ichor::v1::IOError::FAILED;
+        }
+    }
 
-std::atomic<bool> Ichor::v1::SharedOverThreadsAsyncFileIO::_initialized;
-std::mutex Ichor::v1::SharedOverThreadsAsyncFileIO::_io_mutex;
-std::queue<std::shared_ptr<Ichor::v1::io_operation_submission>> Ichor::v1::SharedOverThreadsAsyncFileIO::_evts;
+    bool isValid(NativeFile file) noexcept {
+        return file != INVALID_HANDLE_VALUE;
+    }
 
-Ichor::v1::SharedOverThreadsAsyncFileIO::SharedOverThreadsAsyncFileIO(Properties props) : AdvancedService<SharedOverThreadsAsyncFileIO>(std::move(props)) {
+    NativeFile invalidFile() noexcept {
+        return INVALID_HANDLE_VALUE;
+    }
+
+    tl::expected<NativeFile, Ichor::v1::IOError> openNative(std::filesystem::path const &path, Ichor::v1::FileOpenFlags flags) {
+        using Ichor::v1::FileOpenFlags;
+        DWORD access{};
+        if((flags & FileOpenFlags::READ) == FileOpenFlags::READ) {
+            access |= GENERIC_READ;
+        }
+        if((flags & FileOpenFlags::WRITE) == FileOpenFlags::WRITE) {
+            access |= GENERIC_WRITE;
+        }
+
+        bool create = (flags & FileOpenFlags::CREATE) == FileOpenFlags::CREATE;
+        bool truncate = (flags & FileOpenFlags::TRUNCATE) == FileOpenFlags::TRUNCATE;
+        DWORD disposition = OPEN_EXISTING;
+        if(create && (flags & FileOpenFlags::EXCLUSIVE) == FileOpenFlags::EXCLUSIVE) {
+            disposition = CREATE_NEW;
+        } else if(create && truncate) {
+            disposition = CREATE_ALWAYS;
+        } else if(create) {
+            disposition = OPEN_ALWAYS;
+        } else if(truncate) {
+            disposition = TRUNCATE_EXISTING;
+        }
+
+        HANDLE file = CreateFileW(path.c_str(), access, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, disposition, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if(file == INVALID_HANDLE_VALUE) {
+            return tl::unexpected(mapWindowsError(GetLastError()));
+        }
+        return file;
+    }
+
+    tl::expected<uint64_t, Ichor::v1::IOError> readAt(NativeFile file, char *data, uint64_t size, uint64_t offset) {
+        uint64_t done{};
+        while(done < size) {
+            OVERLAPPED overlapped{};
+            overlapped.Offset = static_cast<DWORD>(offset + done);
+            overlapped.OffsetHigh = static_cast<DWORD>((offset + done) >> 32);
+            DWORD transferred{};
+            if(ReadFile(file, data + done, static_cast<DWORD>(std::min<uint64_t>(size - done, 1u << 30)), &transferred, &overlapped) == 0) {
+                auto err = GetLastError();
+                if(err == ERROR_HANDLE_EOF) {
+                    break;
+                }
+                return tl::unexpected(mapWindowsError(err));
+            }
+            if(transferred == 0) {
+                break;
+            }
+            done += transferred;
+        }
+        return done;
+    }
+
+    tl::expected<void, Ichor::v1::IOError> writeAt(NativeFile file, char const *data, uint64_t size, uint64_t offset) {
+        uint64_t done{};
+        while(done < size) {
+            OVERLAPPED overlapped{};
+            overlapped.Offset = static_cast<DWORD>(offset + done);
+            overlapped.OffsetHigh = static_cast<DWORD>((offset + done) >> 32);
+            DWORD transferred{};
+            if(WriteFile(file, data + done, static_cast<DWORD>(std::min<uint64_t>(size - done, 1u << 30)), &transferred, &overlapped) == 0) {
+                return tl::unexpected(mapWindowsError(GetLastError()));
+            }
+            done += transferred;
+        }
+        return {};
+    }
+
+    tl::expected<void, Ichor::v1::IOError> syncNative(NativeFile file, bool) {
+        if(FlushFileBuffers(file) == 0) {
+            return tl::unexpected(mapWindowsError(GetLastError()));
+        }
+        return {};
+    }
+
+    tl::expected<uint64_t, Ichor::v1::IOError> sizeNative(NativeFile file) {
+        LARGE_INTEGER size{};
+        if(GetFileSizeEx(file, &size) == 0) {
+            return tl::unexpected(mapWindowsError(GetLastError()));
+        }
+        return static_cast<uint64_t>(size.QuadPart);
+    }
+
+    // Windows has no way to reserve a range, extending the file is the closest
+    tl::expected<void, Ichor::v1::IOError> allocateNative(NativeFile file, uint64_t offset, uint64_t length) {
+        auto size = sizeNative(file);
+        if(!size) {
+            return tl::unexpected(size.error());
+        }
+        if(*size >= offset + length) {
+            return {};
+        }
+        FILE_END_OF_FILE_INFO info{};
+        info.EndOfFile.QuadPart = static_cast<LONGLONG>(offset + length);
+        if(SetFileInformationByHandle(file, FileEndOfFileInfo, &info, sizeof(info)) == 0) {
+            return tl::unexpected(mapWindowsError(GetLastError()));
+        }
+        return {};
+    }
+
+    tl::expected<void, Ichor::v1::IOError> closeNative(NativeFile file) {
+        if(CloseHandle(file) == 0) {
+            return tl::unexpected(mapWindowsError(GetLastError()));
+        }
+        return {};
+    }
+#else
+    using NativeFile = int;
+
+    bool isValid(NativeFile file) noexcept {
+        return file >= 0;
+    }
+
+    NativeFile invalidFile() noexcept {
+        return -1;
+    }
+
+    tl::expected<NativeFile, Ichor::v1::IOError> openNative(std::filesystem::path const &path, Ichor::v1::FileOpenFlags flags) {
+        using Ichor::v1::FileOpenFlags;
+        bool read = (flags & FileOpenFlags::READ) == FileOpenFlags::READ;
+        bool write = (flags & FileOpenFlags::WRITE) == FileOpenFlags::WRITE;
+        int openFlags = O_CLOEXEC | (read && write ? O_RDWR : (write ? O_WRONLY : O_RDONLY));
+        if((flags & FileOpenFlags::CREATE) == FileOpenFlags::CREATE) {
+            openFlags |= O_CREAT;
+        }
+        if((flags & FileOpenFlags::TRUNCATE) == FileOpenFlags::TRUNCATE) {
+            openFlags |= O_TRUNC;
+        }
+        if((flags & FileOpenFlags::EXCLUSIVE) == FileOpenFlags::EXCLUSIVE) {
+            openFlags |= O_EXCL;
+        }
+        bool direct = (flags & FileOpenFlags::DIRECT) == FileOpenFlags::DIRECT;
+
+        int fd;
+#ifdef O_DIRECT
+        if(direct) {
+            do {
+                fd = ::open(path.c_str(), openFlags | O_DIRECT, 0644);
+            } while(fd == -1 && errno == EINTR);
+            // file systems without O_DIRECT support reject it
+            if(fd >= 0 || errno != EINVAL) {
+                if(fd == -1) {
+                    return tl::unexpected(Ichor::v1::mapErrnoToError(errno));
+                }
+                return fd;
+            }
+        }
+#endif
+        do {
+            fd = ::open(path.c_str(), openFlags, 0644);
+        } while(fd == -1 && errno == EINTR);
+        if(fd == -1) {
+            return tl::unexpected(Ichor::v1::mapErrnoToError(errno));
+        }
+#ifdef __APPLE__
+        if(direct) {
+            fcntl(fd, F_NOCACHE, 1);
+        }
+#endif
+        return fd;
+    }
+
+    tl::expected<uint64_t, Ichor::v1::IOError> readAt(NativeFile fd, char *data, uint64_t size, uint64_t offset) {
+        uint64_t done{};
+        while(done < size) {
+            auto ret = ::pread(fd, data + done, static_cast<size_t>(std::min<uint64_t>(size - done, 1u << 30)), static_cast<off_t>(offset + done));
+            if(ret == -1) {
+                if(errno == EINTR) {
+                    continue;
+                }
+                return tl::unexpected(Ichor::v1::mapErrnoToError(errno));
+            }
+            if(ret == 0) {
+                break;
+            }
+            done += static_cast<uint64_t>(ret);
+        }
+        return done;
+    }
 
+    tl::expected<void, Ichor::v1::IOError> writeAt(NativeFile fd, char const *data, uint64_t size, uint64_t offset) {
+        uint64_t done{};
+        while(done < size) {
+            auto ret = ::pwrite(fd, data + done, static_cast<size_t>(std::min<uint64_t>(size - done, 1u << 30)), static_cast<off_t>(offset + done));
+            if(ret == -1) {
+                if(errno == EINTR) {
+                    continue;
+                }
+                return tl::unexpected(Ichor::v1::mapErrnoToError(errno));
+            }
+            done += static_cast<uint64_t>(ret);
+        }
+        return {};
+    }
+
+    tl::expected<void, Ichor::v1::IOError> syncNative(NativeFile fd, [[maybe_unused]] bool dataOnly) {
+#ifdef __APPLE__
+        int ret = ::fsync(fd);
+#else
+        int ret = dataOnly ? ::fdatasync(fd) : ::fsync(fd);
+#endif
+        if(ret == -1) {
+            return tl::unexpected(Ichor::v1::mapErrnoToError(errno));
+        }
+        return {};
+    }
+
+    tl::expected<uint64_t, Ichor::v1::IOError> sizeNative(NativeFile fd) {
+        struct stat st{};
+        if(::fstat(fd, &st) == -1) {
+            return tl::unexpected(Ichor::v1::mapErrnoToError(errno));
+        }
+        return static_cast<uint64_t>(st.st_size);
+    }
+
+    tl::expected<void, Ichor::v1::IOError> allocateNative(NativeFile fd, uint64_t offset, uint64_t length) {
+#ifdef __APPLE__
+        // no posix_fallocate, extending the file is the closest
+        auto size = sizeNative(fd);
+        if(!size) {
+            return tl::unexpected(size.error());
+        }
+        if(*size < offset + length && ::ftruncate(fd, static_cast<off_t>(offset + length)) == -1) {
+            return tl::unexpected(Ichor::v1::mapErrnoToError(errno));
+        }
+#else
+        // returns the error instead of setting errno
+        if(int ret = ::posix_fallocate(fd, static_cast<off_t>(offset), static_cast<off_t>(length)); ret != 0) {
+            return tl::unexpected(Ichor::v1::mapErrnoToError(ret));
+        }
+#endif
+        return {};
+    }
+
+    tl::expected<void, Ichor::v1::IOError> closeNative(NativeFile fd) {
+        // the descriptor is released even if close reports an error, retrying could close another file
+        if(::close(fd) == -1 && errno != EINTR) {
+            return tl::unexpected(Ichor::v1::mapErrnoToError(errno));
+        }
+        return {};
+    }
+#endif
 }
 
+// Completed submissions of one instance, handed back to its queue in batches
+struct Ichor::v1::SharedOverThreadsAsyncFileIO::CompletionBatch final : public Ichor::Detail::CompletionBatch<io_operation_submission> {
+    using Ichor::Detail::CompletionBatch<io_operation_submission>::CompletionBatch;
 
-Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::SharedOverThreadsAsyncFileIO::start() {
-    INTERNAL_IO_DEBUG("setup_thread");
-    if (!_initialized.exchange(true, std::memory_order_acq_rel)) {
-        auto &queue = GetThreadLocalEventQueue();
-
-        _io_thread = std::thread([this, &queue = queue]() {
-            INTERNAL_IO_DEBUG("io_thread");
-            while(!_should_stop.load(std::memory_order_acquire)) {
-                INTERNAL_IO_DEBUG("checking");
-                {
-                    std::unique_lock lg{_io_mutex};
-                    while (!_evts.empty()) {
-                        INTERNAL_IO_DEBUG("processing submission");
-                        auto submission = std::move(_evts.front());
-                        _evts.pop();
-                        lg.unlock();
-                        submission->fn(submission->result);
-                        queue.pushEvent<RunFunctionEvent>(ServiceIdType{0}, [submission = std::move(submission)]() mutable {
-                            submission->evt.set();
-                        });
-                        lg.lock();
-                    }
+    bool stopped{}; // the owning service stopped, only used on the thread of queue
+};
+
+// The io threads, shared by all instances and started by the first one
+struct Ichor::v1::SharedOverThreadsAsyncFileIO::WorkerPool final {
+    struct Operation final {
+        void operator()() {
+            INTERNAL_IO_DEBUG("processing submission");
+            submission->fn(submission->result);
+            completions->complete(std::move(submission));
+        }
+
+        std::shared_ptr<io_operation_submission> submission;
+        std::shared_ptr<CompletionBatch> completions;
+    };
+
+    void acquire(uint32_t threadCount) {
+        std::unique_lock lifecycle{lifecycleMutex};
+        if(users++ > 0) {
+            return;
+        }
+
+        INTERNAL_IO_DEBUG("starting {} io threads", threadCount);
+        threads.start(threadCount, "FileIO");
+    }
+
+    void release() {
+        std::unique_lock lifecycle{lifecycleMutex};
+        if(--users > 0) {
+            return;
+        }
+
+        threads.stop();
+        INTERNAL_IO_DEBUG("io threads done");
+    }
+
+    void push(Operation &&op) {
+        threads.push(std::move(op));
+    }
+
+    std::mutex lifecycleMutex; // serializes starting and joining the threads
+    uint64_t users{};
+    Ichor::Detail::WorkerThreads<Operation> threads;
+};
+
+Ichor::v1::SharedOverThreadsAsyncFileIO::WorkerPool Ichor::v1::SharedOverThreadsAsyncFileIO::_pool;
+
+class Ichor::v1::SharedOverThreadsAsyncFileIO::AsyncFile final : public IAsyncFile {
+public:
+    AsyncFile(std::shared_ptr<CompletionBatch> completions, NativeFile file) noexcept : _completions(std::move(completions)), _file(file) {}
+    AsyncFile(AsyncFile const &) = delete;
+    AsyncFile(AsyncFile &&) = delete;
+    AsyncFile& operator=(AsyncFile const &) = delete;
+    AsyncFile& operator=(AsyncFile &&) = delete;
+
+    ~AsyncFile() final {
+        if(!isValid(_file)) {
+            return;
+        }
+
+        if(_completions->stopped) {
+            std::ignore = closeNative(_file);
+            return;
+        }
+
+        // closing can flush, don't block the event loop on it
+        auto submission = std::make_shared<io_operation_submission>();
+        submission->fn = [file = _file](decltype(io_operation_submission::result) &res) {
+            res = closeNative(file);
+        };
+        _pool.push(WorkerPool::Operation{std::move(submission), _completions});
+    }
+
+    Task<tl::expected<uint64_t, IOError>> read(std::span<char> buffer, uint64_t offset) final {
+        uint64_t bytes{};
+        auto res = co_await run([&bytes, buffer, offset](NativeFile file) -> tl::expected<void, IOError> {
+            auto ret = readAt(file, buffer.data(), buffer.size(), offset);
+            if(!ret) {
+                return tl::unexpected(ret.error());
+            }
+            bytes = *ret;
+            return {};
+        });
+        if(!res) {
+            co_return tl::unexpected(res.error());
+        }
+        co_return bytes;
+    }
+
+    Task<tl::expected<void, IOError>> write(std::span<char const> buffer, uint64_t offset) final {
+        co_return co_await run([buffer, offset](NativeFile file) {
+            return writeAt(file, buffer.data(), buffer.size(), offset);
+        });
+    }
+
+    Task<tl::expected<uint64_t, IOError>> readv(std::span<std::span<char> const> buffers, uint64_t offset) final {
+        uint64_t bytes{};
+        // one hop to the worker for all buffers, the syscalls per buffer are cheap compared to that
+        auto res = co_await run([&bytes, buffers, offset](NativeFile file) -> tl::expected<void, IOError> {
+            for(auto const &buffer : buffers) {
+                auto ret = readAt(file, buffer.data(), buffer.size(), offset + bytes);
+                if(!ret) {
+                    return tl::unexpected(ret.error());
+                }
+                bytes += *ret;
+                if(*ret < buffer.size()) {
+                    break;
                 }
-                std::this_thread::sleep_for(10ms);
-                INTERNAL_IO_DEBUG("checking post-sleep");
             }
-            INTERNAL_IO_DEBUG("io_thread done");
+            return {};
         });
+        if(!res) {
+            co_return tl::unexpected(res.error());
+        }
+        co_return bytes;
+    }
+
+    Task<tl::expected<void, IOError>> writev(std::span<std::span<char const> const> buffers, uint64_t offset) final {
+        co_return co_await run([buffers, offset](NativeFile file) -> tl::expected<void, IOError> {
+            uint64_t written{};
+            for(auto const &buffer : buffers) {
+                auto ret = writeAt(file, buffer.data(), buffer.size(), offset + written);
+                if(!ret) {
+                    return ret;
+                }
+                written += buffer.size();
+            }
+            return {};
+        });
+    }
+
+    Task<tl::expected<void, IOError>> sync() final {
+        co_return co_await run([](NativeFile file) {
+            return syncNative(file, false);
+        });
+    }
+
+    Task<tl::expected<void, IOError>> dataSync() final {
+        co_return co_await run([](NativeFile file) {
+            return syncNative(file, true);
+        });
+    }
+
+    Task<tl::expected<void, IOError>> allocate(uint64_t offset, uint64_t length) final {
+        co_return co_await run([offset, length](NativeFile file) {
+            return allocateNative(file, offset, length);
+        });
+    }
+
+    Task<tl::expected<uint64_t, IOError>> size() final {
+        uint64_t bytes{};
+        auto res = co_await run([&bytes](NativeFile file) -> tl::expected<void, IOError> {
+            auto ret = sizeNative(file);
+            if(!ret) {
+                return tl::unexpected(ret.error());
+            }
+            bytes = *ret;
+            return {};
+        });
+        if(!res) {
+            co_return tl::unexpected(res.error());
+        }
+        co_return bytes;
+    }
+
+    Task<tl::expected<void, IOError>> close() final {
+        auto res = co_await run([](NativeFile file) {
+            return closeNative(file);
+        });
+        _file = invalidFile();
+        co_return res;
+    }
+
+private:
+    /// Runs fn with the file on a worker thread and waits for it
+    template <typename Fn>
+    Task<tl::expected<void, IOError>> run(Fn fn) {
+        if(!isValid(_file)) {
+            co_return tl::unexpected(IOError::BAD_FILE_DESCRIPTOR);
+        }
+        if(_completions->stopped) {
+            co_return tl::unexpected(IOError::SERVICE_STOPPED);
+        }
+
+        auto submission = std::make_shared<io_operation_submission>();
+        submission->fn = [file = _file, &fn](decltype(io_operation_submission::result) &res) {
+            res = fn(file);
+        };
+        _pool.push(WorkerPool::Operation{submission, _completions});
+        co_await submission->evt;
+
+        co_return submission->result;
+    }
+
+    std::shared_ptr<CompletionBatch> _completions;
+    NativeFile _file;
+};
+
+Ichor::v1::SharedOverThreadsAsyncFileIO::SharedOverThreadsAsyncFileIO(Properties props) : AdvancedService<SharedOverThreadsAsyncFileIO>(std::move(props)) {
+    if(auto propIt = getProperties().find("WorkerThreads"); propIt != getProperties().end()) {
+        _workerThreads = Ichor::v1::any_cast<uint32_t>(propIt->second);
     }
+}
+
+
+Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::SharedOverThreadsAsyncFileIO::start() {
+    INTERNAL_IO_DEBUG("setup_thread");
+    _completions = std::make_shared<CompletionBatch>(GetThreadLocalEventQueue());
+    _pool.acquire(_workerThreads);
     co_return {};
 }
 
 Ichor::Task<void> Ichor::v1::SharedOverThreadsAsyncFileIO::stop() {
-    if(_io_thread && _io_thread->joinable()) {
-        _should_stop.store(true, std::memory_order_release);
-        _io_thread->join();
-        _initialized.store(false, std::memory_order_release);
-    }
+    _pool.release();
+    // open files outlive the service, their operations fail from here on
+    _completions->stopped = true;
+    _completions.reset();
     co_return;
 }
 
+void Ichor::v1::SharedOverThreadsAsyncFileIO::submit(std::shared_ptr<io_operation_submission> submission) {
+    _pool.push(WorkerPool::Operation{std::move(submission), _completions});
+}
+
 Ichor::Task<tl::expected<std::string, Ichor::v1::IOError>> Ichor::v1::SharedOverThreadsAsyncFileIO::readWholeFile(std::filesystem::path const &file_path) {
     INTERNAL_IO_DEBUG("readWholeFile()");
 
@@ -100,10 +561,7 @@ Ichor::Task<tl::expected<std::string, Ichor::v1::IOError>> Ichor::v1::SharedOver
 
         INTERNAL_IO_DEBUG("submission->fn() contents: {}", contents);
     };
-    {
-        std::unique_lock lg{_io_mutex};
-        _evts.push(submission);
-    }
+    submit(submission);
     INTERNAL_IO_DEBUG("co_await");
     co_await submission->evt;
 
@@ -116,6 +574,100 @@ Ichor::Task<tl::expected<std::string, Ichor::v1::IOError>> Ichor::v1::SharedOver
     co_return contents;
 }
 
+Ichor::AsyncGenerator<tl::expected<std::span<char const>, Ichor::v1::IOError>> Ichor::v1::SharedOverThreadsAsyncFileIO::readFileStream(std::filesystem::path const &file_path) {
+    INTERNAL_IO_DEBUG("readFileStream()");
+
+    constexpr size_t chunkSize = 64 * 1024;
+
+    // shared with the io thread, which may still be reading ahead when the consumer stops iterating
+    struct StreamState final {
+        std::ifstream file;
+        std::array<std::vector<char>, 2> buffers{std::vector<char>(chunkSize), std::vector<char>(chunkSize)};
+        std::array<size_t, 2> sizes{};
+    };
+    auto state = std::make_shared<StreamState>();
+
+    auto submitRead = [this, &state, path = file_path](size_t index) {
+        auto submission = std::make_shared<io_operation_submission>();
+        submission->fn = [state, path, index](decltype(io_operation_submission::result) &res) {
+            INTERNAL_IO_DEBUG("submission->fn()");
+            if(!state->file.is_open()) {
+                state->file.open(path, std::ios::binary);
+
+                if(!state->file) {
+                    INTERNAL_IO_DEBUG("!file {} {}", errno, strerror(errno));
+                    res = tl::unexpected(mapErrnoToError(errno));
+                    return;
+                }
+            }
+
+            state->file.read(state->buffers[index].data(), static_cast<std::streamsize>(chunkSize));
+
+            if(state->file.bad()) {
+                res = tl::unexpected(IOError::IO_ERROR);
+                return;
+            }
+
+            state->sizes[index] = static_cast<size_t>(state->file.gcount());
+        };
+        submit(submission);
+        return submission;
+    };
+
+    // double buffered: the next chunk is read while the consumer handles the current one
+    auto current = submitRead(0);
+    co_await current->evt;
+
+    for(size_t index = 0; ; index = 1 - index) {
+        if(!current->result) {
+            co_yield tl::unexpected(current->result.error());
+            co_return {};
+        }
+
+        auto size = state->sizes[index];
+        if(size == 0) {
+            break;
+        }
+
+        auto next = submitRead(1 - index);
+        co_yield std::span<char const>{state->buffers[index].data(), size};
+        co_await next->evt;
+        current = std::move(next);
+    }
+
+    co_return {};
+}
+
+Ichor::Task<tl::expected<std::unique_ptr<Ichor::v1::IAsyncFile>, Ichor::v1::IOError>> Ichor::v1::SharedOverThreadsAsyncFileIO::open(std::filesystem::path const &file_path, FileOpenFlags flags) {
+    INTERNAL_IO_DEBUG("open()");
+
+    if((flags & (FileOpenFlags::READ | FileOpenFlags::WRITE)) == FileOpenFlags::NONE) {
+        co_return tl::unexpected(IOError::NOT_SUPPORTED);
+    }
+
+    auto submission = std::make_shared<io_operation_submission>();
+    NativeFile file = invalidFile();
+    submission->fn = [&file_path, flags, &file](decltype(io_operation_submission::result) &res) {
+        auto ret = openNative(file_path, flags);
+        if(!ret) {
+            INTERNAL_IO_DEBUG("openNative failed: {}", ret.error());
+            res = tl::unexpected(ret.error());
+            return;
+        }
+        file = *ret;
+    };
+    submit(submission);
+    INTERNAL_IO_DEBUG("co_await");
+    co_await submission->evt;
+
+    if(!submission->result) {
+        INTERNAL_IO_DEBUG("!result");
+        co_return tl::unexpected(submission->result.error());
+    }
+
+    co_return std::make_unique<AsyncFile>(_completions, file);
+}
+
 Ichor::Task<tl::expected<void, Ichor::v1::IOError>> Ichor::v1::SharedOverThreadsAsyncFileIO::copyFile(const std::filesystem::path &from, const std::filesystem::path &to) {
     INTERNAL_IO_DEBUG("copyFile()");
 
@@ -151,7 +703,7 @@ Ichor::Task<tl::expected<void, Ichor::v1::IOError>> Ichor::v1::SharedOverThreads
 #else
         struct stat stat;
         off_t len, ret;
-        int fd_in = open(from.c_str(), O_RDONLY | O_CLOEXEC);
+        int fd_in = ::open(from.c_str(), O_RDONLY | O_CLOEXEC);
         if (fd_in == -1) {
             INTERNAL_IO_DEBUG("open from errno {} {}", errno, strerror(errno));
             res = tl::unexpected(mapErrnoToError(errno));
@@ -169,7 +721,7 @@ Ichor::Task<tl::expected<void, Ichor::v1::IOError>> Ichor::v1::SharedOverThreads
 
         len = stat.st_size;
 
-        int fd_out = open(to.c_str(), O_CREAT | O_WRONLY | O_TRUNC | O_CLOEXEC, 0644);
+        int fd_out = ::open(to.c_str(), O_CREAT | O_WRONLY | O_TRUNC | O_CLOEXEC, 0644);
         if (fd_out == -1) {
             INTERNAL_IO_DEBUG("open to errno {} {}", errno, strerror(errno));
             res = tl::unexpected(mapErrnoToError(errno));
@@ -193,10 +745,7 @@ Ichor::Task<tl::expected<void, Ichor::v1::IOError>> Ichor::v1::SharedOverThreads
         INTERNAL_IO_DEBUG("submission->fn() copied bytes: {}", stat.st_size);
 #endif
     };
-    {
-        std::unique_lock lg{_io_mutex};
-        _evts.push(submission);
-    }
+    submit(submission);
     INTERNAL_IO_DEBUG("co_await");
     co_await submission->evt;
 
@@ -239,10 +788,7 @@ Ichor::Task<tl::expected<void, Ichor::v1::IOError>> Ichor::v1::SharedOverThreads
         }
 #endif
     };
-    {
-        std::unique_lock lg{_io_mutex};
-        _evts.push(submission);
-    }
+    submit(submission);
     INTERNAL_IO_DEBUG("co_await");
     co_await submission->evt;
 
@@ -273,10 +819,7 @@ Ichor::Task<tl::expected<void, Ichor::v1::IOError>> Ichor::v1::SharedOverThreads
         }
 #endif
     };
-    {
-        std::unique_lock lg{_io_mutex};
-        _evts.push(submission);
-    }
+    submit(submission);
     INTERNAL_IO_DEBUG("co_await");
     co_await submission->evt;
 
@@ -308,10 +851,7 @@ Ichor::Task<tl::expected<void, Ichor::v1::IOError>> Ichor::v1::SharedOverThreads
         }
 #endif
     };
-    {
-        std::unique_lock lg{_io_mutex};
-        _evts.push(submission);
-    }
+    submit(submission);
     INTERNAL_IO_DEBUG("co_await");
     co_await submission->evt;
 
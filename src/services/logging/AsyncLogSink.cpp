@@ -0,0 +1,288 @@
+#include <ichor/services/logging/AsyncLogSink.h>
+#include <fmt/format.h>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+#if (defined(WIN32) || defined(_WIN32) || defined(__WIN32)) && !defined(__CYGWIN__)
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/uio.h>
+#endif
+
+using namespace std::chrono_literals;
+
+namespace Ichor::v1::Detail {
+    // keeps the producer and writer owned halves of the ring from false sharing
+    constexpr size_t RING_ALIGNMENT = 64;
+
+    // Positions only ever increase, the index in the buffer is position & mask. head is only written by the producer, tail only by the writer thread.
+    struct AsyncLogRing final {
+        AsyncLogRing(uint64_t size, int fd_, bool ownsFd_, bool reportDrops_) : data(std::make_unique<char[]>(size)), mask(size - 1), fd(fd_), ownsFd(ownsFd_), reportDrops(reportDrops_) {
+        }
+
+        ~AsyncLogRing() {
+            if(ownsFd) {
+#if (defined(WIN32) || defined(_WIN32) || defined(__WIN32)) && !defined(__CYGWIN__)
+                ::_close(fd);
+#else
+                ::close(fd);
+#endif
+            }
+        }
+
+        AsyncLogRing(AsyncLogRing const &) = delete;
+        AsyncLogRing& operator=(AsyncLogRing const &) = delete;
+
+        bool tryPush(std::string_view line) noexcept {
+            auto const h = head.load(std::memory_order_relaxed);
+            auto const size = mask + 1;
+
+            if(h + line.size() - cachedTail > size) {
+                cachedTail = tail.load(std::memory_order_acquire);
+                if(h + line.size() - cachedTail > size) {
+                    return false;
+                }
+            }
+
+            auto const idx = h & mask;
+            auto const firstPart = std::min<uint64_t>(line.size(), size - idx);
+            std::memcpy(data.get() + idx, line.data(), firstPart);
+            std::memcpy(data.get(), line.data() + firstPart, line.size() - firstPart);
+            head.store(h + line.size(), std::memory_order_release);
+            return true;
+        }
+
+        std::unique_ptr<char[]> data;
+        uint64_t const mask;
+        int const fd;
+        bool const ownsFd;
+        bool const reportDrops;
+        alignas(RING_ALIGNMENT) std::atomic<uint64_t> head{};
+        // producer's last seen tail, prevents touching the writer's cache line on every push
+        uint64_t cachedTail{};
+        std::atomic<uint64_t> dropped{};
+        alignas(RING_ALIGNMENT) std::atomic<uint64_t> tail{};
+        uint64_t reportedDropped{};
+        uint64_t failedWrites{};
+    };
+}
+
+namespace {
+    using Ichor::v1::Detail::AsyncLogRing;
+
+    // without anything to write, check the rings this often
+    constexpr auto WRITER_IDLE_SLEEP = 1ms;
+    // consecutive write errors, roughly one WRITER_IDLE_SLEEP apart, before giving up on the data in a ring
+    constexpr uint64_t MAX_FAILED_WRITES = 100;
+
+    std::mutex writerMutex;
+    std::vector<std::shared_ptr<AsyncLogRing>> writerRings;
+    std::thread writerThread;
+    // per writer thread, a sink starting while the previous writer is being joined must not revive it
+    std::shared_ptr<std::atomic<bool>> writerShouldStop;
+
+    void writeAll(int fd, char const *data, size_t len) noexcept {
+        while(len > 0) {
+#if (defined(WIN32) || defined(_WIN32) || defined(__WIN32)) && !defined(__CYGWIN__)
+            auto ret = ::_write(fd, data, static_cast<unsigned int>(len));
+#else
+            auto ret = ::write(fd, data, len);
+#endif
+            if(ret < 0) {
+                if(errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+            data += ret;
+            len -= static_cast<size_t>(ret);
+        }
+    }
+
+    // returns amount of bytes handled, at most everything published at the time of calling
+    uint64_t drain(AsyncLogRing &ring) noexcept {
+        auto const dropped = ring.dropped.load(std::memory_order_relaxed);
+        if(ring.reportDrops && dropped != ring.reportedDropped) {
+            auto notice = fmt::format("[AsyncLogSink dropped {} lines]\n", dropped - ring.reportedDropped);
+            writeAll(ring.fd, notice.data(), notice.size());
+            ring.reportedDropped = dropped;
+        }
+
+        auto const t = ring.tail.load(std::memory_order_relaxed);
+        auto const h = ring.head.load(std::memory_order_acquire);
+        if(h == t) {
+            return 0;
+        }
+
+        auto const size = ring.mask + 1;
+        auto const idx = t & ring.mask;
+        auto const firstPart = std::min<uint64_t>(h - t, size - idx);
+        auto const secondPart = (h - t) - firstPart;
+
+#if (defined(WIN32) || defined(_WIN32) || defined(__WIN32)) && !defined(__CYGWIN__)
+        writeAll(ring.fd, ring.data.get() + idx, firstPart);
+        writeAll(ring.fd, ring.data.get(), secondPart);
+        uint64_t const written = h - t;
+#else
+        iovec iov[2]{};
+        iov[0].iov_base = ring.data.get() + idx;
+        iov[0].iov_len = firstPart;
+        iov[1].iov_base = ring.data.get();
+        iov[1].iov_len = secondPart;
+
+        auto ret = ::writev(ring.fd, iov, secondPart == 0 ? 1 : 2);
+        uint64_t written;
+        if(ret < 0) {
+            if(errno == EINTR || errno == EAGAIN) {
+                return 0;
+            }
+            // Nothing has been written, the error may be temporary, e.g. a full disk. Keep the data and try again next round.
+            if(++ring.failedWrites < MAX_FAILED_WRITES) {
+                return 0;
+            }
+            // Give up on what has been published so far, so blocking producers do not wait forever. Head is always at the end of a line or record, so the next write starts at a whole one.
+            ring.failedWrites = 0;
+            written = h - t;
+        } else {
+            ring.failedWrites = 0;
+            written = static_cast<uint64_t>(ret);
+        }
+#endif
+
+        ring.tail.store(t + written, std::memory_order_release);
+        return written;
+    }
+
+    void writerLoop(std::shared_ptr<std::atomic<bool>> shouldStop) {
+        while(true) {
+            bool const stopping = shouldStop->load(std::memory_order_acquire);
+            uint64_t written{};
+            {
+                std::lock_guard const lg{writerMutex};
+                for(auto &ring : writerRings) {
+                    written += drain(*ring);
+                }
+            }
+
+            if(written == 0) {
+                if(stopping) {
+                    break;
+                }
+                std::this_thread::sleep_for(WRITER_IDLE_SLEEP);
+            }
+        }
+    }
+}
+
+Ichor::v1::AsyncLogSink::AsyncLogSink(Properties props) : AdvancedService<AsyncLogSink>(std::move(props)) {
+    auto const &properties = getProperties();
+
+    if(auto propIt = properties.find("OverflowPolicy"); propIt != properties.end()) {
+        _policy = Ichor::v1::any_cast<AsyncLogOverflowPolicy>(propIt->second);
+    }
+    if(auto propIt = properties.find("RingSize"); propIt != properties.end()) {
+        _ringSize = std::bit_ceil(std::max<uint64_t>(Ichor::v1::any_cast<uint64_t>(propIt->second), 4096));
+    }
+    if(auto propIt = properties.find("LogFile"); propIt != properties.end()) {
+        _logFile = Ichor::v1::any_cast<std::string>(propIt->second);
+    }
+    if(auto propIt = properties.find("ReportDrops"); propIt != properties.end()) {
+        _reportDrops = Ichor::v1::any_cast<bool>(propIt->second);
+    }
+}
+
+Ichor::v1::AsyncLogSink::~AsyncLogSink() = default;
+
+Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::AsyncLogSink::start() {
+    int fd = 1;
+    if(!_logFile.empty()) {
+#if (defined(WIN32) || defined(_WIN32) || defined(__WIN32)) && !defined(__CYGWIN__)
+        fd = ::_open(_logFile.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+        fd = ::open(_logFile.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+#endif
+        if(fd < 0) {
+            fmt::println("AsyncLogSink couldn't open {}, errno {}", _logFile, errno);
+            co_return tl::unexpected(StartError::FAILED);
+        }
+    }
+
+    _ring = std::make_shared<Detail::AsyncLogRing>(_ringSize, fd, !_logFile.empty(), _reportDrops);
+
+    {
+        std::lock_guard const lg{writerMutex};
+        writerRings.push_back(_ring);
+
+        if(writerRings.size() == 1) {
+            writerShouldStop = std::make_shared<std::atomic<bool>>(false);
+            writerThread = std::thread(writerLoop, writerShouldStop);
+        }
+    }
+
+    co_return {};
+}
+
+Ichor::Task<void> Ichor::v1::AsyncLogSink::stop() {
+    // loggers depending on us are gone by now, wait until the writer caught up
+    while(_ring->tail.load(std::memory_order_acquire) != _ring->head.load(std::memory_order_relaxed)) {
+        std::this_thread::sleep_for(WRITER_IDLE_SLEEP);
+    }
+
+    std::thread toJoin;
+    {
+        std::lock_guard const lg{writerMutex};
+        std::erase(writerRings, _ring);
+
+        if(writerRings.empty()) {
+            writerShouldStop->store(true, std::memory_order_release);
+            writerShouldStop.reset();
+            toJoin = std::move(writerThread);
+        }
+    }
+
+    if(toJoin.joinable()) {
+        toJoin.join();
+    }
+
+    // report drops that happened after the last drain
+    drain(*_ring);
+    _ring.reset();
+
+    co_return;
+}
+
+bool Ichor::v1::AsyncLogSink::push(std::string_view line) noexcept {
+    if(!_ring) [[unlikely]] {
+        return false;
+    }
+
+    if(_ring->tryPush(line)) [[likely]] {
+        return true;
+    }
+
+    // a line larger than the ring would never fit
+    if(_policy == AsyncLogOverflowPolicy::BLOCK && line.size() <= _ring->mask + 1) {
+        do {
+            std::this_thread::yield();
+        } while(!_ring->tryPush(line));
+        return true;
+    }
+
+    _ring->dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+uint64_t Ichor::v1::AsyncLogSink::getDroppedCount() const noexcept {
+    if(!_ring) {
+        return 0;
+    }
+    return _ring->dropped.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,78 @@
+#include <ichor/services/logging/AsyncLogger.h>
+#include <ichor/dependency_management/DependencyRegister.h>
+#include <ichor/stl/StringUtils.h>
+#include <fmt/format.h>
+#define FMT_INLINE_BUFFER_SIZE 1024
+
+Ichor::v1::AsyncLogger::AsyncLogger(DependencyRegister &reg, Properties props) : AdvancedService(std::move(props)) {
+    reg.registerDependency<IAsyncLogSink>(this, DependencyFlags::REQUIRED);
+
+    if(auto const *logLevel = getProperties().get(PropertyKeys::LogLevel); logLevel != nullptr) {
+        setLogLevel(*logLevel);
+    }
+}
+
+void Ichor::v1::AsyncLogger::trace(const char *filename_in, int line_in, const char *,
+                                   std::string_view format_str, fmt::format_args args) {
+    ICHOR_CONTRACT_ASSERT(_level <= LogLevel::LOG_TRACE);
+    log(filename_in, line_in, format_str, args);
+}
+
+void Ichor::v1::AsyncLogger::debug(const char *filename_in, int line_in, const char *,
+                                   std::string_view format_str, fmt::format_args args) {
+    ICHOR_CONTRACT_ASSERT(_level <= LogLevel::LOG_DEBUG);
+    log(filename_in, line_in, format_str, args);
+}
+
+void Ichor::v1::AsyncLogger::info(const char *filename_in, int line_in, const char *,
+                                  std::string_view format_str, fmt::format_args args) {
+    ICHOR_CONTRACT_ASSERT(_level <= LogLevel::LOG_INFO);
+    log(filename_in, line_in, format_str, args);
+}
+
+void Ichor::v1::AsyncLogger::warn(const char *filename_in, int line_in, const char *,
+                                  std::string_view format_str, fmt::format_args args) {
+    ICHOR_CONTRACT_ASSERT(_level <= LogLevel::LOG_WARN);
+    log(filename_in, line_in, format_str, args);
+}
+
+void Ichor::v1::AsyncLogger::error(const char *filename_in, int line_in, const char *,
+                                   std::string_view format_str, fmt::format_args args) {
+    ICHOR_CONTRACT_ASSERT(_level <= LogLevel::LOG_ERROR);
+    log(filename_in, line_in, format_str, args);
+}
+
+void Ichor::v1::AsyncLogger::addDependencyInstance(Ichor::ScopedServiceProxy<IAsyncLogSink*> sink, IService&) noexcept {
+    _sink = std::move(sink);
+}
+
+void Ichor::v1::AsyncLogger::removeDependencyInstance(Ichor::ScopedServiceProxy<IAsyncLogSink*>, IService&) noexcept {
+    _sink.reset();
+}
+
+void Ichor::v1::AsyncLogger::setLogLevel(LogLevel level) noexcept {
+    _level = level;
+}
+
+Ichor::LogLevel Ichor::v1::AsyncLogger::getLogLevel() const noexcept {
+    return _level;
+}
+
+void Ichor::v1::AsyncLogger::log([[maybe_unused]] const char *filename_in, [[maybe_unused]] int line_in, std::string_view format_str, fmt::format_args args) {
+#if defined(ICHOR_USE_HARDENING) || defined(ICHOR_ENABLE_INTERNAL_DEBUGGING)
+    if(_sink == nullptr) {
+        std::terminate();
+    }
+#endif
+
+    fmt::basic_memory_buffer<char, FMT_INLINE_BUFFER_SIZE> buf{};
+#ifndef ICHOR_REMOVE_SOURCE_NAMES_FROM_LOGGING
+    if(filename_in != nullptr) {
+        const char *base = Ichor::v1::basename(filename_in);
+        fmt::vformat_to(std::back_inserter(buf), "[{}:{}] ", fmt::make_format_args(base, line_in));
+    }
+#endif
+    fmt::vformat_to(std::back_inserter(buf), format_str, args);
+    buf.push_back('\n');
+    _sink->push(std::string_view{buf.data(), buf.size()});
+}
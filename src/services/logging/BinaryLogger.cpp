@@ -0,0 +1,305 @@
+#include <ichor/services/logging/BinaryLogger.h>
+#include <ichor/dependency_management/DependencyRegister.h>
+#include <ichor/stl/StringUtils.h>
+#include <fmt/format.h>
+#include <fmt/args.h>
+#include <chrono>
+#include <cstring>
+#include <type_traits>
+#define FMT_INLINE_BUFFER_SIZE 512
+
+namespace {
+    using RecordBuffer = fmt::basic_memory_buffer<char, FMT_INLINE_BUFFER_SIZE>;
+
+    template <typename T>
+    void append(RecordBuffer &buf, T val) noexcept {
+        static_assert(std::is_trivially_copyable_v<T>);
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &val, sizeof(T));
+        buf.append(bytes, bytes + sizeof(T));
+    }
+
+    template <typename SizeT>
+    void appendString(RecordBuffer &buf, std::string_view str) noexcept {
+        auto const size = std::min<size_t>(str.size(), std::numeric_limits<SizeT>::max());
+        append(buf, static_cast<SizeT>(size));
+        buf.append(str.data(), str.data() + size);
+    }
+
+    struct ArgEncoder final {
+        template <typename T>
+        void operator()(T val) {
+            using Ichor::v1::BinaryLogArgType;
+            using U = std::remove_cvref_t<T>;
+
+            if constexpr (std::is_same_v<U, bool>) {
+                append(buf, BinaryLogArgType::BOOL);
+                append(buf, static_cast<uint8_t>(val));
+            } else if constexpr (std::is_same_v<U, char>) {
+                append(buf, BinaryLogArgType::CHAR);
+                append(buf, val);
+            } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U> && sizeof(U) <= sizeof(int64_t)) {
+                append(buf, BinaryLogArgType::INT64);
+                append(buf, static_cast<int64_t>(val));
+            } else if constexpr (std::is_integral_v<U> && std::is_unsigned_v<U> && sizeof(U) <= sizeof(uint64_t)) {
+                append(buf, BinaryLogArgType::UINT64);
+                append(buf, static_cast<uint64_t>(val));
+            } else if constexpr (std::is_floating_point_v<U>) {
+                append(buf, BinaryLogArgType::DOUBLE);
+                append(buf, static_cast<double>(val));
+            } else if constexpr (std::is_same_v<U, char const *>) {
+                append(buf, BinaryLogArgType::STRING);
+                appendString<uint32_t>(buf, val == nullptr ? std::string_view{} : std::string_view{val});
+            } else if constexpr (std::is_same_v<U, fmt::basic_string_view<char>>) {
+                append(buf, BinaryLogArgType::STRING);
+                appendString<uint32_t>(buf, std::string_view{val.data(), val.size()});
+            } else if constexpr (std::is_same_v<U, void const *>) {
+                append(buf, BinaryLogArgType::POINTER);
+                append(buf, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(val)));
+            } else {
+                // user defined formatters and 128 bit integers
+                unsupported = true;
+            }
+        }
+
+        RecordBuffer &buf;
+        bool unsupported{};
+    };
+
+    // returns false if any of the arguments has to be formatted by fmt itself
+    bool encodeArgs(RecordBuffer &buf, fmt::format_args args) {
+        auto const countOffset = buf.size();
+        append(buf, uint8_t{});
+
+        ArgEncoder encoder{buf};
+        uint8_t count{};
+        for(int i = 0; count < std::numeric_limits<uint8_t>::max(); i++) {
+            auto arg = args.get(i);
+            if(!arg) {
+                break;
+            }
+#if FMT_VERSION >= 110000
+            arg.visit(encoder);
+#else
+            fmt::visit_format_arg(encoder, arg);
+#endif
+            if(encoder.unsupported) {
+                return false;
+            }
+            count++;
+        }
+
+        buf[countOffset] = static_cast<char>(count);
+        return true;
+    }
+
+    template <typename T>
+    bool read(std::span<char const> &data, T &val) noexcept {
+        if(data.size() < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&val, data.data(), sizeof(T));
+        data = data.subspan(sizeof(T));
+        return true;
+    }
+
+    template <typename SizeT>
+    bool readString(std::span<char const> &data, std::string_view &str) noexcept {
+        SizeT size{};
+        if(!read(data, size) || data.size() < size) {
+            return false;
+        }
+        str = std::string_view{data.data(), size};
+        data = data.subspan(size);
+        return true;
+    }
+}
+
+Ichor::v1::BinaryLogger::BinaryLogger(DependencyRegister &reg, Properties props) : AdvancedService(std::move(props)) {
+    reg.registerDependency<IAsyncLogSink>(this, DependencyFlags::REQUIRED);
+
+    if(auto const *logLevel = getProperties().get(PropertyKeys::LogLevel); logLevel != nullptr) {
+        setLogLevel(*logLevel);
+    }
+}
+
+void Ichor::v1::BinaryLogger::trace(const char *filename_in, int line_in, const char *,
+                                    std::string_view format_str, fmt::format_args args) {
+    ICHOR_CONTRACT_ASSERT(_level <= LogLevel::LOG_TRACE);
+    log(LogLevel::LOG_TRACE, filename_in, line_in, format_str, args);
+}
+
+void Ichor::v1::BinaryLogger::debug(const char *filename_in, int line_in, const char *,
+                                    std::string_view format_str, fmt::format_args args) {
+    ICHOR_CONTRACT_ASSERT(_level <= LogLevel::LOG_DEBUG);
+    log(LogLevel::LOG_DEBUG, filename_in, line_in, format_str, args);
+}
+
+void Ichor::v1::BinaryLogger::info(const char *filename_in, int line_in, const char *,
+                                   std::string_view format_str, fmt::format_args args) {
+    ICHOR_CONTRACT_ASSERT(_level <= LogLevel::LOG_INFO);
+    log(LogLevel::LOG_INFO, filename_in, line_in, format_str, args);
+}
+
+void Ichor::v1::BinaryLogger::warn(const char *filename_in, int line_in, const char *,
+                                   std::string_view format_str, fmt::format_args args) {
+    ICHOR_CONTRACT_ASSERT(_level <= LogLevel::LOG_WARN);
+    log(LogLevel::LOG_WARN, filename_in, line_in, format_str, args);
+}
+
+void Ichor::v1::BinaryLogger::error(const char *filename_in, int line_in, const char *,
+                                    std::string_view format_str, fmt::format_args args) {
+    ICHOR_CONTRACT_ASSERT(_level <= LogLevel::LOG_ERROR);
+    log(LogLevel::LOG_ERROR, filename_in, line_in, format_str, args);
+}
+
+void Ichor::v1::BinaryLogger::addDependencyInstance(Ichor::ScopedServiceProxy<IAsyncLogSink*> sink, IService&) noexcept {
+    _sink = std::move(sink);
+}
+
+void Ichor::v1::BinaryLogger::removeDependencyInstance(Ichor::ScopedServiceProxy<IAsyncLogSink*>, IService&) noexcept {
+    _sink.reset();
+}
+
+void Ichor::v1::BinaryLogger::setLogLevel(LogLevel level) noexcept {
+    _level = level;
+}
+
+Ichor::LogLevel Ichor::v1::BinaryLogger::getLogLevel() const noexcept {
+    return _level;
+}
+
+void Ichor::v1::BinaryLogger::log(LogLevel level, [[maybe_unused]] const char *filename_in, int line_in, std::string_view format_str, fmt::format_args args) {
+#if defined(ICHOR_USE_HARDENING) || defined(ICHOR_ENABLE_INTERNAL_DEBUGGING)
+    if(_sink == nullptr) {
+        std::terminate();
+    }
+#endif
+
+    std::string_view filename{};
+#ifndef ICHOR_REMOVE_SOURCE_NAMES_FROM_LOGGING
+    if(filename_in != nullptr) {
+        filename = Ichor::v1::basename(filename_in);
+    }
+#endif
+
+    RecordBuffer buf{};
+    append(buf, uint32_t{});
+    append(buf, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count()));
+    append(buf, static_cast<uint8_t>(level));
+    append(buf, static_cast<uint32_t>(line_in));
+    appendString<uint16_t>(buf, filename);
+    auto const formatOffset = buf.size();
+    appendString<uint16_t>(buf, format_str);
+
+    if(!encodeArgs(buf, args)) {
+        buf.resize(formatOffset);
+        appendString<uint16_t>(buf, "{}");
+        append(buf, uint8_t{1});
+        append(buf, BinaryLogArgType::STRING);
+        auto const sizeOffset = buf.size();
+        append(buf, uint32_t{});
+        fmt::vformat_to(std::back_inserter(buf), format_str, args);
+        auto const size = static_cast<uint32_t>(buf.size() - sizeOffset - sizeof(uint32_t));
+        std::memcpy(buf.data() + sizeOffset, &size, sizeof(size));
+    }
+
+    auto const recordSize = static_cast<uint32_t>(buf.size());
+    std::memcpy(buf.data(), &recordSize, sizeof(recordSize));
+    _sink->push(std::string_view{buf.data(), buf.size()});
+}
+
+tl::expected<uint64_t, Ichor::v1::BinaryLogDecodeError> Ichor::v1::decodeBinaryLog(std::span<char const> data, std::function<void(DecodedLogRecord const &)> const &fn) {
+    uint64_t consumed{};
+    DecodedLogRecord record{};
+    fmt::dynamic_format_arg_store<fmt::format_context> store;
+
+    while(true) {
+        auto remaining = data.subspan(consumed);
+        uint32_t recordSize{};
+        if(!read(remaining, recordSize) || remaining.size() + sizeof(recordSize) < recordSize) {
+            // partially written, or the end
+            break;
+        }
+        if(recordSize < sizeof(recordSize)) {
+            return tl::unexpected(BinaryLogDecodeError::MALFORMED_RECORD);
+        }
+
+        auto recordData = remaining.subspan(0, recordSize - sizeof(recordSize));
+        uint8_t level{};
+        std::string_view format{};
+        uint8_t argCount{};
+        if(!read(recordData, record.timestampNs) || !read(recordData, level) || !read(recordData, record.line) ||
+           !readString<uint16_t>(recordData, record.filename) || !readString<uint16_t>(recordData, format) || !read(recordData, argCount) ||
+           level > static_cast<uint8_t>(LogLevel::LOG_ERROR)) {
+            return tl::unexpected(BinaryLogDecodeError::MALFORMED_RECORD);
+        }
+        record.level = static_cast<LogLevel>(level);
+
+        store.clear();
+        for(uint8_t i = 0; i < argCount; i++) {
+            BinaryLogArgType type{};
+            if(!read(recordData, type)) {
+                return tl::unexpected(BinaryLogDecodeError::MALFORMED_RECORD);
+            }
+
+            bool ok{};
+            switch(type) {
+                case BinaryLogArgType::INT64: {
+                    int64_t val{};
+                    ok = read(recordData, val);
+                    store.push_back(val);
+                    break;
+                }
+                case BinaryLogArgType::UINT64: {
+                    uint64_t val{};
+                    ok = read(recordData, val);
+                    store.push_back(val);
+                    break;
+                }
+                case BinaryLogArgType::BOOL: {
+                    uint8_t val{};
+                    ok = read(recordData, val);
+                    store.push_back(val != 0);
+                    break;
+                }
+                case BinaryLogArgType::CHAR: {
+                    char val{};
+                    ok = read(recordData, val);
+                    store.push_back(val);
+                    break;
+                }
+                case BinaryLogArgType::DOUBLE: {
+                    double val{};
+                    ok = read(recordData, val);
+                    store.push_back(val);
+                    break;
+                }
+                case BinaryLogArgType::STRING: {
+                    std::string_view val{};
+                    ok = readString<uint32_t>(recordData, val);
+                    store.push_back(fmt::string_view{val.data(), val.size()});
+                    break;
+                }
+                case BinaryLogArgType::POINTER: {
+                    uint64_t val{};
+                    ok = read(recordData, val);
+                    store.push_back(reinterpret_cast<void const *>(static_cast<uintptr_t>(val)));
+                    break;
+                }
+                default:
+                    return tl::unexpected(BinaryLogDecodeError::UNKNOWN_ARGUMENT_TYPE);
+            }
+
+            if(!ok) {
+                return tl::unexpected(BinaryLogDecodeError::MALFORMED_RECORD);
+            }
+        }
+
+        record.message = fmt::vformat(fmt::string_view{format.data(), format.size()}, store);
+        fn(record);
+        consumed += recordSize;
+    }
+
+    return consumed;
+}
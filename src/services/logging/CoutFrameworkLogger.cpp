@@ -1,13 +1,13 @@
 #include <ichor/services/logging/CoutFrameworkLogger.h>
+#include <ichor/services/logging/Logger.h>
 #include <ichor/stl/StringUtils.h>
 #include <fmt/format.h>
 #include <iostream>
 #define FMT_INLINE_BUFFER_SIZE 1024
 
 Ichor::v1::CoutFrameworkLogger::CoutFrameworkLogger() : IFrameworkLogger(), AdvancedService(), _level(LogLevel::LOG_WARN) {
-    auto logLevelProp = getProperties().find("LogLevel");
-    if(logLevelProp != end(getProperties())) {
-        setLogLevel(Ichor::v1::any_cast<LogLevel>(logLevelProp->second));
+    if(auto const *logLevel = getProperties().get(PropertyKeys::LogLevel); logLevel != nullptr) {
+        setLogLevel(*logLevel);
     }
 
     // preventing a warnig on -Wnonnull-compare
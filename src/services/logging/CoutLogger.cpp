@@ -5,9 +5,8 @@
 #define FMT_INLINE_BUFFER_SIZE 1024
 
 Ichor::v1::CoutLogger::CoutLogger(Properties props) : AdvancedService(std::move(props)) {
-    auto logLevelProp = getProperties().find("LogLevel");
-    if(logLevelProp != end(getProperties())) {
-        setLogLevel(Ichor::v1::any_cast<LogLevel>(logLevelProp->second));
+    if(auto const *logLevel = getProperties().get(PropertyKeys::LogLevel); logLevel != nullptr) {
+        setLogLevel(*logLevel);
     }
 }
 
@@ -4,6 +4,7 @@
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <ichor/services/logging/SpdlogFrameworkLogger.h>
+#include <ichor/services/logging/Logger.h>
 
 
 namespace Ichor {
@@ -42,9 +43,8 @@ Ichor::v1::SpdlogFrameworkLogger::SpdlogFrameworkLogger(Properties props) : Adva
         // spinlock
     }
 
-    auto logLevelProp = getProperties().find("LogLevel");
-    if(logLevelProp != end(getProperties())) {
-        setLogLevel(Ichor::v1::any_cast<LogLevel>(logLevelProp->second));
+    if(auto const *logLevel = getProperties().get(PropertyKeys::LogLevel); logLevel != nullptr) {
+        setLogLevel(*logLevel);
     }
 
     SPDLOG_TRACE("SpdlogFrameworkLogger constructor");
@@ -8,9 +8,8 @@
 Ichor::v1::SpdlogLogger::SpdlogLogger(DependencyRegister &reg, Properties props) : AdvancedService(std::move(props)) {
     reg.registerDependency<ISpdlogSharedService>(this, DependencyFlags::REQUIRED);
 
-    auto logLevelProp = getProperties().find("LogLevel");
-    if(logLevelProp != end(getProperties())) {
-        setLogLevel(Ichor::v1::any_cast<LogLevel>(logLevelProp->second));
+    if(auto const *logLevel = getProperties().get(PropertyKeys::LogLevel); logLevel != nullptr) {
+        setLogLevel(*logLevel);
     }
 }
 
@@ -102,9 +101,8 @@ Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::SpdlogLogger::star
     static_cast<spdlog::logger*>(_logger)->set_pattern("[%C-%m-%d %H:%M:%S.%e] [%L] %v");
 #endif
 
-    auto requestedLevelIt = _properties.find("LogLevel");
-    if(requestedLevelIt != end(_properties)) {
-        _level = Ichor::v1::any_cast<LogLevel>(requestedLevelIt->second);
+    if(auto const *requestedLevel = _properties.get(PropertyKeys::LogLevel); requestedLevel != nullptr) {
+        _level = *requestedLevel;
     } else {
         _level = LogLevel::LOG_INFO;
     }
@@ -1,8 +1,14 @@
 #include <ichor/services/metrics/EventStatisticsService.h>
 #include <ichor/DependencyManager.h>
-#include <numeric>
 #include <ichor/ScopedServiceProxy.h>
 
+namespace {
+    Ichor::v1::EventStatisticSummary summarize(Ichor::v1::EventStatisticKey const &key, std::string_view eventName, Ichor::v1::LatencyHistogram const &histogram) {
+        return Ichor::v1::EventStatisticSummary{key, eventName, histogram.count(), histogram.min(), histogram.valueAtPercentile(50.), histogram.valueAtPercentile(99.),
+                                                histogram.valueAtPercentile(99.9), histogram.max(), histogram.mean()};
+    }
+}
+
 Ichor::v1::EventStatisticsService::EventStatisticsService(DependencyRegister &reg, Properties props) : AdvancedService<EventStatisticsService>(std::move(props)) {
     reg.registerDependency<ITimerFactory>(this, DependencyFlags::REQUIRED);
     reg.registerDependency<ILogger>(this, DependencyFlags::REQUIRED);
@@ -18,14 +24,11 @@ Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::EventStatisticsSer
         _averagingIntervalMs = Ichor::v1::any_cast<uint64_t>(propIt->second);
     }
 
-//    fmt::print("evt stats {}:{} {} {}\n", getServiceId(), getServiceName(), _showStatisticsOnStop, _averagingIntervalMs);
-
     auto timer = _timerFactory->createTimer();
     timer.setChronoInterval(std::chrono::milliseconds(_averagingIntervalMs));
 
-    timer.setCallbackAsync([this]() -> AsyncGenerator<IchorBehaviour> {
-        calculateAverage();
-        co_return {};
+    timer.setCallback([this]() {
+        finishInterval();
     });
 
     _interceptorRegistration = GetThreadLocalManager().registerEventInterceptor<Event>(this, this);
@@ -44,24 +47,17 @@ Ichor::Task<void> Ichor::v1::EventStatisticsService::stop() {
         std::terminate();
     }
 
-    int64_t total_occ{};
-
     if(_showStatisticsOnStop) {
-        // handle last bit of stored statistics by emulating a handleEvent call
-        calculateAverage();
-
-        for(auto &[key, statistics] : _averagedStatistics) {
-            if(statistics.empty()) {
-                continue;
-            }
+        // include the unfinished interval
+        finishInterval();
 
-            auto min = std::min_element(begin(statistics), end(statistics), [](const AveragedStatisticEntry &a, const AveragedStatisticEntry &b){return a.minProcessingTimeRequired < b.minProcessingTimeRequired; })->minProcessingTimeRequired;
-            auto max = std::max_element(begin(statistics), end(statistics), [](const AveragedStatisticEntry &a, const AveragedStatisticEntry &b){return a.maxProcessingTimeRequired < b.maxProcessingTimeRequired; })->maxProcessingTimeRequired;
-            auto avg = std::accumulate(begin(statistics), end(statistics), 0L, [](int64_t i, const AveragedStatisticEntry &entry) -> int64_t { return i + entry.avgProcessingTimeRequired; }) / static_cast<int64_t>(statistics.size());
-            auto occ = std::accumulate(begin(statistics), end(statistics), 0L, [](int64_t i, const AveragedStatisticEntry &entry){ return i + entry.occurrences; });
-            total_occ += occ;
+        uint64_t total_occ{};
+        for(auto const &summary : getTotalStatistics()) {
+            total_occ += summary.occurrences;
 
-            ICHOR_LOG_ERROR(_logger, "Dm {:L} Event type {} occurred {:L} times, min/max/avg processing: {:L}/{:L}/{:L} ns", GetThreadLocalManager().getId(), _eventTypeToNameMapper[key], occ, min, max, avg);
+            ICHOR_LOG_ERROR(_logger, "Dm {:L} Event type {} from svc {} occurred {:L} times, min/p50/p99/p999/max/avg processing: {:L}/{:L}/{:L}/{:L}/{:L}/{:L} ns", GetThreadLocalManager().getId(), summary.eventName,
+                            summary.key.originatingService, summary.occurrences, summary.minProcessingTimeNs, summary.p50ProcessingTimeNs, summary.p99ProcessingTimeNs, summary.p999ProcessingTimeNs,
+                            summary.maxProcessingTimeNs, summary.avgProcessingTimeNs);
         }
         ICHOR_LOG_ERROR(_logger, "Dm {:L} total events caught: {}", GetThreadLocalManager().getId(), total_occ);
     }
@@ -69,14 +65,9 @@ Ichor::Task<void> Ichor::v1::EventStatisticsService::stop() {
     co_return;
 }
 
-bool Ichor::v1::EventStatisticsService::preInterceptEvent(Event const &evt) {
+bool Ichor::v1::EventStatisticsService::preInterceptEvent(Event const &) {
     _startProcessingTimestamp = std::chrono::steady_clock::now();
 
-    auto evtType = evt.get_type();
-    if(!_eventTypeToNameMapper.contains(evtType)) {
-        _eventTypeToNameMapper.emplace(evtType, evt.get_name());
-    }
-
     return (bool)AllowOthersHandling;
 }
 
@@ -85,29 +76,15 @@ void Ichor::v1::EventStatisticsService::postInterceptEvent(Event const &evt, boo
         return;
     }
 
-    auto now = std::chrono::steady_clock::now();
-    auto processingTime = now - _startProcessingTimestamp;
-    auto evtType = evt.get_type();
-    auto statistics = _recentEventStatistics.find(evtType);
+    auto processingTime = std::chrono::steady_clock::now() - _startProcessingTimestamp;
+    EventStatisticKey const key{evt.get_type(), evt.originatingService};
+    auto statistics = _statistics.find(key);
 
-    if(statistics == end(_recentEventStatistics)) {
-        _recentEventStatistics.emplace(evtType, std::vector<StatisticEntry>{{StatisticEntry{
-            std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count(),
-            std::chrono::duration_cast<std::chrono::nanoseconds>(processingTime).count()}}});
-    } else {
-        statistics->second.emplace_back(
-                std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count(),
-                std::chrono::duration_cast<std::chrono::nanoseconds>(processingTime).count());
+    if(statistics == end(_statistics)) [[unlikely]] {
+        statistics = _statistics.emplace(key, std::make_unique<EventStatistics>(evt.get_name())).first;
     }
 
-    if(processingTime > 1ms) {
-        fmt::println("LONG EVENT {} {}", evt.get_name(), evt.originatingService);
-        if(evt.originatingService != ServiceIdType{0}) {
-            auto &dm = GetThreadLocalManager();
-            auto svc = dm.getIService(evt.originatingService);
-            fmt::println("SVC {}", (*svc)->getServiceName());
-        }
-    }
+    statistics->second->current.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(processingTime).count()));
 }
 
 void Ichor::v1::EventStatisticsService::addDependencyInstance(Ichor::ScopedServiceProxy<ILogger*> logger, IService &) {
@@ -126,35 +103,56 @@ void Ichor::v1::EventStatisticsService::removeDependencyInstance(Ichor::ScopedSe
     _timerFactory = nullptr;
 }
 
-void Ichor::v1::EventStatisticsService::calculateAverage() {
-    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
-    decltype(_recentEventStatistics) newVec{};
-    newVec.swap(_recentEventStatistics);
-    _recentEventStatistics.clear();
+void Ichor::v1::EventStatisticsService::finishInterval() {
+    auto &dm = GetThreadLocalManager();
+
+    // Service ids are never reused, so a removed service cannot add to its entries anymore. Drop them once they have been idle for an interval.
+    // Id 0 and services of other managers are not known here, but keep seeing events, so they are only dropped after an idle interval as well.
+    std::erase_if(_statistics, [&dm](auto const &entry) {
+        return entry.second->current.count() == 0 && entry.first.originatingService != ServiceIdType{0} && !dm.getIService(entry.first.originatingService);
+    });
+
+    for(auto &[key, statistics] : _statistics) {
+        statistics->total.merge(statistics->current);
+        statistics->lastInterval = statistics->current;
+        statistics->current.reset();
+    }
+}
+
+std::vector<Ichor::v1::EventStatisticSummary> Ichor::v1::EventStatisticsService::getTotalStatistics() const {
+    std::vector<EventStatisticSummary> ret;
+    ret.reserve(_statistics.size());
 
-    for(auto &[key, statistics] : newVec) {
-        if(statistics.empty()) {
+    for(auto const &[key, statistics] : _statistics) {
+        if(statistics->total.count() == 0) {
             continue;
         }
+        ret.emplace_back(summarize(key, statistics->eventName, statistics->total));
+    }
 
-        auto avgStatistics = _averagedStatistics.find(key);
+    return ret;
+}
 
-        auto min = std::min_element(begin(statistics), end(statistics), [](const StatisticEntry &a, const StatisticEntry &b){return a.processingTimeRequired < b.processingTimeRequired; })->processingTimeRequired;
-        auto max = std::max_element(begin(statistics), end(statistics), [](const StatisticEntry &a, const StatisticEntry &b){return a.processingTimeRequired < b.processingTimeRequired; })->processingTimeRequired;
-        auto avg = std::accumulate(begin(statistics), end(statistics), 0L, [](int64_t i, const StatisticEntry &entry){ return i + entry.processingTimeRequired; }) / static_cast<int64_t>(statistics.size());
+std::vector<Ichor::v1::EventStatisticSummary> Ichor::v1::EventStatisticsService::getLastIntervalStatistics() const {
+    std::vector<EventStatisticSummary> ret;
+    ret.reserve(_statistics.size());
 
-        if(avgStatistics == end(_averagedStatistics)) {
-            _averagedStatistics.emplace(key, std::vector<AveragedStatisticEntry>{{AveragedStatisticEntry{now, min, max, avg, static_cast<int64_t>(statistics.size())}}});
-        } else {
-            avgStatistics->second.emplace_back(now, min, max, avg, statistics.size());
+    for(auto const &[key, statistics] : _statistics) {
+        if(statistics->lastInterval.count() == 0) {
+            continue;
         }
+        ret.emplace_back(summarize(key, statistics->eventName, statistics->lastInterval));
     }
-}
 
-const Ichor::unordered_map<uint64_t, std::vector<Ichor::v1::StatisticEntry>> &Ichor::v1::EventStatisticsService::getRecentStatistics() const noexcept {
-    return _recentEventStatistics;
+    return ret;
 }
 
-const Ichor::unordered_map<uint64_t, std::vector<Ichor::v1::AveragedStatisticEntry>> &Ichor::v1::EventStatisticsService::getAverageStatistics() const noexcept {
-    return _averagedStatistics;
+Ichor::v1::LatencyHistogram const * Ichor::v1::EventStatisticsService::getTotalHistogram(EventStatisticKey const &key) const noexcept {
+    auto statistics = _statistics.find(key);
+
+    if(statistics == end(_statistics)) {
+        return nullptr;
+    }
+
+    return &statistics->second->total;
 }
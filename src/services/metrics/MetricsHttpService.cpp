@@ -0,0 +1,31 @@
+#include <ichor/services/metrics/MetricsHttpService.h>
+#include <ichor/services/metrics/MetricsRegistryService.h>
+#include <ichor/dependency_management/DependencyRegister.h>
+
+Ichor::v1::MetricsHttpService::MetricsHttpService(DependencyRegister &reg, Properties props) : AdvancedService<MetricsHttpService>(std::move(props)) {
+    reg.registerDependency<IHttpHostService>(this, DependencyFlags::REQUIRED | DependencyFlags::ALLOW_MULTIPLE);
+
+    if(auto propIt = getProperties().find("Route"); propIt != getProperties().end()) {
+        _route = Ichor::v1::any_cast<std::string>(propIt->second);
+    }
+}
+
+Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::MetricsHttpService::start() {
+    co_return {};
+}
+
+Ichor::Task<void> Ichor::v1::MetricsHttpService::stop() {
+    _routeRegistrations.clear();
+    co_return;
+}
+
+void Ichor::v1::MetricsHttpService::addDependencyInstance(Ichor::ScopedServiceProxy<IHttpHostService*> host, IService &isvc) {
+    _routeRegistrations.emplace(isvc.getServiceId(), host->addRoute(HttpMethod::get, _route, [](HttpRequest &) -> Task<HttpResponse> {
+        auto text = formatMetricsText();
+        co_return HttpResponse{HttpStatus::ok, "text/plain; version=0.0.4; charset=utf-8", std::vector<uint8_t>{text.begin(), text.end()}, {}};
+    }));
+}
+
+void Ichor::v1::MetricsHttpService::removeDependencyInstance(Ichor::ScopedServiceProxy<IHttpHostService*>, IService &isvc) {
+    _routeRegistrations.erase(isvc.getServiceId());
+}
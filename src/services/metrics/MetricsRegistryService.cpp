@@ -0,0 +1,329 @@
+#include <ichor/services/metrics/MetricsRegistryService.h>
+#include <ichor/services/metrics/MemoryUsageFunctions.h>
+#include <ichor/DependencyManager.h>
+#include <ichor/ScopedServiceProxy.h>
+#ifdef ICHOR_USE_LIBURING
+#include <ichor/event_queues/IIOUringQueue.h>
+#include <ichor/ichor_liburing.h>
+#endif
+#include <fmt/format.h>
+#include <algorithm>
+#include <map>
+
+namespace {
+    std::mutex registriesMutex{};
+    std::vector<Ichor::v1::MetricsRegistryService const *> registries{};
+
+    constexpr std::array<std::string_view, 7> SERVICE_STATE_NAMES{"uninstalled", "installed", "injecting", "starting", "active", "uninjecting", "stopping"};
+
+    void appendEscaped(std::string &out, std::string_view str, bool escapeQuotes) {
+        for(char c : str) {
+            if(c == '\\') {
+                out += "\\\\";
+            } else if(c == '\n') {
+                out += "\\n";
+            } else if(c == '"' && escapeQuotes) {
+                out += "\\\"";
+            } else {
+                out += c;
+            }
+        }
+    }
+
+    std::string renderLabels(std::span<Ichor::v1::MetricLabel const> labels) {
+        std::string ret;
+        if(labels.empty()) {
+            return ret;
+        }
+        ret += '{';
+        for(auto const &label : labels) {
+            if(ret.size() > 1) {
+                ret += ',';
+            }
+            ret += label.name;
+            ret += "=\"";
+            appendEscaped(ret, label.value, true);
+            ret += '"';
+        }
+        ret += '}';
+        return ret;
+    }
+
+    // the rendered labels of a series with one label added, used for the le label of histogram buckets
+    std::string withLabel(std::string_view labels, std::string_view name, std::string_view value) {
+        std::string ret;
+        if(labels.empty()) {
+            ret += '{';
+        } else {
+            ret += labels.substr(0, labels.size() - 1);
+            ret += ',';
+        }
+        ret += name;
+        ret += "=\"";
+        ret += value;
+        ret += "\"}";
+        return ret;
+    }
+
+    std::string_view metricTypeName(Ichor::v1::MetricType type) {
+        switch(type) {
+            case Ichor::v1::MetricType::COUNTER:
+                return "counter";
+            case Ichor::v1::MetricType::GAUGE:
+                return "gauge";
+            case Ichor::v1::MetricType::HISTOGRAM:
+                return "histogram";
+        }
+        return "untyped";
+    }
+
+    struct AggregatedSeries final {
+        int64_t value{};
+        std::vector<uint64_t> upperBounds{};
+        std::vector<uint64_t> bucketCounts{};
+        uint64_t sum{};
+        bool initialized{};
+    };
+
+    struct AggregatedFamily final {
+        std::string_view help;
+        Ichor::v1::MetricType type;
+        std::map<std::string_view, AggregatedSeries> series;
+    };
+}
+
+Ichor::v1::MetricsRegistryService::MetricsRegistryService(DependencyRegister &reg, Properties props) : AdvancedService<MetricsRegistryService>(std::move(props)) {
+    reg.registerDependency<ITimerFactory>(this, DependencyFlags::REQUIRED);
+}
+
+Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::MetricsRegistryService::start() {
+    if(auto propIt = getProperties().find("SampleIntervalMs"); propIt != getProperties().end()) {
+        _sampleIntervalMs = Ichor::v1::any_cast<uint64_t>(propIt->second);
+    }
+    if(auto propIt = getProperties().find("CountEvents"); propIt != getProperties().end()) {
+        _countEvents = Ichor::v1::any_cast<bool>(propIt->second);
+    }
+
+    _queueSize = &gauge("ichor_event_queue_size", "Events waiting in the queue");
+    _coroutines = &gauge("ichor_suspended_coroutines", "Coroutines waiting to be resumed");
+    for(size_t i = 0; i < _serviceStates.size(); i++) {
+        std::array<MetricLabel, 1> labels{MetricLabel{"state", SERVICE_STATE_NAMES[i]}};
+        _serviceStates[i] = &gauge("ichor_services", "Services per lifecycle state", labels);
+    }
+#ifdef ICHOR_USE_LIBURING
+    if(dynamic_cast<IIOUringQueue*>(&GetThreadLocalEventQueue()) != nullptr) {
+        _sqEntries = &gauge("ichor_io_uring_sq_entries", "Size of the io_uring submission queue");
+        _sqInUse = &gauge("ichor_io_uring_sq_entries_in_use", "Submission queue entries not yet submitted to the kernel");
+        _cqReady = &gauge("ichor_io_uring_cq_ready", "Completion queue entries waiting to be processed");
+    }
+#endif
+
+    if(_countEvents) {
+        _interceptorRegistration = GetThreadLocalManager().registerEventInterceptor<Event>(this, this);
+    }
+
+    auto timer = _timerFactory->createTimer();
+    timer.setChronoInterval(std::chrono::milliseconds(_sampleIntervalMs));
+    timer.setCallback([this]() {
+        sample();
+    });
+    timer.startTimer();
+    sample();
+
+    {
+        std::lock_guard lg{registriesMutex};
+        registries.push_back(this);
+    }
+
+    // Get stopped after the services using the registry, so connections closing during shutdown are still counted.
+    this->setServicePriority(1'001);
+
+    co_return {};
+}
+
+Ichor::Task<void> Ichor::v1::MetricsRegistryService::stop() {
+    {
+        std::lock_guard lg{registriesMutex};
+        std::erase(registries, this);
+    }
+    _interceptorRegistration.reset();
+
+    co_return;
+}
+
+void Ichor::v1::MetricsRegistryService::addDependencyInstance(Ichor::ScopedServiceProxy<ITimerFactory*> factory, IService &) {
+    _timerFactory = std::move(factory);
+}
+
+void Ichor::v1::MetricsRegistryService::removeDependencyInstance(Ichor::ScopedServiceProxy<ITimerFactory*>, IService &) {
+    _timerFactory = nullptr;
+}
+
+bool Ichor::v1::MetricsRegistryService::preInterceptEvent(Event const &evt) {
+    auto counterIt = _eventCounters.find(evt.get_type());
+
+    if(counterIt == _eventCounters.end()) [[unlikely]] {
+        std::array<MetricLabel, 1> labels{MetricLabel{"type", evt.get_name()}};
+        counterIt = _eventCounters.emplace(evt.get_type(), &counter("ichor_events_total", "Events dispatched, per event type", labels)).first;
+    }
+
+    counterIt->second->inc();
+
+    return (bool)AllowOthersHandling;
+}
+
+void Ichor::v1::MetricsRegistryService::postInterceptEvent(Event const &, bool) {
+}
+
+void Ichor::v1::MetricsRegistryService::sample() {
+    auto &dm = GetThreadLocalManager();
+    _queueSize->set(static_cast<int64_t>(dm.getEventQueue().size()));
+    _coroutines->set(static_cast<int64_t>(dm.getSuspendedCoroutineCount()));
+
+    std::array<int64_t, SERVICE_STATE_NAMES.size()> stateCounts{};
+    for(auto const &[svcId, svc] : dm.getAllServices()) {
+        stateCounts[static_cast<size_t>(svc->getServiceState())]++;
+    }
+    for(size_t i = 0; i < stateCounts.size(); i++) {
+        _serviceStates[i]->set(stateCounts[i]);
+    }
+
+#ifdef ICHOR_USE_LIBURING
+    if(_sqEntries != nullptr) {
+        auto &q = static_cast<IIOUringQueue&>(dm.getEventQueue());
+        _sqEntries->set(q.getMaxEntriesCount());
+        _sqInUse->set(static_cast<int64_t>(q.getMaxEntriesCount()) - q.sqeSpaceLeft());
+        _cqReady->set(io_uring_cq_ready(q.getRing()));
+    }
+#endif
+}
+
+Ichor::v1::MetricCounter& Ichor::v1::MetricsRegistryService::counter(std::string_view name, std::string_view help, std::span<MetricLabel const> labels) {
+    auto &series = findOrCreateSeries(name, help, MetricType::COUNTER, {}, labels);
+    return *std::get<std::unique_ptr<MetricCounter>>(series.metric);
+}
+
+Ichor::v1::MetricGauge& Ichor::v1::MetricsRegistryService::gauge(std::string_view name, std::string_view help, std::span<MetricLabel const> labels) {
+    auto &series = findOrCreateSeries(name, help, MetricType::GAUGE, {}, labels);
+    return *std::get<std::unique_ptr<MetricGauge>>(series.metric);
+}
+
+Ichor::v1::MetricHistogram& Ichor::v1::MetricsRegistryService::histogram(std::string_view name, std::string_view help, std::span<uint64_t const> upperBounds, std::span<MetricLabel const> labels) {
+    auto &series = findOrCreateSeries(name, help, MetricType::HISTOGRAM, upperBounds, labels);
+    return *std::get<std::unique_ptr<MetricHistogram>>(series.metric);
+}
+
+Ichor::v1::MetricsRegistryService::MetricSeries& Ichor::v1::MetricsRegistryService::findOrCreateSeries(std::string_view name, std::string_view help, MetricType type, std::span<uint64_t const> upperBounds, std::span<MetricLabel const> labels) {
+    auto renderedLabels = renderLabels(labels);
+    std::lock_guard lg{_familiesMutex};
+
+    auto familyIt = std::find_if(_families.begin(), _families.end(), [name](MetricFamily const &family) {
+        return family.name == name;
+    });
+    if(familyIt == _families.end()) {
+        familyIt = _families.insert(_families.end(), MetricFamily{std::string{name}, std::string{help}, type, {}});
+    } else if(familyIt->type != type) [[unlikely]] {
+        fmt::println("Metric {} requested as {}, but was registered as {}", name, metricTypeName(type), metricTypeName(familyIt->type));
+        std::terminate();
+    }
+
+    auto seriesIt = std::find_if(familyIt->series.begin(), familyIt->series.end(), [&renderedLabels](MetricSeries const &series) {
+        return series.labels == renderedLabels;
+    });
+    if(seriesIt != familyIt->series.end()) {
+        return *seriesIt;
+    }
+
+    auto &series = familyIt->series.emplace_back(MetricSeries{std::move(renderedLabels), {}});
+    switch(type) {
+        case MetricType::COUNTER:
+            series.metric = std::make_unique<MetricCounter>();
+            break;
+        case MetricType::GAUGE:
+            series.metric = std::make_unique<MetricGauge>();
+            break;
+        case MetricType::HISTOGRAM:
+            // created under the lock as well, formatMetricsText() reads it from other threads
+            series.metric = std::make_unique<MetricHistogram>(upperBounds);
+            break;
+    }
+    return series;
+}
+
+std::string Ichor::v1::formatMetricsText() {
+    std::string out;
+    // the sorted map keeps the output stable between scrapes
+    std::map<std::string_view, AggregatedFamily> families;
+
+    {
+        std::lock_guard lg{registriesMutex};
+        std::vector<std::unique_lock<std::mutex>> familyLocks;
+        familyLocks.reserve(registries.size());
+
+        for(auto const *registry : registries) {
+            // held until everything is rendered, the aggregation refers to the names and labels of the registries
+            familyLocks.emplace_back(registry->_familiesMutex);
+
+            for(auto const &family : registry->_families) {
+                auto &aggFamily = families.try_emplace(family.name, AggregatedFamily{family.help, family.type, {}}).first->second;
+                if(aggFamily.type != family.type) {
+                    continue;
+                }
+
+                for(auto const &series : family.series) {
+                    auto &aggSeries = aggFamily.series[series.labels];
+
+                    if(auto const *ctr = std::get_if<std::unique_ptr<MetricCounter>>(&series.metric)) {
+                        aggSeries.value += static_cast<int64_t>((*ctr)->value());
+                    } else if(auto const *gauge = std::get_if<std::unique_ptr<MetricGauge>>(&series.metric)) {
+                        aggSeries.value += (*gauge)->value();
+                    } else if(auto const *hist = std::get_if<std::unique_ptr<MetricHistogram>>(&series.metric)) {
+                        auto bounds = (*hist)->upperBounds();
+                        if(!aggSeries.initialized) {
+                            aggSeries.upperBounds.assign(bounds.begin(), bounds.end());
+                            aggSeries.bucketCounts.resize(bounds.size() + 1);
+                        } else if(!std::equal(bounds.begin(), bounds.end(), aggSeries.upperBounds.begin(), aggSeries.upperBounds.end())) {
+                            continue;
+                        }
+                        for(size_t i = 0; i < aggSeries.bucketCounts.size(); i++) {
+                            aggSeries.bucketCounts[i] += (*hist)->bucketCount(i);
+                        }
+                        aggSeries.sum += (*hist)->sum();
+                    }
+                    aggSeries.initialized = true;
+                }
+            }
+        }
+
+        for(auto const &[name, family] : families) {
+            out += "# HELP ";
+            out += name;
+            out += ' ';
+            appendEscaped(out, family.help, false);
+            out += "\n# TYPE ";
+            out += name;
+            out += ' ';
+            out += metricTypeName(family.type);
+            out += '\n';
+
+            for(auto const &[labels, series] : family.series) {
+                if(family.type != MetricType::HISTOGRAM) {
+                    fmt::format_to(std::back_inserter(out), "{}{} {}\n", name, labels, series.value);
+                    continue;
+                }
+
+                uint64_t cumulative{};
+                for(size_t i = 0; i < series.bucketCounts.size(); i++) {
+                    cumulative += series.bucketCounts[i];
+                    auto le = i < series.upperBounds.size() ? fmt::format("{}", series.upperBounds[i]) : std::string{"+Inf"};
+                    fmt::format_to(std::back_inserter(out), "{}_bucket{} {}\n", name, withLabel(labels, "le", le), cumulative);
+                }
+                fmt::format_to(std::back_inserter(out), "{}_sum{} {}\n{}_count{} {}\n", name, labels, series.sum, name, labels, cumulative);
+            }
+        }
+    }
+
+    fmt::format_to(std::back_inserter(out), "# HELP process_resident_memory_bytes Resident memory size in bytes\n# TYPE process_resident_memory_bytes gauge\nprocess_resident_memory_bytes {}\n", getCurrentRSS());
+
+    return out;
+}
@@ -99,22 +99,21 @@ Ichor::Task<void> Ichor::v1::HttpConnectionService::close() {
 }
 
 Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::HttpConnectionService::start() {
-    auto addrIt = getProperties().find("Address");
-    auto portIt = getProperties().find("Port");
+    auto const *addr = getProperties().get(PropertyKeys::Address);
 
-    if(addrIt == getProperties().end()) {
+    if(addr == nullptr) {
         ICHOR_LOG_ERROR(_logger, "Missing address");
         co_return tl::unexpected(StartError::FAILED);
     }
-    if(portIt == getProperties().end()) {
+    if(!getProperties().contains(PropertyKeys::Port)) {
         ICHOR_LOG_ERROR(_logger, "Missing port");
         co_return tl::unexpected(StartError::FAILED);
     }
 
-    _address = &Ichor::v1::any_cast<std::string const &>(addrIt->second);
+    _address = addr;
 
-    if(auto propIt = getProperties().find("Priority"); propIt != getProperties().end()) {
-        _priority = Ichor::v1::any_cast<uint64_t>(propIt->second);
+    if(auto const *priority = getProperties().get(PropertyKeys::Priority); priority != nullptr) {
+        _priority = *priority;
     }
     if(auto propIt = getProperties().find("Debug"); propIt != getProperties().end()) {
         _debug = Ichor::v1::any_cast<bool>(propIt->second);
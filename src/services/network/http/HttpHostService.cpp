@@ -36,20 +36,17 @@ Ichor::v1::HttpHostService::HttpHostService(DependencyRegister &reg, Properties
 }
 
 Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::HttpHostService::start() {
-    auto addrIt = getProperties().find("Address");
-    auto portIt = getProperties().find("Port");
-
-    if(addrIt == getProperties().end()) {
+    if(!getProperties().contains(PropertyKeys::Address)) {
         ICHOR_LOG_ERROR(_logger, "Missing address");
         co_return tl::unexpected(StartError::FAILED);
     }
-    if(portIt == getProperties().end()) {
+    if(!getProperties().contains(PropertyKeys::Port)) {
         ICHOR_LOG_ERROR(_logger, "Missing port");
         co_return tl::unexpected(StartError::FAILED);
     }
 
-    if(auto propIt = getProperties().find("Priority"); propIt != getProperties().end()) {
-        _priority = Ichor::v1::any_cast<uint64_t>(propIt->second);
+    if(auto const *priority = getProperties().get(PropertyKeys::Priority); priority != nullptr) {
+        _priority = *priority;
     }
     if(auto propIt = getProperties().find("Debug"); propIt != getProperties().end()) {
         _debug = Ichor::v1::any_cast<bool>(propIt->second);
@@ -99,14 +96,14 @@ void Ichor::v1::HttpHostService::addDependencyInstance(Ichor::ScopedServiceProxy
         return;
     }
 
-    auto TcpHostProp = s.getProperties().find("TcpHostService");
+    auto const *tcpHostServiceId = s.getProperties().get(PropertyKeys::TcpHostService);
 
-    if(TcpHostProp == s.getProperties().end()) {
+    if(tcpHostServiceId == nullptr) {
         ICHOR_LOG_TRACE(_logger, "New connection {} did not have TcpHostService property", s.getServiceId());
         return;
     }
-    if(!_hostServiceIds.contains(Ichor::v1::any_cast<ServiceIdType>(TcpHostProp->second))) {
-        ICHOR_LOG_TRACE(_logger, "New connection {}:{} did not match hostServiceId {}", s.getServiceId(), Ichor::v1::any_cast<ServiceIdType>(TcpHostProp->second), _hostServiceIds);
+    if(!_hostServiceIds.contains(*tcpHostServiceId)) {
+        ICHOR_LOG_TRACE(_logger, "New connection {}:{} did not match hostServiceId {}", s.getServiceId(), *tcpHostServiceId, _hostServiceIds);
         return;
     }
 
@@ -312,11 +309,23 @@ Ichor::Task<void> Ichor::v1::HttpHostService::receiveRequestHandler(ServiceIdTyp
 
         co_await sendResponse(id, resp);
 
-        if(!_connections.contains(id)) {
+        auto client = _connections.find(id);
+        if(client == _connections.end()) {
             ICHOR_LOG_TRACE(_logger, "HttpHostService {} connection {} closed", getServiceId(), id);
             co_return;
         }
 
+        if(resp.status == HttpStatus::switching_protocols && req && req->upgradeHandler) {
+            // The client has to wait for the 101 before speaking the new protocol, so there's nothing left in the buffer that belongs to it.
+            // Any data arriving from now on is queued by the connection until the new owner sets its receive handler.
+            ICHOR_LOG_TRACE(_logger, "HttpHostService {} connection {} upgraded", getServiceId(), id);
+            client->second->setReceiveHandler({});
+            _connections.erase(client);
+            _connectionBuffers.erase(id);
+            req->upgradeHandler(id);
+            co_return;
+        }
+
         if(!msg.empty()) {
             if constexpr (DO_INTERNAL_DEBUG || DO_HARDENING) {
                 if(pos > msg.length()) [[unlikely]] {
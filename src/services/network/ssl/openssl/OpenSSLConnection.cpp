@@ -1,4 +1,5 @@
 #include <ichor/services/network/ssl/openssl/OpenSSLConnection.h>
+#include <openssl/crypto.h>
 
 using namespace Ichor::v1;
 
@@ -10,6 +11,10 @@ OpenSSLConnection::~OpenSSLConnection() {
         ::SSL_free(static_cast<SSL *>(_ctx));
         _ctx = nullptr;
     }
+
+    for(auto &state : traffic) {
+        ::OPENSSL_cleanse(state.secret.data(), state.secret.size());
+    }
 }
 
 SSL* OpenSSLConnection::getHandle() const {
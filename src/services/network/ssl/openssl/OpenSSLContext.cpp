@@ -7,6 +7,11 @@ OpenSSLContext::OpenSSLContext(SSL_CTX* ctx, Ichor::v1::TLSContextIdType id, REF
 }
 
 OpenSSLContext::~OpenSSLContext() {
+    for(auto &[name, session] : _sessions) {
+        ::SSL_SESSION_free(session);
+    }
+    _sessions.clear();
+
     if(_ctx != nullptr) {
         ::SSL_CTX_free(static_cast<SSL_CTX *>(_ctx));
         _ctx = nullptr;
@@ -18,6 +23,34 @@ SSL_CTX* OpenSSLContext::getHandle() const {
     return static_cast<SSL_CTX *>(_ctx);
 }
 
+void OpenSSLContext::setAllowKernelOffload(bool allow) noexcept {
+    _allowKernelOffload = allow;
+}
+
+SSL_SESSION* OpenSSLContext::takeSession(std::string_view serverName) {
+    auto it = _sessions.find(serverName);
+
+    if(it == _sessions.end()) {
+        return nullptr;
+    }
+
+    auto *session = it->second;
+    _sessions.erase(it);
+    return session;
+}
+
+void OpenSSLContext::storeSession(std::string_view serverName, SSL_SESSION *session) {
+    auto it = _sessions.find(serverName);
+
+    if(it == _sessions.end()) {
+        _sessions.emplace(serverName, session);
+        return;
+    }
+
+    ::SSL_SESSION_free(it->second);
+    it->second = session;
+}
+
 Ichor::ScopedServiceProxy<ILogger*> OpenSSLContext::getLogger() const {
     return _svc.getLogger();
 }
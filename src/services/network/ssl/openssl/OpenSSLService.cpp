@@ -9,11 +9,167 @@
 #include <openssl/bio.h>
 #include <openssl/err.h>
 #include <openssl/x509_vfy.h>
+#include <openssl/kdf.h>
+#include <openssl/core_names.h>
+#include <openssl/crypto.h>
+#include <charconv>
 #include <ichor/ScopedServiceProxy.h>
 
 namespace {
     struct NullStruct {};
 
+    // Session id context has to be set for the server-side session cache to hand out resumable sessions
+    constexpr unsigned char SessionIdContext[] = "ichor";
+    // Maximum amount of plaintext in one TLS record
+    constexpr size_t MaxRecordPlaintextSize = 16'384;
+
+    int SSLNewSessionCallback(SSL *ssl, SSL_SESSION *session) {
+        auto *conn = static_cast<Ichor::v1::OpenSSLConnection*>(SSL_get_app_data(ssl));
+        auto *ctx = static_cast<Ichor::v1::OpenSSLContext*>(SSL_CTX_get_app_data(::SSL_get_SSL_CTX(ssl)));
+
+        if(conn == nullptr || ctx == nullptr || conn->serverName.empty()) {
+            return 0;
+        }
+
+        // OpenSSL marks the session as not resumable if the connection is freed without a close_notify, store a copy so that doesn't affect us
+        auto *copy = ::SSL_SESSION_dup(session);
+
+        if(copy != nullptr) {
+            ctx->storeSession(conn->serverName, copy);
+        }
+
+        return 0;
+    }
+
+    void drainExternalBio(Ichor::v1::OpenSSLConnection &conn, std::vector<uint8_t> &out) {
+        char *buf{};
+        int len = ::BIO_nread0(conn.externalBio, &buf);
+
+        // the bio pair is a ring buffer, so it may take two reads to get everything out
+        while(len > 0) {
+            out.insert(out.end(), reinterpret_cast<uint8_t const *>(buf), reinterpret_cast<uint8_t const *>(buf) + len);
+            ::BIO_nread(conn.externalBio, &buf, len);
+            len = ::BIO_nread0(conn.externalBio, &buf);
+        }
+    }
+
+    // Lines look like "CLIENT_TRAFFIC_SECRET_0 <client random> <secret>", both in hex
+    void SSLKeylogCallback(SSL const *ssl, char const *line) {
+        auto *conn = static_cast<Ichor::v1::OpenSSLConnection*>(SSL_get_app_data(ssl));
+
+        if(conn == nullptr) {
+            return;
+        }
+
+        std::string_view view{line};
+        auto labelEnd = view.find(' ');
+        auto secretStart = view.rfind(' ');
+
+        if(labelEnd == std::string_view::npos || secretStart == labelEnd) {
+            return;
+        }
+
+        auto label = view.substr(0, labelEnd);
+        bool isServer = ::SSL_is_server(ssl) == 1;
+        Ichor::v1::TLSTrafficDirection direction{};
+
+        if(label == "CLIENT_TRAFFIC_SECRET_0") {
+            direction = isServer ? Ichor::v1::TLSTrafficDirection::RECEIVE : Ichor::v1::TLSTrafficDirection::SEND;
+        } else if(label == "SERVER_TRAFFIC_SECRET_0") {
+            direction = isServer ? Ichor::v1::TLSTrafficDirection::SEND : Ichor::v1::TLSTrafficDirection::RECEIVE;
+        } else {
+            return;
+        }
+
+        auto hex = view.substr(secretStart + 1);
+        auto &state = conn->traffic[static_cast<size_t>(direction)];
+
+        if(hex.size() % 2 != 0 || hex.size() / 2 > state.secret.size()) {
+            return;
+        }
+
+        for(size_t i = 0; i < hex.size() / 2; i++) {
+            auto [ptr, ec] = std::from_chars(hex.data() + i * 2, hex.data() + i * 2 + 2, state.secret[i], 16);
+
+            if(ec != std::errc{}) {
+                ::OPENSSL_cleanse(state.secret.data(), state.secret.size());
+                return;
+            }
+        }
+
+        state.secretLength = hex.size() / 2;
+    }
+
+    // TLS 1.3 sequence numbers restart at 0 with every key change and OpenSSL doesn't expose them, so count records ourselves.
+    // The Finished message is the last record protected by handshake keys in its direction.
+    void SSLRecordCountingCallback(int writeP, int, int contentType, void const *buf, size_t len, SSL *ssl, void *) {
+        auto *conn = static_cast<Ichor::v1::OpenSSLConnection*>(SSL_get_app_data(ssl));
+
+        if(conn == nullptr) {
+            return;
+        }
+
+        auto &state = conn->traffic[static_cast<size_t>(writeP == 1 ? Ichor::v1::TLSTrafficDirection::SEND : Ichor::v1::TLSTrafficDirection::RECEIVE)];
+
+        if(contentType == SSL3_RT_INNER_CONTENT_TYPE) {
+            if(state.applicationKeysActive) {
+                state.records++;
+            }
+        } else if(contentType == SSL3_RT_HANDSHAKE && len > 0) {
+            auto msgType = *static_cast<uint8_t const *>(buf);
+
+            if(msgType == SSL3_MT_FINISHED) {
+                state.applicationKeysActive = true;
+            } else if(msgType == SSL3_MT_KEY_UPDATE) {
+                state.keysUpdated = true;
+            }
+        }
+    }
+
+    // HKDF-Expand-Label from RFC 8446 section 7.1, with an empty context
+    bool hkdfExpandLabel(EVP_MD const *md, std::span<uint8_t const> secret, std::string_view label, uint8_t *out, size_t outLength) {
+        constexpr std::string_view prefix{"tls13 "};
+        std::array<uint8_t, 2 + 1 + 255 + 1> info{};
+        size_t pos{};
+
+        info[pos++] = static_cast<uint8_t>(outLength >> 8);
+        info[pos++] = static_cast<uint8_t>(outLength);
+        info[pos++] = static_cast<uint8_t>(prefix.size() + label.size());
+        std::copy(prefix.begin(), prefix.end(), info.begin() + static_cast<std::ptrdiff_t>(pos));
+        pos += prefix.size();
+        std::copy(label.begin(), label.end(), info.begin() + static_cast<std::ptrdiff_t>(pos));
+        pos += label.size();
+        info[pos++] = 0;
+
+        EVP_KDF *kdf = ::EVP_KDF_fetch(nullptr, "HKDF", nullptr);
+
+        if(kdf == nullptr) {
+            return false;
+        }
+
+        EVP_KDF_CTX *kctx = ::EVP_KDF_CTX_new(kdf);
+        ::EVP_KDF_free(kdf);
+
+        if(kctx == nullptr) {
+            return false;
+        }
+
+        Ichor::ScopeGuard sgKctx{[kctx] {
+            ::EVP_KDF_CTX_free(kctx);
+        }};
+
+        int mode = EVP_KDF_HKDF_MODE_EXPAND_ONLY;
+        OSSL_PARAM params[] = {
+            ::OSSL_PARAM_construct_utf8_string(OSSL_KDF_PARAM_DIGEST, const_cast<char *>(::EVP_MD_get0_name(md)), 0),
+            ::OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_KEY, const_cast<uint8_t *>(secret.data()), secret.size()),
+            ::OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_INFO, info.data(), pos),
+            ::OSSL_PARAM_construct_int(OSSL_KDF_PARAM_MODE, &mode),
+            ::OSSL_PARAM_construct_end()
+        };
+
+        return ::EVP_KDF_derive(kctx, out, outLength, params) == 1;
+    }
+
     int SSLContextVerifyCertificateCallback(X509_STORE_CTX *storeCtx, void *userArg) {
 #if defined(ICHOR_USE_HARDENING) || defined(ICHOR_ENABLE_INTERNAL_DEBUGGING)
         if(storeCtx == nullptr) {
@@ -144,6 +300,15 @@ tl::expected<std::unique_ptr<Ichor::v1::TLSContext>, Ichor::v1::TLSContextError>
         ::SSL_CTX_set_security_level(ctx_handle, 2);
     }
 
+    if(opts.sessionResumption) {
+        SSL_CTX_set_session_cache_mode(ctx_handle, SSL_SESS_CACHE_SERVER);
+        ::SSL_CTX_set_session_id_context(ctx_handle, SessionIdContext, sizeof(SessionIdContext) - 1);
+        ::SSL_CTX_set_num_tickets(ctx_handle, opts.sessionTicketCount);
+    } else {
+        SSL_CTX_set_session_cache_mode(ctx_handle, SSL_SESS_CACHE_OFF);
+        ::SSL_CTX_set_num_tickets(ctx_handle, 0);
+        ::SSL_CTX_set_options(ctx_handle, SSL_OP_NO_TICKET);
+    }
 
     ScopeGuard sgCertx509{[certx509] {
         ::X509_free(certx509);
@@ -190,9 +355,15 @@ tl::expected<std::unique_ptr<Ichor::v1::TLSContext>, Ichor::v1::TLSContextError>
         return tl::unexpected(TLSContextError::UNKNOWN);
     }
 
+    if(opts.allowKernelOffload) {
+        ::SSL_CTX_set_keylog_callback(ctx_handle, &SSLKeylogCallback);
+    }
+
     ++_contextIdCounter;
     error = false;
-    return std::make_unique<OpenSSLContext>(ctx_handle, _contextIdCounter, _currentlyActiveContexts, *this);
+    auto tlsContext = std::make_unique<OpenSSLContext>(ctx_handle, _contextIdCounter, _currentlyActiveContexts, *this);
+    tlsContext->setAllowKernelOffload(opts.allowKernelOffload);
+    return tlsContext;
 }
 
 tl::expected<std::unique_ptr<Ichor::v1::TLSContext>, Ichor::v1::TLSContextError> Ichor::v1::OpenSSLService::createClientTLSContext(TLSCreateContextOptions opts) {
@@ -211,6 +382,20 @@ tl::expected<std::unique_ptr<Ichor::v1::TLSContext>, Ichor::v1::TLSContextError>
         tlsContext->certificateVerifyCallback = std::move(opts.certificateVerifyCallback);
     }
 
+    if(opts.sessionResumption) {
+        // sessions are stored per server name in the OpenSSLContext, OpenSSL's internal cache is server oriented
+        SSL_CTX_set_session_cache_mode(ctx_handle, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        SSL_CTX_set_app_data(ctx_handle, tlsContext.get());
+        ::SSL_CTX_sess_set_new_cb(ctx_handle, &SSLNewSessionCallback);
+    } else {
+        SSL_CTX_set_session_cache_mode(ctx_handle, SSL_SESS_CACHE_OFF);
+    }
+
+    if(opts.allowKernelOffload) {
+        ::SSL_CTX_set_keylog_callback(ctx_handle, &SSLKeylogCallback);
+        tlsContext->setAllowKernelOffload(true);
+    }
+
     if(opts.allowUnknownCertificates) {
         ::SSL_CTX_set_verify(ctx_handle, SSL_VERIFY_NONE, nullptr);
     } else {
@@ -246,9 +431,32 @@ tl::expected<std::unique_ptr<Ichor::v1::TLSConnection>, Ichor::v1::TLSConnection
     }
 
     ::SSL_set_bio(con->getHandle(), con->internalBio, con->internalBio);
+    SSL_set_app_data(con->getHandle(), con.get());
+    // TLSEncrypt drains the bio pair whenever it is full, which requires partial writes
+    SSL_set_mode(con->getHandle(), SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+    if(ctx.allowsKernelOffload()) {
+        ::SSL_set_msg_callback(con->getHandle(), &SSLRecordCountingCallback);
+    }
     auto key = ::SSL_CTX_get0_privatekey(static_cast<OpenSSLContext&>(ctx).getHandle());
     if(key == nullptr) {
         ::SSL_set_connect_state(con->getHandle());
+
+        if(!opts.serverName.empty()) {
+            if(SSL_set_tlsext_host_name(con->getHandle(), opts.serverName.c_str()) != 1) {
+                printAllSslErrors(*con.get(), __LINE__);
+                return tl::unexpected(TLSConnectionError::UNKNOWN);
+            }
+
+            auto *session = static_cast<OpenSSLContext&>(ctx).takeSession(opts.serverName);
+            if(session != nullptr) {
+                if(::SSL_set_session(con->getHandle(), session) != 1) {
+                    printAllSslErrors(*con.get(), __LINE__);
+                }
+                ::SSL_SESSION_free(session);
+            }
+
+            con->serverName = std::move(opts.serverName);
+        }
     } else {
         ::SSL_set_accept_state(con->getHandle());
     }
@@ -359,6 +567,225 @@ Ichor::v1::TLSHandshakeStatus Ichor::v1::OpenSSLService::TLSDoHandshake(TLSConne
     }
 }
 
+tl::expected<void, Ichor::v1::TLSConnectionError> Ichor::v1::OpenSSLService::TLSDecrypt(TLSConnection &conn, std::span<uint8_t const> ciphertext, std::vector<uint8_t> &plaintextOut, std::vector<uint8_t> &ciphertextOut) {
+#if defined(ICHOR_USE_HARDENING) || defined(ICHOR_ENABLE_INTERNAL_DEBUGGING)
+    if(conn.getType() != TLSConnectionTypeType{1}) [[unlikely]] {
+        ICHOR_LOG_ERROR(_logger, "TLSConnection type expected {} got {}", 1, conn.getType().value);
+        std::terminate();
+    }
+#endif
+
+    auto &sslConn = static_cast<OpenSSLConnection &>(conn);
+    auto *ssl = sslConn.getHandle();
+    size_t offset{};
+
+    if(!_readScratch) {
+        // not value-initialized, SSL_read_ex only reports the bytes it wrote
+        _readScratch = std::make_unique_for_overwrite<uint8_t[]>(MaxRecordPlaintextSize);
+    }
+
+    do {
+        // copy as much ciphertext as fits directly into the bio pair
+        while(offset < ciphertext.size()) {
+            char *buf{};
+            int space = ::BIO_nwrite0(sslConn.externalBio, &buf);
+
+            if(space <= 0) {
+                break;
+            }
+
+            auto chunk = std::min(static_cast<size_t>(space), ciphertext.size() - offset);
+            std::memcpy(buf, ciphertext.data() + offset, chunk);
+            ::BIO_nwrite(sslConn.externalBio, &buf, static_cast<int>(chunk));
+            offset += chunk;
+        }
+
+        // SSL_read also drives the handshake and processes post-handshake messages like session tickets
+        while(true) {
+            size_t readBytes{};
+            int ret = ::SSL_read_ex(ssl, _readScratch.get(), MaxRecordPlaintextSize, &readBytes);
+
+            if(ret == 1) {
+                plaintextOut.insert(plaintextOut.end(), _readScratch.get(), _readScratch.get() + readBytes);
+                continue;
+            }
+
+            int err = ::SSL_get_error(ssl, ret);
+
+            if(err == SSL_ERROR_WANT_READ) {
+                break;
+            }
+
+            if(err == SSL_ERROR_WANT_WRITE) {
+                drainExternalBio(sslConn, ciphertextOut);
+                continue;
+            }
+
+            // whatever is left is probably an alert that the peer should receive
+            drainExternalBio(sslConn, ciphertextOut);
+
+            if(err == SSL_ERROR_ZERO_RETURN) {
+                ICHOR_LOG_TRACE(_logger, "Connection {} received close_notify.", conn.getId().value);
+                return tl::unexpected(TLSConnectionError::CLOSED);
+            }
+
+            printAllSslErrors(sslConn, __LINE__);
+
+            if(err == SSL_ERROR_SSL) {
+                return tl::unexpected(TLSConnectionError::PROTOCOL_ERROR);
+            }
+
+            return tl::unexpected(TLSConnectionError::UNKNOWN);
+        }
+
+        drainExternalBio(sslConn, ciphertextOut);
+    } while(offset < ciphertext.size());
+
+    return {};
+}
+
+tl::expected<void, Ichor::v1::TLSConnectionError> Ichor::v1::OpenSSLService::TLSEncrypt(TLSConnection &conn, std::span<uint8_t const> plaintext, std::vector<uint8_t> &ciphertextOut) {
+#if defined(ICHOR_USE_HARDENING) || defined(ICHOR_ENABLE_INTERNAL_DEBUGGING)
+    if(conn.getType() != TLSConnectionTypeType{1}) [[unlikely]] {
+        ICHOR_LOG_ERROR(_logger, "TLSConnection type expected {} got {}", 1, conn.getType().value);
+        std::terminate();
+    }
+#endif
+
+    auto &sslConn = static_cast<OpenSSLConnection &>(conn);
+    auto *ssl = sslConn.getHandle();
+    size_t offset{};
+
+    while(offset < plaintext.size()) {
+        size_t written{};
+        int ret = ::SSL_write_ex(ssl, plaintext.data() + offset, plaintext.size() - offset, &written);
+
+        if(ret == 1) {
+            offset += written;
+            continue;
+        }
+
+        int err = ::SSL_get_error(ssl, ret);
+
+        if(err == SSL_ERROR_WANT_WRITE) {
+            // bio pair is full, empty it and try again
+            drainExternalBio(sslConn, ciphertextOut);
+            continue;
+        }
+
+        drainExternalBio(sslConn, ciphertextOut);
+
+        if(err == SSL_ERROR_WANT_READ) {
+            ICHOR_LOG_ERROR(_logger, "Connection {} tried to encrypt before the handshake finished.", conn.getId().value);
+            return tl::unexpected(TLSConnectionError::UNKNOWN);
+        }
+
+        if(err == SSL_ERROR_ZERO_RETURN) {
+            return tl::unexpected(TLSConnectionError::CLOSED);
+        }
+
+        printAllSslErrors(sslConn, __LINE__);
+        return tl::unexpected(err == SSL_ERROR_SSL ? TLSConnectionError::PROTOCOL_ERROR : TLSConnectionError::UNKNOWN);
+    }
+
+    drainExternalBio(sslConn, ciphertextOut);
+
+    return {};
+}
+
+void Ichor::v1::OpenSSLService::TLSDrainPending(TLSConnection &conn, std::vector<uint8_t> &ciphertextOut) {
+#if defined(ICHOR_USE_HARDENING) || defined(ICHOR_ENABLE_INTERNAL_DEBUGGING)
+    if(conn.getType() != TLSConnectionTypeType{1}) [[unlikely]] {
+        ICHOR_LOG_ERROR(_logger, "TLSConnection type expected {} got {}", 1, conn.getType().value);
+        std::terminate();
+    }
+#endif
+
+    drainExternalBio(static_cast<OpenSSLConnection &>(conn), ciphertextOut);
+}
+
+bool Ichor::v1::OpenSSLService::TLSIsHandshakeDone(TLSConnection &conn) {
+#if defined(ICHOR_USE_HARDENING) || defined(ICHOR_ENABLE_INTERNAL_DEBUGGING)
+    if(conn.getType() != TLSConnectionTypeType{1}) [[unlikely]] {
+        ICHOR_LOG_ERROR(_logger, "TLSConnection type expected {} got {}", 1, conn.getType().value);
+        std::terminate();
+    }
+#endif
+
+    return ::SSL_is_init_finished(static_cast<OpenSSLConnection &>(conn).getHandle()) == 1;
+}
+
+bool Ichor::v1::OpenSSLService::TLSIsSessionReused(TLSConnection &conn) {
+#if defined(ICHOR_USE_HARDENING) || defined(ICHOR_ENABLE_INTERNAL_DEBUGGING)
+    if(conn.getType() != TLSConnectionTypeType{1}) [[unlikely]] {
+        ICHOR_LOG_ERROR(_logger, "TLSConnection type expected {} got {}", 1, conn.getType().value);
+        std::terminate();
+    }
+#endif
+
+    return ::SSL_session_reused(static_cast<OpenSSLConnection &>(conn).getHandle()) == 1;
+}
+
+tl::expected<Ichor::v1::TLSTrafficKeys, Ichor::v1::TLSConnectionError> Ichor::v1::OpenSSLService::TLSExportTrafficKeys(TLSConnection &conn, TLSTrafficDirection direction) {
+#if defined(ICHOR_USE_HARDENING) || defined(ICHOR_ENABLE_INTERNAL_DEBUGGING)
+    if(conn.getType() != TLSConnectionTypeType{1}) [[unlikely]] {
+        ICHOR_LOG_ERROR(_logger, "TLSConnection type expected {} got {}", 1, conn.getType().value);
+        std::terminate();
+    }
+#endif
+
+    auto &sslConn = static_cast<OpenSSLConnection &>(conn);
+    auto *ssl = sslConn.getHandle();
+    auto &state = sslConn.traffic[static_cast<size_t>(direction)];
+
+    if(state.secretLength == 0 || !state.applicationKeysActive || state.keysUpdated || state.exported || ::SSL_version(ssl) != TLS1_3_VERSION || ::SSL_is_init_finished(ssl) != 1) {
+        return tl::unexpected(TLSConnectionError::UNSUPPORTED);
+    }
+
+    if(direction == TLSTrafficDirection::SEND && ::BIO_ctrl_pending(sslConn.externalBio) != 0) {
+        return tl::unexpected(TLSConnectionError::UNSUPPORTED);
+    }
+
+    if(direction == TLSTrafficDirection::RECEIVE && (::SSL_has_pending(ssl) == 1 || ::BIO_ctrl_pending(sslConn.internalBio) != 0)) {
+        return tl::unexpected(TLSConnectionError::UNSUPPORTED);
+    }
+
+    auto const *cipher = ::SSL_get_current_cipher(ssl);
+    TLSTrafficKeys keys{};
+
+    switch(::SSL_CIPHER_get_id(cipher) & 0xFFFF) {
+        case 0x1301:
+            keys.cipher = TLSCipher::AES_128_GCM;
+            keys.keyLength = 16;
+            break;
+        case 0x1302:
+            keys.cipher = TLSCipher::AES_256_GCM;
+            keys.keyLength = 32;
+            break;
+        case 0x1303:
+            keys.cipher = TLSCipher::CHACHA20_POLY1305;
+            keys.keyLength = 32;
+            break;
+        default:
+            return tl::unexpected(TLSConnectionError::UNSUPPORTED);
+    }
+
+    auto const *md = ::SSL_CIPHER_get_handshake_digest(cipher);
+    std::span<uint8_t const> secret{state.secret.data(), state.secretLength};
+
+    if(md == nullptr || !hkdfExpandLabel(md, secret, "key", keys.key.data(), keys.keyLength) || !hkdfExpandLabel(md, secret, "iv", keys.iv.data(), keys.iv.size())) {
+        printAllSslErrors(sslConn, __LINE__);
+        return tl::unexpected(TLSConnectionError::UNKNOWN);
+    }
+
+    keys.sequenceNumber = state.records;
+    state.exported = true;
+    ::OPENSSL_cleanse(state.secret.data(), state.secret.size());
+    state.secretLength = 0;
+
+    return keys;
+}
+
 template <typename TLSObjectT>
 void Ichor::v1::OpenSSLService::printAllSslErrors(TLSObjectT const &obj, int line_in) const {
     char buf[256];
@@ -0,0 +1,106 @@
+#include <ichor/services/network/tcp/IOUringBroadcast.h>
+#include <ichor/coroutines/AsyncManualResetEvent.h>
+#include <sys/socket.h>
+#include <vector>
+#include <ichor/ichor_liburing.h>
+
+namespace {
+    struct BroadcastTarget final {
+        Ichor::v1::SocketSendGuard *guard;
+        tl::optional<Ichor::v1::AsyncSingleThreadedLockGuard> lock;
+        uint64_t sent;
+    };
+
+    struct BroadcastState final {
+        Ichor::IIOUringQueue &q;
+        Ichor::ServiceIdType origin;
+        std::span<uint8_t const> data;
+        std::vector<BroadcastTarget> targets;
+        uint64_t pending{};
+        uint64_t succeeded{};
+        Ichor::AsyncManualResetEvent done{};
+    };
+
+    void finishSend(BroadcastState &state, BroadcastTarget &target, bool succeeded) {
+        // lets the connection's own sends continue
+        target.lock.reset();
+
+        if(succeeded) {
+            state.succeeded++;
+        }
+
+        if(--state.pending == 0) {
+            state.done.set();
+        }
+    }
+
+    void submitSend(BroadcastState &state, uint64_t idx) {
+        auto &target = state.targets[idx];
+
+        if(target.guard->closed) {
+            INTERNAL_IO_DEBUG("broadcast socket {} closed", target.guard->socket);
+            finishSend(state, target, false);
+            return;
+        }
+
+        // capturing only the state and index keeps the handler within std::function's small buffer
+        auto *sqe = state.q.getSqeWithData(state.origin, [&state, idx](io_uring_cqe *cqe) {
+            auto &t = state.targets[idx];
+
+            if(cqe->res > 0) {
+                t.sent += static_cast<uint64_t>(cqe->res);
+
+                if(t.sent < state.data.size()) {
+                    submitSend(state, idx);
+                    return;
+                }
+
+                finishSend(state, t, true);
+                return;
+            }
+
+            INTERNAL_IO_DEBUG("broadcast send to {} failed: {}", t.guard->socket, cqe->res);
+            finishSend(state, t, false);
+        });
+        io_uring_prep_send(sqe, target.guard->socket, state.data.data() + target.sent, state.data.size() - target.sent, MSG_NOSIGNAL);
+    }
+}
+
+Ichor::Task<uint64_t> Ichor::v1::broadcastToSockets(IIOUringQueue &q, ServiceIdType origin, std::span<std::shared_ptr<SocketSendGuard> const> sockets, std::span<uint8_t const> data) {
+    if(sockets.empty()) {
+        co_return 0;
+    }
+
+    if(data.empty()) {
+        co_return sockets.size();
+    }
+
+    BroadcastState state{q, origin, data, {}, sockets.size()};
+    state.targets.reserve(sockets.size());
+    for(auto const &socket : sockets) {
+        state.targets.push_back(BroadcastTarget{socket.get(), {}, 0});
+    }
+
+    // Most sockets are idle and get their send right away. Busy ones are waited for one after the other, while the sends already submitted continue.
+    std::vector<uint64_t> busy;
+    for(uint64_t i = 0; i < state.targets.size(); i++) {
+        auto lock = state.targets[i].guard->mutex.non_blocking_lock();
+
+        if(!lock) {
+            busy.push_back(i);
+            continue;
+        }
+
+        state.targets[i].lock.emplace(std::move(*lock));
+        submitSend(state, i);
+    }
+
+    for(auto i : busy) {
+        state.targets[i].lock.emplace(co_await state.targets[i].guard->mutex.lock());
+        submitSend(state, i);
+    }
+
+    co_await state.done;
+
+    co_return state.succeeded;
+}
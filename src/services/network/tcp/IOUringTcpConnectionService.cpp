@@ -5,15 +5,23 @@
 #include <arpa/inet.h>
 #include <sys/socket.h>
 #include <netinet/tcp.h>
+#include <linux/tls.h>
 #include <unistd.h>
+#include <cstring>
 #include <thread>
 #include <ichor/ichor_liburing.h>
 #include <ichor/ScopedServiceProxy.h>
+#include <ichor/ScopeGuard.h>
 
 template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
 Ichor::v1::IOUringTcpConnectionService<InterfaceT>::IOUringTcpConnectionService(DependencyRegister &reg, Properties props) : AdvancedService<IOUringTcpConnectionService>(std::move(props)), _socket(-1) {
     reg.registerDependency<ILogger>(this, DependencyFlags::REQUIRED);
     reg.registerDependency<IIOUringQueue>(this, DependencyFlags::REQUIRED);
+    reg.registerDependency<IMetricsRegistry>(this, DependencyFlags::NONE);
+
+    if(AdvancedService<IOUringTcpConnectionService>::getProperties().contains("TLSContext")) {
+        reg.registerDependency<ISSL>(this, DependencyFlags::REQUIRED);
+    }
 }
 
 template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
@@ -25,33 +33,39 @@ Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::IOUringTcpConnecti
     // fmt::println("{}::start() {}", typeName<IOUringTcpConnectionService>(), AdvancedService<IOUringTcpConnectionService>::getServiceId());
     auto const &props = AdvancedService<IOUringTcpConnectionService>::getProperties();
 
-    if(auto propIt = props.find("TimeoutSendUs"); propIt != props.end()) {
-        _sendTimeout = Ichor::v1::any_cast<int64_t>(propIt->second);
+    if(auto const *sendTimeout = props.get(PropertyKeys::TimeoutSendUs); sendTimeout != nullptr) {
+        _sendTimeout = *sendTimeout;
+    }
+    if(auto const *recvTimeout = props.get(PropertyKeys::TimeoutRecvUs); recvTimeout != nullptr) {
+        _recvTimeout = *recvTimeout;
     }
-    if(auto propIt = props.find("TimeoutRecvUs"); propIt != props.end()) {
-        _recvTimeout = Ichor::v1::any_cast<int64_t>(propIt->second);
+    if(auto const *bufferEntries = props.get(PropertyKeys::BufferEntries); bufferEntries != nullptr) {
+        _bufferEntries = *bufferEntries;
     }
-    if(auto propIt = props.find("BufferEntries"); propIt != props.end()) {
-        _bufferEntries = Ichor::v1::any_cast<uint32_t>(propIt->second);
+    if(auto const *bufferEntrySize = props.get(PropertyKeys::BufferEntrySize); bufferEntrySize != nullptr) {
+        _bufferEntrySize = *bufferEntrySize;
     }
-    if(auto propIt = props.find("BufferEntrySize"); propIt != props.end()) {
-        _bufferEntrySize = Ichor::v1::any_cast<uint32_t>(propIt->second);
+    auto const *existingSocket = props.get(PropertyKeys::Socket);
+    auto const *addr = props.get(PropertyKeys::Address);
+    auto const *port = props.get(PropertyKeys::Port);
+
+    if(auto const *sendGuard = props.get(PropertyKeys::SendGuard); sendGuard != nullptr) {
+        _sendGuard = *sendGuard;
+    } else {
+        _sendGuard = std::make_shared<SocketSendGuard>(-1);
     }
-    auto socketPropIt = props.find("Socket");
-    auto addrIt = props.find("Address");
-    auto portIt = props.find("Port");
 
-    if(socketPropIt != props.end()) {
-        _socket = Ichor::v1::any_cast<int>(socketPropIt->second);
+    if(existingSocket != nullptr) {
+        _socket = *existingSocket;
 
         ICHOR_LOG_TRACE(_logger, "[{}] Starting TCP connection for existing socket", AdvancedService<IOUringTcpConnectionService>::getServiceId());
     } else {
 
-        if(addrIt == props.end()) {
+        if(addr == nullptr) {
             ICHOR_LOG_ERROR(_logger, "[{}] Missing address", AdvancedService<IOUringTcpConnectionService>::getServiceId());
             co_return tl::unexpected(StartError::FAILED);
         }
-        if(portIt == props.end()) {
+        if(port == nullptr) {
             ICHOR_LOG_ERROR(_logger, "[{}] Missing port", AdvancedService<IOUringTcpConnectionService>::getServiceId());
             co_return tl::unexpected(StartError::FAILED);
         }
@@ -70,8 +84,7 @@ Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::IOUringTcpConnecti
             co_await evt;
 
             if (res < 0) {
-                ICHOR_LOG_ERROR(_logger, "Couldn't open a socket to {}:{}: {}", Ichor::v1::any_cast<std::string const &>(addrIt->second),
-                                Ichor::v1::any_cast<uint16_t>(portIt->second), mapErrnoToError(-res));
+                ICHOR_LOG_ERROR(_logger, "Couldn't open a socket to {}:{}: {}", *addr, *port, mapErrnoToError(-res));
                 co_return tl::unexpected(StartError::FAILED);
             }
 
@@ -80,6 +93,7 @@ Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::IOUringTcpConnecti
             _socket = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
         }
     }
+    _sendGuard->socket = _socket;
 
     if(_q->getKernelVersion() >= Version{6, 7, 0}) {
         int setting = 1;
@@ -141,12 +155,12 @@ Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::IOUringTcpConnecti
         }
     }
 
-    if(socketPropIt == props.end()) {
+    if(existingSocket == nullptr) {
         sockaddr_in address{};
         address.sin_family = AF_INET;
-        address.sin_port = htons(Ichor::v1::any_cast<uint16_t>(portIt->second));
+        address.sin_port = htons(*port);
 
-        int ret = inet_pton(AF_INET, Ichor::v1::any_cast<std::string const &>(addrIt->second).c_str(), &address.sin_addr);
+        int ret = inet_pton(AF_INET, addr->c_str(), &address.sin_addr);
         if(ret == 0)
         {
             fmt::println("inet_pton invalid address for given address family (has to be ipv4-valid address)");
@@ -163,24 +177,36 @@ Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::IOUringTcpConnecti
         io_uring_prep_connect(sqe, _socket, (struct sockaddr *)&address, sizeof(address));
         co_await evt;
 
-        ICHOR_LOG_TRACE(_logger, "[{}] Starting TCP connection for {}:{}", AdvancedService<IOUringTcpConnectionService>::getServiceId(), Ichor::v1::any_cast<std::string const &>(addrIt->second), Ichor::v1::any_cast<uint16_t>(portIt->second));
+        ICHOR_LOG_TRACE(_logger, "[{}] Starting TCP connection for {}:{}", AdvancedService<IOUringTcpConnectionService>::getServiceId(), *addr, *port);
+    }
+
+    if(auto propIt = props.find("TLSContext"); propIt != props.end()) {
+        _tlsContext = Ichor::v1::any_cast<std::shared_ptr<TLSContext>>(propIt->second);
+        TLSCreateConnectionOptions opts{};
+
+        if(auto nameIt = props.find("TLSServerName"); nameIt != props.end()) {
+            opts.serverName = Ichor::v1::any_cast<std::string const &>(nameIt->second);
+        }
+
+        auto conn = _ssl->createTLSConnection(*_tlsContext, std::move(opts));
+
+        if(!conn) {
+            ICHOR_LOG_ERROR(_logger, "[{}] Couldn't create TLS connection", AdvancedService<IOUringTcpConnectionService>::getServiceId());
+            co_return tl::unexpected(StartError::FAILED);
+        }
+
+        _tlsConnection = std::move(*conn);
     }
 
-    bool armedMultishot{};
     if(_q->getKernelVersion() >= Version{6, 0, 0}) {
         auto buffer = _q->createProvidedBuffer(static_cast<unsigned short>(_bufferEntries), _bufferEntrySize);
         if(buffer) {
             _buffer = std::move(*buffer);
-            auto *sqe = _q->getSqeWithData(this, createRecvHandler());
-            io_uring_prep_recv_multishot(sqe, _socket, nullptr, 0, 0);
-            sqe->buf_group = static_cast<__u16>(_buffer->getBufferGroupId());
-            sqe->flags |= IOSQE_BUFFER_SELECT;
-            armedMultishot = true;
         } else {
             ICHOR_LOG_WARN(_logger, "Couldn't create provided buffers: {}", buffer.error());
         }
     }
-    if(!armedMultishot) {
+    if(!_buffer) {
         if(auto propIt = props.find("RecvBufferSize"); propIt != props.end()) {
             _recvBuf.reserve(Ichor::v1::any_cast<size_t>(propIt->second));
             ICHOR_LOG_WARN(_logger, "_recvBuf size {}", _recvBuf.size());
@@ -188,9 +214,15 @@ Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::IOUringTcpConnecti
             _recvBuf.resize(2048);
             ICHOR_LOG_WARN(_logger, "_recvBuf size2 {}", _recvBuf.size());
         }
-
-        auto *sqe = _q->getSqeWithData(this, createRecvHandler());
-        io_uring_prep_recv(sqe, _socket, _recvBuf.data(), _recvBuf.size(), 0);
+    }
+    armRecv();
+    _metrics.opened();
+
+    if(_tlsConnection && isClient()) {
+        // send the ClientHello, the rest of the handshake is driven by received data
+        std::ignore = _ssl->TLSDoHandshake(*_tlsConnection);
+        _ssl->TLSDrainPending(*_tlsConnection, _tlsPendingOut);
+        co_await flushTLSPending();
     }
 
     co_return {};
@@ -200,6 +232,13 @@ template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1:
 Ichor::Task<void> Ichor::v1::IOUringTcpConnectionService<InterfaceT>::stop() {
     _quit = true;
     INTERNAL_IO_DEBUG("quit");
+    _metrics.closed();
+    // sends in flight still complete, but nobody may submit on the socket number anymore
+    if(_sendGuard) {
+        _sendGuard->closed = true;
+    }
+    // release senders still waiting on a handshake that will never finish
+    _tlsHandshakeDone.set();
 
     if(_socket >= 0) {
         if(_q->getKernelVersion() >= Version{5, 19, 0}) {
@@ -252,6 +291,9 @@ Ichor::Task<void> Ichor::v1::IOUringTcpConnectionService<InterfaceT>::stop() {
         _socket = 0;
     }
 
+    _tlsConnection.reset();
+    _tlsContext.reset();
+
     co_return;
 }
 
@@ -275,6 +317,40 @@ void Ichor::v1::IOUringTcpConnectionService<InterfaceT>::removeDependencyInstanc
     _q = nullptr;
 }
 
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+void Ichor::v1::IOUringTcpConnectionService<InterfaceT>::addDependencyInstance(Ichor::ScopedServiceProxy<ISSL*> ssl, IService&) noexcept {
+    _ssl = std::move(ssl);
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+void Ichor::v1::IOUringTcpConnectionService<InterfaceT>::removeDependencyInstance(Ichor::ScopedServiceProxy<ISSL*>, IService&) noexcept {
+    _ssl = nullptr;
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+void Ichor::v1::IOUringTcpConnectionService<InterfaceT>::addDependencyInstance(Ichor::ScopedServiceProxy<IMetricsRegistry*> registry, IService&) {
+    _metrics.attach(**registry);
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+void Ichor::v1::IOUringTcpConnectionService<InterfaceT>::removeDependencyInstance(Ichor::ScopedServiceProxy<IMetricsRegistry*>, IService&) noexcept {
+    _metrics.detach();
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+void Ichor::v1::IOUringTcpConnectionService<InterfaceT>::armRecv() {
+    auto *sqe = _q->getSqeWithData(this, createRecvHandler());
+    if(_buffer) {
+        io_uring_prep_recv_multishot(sqe, _socket, nullptr, 0, 0);
+        sqe->buf_group = static_cast<__u16>(_buffer->getBufferGroupId());
+        sqe->flags |= IOSQE_BUFFER_SELECT;
+    } else {
+        io_uring_prep_recv(sqe, _socket, _recvBuf.data(), _recvBuf.size(), 0);
+    }
+    // needed to cancel the multishot recv when switching to kernel TLS
+    _recvUserData = sqe->user_data;
+}
+
 template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
 std::function<void(io_uring_cqe*)> Ichor::v1::IOUringTcpConnectionService<InterfaceT>::createRecvHandler() noexcept {
     return [this](io_uring_cqe *cqe) {
@@ -286,9 +362,19 @@ std::function<void(io_uring_cqe*)> Ichor::v1::IOUringTcpConnectionService<Interf
             return;
         }
 
+        if(cqe->res == -ECANCELED && _ktlsReceiveSwitching) {
+            // every recv that completed before the cancel has been handled in user space, the socket is now at a record boundary
+            finishKernelTLSReceiveSwitch();
+            armRecv();
+            return;
+        }
+
         // TODO: check for -ENOBUFS and if so, create more provided buffers, swap and re-arm
         if(cqe->res <= 0) {
-            if(cqe->res < 0 && cqe->res != -ECONNRESET) {
+            if(cqe->res == -EIO && _ktlsReceive) {
+                // kernel TLS only passes application data to a plain recv, anything else (close_notify, alerts, key updates) ends up here
+                ICHOR_LOG_TRACE(_logger, "[{}] received non application data record, closing connection", AdvancedService<IOUringTcpConnectionService>::getServiceId());
+            } else if(cqe->res < 0 && cqe->res != -ECONNRESET) {
                 ICHOR_LOG_ERROR(_logger, "recv returned an error {}:{}", cqe->res, strerror(-cqe->res));
             } else {
                 ICHOR_LOG_TRACE(_logger, "recv returned an error {}:{}", cqe->res, strerror(-cqe->res));
@@ -308,36 +394,217 @@ std::function<void(io_uring_cqe*)> Ichor::v1::IOUringTcpConnectionService<Interf
             auto entryData = _buffer->readMemory(entry);
             auto data = std::span<uint8_t const>{reinterpret_cast<uint8_t const*>(entryData.data()), std::min(entryData.size(), static_cast<decltype(entryData.size())>(cqe->res))};
 //            fmt::println("received {} len, entry {}, {} {}", cqe->res, entry, _bufferEntries, _bufferEntrySize);
-            if(_recvHandler) {
-                _recvHandler(data);
-            } else {
-                auto &copy = _queuedMessages.emplace_back();
-                copy.assign(data.begin(), data.end());
-            }
+            onReceived(data);
             _buffer->markEntryAvailableAgain(static_cast<unsigned short>(entry));
         } else {
-            if(_recvHandler) {
-                _recvHandler(std::span<uint8_t const>{_recvBuf.begin(), _recvBuf.begin() + cqe->res});
+            if(_recvHandler || _tlsConnection) {
+                onReceived(std::span<uint8_t const>{_recvBuf.begin(), _recvBuf.begin() + cqe->res});
             } else {
                 _queuedMessages.emplace_back(std::move(_recvBuf));
             }
 
-            auto *sqe = _q->getSqeWithData(this, createRecvHandler());
-            io_uring_prep_recv(sqe, _socket, _recvBuf.data(), _recvBuf.size(), 0);
+            // no recv in flight, so the switch can be done right away
+            if(_ktlsReceiveSwitching) {
+                finishKernelTLSReceiveSwitch();
+            }
+
+            armRecv();
         }
     };
 }
 
 template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
-Ichor::Task<tl::expected<void, Ichor::v1::IOError>> Ichor::v1::IOUringTcpConnectionService<InterfaceT>::sendAsync(std::vector<uint8_t> &&msg) {
-    size_t sent_bytes = 0;
+void Ichor::v1::IOUringTcpConnectionService<InterfaceT>::onReceived(std::span<uint8_t const> data) {
+    _metrics.received(data.size());
 
-    if(_quit) {
-        ICHOR_LOG_TRACE(_logger, "[{}] quitting, no send", AdvancedService<IOUringTcpConnectionService>::getServiceId());
-        co_return tl::unexpected(IOError::SERVICE_QUITTING);
+    if(!_tlsConnection || _ktlsReceive) {
+        deliver(data);
+        return;
+    }
+
+    auto ret = _ssl->TLSDecrypt(*_tlsConnection, data, _tlsPlaintext, _tlsPendingOut);
+
+    if(!_tlsHandshakeDone.is_set() && _ssl->TLSIsHandshakeDone(*_tlsConnection)) {
+        ICHOR_LOG_TRACE(_logger, "[{}] TLS handshake done, resumed session: {}", AdvancedService<IOUringTcpConnectionService>::getServiceId(), _ssl->TLSIsSessionReused(*_tlsConnection));
+        _tlsHandshakeDone.set();
+
+        if(ret && !isClient() && _tlsContext->allowsKernelOffload()) {
+            // the recv that is in flight may already hold ciphertext, so it has to finish before the kernel can take over
+            _ktlsReceiveSwitching = true;
+            if(_buffer) {
+                auto *sqe = _q->getSqeWithData(this, [](io_uring_cqe *cqe) {
+                    INTERNAL_IO_DEBUG("cancel recv res: {} {}", cqe->res, cqe->res < 0 ? strerror(-cqe->res) : "");
+                });
+                io_uring_prep_cancel64(sqe, _recvUserData, 0);
+            }
+        }
+    }
+
+    if(_ktlsSend && !_tlsPendingOut.empty()) {
+        // these records would use sequence numbers the kernel already used
+        ICHOR_LOG_ERROR(_logger, "[{}] TLS records produced after handing sends to the kernel, closing connection", AdvancedService<IOUringTcpConnectionService>::getServiceId());
+        _tlsPendingOut.clear();
+        ret = tl::unexpected(TLSConnectionError::PROTOCOL_ERROR);
+    }
+
+    if(!_tlsPendingOut.empty() && !_tlsFlushScheduled) {
+        _tlsFlushScheduled = true;
+        GetThreadLocalEventQueue().pushEvent<RunFunctionEventAsync>(AdvancedService<IOUringTcpConnectionService>::getServiceId(), [this]() -> AsyncGenerator<IchorBehaviour> {
+            co_await flushTLSPending();
+            co_return {};
+        });
+    }
+
+    if(!_tlsPlaintext.empty()) {
+        deliver(_tlsPlaintext);
+        _tlsPlaintext.clear();
+    }
+
+    if(!ret) {
+        if(ret.error() == TLSConnectionError::CLOSED) {
+            ICHOR_LOG_TRACE(_logger, "[{}] TLS connection closed by peer", AdvancedService<IOUringTcpConnectionService>::getServiceId());
+        } else {
+            ICHOR_LOG_ERROR(_logger, "[{}] TLS error, closing connection", AdvancedService<IOUringTcpConnectionService>::getServiceId());
+        }
+        GetThreadLocalEventQueue().pushEvent<StopServiceEvent>(AdvancedService<IOUringTcpConnectionService>::getServiceId(), AdvancedService<IOUringTcpConnectionService>::getServiceId(), true);
+    }
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+void Ichor::v1::IOUringTcpConnectionService<InterfaceT>::deliver(std::span<uint8_t const> data) {
+    if(_recvHandler) {
+        _recvHandler(data);
+    } else {
+        auto &copy = _queuedMessages.emplace_back();
+        copy.assign(data.begin(), data.end());
+    }
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+Ichor::Task<void> Ichor::v1::IOUringTcpConnectionService<InterfaceT>::flushTLSPending() {
+    auto lock = co_await _sendGuard->mutex.lock();
+    _tlsFlushScheduled = false;
+
+    if(_tlsPendingOut.empty() || _quit) {
+        co_return;
+    }
+
+    std::swap(_tlsSendBuf, _tlsPendingOut);
+    auto ret = co_await sendRaw(_tlsSendBuf);
+    _tlsSendBuf.clear();
+
+    if(!ret) {
+        ICHOR_LOG_ERROR(_logger, "[{}] Couldn't send TLS records: {}", AdvancedService<IOUringTcpConnectionService>::getServiceId(), ret.error());
+    }
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+Ichor::Task<tl::expected<void, Ichor::v1::IOError>> Ichor::v1::IOUringTcpConnectionService<InterfaceT>::offloadTLSSend() {
+    _ktlsSendAttempted = true;
+
+    // the last handshake records and session tickets still have to go out before the kernel takes over the sequence numbers
+    if(!_tlsPendingOut.empty()) {
+        std::swap(_tlsSendBuf, _tlsPendingOut);
+        auto ret = co_await sendRaw(_tlsSendBuf);
+        _tlsSendBuf.clear();
+
+        if(!ret) {
+            co_return ret;
+        }
+    }
+
+    _ktlsSend = installKernelTLS(TLSTrafficDirection::SEND);
+    co_return {};
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+void Ichor::v1::IOUringTcpConnectionService<InterfaceT>::finishKernelTLSReceiveSwitch() {
+    _ktlsReceiveSwitching = false;
+    _ktlsReceive = installKernelTLS(TLSTrafficDirection::RECEIVE);
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+bool Ichor::v1::IOUringTcpConnectionService<InterfaceT>::installKernelTLS(TLSTrafficDirection direction) {
+    if(direction == TLSTrafficDirection::SEND && !_tlsPendingOut.empty()) {
+        return false;
     }
 
-    while(sent_bytes < msg.size()) {
+    // fails if the context doesn't allow offloading or if there is still a partial record in user space
+    auto keys = _ssl->TLSExportTrafficKeys(*_tlsConnection, direction);
+
+    if(!keys) {
+        return false;
+    }
+
+    union {
+        tls12_crypto_info_aes_gcm_128 aes128;
+        tls12_crypto_info_aes_gcm_256 aes256;
+        tls12_crypto_info_chacha20_poly1305 chacha20;
+    } info{};
+    socklen_t infoSize{};
+    ScopeGuard sgKeys{[&keys, &info] {
+        explicit_bzero(&*keys, sizeof(*keys));
+        explicit_bzero(&info, sizeof(info));
+    }};
+
+    std::array<uint8_t, 8> recSeq{};
+    for(size_t i = 0; i < recSeq.size(); i++) {
+        recSeq[recSeq.size() - 1 - i] = static_cast<uint8_t>(keys->sequenceNumber >> (i * 8));
+    }
+
+    // the kernel splits the TLS 1.3 iv into a 4 byte salt and an 8 byte explicit part for AES-GCM
+    switch(keys->cipher) {
+        case TLSCipher::AES_128_GCM:
+            info.aes128.info.version = TLS_1_3_VERSION;
+            info.aes128.info.cipher_type = TLS_CIPHER_AES_GCM_128;
+            std::memcpy(info.aes128.key, keys->key.data(), TLS_CIPHER_AES_GCM_128_KEY_SIZE);
+            std::memcpy(info.aes128.salt, keys->iv.data(), TLS_CIPHER_AES_GCM_128_SALT_SIZE);
+            std::memcpy(info.aes128.iv, keys->iv.data() + TLS_CIPHER_AES_GCM_128_SALT_SIZE, TLS_CIPHER_AES_GCM_128_IV_SIZE);
+            std::memcpy(info.aes128.rec_seq, recSeq.data(), TLS_CIPHER_AES_GCM_128_REC_SEQ_SIZE);
+            infoSize = sizeof(info.aes128);
+            break;
+        case TLSCipher::AES_256_GCM:
+            info.aes256.info.version = TLS_1_3_VERSION;
+            info.aes256.info.cipher_type = TLS_CIPHER_AES_GCM_256;
+            std::memcpy(info.aes256.key, keys->key.data(), TLS_CIPHER_AES_GCM_256_KEY_SIZE);
+            std::memcpy(info.aes256.salt, keys->iv.data(), TLS_CIPHER_AES_GCM_256_SALT_SIZE);
+            std::memcpy(info.aes256.iv, keys->iv.data() + TLS_CIPHER_AES_GCM_256_SALT_SIZE, TLS_CIPHER_AES_GCM_256_IV_SIZE);
+            std::memcpy(info.aes256.rec_seq, recSeq.data(), TLS_CIPHER_AES_GCM_256_REC_SEQ_SIZE);
+            infoSize = sizeof(info.aes256);
+            break;
+        case TLSCipher::CHACHA20_POLY1305:
+            info.chacha20.info.version = TLS_1_3_VERSION;
+            info.chacha20.info.cipher_type = TLS_CIPHER_CHACHA20_POLY1305;
+            std::memcpy(info.chacha20.key, keys->key.data(), TLS_CIPHER_CHACHA20_POLY1305_KEY_SIZE);
+            std::memcpy(info.chacha20.iv, keys->iv.data(), TLS_CIPHER_CHACHA20_POLY1305_IV_SIZE);
+            std::memcpy(info.chacha20.rec_seq, recSeq.data(), TLS_CIPHER_CHACHA20_POLY1305_REC_SEQ_SIZE);
+            infoSize = sizeof(info.chacha20);
+            break;
+    }
+
+    if(!_ktlsUlp) {
+        if(::setsockopt(_socket, IPPROTO_TCP, TCP_ULP, "tls", sizeof("tls")) != 0) {
+            ICHOR_LOG_DEBUG(_logger, "[{}] kernel TLS not available, continuing in user space: {}", AdvancedService<IOUringTcpConnectionService>::getServiceId(), mapErrnoToError(errno));
+            return false;
+        }
+        _ktlsUlp = true;
+    }
+
+    // user space TLS still has a valid state if this fails, so there's nothing to undo
+    if(::setsockopt(_socket, SOL_TLS, direction == TLSTrafficDirection::SEND ? TLS_TX : TLS_RX, &info, infoSize) != 0) {
+        ICHOR_LOG_DEBUG(_logger, "[{}] couldn't install kernel TLS {} keys, continuing in user space: {}", AdvancedService<IOUringTcpConnectionService>::getServiceId(), direction == TLSTrafficDirection::SEND ? "send" : "receive", mapErrnoToError(errno));
+        return false;
+    }
+
+    ICHOR_LOG_TRACE(_logger, "[{}] kernel TLS {} enabled", AdvancedService<IOUringTcpConnectionService>::getServiceId(), direction == TLSTrafficDirection::SEND ? "send" : "receive");
+    return true;
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+Ichor::Task<tl::expected<void, Ichor::v1::IOError>> Ichor::v1::IOUringTcpConnectionService<InterfaceT>::sendRaw(std::span<uint8_t const> data) {
+    size_t sent_bytes = 0;
+
+    while(sent_bytes < data.size()) {
         if(_quit) {
             ICHOR_LOG_TRACE(_logger, "[{}] quitting, no send", AdvancedService<IOUringTcpConnectionService>::getServiceId());
             co_return tl::unexpected(IOError::SERVICE_QUITTING);
@@ -349,7 +616,7 @@ Ichor::Task<tl::expected<void, Ichor::v1::IOError>> Ichor::v1::IOUringTcpConnect
             res = cqe->res;
             evt.set();
         });
-        io_uring_prep_send(sqe, _socket, msg.data() + sent_bytes, msg.size() - sent_bytes, MSG_NOSIGNAL);
+        io_uring_prep_send(sqe, _socket, data.data() + sent_bytes, data.size() - sent_bytes, MSG_NOSIGNAL);
         co_await evt;
         if(res < 0) {
             auto ret = mapErrnoToError(res);
@@ -360,23 +627,106 @@ Ichor::Task<tl::expected<void, Ichor::v1::IOError>> Ichor::v1::IOUringTcpConnect
 
         sent_bytes += static_cast<size_t>(res);
     }
+    _metrics.sent(sent_bytes);
 
     INTERNAL_IO_DEBUG("sending done");
     co_return {};
 }
 
 template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
-Ichor::Task<tl::expected<void, Ichor::v1::IOError>> Ichor::v1::IOUringTcpConnectionService<InterfaceT>::sendAsync(std::vector<std::vector<uint8_t>> &&msgs) {
+Ichor::Task<tl::expected<void, Ichor::v1::IOError>> Ichor::v1::IOUringTcpConnectionService<InterfaceT>::sendAsync(std::vector<uint8_t> &&msg) {
     if(_quit) {
         ICHOR_LOG_TRACE(_logger, "[{}] quitting, no send", AdvancedService<IOUringTcpConnectionService>::getServiceId());
         co_return tl::unexpected(IOError::SERVICE_QUITTING);
     }
 
+    if(_tlsConnection && !_ktlsSend) {
+        co_await _tlsHandshakeDone;
+    }
+
+    auto lock = co_await _sendGuard->mutex.lock();
+
+    if(_quit) {
+        co_return tl::unexpected(IOError::SERVICE_QUITTING);
+    }
+
+    if(!_tlsConnection || _ktlsSend) {
+        co_return co_await sendRaw(msg);
+    }
+
+    if(!_ktlsSendAttempted) {
+        auto offloadRet = co_await offloadTLSSend();
+
+        if(!offloadRet) {
+            co_return offloadRet;
+        }
+    }
+
+    if(_ktlsSend) {
+        co_return co_await sendRaw(msg);
+    }
+
+    // pending records were produced before this message and have to keep their place in the stream
+    std::swap(_tlsSendBuf, _tlsPendingOut);
+    auto encRet = _ssl->TLSEncrypt(*_tlsConnection, msg, _tlsSendBuf);
+
+    if(!encRet) {
+        _tlsSendBuf.clear();
+        ICHOR_LOG_ERROR(_logger, "[{}] Couldn't encrypt message", AdvancedService<IOUringTcpConnectionService>::getServiceId());
+        co_return tl::unexpected(IOError::FAILED);
+    }
+
+    auto ret = co_await sendRaw(_tlsSendBuf);
+    _tlsSendBuf.clear();
+    co_return ret;
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+Ichor::Task<tl::expected<void, Ichor::v1::IOError>> Ichor::v1::IOUringTcpConnectionService<InterfaceT>::sendAsync(std::vector<std::vector<uint8_t>> &&msgs) {
     if(_quit) {
         ICHOR_LOG_TRACE(_logger, "[{}] quitting, no send", AdvancedService<IOUringTcpConnectionService>::getServiceId());
         co_return tl::unexpected(IOError::SERVICE_QUITTING);
     }
 
+    if(_tlsConnection && !_ktlsSend) {
+        co_await _tlsHandshakeDone;
+    }
+
+    auto lock = co_await _sendGuard->mutex.lock();
+
+    if(_quit) {
+        co_return tl::unexpected(IOError::SERVICE_QUITTING);
+    }
+
+    if(_tlsConnection && !_ktlsSend) {
+        if(!_ktlsSendAttempted) {
+            auto offloadRet = co_await offloadTLSSend();
+
+            if(!offloadRet) {
+                co_return offloadRet;
+            }
+        }
+
+        // with kernel TLS the plaintext path below is used, the kernel creates the records
+        if(!_ktlsSend) {
+            // encrypt everything into one buffer, which gets sent in one go
+            std::swap(_tlsSendBuf, _tlsPendingOut);
+            for(auto const &msg : msgs) {
+                auto encRet = _ssl->TLSEncrypt(*_tlsConnection, msg, _tlsSendBuf);
+
+                if(!encRet) {
+                    _tlsSendBuf.clear();
+                    ICHOR_LOG_ERROR(_logger, "[{}] Couldn't encrypt message", AdvancedService<IOUringTcpConnectionService>::getServiceId());
+                    co_return tl::unexpected(IOError::FAILED);
+                }
+            }
+
+            auto ret = co_await sendRaw(_tlsSendBuf);
+            _tlsSendBuf.clear();
+            co_return ret;
+        }
+    }
+
     AsyncManualResetEvent evt{};
     int32_t res{};
     uint64_t totalBytes{};
@@ -422,6 +772,7 @@ Ichor::Task<tl::expected<void, Ichor::v1::IOError>> Ichor::v1::IOUringTcpConnect
     if(static_cast<uint64_t>(res) != totalBytes) {
         std::terminate();
     }
+    _metrics.sent(totalBytes);
 
     INTERNAL_IO_DEBUG("sending done");
     co_return {};
@@ -439,13 +790,18 @@ uint64_t Ichor::v1::IOUringTcpConnectionService<InterfaceT>::getPriority() {
 
 template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
 bool Ichor::v1::IOUringTcpConnectionService<InterfaceT>::isClient() const noexcept {
-    return AdvancedService<IOUringTcpConnectionService>::getProperties().find("Socket") == AdvancedService<IOUringTcpConnectionService>::getProperties().end();
+    return !AdvancedService<IOUringTcpConnectionService>::getProperties().contains(PropertyKeys::Socket);
 }
 
 template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
 void Ichor::v1::IOUringTcpConnectionService<InterfaceT>::setReceiveHandler(std::function<void(std::span<uint8_t const>)> recvHandler) {
     _recvHandler = recvHandler;
 
+    // clearing the handler keeps whatever is queued for the next one
+    if(!_recvHandler) {
+        return;
+    }
+
     for(auto &msg : _queuedMessages) {
         _recvHandler(msg);
     }
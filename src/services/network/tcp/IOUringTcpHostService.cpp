@@ -1,6 +1,7 @@
 #include <ichor/DependencyManager.h>
 #include <ichor/services/network/tcp/IOUringTcpHostService.h>
 #include <ichor/services/network/tcp/IOUringTcpConnectionService.h>
+#include <ichor/services/network/tcp/IOUringBroadcast.h>
 #include <ichor/events/RunFunctionEvent.h>
 #include <ichor/ScopeGuard.h>
 #include <ichor/Filter.h>
@@ -15,21 +16,25 @@
 Ichor::v1::IOUringTcpHostService::IOUringTcpHostService(DependencyRegister &reg, Properties props) : AdvancedService(std::move(props)), _socket(-1), _bindFd(), _priority(INTERNAL_EVENT_PRIORITY), _quit() {
     reg.registerDependency<ILogger>(this, DependencyFlags::REQUIRED);
     reg.registerDependency<IIOUringQueue>(this, DependencyFlags::REQUIRED);
+    reg.registerDependency<IHostConnectionService>(this, DependencyFlags::ALLOW_MULTIPLE);
 }
 
 Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::IOUringTcpHostService::start() {
-    if(auto propIt = getProperties().find("Priority"); propIt != getProperties().end()) {
-        _priority = Ichor::v1::any_cast<uint64_t>(propIt->second);
+    if(auto const *priority = getProperties().get(PropertyKeys::Priority); priority != nullptr) {
+        _priority = *priority;
     }
-    if(auto propIt = getProperties().find("ListenBacklogSize"); propIt != getProperties().end()) {
-        _listenBacklogSize = Ichor::v1::any_cast<uint16_t>(propIt->second);
+    if(auto const *listenBacklogSize = getProperties().get(PropertyKeys::ListenBacklogSize); listenBacklogSize != nullptr) {
+        _listenBacklogSize = *listenBacklogSize;
     }
-	if(auto propIt = getProperties().find("BufferEntries"); propIt != getProperties().end()) {
-		_bufferEntries = Ichor::v1::any_cast<uint32_t>(propIt->second);
+	if(auto const *bufferEntries = getProperties().get(PropertyKeys::BufferEntries); bufferEntries != nullptr) {
+		_bufferEntries = *bufferEntries;
 	}
-	if(auto propIt = getProperties().find("BufferEntrySize"); propIt != getProperties().end()) {
-		_bufferEntrySize = Ichor::v1::any_cast<uint32_t>(propIt->second);
+	if(auto const *bufferEntrySize = getProperties().get(PropertyKeys::BufferEntrySize); bufferEntrySize != nullptr) {
+		_bufferEntrySize = *bufferEntrySize;
 	}
+    if(auto propIt = getProperties().find("TLSContext"); propIt != getProperties().end()) {
+        _tlsContext = Ichor::v1::any_cast<std::shared_ptr<TLSContext>>(propIt->second);
+    }
 
 
     if(_q->getKernelVersion() >= Version{5, 19, 0}) {
@@ -93,16 +98,15 @@ Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::IOUringTcpHostServ
     sockaddr_in address{};
     address.sin_family = AF_INET;
 
-    auto const addressProp = getProperties().find("Address");
+    auto const *hostname = getProperties().get(PropertyKeys::Address);
 
-    if(addressProp != cend(getProperties())) {
-        auto hostname = Ichor::v1::any_cast<std::string>(addressProp->second);
-        if(::inet_aton(hostname.c_str(), &address.sin_addr) != 0) {
-            auto *hp = ::gethostbyname(hostname.c_str());
+    if(hostname != nullptr) {
+        if(::inet_aton(hostname->c_str(), &address.sin_addr) != 0) {
+            auto *hp = ::gethostbyname(hostname->c_str());
             if (hp == nullptr) {
                 close(_socket);
                 _socket = -1;
-                ICHOR_LOG_ERROR(_logger, "Couldn't get host by name for hostname {}: {}", hostname, mapErrnoToError(errno));
+                ICHOR_LOG_ERROR(_logger, "Couldn't get host by name for hostname {}: {}", *hostname, mapErrnoToError(errno));
                 co_return tl::unexpected(StartError::FAILED);
             }
 
@@ -111,7 +115,14 @@ Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::IOUringTcpHostServ
     } else {
         address.sin_addr.s_addr = INADDR_ANY;
     }
-    address.sin_port = ::htons(Ichor::v1::any_cast<uint16_t>((getProperties())["Port"]));
+    auto const *port = getProperties().get(PropertyKeys::Port);
+    if(port == nullptr) {
+        close(_socket);
+        _socket = -1;
+        ICHOR_LOG_ERROR(_logger, "Missing port");
+        co_return tl::unexpected(StartError::FAILED);
+    }
+    address.sin_port = ::htons(*port);
 
     // io_uring_prep_bind is not yet available in the kernel.
     _bindFd = ::bind(_socket, (sockaddr *)&address, sizeof(address));
@@ -119,7 +130,7 @@ Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::IOUringTcpHostServ
     if(_bindFd == -1) {
         close(_socket);
         _socket = -1;
-        ICHOR_LOG_ERROR(_logger, "Couldn't bind socket with address {} port {}: {}", addressProp == cend(getProperties()) ? std::string{"ANY"} : Ichor::v1::any_cast<std::string>(addressProp->second), Ichor::v1::any_cast<uint16_t>((getProperties())["Port"]), mapErrnoToError(errno));
+        ICHOR_LOG_ERROR(_logger, "Couldn't bind socket with address {} port {}: {}", hostname == nullptr ? std::string_view{"ANY"} : std::string_view{*hostname}, *port, mapErrnoToError(errno));
         co_return tl::unexpected(StartError::FAILED);
     }
 
@@ -196,6 +207,8 @@ Ichor::Task<void> Ichor::v1::IOUringTcpHostService::stop() {
         _socket = 0;
     }
 
+    _tlsContext.reset();
+
     co_return;
 }
 
@@ -215,6 +228,28 @@ void Ichor::v1::IOUringTcpHostService::removeDependencyInstance(Ichor::ScopedSer
     _q = nullptr;
 }
 
+void Ichor::v1::IOUringTcpHostService::addDependencyInstance(Ichor::ScopedServiceProxy<IHostConnectionService*> connection, IService &isvc) noexcept {
+    auto const &props = isvc.getProperties();
+    auto const *hostServiceId = props.get(PropertyKeys::TcpHostService);
+
+    // also gets connections of other hosts and connections layered on top of these, e.g. websockets
+    if(hostServiceId == nullptr || *hostServiceId != getServiceId()) {
+        return;
+    }
+
+    // only set for plaintext connections
+    std::shared_ptr<SocketSendGuard> sendGuard{};
+    if(auto const *guard = props.get(PropertyKeys::SendGuard); guard != nullptr) {
+        sendGuard = *guard;
+    }
+
+    _connections.emplace(isvc.getServiceId(), HostConnection{std::move(connection), std::move(sendGuard)});
+}
+
+void Ichor::v1::IOUringTcpHostService::removeDependencyInstance(Ichor::ScopedServiceProxy<IHostConnectionService*>, IService &isvc) noexcept {
+    _connections.erase(isvc.getServiceId());
+}
+
 void Ichor::v1::IOUringTcpHostService::setPriority(uint64_t priority) {
     _priority = priority;
 }
@@ -223,6 +258,45 @@ uint64_t Ichor::v1::IOUringTcpHostService::getPriority() {
     return _priority;
 }
 
+Ichor::Task<tl::expected<uint64_t, Ichor::v1::IOError>> Ichor::v1::IOUringTcpHostService::broadcastAsync(SharedMessage msg) {
+    if(_quit) {
+        co_return tl::unexpected(IOError::SERVICE_QUITTING);
+    }
+
+    // holding on to the guards keeps them valid for the whole broadcast, even if connections go away in the meantime
+    std::vector<std::shared_ptr<SocketSendGuard>> sockets;
+    std::vector<ServiceIdType> tlsConnections;
+    sockets.reserve(_connections.size());
+    for(auto const &[id, conn] : _connections) {
+        if(conn.sendGuard) {
+            sockets.push_back(conn.sendGuard);
+        } else {
+            tlsConnections.push_back(id);
+        }
+    }
+
+    uint64_t sent = co_await broadcastToSockets(**_q, getServiceId(), sockets, *msg);
+
+    // every TLS connection has its own keys and sequence numbers, so these need their own copy
+    for(auto id : tlsConnections) {
+        auto connIt = _connections.find(id);
+
+        if(_quit || connIt == _connections.end()) {
+            continue;
+        }
+
+        auto ret = co_await connIt->second.connection->sendAsync(std::vector<uint8_t>(*msg));
+
+        if(ret) {
+            sent++;
+        }
+    }
+
+    ICHOR_LOG_TRACE(_logger, "broadcast {} bytes to {}/{} connections", msg->size(), sent, sockets.size() + tlsConnections.size());
+
+    co_return sent;
+}
+
 std::function<void(io_uring_cqe *)> Ichor::v1::IOUringTcpHostService::createAcceptHandler() noexcept {
     return [this](io_uring_cqe *cqe) {
         INTERNAL_IO_DEBUG("accept res: {} {}", cqe->res, cqe->res < 0 ? strerror(-cqe->res) : "");
@@ -240,7 +314,7 @@ std::function<void(io_uring_cqe *)> Ichor::v1::IOUringTcpHostService::createAcce
             return;
         }
 
-        if(_logger->getLogLevel() == LogLevel::LOG_TRACE) {
+        if(MIN_LOG_LEVEL <= LogLevel::LOG_TRACE && _logger->getLogLevel() == LogLevel::LOG_TRACE) {
             sockaddr_in client_addr{};
             socklen_t addr_size = sizeof(client_addr);
             if(getpeername(cqe->res, (struct sockaddr *)&client_addr, &addr_size) != 0) {
@@ -252,19 +326,24 @@ std::function<void(io_uring_cqe *)> Ichor::v1::IOUringTcpHostService::createAcce
         }
 
         Properties props{};
-        props.reserve(7);
-        props.emplace("Priority", Ichor::v1::make_any<uint64_t>(_priority));
-        props.emplace("Socket", Ichor::v1::make_any<int>(cqe->res));
-        props.emplace("TimeoutSendUs", Ichor::v1::make_any<int64_t>(_sendTimeout));
-        props.emplace("TimeoutRecvUs", Ichor::v1::make_any<int64_t>(_recvTimeout));
-        props.emplace("TcpHostService", Ichor::v1::make_any<ServiceIdType>(getServiceId()));
+        props.reserve(8);
+        props.set(PropertyKeys::Priority, _priority);
+        props.set(PropertyKeys::Socket, cqe->res);
+        props.set(PropertyKeys::TimeoutSendUs, _sendTimeout);
+        props.set(PropertyKeys::TimeoutRecvUs, _recvTimeout);
+        props.set(PropertyKeys::TcpHostService, getServiceId());
 		if(_bufferEntries) {
-			props.emplace("BufferEntries", Ichor::v1::make_any<uint32_t>(*_bufferEntries));
+			props.set(PropertyKeys::BufferEntries, *_bufferEntries);
 		}
 		if(_bufferEntrySize) {
-			props.emplace("BufferEntrySize", Ichor::v1::make_any<uint32_t>(*_bufferEntrySize));
+			props.set(PropertyKeys::BufferEntrySize, *_bufferEntrySize);
 		}
-        _connections.emplace_back(GetThreadLocalManager().template createServiceManager<IOUringTcpConnectionService<IHostConnectionService>, IConnectionService, IHostConnectionService>(std::move(props))->getServiceId());
+        if(_tlsContext) {
+            props.emplace("TLSContext", Ichor::v1::make_unformattable_any<std::shared_ptr<TLSContext>>(_tlsContext));
+        } else {
+            props.emplace(PropertyKeys::SendGuard, Ichor::v1::make_unformattable_any<std::shared_ptr<SocketSendGuard>>(std::make_shared<SocketSendGuard>(cqe->res)));
+        }
+        GetThreadLocalManager().template createServiceManager<IOUringTcpConnectionService<IHostConnectionService>, IConnectionService, IHostConnectionService>(std::move(props));
 
         if(_q->getKernelVersion() < Version{5, 19, 0}) {
             auto *sqe = _q->getSqeWithData(this, createAcceptHandler());
@@ -11,6 +11,9 @@
 #include <fcntl.h>
 #include <poll.h>
 #include <thread>
+#ifdef ICHOR_USE_EPOLL
+#include <sys/epoll.h>
+#endif
 #include <ichor/ScopedServiceProxy.h>
 
 
@@ -18,21 +21,24 @@ template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1:
 Ichor::v1::TcpConnectionService<InterfaceT>::TcpConnectionService(DependencyRegister &reg, Properties props) : AdvancedService<TcpConnectionService<InterfaceT>>(std::move(props)), _socket(-1), _attempts(), _priority(INTERNAL_EVENT_PRIORITY), _quit() {
     reg.registerDependency<ILogger>(this, DependencyFlags::REQUIRED);
     reg.registerDependency<ITimerFactory>(this, DependencyFlags::REQUIRED);
+    reg.registerDependency<IMetricsRegistry>(this, DependencyFlags::NONE);
+#ifdef ICHOR_USE_EPOLL
+    reg.registerDependency<IEpollQueue>(this, DependencyFlags::NONE);
+#endif
 }
 
 template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
 Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::TcpConnectionService<InterfaceT>::start() {
-    if(auto propIt = AdvancedService<TcpConnectionService>::getProperties().find("Priority"); propIt != AdvancedService<TcpConnectionService>::getProperties().end()) {
-        _priority = Ichor::v1::any_cast<uint64_t>(propIt->second);
+    auto const &props = AdvancedService<TcpConnectionService>::getProperties();
+    if(auto const *priority = props.get(PropertyKeys::Priority); priority != nullptr) {
+        _priority = *priority;
     }
-    if(auto propIt = AdvancedService<TcpConnectionService>::getProperties().find("TimeoutSendUs"); propIt != AdvancedService<TcpConnectionService>::getProperties().end()) {
-        _sendTimeout = Ichor::v1::any_cast<int64_t>(propIt->second);
+    if(auto const *sendTimeout = props.get(PropertyKeys::TimeoutSendUs); sendTimeout != nullptr) {
+        _sendTimeout = *sendTimeout;
     }
 
-    if(AdvancedService<TcpConnectionService>::getProperties().contains("Socket")) {
-        if(auto propIt = AdvancedService<TcpConnectionService>::getProperties().find("Socket"); propIt != AdvancedService<TcpConnectionService>::getProperties().end()) {
-            _socket = Ichor::v1::any_cast<int>(propIt->second);
-        }
+    if(auto const *existingSocket = props.get(PropertyKeys::Socket); existingSocket != nullptr) {
+        _socket = *existingSocket;
 
         int setting = 1;
         ::setsockopt(_socket, IPPROTO_TCP, TCP_NODELAY, &setting, sizeof(setting));
@@ -43,18 +49,18 @@ Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::TcpConnectionServi
 
         ICHOR_LOG_DEBUG(_logger, "[{}] Starting TCP connection for existing socket", AdvancedService<TcpConnectionService>::getServiceId());
     } else {
-        auto addrIt = AdvancedService<TcpConnectionService>::getProperties().find("Address");
-        auto portIt = AdvancedService<TcpConnectionService>::getProperties().find("Port");
+        auto const *addr = props.get(PropertyKeys::Address);
+        auto const *port = props.get(PropertyKeys::Port);
 
-        if(addrIt == AdvancedService<TcpConnectionService>::getProperties().end()) {
+        if(addr == nullptr) {
             ICHOR_LOG_ERROR(_logger, "[{}] Missing address", AdvancedService<TcpConnectionService>::getServiceId());
             co_return tl::unexpected(StartError::FAILED);
         }
-        if(portIt == AdvancedService<TcpConnectionService>::getProperties().end()) {
+        if(port == nullptr) {
             ICHOR_LOG_ERROR(_logger, "[{}] Missing port", AdvancedService<TcpConnectionService>::getServiceId());
             co_return tl::unexpected(StartError::FAILED);
         }
-        ICHOR_LOG_TRACE(_logger, "[{}] connecting to {}:{}", AdvancedService<TcpConnectionService>::getServiceId(), Ichor::v1::any_cast<std::string&>(addrIt->second), Ichor::v1::any_cast<uint16_t>(portIt->second));
+        ICHOR_LOG_TRACE(_logger, "[{}] connecting to {}:{}", AdvancedService<TcpConnectionService>::getServiceId(), *addr, *port);
 
         // The start function possibly gets called multiple times due to trying to recover from not being able to connect
         if(_socket == -1) {
@@ -74,9 +80,9 @@ Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::TcpConnectionServi
 
         sockaddr_in address{};
         address.sin_family = AF_INET;
-        address.sin_port = htons(Ichor::v1::any_cast<uint16_t>(portIt->second));
+        address.sin_port = htons(*port);
 
-        int ret = inet_pton(AF_INET, Ichor::v1::any_cast<std::string&>(addrIt->second).c_str(), &address.sin_addr);
+        int ret = inet_pton(AF_INET, addr->c_str(), &address.sin_addr);
         if(ret == 0) {
             fmt::println("inet_pton invalid address for given address family (has to be ipv4-valid address)");
             co_return tl::unexpected(Ichor::StartError::FAILED);
@@ -148,6 +154,24 @@ Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::TcpConnectionServi
         ICHOR_LOG_DEBUG(_logger, "[{}] Starting TCP connection for {}:{}", AdvancedService<TcpConnectionService>::getServiceId(), ip, ::ntohs(address.sin_port));
     }
 
+    _metrics.opened();
+
+#ifdef ICHOR_USE_EPOLL
+    if(_epollQueue) {
+        auto ret = _epollQueue->registerFd(_socket, EPOLLIN | EPOLLRDHUP, [this](uint32_t) {
+            recvHandler();
+        });
+
+        if(ret) {
+            _registeredWithEpoll = true;
+            // data may have arrived before registering, level-triggered epoll reports it right away
+            co_return {};
+        }
+
+        ICHOR_LOG_WARN(_logger, "[{}] Couldn't register socket with epoll: {}, polling instead", AdvancedService<TcpConnectionService>::getServiceId(), ret.error());
+    }
+#endif
+
     _timer = _timerFactory->createTimer();
     _timer->setFireOnce(true);
     _timer->setChronoInterval(20ms);
@@ -164,6 +188,9 @@ Ichor::Task<void> Ichor::v1::TcpConnectionService<InterfaceT>::stop() {
     _quit = true;
     ICHOR_LOG_INFO(_logger, "[{}] stopping service", AdvancedService<TcpConnectionService>::getServiceId());
 
+    stopWatchingSocket();
+    _metrics.closed();
+
     if(_socket >= 0) {
         ::shutdown(_socket, SHUT_RDWR);
         ::close(_socket);
@@ -194,6 +221,29 @@ void Ichor::v1::TcpConnectionService<InterfaceT>::removeDependencyInstance(Ichor
     _timerFactory = nullptr;
 }
 
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+void Ichor::v1::TcpConnectionService<InterfaceT>::addDependencyInstance(Ichor::ScopedServiceProxy<IMetricsRegistry*> registry, IService &) {
+    _metrics.attach(**registry);
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+void Ichor::v1::TcpConnectionService<InterfaceT>::removeDependencyInstance(Ichor::ScopedServiceProxy<IMetricsRegistry*>, IService&) {
+    _metrics.detach();
+}
+
+#ifdef ICHOR_USE_EPOLL
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+void Ichor::v1::TcpConnectionService<InterfaceT>::addDependencyInstance(Ichor::ScopedServiceProxy<IEpollQueue*> q, IService &) {
+    _epollQueue = std::move(q);
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+void Ichor::v1::TcpConnectionService<InterfaceT>::removeDependencyInstance(Ichor::ScopedServiceProxy<IEpollQueue*>, IService&) {
+    stopWatchingSocket();
+    _epollQueue = nullptr;
+}
+#endif
+
 template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
 Ichor::Task<tl::expected<void, Ichor::v1::IOError>> Ichor::v1::TcpConnectionService<InterfaceT>::sendAsync(std::vector<uint8_t> &&msg) {
     size_t sent_bytes = 0;
@@ -213,6 +263,7 @@ Ichor::Task<tl::expected<void, Ichor::v1::IOError>> Ichor::v1::TcpConnectionServ
 
         sent_bytes += static_cast<size_t>(ret);
     }
+    _metrics.sent(sent_bytes);
 
     co_return {};
 }
@@ -237,6 +288,7 @@ Ichor::Task<tl::expected<void, Ichor::v1::IOError>> Ichor::v1::TcpConnectionServ
 
             sent_bytes += static_cast<size_t>(ret);
         }
+        _metrics.sent(sent_bytes);
     }
 
     co_return {};
@@ -254,13 +306,17 @@ uint64_t Ichor::v1::TcpConnectionService<InterfaceT>::getPriority() {
 
 template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
 bool Ichor::v1::TcpConnectionService<InterfaceT>::isClient() const noexcept {
-    return AdvancedService<TcpConnectionService>::getProperties().find("Socket") == AdvancedService<TcpConnectionService>::getProperties().end();
+    return !AdvancedService<TcpConnectionService>::getProperties().contains(PropertyKeys::Socket);
 }
 
 template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
 void Ichor::v1::TcpConnectionService<InterfaceT>::setReceiveHandler(std::function<void(std::span<uint8_t const>)> recvHandler) {
     _recvHandler = recvHandler;
 
+    if(!_recvHandler) {
+        return;
+    }
+
     for(auto &msg : _queuedMessages) {
         _recvHandler(msg);
     }
@@ -270,6 +326,9 @@ void Ichor::v1::TcpConnectionService<InterfaceT>::setReceiveHandler(std::functio
 template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
 void Ichor::v1::TcpConnectionService<InterfaceT>::recvHandler() {
     ScopeGuard sg{[this]() {
+        if(!_timer) {
+            return;
+        }
         if(!_quit) {
             if(!_timer->startTimer()) {
                 GetThreadLocalEventQueue().pushEvent<RunFunctionEvent>(AdvancedService<TcpConnectionService>::getServiceId(), [this]() {
@@ -302,6 +361,7 @@ void Ichor::v1::TcpConnectionService<InterfaceT>::recvHandler() {
     }
 
 	if(!msg.empty()) {
+		_metrics.received(msg.size());
 		if(_recvHandler) {
 			_recvHandler(msg);
 		} else {
@@ -312,6 +372,7 @@ void Ichor::v1::TcpConnectionService<InterfaceT>::recvHandler() {
     if(ret == 0) {
         // closed connection
         ICHOR_LOG_INFO(_logger, "[{}] peer closed connection", AdvancedService<TcpConnectionService>::getServiceId());
+        stopWatchingSocket();
         GetThreadLocalEventQueue().pushEvent<StopServiceEvent>(AdvancedService<TcpConnectionService>::getServiceId(), AdvancedService<TcpConnectionService>::getServiceId(), true);
         return;
     }
@@ -321,11 +382,22 @@ void Ichor::v1::TcpConnectionService<InterfaceT>::recvHandler() {
 			return;
 		}
         ICHOR_LOG_ERROR(_logger, "[{}] Error receiving from socket: {}", AdvancedService<TcpConnectionService>::getServiceId(), errno);
+        stopWatchingSocket();
         GetThreadLocalEventQueue().pushEvent<StopServiceEvent>(AdvancedService<TcpConnectionService>::getServiceId(), AdvancedService<TcpConnectionService>::getServiceId(), true);
         return;
     }
 }
 
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+void Ichor::v1::TcpConnectionService<InterfaceT>::stopWatchingSocket() noexcept {
+#ifdef ICHOR_USE_EPOLL
+    if(_registeredWithEpoll) {
+        _epollQueue->unregisterFd(_socket);
+        _registeredWithEpoll = false;
+    }
+#endif
+}
+
 template class Ichor::v1::TcpConnectionService<Ichor::v1::IConnectionService>;
 template class Ichor::v1::TcpConnectionService<Ichor::v1::IHostConnectionService>;
 template class Ichor::v1::TcpConnectionService<Ichor::v1::IClientConnectionService>;
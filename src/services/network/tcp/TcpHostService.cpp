@@ -13,15 +13,21 @@
 #include <netdb.h>
 #include <fcntl.h>
 #include <ichor/ScopedServiceProxy.h>
+#ifdef ICHOR_USE_EPOLL
+#include <sys/epoll.h>
+#endif
 
 Ichor::v1::TcpHostService::TcpHostService(DependencyRegister &reg, Properties props) : AdvancedService(std::move(props)), _socket(-1), _bindFd(), _priority(INTERNAL_EVENT_PRIORITY), _quit() {
     reg.registerDependency<ILogger>(this, DependencyFlags::REQUIRED);
     reg.registerDependency<ITimerFactory>(this, DependencyFlags::REQUIRED);
+#ifdef ICHOR_USE_EPOLL
+    reg.registerDependency<IEpollQueue>(this, DependencyFlags::NONE);
+#endif
 }
 
 Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::TcpHostService::start() {
-    if(auto propIt = getProperties().find("Priority"); propIt != getProperties().end()) {
-        _priority = Ichor::v1::any_cast<uint64_t>(propIt->second);
+    if(auto const *priority = getProperties().get(PropertyKeys::Priority); priority != nullptr) {
+        _priority = *priority;
     }
 
     _newSocketEventHandlerRegistration = GetThreadLocalManager().registerEventHandler<NewSocketEvent>(this, this);
@@ -41,12 +47,9 @@ Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::TcpHostService::st
     sockaddr_in address{};
     address.sin_family = AF_INET;
 
-    auto const addressProp = getProperties().find("Address");
-
-    if(addressProp != cend(getProperties())) {
-        auto hostname = Ichor::v1::any_cast<std::string>(addressProp->second);
-        if(::inet_aton(hostname.c_str(), &address.sin_addr) != 0) {
-            auto *hp = ::gethostbyname(hostname.c_str());
+    if(auto const *hostname = getProperties().get(PropertyKeys::Address); hostname != nullptr) {
+        if(::inet_aton(hostname->c_str(), &address.sin_addr) != 0) {
+            auto *hp = ::gethostbyname(hostname->c_str());
             if (hp == nullptr) {
                 close(_socket);
                 _socket = -1;
@@ -59,7 +62,14 @@ Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::TcpHostService::st
     } else {
         address.sin_addr.s_addr = INADDR_ANY;
     }
-    address.sin_port = ::htons(Ichor::v1::any_cast<uint16_t>((getProperties())["Port"]));
+    auto const *port = getProperties().get(PropertyKeys::Port);
+    if(port == nullptr) {
+        close(_socket);
+        _socket = -1;
+        fmt::println("Missing port");
+        co_return tl::unexpected(StartError::FAILED);
+    }
+    address.sin_port = ::htons(*port);
 
     _bindFd = ::bind(_socket, (sockaddr *)&address, sizeof(address));
 
@@ -77,6 +87,21 @@ Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::TcpHostService::st
         co_return tl::unexpected(StartError::FAILED);
     }
 
+#ifdef ICHOR_USE_EPOLL
+    if(_epollQueue) {
+        auto ret = _epollQueue->registerFd(_socket, EPOLLIN, [this](uint32_t) {
+            acceptHandler();
+        });
+
+        if(ret) {
+            _registeredWithEpoll = true;
+            co_return {};
+        }
+
+        ICHOR_LOG_WARN(_logger, "Couldn't register socket with epoll: {}, polling instead", ret.error());
+    }
+#endif
+
     _timer = _timerFactory->createTimer();
     _timer->setFireOnce(true);
     _timer->setChronoInterval(20ms);
@@ -91,6 +116,8 @@ Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::TcpHostService::st
 Ichor::Task<void> Ichor::v1::TcpHostService::stop() {
     _quit = true;
 
+    stopWatchingSocket();
+
     if(_socket >= 0) {
         ::shutdown(_socket, SHUT_RDWR);
         ::close(_socket);
@@ -118,6 +145,17 @@ void Ichor::v1::TcpHostService::removeDependencyInstance(Ichor::ScopedServicePro
     _timerFactory = nullptr;
 }
 
+#ifdef ICHOR_USE_EPOLL
+void Ichor::v1::TcpHostService::addDependencyInstance(Ichor::ScopedServiceProxy<IEpollQueue*> q, IService &) {
+    _epollQueue = std::move(q);
+}
+
+void Ichor::v1::TcpHostService::removeDependencyInstance(Ichor::ScopedServiceProxy<IEpollQueue*>, IService&) {
+    stopWatchingSocket();
+    _epollQueue = nullptr;
+}
+#endif
+
 void Ichor::v1::TcpHostService::setPriority(uint64_t priority) {
     _priority = priority;
 }
@@ -129,10 +167,10 @@ uint64_t Ichor::v1::TcpHostService::getPriority() {
 Ichor::AsyncGenerator<Ichor::IchorBehaviour> Ichor::v1::TcpHostService::handleEvent(NewSocketEvent const &evt) {
     Properties props{};
     props.reserve(4);
-    props.emplace("Priority", Ichor::v1::make_any<uint64_t>(_priority));
-    props.emplace("Socket", Ichor::v1::make_any<int>(evt.socket));
-    props.emplace("TimeoutSendUs", Ichor::v1::make_any<int64_t>(_sendTimeout));
-    props.emplace("TcpHostService", Ichor::v1::make_any<ServiceIdType>(getServiceId()));
+    props.set(PropertyKeys::Priority, _priority);
+    props.set(PropertyKeys::Socket, evt.socket);
+    props.set(PropertyKeys::TimeoutSendUs, _sendTimeout);
+    props.set(PropertyKeys::TcpHostService, getServiceId());
     _connections.emplace_back(GetThreadLocalManager().template createServiceManager<TcpConnectionService<IHostConnectionService>, IConnectionService, IHostConnectionService>(std::move(props))->getServiceId());
 
     co_return {};
@@ -142,6 +180,9 @@ void Ichor::v1::TcpHostService::acceptHandler() {
     sockaddr_in client_addr{};
     socklen_t client_addr_size = sizeof(client_addr);
     ScopeGuard sg{[this]() {
+        if(!_timer) {
+            return;
+        }
         if(!_quit) {
             _timer->startTimer();
         } else {
@@ -160,6 +201,7 @@ void Ichor::v1::TcpHostService::acceptHandler() {
 			return;
 		}
         ICHOR_LOG_ERROR(_logger, "New connection but accept() returned {} errno {}", newConnection, errno);
+        stopWatchingSocket();
         GetThreadLocalEventQueue().pushEvent<StopServiceEvent>(getServiceId(), getServiceId(), true);
         return;
     }
@@ -170,4 +212,13 @@ void Ichor::v1::TcpHostService::acceptHandler() {
     GetThreadLocalEventQueue().pushPrioritisedEvent<NewSocketEvent>(getServiceId(), _priority, newConnection);
 }
 
+void Ichor::v1::TcpHostService::stopWatchingSocket() noexcept {
+#ifdef ICHOR_USE_EPOLL
+    if(_registeredWithEpoll) {
+        _epollQueue->unregisterFd(_socket);
+        _registeredWithEpoll = false;
+    }
+#endif
+}
+
 #endif
@@ -0,0 +1,336 @@
+#include <ichor/services/network/ws/WsCommon.h>
+#include <ichor/ScopeGuard.h>
+#include <ichor/stl/StringUtils.h>
+#include <base64/base64.h>
+#include <openssl/evp.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#ifdef ICHOR_USE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+    [[nodiscard]] constexpr std::string_view trimWhitespace(std::string_view s) noexcept {
+        while(!s.empty() && (s.front() == ' ' || s.front() == '\t')) {
+            s.remove_prefix(1);
+        }
+        while(!s.empty() && (s.back() == ' ' || s.back() == '\t')) {
+            s.remove_suffix(1);
+        }
+        return s;
+    }
+
+#ifdef ICHOR_USE_ZLIB
+    // Without context takeover, every message starts with a fresh window. That means the streams can be shared by all connections on a thread,
+    // rather than keeping ~300 KiB of zlib state per connection around.
+    struct WsZlibStreams final {
+        WsZlibStreams() noexcept {
+            deflateOk = ::deflateInit2(&deflater, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+            inflateOk = ::inflateInit2(&inflater, -15) == Z_OK;
+        }
+        ~WsZlibStreams() noexcept {
+            if(deflateOk) {
+                ::deflateEnd(&deflater);
+            }
+            if(inflateOk) {
+                ::inflateEnd(&inflater);
+            }
+        }
+        WsZlibStreams(const WsZlibStreams&) = delete;
+        WsZlibStreams(WsZlibStreams&&) = delete;
+        WsZlibStreams& operator=(const WsZlibStreams&) = delete;
+        WsZlibStreams& operator=(WsZlibStreams&&) = delete;
+
+        z_stream deflater{};
+        z_stream inflater{};
+        bool deflateOk{};
+        bool inflateOk{};
+    };
+
+    thread_local WsZlibStreams zlibStreams{};
+
+    constexpr std::array<uint8_t, 4> DEFLATE_TAIL{0x00, 0x00, 0xFF, 0xFF};
+#endif
+}
+
+tl::expected<Ichor::v1::WsFrameHeader, Ichor::v1::WsFrameError> Ichor::v1::parseWsFrameHeader(std::span<uint8_t const> data, bool allowCompressed) noexcept {
+    if(data.size() < 2) {
+        return tl::unexpected(WsFrameError::INCOMPLETE);
+    }
+
+    WsFrameHeader header{};
+    header.fin = (data[0] & 0x80) != 0;
+    header.compressed = (data[0] & 0x40) != 0;
+    header.masked = (data[1] & 0x80) != 0;
+    uint8_t const opcode = data[0] & 0x0F;
+
+    if((data[0] & 0x30) != 0 || (header.compressed && !allowCompressed)) {
+        return tl::unexpected(WsFrameError::PROTOCOL_ERROR);
+    }
+
+    switch(opcode) {
+        case static_cast<uint8_t>(WsOpcode::CONTINUATION):
+        case static_cast<uint8_t>(WsOpcode::TEXT):
+        case static_cast<uint8_t>(WsOpcode::BINARY):
+        case static_cast<uint8_t>(WsOpcode::CLOSE):
+        case static_cast<uint8_t>(WsOpcode::PING):
+        case static_cast<uint8_t>(WsOpcode::PONG):
+            header.opcode = static_cast<WsOpcode>(opcode);
+            break;
+        default:
+            return tl::unexpected(WsFrameError::PROTOCOL_ERROR);
+    }
+
+    bool const control = (opcode & 0x08) != 0;
+    uint8_t const length7 = data[1] & 0x7F;
+    uint32_t headerLength = 2;
+
+    if(control && (!header.fin || length7 > 125 || header.compressed)) {
+        return tl::unexpected(WsFrameError::PROTOCOL_ERROR);
+    }
+    if(header.compressed && header.opcode == WsOpcode::CONTINUATION) {
+        return tl::unexpected(WsFrameError::PROTOCOL_ERROR);
+    }
+
+    if(length7 == 126) {
+        headerLength += 2;
+        if(data.size() < headerLength) {
+            return tl::unexpected(WsFrameError::INCOMPLETE);
+        }
+        header.payloadLength = (static_cast<uint64_t>(data[2]) << 8) | static_cast<uint64_t>(data[3]);
+    } else if(length7 == 127) {
+        headerLength += 8;
+        if(data.size() < headerLength) {
+            return tl::unexpected(WsFrameError::INCOMPLETE);
+        }
+        for(uint32_t i = 0; i < 8; i++) {
+            header.payloadLength = (header.payloadLength << 8) | static_cast<uint64_t>(data[2 + i]);
+        }
+        // the most significant bit MUST be 0
+        if((header.payloadLength >> 63) != 0) {
+            return tl::unexpected(WsFrameError::PROTOCOL_ERROR);
+        }
+    } else {
+        header.payloadLength = length7;
+    }
+
+    if(header.masked) {
+        if(data.size() < headerLength + 4) {
+            return tl::unexpected(WsFrameError::INCOMPLETE);
+        }
+        std::memcpy(header.mask.data(), data.data() + headerLength, 4);
+        headerLength += 4;
+    }
+
+    header.headerLength = headerLength;
+    return header;
+}
+
+uint32_t Ichor::v1::writeWsFrameHeader(std::array<uint8_t, ICHOR_WS_MAX_HEADER_SIZE> &out, WsOpcode opcode, bool fin, bool compressed, uint64_t payloadLength, uint8_t const *mask) noexcept {
+    out[0] = static_cast<uint8_t>((fin ? 0x80 : 0x00) | (compressed ? 0x40 : 0x00) | static_cast<uint8_t>(opcode));
+    uint8_t const maskBit = mask != nullptr ? 0x80 : 0x00;
+    uint32_t len = 2;
+
+    if(payloadLength < 126) {
+        out[1] = static_cast<uint8_t>(maskBit | payloadLength);
+    } else if(payloadLength <= std::numeric_limits<uint16_t>::max()) {
+        out[1] = static_cast<uint8_t>(maskBit | 126);
+        out[2] = static_cast<uint8_t>(payloadLength >> 8);
+        out[3] = static_cast<uint8_t>(payloadLength);
+        len = 4;
+    } else {
+        out[1] = static_cast<uint8_t>(maskBit | 127);
+        for(uint32_t i = 0; i < 8; i++) {
+            out[2 + i] = static_cast<uint8_t>(payloadLength >> ((7 - i) * 8));
+        }
+        len = 10;
+    }
+
+    if(mask != nullptr) {
+        std::memcpy(out.data() + len, mask, 4);
+        len += 4;
+    }
+
+    return len;
+}
+
+void Ichor::v1::applyWsMask(std::span<uint8_t> payload, std::array<uint8_t, 4> mask) noexcept {
+    uint8_t *data = payload.data();
+    uint64_t const len = payload.size();
+    uint64_t i{};
+    uint32_t mask32;
+    std::memcpy(&mask32, mask.data(), 4);
+
+    // every step below is a multiple of 4 bytes, so the mask stays aligned with the payload offset
+#if defined(__AVX2__)
+    __m256i const mask256 = _mm256_set1_epi32(static_cast<int>(mask32));
+    for(; i + 32 <= len; i += 32) {
+        auto *p = reinterpret_cast<__m256i *>(data + i);
+        _mm256_storeu_si256(p, _mm256_xor_si256(_mm256_loadu_si256(p), mask256));
+    }
+#endif
+#if defined(__SSE2__)
+    __m128i const mask128 = _mm_set1_epi32(static_cast<int>(mask32));
+    for(; i + 16 <= len; i += 16) {
+        auto *p = reinterpret_cast<__m128i *>(data + i);
+        _mm_storeu_si128(p, _mm_xor_si128(_mm_loadu_si128(p), mask128));
+    }
+#elif defined(__ARM_NEON)
+    uint8x16_t const mask128 = vreinterpretq_u8_u32(vdupq_n_u32(mask32));
+    for(; i + 16 <= len; i += 16) {
+        vst1q_u8(data + i, veorq_u8(vld1q_u8(data + i), mask128));
+    }
+#endif
+
+    uint64_t const mask64 = (static_cast<uint64_t>(mask32) << 32) | mask32;
+    for(; i + 8 <= len; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        word ^= mask64;
+        std::memcpy(data + i, &word, 8);
+    }
+    for(; i < len; i++) {
+        data[i] ^= mask[i & 3];
+    }
+}
+
+std::string Ichor::v1::createWsAcceptKey(std::string_view key) {
+    std::string input;
+    input.reserve(key.size() + ICHOR_WS_GUID.size());
+    input.append(key);
+    input.append(ICHOR_WS_GUID);
+    // SHA-1 is not used for anything security related in RFC 6455, it only proves the server understood the handshake
+    std::array<uint8_t, 20> digest{};
+    if(EVP_Digest(input.data(), input.size(), digest.data(), nullptr, EVP_sha1(), nullptr) != 1) {
+        return {};
+    }
+    return base64_encode(digest.data(), digest.size());
+}
+
+bool Ichor::v1::wsHeaderContainsToken(std::string_view value, std::string_view token) noexcept {
+    while(!value.empty()) {
+        auto const comma = value.find(',');
+        auto element = value.substr(0, comma);
+        if(auto const semicolon = element.find(';'); semicolon != std::string_view::npos) {
+            element = element.substr(0, semicolon);
+        }
+        element = trimWhitespace(element);
+
+        if(CaseInsensitiveEquals(element, token)) {
+            return true;
+        }
+
+        if(comma == std::string_view::npos) {
+            break;
+        }
+        value.remove_prefix(comma + 1);
+    }
+
+    return false;
+}
+
+#ifdef ICHOR_USE_ZLIB
+bool Ichor::v1::wsDeflate(std::span<uint8_t const> in, std::vector<uint8_t> &out) {
+    auto &streams = zlibStreams;
+    if(!streams.deflateOk || in.size() > std::numeric_limits<uInt>::max()) {
+        return false;
+    }
+
+    auto &strm = streams.deflater;
+    ScopeGuard const resetGuard{[&strm]() {
+        ::deflateReset(&strm);
+    }};
+
+    uint64_t const start = out.size();
+    // deflateBound doesn't account for the sync flush marker
+    out.resize(start + ::deflateBound(&strm, static_cast<uLong>(in.size())) + 16);
+
+    strm.next_in = const_cast<Bytef *>(in.data());
+    strm.avail_in = static_cast<uInt>(in.size());
+    strm.next_out = out.data() + start;
+    strm.avail_out = static_cast<uInt>(out.size() - start);
+
+    if(::deflate(&strm, Z_SYNC_FLUSH) != Z_OK || strm.avail_in != 0) {
+        out.resize(start);
+        return false;
+    }
+
+    uint64_t const written = out.size() - strm.avail_out;
+    // RFC 7692 7.2.1: remove the 0x00 0x00 0xff 0xff the sync flush ends with
+    if(written - start < DEFLATE_TAIL.size() || !std::equal(DEFLATE_TAIL.begin(), DEFLATE_TAIL.end(), out.begin() + static_cast<int64_t>(written - DEFLATE_TAIL.size()))) {
+        out.resize(start);
+        return false;
+    }
+    out.resize(written - DEFLATE_TAIL.size());
+
+    return true;
+}
+
+tl::expected<void, Ichor::v1::WsFrameError> Ichor::v1::wsInflate(std::span<uint8_t const> in, std::vector<uint8_t> &out, uint64_t maxSize) {
+    auto &streams = zlibStreams;
+    if(!streams.inflateOk || in.size() > std::numeric_limits<uInt>::max()) {
+        return tl::unexpected(WsFrameError::PROTOCOL_ERROR);
+    }
+
+    auto &strm = streams.inflater;
+    ScopeGuard const resetGuard{[&strm]() {
+        ::inflateReset(&strm);
+    }};
+
+    uint64_t const start = out.size();
+    uint64_t written = start;
+    bool streamEnd{};
+
+    // RFC 7692 7.2.2: append the 0x00 0x00 0xff 0xff that was removed by the sender
+    for(auto part : {in, std::span<uint8_t const>{DEFLATE_TAIL}}) {
+        strm.next_in = const_cast<Bytef *>(part.data());
+        strm.avail_in = static_cast<uInt>(part.size());
+
+        while(!streamEnd) {
+            if(written == out.size()) {
+                if(written - start >= maxSize) {
+                    out.resize(start);
+                    return tl::unexpected(WsFrameError::MESSAGE_TOO_BIG);
+                }
+                auto const grow = std::min<uint64_t>(std::max<uint64_t>(in.size() * 4, 4096), maxSize - (written - start));
+                out.resize(written + std::min<uint64_t>(grow, std::numeric_limits<uInt>::max()));
+            }
+
+            strm.next_out = out.data() + written;
+            strm.avail_out = static_cast<uInt>(out.size() - written);
+            auto const ret = ::inflate(&strm, Z_SYNC_FLUSH);
+            written = out.size() - strm.avail_out;
+
+            if(ret == Z_STREAM_END) {
+                streamEnd = true;
+            } else if(ret == Z_BUF_ERROR) {
+                // no progress possible: either all input is consumed or more output space is needed
+                if(strm.avail_out != 0) {
+                    break;
+                }
+            } else if(ret != Z_OK) {
+                out.resize(start);
+                return tl::unexpected(WsFrameError::PROTOCOL_ERROR);
+            } else if(strm.avail_in == 0 && strm.avail_out != 0) {
+                break;
+            }
+        }
+
+        if(!streamEnd && strm.avail_in != 0) {
+            out.resize(start);
+            return tl::unexpected(WsFrameError::PROTOCOL_ERROR);
+        }
+    }
+
+    out.resize(written);
+    return {};
+}
+#endif
@@ -0,0 +1,611 @@
+#include <ichor/DependencyManager.h>
+#include <ichor/services/network/ws/WsConnectionService.h>
+#include <ichor/events/RunFunctionEvent.h>
+#include <ichor/stl/StringUtils.h>
+#include <ichor/ScopedServiceProxy.h>
+#include <base64/base64.h>
+#include <random>
+
+namespace {
+    // Shared by all connections on a thread, so that idle connections don't hold on to buffers.
+    thread_local std::vector<uint8_t> unmaskScratch{};
+#ifdef ICHOR_USE_ZLIB
+    thread_local std::vector<uint8_t> inflateScratch{};
+#endif
+    thread_local std::mt19937 maskGenerator{std::random_device{}()};
+
+    constexpr uint64_t MAX_HANDSHAKE_RESPONSE_SIZE = 16 * 1024;
+    constexpr uint64_t MAX_RETAINED_BUFFER_SIZE = 64 * 1024;
+
+    std::array<uint8_t, 4> createMask() noexcept {
+        auto const val = maskGenerator();
+        return {static_cast<uint8_t>(val), static_cast<uint8_t>(val >> 8), static_cast<uint8_t>(val >> 16), static_cast<uint8_t>(val >> 24)};
+    }
+
+    std::vector<uint8_t> createClosePayload(Ichor::v1::WsCloseCode code) {
+        auto const val = static_cast<uint16_t>(code);
+        return std::vector<uint8_t>{static_cast<uint8_t>(val >> 8), static_cast<uint8_t>(val)};
+    }
+
+    std::string_view trimHeaderValue(std::string_view value) noexcept {
+        auto const start = value.find_first_not_of(" \t");
+        if(start == std::string_view::npos) {
+            return {};
+        }
+        return value.substr(start, value.find_last_not_of(" \t") - start + 1);
+    }
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+Ichor::v1::WsConnectionService<InterfaceT>::WsConnectionService(DependencyRegister &reg, Properties props) : AdvancedService<WsConnectionService>(std::move(props)) {
+    reg.registerDependency<ILogger>(this, DependencyFlags::REQUIRED);
+    reg.registerDependency<IEventQueue>(this, DependencyFlags::REQUIRED);
+
+    auto const &properties = AdvancedService<WsConnectionService>::getProperties();
+    if(auto propIt = properties.find("WsHostServiceId"); propIt != properties.end()) {
+        _wsHostServiceId = Ichor::v1::any_cast<ServiceIdType>(propIt->second);
+        reg.registerDependency<IWsHostService>(this, DependencyFlags::REQUIRED | DependencyFlags::ALLOW_MULTIPLE);
+    } else {
+        _isClient = true;
+        reg.registerDependency<IClientConnectionService>(this, DependencyFlags::REQUIRED, properties);
+    }
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::WsConnectionService<InterfaceT>::start() {
+    auto const &props = AdvancedService<WsConnectionService>::getProperties();
+
+    if(auto const *priority = props.get(PropertyKeys::Priority); priority != nullptr) {
+        _priority = *priority;
+    }
+    if(auto propIt = props.find("PerMessageDeflate"); propIt != props.end()) {
+        _perMessageDeflate = Ichor::v1::any_cast<bool>(propIt->second);
+    }
+    if(auto propIt = props.find("MaxMessageSize"); propIt != props.end()) {
+        _maxMessageSize = Ichor::v1::any_cast<uint64_t>(propIt->second);
+    }
+    if(auto propIt = props.find("SendText"); propIt != props.end()) {
+        _sendText = Ichor::v1::any_cast<bool>(propIt->second);
+    }
+#ifndef ICHOR_USE_ZLIB
+    if(_perMessageDeflate) {
+        ICHOR_LOG_WARN(_logger, "WsConnection {} PerMessageDeflate requested, but Ichor has not been compiled with zlib support", AdvancedService<WsConnectionService>::getServiceId());
+        _perMessageDeflate = false;
+    }
+#endif
+
+    _quit = false;
+    _closing = false;
+
+    if(!_isClient) {
+        _connectionServiceId = Ichor::v1::any_cast<ServiceIdType>(props.find("ConnectionServiceId")->second);
+        auto *conn = connection();
+
+        if(conn == nullptr) {
+            ICHOR_LOG_TRACE(_logger, "WsConnection {} upgraded connection {} not available", AdvancedService<WsConnectionService>::getServiceId(), _connectionServiceId);
+            co_return tl::unexpected(StartError::FAILED);
+        }
+
+        _connected = true;
+        conn->setReceiveHandler([this](std::span<uint8_t const> data) {
+            onReceive(data);
+        });
+
+        co_return {};
+    }
+
+    auto const *addr = props.get(PropertyKeys::Address);
+    auto const *port = props.get(PropertyKeys::Port);
+
+    if(addr == nullptr) {
+        ICHOR_LOG_ERROR(_logger, "Missing address");
+        co_return tl::unexpected(StartError::FAILED);
+    }
+    if(port == nullptr) {
+        ICHOR_LOG_ERROR(_logger, "Missing port");
+        co_return tl::unexpected(StartError::FAILED);
+    }
+
+    std::string_view path{"/"};
+    if(auto propIt = props.find("Path"); propIt != props.end()) {
+        path = Ichor::v1::any_cast<std::string const &>(propIt->second);
+    }
+
+    std::array<uint8_t, 16> keyBytes{};
+    for(uint32_t i = 0; i < keyBytes.size(); i += 4) {
+        auto const mask = createMask();
+        std::copy(mask.begin(), mask.end(), keyBytes.begin() + i);
+    }
+    _handshakeKey = base64_encode(keyBytes.data(), keyBytes.size());
+    _handshakeDone.reset();
+
+    std::vector<uint8_t> req;
+    req.reserve(512);
+    fmt::format_to(FmtU8Inserter(req), "GET {} HTTP/1.1\r\nHost: {}:{}\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Key: {}\r\nSec-WebSocket-Version: 13\r\n", path, *addr, *port, _handshakeKey);
+    if(_perMessageDeflate) {
+        fmt::format_to(FmtU8Inserter(req), "Sec-WebSocket-Extensions: permessage-deflate; server_no_context_takeover; client_no_context_takeover\r\n");
+    }
+    fmt::format_to(FmtU8Inserter(req), "\r\n");
+
+    auto sent = co_await _clientConnection->sendAsync(std::move(req));
+
+    if(!sent) {
+        ICHOR_LOG_ERROR(_logger, "WsConnection {} couldn't send handshake: {}", AdvancedService<WsConnectionService>::getServiceId(), sent.error());
+        co_return tl::unexpected(StartError::FAILED);
+    }
+
+    co_await _handshakeDone;
+
+    if(!_connected) {
+        co_return tl::unexpected(StartError::FAILED);
+    }
+
+    ICHOR_LOG_TRACE(_logger, "WsConnection {} handshake done, deflate {}", AdvancedService<WsConnectionService>::getServiceId(), _perMessageDeflate);
+
+    co_return {};
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+Ichor::Task<void> Ichor::v1::WsConnectionService<InterfaceT>::stop() {
+    _quit = true;
+
+    auto *conn = connection();
+    if(conn != nullptr) {
+        if(_connected && !_closing) {
+            _closing = true;
+            co_await sendControlFrame(WsOpcode::CLOSE, createClosePayload(WsCloseCode::GOING_AWAY));
+        }
+
+        // the connection may have gone away while sending
+        conn = connection();
+        if(conn != nullptr) {
+            conn->setReceiveHandler({});
+        }
+    }
+
+    // Upgraded connections belong to us from now on. Client connections are stopped by their factory.
+    if(!_isClient && conn != nullptr) {
+        _queue->pushEvent<StopServiceEvent>(AdvancedService<WsConnectionService>::getServiceId(), _connectionServiceId, true);
+    }
+
+    _connected = false;
+    _recvBuffer = {};
+    _messageBuffer = {};
+    _messageInProgress = false;
+
+    co_return;
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+void Ichor::v1::WsConnectionService<InterfaceT>::addDependencyInstance(Ichor::ScopedServiceProxy<ILogger*> logger, IService &) {
+    _logger = std::move(logger);
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+void Ichor::v1::WsConnectionService<InterfaceT>::removeDependencyInstance(Ichor::ScopedServiceProxy<ILogger*>, IService &) {
+    _logger = nullptr;
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+void Ichor::v1::WsConnectionService<InterfaceT>::addDependencyInstance(Ichor::ScopedServiceProxy<IEventQueue*> q, IService &) {
+    _queue = std::move(q);
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+void Ichor::v1::WsConnectionService<InterfaceT>::removeDependencyInstance(Ichor::ScopedServiceProxy<IEventQueue*>, IService &) {
+    _queue = nullptr;
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+void Ichor::v1::WsConnectionService<InterfaceT>::addDependencyInstance(Ichor::ScopedServiceProxy<IWsHostService*> h, IService &s) {
+    if(s.getServiceId() != _wsHostServiceId) {
+        return;
+    }
+
+    _wsHost = std::move(h);
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+void Ichor::v1::WsConnectionService<InterfaceT>::removeDependencyInstance(Ichor::ScopedServiceProxy<IWsHostService*>, IService &s) {
+    if(s.getServiceId() != _wsHostServiceId) {
+        return;
+    }
+
+    _wsHost = nullptr;
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+void Ichor::v1::WsConnectionService<InterfaceT>::addDependencyInstance(Ichor::ScopedServiceProxy<IClientConnectionService*> c, IService &s) {
+    if(!c->isClient()) {
+        ICHOR_LOG_TRACE(_logger, "connection {} is not a client connection", s.getServiceId());
+        return;
+    }
+
+    _clientConnection = std::move(c);
+    _clientConnection->setReceiveHandler([this](std::span<uint8_t const> data) {
+        onReceive(data);
+    });
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+void Ichor::v1::WsConnectionService<InterfaceT>::removeDependencyInstance(Ichor::ScopedServiceProxy<IClientConnectionService*>, IService &) {
+    _clientConnection = nullptr;
+    _connected = false;
+    // in case the connection went away during the handshake
+    _handshakeDone.set();
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+Ichor::v1::IConnectionService* Ichor::v1::WsConnectionService<InterfaceT>::connection() const noexcept {
+    if(_isClient) {
+        if(_clientConnection == nullptr) {
+            return nullptr;
+        }
+        return *_clientConnection;
+    }
+
+    if(_wsHost == nullptr) {
+        return nullptr;
+    }
+
+    return _wsHost->getUpgradedConnection(_connectionServiceId);
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+void Ichor::v1::WsConnectionService<InterfaceT>::onReceive(std::span<uint8_t const> data) {
+    if(_quit || _closing) {
+        return;
+    }
+
+    if(!_connected) {
+        if(_isClient) {
+            onHandshakeResponse(data);
+        }
+        return;
+    }
+
+    // Only copy into our own buffer if a frame got split over multiple reads, otherwise work on the provided buffer directly.
+    bool const buffered = !_recvBuffer.empty();
+    std::span<uint8_t const> input = data;
+    if(buffered) {
+        _recvBuffer.insert(_recvBuffer.end(), data.begin(), data.end());
+        input = _recvBuffer;
+    }
+
+    uint64_t pos{};
+    while(pos < input.size()) {
+        auto header = parseWsFrameHeader(input.subspan(pos), _perMessageDeflate);
+
+        if(!header) {
+            if(header.error() == WsFrameError::INCOMPLETE) {
+                break;
+            }
+            ICHOR_LOG_TRACE(_logger, "WsConnection {} invalid frame", AdvancedService<WsConnectionService>::getServiceId());
+            close(WsCloseCode::PROTOCOL_ERROR);
+            return;
+        }
+
+        // clients have to mask every frame, servers must not mask any
+        if(header->masked == _isClient) {
+            ICHOR_LOG_TRACE(_logger, "WsConnection {} wrong masking", AdvancedService<WsConnectionService>::getServiceId());
+            close(WsCloseCode::PROTOCOL_ERROR);
+            return;
+        }
+
+        if(header->payloadLength > _maxMessageSize) {
+            close(WsCloseCode::MESSAGE_TOO_BIG);
+            return;
+        }
+
+        uint64_t const payloadStart = pos + header->headerLength;
+        if(input.size() - payloadStart < header->payloadLength) {
+            break;
+        }
+
+        auto payload = input.subspan(payloadStart, header->payloadLength);
+        if(header->masked) {
+            if(buffered) {
+                std::span<uint8_t> writable{_recvBuffer.data() + payloadStart, header->payloadLength};
+                applyWsMask(writable, header->mask);
+            } else {
+                // the provided buffer is read-only and gets recycled by the connection
+                unmaskScratch.assign(payload.begin(), payload.end());
+                applyWsMask(unmaskScratch, header->mask);
+                payload = unmaskScratch;
+            }
+        }
+        pos = payloadStart + header->payloadLength;
+
+        if(!handleFrame(*header, payload)) {
+            return;
+        }
+    }
+
+    if(buffered) {
+        if(pos == _recvBuffer.size()) {
+            if(_recvBuffer.capacity() > MAX_RETAINED_BUFFER_SIZE) {
+                _recvBuffer = {};
+            } else {
+                _recvBuffer.clear();
+            }
+        } else {
+            _recvBuffer.erase(_recvBuffer.begin(), _recvBuffer.begin() + static_cast<int64_t>(pos));
+        }
+    } else if(pos < input.size()) {
+        _recvBuffer.assign(input.begin() + static_cast<int64_t>(pos), input.end());
+    }
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+void Ichor::v1::WsConnectionService<InterfaceT>::onHandshakeResponse(std::span<uint8_t const> data) {
+    _handshakeBuffer.append(reinterpret_cast<char const *>(data.data()), data.size());
+    auto const end = _handshakeBuffer.find("\r\n\r\n");
+
+    if(end == std::string::npos) {
+        if(_handshakeBuffer.size() > MAX_HANDSHAKE_RESPONSE_SIZE) {
+            ICHOR_LOG_ERROR(_logger, "WsConnection {} handshake response too big", AdvancedService<WsConnectionService>::getServiceId());
+            _handshakeBuffer = {};
+            _handshakeDone.set();
+        }
+        return;
+    }
+
+    auto const expectedAccept = createWsAcceptKey(_handshakeKey);
+    bool statusOk{};
+    bool upgradeOk{};
+    bool connectionOk{};
+    bool acceptOk{};
+    bool deflate{};
+    bool serverNoContextTakeover{};
+    uint64_t lineNo{};
+
+    split(std::string_view{_handshakeBuffer.data(), end}, "\r\n", false, [&](std::string_view line) {
+        if(lineNo++ == 0) {
+            statusOk = line.starts_with("HTTP/1.1 101");
+            return;
+        }
+
+        auto const colon = line.find(':');
+        if(colon == std::string_view::npos) {
+            return;
+        }
+
+        auto const name = line.substr(0, colon);
+        auto const value = trimHeaderValue(line.substr(colon + 1));
+
+        if(CaseInsensitiveEquals(name, "Upgrade")) {
+            upgradeOk = wsHeaderContainsToken(value, "websocket");
+        } else if(CaseInsensitiveEquals(name, "Connection")) {
+            connectionOk = wsHeaderContainsToken(value, "upgrade");
+        } else if(CaseInsensitiveEquals(name, "Sec-WebSocket-Accept")) {
+            acceptOk = value == expectedAccept;
+        } else if(CaseInsensitiveEquals(name, "Sec-WebSocket-Extensions")) {
+            deflate = wsHeaderContainsToken(value, "permessage-deflate");
+            serverNoContextTakeover = value.find("server_no_context_takeover") != std::string_view::npos;
+        }
+    });
+
+    // Messages are inflated with a fresh window every time, which only works if the server agreed to not take over its context.
+    if(!statusOk || !upgradeOk || !connectionOk || !acceptOk || (deflate && (!_perMessageDeflate || !serverNoContextTakeover))) {
+        ICHOR_LOG_ERROR(_logger, "WsConnection {} invalid handshake response {} {} {} {} {}", AdvancedService<WsConnectionService>::getServiceId(), statusOk, upgradeOk, connectionOk, acceptOk, deflate);
+        _handshakeBuffer = {};
+        _handshakeDone.set();
+        return;
+    }
+
+    _perMessageDeflate = deflate;
+    _connected = true;
+    std::vector<uint8_t> leftover{_handshakeBuffer.begin() + static_cast<int64_t>(end) + 4, _handshakeBuffer.end()};
+    _handshakeBuffer = {};
+    _handshakeKey = {};
+    _handshakeDone.set();
+
+    if(!leftover.empty()) {
+        onReceive(leftover);
+    }
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+bool Ichor::v1::WsConnectionService<InterfaceT>::handleFrame(WsFrameHeader const &header, std::span<uint8_t const> payload) {
+    switch(header.opcode) {
+        case WsOpcode::TEXT:
+        case WsOpcode::BINARY:
+            if(_messageInProgress) {
+                close(WsCloseCode::PROTOCOL_ERROR);
+                return false;
+            }
+            if(header.fin) {
+                return deliver(payload, header.compressed);
+            }
+            _messageInProgress = true;
+            _messageCompressed = header.compressed;
+            _messageBuffer.assign(payload.begin(), payload.end());
+            return true;
+        case WsOpcode::CONTINUATION: {
+            if(!_messageInProgress) {
+                close(WsCloseCode::PROTOCOL_ERROR);
+                return false;
+            }
+            if(_messageBuffer.size() + payload.size() > _maxMessageSize) {
+                close(WsCloseCode::MESSAGE_TOO_BIG);
+                return false;
+            }
+            _messageBuffer.insert(_messageBuffer.end(), payload.begin(), payload.end());
+            if(!header.fin) {
+                return true;
+            }
+            _messageInProgress = false;
+            auto const ret = deliver(_messageBuffer, _messageCompressed);
+            if(_messageBuffer.capacity() > MAX_RETAINED_BUFFER_SIZE) {
+                _messageBuffer = {};
+            } else {
+                _messageBuffer.clear();
+            }
+            return ret;
+        }
+        case WsOpcode::PING:
+            _queue->pushPrioritisedEvent<RunFunctionEventAsync>(AdvancedService<WsConnectionService>::getServiceId(), _priority, [this, data = std::vector<uint8_t>{payload.begin(), payload.end()}]() mutable -> AsyncGenerator<IchorBehaviour> {
+                co_await sendControlFrame(WsOpcode::PONG, std::move(data));
+                co_return {};
+            });
+            return true;
+        case WsOpcode::PONG:
+            return true;
+        case WsOpcode::CLOSE:
+            // a close frame carries either nothing or at least a 2 byte status code
+            close(payload.size() == 1 ? WsCloseCode::PROTOCOL_ERROR : WsCloseCode::NORMAL);
+            return false;
+    }
+
+    close(WsCloseCode::PROTOCOL_ERROR);
+    return false;
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+bool Ichor::v1::WsConnectionService<InterfaceT>::deliver(std::span<uint8_t const> message, [[maybe_unused]] bool compressed) {
+#ifdef ICHOR_USE_ZLIB
+    if(compressed) {
+        inflateScratch.clear();
+        auto ret = wsInflate(message, inflateScratch, _maxMessageSize);
+
+        if(!ret) {
+            close(ret.error() == WsFrameError::MESSAGE_TOO_BIG ? WsCloseCode::MESSAGE_TOO_BIG : WsCloseCode::INVALID_PAYLOAD);
+            return false;
+        }
+
+        message = inflateScratch;
+    }
+#endif
+
+    if(_recvHandler) {
+        _recvHandler(message);
+    } else {
+        _queuedMessages.emplace_back(message.begin(), message.end());
+    }
+
+    return !_closing && !_quit;
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+std::vector<uint8_t> Ichor::v1::WsConnectionService<InterfaceT>::createFrameHeader(WsOpcode opcode, bool compressed, std::span<uint8_t> payload) noexcept {
+    std::array<uint8_t, ICHOR_WS_MAX_HEADER_SIZE> header;
+    uint32_t len;
+
+    if(_isClient) {
+        auto const mask = createMask();
+        applyWsMask(payload, mask);
+        len = writeWsFrameHeader(header, opcode, true, compressed, payload.size(), mask.data());
+    } else {
+        len = writeWsFrameHeader(header, opcode, true, compressed, payload.size(), nullptr);
+    }
+
+    return std::vector<uint8_t>{header.begin(), header.begin() + len};
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+Ichor::Task<tl::expected<void, Ichor::v1::IOError>> Ichor::v1::WsConnectionService<InterfaceT>::sendControlFrame(WsOpcode opcode, std::vector<uint8_t> payload) {
+    auto *conn = connection();
+
+    if(conn == nullptr) {
+        co_return tl::unexpected(IOError::NOT_CONNECTED);
+    }
+
+    auto frame = createFrameHeader(opcode, false, payload);
+    frame.insert(frame.end(), payload.begin(), payload.end());
+
+    co_return co_await conn->sendAsync(std::move(frame));
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+void Ichor::v1::WsConnectionService<InterfaceT>::close(WsCloseCode code) {
+    if(_closing) {
+        // we started the closing handshake and this is the reply, stopping has already been scheduled
+        return;
+    }
+
+    ICHOR_LOG_TRACE(_logger, "WsConnection {} closing with {}", AdvancedService<WsConnectionService>::getServiceId(), static_cast<uint16_t>(code));
+    _closing = true;
+    _recvBuffer = {};
+    _messageBuffer = {};
+    _messageInProgress = false;
+
+    _queue->pushPrioritisedEvent<RunFunctionEventAsync>(AdvancedService<WsConnectionService>::getServiceId(), _priority, [this, code]() -> AsyncGenerator<IchorBehaviour> {
+        co_await sendControlFrame(WsOpcode::CLOSE, createClosePayload(code));
+        // client connections belong to whoever requested them, upgraded ones are cleaned up completely
+        _queue->pushPrioritisedEvent<StopServiceEvent>(AdvancedService<WsConnectionService>::getServiceId(), _priority, AdvancedService<WsConnectionService>::getServiceId(), !_isClient);
+        co_return {};
+    });
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+Ichor::Task<tl::expected<void, Ichor::v1::IOError>> Ichor::v1::WsConnectionService<InterfaceT>::sendAsync(std::vector<uint8_t> &&msg) {
+    std::vector<std::vector<uint8_t>> msgs;
+    msgs.emplace_back(std::move(msg));
+    co_return co_await sendAsync(std::move(msgs));
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+Ichor::Task<tl::expected<void, Ichor::v1::IOError>> Ichor::v1::WsConnectionService<InterfaceT>::sendAsync(std::vector<std::vector<uint8_t>> &&msgs) {
+    if(_quit || _closing) {
+        co_return tl::unexpected(IOError::SERVICE_QUITTING);
+    }
+
+    auto *conn = connection();
+
+    if(conn == nullptr || !_connected) {
+        co_return tl::unexpected(IOError::NOT_CONNECTED);
+    }
+
+    // header and payload are separate iovecs, so the payload itself never gets copied
+    std::vector<std::vector<uint8_t>> frames;
+    frames.reserve(msgs.size() * 2);
+    for(auto &msg : msgs) {
+        bool compressed{};
+#ifdef ICHOR_USE_ZLIB
+        if(_perMessageDeflate && msg.size() >= ICHOR_WS_DEFLATE_THRESHOLD) {
+            std::vector<uint8_t> deflated;
+            if(wsDeflate(msg, deflated) && deflated.size() < msg.size()) {
+                msg = std::move(deflated);
+                compressed = true;
+            }
+        }
+#endif
+        frames.emplace_back(createFrameHeader(_sendText ? WsOpcode::TEXT : WsOpcode::BINARY, compressed, msg));
+        frames.emplace_back(std::move(msg));
+    }
+
+    co_return co_await conn->sendAsync(std::move(frames));
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+void Ichor::v1::WsConnectionService<InterfaceT>::setPriority(uint64_t priority) {
+    _priority = priority;
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+uint64_t Ichor::v1::WsConnectionService<InterfaceT>::getPriority() {
+    return _priority;
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+bool Ichor::v1::WsConnectionService<InterfaceT>::isClient() const noexcept {
+    return _isClient;
+}
+
+template <typename InterfaceT> requires Ichor::DerivedAny<InterfaceT, Ichor::v1::IConnectionService, Ichor::v1::IHostConnectionService, Ichor::v1::IClientConnectionService>
+void Ichor::v1::WsConnectionService<InterfaceT>::setReceiveHandler(std::function<void(std::span<uint8_t const>)> recvHandler) {
+    _recvHandler = std::move(recvHandler);
+
+    if(!_recvHandler) {
+        return;
+    }
+
+    for(auto &msg : _queuedMessages) {
+        _recvHandler(msg);
+    }
+    _queuedMessages.clear();
+}
+
+template class Ichor::v1::WsConnectionService<Ichor::v1::IConnectionService>;
+template class Ichor::v1::WsConnectionService<Ichor::v1::IHostConnectionService>;
+template class Ichor::v1::WsConnectionService<Ichor::v1::IClientConnectionService>;
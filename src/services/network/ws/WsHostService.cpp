@@ -0,0 +1,305 @@
+#include <ichor/DependencyManager.h>
+#include <ichor/services/network/ws/WsHostService.h>
+#include <ichor/services/network/ws/WsConnectionService.h>
+#include <ichor/services/network/ws/WsCommon.h>
+#include <ichor/stl/StringUtils.h>
+#include <ichor/ScopedServiceProxy.h>
+
+namespace {
+    // HTTP header names are case-insensitive, but HttpHostService stores them as received.
+    tl::optional<std::string_view> findHeader(Ichor::unordered_map<std::string, std::string> const &headers, std::string_view name) {
+        for(auto const &[k, v] : headers) {
+            if(Ichor::v1::CaseInsensitiveEquals(k, name)) {
+                return std::string_view{v};
+            }
+        }
+        return {};
+    }
+}
+
+Ichor::v1::WsHostService::WsHostService(DependencyRegister &reg, Properties props) : AdvancedService(std::move(props)) {
+    reg.registerDependency<ILogger>(this, DependencyFlags::REQUIRED);
+    reg.registerDependency<IEventQueue>(this, DependencyFlags::REQUIRED);
+    reg.registerDependency<IHttpHostService>(this, DependencyFlags::REQUIRED, getProperties());
+    reg.registerDependency<IHostConnectionService>(this, DependencyFlags::ALLOW_MULTIPLE);
+#ifdef ICHOR_USE_LIBURING
+    reg.registerDependency<IIOUringQueue>(this, DependencyFlags::NONE);
+#endif
+}
+
+Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::WsHostService::start() {
+    if(auto propIt = getProperties().find("Path"); propIt != getProperties().end()) {
+        _path = Ichor::v1::any_cast<std::string&>(propIt->second);
+    }
+    if(auto const *priority = getProperties().get(PropertyKeys::Priority); priority != nullptr) {
+        _priority = *priority;
+    }
+    if(auto propIt = getProperties().find("PerMessageDeflate"); propIt != getProperties().end()) {
+        _perMessageDeflate = Ichor::v1::any_cast<bool>(propIt->second);
+    }
+    if(auto propIt = getProperties().find("MaxMessageSize"); propIt != getProperties().end()) {
+        _maxMessageSize = Ichor::v1::any_cast<uint64_t>(propIt->second);
+    }
+    if(auto propIt = getProperties().find("SendText"); propIt != getProperties().end()) {
+        _sendText = Ichor::v1::any_cast<bool>(propIt->second);
+    }
+
+#ifndef ICHOR_USE_ZLIB
+    if(_perMessageDeflate) {
+        ICHOR_LOG_WARN(_logger, "WsHost {} PerMessageDeflate requested, but Ichor has not been compiled with zlib support", getServiceId());
+        _perMessageDeflate = false;
+    }
+#endif
+
+    _quit = false;
+    _routeRegistration = _httpHost->addRoute(HttpMethod::get, _path, [this](HttpRequest &req) -> Task<HttpResponse> {
+        co_return handleUpgradeRequest(req);
+    });
+
+    co_return {};
+}
+
+Ichor::Task<void> Ichor::v1::WsHostService::stop() {
+    _quit = true;
+    _routeRegistration = {};
+
+    for(auto const &[connectionServiceId, wsConnection] : _wsConnections) {
+        _queue->pushEvent<StopServiceEvent>(getServiceId(), wsConnection.wsServiceId, true);
+    }
+    _wsConnections.clear();
+
+    co_return;
+}
+
+void Ichor::v1::WsHostService::addDependencyInstance(Ichor::ScopedServiceProxy<ILogger*> logger, IService &) {
+    _logger = std::move(logger);
+}
+
+void Ichor::v1::WsHostService::removeDependencyInstance(Ichor::ScopedServiceProxy<ILogger*>, IService &) {
+    _logger = nullptr;
+}
+
+void Ichor::v1::WsHostService::addDependencyInstance(Ichor::ScopedServiceProxy<IEventQueue*> q, IService &) {
+    _queue = std::move(q);
+}
+
+void Ichor::v1::WsHostService::removeDependencyInstance(Ichor::ScopedServiceProxy<IEventQueue*>, IService &) {
+    _queue = nullptr;
+}
+
+void Ichor::v1::WsHostService::addDependencyInstance(Ichor::ScopedServiceProxy<IHttpHostService*> h, IService &s) {
+    ICHOR_LOG_TRACE(_logger, "WsHost {} got http host {}", getServiceId(), s.getServiceId());
+    _httpHost = std::move(h);
+}
+
+void Ichor::v1::WsHostService::removeDependencyInstance(Ichor::ScopedServiceProxy<IHttpHostService*>, IService &) {
+    _routeRegistration = {};
+    _httpHost = nullptr;
+}
+
+void Ichor::v1::WsHostService::addDependencyInstance(Ichor::ScopedServiceProxy<IHostConnectionService*> c, IService &s) {
+    // websocket connections are host connections as well, only keep the ones that can be upgraded
+    if(!s.getProperties().contains(PropertyKeys::TcpHostService)) {
+        return;
+    }
+
+#ifdef ICHOR_USE_LIBURING
+    // only set by io_uring hosts, for plaintext connections
+    std::shared_ptr<SocketSendGuard> sendGuard{};
+    if(auto const *guard = s.getProperties().get(PropertyKeys::SendGuard); guard != nullptr) {
+        sendGuard = *guard;
+    }
+
+    _hostConnections.emplace(s.getServiceId(), HostConnection{std::move(c), std::move(sendGuard)});
+#else
+    _hostConnections.emplace(s.getServiceId(), HostConnection{std::move(c)});
+#endif
+}
+
+void Ichor::v1::WsHostService::removeDependencyInstance(Ichor::ScopedServiceProxy<IHostConnectionService*>, IService &s) {
+    _hostConnections.erase(s.getServiceId());
+
+    auto wsIt = _wsConnections.find(s.getServiceId());
+    if(wsIt != _wsConnections.end()) {
+        ICHOR_LOG_TRACE(_logger, "WsHost {} connection {} gone, stopping websocket {}", getServiceId(), s.getServiceId(), wsIt->second.wsServiceId);
+        _queue->pushEvent<StopServiceEvent>(getServiceId(), wsIt->second.wsServiceId, true);
+        _wsConnections.erase(wsIt);
+    }
+}
+
+Ichor::v1::HttpResponse Ichor::v1::WsHostService::handleUpgradeRequest(HttpRequest &req) {
+    HttpResponse resp{};
+
+    if(_quit) {
+        resp.status = HttpStatus::service_unavailable;
+        return resp;
+    }
+
+    auto upgrade = findHeader(req.headers, "Upgrade");
+    auto connection = findHeader(req.headers, "Connection");
+    auto key = findHeader(req.headers, "Sec-WebSocket-Key");
+    auto version = findHeader(req.headers, "Sec-WebSocket-Version");
+
+    // the key is 16 random bytes, base64 encoded
+    if(!upgrade || !wsHeaderContainsToken(*upgrade, "websocket") || !connection || !wsHeaderContainsToken(*connection, "upgrade") || !key || key->size() != 24) {
+        ICHOR_LOG_TRACE(_logger, "WsHost {} not a valid upgrade request", getServiceId());
+        resp.status = HttpStatus::bad_request;
+        return resp;
+    }
+
+    if(!version || *version != "13") {
+        resp.status = HttpStatus::upgrade_required;
+        resp.headers.emplace("Sec-WebSocket-Version", "13");
+        return resp;
+    }
+
+    bool perMessageDeflate{};
+    if(_perMessageDeflate) {
+        auto extensions = findHeader(req.headers, "Sec-WebSocket-Extensions");
+        // Only a 15 bit server window is supported. Clients that ask for less don't get compression.
+        perMessageDeflate = extensions && wsHeaderContainsToken(*extensions, "permessage-deflate") && (extensions->find("server_max_window_bits=") == std::string_view::npos || extensions->find("server_max_window_bits=15") != std::string_view::npos);
+    }
+
+    resp.status = HttpStatus::switching_protocols;
+    resp.headers.emplace("Upgrade", "websocket");
+    resp.headers.emplace("Connection", "Upgrade");
+    resp.headers.emplace("Sec-WebSocket-Accept", createWsAcceptKey(*key));
+    if(perMessageDeflate) {
+        resp.headers.emplace("Sec-WebSocket-Extensions", "permessage-deflate; server_no_context_takeover; client_no_context_takeover");
+    }
+
+    req.upgradeHandler = [this, perMessageDeflate](ServiceIdType connectionServiceId) {
+        createConnection(connectionServiceId, perMessageDeflate);
+    };
+
+    return resp;
+}
+
+void Ichor::v1::WsHostService::createConnection(ServiceIdType connectionServiceId, bool perMessageDeflate) {
+    if(_quit || !_hostConnections.contains(connectionServiceId)) {
+        ICHOR_LOG_TRACE(_logger, "WsHost {} upgraded connection {} already gone", getServiceId(), connectionServiceId);
+        return;
+    }
+
+    auto connection = GetThreadLocalManager().createServiceManager<WsConnectionService<IHostConnectionService>, IConnectionService, IHostConnectionService>(Properties{
+        {"WsHostServiceId", Ichor::v1::make_any<ServiceIdType>(getServiceId())},
+        {"ConnectionServiceId", Ichor::v1::make_any<ServiceIdType>(connectionServiceId)},
+        {"Priority", Ichor::v1::make_any<uint64_t>(_priority)},
+        {"PerMessageDeflate", Ichor::v1::make_any<bool>(perMessageDeflate)},
+        {"MaxMessageSize", Ichor::v1::make_any<uint64_t>(_maxMessageSize)},
+        {"SendText", Ichor::v1::make_any<bool>(_sendText)},
+    });
+    ICHOR_LOG_TRACE(_logger, "WsHost {} upgraded connection {} to websocket {}", getServiceId(), connectionServiceId, connection->getServiceId());
+    _wsConnections.emplace(connectionServiceId, WsConnection{connection->getServiceId(), perMessageDeflate});
+}
+
+Ichor::v1::IHostConnectionService* Ichor::v1::WsHostService::getUpgradedConnection(ServiceIdType connectionServiceId) noexcept {
+    auto it = _hostConnections.find(connectionServiceId);
+
+    if(it == _hostConnections.end()) {
+        return nullptr;
+    }
+
+    return *it->second.connection;
+}
+
+Ichor::Task<tl::expected<uint64_t, Ichor::v1::IOError>> Ichor::v1::WsHostService::broadcastAsync(SharedMessage msg) {
+    if(_quit) {
+        co_return tl::unexpected(IOError::SERVICE_QUITTING);
+    }
+
+    auto const opcode = _sendText ? WsOpcode::TEXT : WsOpcode::BINARY;
+    std::array<uint8_t, ICHOR_WS_MAX_HEADER_SIZE> header{};
+
+    // server frames aren't masked, so every connection gets the exact same bytes
+    auto headerLength = writeWsFrameHeader(header, opcode, true, false, msg->size(), nullptr);
+    std::vector<uint8_t> frame;
+    frame.reserve(headerLength + msg->size());
+    frame.insert(frame.end(), header.begin(), header.begin() + headerLength);
+    frame.insert(frame.end(), msg->begin(), msg->end());
+
+    // without context takeover, a message compresses the same for every connection
+    std::vector<uint8_t> compressedFrame;
+#ifdef ICHOR_USE_ZLIB
+    if(msg->size() >= ICHOR_WS_DEFLATE_THRESHOLD && std::any_of(_wsConnections.begin(), _wsConnections.end(), [](auto const &ws) { return ws.second.perMessageDeflate; })) {
+        std::vector<uint8_t> deflated;
+        if(wsDeflate(*msg, deflated) && deflated.size() < msg->size()) {
+            headerLength = writeWsFrameHeader(header, opcode, true, true, deflated.size(), nullptr);
+            compressedFrame.reserve(headerLength + deflated.size());
+            compressedFrame.insert(compressedFrame.end(), header.begin(), header.begin() + headerLength);
+            compressedFrame.insert(compressedFrame.end(), deflated.begin(), deflated.end());
+        }
+    }
+#endif
+
+#ifdef ICHOR_USE_LIBURING
+    // holding on to the guards keeps them valid for the whole broadcast, even if connections go away in the meantime
+    std::vector<std::shared_ptr<SocketSendGuard>> sockets;
+    std::vector<std::shared_ptr<SocketSendGuard>> compressedSockets;
+#endif
+    // connections that have to go through their connection service, e.g. because of TLS
+    std::vector<std::pair<ServiceIdType, bool>> indirect;
+    uint64_t targets{};
+    for(auto const &[connectionServiceId, wsConnection] : _wsConnections) {
+        auto connIt = _hostConnections.find(connectionServiceId);
+
+        if(connIt == _hostConnections.end()) {
+            continue;
+        }
+
+        targets++;
+
+        bool const compressed = wsConnection.perMessageDeflate && !compressedFrame.empty();
+#ifdef ICHOR_USE_LIBURING
+        if(_uringQueue && connIt->second.sendGuard) {
+            (compressed ? compressedSockets : sockets).push_back(connIt->second.sendGuard);
+            continue;
+        }
+#endif
+        indirect.emplace_back(connectionServiceId, compressed);
+    }
+
+    uint64_t sent{};
+#ifdef ICHOR_USE_LIBURING
+    if(_uringQueue) {
+        sent += co_await broadcastToSockets(**_uringQueue, getServiceId(), sockets, frame);
+        sent += co_await broadcastToSockets(**_uringQueue, getServiceId(), compressedSockets, compressedFrame);
+    }
+#endif
+
+    for(auto const &[connectionServiceId, compressed] : indirect) {
+        auto connIt = _hostConnections.find(connectionServiceId);
+
+        if(_quit || connIt == _hostConnections.end()) {
+            continue;
+        }
+
+        auto ret = co_await connIt->second.connection->sendAsync(std::vector<uint8_t>(compressed ? compressedFrame : frame));
+
+        if(ret) {
+            sent++;
+        }
+    }
+
+    ICHOR_LOG_TRACE(_logger, "WsHost {} broadcast {} bytes to {}/{} websockets", getServiceId(), msg->size(), sent, targets);
+
+    co_return sent;
+}
+
+#ifdef ICHOR_USE_LIBURING
+void Ichor::v1::WsHostService::addDependencyInstance(Ichor::ScopedServiceProxy<IIOUringQueue*> q, IService &) {
+    _uringQueue = std::move(q);
+}
+
+void Ichor::v1::WsHostService::removeDependencyInstance(Ichor::ScopedServiceProxy<IIOUringQueue*>, IService &) {
+    _uringQueue = nullptr;
+}
+#endif
+
+void Ichor::v1::WsHostService::setPriority(uint64_t priority) {
+    _priority = priority;
+}
+
+uint64_t Ichor::v1::WsHostService::getPriority() {
+    return _priority;
+}
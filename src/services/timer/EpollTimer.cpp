@@ -0,0 +1,202 @@
+#include <ichor/services/timer/EpollTimer.h>
+#include <ichor/events/RunFunctionEvent.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+Ichor::v1::EpollTimer::EpollTimer(Ichor::ScopedServiceProxy<IEpollQueue*> queue, uint64_t timerId, ServiceIdType svcId) noexcept : _state(std::make_unique<State>()) {
+    INTERNAL_IO_DEBUG("EpollTimer {} for {}", timerId, svcId);
+    _state->q = std::move(queue);
+    _state->timerId = timerId;
+    _state->requestingServiceId = svcId;
+
+    _state->fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if(_state->fd < 0) [[unlikely]] {
+        fmt::println("timerfd_create() for timer {} failed, errno {}", timerId, errno);
+        std::terminate();
+    }
+
+    auto ret = _state->q->registerFd(_state->fd, EPOLLIN, [state = _state.get()](uint32_t) {
+        onExpired(*state);
+    });
+    if(!ret) [[unlikely]] {
+        fmt::println("Couldn't register timerfd for timer {}: {}", timerId, ret.error());
+        std::terminate();
+    }
+}
+
+Ichor::v1::EpollTimer::~EpollTimer() noexcept {
+    release();
+}
+
+Ichor::v1::EpollTimer& Ichor::v1::EpollTimer::operator=(EpollTimer &&o) noexcept {
+    if(this != &o) {
+        release();
+        _state = std::move(o._state);
+    }
+    return *this;
+}
+
+void Ichor::v1::EpollTimer::release() noexcept {
+    // moved-from
+    if(!_state) {
+        return;
+    }
+
+    if(_state->fd >= 0) {
+        if(_state->q) {
+            _state->q->unregisterFd(_state->fd);
+        }
+        ::close(_state->fd);
+    }
+    _state.reset();
+}
+
+bool Ichor::v1::EpollTimer::startTimer() {
+    return startTimer(false);
+}
+
+bool Ichor::v1::EpollTimer::startTimer(bool fireImmediately) {
+    if(!_state->fn && !_state->fnAsync) [[unlikely]] {
+        fmt::println("No callback set.");
+        std::terminate();
+    }
+
+    if(_state->state != TimerState::STOPPED) {
+        return false;
+    }
+
+    INTERNAL_IO_DEBUG("Starting EpollTimer {} for {} with {} ns interval", _state->timerId, _state->requestingServiceId, _state->intervalNanosec);
+
+    if(fireImmediately && _state->fireOnce) {
+        // already fired, callback is free to start the timer again
+        fire(*_state);
+        return true;
+    }
+
+    _state->state = TimerState::RUNNING;
+    arm(*_state);
+
+    if(fireImmediately) {
+        fire(*_state);
+    }
+
+    return true;
+}
+
+bool Ichor::v1::EpollTimer::stopTimer(std::function<void(void)> cb) {
+    INTERNAL_IO_DEBUG("Stopping EpollTimer {} for {} state {}", _state->timerId, _state->requestingServiceId, _state->state);
+    if(_state->state == TimerState::RUNNING) {
+        // disarming is synchronous, no expiration will be handled after this
+        itimerspec its{};
+        timerfd_settime(_state->fd, 0, &its, nullptr);
+        _state->state = TimerState::STOPPED;
+        if(cb) {
+            cb();
+        }
+        return true;
+    } else if(cb) {
+        cb();
+    }
+    return false;
+}
+
+Ichor::v1::TimerState Ichor::v1::EpollTimer::getState() const noexcept {
+    return _state->state;
+}
+
+void Ichor::v1::EpollTimer::setCallbackAsync(std::function<AsyncGenerator<IchorBehaviour>()> fn) {
+    if(_state->state != TimerState::STOPPED) {
+        std::terminate();
+    }
+
+    _state->fnAsync = std::move(fn);
+    _state->fn = {};
+}
+
+void Ichor::v1::EpollTimer::setCallback(std::function<void()> fn) {
+    if(_state->state != TimerState::STOPPED) {
+        std::terminate();
+    }
+
+    _state->fnAsync = {};
+    _state->fn = std::move(fn);
+}
+
+void Ichor::v1::EpollTimer::setInterval(uint64_t nanoseconds) noexcept {
+    _state->intervalNanosec = nanoseconds;
+
+    if(_state->state == TimerState::RUNNING) {
+        arm(*_state);
+    }
+}
+
+void Ichor::v1::EpollTimer::setPriority(uint64_t priority) noexcept {
+    _state->priority = priority;
+}
+
+uint64_t Ichor::v1::EpollTimer::getPriority() const noexcept {
+    return _state->priority;
+}
+
+void Ichor::v1::EpollTimer::setFireOnce(bool fireOnce) noexcept {
+    _state->fireOnce = fireOnce;
+
+    if(_state->state == TimerState::RUNNING) {
+        arm(*_state);
+    }
+}
+
+bool Ichor::v1::EpollTimer::getFireOnce() const noexcept {
+    return _state->fireOnce;
+}
+
+uint64_t Ichor::v1::EpollTimer::getTimerId() const noexcept {
+    return _state->timerId;
+}
+
+Ichor::ServiceIdType Ichor::v1::EpollTimer::getRequestingServiceId() const noexcept {
+    return _state->requestingServiceId;
+}
+
+void Ichor::v1::EpollTimer::arm(State &state) noexcept {
+    // an it_value of 0 disarms the timer
+    uint64_t const first = state.intervalNanosec == 0 ? 1 : state.intervalNanosec;
+    itimerspec its{};
+    its.it_value.tv_sec = static_cast<time_t>(first / 1'000'000'000);
+    its.it_value.tv_nsec = static_cast<long>(first % 1'000'000'000);
+    if(!state.fireOnce) {
+        its.it_interval = its.it_value;
+    }
+
+    if(timerfd_settime(state.fd, 0, &its, nullptr) < 0) [[unlikely]] {
+        fmt::println("timerfd_settime() for timer {} failed, errno {}", state.timerId, errno);
+        std::terminate();
+    }
+}
+
+void Ichor::v1::EpollTimer::onExpired(State &state) {
+    uint64_t expirations{};
+    // EAGAIN if the timer got disarmed or re-armed after becoming readable
+    if(::read(state.fd, &expirations, sizeof(expirations)) < 0) {
+        return;
+    }
+
+    if(state.state != TimerState::RUNNING) {
+        return;
+    }
+
+    if(state.fireOnce) {
+        state.state = TimerState::STOPPED;
+    }
+
+    fire(state);
+}
+
+void Ichor::v1::EpollTimer::fire(State &state) {
+    if(state.fnAsync) {
+        state.q->pushPrioritisedEvent<RunFunctionEventAsync>(state.requestingServiceId, state.priority, state.fnAsync);
+    } else {
+        state.fn();
+    }
+}
@@ -0,0 +1,98 @@
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <fmt/core.h>
+#include <ichor/services/workers/WorkerPoolService.h>
+#include <ichor/services/workers/WorkerThreads.h>
+#include <ichor/coroutines/AsyncManualResetEvent.h>
+#include <ichor/DependencyManager.h>
+#include <ichor/event_queues/CompletionBatch.h>
+
+namespace {
+    struct Job final {
+        explicit Job(std::function<void()> _fn) noexcept : fn(std::move(_fn)) {}
+
+        std::function<void()> fn;
+        Ichor::AsyncManualResetEvent evt; // set on the thread of the owning queue once fn ran
+    };
+}
+
+// Threads and work of one instance
+struct Ichor::v1::WorkerPoolService::Workers final {
+    explicit Workers(IEventQueue &queue) : completions(std::make_shared<Ichor::Detail::CompletionBatch<Job>>(queue)) {}
+
+    // shared with the events that hand finished jobs back, which may outlive the service
+    std::shared_ptr<Ichor::Detail::CompletionBatch<Job>> completions;
+    Ichor::Detail::WorkerThreads<std::function<void()>> threads;
+};
+
+Ichor::v1::WorkerPoolService::WorkerPoolService(Properties props) : AdvancedService<WorkerPoolService>(std::move(props)) {
+    if(auto const *workerThreads = getProperties().get(PropertyKeys::WorkerThreads); workerThreads != nullptr) {
+        _workerCount = *workerThreads;
+    } else {
+        _workerCount = std::thread::hardware_concurrency();
+    }
+    _workerCount = std::max(_workerCount, 1u);
+}
+
+Ichor::Task<tl::expected<void, Ichor::StartError>> Ichor::v1::WorkerPoolService::start() {
+    _workers = std::make_shared<Workers>(GetThreadLocalEventQueue());
+    _workers->threads.start(_workerCount, fmt::format("Wrk#{}", getServiceId()));
+    co_return {};
+}
+
+Ichor::Task<void> Ichor::v1::WorkerPoolService::stop() {
+    _workers->threads.stop();
+    _workers.reset();
+    co_return;
+}
+
+Ichor::Task<void> Ichor::v1::WorkerPoolService::run(std::function<void()> fn) {
+    if(!_workers) {
+        fn();
+        co_return;
+    }
+
+    auto job = std::make_shared<Job>(std::move(fn));
+    _workers->threads.push([job, completions = _workers->completions]() mutable {
+        job->fn();
+        completions->complete(std::move(job));
+    });
+    co_await job->evt;
+}
+
+void Ichor::v1::WorkerPoolService::runAndWait(std::span<std::function<void()>> fns) {
+    if(!_workers || fns.size() < 2) {
+        for(auto &fn : fns) {
+            fn();
+        }
+        return;
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t remaining = fns.size();
+    for(auto &fn : fns) {
+        _workers->threads.push([&fn, &mutex, &cv, &remaining]() {
+            fn();
+            // notify under the lock, the waiter returns and destroys cv as soon as it sees remaining at 0
+            std::unique_lock lg{mutex};
+            if(--remaining == 0) {
+                cv.notify_all();
+            }
+        });
+    }
+
+    // help out instead of only blocking, this may pick up jobs queued through run() as well
+    while(_workers->threads.runOne()) {
+    }
+
+    std::unique_lock lg{mutex};
+    cv.wait(lg, [&remaining]() {
+        return remaining == 0;
+    });
+}
+
+uint32_t Ichor::v1::WorkerPoolService::getWorkerCount() const noexcept {
+    return _workerCount;
+}
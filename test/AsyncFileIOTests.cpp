@@ -3,6 +3,7 @@
 #include <ichor/events/RunFunctionEvent.h>
 #include <ichor/services/logging/LoggerFactory.h>
 #include <ichor/services/logging/CoutLogger.h>
+#include <ichor/services/io/MappedFileService.h>
 #include <fstream>
 #include <filesystem>
 #include "../examples/common/DebugService.h"
@@ -53,12 +54,20 @@ TEST_CASE_METHOD(AsyncFileIOExpensiveSetup, "AsyncFileIOTests_uring") {
         return;
     }
 
-    auto gen_i = GENERATE(1, 2);
+    auto gen_i = GENERATE(1, 2, 3);
 
     if(gen_i == 2) {
         emulateKernelVersion = v1::Version{5, 18, 0};
         fmt::println("emulating kernel version {}", *emulateKernelVersion);
+    } else if(gen_i == 3) {
+        // first version with fixed file slot allocation, the oldest one that takes the FixedFiles path
+        if(version < v1::Version{5, 19, 0}) {
+            return;
+        }
+        emulateKernelVersion = v1::Version{5, 19, 0};
+        fmt::println("emulating kernel version {}", *emulateKernelVersion);
     } else {
+        emulateKernelVersion = tl::nullopt;
         fmt::println("kernel version {}", *version);
     }
 #else
@@ -291,6 +300,373 @@ TEST_CASE_METHOD(AsyncFileIOExpensiveSetup, "AsyncFileIOTests") {
         t.join();
     }
 
+    SECTION("Read file as stream") {
+        fmt::println("section 2c");
+#if defined(TEST_URING)
+        auto queue = std::make_unique<QIMPL>(500, 100'000'000, emulateKernelVersion);
+#else
+        auto queue = std::make_unique<QIMPL>(500);
+#endif
+        auto &dm = queue->createManager();
+        ServiceIdType ioSvcId{};
+
+        std::thread t([&]() {
+#ifdef TEST_URING
+            REQUIRE(queue->createEventLoop());
+#endif
+            dm.createServiceManager<LoggerFactory<CoutLogger>, ILoggerFactory>(Properties{{"DefaultLogLevel", Ichor::v1::make_any<LogLevel>(LogLevel::LOG_TRACE)}});
+            ioSvcId = dm.createServiceManager<IOIMPL, IAsyncFileIO>()->getServiceId();
+            queue->start(CaptureSigInt);
+        });
+
+        waitForRunning(dm);
+
+        runForOrQueueEmpty(dm);
+
+        queue->pushEvent<RunFunctionEventAsync>(ServiceIdType{0}, [&]() -> AsyncGenerator<IchorBehaviour> {
+            auto async_io_svc = dm.getService<IAsyncFileIO>(ioSvcId);
+
+            {
+                auto stream = async_io_svc->first->readFileStream("NonExistentFile.txt");
+                auto it = co_await stream.begin();
+                REQUIRE(it != stream.end());
+                REQUIRE(!*it);
+                REQUIRE((*it).error() == IOError::FILE_DOES_NOT_EXIST);
+                it = co_await ++it;
+                REQUIRE(it == stream.end());
+            }
+
+            std::string contents;
+            uint64_t chunks{};
+            auto stream = async_io_svc->first->readFileStream("BigFile.txt");
+            for(auto it = co_await stream.begin(); it != stream.end(); it = co_await ++it) {
+                REQUIRE(*it);
+                REQUIRE(!(**it).empty());
+                contents.append((**it).data(), (**it).size());
+                chunks++;
+            }
+            REQUIRE(chunks > 1);
+
+            tl::expected<std::string, Ichor::v1::IOError> ret = co_await async_io_svc->first->readWholeFile("BigFile.txt");
+            REQUIRE(ret);
+            REQUIRE(contents.size() == (uint64_t)bigFilefilesize);
+            REQUIRE(contents == *ret);
+            queue->pushEvent<QuitEvent>(ServiceIdType{0});
+            co_return {};
+        });
+
+        auto start = std::chrono::steady_clock::now();
+        while(queue->is_running()) {
+            std::this_thread::sleep_for(10ms);
+            auto now = std::chrono::steady_clock::now();
+            REQUIRE(now - start < 20s);
+        }
+
+        t.join();
+    }
+
+#ifdef TEST_URING
+    SECTION("Read file with DirectIO") {
+        fmt::println("section 2d");
+        // not a multiple of the alignment or the buffer size, so the last read of every file is short
+        std::string expected;
+        for(uint64_t i = 0; i < 300'001; i++) {
+            expected.push_back(static_cast<char>('a' + i % 26));
+        }
+        {
+            std::ofstream out("DirectFile.txt", std::ios::binary);
+            out << expected;
+            REQUIRE(!out.fail());
+        }
+
+        auto queue = std::make_unique<QIMPL>(500, 100'000'000, emulateKernelVersion);
+        auto &dm = queue->createManager();
+        ServiceIdType ioSvcId{};
+
+        std::thread t([&]() {
+            REQUIRE(queue->createEventLoop());
+            dm.createServiceManager<LoggerFactory<CoutLogger>, ILoggerFactory>(Properties{{"DefaultLogLevel", Ichor::v1::make_any<LogLevel>(LogLevel::LOG_TRACE)}});
+            ioSvcId = dm.createServiceManager<IOIMPL, IAsyncFileIO>(Properties{{"DirectIO", Ichor::v1::make_any<bool>(true)}, {"BufferSize", Ichor::v1::make_any<uint32_t>(64u * 1024u)}})->getServiceId();
+            queue->start(CaptureSigInt);
+        });
+
+        waitForRunning(dm);
+
+        runForOrQueueEmpty(dm);
+
+        queue->pushEvent<RunFunctionEventAsync>(ServiceIdType{0}, [&]() -> AsyncGenerator<IchorBehaviour> {
+            auto async_io_svc = dm.getService<IAsyncFileIO>(ioSvcId);
+
+            tl::expected<std::string, Ichor::v1::IOError> ret = co_await async_io_svc->first->readWholeFile("DirectFile.txt");
+            REQUIRE(ret);
+            REQUIRE(*ret == expected);
+
+            std::string contents;
+            auto stream = async_io_svc->first->readFileStream("DirectFile.txt");
+            for(auto it = co_await stream.begin(); it != stream.end(); it = co_await ++it) {
+                REQUIRE(*it);
+                contents.append((**it).data(), (**it).size());
+            }
+            REQUIRE(contents == expected);
+
+            ret = co_await async_io_svc->first->readWholeFile("BigFile.txt");
+            REQUIRE(ret);
+            REQUIRE((*ret).size() == (uint64_t)bigFilefilesize);
+            queue->pushEvent<QuitEvent>(ServiceIdType{0});
+            co_return {};
+        });
+
+        auto start = std::chrono::steady_clock::now();
+        while(queue->is_running()) {
+            std::this_thread::sleep_for(10ms);
+            auto now = std::chrono::steady_clock::now();
+            REQUIRE(now - start < 20s);
+        }
+
+        t.join();
+        std::remove("DirectFile.txt");
+    }
+#endif
+
+    SECTION("Positional reads and writes through a file handle") {
+        fmt::println("section 2e");
+#if defined(TEST_URING)
+        auto queue = std::make_unique<QIMPL>(500, 100'000'000, emulateKernelVersion);
+#else
+        auto queue = std::make_unique<QIMPL>(500);
+#endif
+        auto &dm = queue->createManager();
+        ServiceIdType ioSvcId{};
+
+        std::thread t([&]() {
+#ifdef TEST_URING
+            REQUIRE(queue->createEventLoop());
+#endif
+            dm.createServiceManager<LoggerFactory<CoutLogger>, ILoggerFactory>(Properties{{"DefaultLogLevel", Ichor::v1::make_any<LogLevel>(LogLevel::LOG_TRACE)}});
+            ioSvcId = dm.createServiceManager<IOIMPL, IAsyncFileIO>()->getServiceId();
+            queue->start(CaptureSigInt);
+        });
+
+        waitForRunning(dm);
+
+        runForOrQueueEmpty(dm);
+
+        queue->pushEvent<RunFunctionEventAsync>(ServiceIdType{0}, [&]() -> AsyncGenerator<IchorBehaviour> {
+            auto async_io_svc = dm.getService<IAsyncFileIO>(ioSvcId);
+
+            auto missing = co_await async_io_svc->first->open("NonExistentFile.txt", FileOpenFlags::READ);
+            REQUIRE(!missing);
+            REQUIRE(missing.error() == IOError::FILE_DOES_NOT_EXIST);
+
+            auto opened = co_await async_io_svc->first->open("AsyncFile.bin", FileOpenFlags::READ | FileOpenFlags::WRITE | FileOpenFlags::CREATE | FileOpenFlags::TRUNCATE);
+            REQUIRE(opened);
+            auto &file = *opened;
+
+            auto exclusive = co_await async_io_svc->first->open("AsyncFile.bin", FileOpenFlags::WRITE | FileOpenFlags::CREATE | FileOpenFlags::EXCLUSIVE);
+            REQUIRE(!exclusive);
+            REQUIRE(exclusive.error() == IOError::FILE_ALREADY_EXISTS);
+
+            auto allocated = co_await file->allocate(0, 8192);
+            REQUIRE(allocated);
+            auto size = co_await file->size();
+            REQUIRE(size);
+            REQUIRE(*size == 8192);
+
+            std::string_view hello{"hello"};
+            auto written = co_await file->write(hello, 4096);
+            REQUIRE(written);
+            std::string_view part1{"part1"};
+            std::string_view part2{"part2"};
+            std::array<std::span<char const>, 2> writeBuffers{part1, part2};
+            auto writtenv = co_await file->writev(writeBuffers, 8190);
+            REQUIRE(writtenv);
+            auto dataSynced = co_await file->dataSync();
+            REQUIRE(dataSynced);
+            auto synced = co_await file->sync();
+            REQUIRE(synced);
+
+            size = co_await file->size();
+            REQUIRE(size);
+            REQUIRE(*size == 8200);
+
+            std::array<char, 5> readBuffer{};
+            auto read = co_await file->read(readBuffer, 4096);
+            REQUIRE(read);
+            REQUIRE(*read == 5);
+            REQUIRE(std::string_view{readBuffer.data(), readBuffer.size()} == hello);
+
+            // only 10 bytes left from 8190
+            std::array<char, 4> first{};
+            std::array<char, 16> second{};
+            std::array<std::span<char>, 2> readBuffers{first, second};
+            read = co_await file->readv(readBuffers, 8190);
+            REQUIRE(read);
+            REQUIRE(*read == 10);
+            REQUIRE(std::string_view{first.data(), first.size()} == "part");
+            REQUIRE(std::string_view{second.data(), 6} == "1part2");
+
+            read = co_await file->read(readBuffer, 8200);
+            REQUIRE(read);
+            REQUIRE(*read == 0);
+
+            auto closed = co_await file->close();
+            REQUIRE(closed);
+            read = co_await file->read(readBuffer, 0);
+            REQUIRE(!read);
+            REQUIRE(read.error() == IOError::BAD_FILE_DESCRIPTOR);
+
+            auto removed = co_await async_io_svc->first->removeFile("AsyncFile.bin");
+            REQUIRE(removed);
+            queue->pushEvent<QuitEvent>(ServiceIdType{0});
+            co_return {};
+        });
+
+        auto start = std::chrono::steady_clock::now();
+        while(queue->is_running()) {
+            std::this_thread::sleep_for(10ms);
+            auto now = std::chrono::steady_clock::now();
+            REQUIRE(now - start < 20s);
+        }
+
+        t.join();
+    }
+
+#ifndef TEST_URING
+    SECTION("Worker pool is shared by multiple queues") {
+        fmt::println("section 2f");
+        constexpr uint32_t readsPerQueue = 50;
+        std::array<std::unique_ptr<QIMPL>, 2> queues{std::make_unique<QIMPL>(500), std::make_unique<QIMPL>(500)};
+        std::array<DependencyManager*, 2> dms{&queues[0]->createManager(), &queues[1]->createManager()};
+        std::array<std::thread, 2> threads{};
+        std::array<ServiceIdType, 2> ioSvcIds{};
+        std::atomic<uint32_t> completed{};
+        std::atomic<uint32_t> failures{};
+
+        {
+            std::ofstream out("AsyncFileIO.txt");
+            out << "This is a test";
+            out.close();
+        }
+
+        for(size_t i = 0; i < queues.size(); i++) {
+            threads[i] = std::thread([&, i]() {
+                ioSvcIds[i] = dms[i]->createServiceManager<IOIMPL, IAsyncFileIO>(Properties{{"WorkerThreads", Ichor::v1::make_any<uint32_t>(3u)}})->getServiceId();
+                queues[i]->start(CaptureSigInt);
+            });
+        }
+
+        for(size_t i = 0; i < queues.size(); i++) {
+            waitForRunning(*dms[i]);
+            runForOrQueueEmpty(*dms[i]);
+
+            auto threadId = threads[i].get_id();
+            for(uint32_t j = 0; j < readsPerQueue; j++) {
+                queues[i]->pushEvent<RunFunctionEventAsync>(ServiceIdType{0}, [&, i, threadId]() -> AsyncGenerator<IchorBehaviour> {
+                    auto async_io_svc = dms[i]->getService<IAsyncFileIO>(ioSvcIds[i]);
+                    tl::expected<std::string, Ichor::v1::IOError> ret = co_await async_io_svc->first->readWholeFile("AsyncFileIO.txt");
+                    // completions have to be delivered on the queue that submitted the operation
+                    if(ret != "This is a test" || std::this_thread::get_id() != threadId) {
+                        failures.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    if(completed.fetch_add(1, std::memory_order_acq_rel) + 1 == readsPerQueue * queues.size()) {
+                        for(auto &q : queues) {
+                            q->pushEvent<QuitEvent>(ServiceIdType{0});
+                        }
+                    }
+                    co_return {};
+                });
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        while(queues[0]->is_running() || queues[1]->is_running()) {
+            std::this_thread::sleep_for(10ms);
+            auto now = std::chrono::steady_clock::now();
+            REQUIRE(now - start < 20s);
+        }
+
+        for(auto &t : threads) {
+            t.join();
+        }
+
+        REQUIRE(completed == readsPerQueue * queues.size());
+        REQUIRE(failures == 0);
+    }
+#endif
+
+    SECTION("Memory-mapped files") {
+        fmt::println("section 2g");
+#if defined(TEST_URING)
+        auto queue = std::make_unique<QIMPL>(500, 100'000'000, emulateKernelVersion);
+#else
+        auto queue = std::make_unique<QIMPL>(500);
+#endif
+        auto &dm = queue->createManager();
+        ServiceIdType mapSvcId{};
+
+        {
+            std::ofstream out("EmptyFile.txt");
+        }
+
+        std::thread t([&]() {
+#ifdef TEST_URING
+            REQUIRE(queue->createEventLoop());
+#endif
+            dm.createServiceManager<LoggerFactory<CoutLogger>, ILoggerFactory>(Properties{{"DefaultLogLevel", Ichor::v1::make_any<LogLevel>(LogLevel::LOG_TRACE)}});
+            mapSvcId = dm.createServiceManager<MappedFileService, IMappedFileService>()->getServiceId();
+            queue->start(CaptureSigInt);
+        });
+
+        waitForRunning(dm);
+
+        runForOrQueueEmpty(dm);
+
+        queue->pushEvent<RunFunctionEventAsync>(ServiceIdType{0}, [&]() -> AsyncGenerator<IchorBehaviour> {
+            auto map_svc = dm.getService<IMappedFileService>(mapSvcId);
+
+            auto missing = map_svc->first->map("NonExistentFile.txt");
+            REQUIRE(!missing);
+            REQUIRE(missing.error() == IOError::FILE_DOES_NOT_EXIST);
+
+            auto empty = map_svc->first->map("EmptyFile.txt");
+            REQUIRE(empty);
+            REQUIRE((*empty)->size() == 0);
+            REQUIRE((*empty)->data().empty());
+
+            auto mapped = map_svc->first->map("BigFile.txt", MappedFileHints::SEQUENTIAL | MappedFileHints::WILL_NEED);
+            REQUIRE(mapped);
+            REQUIRE((*mapped)->size() == (uint64_t)bigFilefilesize);
+            REQUIRE((*mapped)->view().starts_with("This is a test123This is a test123"));
+
+            std::ifstream in("BigFile.txt", std::ios::binary);
+            std::string contents{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+            REQUIRE((*mapped)->view() == contents);
+
+            auto again = map_svc->first->map("./BigFile.txt", MappedFileHints::RANDOM);
+            REQUIRE(again);
+            REQUIRE((*again)->data().data() == (*mapped)->data().data());
+
+            auto prefetched = co_await map_svc->first->prefetch(*mapped, 4096, 65536);
+            REQUIRE(prefetched);
+            auto prefetchedAll = co_await map_svc->first->prefetch(*mapped);
+            REQUIRE(prefetchedAll);
+
+            queue->pushEvent<QuitEvent>(ServiceIdType{0});
+            co_return {};
+        });
+
+        auto start = std::chrono::steady_clock::now();
+        while(queue->is_running()) {
+            std::this_thread::sleep_for(10ms);
+            auto now = std::chrono::steady_clock::now();
+            REQUIRE(now - start < 20s);
+        }
+
+        t.join();
+
+        std::remove("EmptyFile.txt");
+    }
+
     SECTION("Copying non-existent file should error") {
         fmt::print("section 3\n");
 #if defined(TEST_URING)
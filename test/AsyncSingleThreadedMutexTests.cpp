@@ -52,4 +52,55 @@ TEST_CASE("AsyncSingleThreadedMutexTests") {
 
         t.join();
     }
+
+    SECTION("Waiters get the lock one at a time") {
+        auto queue = std::make_unique<PriorityQueue>();
+        auto &dm = queue->createManager();
+        uint64_t holders{};
+        uint64_t maxHolders{};
+        uint64_t done{};
+        AsyncManualResetEvent release{};
+
+        std::thread t([&]() {
+            AsyncSingleThreadedLockGuard lg2 = m.non_blocking_lock().value();
+            lg = &lg2;
+            queue->start(CaptureSigInt);
+        });
+
+        waitForRunning(dm);
+
+        for(uint32_t i = 0; i < 3; i++) {
+            queue->pushEvent<RunFunctionEventAsync>(ServiceIdType{0}, [&]() -> AsyncGenerator<IchorBehaviour> {
+                AsyncSingleThreadedLockGuard lg3 = co_await m.lock();
+                holders++;
+                maxHolders = std::max(maxHolders, holders);
+                co_await release;
+                holders--;
+                done++;
+                co_return {};
+            });
+        }
+
+        runForOrQueueEmpty(dm);
+        REQUIRE(holders == 0);
+
+        queue->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&]() {
+            lg->unlock();
+        });
+
+        runForOrQueueEmpty(dm);
+        REQUIRE(holders == 1);
+
+        queue->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&]() {
+            release.set();
+        });
+
+        runForOrQueueEmpty(dm);
+        REQUIRE(done == 3);
+        REQUIRE(maxHolders == 1);
+
+        queue->pushEvent<QuitEvent>(ServiceIdType{0});
+
+        t.join();
+    }
 }
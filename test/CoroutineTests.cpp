@@ -31,6 +31,12 @@ uint64_t AwaitNoCopy::countMoved{};
 
 #define QIMPL SdeventQueue
 #define TFFIMPL TimerFactoryFactory
+#elif defined(TEST_EPOLL)
+#include <ichor/event_queues/EpollQueue.h>
+#include <ichor/services/timer/EpollTimerFactoryFactory.h>
+
+#define QIMPL EpollQueue
+#define TFFIMPL EpollTimerFactoryFactory
 #else
 #include <ichor/event_queues/PriorityQueue.h>
 #include <ichor/services/timer/TimerFactoryFactory.h>
@@ -65,6 +71,8 @@ TEST_CASE("CoroutineTests_uring") {
 
 #elif defined(TEST_SDEVENT)
 TEST_CASE("CoroutineTests_sdevent") {
+#elif defined(TEST_EPOLL)
+TEST_CASE("CoroutineTests_epoll") {
 #else
 #ifdef TEST_ORDERED
 TEST_CASE("CoroutineTests_ordered") {
@@ -531,7 +539,7 @@ TEST_CASE("CoroutineTests") {
 
             auto svcs = dm.getAllServices();
 
-#if defined(TEST_URING) || defined(TEST_SDEVENT)
+#if defined(TEST_URING) || defined(TEST_SDEVENT) || defined(TEST_EPOLL)
             REQUIRE(svcs.size() == 5);
 #else
             REQUIRE(svcs.size() == 4);
@@ -599,7 +607,7 @@ TEST_CASE("CoroutineTests") {
 
             auto svcs = dm.getAllServices();
 
-#if defined(TEST_URING) || defined(TEST_SDEVENT)
+#if defined(TEST_URING) || defined(TEST_SDEVENT) || defined(TEST_EPOLL)
             REQUIRE(svcs.size() == 5);
 #else
             REQUIRE(svcs.size() == 4);
@@ -621,7 +629,7 @@ TEST_CASE("CoroutineTests") {
 
             auto svcs = dm.getAllServices();
 
-#if defined(TEST_URING) || defined(TEST_SDEVENT)
+#if defined(TEST_URING) || defined(TEST_SDEVENT) || defined(TEST_EPOLL)
             REQUIRE(svcs.size() == 5);
 #else
             REQUIRE(svcs.size() == 4);
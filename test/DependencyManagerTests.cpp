@@ -3,7 +3,10 @@
 #include <ichor/events/RunFunctionEvent.h>
 #include <ichor/coroutines/AsyncManualResetEvent.h>
 #include <ichor/Filter.h>
+#include <ichor/CommunicationChannel.h>
+#include <ichor/ShardedRuntime.h>
 #include "TestServices/UselessService.h"
+#include "TestServices/CallTargetService.h"
 #include "TestServices/RegistrationCheckerService.h"
 #include "TestServices/MultipleSeparateDependencyRequestsService.h"
 
@@ -71,6 +74,207 @@ TEST_CASE("DependencyManager") {
         REQUIRE_FALSE(dm.isRunning());
     }
 
+    SECTION("DependencyManager", "Broadcast shared payload") {
+        CommunicationChannel channel{};
+        std::array<std::unique_ptr<PriorityQueue>, 3> queues{};
+        std::array<DependencyManager*, 3> dms{};
+        std::array<EventInterceptorRegistration, 3> interceptors{};
+        std::array<std::atomic<std::vector<uint8_t> const *>, 3> received{};
+        std::array<std::thread, 3> threads{};
+
+        for(uint32_t i = 0; i < queues.size(); i++) {
+            queues[i] = std::make_unique<PriorityQueue>();
+            dms[i] = &queues[i]->createManager();
+            channel.addManager(dms[i]);
+            interceptors[i] = dms[i]->registerGlobalEventInterceptor<SharedPayloadEvent<std::vector<uint8_t>>>([&received, &queues, &interceptors, i](SharedPayloadEvent<std::vector<uint8_t>> const &evt) -> bool {
+                received[i] = evt.payload.get();
+                queues[i]->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&queues, &interceptors, i]() {
+                    interceptors[i].reset();
+                    queues[i]->pushEvent<QuitEvent>(ServiceIdType{0});
+                });
+                return AllowOthersHandling;
+            }, [](SharedPayloadEvent<std::vector<uint8_t>> const &, bool) {});
+        }
+
+        for(uint32_t i = 0; i < queues.size(); i++) {
+            threads[i] = std::thread([&queues, &dms, i]() {
+                dms[i]->createServiceManager<CoutFrameworkLogger, IFrameworkLogger>();
+                queues[i]->start(CaptureSigInt);
+            });
+        }
+
+        for(auto *dm : dms) {
+            runForOrQueueEmpty(*dm);
+        }
+
+        auto payload = Ichor::v1::make_atomic_reference_counted<std::vector<uint8_t> const>(1024 * 1024, uint8_t{7});
+        channel.broadcastSharedPayload(*dms[0], ServiceIdType{0}, payload);
+        queues[0]->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&queues, &interceptors]() {
+            interceptors[0].reset();
+            queues[0]->pushEvent<QuitEvent>(ServiceIdType{0});
+        });
+
+        for(auto &t : threads) {
+            t.join();
+        }
+
+        for(auto *dm : dms) {
+            channel.removeManager(dm);
+        }
+
+        REQUIRE(received[0] == nullptr);
+        REQUIRE(received[1] == payload.get());
+        REQUIRE(received[2] == payload.get());
+        REQUIRE(payload.use_count() == 1);
+    }
+
+    SECTION("DependencyManager", "Sharded runtime") {
+        ShardedRuntime runtime{3};
+        std::array<std::thread::id, 3> shardThreads{};
+        std::array<uint64_t, 3> replicas{};
+        std::array<uint64_t, 3> managerIds{};
+        std::array<tl::optional<uint32_t>, 3> ranOnShard{};
+        std::array<tl::optional<uint32_t>, 3> resumedOnShard{};
+        std::atomic<uint32_t> keyedShard{100};
+        std::atomic<bool> shardOfOtherRuntime{true};
+        uint32_t taskResult{};
+        // shards only belong to the runtime that started them
+        ShardedRuntime otherRuntime{1};
+
+        runtime.deployReplicas<CoutFrameworkLogger, IFrameworkLogger>();
+        runtime.deployReplicas<UselessService, IUselessService>();
+        runtime.start();
+
+        REQUIRE(runtime.shardCount() == 3);
+        REQUIRE(runtime.shardFor(uint64_t{42}) == runtime.shardFor(uint64_t{42}));
+        REQUIRE(runtime.shardFor(uint64_t{42}) < 3);
+        REQUIRE(runtime.shardFor("tenant") < 3);
+        REQUIRE(!runtime.currentShard());
+
+        runtime.pushEventToShard<RunFunctionEvent>(uint64_t{42}, ServiceIdType{0}, [&]() {
+            keyedShard = *runtime.currentShard();
+            shardOfOtherRuntime = otherRuntime.currentShard().has_value();
+        });
+
+        runtime.queue(0).pushEvent<RunFunctionEventAsync>(ServiceIdType{0}, [&]() -> AsyncGenerator<IchorBehaviour> {
+            for(uint32_t shard = 0; shard < 3; shard++) {
+                auto res = co_await runtime.submitTo(shard, [&runtime]() {
+                    auto &dm = GetThreadLocalManager();
+                    return std::make_tuple(runtime.currentShard(), std::this_thread::get_id(), dm.getAllServicesOfType<IUselessService>().size(), dm.getId());
+                });
+                auto [currentShard, threadId, replicaCount, managerId] = *res;
+                ranOnShard[shard] = currentShard;
+                resumedOnShard[shard] = runtime.currentShard();
+                shardThreads[shard] = threadId;
+                replicas[shard] = replicaCount;
+                managerIds[shard] = managerId;
+            }
+
+            co_await runtime.submitTo(2, []() {});
+
+            auto taskRes = co_await runtime.submitToShardOf(uint64_t{42}, [&runtime]() -> Task<uint32_t> {
+                co_return *runtime.currentShard();
+            });
+            taskResult = *taskRes;
+
+            runtime.stop();
+            co_return {};
+        });
+
+        runtime.join();
+
+        REQUIRE(keyedShard == runtime.shardFor(uint64_t{42}));
+        REQUIRE(!shardOfOtherRuntime);
+        REQUIRE(taskResult == runtime.shardFor(uint64_t{42}));
+        REQUIRE(shardThreads[0] != shardThreads[1]);
+        REQUIRE(shardThreads[1] != shardThreads[2]);
+        REQUIRE(shardThreads[0] != std::this_thread::get_id());
+        for(uint32_t shard = 0; shard < 3; shard++) {
+            REQUIRE(ranOnShard[shard] == shard);
+            REQUIRE(resumedOnShard[shard] == 0u);
+            REQUIRE(replicas[shard] == 1);
+            REQUIRE(managerIds[shard] == runtime.manager(shard).getId());
+        }
+    }
+
+    SECTION("DependencyManager", "Call services on other managers") {
+        ShardedRuntime runtime{2};
+        std::array<EventInterceptorRegistration, 2> interceptors{};
+        std::array<std::atomic<uint64_t>, 2> runFunctionEvents{};
+        std::array<tl::expected<uint64_t, CallError>, 10> added{};
+        tl::expected<std::string, CallError> described{};
+        tl::expected<void, CallError> resetResult{};
+        tl::expected<uint64_t, CallError> totalAfterReset{};
+        tl::expected<uint64_t, CallError> missingService{};
+        tl::expected<uint64_t, CallError> missingManager{};
+        std::atomic<uint64_t> finishedCalls{};
+        uint64_t eventsForBatch{};
+
+        runtime.deployReplicas<CoutFrameworkLogger, IFrameworkLogger>();
+        runtime.deploy([&interceptors, &runFunctionEvents](DependencyManager &dm, uint32_t shard) {
+            if(shard == 1) {
+                dm.createServiceManager<CallTargetService, ICallTargetService>();
+            }
+            interceptors[shard] = dm.registerGlobalEventInterceptor<RunFunctionEvent>([&runFunctionEvents, shard](RunFunctionEvent const &) -> bool {
+                runFunctionEvents[shard]++;
+                return AllowOthersHandling;
+            }, [](RunFunctionEvent const &, bool) {});
+        });
+        runtime.start();
+
+        uint64_t const targetId = runtime.manager(1).getId();
+        auto &channel = runtime.channel();
+
+        runtime.queue(0).pushEvent<RunFunctionEventAsync>(ServiceIdType{0}, [&]() -> AsyncGenerator<IchorBehaviour> {
+            // separate coroutines, all calling before the first batch is sent, which is flushed with INTERNAL_EVENT_PRIORITY
+            for(uint64_t i = 0; i < added.size(); i++) {
+                GetThreadLocalEventQueue().pushPrioritisedEvent<RunFunctionEventAsync>(ServiceIdType{0}, INTERNAL_EVENT_PRIORITY - 1, [&, i]() -> AsyncGenerator<IchorBehaviour> {
+                    added[i] = co_await channel.call<ICallTargetService>(targetId, &ICallTargetService::add, uint64_t{1});
+                    finishedCalls++;
+                    co_return {};
+                });
+            }
+
+            while(finishedCalls != added.size()) {
+                co_await channel.runOn(runtime.manager(0).getId(), []() {});
+            }
+            eventsForBatch = runFunctionEvents[1];
+
+            described = co_await channel.call<ICallTargetService>(targetId, &ICallTargetService::describe, std::string{"manager "});
+            resetResult = co_await channel.call<ICallTargetService>(targetId, &ICallTargetService::reset);
+            totalAfterReset = co_await channel.call<ICallTargetService>(targetId, &ICallTargetService::total);
+            missingService = co_await channel.call<ICallTargetService>(runtime.manager(0).getId(), &ICallTargetService::total);
+            missingManager = co_await channel.call<ICallTargetService>(targetId + 100, &ICallTargetService::total);
+
+            // not from a RunFunctionEvent, which the interceptor is intercepting
+            co_await runtime.submitTo(1, [&interceptors]() -> Task<void> {
+                interceptors[1].reset();
+                co_return;
+            });
+            interceptors[0].reset();
+            runtime.stop();
+            co_return {};
+        });
+
+        runtime.join();
+
+        std::array<bool, 10> seen{};
+        for(auto &res : added) {
+            REQUIRE(res);
+            REQUIRE(*res >= 1);
+            REQUIRE(*res <= 10);
+            REQUIRE(!seen[*res - 1]);
+            seen[*res - 1] = true;
+        }
+        // one event with all ten calls, one to send back all ten results
+        REQUIRE(eventsForBatch == 2);
+        REQUIRE(described == fmt::format("manager {}", targetId));
+        REQUIRE(resetResult);
+        REQUIRE(totalAfterReset == 0u);
+        REQUIRE(missingService.error() == CallError::NO_SUCH_SERVICE);
+        REQUIRE(missingManager.error() == CallError::NO_SUCH_MANAGER);
+    }
+
     SECTION("DependencyManager", "Check Registrations") {
         auto queue = std::make_unique<PriorityQueue>();
         auto &dm = queue->createManager();
@@ -41,6 +41,24 @@ TEST_CASE("Filter Tests") {
         }
     }
 
+    SECTION("FilterIndexKey") {
+        Filter byId{ServiceIdFilterEntry{ServiceIdType{5}}};
+        REQUIRE(byId.indexKey().kind == FilterIndexKey::Kind::SERVICE_ID);
+        REQUIRE(byId.indexKey().value == 5);
+
+        Filter byProperty{PropertiesFilterEntry<std::string, false>{"TestProp", "value"}};
+        auto const key = byProperty.indexKey();
+        REQUIRE(key.kind == FilterIndexKey::Kind::PROPERTY);
+        REQUIRE(key.nameHash == PropertyName{"TestProp"}.hash());
+        REQUIRE(key.hashProperty(Ichor::v1::make_any<std::string>("value")) == key.value);
+        REQUIRE(key.hashProperty(Ichor::v1::make_any<std::string>("other")) != key.value);
+        REQUIRE(!key.hashProperty(Ichor::v1::make_any<int>(5)));
+
+        // also matches services without the property, which cannot be looked up
+        Filter missingOk{PropertiesFilterEntry<std::string, true>{"TestProp", "value"}};
+        REQUIRE(missingOk.indexKey().kind == FilterIndexKey::Kind::NONE);
+    }
+
     SECTION("DependencyPropertiesFilterEntry") {
         {
             DependencyPropertiesFilterEntry<Interface1, bool, false> f{"TestProp", true};
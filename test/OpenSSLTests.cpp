@@ -5,6 +5,7 @@
 #include <ichor/services/network/ssl/openssl/OpenSSLContext.h>
 #include <ichor/services/network/ssl/openssl/OpenSSLConnection.h>
 #include <ichor/dependency_management/InternalServiceLifecycleManager.h>
+#include <openssl/evp.h>
 #include <fstream>
 #include <catch2/generators/catch_generators.hpp>
 
@@ -13,6 +14,35 @@
 #include "Mocks/QueueMock.h"
 #include "SSLCerts.h"
 
+namespace {
+    // builds a TLS 1.3 application data record the way kernel TLS would
+    std::vector<uint8_t> sealRecord(TLSTrafficKeys const &keys, std::span<uint8_t const> plaintext) {
+        EVP_CIPHER const *cipher = keys.cipher == TLSCipher::AES_128_GCM ? EVP_aes_128_gcm() : keys.cipher == TLSCipher::AES_256_GCM ? EVP_aes_256_gcm() : EVP_chacha20_poly1305();
+        auto nonce = keys.iv;
+        for(size_t i = 0; i < 8; i++) {
+            nonce[nonce.size() - 1 - i] ^= static_cast<uint8_t>(keys.sequenceNumber >> (i * 8));
+        }
+
+        auto innerLength = plaintext.size() + 1;
+        auto recordLength = innerLength + 16;
+        std::vector<uint8_t> record{0x17, 0x03, 0x03, static_cast<uint8_t>(recordLength >> 8), static_cast<uint8_t>(recordLength)};
+        std::vector<uint8_t> inner(plaintext.begin(), plaintext.end());
+        inner.push_back(0x17);
+        record.resize(5 + recordLength);
+
+        auto *ctx = EVP_CIPHER_CTX_new();
+        int len{};
+        REQUIRE(EVP_EncryptInit_ex(ctx, cipher, nullptr, keys.key.data(), nonce.data()) == 1);
+        REQUIRE(EVP_EncryptUpdate(ctx, nullptr, &len, record.data(), 5) == 1);
+        REQUIRE(EVP_EncryptUpdate(ctx, record.data() + 5, &len, inner.data(), static_cast<int>(inner.size())) == 1);
+        REQUIRE(EVP_EncryptFinal_ex(ctx, record.data() + 5 + len, &len) == 1);
+        REQUIRE(EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG, 16, record.data() + 5 + innerLength) == 1);
+        EVP_CIPHER_CTX_free(ctx);
+
+        return record;
+    }
+}
+
 TEST_CASE("OpenSSL Handshake Tests - supported server certificate only") {
     Properties props{};
     QueueMock qm{};
@@ -219,3 +249,214 @@ TEST_CASE("OpenSSL Handshake Tests - rejects weaker certificates") {
     auto serverContextOpt = sslService.getService().createServerTLSContext(cert, key, opts);
     REQUIRE(!serverContextOpt);
 }
+
+TEST_CASE("OpenSSL Streaming Tests - encrypt/decrypt and session resumption") {
+    Properties props{};
+    QueueMock qm{};
+    Ichor::Detail::InternalServiceLifecycleManager<IEventQueue> q{&qm};
+    Ichor::Detail::DependencyLifecycleManager<LoggerMock, ILogger> logger{{}};
+    Ichor::Detail::DependencyLifecycleManager<OpenSSLService, ISSL> sslService{std::move(props)};
+
+    std::vector<uint8_t> cert(ecdsa_p256_cert, ecdsa_p256_cert + sizeof(ecdsa_p256_cert));
+    std::vector<uint8_t> key(ecdsa_p256_private_key, ecdsa_p256_private_key + sizeof(ecdsa_p256_private_key));
+
+    {
+        auto ret = sslService.dependencyOnline(&q);
+        REQUIRE(ret == StartBehaviour::DONE);
+        ret = sslService.dependencyOnline(&logger);
+        REQUIRE(ret == StartBehaviour::STARTED);
+    }
+
+    auto gen = sslService.start();
+    auto it = gen.begin();
+    REQUIRE(it.get_finished());
+
+    auto &ssl = sslService.getService();
+    auto serverContext = std::move(*ssl.createServerTLSContext(cert, key, {}));
+    auto clientContext = std::move(*ssl.createClientTLSContext({.allowUnknownCertificates = true}));
+
+    // pumps data between client and server until neither has anything left to send
+    auto handshake = [&ssl](TLSConnection &client, TLSConnection &server) {
+        std::vector<uint8_t> toServer;
+        std::vector<uint8_t> toClient;
+        std::vector<uint8_t> plaintext;
+        REQUIRE(ssl.TLSDoHandshake(client) == TLSHandshakeStatus::WANT_READ);
+        ssl.TLSDrainPending(client, toServer);
+
+        while(!toServer.empty() || !toClient.empty()) {
+            std::vector<uint8_t> in = std::move(toServer);
+            toServer.clear();
+            REQUIRE(ssl.TLSDecrypt(server, in, plaintext, toClient));
+            in = std::move(toClient);
+            toClient.clear();
+            REQUIRE(ssl.TLSDecrypt(client, in, plaintext, toServer));
+        }
+
+        REQUIRE(plaintext.empty());
+        REQUIRE(ssl.TLSIsHandshakeDone(client));
+        REQUIRE(ssl.TLSIsHandshakeDone(server));
+    };
+
+    {
+        auto serverConn = std::move(*ssl.createTLSConnection(*serverContext, {}));
+        auto clientConn = std::move(*ssl.createTLSConnection(*clientContext, {.serverName = "localhost"}));
+        handshake(*clientConn, *serverConn);
+        REQUIRE(!ssl.TLSIsSessionReused(*clientConn));
+
+        // bigger than both a single record and the bio pair buffer
+        std::vector<uint8_t> msg(100'000);
+        for(size_t i = 0; i < msg.size(); i++) {
+            msg[i] = static_cast<uint8_t>(i);
+        }
+        std::vector<uint8_t> ciphertext;
+        std::vector<uint8_t> plaintext;
+        std::vector<uint8_t> unused;
+        REQUIRE(ssl.TLSEncrypt(*clientConn, msg, ciphertext));
+        REQUIRE(ciphertext.size() > msg.size());
+
+        // deliver in odd sized chunks, to force partial records
+        for(size_t offset = 0; offset < ciphertext.size(); offset += 1'000) {
+            auto len = std::min<size_t>(1'000, ciphertext.size() - offset);
+            REQUIRE(ssl.TLSDecrypt(*serverConn, std::span<uint8_t const>{ciphertext.data() + offset, len}, plaintext, unused));
+        }
+        REQUIRE(plaintext == msg);
+    }
+
+    {
+        auto serverConn = std::move(*ssl.createTLSConnection(*serverContext, {}));
+        auto clientConn = std::move(*ssl.createTLSConnection(*clientContext, {.serverName = "localhost"}));
+        handshake(*clientConn, *serverConn);
+        REQUIRE(ssl.TLSIsSessionReused(*clientConn));
+        REQUIRE(ssl.TLSIsSessionReused(*serverConn));
+    }
+
+    {
+        // no cached session for other server names
+        auto serverConn = std::move(*ssl.createTLSConnection(*serverContext, {}));
+        auto clientConn = std::move(*ssl.createTLSConnection(*clientContext, {.serverName = "example.com"}));
+        handshake(*clientConn, *serverConn);
+        REQUIRE(!ssl.TLSIsSessionReused(*clientConn));
+    }
+}
+
+TEST_CASE("OpenSSL Kernel Offload Tests - exported traffic keys continue the record stream") {
+    Properties props{};
+    QueueMock qm{};
+    Ichor::Detail::InternalServiceLifecycleManager<IEventQueue> q{&qm};
+    Ichor::Detail::DependencyLifecycleManager<LoggerMock, ILogger> logger{{}};
+    Ichor::Detail::DependencyLifecycleManager<OpenSSLService, ISSL> sslService{std::move(props)};
+
+    std::vector<uint8_t> cert(ecdsa_p256_cert, ecdsa_p256_cert + sizeof(ecdsa_p256_cert));
+    std::vector<uint8_t> key(ecdsa_p256_private_key, ecdsa_p256_private_key + sizeof(ecdsa_p256_private_key));
+
+    {
+        auto ret = sslService.dependencyOnline(&q);
+        REQUIRE(ret == StartBehaviour::DONE);
+        ret = sslService.dependencyOnline(&logger);
+        REQUIRE(ret == StartBehaviour::STARTED);
+    }
+
+    auto gen = sslService.start();
+    auto it = gen.begin();
+    REQUIRE(it.get_finished());
+
+    auto &ssl = sslService.getService();
+    // two tickets, so the server already used some sequence numbers before the first application data record
+    auto serverContext = std::move(*ssl.createServerTLSContext(cert, key, {.sessionTicketCount = 2, .allowKernelOffload = true}));
+    auto clientContext = std::move(*ssl.createClientTLSContext({.allowUnknownCertificates = true, .allowKernelOffload = true}));
+    auto plainServerContext = std::move(*ssl.createServerTLSContext(cert, key, {}));
+    auto plainClientContext = std::move(*ssl.createClientTLSContext({.allowUnknownCertificates = true}));
+
+    auto handshake = [&ssl](TLSConnection &client, TLSConnection &server) {
+        std::vector<uint8_t> toServer;
+        std::vector<uint8_t> toClient;
+        std::vector<uint8_t> plaintext;
+        REQUIRE(ssl.TLSDoHandshake(client) == TLSHandshakeStatus::WANT_READ);
+        ssl.TLSDrainPending(client, toServer);
+
+        while(!toServer.empty() || !toClient.empty()) {
+            std::vector<uint8_t> in = std::move(toServer);
+            toServer.clear();
+            REQUIRE(ssl.TLSDecrypt(server, in, plaintext, toClient));
+            in = std::move(toClient);
+            toClient.clear();
+            REQUIRE(ssl.TLSDecrypt(client, in, plaintext, toServer));
+        }
+
+        REQUIRE(ssl.TLSIsHandshakeDone(client));
+        REQUIRE(ssl.TLSIsHandshakeDone(server));
+    };
+
+    {
+        auto serverConn = std::move(*ssl.createTLSConnection(*plainServerContext, {}));
+        auto clientConn = std::move(*ssl.createTLSConnection(*plainClientContext, {}));
+        handshake(*clientConn, *serverConn);
+
+        auto keys = ssl.TLSExportTrafficKeys(*clientConn, TLSTrafficDirection::SEND);
+        REQUIRE(!keys);
+        REQUIRE(keys.error() == TLSConnectionError::UNSUPPORTED);
+    }
+
+    {
+        auto serverConn = std::move(*ssl.createTLSConnection(*serverContext, {}));
+        auto clientConn = std::move(*ssl.createTLSConnection(*clientContext, {}));
+
+        // nothing to export before the handshake is done
+        REQUIRE(!ssl.TLSExportTrafficKeys(*clientConn, TLSTrafficDirection::SEND));
+
+        handshake(*clientConn, *serverConn);
+
+        std::vector<uint8_t> msg{'h', 'e', 'l', 'l', 'o'};
+        std::vector<uint8_t> ciphertext;
+        std::vector<uint8_t> plaintext;
+        std::vector<uint8_t> unused;
+
+        // a few records in user space first, to move the sequence numbers
+        for(int i = 0; i < 3; i++) {
+            REQUIRE(ssl.TLSEncrypt(*clientConn, msg, ciphertext));
+        }
+        REQUIRE(ssl.TLSDecrypt(*serverConn, ciphertext, plaintext, unused));
+        REQUIRE(plaintext.size() == msg.size() * 3);
+        plaintext.clear();
+
+        auto clientSend = ssl.TLSExportTrafficKeys(*clientConn, TLSTrafficDirection::SEND);
+        REQUIRE(clientSend);
+        REQUIRE(clientSend->sequenceNumber == 3);
+        REQUIRE(!ssl.TLSExportTrafficKeys(*clientConn, TLSTrafficDirection::SEND));
+
+        std::vector<uint8_t> offloaded{'o', 'f', 'f', 'l', 'o', 'a', 'd', 'e', 'd'};
+        auto record = sealRecord(*clientSend, offloaded);
+        REQUIRE(ssl.TLSDecrypt(*serverConn, record, plaintext, unused));
+        REQUIRE(plaintext == offloaded);
+        plaintext.clear();
+
+        auto serverReceive = ssl.TLSExportTrafficKeys(*serverConn, TLSTrafficDirection::RECEIVE);
+        REQUIRE(serverReceive);
+        REQUIRE(serverReceive->sequenceNumber == 4);
+        REQUIRE(serverReceive->key == clientSend->key);
+        REQUIRE(serverReceive->iv == clientSend->iv);
+
+        auto serverSend = ssl.TLSExportTrafficKeys(*serverConn, TLSTrafficDirection::SEND);
+        REQUIRE(serverSend);
+        REQUIRE(serverSend->sequenceNumber == 2);
+
+        record = sealRecord(*serverSend, offloaded);
+        REQUIRE(ssl.TLSDecrypt(*clientConn, record, plaintext, unused));
+        REQUIRE(plaintext == offloaded);
+        plaintext.clear();
+
+        // a partially received record can't be handed over
+        serverSend->sequenceNumber++;
+        record = sealRecord(*serverSend, offloaded);
+        REQUIRE(ssl.TLSDecrypt(*clientConn, std::span<uint8_t const>{record.data(), record.size() / 2}, plaintext, unused));
+        REQUIRE(plaintext.empty());
+        auto clientReceive = ssl.TLSExportTrafficKeys(*clientConn, TLSTrafficDirection::RECEIVE);
+        REQUIRE(!clientReceive);
+        REQUIRE(ssl.TLSDecrypt(*clientConn, std::span<uint8_t const>{record.data() + record.size() / 2, record.size() - record.size() / 2}, plaintext, unused));
+        REQUIRE(plaintext == offloaded);
+
+        clientReceive = ssl.TLSExportTrafficKeys(*clientConn, TLSTrafficDirection::RECEIVE);
+        REQUIRE(clientReceive);
+        REQUIRE(clientReceive->sequenceNumber == 4);
+    }
+}
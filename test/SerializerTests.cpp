@@ -0,0 +1,148 @@
+#include "Common.h"
+#include "../examples/common/TestMsgGlazeSerializer.h"
+#include <ichor/services/serialization/GlazeBinarySerializer.h>
+#include <algorithm>
+
+namespace {
+    // only implements the required methods, so the defaults of ISerializer get used
+    class MinimalTestMsgSerializer final : public ISerializer<TestMsg> {
+    public:
+        std::vector<uint8_t> serialize(TestMsg const &msg) final {
+            return _inner.serialize(msg);
+        }
+
+        tl::optional<TestMsg> deserialize(std::span<uint8_t const> stream) final {
+            return _inner.deserialize(stream);
+        }
+
+    private:
+        TestMsgGlazeSerializer _inner;
+    };
+}
+
+TEST_CASE("SerializerTests") {
+
+    SECTION("serializeInto an empty buffer produces the same bytes as serialize") {
+        TestMsgGlazeSerializer serializer;
+        TestMsg msg{20, "five hundred"};
+
+        std::vector<uint8_t> buffer;
+        REQUIRE(serializer.serializeInto(msg, buffer));
+        REQUIRE(buffer == serializer.serialize(msg));
+
+        auto ret = serializer.deserialize(buffer);
+        REQUIRE(ret);
+        REQUIRE(ret->id == 20);
+        REQUIRE(ret->val == "five hundred");
+    }
+
+    SECTION("serializeInto appends to a buffer that is not empty") {
+        TestMsgGlazeSerializer serializer;
+        TestMsg first{1, "first"};
+        TestMsg second{2, "second message, longer than the first"};
+        auto firstBytes = serializer.serialize(first);
+        auto secondBytes = serializer.serialize(second);
+
+        std::vector<uint8_t> buffer{1, 2, 3};
+        REQUIRE(serializer.serializeInto(first, buffer));
+        REQUIRE(serializer.serializeInto(second, buffer));
+        // the second message is larger than what the scratch buffer held before
+        REQUIRE(serializer.serializeInto(first, buffer));
+
+        REQUIRE(buffer.size() == 3 + firstBytes.size() * 2 + secondBytes.size());
+        REQUIRE(buffer[0] == 1);
+        REQUIRE(buffer[1] == 2);
+        REQUIRE(buffer[2] == 3);
+
+        std::span<uint8_t const> data{buffer};
+        REQUIRE(std::ranges::equal(data.subspan(3, firstBytes.size()), firstBytes));
+        REQUIRE(std::ranges::equal(data.subspan(3 + firstBytes.size(), secondBytes.size()), secondBytes));
+        REQUIRE(std::ranges::equal(data.subspan(3 + firstBytes.size() + secondBytes.size()), firstBytes));
+
+        auto ret = serializer.deserialize(data.subspan(3 + firstBytes.size(), secondBytes.size()));
+        REQUIRE(ret);
+        REQUIRE(ret->id == 2);
+        REQUIRE(ret->val == "second message, longer than the first");
+    }
+
+    SECTION("deserializeInto overwrites an existing object") {
+        TestMsgGlazeSerializer serializer;
+        auto bytes = serializer.serialize(TestMsg{3, "new"});
+
+        TestMsg msg{100, "an old value that is longer than the new one"};
+        REQUIRE(serializer.deserializeInto(bytes, msg));
+        REQUIRE(msg.id == 3);
+        REQUIRE(msg.val == "new");
+
+        std::string_view invalid = "not a message";
+        REQUIRE(!serializer.deserializeInto(std::span<uint8_t const>{reinterpret_cast<uint8_t const*>(invalid.data()), invalid.size()}, msg));
+    }
+
+    SECTION("Default implementations use serialize and deserialize") {
+        MinimalTestMsgSerializer serializer;
+        TestMsg msg{4, "four"};
+        auto bytes = serializer.serialize(msg);
+
+        std::vector<uint8_t> buffer{9};
+        REQUIRE(serializer.serializeInto(msg, buffer));
+        REQUIRE(buffer.size() == 1 + bytes.size());
+        REQUIRE(buffer[0] == 9);
+        REQUIRE(std::ranges::equal(std::span<uint8_t const>{buffer}.subspan(1), bytes));
+        REQUIRE(!serializer.serializedSize(msg));
+
+        TestMsg out{5, "five"};
+        REQUIRE(serializer.deserializeInto(bytes, out));
+        REQUIRE(out.id == 4);
+        REQUIRE(out.val == "four");
+    }
+
+    SECTION("GlazeBinarySerializer round trip") {
+        GlazeBinarySerializer<TestMsg> serializer;
+        auto bytes = serializer.serialize(TestMsg{6, "six"});
+        REQUIRE(!bytes.empty());
+
+        auto ret = serializer.deserialize(bytes);
+        REQUIRE(ret);
+        REQUIRE(ret->id == 6);
+        REQUIRE(ret->val == "six");
+
+        REQUIRE(!serializer.deserialize(std::span<uint8_t const>{}));
+    }
+
+    SECTION("GlazeBinarySerializer serializeInto appends to a buffer that is not empty") {
+        GlazeBinarySerializer<TestMsg> serializer;
+        TestMsg first{7, "seven"};
+        TestMsg second{8, "eight, longer than seven"};
+        auto firstBytes = serializer.serialize(first);
+        auto secondBytes = serializer.serialize(second);
+
+        std::vector<uint8_t> buffer;
+        REQUIRE(serializer.serializeInto(first, buffer));
+        REQUIRE(buffer == firstBytes);
+        REQUIRE(serializer.serializeInto(second, buffer));
+        REQUIRE(serializer.serializeInto(first, buffer));
+
+        REQUIRE(buffer.size() == firstBytes.size() * 2 + secondBytes.size());
+        std::span<uint8_t const> data{buffer};
+        REQUIRE(std::ranges::equal(data.subspan(0, firstBytes.size()), firstBytes));
+        REQUIRE(std::ranges::equal(data.subspan(firstBytes.size(), secondBytes.size()), secondBytes));
+        REQUIRE(std::ranges::equal(data.subspan(firstBytes.size() + secondBytes.size()), firstBytes));
+
+        auto ret = serializer.deserialize(data.subspan(firstBytes.size(), secondBytes.size()));
+        REQUIRE(ret);
+        REQUIRE(ret->id == 8);
+        REQUIRE(ret->val == "eight, longer than seven");
+    }
+
+    SECTION("GlazeBinarySerializer deserializeInto overwrites an existing object") {
+        GlazeBinarySerializer<TestMsg> serializer;
+        auto bytes = serializer.serialize(TestMsg{9, "nine"});
+
+        TestMsg msg{100, "an old value that is longer than the new one"};
+        REQUIRE(serializer.deserializeInto(bytes, msg));
+        REQUIRE(msg.id == 9);
+        REQUIRE(msg.val == "nine");
+
+        REQUIRE(!serializer.deserializeInto(std::span<uint8_t const>{}, msg));
+    }
+}
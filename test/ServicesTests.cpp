@@ -15,10 +15,19 @@
 #include "TestServices/AsyncBroadcastService.h"
 #include "TestServices/RemoveAfterAwaitedStopService.h"
 #include "TestServices/AwaitingDependencyService.h"
+#include "TestServices/OffloadingService.h"
+#include "TestServices/ParallelStartService.h"
 #include <ichor/events/RunFunctionEvent.h>
 #include <ichor/services/logging/LoggerFactory.h>
 #include <ichor/services/logging/CoutLogger.h>
 #include <ichor/services/logging/CoutFrameworkLogger.h>
+#include <ichor/services/logging/AsyncLogger.h>
+#include <ichor/services/logging/BinaryLogger.h>
+#include <ichor/services/metrics/MetricsRegistryService.h>
+#include <ichor/services/workers/WorkerPoolService.h>
+#include <filesystem>
+#include <fstream>
+#include <random>
 #include "../examples/common/DebugService.h"
 
 
@@ -36,6 +45,12 @@
 
 #define QIMPL SdeventQueue
 #define TFFIMPL TimerFactoryFactory
+#elif defined(TEST_EPOLL)
+#include <ichor/event_queues/EpollQueue.h>
+#include <ichor/services/timer/EpollTimerFactoryFactory.h>
+
+#define QIMPL EpollQueue
+#define TFFIMPL EpollTimerFactoryFactory
 #else
 #include <ichor/event_queues/PriorityQueue.h>
 #include <ichor/services/timer/TimerFactoryFactory.h>
@@ -87,6 +102,8 @@ TEST_CASE("ServicesTests_uring") {
 
 #elif defined(TEST_SDEVENT)
 TEST_CASE("ServicesTests_sdevent") {
+#elif defined(TEST_EPOLL)
+TEST_CASE("ServicesTests_epoll") {
 #else
 #ifdef TEST_ORDERED
 TEST_CASE("ServicesTests_ordered") {
@@ -495,6 +512,273 @@ TEST_CASE("ServicesTests") {
         REQUIRE_FALSE(dm.isRunning());
     }
 
+    SECTION("Filtered dependencies are only injected into matching services") {
+#if defined(TEST_URING)
+        auto queue = std::make_unique<QIMPL>(500, 100'000'000, emulateKernelVersion);
+#else
+        auto queue = std::make_unique<QIMPL>(500);
+#endif
+        auto &dm = queue->createManager();
+        ServiceIdType firstId{};
+        ServiceIdType secondId{};
+        ServiceIdType thirdId{};
+
+        std::thread t([&]() {
+#if defined(TEST_URING)
+            REQUIRE(queue->createEventLoop());
+#elif defined(TEST_SDEVENT)
+            auto *loop = queue->createEventLoop();
+            REQUIRE(loop);
+#endif
+            dm.createServiceManager<CoutFrameworkLogger, IFrameworkLogger>();
+            firstId = dm.createServiceManager<DependencyService<IUselessService, DependencyFlags::ALLOW_MULTIPLE>, ICountService>(Properties{{"Scope", Ichor::v1::make_any<std::string>("a")}})->getServiceId();
+            secondId = dm.createServiceManager<DependencyService<IUselessService, DependencyFlags::ALLOW_MULTIPLE>, ICountService>(Properties{{"Scope", Ichor::v1::make_any<std::string>("b")}})->getServiceId();
+            // indexed on service id, on property value, not filtered and not indexable because it also matches services without the property
+            dm.createServiceManager<UselessService, IUselessService>(Properties{{"Filter", Ichor::v1::make_any<Filter>(ServiceIdFilterEntry{firstId})}});
+            dm.createServiceManager<UselessService, IUselessService>(Properties{{"Filter", Ichor::v1::make_any<Filter>(PropertiesFilterEntry<std::string, false>{"Scope", "b"})}});
+            dm.createServiceManager<UselessService, IUselessService>();
+            dm.createServiceManager<UselessService, IUselessService>(Properties{{"Filter", Ichor::v1::make_any<Filter>(PropertiesFilterEntry<std::string, true>{"Scope", "a"})}});
+            queue->start(CaptureSigInt);
+#if defined(TEST_SDEVENT)
+            int r = sd_event_loop(loop);
+            REQUIRE(r >= 0);
+#endif
+        });
+
+        waitForRunning(dm);
+
+        runForOrQueueEmpty(dm);
+
+        queue->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&]() {
+            REQUIRE(dm.getService<ICountService>(firstId).value().first->getSvcCount() == 3);
+            REQUIRE(dm.getService<ICountService>(secondId).value().first->getSvcCount() == 2);
+
+            // dependencies that are already online are found through the index as well
+            thirdId = dm.createServiceManager<DependencyService<IUselessService, DependencyFlags::ALLOW_MULTIPLE>, ICountService>(Properties{{"Scope", Ichor::v1::make_any<std::string>("b")}})->getServiceId();
+        });
+
+        runForOrQueueEmpty(dm);
+
+        queue->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&]() {
+            REQUIRE(dm.getService<ICountService>(thirdId).value().first->getSvcCount() == 2);
+
+            dm.getEventQueue().pushEvent<QuitEvent>(ServiceIdType{0});
+        });
+
+        t.join();
+
+        REQUIRE_FALSE(dm.isRunning());
+    }
+
+    SECTION("Service batches start in dependency order and report readiness once") {
+#if defined(TEST_URING)
+        auto queue = std::make_unique<QIMPL>(500, 100'000'000, emulateKernelVersion);
+#else
+        auto queue = std::make_unique<QIMPL>(500);
+#endif
+        auto &dm = queue->createManager();
+        ServiceIdType requiredId{};
+        ServiceIdType optionalId{};
+        uint64_t batchId{};
+        uint64_t batchesStarted{};
+        uint64_t servicesStartedSeparately{};
+        EventInterceptorRegistration batchInterceptor{};
+        EventInterceptorRegistration startInterceptor{};
+
+        std::thread t([&]() {
+#if defined(TEST_URING)
+            REQUIRE(queue->createEventLoop());
+#elif defined(TEST_SDEVENT)
+            auto *loop = queue->createEventLoop();
+            REQUIRE(loop);
+#endif
+            batchInterceptor = dm.registerGlobalEventInterceptor<ServiceBatchStartedEvent>([&](ServiceBatchStartedEvent const &evt) -> bool {
+                REQUIRE(evt.batchId == batchId);
+                batchesStarted++;
+                return true;
+            }, [](ServiceBatchStartedEvent const &, bool) {});
+            startInterceptor = dm.registerGlobalEventInterceptor<StartServiceEvent>([&](StartServiceEvent const &) -> bool {
+                servicesStartedSeparately++;
+                return true;
+            }, [](StartServiceEvent const &, bool) {});
+
+            dm.createServiceManager<CoutFrameworkLogger, IFrameworkLogger>();
+            auto batch = dm.createServiceBatch();
+            // dependents before the services they depend on, the batch reorders them
+            requiredId = batch.createServiceManager<DependencyService<IUselessService, DependencyFlags::REQUIRED | DependencyFlags::ALLOW_MULTIPLE>, ICountService>()->getServiceId();
+            optionalId = batch.createServiceManager<DependencyService<IUselessService, DependencyFlags::ALLOW_MULTIPLE>, ICountService>()->getServiceId();
+            batch.createServiceManager<UselessService, IUselessService>();
+            batch.createServiceManager<UselessService, IUselessService>();
+            REQUIRE(batch.size() == 4);
+            batchId = dm.insertServiceBatch(std::move(batch));
+            queue->start(CaptureSigInt);
+#if defined(TEST_SDEVENT)
+            int r = sd_event_loop(loop);
+            REQUIRE(r >= 0);
+#endif
+        });
+
+        waitForRunning(dm);
+
+        runForOrQueueEmpty(dm);
+
+        queue->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&]() {
+            REQUIRE(batchesStarted == 1);
+            // only the logger, which was created separately
+            REQUIRE(servicesStartedSeparately == 1);
+            REQUIRE(dm.getService<ICountService>(requiredId).value().first->isRunning());
+            REQUIRE(dm.getService<ICountService>(requiredId).value().first->getSvcCount() == 2);
+            REQUIRE(dm.getService<ICountService>(optionalId).value().first->isRunning());
+            REQUIRE(dm.getService<ICountService>(optionalId).value().first->getSvcCount() == 2);
+
+            batchInterceptor.reset();
+            startInterceptor.reset();
+            dm.getEventQueue().pushEvent<QuitEvent>(ServiceIdType{0});
+        });
+
+        t.join();
+
+        REQUIRE_FALSE(dm.isRunning());
+    }
+
+    SECTION("Independent services in a batch run their offloaded start work in parallel") {
+#if defined(TEST_URING)
+        auto queue = std::make_unique<QIMPL>(500, 100'000'000, emulateKernelVersion);
+#else
+        auto queue = std::make_unique<QIMPL>(500);
+#endif
+        auto &dm = queue->createManager();
+        ServiceIdType firstId{};
+        ServiceIdType secondId{};
+        ServiceIdType dependentId{};
+        std::thread::id queueThread{};
+        uint64_t batchesStarted{};
+        EventInterceptorRegistration batchInterceptor{};
+        OffloadingService::maxJobsRunning = 0;
+
+        std::thread t([&]() {
+#if defined(TEST_URING)
+            REQUIRE(queue->createEventLoop());
+#elif defined(TEST_SDEVENT)
+            auto *loop = queue->createEventLoop();
+            REQUIRE(loop);
+#endif
+            queueThread = std::this_thread::get_id();
+            // the offloaded work finishes outside of the event loop, so wait for the batch rather than for an empty queue
+            batchInterceptor = dm.registerGlobalEventInterceptor<ServiceBatchStartedEvent>([&](ServiceBatchStartedEvent const &) -> bool {
+                batchesStarted++;
+                // both start() bodies were offloaded before either finished
+                REQUIRE(OffloadingService::maxJobsRunning == 2);
+                for(auto const id : {firstId, secondId}) {
+                    auto svc = dm.getService<IUselessService>(id);
+                    REQUIRE(svc);
+                    auto const *offloading = static_cast<OffloadingService const *>(svc.value().first);
+                    REQUIRE(svc.value().second->isStarted());
+                    REQUIRE(offloading->_workerThread != queueThread);
+                    REQUIRE(offloading->_resumedThread == queueThread);
+                }
+                REQUIRE(dm.getService<ICountService>(dependentId).value().first->isRunning());
+                REQUIRE(dm.getService<ICountService>(dependentId).value().first->getSvcCount() == 2);
+
+                dm.getEventQueue().pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&]() {
+                    batchInterceptor.reset();
+                    dm.getEventQueue().pushEvent<QuitEvent>(ServiceIdType{0});
+                });
+                return true;
+            }, [](ServiceBatchStartedEvent const &, bool) {});
+
+            dm.createServiceManager<CoutFrameworkLogger, IFrameworkLogger>();
+            auto batch = dm.createServiceBatch();
+            dependentId = batch.createServiceManager<DependencyService<IUselessService, DependencyFlags::REQUIRED | DependencyFlags::ALLOW_MULTIPLE>, ICountService>()->getServiceId();
+            firstId = batch.createServiceManager<OffloadingService, IUselessService>()->getServiceId();
+            secondId = batch.createServiceManager<OffloadingService, IUselessService>()->getServiceId();
+            batch.createServiceManager<WorkerPoolService, IWorkerPool>(Properties{{"WorkerThreads", Ichor::v1::make_any<uint32_t>(2u)}});
+            dm.insertServiceBatch(std::move(batch));
+            queue->start(CaptureSigInt);
+#if defined(TEST_SDEVENT)
+            int r = sd_event_loop(loop);
+            REQUIRE(r >= 0);
+#endif
+        });
+
+        t.join();
+
+        REQUIRE(batchesStarted == 1);
+        REQUIRE_FALSE(dm.isRunning());
+    }
+
+    SECTION("Batch services with ParallelStart start concurrently on the worker pool") {
+#if defined(TEST_URING)
+        auto queue = std::make_unique<QIMPL>(500, 100'000'000, emulateKernelVersion);
+#else
+        auto queue = std::make_unique<QIMPL>(500);
+#endif
+        auto &dm = queue->createManager();
+        std::vector<ServiceIdType> parallelIds;
+        ServiceIdType dependentId{};
+        std::thread::id queueThread{};
+        uint64_t batchesStarted{};
+        EventInterceptorRegistration batchInterceptor{};
+        ParallelStartService::starting = 0;
+        // the pool threads and the queue thread
+        ParallelStartService::expected = 3;
+
+        std::thread t([&]() {
+#if defined(TEST_URING)
+            REQUIRE(queue->createEventLoop());
+#elif defined(TEST_SDEVENT)
+            auto *loop = queue->createEventLoop();
+            REQUIRE(loop);
+#endif
+            queueThread = std::this_thread::get_id();
+            batchInterceptor = dm.registerGlobalEventInterceptor<ServiceBatchStartedEvent>([&](ServiceBatchStartedEvent const &) -> bool {
+                batchesStarted++;
+                bool startedOnWorker{};
+                for(auto const id : parallelIds) {
+                    auto svc = dm.getService<IUselessService>(id);
+                    REQUIRE(svc);
+                    auto const *parallel = static_cast<ParallelStartService const *>(svc.value().first);
+                    REQUIRE(svc.value().second->isStarted());
+                    REQUIRE(parallel->_allStartedTogether);
+                    startedOnWorker = startedOnWorker || parallel->_startThread != queueThread;
+                    if(parallel->_suspend) {
+                        REQUIRE(parallel->_resumedThread == queueThread);
+                    }
+                }
+                REQUIRE(startedOnWorker);
+                // the next layer only started once the parallel starts were joined back
+                REQUIRE(dm.getService<ICountService>(dependentId).value().first->isRunning());
+                REQUIRE(dm.getService<ICountService>(dependentId).value().first->getSvcCount() == 3);
+
+                dm.getEventQueue().pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&]() {
+                    batchInterceptor.reset();
+                    dm.getEventQueue().pushEvent<QuitEvent>(ServiceIdType{0});
+                });
+                return true;
+            }, [](ServiceBatchStartedEvent const &, bool) {});
+
+            dm.createServiceManager<CoutFrameworkLogger, IFrameworkLogger>();
+            auto batch = dm.createServiceBatch();
+            dependentId = batch.createServiceManager<DependencyService<IUselessService, DependencyFlags::REQUIRED | DependencyFlags::ALLOW_MULTIPLE>, ICountService>(Properties{{"ParallelStart", Ichor::v1::make_any<bool>(true)}})->getServiceId();
+            parallelIds.push_back(batch.createServiceManager<ParallelStartService, IUselessService>(Properties{{"ParallelStart", Ichor::v1::make_any<bool>(true)}})->getServiceId());
+            parallelIds.push_back(batch.createServiceManager<ParallelStartService, IUselessService>(Properties{{"ParallelStart", Ichor::v1::make_any<bool>(true)}, {"Suspend", Ichor::v1::make_any<bool>(true)}})->getServiceId());
+            parallelIds.push_back(batch.createServiceManager<ParallelStartService, IUselessService>(Properties{{"ParallelStart", Ichor::v1::make_any<bool>(true)}})->getServiceId());
+            // in the same layer, the pool starts before the services that wait on it
+            batch.createServiceManager<WorkerPoolService, IWorkerPool>(Properties{{"WorkerThreads", Ichor::v1::make_any<uint32_t>(2u)}});
+            dm.insertServiceBatch(std::move(batch));
+            queue->start(CaptureSigInt);
+#if defined(TEST_SDEVENT)
+            int r = sd_event_loop(loop);
+            REQUIRE(r >= 0);
+#endif
+        });
+
+        t.join();
+
+        REQUIRE(batchesStarted == 1);
+        REQUIRE_FALSE(dm.isRunning());
+    }
+
     SECTION("Mixing services should not cause UB") {
 #if defined(TEST_URING)
         auto queue = std::make_unique<QIMPL>(500, 100'000'000, emulateKernelVersion);
@@ -731,7 +1015,7 @@ TEST_CASE("ServicesTests") {
 
         queue->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&]() {
             DisplayServices(dm);
-#if defined(TEST_URING) || defined(TEST_SDEVENT)
+#if defined(TEST_URING) || defined(TEST_SDEVENT) || defined(TEST_EPOLL)
             REQUIRE(dm.getServiceCount() == 7);
 #else
             REQUIRE(dm.getServiceCount() == 6);
@@ -744,7 +1028,7 @@ TEST_CASE("ServicesTests") {
 
         queue->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&]() {
             DisplayServices(dm);
-#if defined(TEST_URING) || defined(TEST_SDEVENT)
+#if defined(TEST_URING) || defined(TEST_SDEVENT) || defined(TEST_EPOLL)
             REQUIRE(dm.getServiceCount() == 5);
 #else
             REQUIRE(dm.getServiceCount() == 4);
@@ -756,6 +1040,359 @@ TEST_CASE("ServicesTests") {
         t.join();
     }
 
+    SECTION("AsyncLogger writes through AsyncLogSink") {
+#if defined(TEST_URING)
+        auto queue = std::make_unique<QIMPL>(500, 100'000'000, emulateKernelVersion);
+#else
+        auto queue = std::make_unique<QIMPL>(500);
+#endif
+        auto &dm = queue->createManager();
+        auto logFile = std::filesystem::temp_directory_path() / fmt::format("ichor-async-logger-{}.txt", std::random_device{}());
+        std::filesystem::remove(logFile);
+
+        std::thread t([&]() {
+#if defined(TEST_URING)
+            REQUIRE(queue->createEventLoop());
+#elif defined(TEST_SDEVENT)
+            auto *loop = queue->createEventLoop();
+            REQUIRE(loop);
+#endif
+            dm.createServiceManager<CoutFrameworkLogger, IFrameworkLogger>();
+            // small enough that the logging below wraps around
+            dm.createServiceManager<AsyncLogSink, IAsyncLogSink>(Properties{{"LogFile", Ichor::v1::make_any<std::string>(logFile.string())}, {"RingSize", Ichor::v1::make_any<uint64_t>(4096)}, {"OverflowPolicy", Ichor::v1::make_any<AsyncLogOverflowPolicy>(AsyncLogOverflowPolicy::BLOCK)}});
+            dm.createServiceManager<LoggerFactory<AsyncLogger>, ILoggerFactory>(Properties{{"DefaultLogLevel", Ichor::v1::make_any<LogLevel>(LogLevel::LOG_INFO)}});
+            dm.createServiceManager<RequestsLoggingService, IRequestsLoggingService>();
+            queue->start(CaptureSigInt);
+#if defined(TEST_SDEVENT)
+            int r = sd_event_loop(loop);
+            REQUIRE(r >= 0);
+#endif
+        });
+
+        waitForRunning(dm);
+
+        runForOrQueueEmpty(dm);
+
+        queue->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&]() {
+            auto loggers = dm.getAllServicesOfType<ILogger>();
+            REQUIRE(loggers.size() == 1);
+            ILogger *logger = &loggers[0].first;
+
+            for(uint64_t i = 0; i < 1'000; i++) {
+                ICHOR_LOG_INFO(logger, "async line {}", i);
+            }
+            ICHOR_LOG_DEBUG(logger, "filtered");
+
+            dm.getEventQueue().pushEvent<QuitEvent>(ServiceIdType{0});
+        });
+
+        t.join();
+
+        // the sink flushes everything when stopping
+        std::ifstream in{logFile};
+        std::string line;
+        uint64_t count{};
+        while(std::getline(in, line)) {
+            REQUIRE(line.ends_with(fmt::format("async line {}", count)));
+            count++;
+        }
+        REQUIRE(count == 1'000);
+        in.close();
+        std::filesystem::remove(logFile);
+    }
+
+    SECTION("BinaryLogger records decode to formatted text") {
+#if defined(TEST_URING)
+        auto queue = std::make_unique<QIMPL>(500, 100'000'000, emulateKernelVersion);
+#else
+        auto queue = std::make_unique<QIMPL>(500);
+#endif
+        auto &dm = queue->createManager();
+        auto logFile = std::filesystem::temp_directory_path() / fmt::format("ichor-binary-logger-{}.bin", std::random_device{}());
+        std::filesystem::remove(logFile);
+
+        std::thread t([&]() {
+#if defined(TEST_URING)
+            REQUIRE(queue->createEventLoop());
+#elif defined(TEST_SDEVENT)
+            auto *loop = queue->createEventLoop();
+            REQUIRE(loop);
+#endif
+            dm.createServiceManager<CoutFrameworkLogger, IFrameworkLogger>();
+            dm.createServiceManager<AsyncLogSink, IAsyncLogSink>(Properties{{"LogFile", Ichor::v1::make_any<std::string>(logFile.string())}, {"OverflowPolicy", Ichor::v1::make_any<AsyncLogOverflowPolicy>(AsyncLogOverflowPolicy::BLOCK)}, {"ReportDrops", Ichor::v1::make_any<bool>(false)}});
+            dm.createServiceManager<LoggerFactory<BinaryLogger>, ILoggerFactory>(Properties{{"DefaultLogLevel", Ichor::v1::make_any<LogLevel>(LogLevel::LOG_DEBUG)}});
+            dm.createServiceManager<RequestsLoggingService, IRequestsLoggingService>();
+            queue->start(CaptureSigInt);
+#if defined(TEST_SDEVENT)
+            int r = sd_event_loop(loop);
+            REQUIRE(r >= 0);
+#endif
+        });
+
+        waitForRunning(dm);
+
+        runForOrQueueEmpty(dm);
+
+        queue->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&]() {
+            auto loggers = dm.getAllServicesOfType<ILogger>();
+            REQUIRE(loggers.size() == 1);
+            ILogger *logger = &loggers[0].first;
+
+            std::string str{"string"};
+            ICHOR_LOG_DEBUG(logger, "{} {} {} {} {:.2f} {} {}", -5, 5u, true, 'c', 1.234, "c-string", str);
+            // LogLevel has a user defined formatter, formatted on the logging thread
+            ICHOR_LOG_ERROR(logger, "level {} {:>4}", LogLevel::LOG_INFO, 7);
+            ICHOR_LOG_TRACE(logger, "filtered");
+
+            dm.getEventQueue().pushEvent<QuitEvent>(ServiceIdType{0});
+        });
+
+        t.join();
+
+        std::ifstream in{logFile, std::ios::binary};
+        std::string contents{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+        in.close();
+        std::filesystem::remove(logFile);
+
+        std::vector<DecodedLogRecord> records;
+        // leave off the last byte, the partial record should be left for later
+        auto ret = decodeBinaryLog(std::span<char const>{contents.data(), contents.size() - 1}, [&](DecodedLogRecord const &record) {
+            records.push_back(record);
+        });
+        REQUIRE(ret);
+        REQUIRE(records.size() == 1);
+        REQUIRE(*ret < contents.size());
+
+        ret = decodeBinaryLog(std::span<char const>{contents.data() + *ret, contents.size() - *ret}, [&](DecodedLogRecord const &record) {
+            records.push_back(record);
+        });
+        REQUIRE(ret);
+        REQUIRE(records.size() == 2);
+        REQUIRE(records[0].message == "-5 5 true c 1.23 c-string string");
+        REQUIRE(records[0].level == LogLevel::LOG_DEBUG);
+        REQUIRE(records[1].message == "level LOG_INFO    7");
+        REQUIRE(records[1].level == LogLevel::LOG_ERROR);
+#ifndef ICHOR_REMOVE_SOURCE_NAMES_FROM_LOGGING
+        REQUIRE(records[0].filename == "ServicesTests.cpp");
+        REQUIRE(records[1].line == records[0].line + 2);
+#endif
+        REQUIRE(records[0].timestampNs <= records[1].timestampNs);
+    }
+
+    SECTION("MetricsRegistryService aggregates over managers") {
+        std::array<std::unique_ptr<QIMPL>, 2> queues{};
+        std::array<std::thread, 2> threads{};
+        std::array<DependencyManager*, 2> dms{};
+        std::atomic<uint64_t> running{};
+
+        for(size_t i = 0; i < queues.size(); i++) {
+#if defined(TEST_URING)
+            queues[i] = std::make_unique<QIMPL>(500, 100'000'000, emulateKernelVersion);
+#else
+            queues[i] = std::make_unique<QIMPL>(500);
+#endif
+            dms[i] = &queues[i]->createManager();
+            threads[i] = std::thread([&, i]() {
+#if defined(TEST_URING)
+                REQUIRE(queues[i]->createEventLoop());
+#elif defined(TEST_SDEVENT)
+                auto *loop = queues[i]->createEventLoop();
+                REQUIRE(loop);
+#endif
+                dms[i]->createServiceManager<CoutFrameworkLogger, IFrameworkLogger>();
+                dms[i]->createServiceManager<TFFIMPL>();
+                dms[i]->createServiceManager<MetricsRegistryService, IMetricsRegistry>();
+                queues[i]->start(CaptureSigInt);
+#if defined(TEST_SDEVENT)
+                int r = sd_event_loop(loop);
+                REQUIRE(r >= 0);
+#endif
+            });
+        }
+
+        for(size_t i = 0; i < queues.size(); i++) {
+            waitForRunning(*dms[i]);
+            runForOrQueueEmpty(*dms[i]);
+
+            queues[i]->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&, i]() {
+                auto registries = dms[i]->getAllServicesOfType<IMetricsRegistry>();
+                REQUIRE(registries.size() == 1);
+                auto &registry = registries[0].first;
+
+                std::array<MetricLabel, 1> labels{MetricLabel{"kind", "a\"b"}};
+                registry.counter("test_requests_total", "Requests", labels).inc(i + 1);
+                registry.gauge("test_in_flight", "In flight").set(5);
+                auto &histogram = registry.histogram("test_latency_ns", "Latency", DEFAULT_LATENCY_BOUNDS_NS);
+                histogram.record(500);
+                histogram.record(20'000'000'000);
+                running++;
+            });
+        }
+
+        while(running != queues.size()) {
+            std::this_thread::sleep_for(1ms);
+        }
+
+        auto text = formatMetricsText();
+        REQUIRE(text.contains("# TYPE test_requests_total counter\ntest_requests_total{kind=\"a\\\"b\"} 3\n"));
+        REQUIRE(text.contains("test_in_flight 10\n"));
+        REQUIRE(text.contains("# TYPE test_latency_ns histogram\n"));
+        REQUIRE(text.contains("test_latency_ns_bucket{le=\"1000\"} 2\n"));
+        REQUIRE(text.contains("test_latency_ns_bucket{le=\"10000000000\"} 2\n"));
+        REQUIRE(text.contains("test_latency_ns_bucket{le=\"+Inf\"} 4\n"));
+        REQUIRE(text.contains("test_latency_ns_sum 40000001000\ntest_latency_ns_count 4\n"));
+        REQUIRE(text.contains("ichor_services{state=\"active\"} "));
+        REQUIRE(text.contains(fmt::format("ichor_events_total{{type=\"{}\"}} ", RunFunctionEvent::NAME)));
+        REQUIRE(text.contains("process_resident_memory_bytes "));
+
+        for(size_t i = 0; i < queues.size(); i++) {
+            queues[i]->pushEvent<QuitEvent>(ServiceIdType{0});
+            threads[i].join();
+        }
+
+        // stopped registries are no longer scraped
+        REQUIRE(!formatMetricsText().contains("test_requests_total"));
+    }
+
+    SECTION("Event tracing records spans and exports Chrome trace") {
+        {
+            EventTraceRing ring{1, 3};
+            REQUIRE(ring.getCapacity() == 4);
+            for(uint64_t i = 0; i < 6; i++) {
+                ring.record(TraceSpanKind::EVENT, "evt", "svc", ServiceIdType{i}, i, i * 10, i * 10 + 5);
+            }
+            auto spans = ring.snapshot();
+            REQUIRE(spans.size() == 4);
+            for(uint64_t i = 0; i < spans.size(); i++) {
+                REQUIRE(spans[i].eventId == i + 2);
+                REQUIRE(spans[i].startNs == (i + 2) * 10);
+                REQUIRE(spans[i].durationNs == 5);
+                REQUIRE(spans[i].eventName == "evt");
+                REQUIRE(spans[i].serviceName == "svc");
+            }
+        }
+
+        auto queue = std::make_unique<QIMPL>(500);
+        auto &dm = queue->createManager();
+        _evt = std::make_unique<AsyncManualResetEvent>();
+        std::thread t([&]() {
+#if defined(TEST_URING)
+            REQUIRE(queue->createEventLoop());
+#elif defined(TEST_SDEVENT)
+            auto *loop = queue->createEventLoop();
+            REQUIRE(loop);
+#endif
+            dm.createServiceManager<AsyncBroadcastService, IAsyncBroadcastService>();
+            dm.createServiceManager<AsyncBroadcastService, IAsyncBroadcastService>();
+            queue->start(CaptureSigInt);
+#if defined(TEST_SDEVENT)
+            int r = sd_event_loop(loop);
+            REQUIRE(r >= 0);
+#endif
+        });
+
+        waitForRunning(dm);
+
+        runForOrQueueEmpty(dm);
+
+        queue->pushEvent<RunFunctionEventAsync>(ServiceIdType{0}, [&]() -> AsyncGenerator<IchorBehaviour> {
+            dm.enableEventTracing(1'024);
+            auto services = dm.getStartedServices<IAsyncBroadcastService>();
+            REQUIRE(services.size() == 2);
+            co_await services[0]->postEvent();
+            co_return {};
+        });
+
+        runForOrQueueEmpty(dm);
+
+        queue->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&]() {
+            _evt->set();
+        });
+
+        runForOrQueueEmpty(dm);
+
+        auto trace = exportChromeTrace();
+        REQUIRE(trace.starts_with("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+        REQUIRE(trace.ends_with("]}"));
+        REQUIRE(trace.contains(fmt::format("\"args\":{{\"name\":\"DepMan#{}\"}}", dm.getId())));
+        REQUIRE(trace.contains(fmt::format("{{\"name\":\"{}\",\"cat\":\"event\"", RunFunctionEvent::NAME)));
+        REQUIRE(trace.contains(fmt::format("{{\"name\":\"{}\",\"cat\":\"callback\"", typeName<AsyncBroadcastService>())));
+        REQUIRE(trace.contains(fmt::format("{{\"name\":\"{}\",\"cat\":\"coroutine\"", typeName<AsyncBroadcastService>())));
+
+        queue->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&]() {
+            dm.disableEventTracing();
+            dm.getEventQueue().pushEvent<QuitEvent>(ServiceIdType{0});
+        });
+
+        t.join();
+
+        REQUIRE(exportChromeTrace() == "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[]}");
+    }
+
+#ifdef ICHOR_ENABLE_QUEUE_STATISTICS
+    SECTION("Queue statistics record queue wait and processing per priority band") {
+        static_assert(priorityBand(INTERNAL_INSERT_SERVICE_EVENT_PRIORITY) == QueuePriorityBand::INTERNAL);
+        static_assert(priorityBand(INTERNAL_DEPENDENCY_EVENT_PRIORITY) == QueuePriorityBand::INTERNAL);
+        static_assert(priorityBand(INTERNAL_DEPENDENCY_EVENT_PRIORITY + 1) == QueuePriorityBand::HIGH);
+        static_assert(priorityBand(INTERNAL_EVENT_PRIORITY) == QueuePriorityBand::DEFAULT);
+        static_assert(priorityBand(INTERNAL_EVENT_PRIORITY + 1) == QueuePriorityBand::LOW);
+
+        auto queue = std::make_unique<QIMPL>(500);
+        auto &dm = queue->createManager();
+        std::vector<uint64_t> lateEvents;
+        queue->setQueueWaitAlarm(std::chrono::milliseconds(5), [&](Event const &evt, std::chrono::nanoseconds waited) {
+            REQUIRE(waited > std::chrono::milliseconds(5));
+            lateEvents.push_back(evt.id);
+        });
+
+        std::thread t([&]() {
+#if defined(TEST_URING)
+            REQUIRE(queue->createEventLoop());
+#elif defined(TEST_SDEVENT)
+            auto *loop = queue->createEventLoop();
+            REQUIRE(loop);
+#endif
+            queue->start(CaptureSigInt);
+#if defined(TEST_SDEVENT)
+            int r = sd_event_loop(loop);
+            REQUIRE(r >= 0);
+#endif
+        });
+
+        waitForRunning(dm);
+
+        runForOrQueueEmpty(dm);
+
+        queue->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&]() {
+            queue->resetStatistics();
+            lateEvents.clear();
+        });
+        // the second event waits on the first one
+        queue->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        });
+        auto lateEventId = queue->pushPrioritisedEvent<RunFunctionEvent>(ServiceIdType{0}, INTERNAL_EVENT_PRIORITY + 1, [&]() {});
+
+        runForOrQueueEmpty(dm);
+
+        queue->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&]() {
+            auto const &stats = queue->getStatistics();
+            REQUIRE(stats.processing(QueuePriorityBand::DEFAULT).count() == 2);
+            REQUIRE(stats.processing(QueuePriorityBand::DEFAULT).max() >= 10'000'000);
+            REQUIRE(stats.queueWait(QueuePriorityBand::DEFAULT).count() == 2);
+            REQUIRE(stats.queueWait(QueuePriorityBand::LOW).count() == 1);
+            REQUIRE(stats.queueWait(QueuePriorityBand::LOW).max() >= 5'000'000);
+            REQUIRE(stats.processing(QueuePriorityBand::LOW).count() == 1);
+            REQUIRE(stats.queueWait(QueuePriorityBand::HIGH).count() == 0);
+            REQUIRE(stats.queueWaitAlarms == lateEvents.size());
+            REQUIRE(std::find(lateEvents.begin(), lateEvents.end(), lateEventId) != lateEvents.end());
+            dm.getEventQueue().pushEvent<QuitEvent>(ServiceIdType{0});
+        });
+
+        t.join();
+    }
+#endif
+
     SECTION("ConstructorInjectionService basic test") {
 #if defined(TEST_URING)
         auto queue = std::make_unique<QIMPL>(500, 100'000'000, emulateKernelVersion);
@@ -793,7 +1430,7 @@ TEST_CASE("ServicesTests") {
             DisplayServices(dm);
 
             DisplayServices(dm);
-#if defined(TEST_URING) || defined(TEST_SDEVENT)
+#if defined(TEST_URING) || defined(TEST_SDEVENT) || defined(TEST_EPOLL)
             REQUIRE(dm.getServiceCount() == 8);
 #else
             REQUIRE(dm.getServiceCount() == 7);
@@ -815,7 +1452,7 @@ TEST_CASE("ServicesTests") {
         queue->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&]() {
             DisplayServices(dm);
             DisplayServices(dm);
-#if defined(TEST_URING) || defined(TEST_SDEVENT)
+#if defined(TEST_URING) || defined(TEST_SDEVENT) || defined(TEST_EPOLL)
             REQUIRE(dm.getServiceCount() == 6);
 #else
             REQUIRE(dm.getServiceCount() == 5);
@@ -951,7 +1588,7 @@ TEST_CASE("ServicesTests") {
 
         queue->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&]() {
             DisplayServices(dm);
-#if defined(TEST_URING) || defined(TEST_SDEVENT)
+#if defined(TEST_URING) || defined(TEST_SDEVENT) || defined(TEST_EPOLL)
             REQUIRE(dm.getServiceCount() == 4);
 #else
             REQUIRE(dm.getServiceCount() == 3);
@@ -995,7 +1632,7 @@ TEST_CASE("ServicesTests") {
 
         queue->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&]() {
             DisplayServices(dm);
-#if defined(TEST_URING) || defined(TEST_SDEVENT)
+#if defined(TEST_URING) || defined(TEST_SDEVENT) || defined(TEST_EPOLL)
             REQUIRE(dm.getServiceCount() == 8);
 #else
             REQUIRE(dm.getServiceCount() == 7);
@@ -1014,7 +1651,7 @@ TEST_CASE("ServicesTests") {
 
         queue->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&]() {
             DisplayServices(dm);
-#if defined(TEST_URING) || defined(TEST_SDEVENT)
+#if defined(TEST_URING) || defined(TEST_SDEVENT) || defined(TEST_EPOLL)
             REQUIRE(dm.getServiceCount() == 5);
 #else
             REQUIRE(dm.getServiceCount() == 4);
@@ -1031,7 +1668,7 @@ TEST_CASE("ServicesTests") {
         queue->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&]() {
             DisplayServices(dm);
             DisplayServices(dm);
-#if defined(TEST_URING) || defined(TEST_SDEVENT)
+#if defined(TEST_URING) || defined(TEST_SDEVENT) || defined(TEST_EPOLL)
             REQUIRE(dm.getServiceCount() == 4);
 #else
             REQUIRE(dm.getServiceCount() == 3);
@@ -1048,7 +1685,7 @@ TEST_CASE("ServicesTests") {
         queue->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&]() {
             DisplayServices(dm);
             DisplayServices(dm);
-#if defined(TEST_URING) || defined(TEST_SDEVENT)
+#if defined(TEST_URING) || defined(TEST_SDEVENT) || defined(TEST_EPOLL)
             REQUIRE(dm.getServiceCount() == 6);
 #else
             REQUIRE(dm.getServiceCount() == 5);
@@ -1094,7 +1731,7 @@ TEST_CASE("ServicesTests") {
 
         queue->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&]() {
             DisplayServices(dm);
-#if defined(TEST_URING) || defined(TEST_SDEVENT)
+#if defined(TEST_URING) || defined(TEST_SDEVENT) || defined(TEST_EPOLL)
             REQUIRE(dm.getServiceCount() == 6);
 #else
             REQUIRE(dm.getServiceCount() == 5);
@@ -1112,7 +1749,7 @@ TEST_CASE("ServicesTests") {
 
         queue->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&]() {
             DisplayServices(dm);
-#if defined(TEST_URING) || defined(TEST_SDEVENT)
+#if defined(TEST_URING) || defined(TEST_SDEVENT) || defined(TEST_EPOLL)
             REQUIRE(dm.getServiceCount() == 8);
 #else
             REQUIRE(dm.getServiceCount() == 7);
@@ -1132,7 +1769,7 @@ TEST_CASE("ServicesTests") {
 
         queue->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&]() {
             DisplayServices(dm);
-#if defined(TEST_URING) || defined(TEST_SDEVENT)
+#if defined(TEST_URING) || defined(TEST_SDEVENT) || defined(TEST_EPOLL)
             REQUIRE(dm.getServiceCount() == 7);
 #else
             REQUIRE(dm.getServiceCount() == 6);
@@ -1148,7 +1785,7 @@ TEST_CASE("ServicesTests") {
 
         queue->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&]() {
             DisplayServices(dm);
-#if defined(TEST_URING) || defined(TEST_SDEVENT)
+#if defined(TEST_URING) || defined(TEST_SDEVENT) || defined(TEST_EPOLL)
             REQUIRE(dm.getServiceCount() == 5);
 #else
             REQUIRE(dm.getServiceCount() == 4);
@@ -1165,7 +1802,7 @@ TEST_CASE("ServicesTests") {
         queue->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&]() {
             DisplayServices(dm);
             DisplayServices(dm);
-#if defined(TEST_URING) || defined(TEST_SDEVENT)
+#if defined(TEST_URING) || defined(TEST_SDEVENT) || defined(TEST_EPOLL)
             REQUIRE(dm.getServiceCount() == 4);
 #else
             REQUIRE(dm.getServiceCount() == 3);
@@ -1182,7 +1819,7 @@ TEST_CASE("ServicesTests") {
         queue->pushEvent<RunFunctionEvent>(ServiceIdType{0}, [&]() {
             DisplayServices(dm);
             DisplayServices(dm);
-#if defined(TEST_URING) || defined(TEST_SDEVENT)
+#if defined(TEST_URING) || defined(TEST_SDEVENT) || defined(TEST_EPOLL)
             REQUIRE(dm.getServiceCount() == 6);
 #else
             REQUIRE(dm.getServiceCount() == 5);
@@ -3,11 +3,14 @@
 #include <ichor/stl/RealtimeReadWriteMutex.h>
 #include <ichor/stl/NeverAlwaysNull.h>
 #include <ichor/stl/ReferenceCountedPointer.h>
+#include <ichor/stl/AtomicReferenceCountedPointer.h>
 #include <ichor/stl/StringUtils.h>
 #include <ichor/stl/StaticVector.h>
 #include <ichor/stl/SectionalPriorityQueue.h>
 #include <ichor/stl/StrongTypedef.h>
 #include <ichor/stl/Spans.h>
+#include <ichor/Properties.h>
+#include <array>
 #include <memory>
 #include <string_view>
 #include "TestServices/UselessService.h"
@@ -497,6 +500,63 @@ TEST_CASE("STL Tests") {
         }
     }
 
+    SECTION("AtomicReferenceCountedPointer tests") {
+        {
+            AtomicReferenceCountedPointer<int> i;
+            REQUIRE(i.use_count() == 0);
+            REQUIRE(!i.has_value());
+            i = Ichor::v1::make_atomic_reference_counted<int>(5);
+            REQUIRE(i.use_count() == 1);
+            REQUIRE(*i == 5);
+            AtomicReferenceCountedPointer<int> i2{i};
+            REQUIRE(i.use_count() == 2);
+            REQUIRE(i2 == i);
+            i = nullptr;
+            REQUIRE(i2.use_count() == 1);
+            REQUIRE(*i2 == 5);
+        }
+        {
+            auto def = Ichor::v1::make_atomic_reference_counted<std::string>();
+            REQUIRE(def.has_value());
+            REQUIRE(def->empty());
+        }
+        {
+            AtomicReferenceCountedPointer<parent_test_class const> tc = Ichor::v1::make_atomic_reference_counted<rc_test_class>(5, 5.0f, noncopyable{});
+            REQUIRE(tc.use_count() == 1);
+            AtomicReferenceCountedPointer<parent_test_class const> tc2;
+            tc2 = tc;
+            REQUIRE(tc.use_count() == 2);
+            AtomicReferenceCountedPointer<parent_test_class const> tc3{std::move(tc2)};
+            REQUIRE(!tc2.has_value());
+            REQUIRE(tc.use_count() == 2);
+        }
+        {
+            std::atomic<uint64_t> destroyed{};
+            struct counted final {
+                explicit counted(std::atomic<uint64_t> &_destroyed) noexcept : destroyed(_destroyed) {}
+                ~counted() { destroyed++; }
+                std::atomic<uint64_t> &destroyed;
+            };
+            auto shared = Ichor::v1::make_atomic_reference_counted<counted const>(destroyed);
+            std::array<std::thread, 4> threads{};
+            for(auto &t : threads) {
+                t = std::thread([copy = shared]() mutable {
+                    for(uint32_t i = 0; i < 10'000; i++) {
+                        AtomicReferenceCountedPointer<counted const> local{copy};
+                        copy = local;
+                    }
+                });
+            }
+            for(auto &t : threads) {
+                t.join();
+            }
+            REQUIRE(shared.use_count() == 1);
+            REQUIRE(destroyed == 0);
+            shared = nullptr;
+            REQUIRE(destroyed == 1);
+        }
+    }
+
     SECTION("FastAtoi(u) tests") {
         REQUIRE(Ichor::v1::FastAtoiu("10") == 10);
         REQUIRE(Ichor::v1::FastAtoiu("0") == 0);
@@ -1646,6 +1706,59 @@ TEST_CASE("STL Tests") {
 
     }
 
+    SECTION("Properties") {
+        static constexpr PropertyKey<uint16_t> Port{"Port"};
+        static constexpr PropertyKey<std::string> Address{"Address"};
+        static_assert(PropertyName{"Port"}.hash() == propertyNameHash("Port"));
+
+        Properties props{{"Port", Ichor::v1::make_any<uint16_t>(static_cast<uint16_t>(8001))}, {"Port", Ichor::v1::make_any<uint16_t>(static_cast<uint16_t>(8002))}};
+        REQUIRE(props.size() == 1);
+        REQUIRE(props.get(Port) != nullptr);
+        REQUIRE(*props.get(Port) == 8001);
+        REQUIRE(props.get(Address) == nullptr);
+
+        // type mismatches are not found by typed keys, but are by names
+        props.emplace("Address", Ichor::v1::make_any<int>(1));
+        REQUIRE(props.get(Address) == nullptr);
+        REQUIRE(props.contains(Address));
+        REQUIRE(props.set(Address, "localhost") == "localhost");
+        REQUIRE(*props.get(Address) == "localhost");
+        REQUIRE(props.size() == 2);
+
+        // keys built from runtime strings are copied on insertion
+        {
+            std::string name{"Runtime"};
+            props.emplace(name, Ichor::v1::make_any<uint64_t>(5u));
+            name = "Overwritten";
+        }
+        REQUIRE(props.contains("Runtime"));
+        REQUIRE(props.find("Runtime")->first.name() == "Runtime"sv);
+        REQUIRE(props.size() == 3);
+
+        Properties copy{props};
+        Properties moved{std::move(props)};
+        REQUIRE(props.empty());
+        REQUIRE(copy.size() == 3);
+        REQUIRE(moved.size() == 3);
+        REQUIRE(*moved.get(Address) == "localhost");
+
+        REQUIRE(copy.erase("Port") == 1);
+        REQUIRE(copy.erase("Port") == 0);
+        REQUIRE(copy.size() == 2);
+        REQUIRE(*copy.get(Address) == "localhost");
+        REQUIRE(Ichor::v1::any_cast<uint64_t>(copy["Runtime"]) == 5);
+        REQUIRE(*moved.get(Port) == 8001);
+
+        Properties small{};
+        small.set(Port, static_cast<uint16_t>(1));
+        moved = std::move(small);
+        REQUIRE(moved.size() == 1);
+        REQUIRE(*moved.get(Port) == 1);
+        moved = copy;
+        REQUIRE(moved.size() == 2);
+        REQUIRE(moved.get(Port) == nullptr);
+    }
+
     static_assert(std::random_access_iterator<VectorView<int>::iterator>, "VectorView iterator not random access");
     static_assert(std::random_access_iterator<VectorView<sufficiently_non_trivial>::iterator>, "VectorView iterator not random access");
 }
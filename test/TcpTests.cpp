@@ -14,6 +14,7 @@ std::atomic<uint64_t> evtGate;
 #ifdef TEST_URING
 #include <ichor/services/network/tcp/IOUringTcpConnectionService.h>
 #include <ichor/services/network/tcp/IOUringTcpHostService.h>
+#include <ichor/services/network/IBroadcastService.h>
 #include <ichor/event_queues/IOUringQueue.h>
 #include <ichor/stl/LinuxUtils.h>
 #include <catch2/generators/catch_generators.hpp>
@@ -21,6 +22,16 @@ std::atomic<uint64_t> evtGate;
 #define QIMPL IOUringQueue
 #define CONNIMPL IOUringTcpConnectionService
 #define HOSTIMPL IOUringTcpHostService
+#elif defined(TEST_EPOLL)
+#include <ichor/services/timer/EpollTimerFactoryFactory.h>
+#include <ichor/services/network/tcp/TcpConnectionService.h>
+#include <ichor/services/network/tcp/TcpHostService.h>
+#include <ichor/event_queues/EpollQueue.h>
+
+#define QIMPL EpollQueue
+#define TFFIMPL EpollTimerFactoryFactory
+#define CONNIMPL TcpConnectionService
+#define HOSTIMPL TcpHostService
 #else
 #include <ichor/services/timer/TimerFactoryFactory.h>
 #include <ichor/services/network/tcp/TcpConnectionService.h>
@@ -28,6 +39,7 @@ std::atomic<uint64_t> evtGate;
 #include <ichor/event_queues/PriorityQueue.h>
 
 #define QIMPL PriorityQueue
+#define TFFIMPL TimerFactoryFactory
 #define CONNIMPL TcpConnectionService
 #define HOSTIMPL TcpHostService
 #endif
@@ -55,6 +67,8 @@ TEST_CASE("TcpTests_uring") {
         fmt::println("kernel version {}", *version);
     }
 
+#elif defined(TEST_EPOLL)
+TEST_CASE("TcpTests_epoll") {
 #else
 TEST_CASE("TcpTests") {
 #endif
@@ -62,6 +76,8 @@ TEST_CASE("TcpTests") {
         _evt = std::make_unique<Ichor::AsyncManualResetEvent>();
 #if defined(TEST_URING)
         auto queue = std::make_unique<QIMPL>(500, 100'000'000, emulateKernelVersion);
+#elif defined(TEST_EPOLL)
+        auto queue = std::make_unique<QIMPL>(500);
 #else
         auto queue = std::make_unique<QIMPL>(500, true);
 #endif
@@ -79,7 +95,7 @@ TEST_CASE("TcpTests") {
             dm.createServiceManager<HOSTIMPL, IHostService>(Properties{{"Address", Ichor::v1::make_any<std::string>("127.0.0.1"s)}, {"Port", Ichor::v1::make_any<uint16_t>(static_cast<uint16_t>(8001))}}, priorityToEnsureHostStartingFirst);
             dm.createServiceManager<ClientFactory<CONNIMPL<IClientConnectionService>>, IClientFactory<IConnectionService>>();
 #ifndef TEST_URING
-            dm.createServiceManager<TimerFactoryFactory>(Properties{}, priorityToEnsureHostStartingFirst);
+            dm.createServiceManager<TFFIMPL>(Properties{}, priorityToEnsureHostStartingFirst);
 #endif
             tcpClientId = dm.createServiceManager<TcpService, ITcpService>(Properties{{"Address", Ichor::v1::make_any<std::string>("127.0.0.1"s)}, {"Port", Ichor::v1::make_any<uint16_t>(static_cast<uint16_t>(8001))}})->getServiceId();
 
@@ -157,7 +173,7 @@ TEST_CASE("TcpTests") {
             dm.createServiceManager<HOSTIMPL, IHostService>(Properties{{"Address", Ichor::v1::make_any<std::string>("127.0.0.1"s)}, {"Port", Ichor::v1::make_any<uint16_t>(static_cast<uint16_t>(8001))}, {"BufferEntries", Ichor::v1::make_any<uint32_t>(static_cast<uint16_t>(16))}, {"BufferEntrySize", Ichor::v1::make_any<uint32_t>(static_cast<uint16_t>(16'384))}}, priorityToEnsureHostStartingFirst);
             dm.createServiceManager<ClientFactory<CONNIMPL<IClientConnectionService>>, IClientFactory<IConnectionService>>();
 #ifndef TEST_URING
-            dm.createServiceManager<TimerFactoryFactory>(Properties{}, priorityToEnsureHostStartingFirst);
+            dm.createServiceManager<TFFIMPL>(Properties{}, priorityToEnsureHostStartingFirst);
 #endif
             tcpClientId = dm.createServiceManager<TcpService, ITcpService>(Properties{{"Address", Ichor::v1::make_any<std::string>("127.0.0.1"s)}, {"Port", Ichor::v1::make_any<uint16_t>(static_cast<uint16_t>(8001))}})->getServiceId();
 
@@ -233,7 +249,7 @@ TEST_CASE("TcpTests") {
             dm.createServiceManager<HOSTIMPL, IHostService>(Properties{{"Address", Ichor::v1::make_any<std::string>("127.0.0.1"s)}, {"Port", Ichor::v1::make_any<uint16_t>(static_cast<uint16_t>(8001))}}, priorityToEnsureHostStartingFirst);
             dm.createServiceManager<ClientFactory<CONNIMPL<IClientConnectionService>>, IClientFactory<IConnectionService>>();
 #ifndef TEST_URING
-            dm.createServiceManager<TimerFactoryFactory>(Properties{}, priorityToEnsureHostStartingFirst);
+            dm.createServiceManager<TFFIMPL>(Properties{}, priorityToEnsureHostStartingFirst);
 #endif
             tcpClientId = dm.createServiceManager<TcpService, ITcpService>(Properties{{"Address", Ichor::v1::make_any<std::string>("127.0.0.1"s)}, {"Port", Ichor::v1::make_any<uint16_t>(static_cast<uint16_t>(8001))}})->getServiceId();
 
@@ -320,7 +336,7 @@ TEST_CASE("TcpTests") {
             dm.createServiceManager<HOSTIMPL, IHostService>(Properties{{"Address", Ichor::v1::make_any<std::string>("127.0.0.1"s)}, {"Port", Ichor::v1::make_any<uint16_t>(static_cast<uint16_t>(8001))}}, priorityToEnsureHostStartingFirst);
             dm.createServiceManager<ClientFactory<CONNIMPL<IClientConnectionService>>, IClientFactory<IConnectionService>>();
 #ifndef TEST_URING
-            dm.createServiceManager<TimerFactoryFactory>(Properties{}, priorityToEnsureHostStartingFirst);
+            dm.createServiceManager<TFFIMPL>(Properties{}, priorityToEnsureHostStartingFirst);
 #endif
             tcpClientId = dm.createServiceManager<TcpService, ITcpService>(Properties{{"Address", Ichor::v1::make_any<std::string>("127.0.0.1"s)}, {"Port", Ichor::v1::make_any<uint16_t>(static_cast<uint16_t>(8001))}})->getServiceId();
 
@@ -396,7 +412,7 @@ TEST_CASE("TcpTests") {
             dm.createServiceManager<HOSTIMPL, IHostService>(Properties{{"Address", Ichor::v1::make_any<std::string>("127.0.0.1"s)}, {"Port", Ichor::v1::make_any<uint16_t>(static_cast<uint16_t>(8001))}, {"BufferEntries", Ichor::v1::make_any<uint32_t>(static_cast<uint16_t>(512))}, {"BufferEntrySize", Ichor::v1::make_any<uint32_t>(static_cast<uint16_t>(32))}}, priorityToEnsureHostStartingFirst);
             dm.createServiceManager<ClientFactory<CONNIMPL<IClientConnectionService>>, IClientFactory<IConnectionService>>();
 #ifndef TEST_URING
-            dm.createServiceManager<TimerFactoryFactory>(Properties{}, priorityToEnsureHostStartingFirst);
+            dm.createServiceManager<TFFIMPL>(Properties{}, priorityToEnsureHostStartingFirst);
 #endif
             tcpClientId = dm.createServiceManager<TcpService, ITcpService>(Properties{{"Address", Ichor::v1::make_any<std::string>("127.0.0.1"s)}, {"Port", Ichor::v1::make_any<uint16_t>(static_cast<uint16_t>(8001))}})->getServiceId();
 
@@ -479,7 +495,7 @@ TEST_CASE("TcpTests") {
             dm.createServiceManager<HOSTIMPL, IHostService>(Properties{{"Address", Ichor::v1::make_any<std::string>("127.0.0.1"s)}, {"Port", Ichor::v1::make_any<uint16_t>(static_cast<uint16_t>(8001))}}, priorityToEnsureHostStartingFirst);
             dm.createServiceManager<ClientFactory<CONNIMPL<IClientConnectionService>>, IClientFactory<IConnectionService>>();
 #ifndef TEST_URING
-            dm.createServiceManager<TimerFactoryFactory>(Properties{}, priorityToEnsureHostStartingFirst);
+            dm.createServiceManager<TFFIMPL>(Properties{}, priorityToEnsureHostStartingFirst);
 #endif
             tcpClientId = dm.createServiceManager<TcpService, ITcpService>(Properties{{"Address", Ichor::v1::make_any<std::string>("127.0.0.1"s)}, {"Port", Ichor::v1::make_any<uint16_t>(static_cast<uint16_t>(8001))}})->getServiceId();
 
@@ -524,4 +540,72 @@ TEST_CASE("TcpTests") {
 
         t.join();
     }
+
+#ifdef TEST_URING
+    SECTION("Broadcast message") {
+        _evt = std::make_unique<Ichor::AsyncManualResetEvent>();
+        auto queue = std::make_unique<QIMPL>(true);
+        ServiceIdType tcpClientId;
+        ServiceIdType hostId;
+        evtGate = 0;
+
+        std::thread t([&]() {
+            REQUIRE(queue->createEventLoop());
+            auto &dm = queue->createManager();
+            uint64_t priorityToEnsureHostStartingFirst = 51;
+            dm.createServiceManager<CoutFrameworkLogger, IFrameworkLogger>(Properties{{"DefaultLogLevel", Ichor::v1::make_any<LogLevel>(LogLevel::LOG_TRACE)}}, priorityToEnsureHostStartingFirst);
+            dm.createServiceManager<LoggerFactory<CoutLogger>, ILoggerFactory>(Properties{{"DefaultLogLevel", Ichor::v1::make_any<LogLevel>(LogLevel::LOG_TRACE)}}, priorityToEnsureHostStartingFirst);
+            hostId = dm.createServiceManager<HOSTIMPL, IHostService, IBroadcastService>(Properties{{"Address", Ichor::v1::make_any<std::string>("127.0.0.1"s)}, {"Port", Ichor::v1::make_any<uint16_t>(static_cast<uint16_t>(8001))}}, priorityToEnsureHostStartingFirst)->getServiceId();
+            dm.createServiceManager<ClientFactory<CONNIMPL<IClientConnectionService>>, IClientFactory<IConnectionService>>();
+            tcpClientId = dm.createServiceManager<TcpService, ITcpService>(Properties{{"Address", Ichor::v1::make_any<std::string>("127.0.0.1"s)}, {"Port", Ichor::v1::make_any<uint16_t>(static_cast<uint16_t>(8001))}})->getServiceId();
+
+            queue->start(CaptureSigInt);
+        });
+
+        auto start = std::chrono::steady_clock::now();
+        while(evtGate.load(std::memory_order_acquire) != 1) {
+            std::this_thread::sleep_for(500us);
+            auto now = std::chrono::steady_clock::now();
+            REQUIRE(now - start < 1s);
+        }
+
+        evtGate.store(0, std::memory_order_release);
+
+        queue->pushEvent<RunFunctionEventAsync>(ServiceIdType{0}, [&]() -> AsyncGenerator<IchorBehaviour> {
+            auto &dm = GetThreadLocalManager();
+            auto host = dm.getService<IBroadcastService>(hostId);
+            REQUIRE(host);
+            std::string_view str = "This is a broadcast\n";
+            auto ret = co_await (*host).first->broadcastAsync(std::make_shared<std::vector<uint8_t> const>(str.begin(), str.end()));
+            REQUIRE(ret);
+            REQUIRE(*ret == 1);
+            co_return {};
+        });
+
+        start = std::chrono::steady_clock::now();
+        while(evtGate.load(std::memory_order_acquire) != 1) {
+            std::this_thread::sleep_for(500us);
+            auto now = std::chrono::steady_clock::now();
+            REQUIRE(now - start < 1s);
+        }
+
+        evtGate.store(0, std::memory_order_release);
+
+        queue->pushEvent<RunFunctionEventAsync>(ServiceIdType{0}, [&]() -> AsyncGenerator<IchorBehaviour> {
+            auto &dm = GetThreadLocalManager();
+            auto svc = dm.getService<ITcpService>(tcpClientId);
+            REQUIRE(svc);
+            auto& msgs = (*svc).first->getMsgs();
+            REQUIRE(msgs.size() == 2);
+            std::span<uint8_t> msg{msgs[0].begin(), msgs[0].end()};
+            std::string_view str{reinterpret_cast<char*>(msg.data()), msg.size()};
+            REQUIRE(str == "This is a broadcast\n");
+
+            queue->pushEvent<QuitEvent>(ServiceIdType{0});
+            co_return {};
+        });
+
+        t.join();
+    }
+#endif
 }
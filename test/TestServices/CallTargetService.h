@@ -0,0 +1,41 @@
+#pragma once
+
+#include <ichor/dependency_management/AdvancedService.h>
+#include <ichor/coroutines/Task.h>
+#include <string>
+
+using namespace Ichor;
+using namespace Ichor::v1;
+
+struct ICallTargetService {
+    virtual uint64_t add(uint64_t value) = 0;
+    virtual Task<std::string> describe(std::string prefix) = 0;
+    virtual void reset() = 0;
+    [[nodiscard]] virtual uint64_t total() const noexcept = 0;
+protected:
+    ~ICallTargetService() = default;
+};
+
+struct CallTargetService final : public ICallTargetService, public AdvancedService<CallTargetService> {
+    CallTargetService() = default;
+    ~CallTargetService() final = default;
+
+    uint64_t add(uint64_t value) final {
+        _total += value;
+        return _total;
+    }
+
+    Task<std::string> describe(std::string prefix) final {
+        co_return prefix + std::to_string(GetThreadLocalManager().getId());
+    }
+
+    void reset() final {
+        _total = 0;
+    }
+
+    [[nodiscard]] uint64_t total() const noexcept final {
+        return _total;
+    }
+
+    uint64_t _total{};
+};
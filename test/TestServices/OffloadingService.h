@@ -0,0 +1,45 @@
+#pragma once
+
+#include "UselessService.h"
+#include <ichor/services/workers/IWorkerPool.h>
+#include <ichor/dependency_management/AdvancedService.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace Ichor {
+    struct OffloadingService final : public IUselessService, public AdvancedService<OffloadingService> {
+        OffloadingService(DependencyRegister &reg, Properties props) : AdvancedService(std::move(props)) {
+            reg.registerDependency<IWorkerPool>(this, DependencyFlags::REQUIRED);
+        }
+
+        Task<tl::expected<void, StartError>> start() final {
+            co_await _pool->run([this]() {
+                _workerThread = std::this_thread::get_id();
+                auto const running = jobsRunning.fetch_add(1, std::memory_order_acq_rel) + 1;
+                auto max = maxJobsRunning.load(std::memory_order_acquire);
+                while(running > max && !maxJobsRunning.compare_exchange_weak(max, running, std::memory_order_acq_rel)) {
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                jobsRunning.fetch_sub(1, std::memory_order_acq_rel);
+            });
+            _resumedThread = std::this_thread::get_id();
+            co_return {};
+        }
+
+        void addDependencyInstance(ScopedServiceProxy<IWorkerPool*> pool, IService&) {
+            _pool = std::move(pool);
+        }
+
+        void removeDependencyInstance(ScopedServiceProxy<IWorkerPool*>, IService&) {
+            _pool.reset();
+        }
+
+        static inline std::atomic<uint64_t> jobsRunning{};
+        static inline std::atomic<uint64_t> maxJobsRunning{};
+
+        ScopedServiceProxy<IWorkerPool*> _pool{};
+        std::thread::id _workerThread{};
+        std::thread::id _resumedThread{};
+    };
+}
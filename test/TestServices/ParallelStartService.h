@@ -0,0 +1,52 @@
+#pragma once
+
+#include "UselessService.h"
+#include <ichor/coroutines/AsyncManualResetEvent.h>
+#include <ichor/dependency_management/AdvancedService.h>
+#include <ichor/events/RunFunctionEvent.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace Ichor {
+    /// Started with the "ParallelStart" property, waits in start() until all instances are starting at the same time.
+    /// With the "Suspend" property, start() suspends afterwards and finishes on the thread of the queue.
+    struct ParallelStartService final : public IUselessService, public AdvancedService<ParallelStartService> {
+        ParallelStartService(Properties props) : AdvancedService(std::move(props)) {
+            _suspend = getProperties().contains("Suspend");
+        }
+
+        Task<tl::expected<void, StartError>> start() final {
+            _startThread = std::this_thread::get_id();
+            {
+                std::unique_lock lg{mutex};
+                starting++;
+                cv.notify_all();
+                _allStartedTogether = cv.wait_for(lg, std::chrono::seconds(5), []() {
+                    return starting == expected;
+                });
+            }
+
+            if(_suspend) {
+                GetThreadLocalEventQueue().pushEvent<RunFunctionEvent>(getServiceId(), [this]() {
+                    _resume.set();
+                });
+                co_await _resume;
+                _resumedThread = std::this_thread::get_id();
+            }
+            co_return {};
+        }
+
+        static inline std::mutex mutex;
+        static inline std::condition_variable cv;
+        static inline uint32_t starting{};
+        static inline uint32_t expected{};
+
+        bool _suspend{};
+        bool _allStartedTogether{};
+        AsyncManualResetEvent _resume;
+        std::thread::id _startThread{};
+        std::thread::id _resumedThread{};
+    };
+}
@@ -34,25 +34,28 @@ public:
 
     void addDependencyInstance(Ichor::ScopedServiceProxy<IConnectionService*> connectionService, IService &svc) {
         fmt::println("{} svc injected {} {} {} {} {}", getServiceId(), svc.getServiceId(), connectionService->isClient(), evtGate.load(std::memory_order_acquire), _clientService == nullptr, _hostService == nullptr);
+        // messages are only sent in one direction per test, so both sides can collect into msgs
+        auto recvHandler = [this](std::span<uint8_t const> data) {
+            fmt::println("svc recv {}", data.size());
+            std::string_view fullMsg{reinterpret_cast<char const*>(data.data()), data.size()};
+            if(msgs.empty()) {
+                msgs.emplace_back();
+            }
+            split(fullMsg, "\n", true, [&](std::string_view msg) {
+                msgs.back().insert(msgs.back().end(), msg.begin(), msg.end());
+                if(msg.ends_with('\n')) {
+                    msgs.emplace_back();
+                    evtGate.fetch_add(1, std::memory_order_acq_rel);
+                }
+            });
+        };
         if(connectionService->isClient()) {
             _clientService = std::move(connectionService);
+            _clientService->setReceiveHandler(recvHandler);
             _clientId = svc.getServiceId();
         } else {
             _hostService = std::move(connectionService);
-            _hostService->setReceiveHandler([this](std::span<uint8_t const> data) {
-                fmt::println("svc recv {}", data.size());
-                std::string_view fullMsg{reinterpret_cast<char const*>(data.data()), data.size()};
-                if(msgs.empty()) {
-                    msgs.emplace_back();
-                }
-                split(fullMsg, "\n", true, [&](std::string_view msg) {
-                    msgs.back().insert(msgs.back().end(), msg.begin(), msg.end());
-                    if(msg.ends_with('\n')) {
-                        msgs.emplace_back();
-                        evtGate.fetch_add(1, std::memory_order_acq_rel);
-                    }
-                });
-            });
+            _hostService->setReceiveHandler(recvHandler);
             _hostId = svc.getServiceId();
         }
 
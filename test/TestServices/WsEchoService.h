@@ -0,0 +1,44 @@
+#pragma once
+
+#include <ichor/DependencyManager.h>
+#include <ichor/events/RunFunctionEvent.h>
+#include <ichor/dependency_management/AdvancedService.h>
+#include <ichor/services/network/IConnectionService.h>
+#include <ichor/ScopedServiceProxy.h>
+
+using namespace Ichor;
+using namespace Ichor::v1;
+
+// Sends every message received on an upgraded websocket connection straight back.
+class WsEchoService final : public AdvancedService<WsEchoService> {
+public:
+    WsEchoService(DependencyRegister &reg, Properties props) : AdvancedService(std::move(props)) {
+        reg.registerDependency<IConnectionService>(this, DependencyFlags::ALLOW_MULTIPLE);
+    }
+    ~WsEchoService() final = default;
+
+    void addDependencyInstance(Ichor::ScopedServiceProxy<IConnectionService*> connectionService, IService &svc) {
+        // the plain tcp connections underneath the websockets are injected as well
+        if(!svc.getProperties().contains("WsHostServiceId")) {
+            return;
+        }
+
+        connectionService->setReceiveHandler([this, id = svc.getServiceId()](std::span<uint8_t const> data) {
+            GetThreadLocalEventQueue().pushEvent<RunFunctionEventAsync>(getServiceId(), [this, id, msg = std::vector<uint8_t>{data.begin(), data.end()}]() mutable -> AsyncGenerator<IchorBehaviour> {
+                auto it = _connections.find(id);
+                if(it != _connections.end()) {
+                    co_await it->second->sendAsync(std::move(msg));
+                }
+                co_return {};
+            });
+        });
+        _connections.emplace(svc.getServiceId(), std::move(connectionService));
+    }
+
+    void removeDependencyInstance(Ichor::ScopedServiceProxy<IConnectionService*>, IService &svc) {
+        _connections.erase(svc.getServiceId());
+    }
+
+private:
+    unordered_map<ServiceIdType, Ichor::ScopedServiceProxy<IConnectionService*>, ServiceIdHash> _connections;
+};
@@ -1,6 +1,7 @@
 #include "Common.h"
 #include <ichor/Common.h>
 #include <ctre/ctre.hpp>
+#include <ichor/services/metrics/LatencyHistogram.h>
 
 namespace Ichor {
     struct SomeStruct {
@@ -53,4 +54,56 @@ TEST_CASE("Util Tests") {
         REQUIRE(Ichor::typeNameHash<Ichor::SomeStruct>() == 6023179687158125491UL);
         REQUIRE(Ichor::typeNameHash<Ichor::SomeClass>() == 10344807212141480755UL);
     }
+
+    SECTION("LatencyHistogram tests") {
+        using Ichor::v1::LatencyHistogram;
+
+        // buckets are contiguous and cover the whole range
+        for(uint64_t i = 1; i < LatencyHistogram::BUCKET_COUNT; i++) {
+            REQUIRE(LatencyHistogram::bucketIndex(LatencyHistogram::bucketHighestValue(i - 1) + 1) == i);
+        }
+        REQUIRE(LatencyHistogram::bucketIndex(std::numeric_limits<uint64_t>::max()) == LatencyHistogram::BUCKET_COUNT - 1);
+
+        // every value in a bucket is less than 1 / SUB_BUCKET_HALF_COUNT below the highest value of that bucket
+        for(uint64_t i = 0; i < LatencyHistogram::BUCKET_COUNT; i++) {
+            uint64_t const lowest = i == 0 ? 0 : LatencyHistogram::bucketHighestValue(i - 1) + 1;
+            uint64_t const highest = LatencyHistogram::bucketHighestValue(i);
+            REQUIRE(highest >= lowest);
+            REQUIRE(highest - lowest < std::max<uint64_t>(lowest / LatencyHistogram::SUB_BUCKET_HALF_COUNT, 1));
+        }
+
+        LatencyHistogram h{};
+        REQUIRE(h.valueAtPercentile(50.) == 0);
+        REQUIRE(h.min() == 0);
+
+        for(uint64_t i = 1; i <= 10'000; i++) {
+            h.record(i * 1'000);
+        }
+        REQUIRE(h.count() == 10'000);
+        REQUIRE(h.min() == 1'000);
+        REQUIRE(h.max() == 10'000'000);
+        REQUIRE(h.mean() == 5'000'500);
+
+        auto withinError = [](uint64_t value, uint64_t expected) {
+            return value >= expected && value <= expected + expected / LatencyHistogram::SUB_BUCKET_HALF_COUNT;
+        };
+        REQUIRE(withinError(h.valueAtPercentile(50.), 5'000'000));
+        REQUIRE(withinError(h.valueAtPercentile(99.), 9'900'000));
+        REQUIRE(withinError(h.valueAtPercentile(99.9), 9'990'000));
+        REQUIRE(h.valueAtPercentile(100.) == 10'000'000);
+        REQUIRE(h.valueAtPercentile(0.) == 1'000);
+
+        LatencyHistogram h2{};
+        h2.record(20'000'000);
+        h2.record(500);
+        h.merge(h2);
+        REQUIRE(h.count() == 10'002);
+        REQUIRE(h.min() == 500);
+        REQUIRE(h.max() == 20'000'000);
+
+        h.reset();
+        REQUIRE(h.count() == 0);
+        REQUIRE(h.max() == 0);
+        REQUIRE(h.valueAtPercentile(99.) == 0);
+    }
 }
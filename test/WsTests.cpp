@@ -0,0 +1,314 @@
+#include "Common.h"
+#include <ichor/services/network/ws/WsCommon.h>
+#include <random>
+
+#ifdef __linux__
+#include <ichor/event_queues/PriorityQueue.h>
+#include <ichor/events/RunFunctionEvent.h>
+#include <ichor/services/logging/LoggerFactory.h>
+#include <ichor/services/logging/CoutLogger.h>
+#include <ichor/services/timer/TimerFactoryFactory.h>
+#include <ichor/services/network/tcp/TcpConnectionService.h>
+#include <ichor/services/network/tcp/TcpHostService.h>
+#include <ichor/services/network/http/HttpHostService.h>
+#include <ichor/services/network/ws/WsHostService.h>
+#include "TestServices/WsEchoService.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace Ichor;
+using namespace Ichor::v1;
+using namespace std::string_literals;
+
+namespace {
+    std::vector<uint8_t> createFrame(WsOpcode opcode, bool fin, bool compressed, std::vector<uint8_t> payload, uint8_t const *mask) {
+        std::array<uint8_t, ICHOR_WS_MAX_HEADER_SIZE> header{};
+        auto headerLength = writeWsFrameHeader(header, opcode, fin, compressed, payload.size(), mask);
+        std::vector<uint8_t> frame{header.begin(), header.begin() + headerLength};
+        frame.insert(frame.end(), payload.begin(), payload.end());
+        return frame;
+    }
+
+#ifdef __linux__
+    // The test thread plays a blocking client, so that every byte on the wire is under its control.
+    int connectClient(uint16_t port) {
+        auto const start = std::chrono::steady_clock::now();
+        while(std::chrono::steady_clock::now() - start < 1s) {
+            int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+            REQUIRE(fd >= 0);
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(port);
+            ::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+            if(::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) {
+                timeval timeout{1, 0};
+                ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+                return fd;
+            }
+
+            // host not listening yet
+            ::close(fd);
+            std::this_thread::sleep_for(1ms);
+        }
+        return -1;
+    }
+
+    void sendAll(int fd, std::span<uint8_t const> data) {
+        while(!data.empty()) {
+            auto ret = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+            REQUIRE(ret > 0);
+            data = data.subspan(static_cast<size_t>(ret));
+        }
+    }
+
+    // Returns false if the peer closed the connection before the buffer holds at least minSize bytes.
+    bool recvAtLeast(int fd, std::vector<uint8_t> &buf, size_t minSize) {
+        std::array<uint8_t, 4096> tmp{};
+        while(buf.size() < minSize) {
+            auto ret = ::recv(fd, tmp.data(), tmp.size(), 0);
+            REQUIRE(ret >= 0); // -1 means the receive timeout expired
+            if(ret == 0) {
+                return false;
+            }
+            buf.insert(buf.end(), tmp.begin(), tmp.begin() + ret);
+        }
+        return true;
+    }
+
+    std::pair<WsFrameHeader, std::vector<uint8_t>> recvFrame(int fd, std::vector<uint8_t> &buf) {
+        while(true) {
+            auto header = parseWsFrameHeader(buf, false);
+            if(header && buf.size() >= header->headerLength + header->payloadLength) {
+                std::vector<uint8_t> payload{buf.begin() + header->headerLength, buf.begin() + static_cast<int64_t>(header->headerLength + header->payloadLength)};
+                buf.erase(buf.begin(), buf.begin() + static_cast<int64_t>(header->headerLength + header->payloadLength));
+                return {*header, std::move(payload)};
+            }
+            REQUIRE((header || header.error() == WsFrameError::INCOMPLETE));
+            REQUIRE(recvAtLeast(fd, buf, buf.size() + 1));
+        }
+    }
+
+    std::vector<uint8_t> maskedFrame(WsOpcode opcode, bool fin, std::string_view payload) {
+        std::array<uint8_t, 4> mask{0x37, 0xFA, 0x21, 0x3D};
+        std::vector<uint8_t> masked{payload.begin(), payload.end()};
+        applyWsMask(masked, mask);
+        return createFrame(opcode, fin, false, std::move(masked), mask.data());
+    }
+#endif
+}
+
+TEST_CASE("WsTests") {
+
+    SECTION("Accept key matches RFC 6455 example") {
+        REQUIRE(createWsAcceptKey("dGhlIHNhbXBsZSBub25jZQ==") == "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=");
+    }
+
+    SECTION("Header roundtrip") {
+        std::array<uint8_t, 4> mask{0x12, 0x34, 0x56, 0x78};
+
+        for(uint64_t len : {0ull, 1ull, 125ull, 126ull, 65535ull, 65536ull, 1ull << 32u}) {
+            for(bool masked : {false, true}) {
+                std::array<uint8_t, ICHOR_WS_MAX_HEADER_SIZE> header{};
+                auto headerLength = writeWsFrameHeader(header, WsOpcode::BINARY, true, false, len, masked ? mask.data() : nullptr);
+
+                auto parsed = parseWsFrameHeader(std::span<uint8_t const>{header.data(), headerLength}, false);
+                REQUIRE(parsed);
+                REQUIRE(parsed->headerLength == headerLength);
+                REQUIRE(parsed->payloadLength == len);
+                REQUIRE(parsed->opcode == WsOpcode::BINARY);
+                REQUIRE(parsed->fin);
+                REQUIRE(!parsed->compressed);
+                REQUIRE(parsed->masked == masked);
+                if(masked) {
+                    REQUIRE(parsed->mask == mask);
+                }
+
+                auto incomplete = parseWsFrameHeader(std::span<uint8_t const>{header.data(), headerLength - 1}, false);
+                REQUIRE(!incomplete);
+                REQUIRE(incomplete.error() == WsFrameError::INCOMPLETE);
+            }
+        }
+    }
+
+    SECTION("Protocol errors") {
+        // RSV1 without permessage-deflate
+        auto frame = createFrame(WsOpcode::TEXT, true, true, {}, nullptr);
+        REQUIRE(parseWsFrameHeader(frame, false).error() == WsFrameError::PROTOCOL_ERROR);
+        REQUIRE(parseWsFrameHeader(frame, true));
+
+        // RSV2
+        frame = createFrame(WsOpcode::TEXT, true, false, {}, nullptr);
+        frame[0] |= 0x20;
+        REQUIRE(parseWsFrameHeader(frame, true).error() == WsFrameError::PROTOCOL_ERROR);
+
+        // reserved opcode
+        frame = createFrame(WsOpcode::TEXT, true, false, {}, nullptr);
+        frame[0] = static_cast<uint8_t>((frame[0] & 0xF0) | 0x3);
+        REQUIRE(parseWsFrameHeader(frame, false).error() == WsFrameError::PROTOCOL_ERROR);
+
+        // fragmented control frame
+        frame = createFrame(WsOpcode::PING, false, false, {}, nullptr);
+        REQUIRE(parseWsFrameHeader(frame, false).error() == WsFrameError::PROTOCOL_ERROR);
+
+        // control frame payload over 125 bytes
+        frame = createFrame(WsOpcode::PING, true, false, std::vector<uint8_t>(126, 'a'), nullptr);
+        REQUIRE(parseWsFrameHeader(frame, false).error() == WsFrameError::PROTOCOL_ERROR);
+
+        // most significant bit of the 64 bit length set
+        frame = createFrame(WsOpcode::BINARY, true, false, {}, nullptr);
+        frame[1] = 127;
+        frame.insert(frame.end(), {0x80, 0, 0, 0, 0, 0, 0, 0});
+        REQUIRE(parseWsFrameHeader(frame, false).error() == WsFrameError::PROTOCOL_ERROR);
+    }
+
+    SECTION("Masking matches the naive implementation") {
+        std::mt19937 gen{42};
+        std::array<uint8_t, 4> mask{0xDE, 0xAD, 0xBE, 0xEF};
+
+        for(size_t len : {0ul, 1ul, 3ul, 7ul, 15ul, 16ul, 31ul, 33ul, 63ul, 100ul, 1031ul}) {
+            std::vector<uint8_t> payload(len);
+            for(auto &b : payload) {
+                b = static_cast<uint8_t>(gen());
+            }
+            auto expected = payload;
+            for(size_t i = 0; i < expected.size(); i++) {
+                expected[i] ^= mask[i % 4];
+            }
+
+            applyWsMask(payload, mask);
+            REQUIRE(payload == expected);
+
+            // unaligned start
+            if(len > 1) {
+                auto unaligned = expected;
+                applyWsMask(std::span<uint8_t>{unaligned}.subspan(1), mask);
+                for(size_t i = 1; i < unaligned.size(); i++) {
+                    REQUIRE(unaligned[i] == static_cast<uint8_t>(expected[i] ^ mask[(i - 1) % 4]));
+                }
+            }
+        }
+    }
+
+    SECTION("Header tokens") {
+        REQUIRE(wsHeaderContainsToken("Upgrade", "upgrade"));
+        REQUIRE(wsHeaderContainsToken("keep-alive, Upgrade", "upgrade"));
+        REQUIRE(wsHeaderContainsToken("permessage-deflate; client_max_window_bits, x-webkit-deflate-frame", "permessage-deflate"));
+        REQUIRE(!wsHeaderContainsToken("keep-alive", "upgrade"));
+        REQUIRE(!wsHeaderContainsToken("upgrades", "upgrade"));
+        REQUIRE(!wsHeaderContainsToken("", "upgrade"));
+    }
+
+#ifdef ICHOR_USE_ZLIB
+    SECTION("Deflate roundtrip") {
+        std::string_view text = "Hello World, Hello World, Hello World, Hello World, Hello World, Hello World";
+        std::span<uint8_t const> in{reinterpret_cast<uint8_t const*>(text.data()), text.size()};
+
+        std::vector<uint8_t> compressed;
+        REQUIRE(wsDeflate(in, compressed));
+        REQUIRE(compressed.size() < in.size());
+
+        std::vector<uint8_t> decompressed;
+        REQUIRE(wsInflate(compressed, decompressed, 1024));
+        REQUIRE(std::string_view{reinterpret_cast<char const*>(decompressed.data()), decompressed.size()} == text);
+
+        // no context takeover, so compressing the same message twice gives the same result
+        std::vector<uint8_t> compressedAgain;
+        REQUIRE(wsDeflate(in, compressedAgain));
+        REQUIRE(compressed == compressedAgain);
+
+        decompressed.clear();
+        auto tooBig = wsInflate(compressed, decompressed, text.size() - 1);
+        REQUIRE(!tooBig);
+        REQUIRE(tooBig.error() == WsFrameError::MESSAGE_TOO_BIG);
+    }
+#endif
+}
+
+#ifdef __linux__
+TEST_CASE("WsTests_native") {
+    SECTION("Upgrade, fragmented and control frames and closing handshake") {
+        auto queue = std::make_unique<PriorityQueue>(500, true);
+        constexpr uint16_t port = 8002;
+
+        std::thread t([&]() {
+            auto &dm = queue->createManager();
+            uint64_t priorityToEnsureHostStartingFirst = 51;
+            dm.createServiceManager<CoutFrameworkLogger, IFrameworkLogger>(Properties{}, priorityToEnsureHostStartingFirst);
+            dm.createServiceManager<LoggerFactory<CoutLogger>, ILoggerFactory>(Properties{}, priorityToEnsureHostStartingFirst);
+            dm.createServiceManager<TimerFactoryFactory>(Properties{}, priorityToEnsureHostStartingFirst);
+            dm.createServiceManager<TcpHostService, IHostService>(Properties{{"Address", Ichor::v1::make_any<std::string>("127.0.0.1"s)}, {"Port", Ichor::v1::make_any<uint16_t>(port)}}, priorityToEnsureHostStartingFirst);
+            dm.createServiceManager<HttpHostService, IHttpHostService>(Properties{{"Address", Ichor::v1::make_any<std::string>("127.0.0.1"s)}, {"Port", Ichor::v1::make_any<uint16_t>(port)}});
+            dm.createServiceManager<WsHostService, IHostService, IWsHostService>(Properties{{"Address", Ichor::v1::make_any<std::string>("127.0.0.1"s)}, {"Port", Ichor::v1::make_any<uint16_t>(port)}});
+            dm.createServiceManager<WsEchoService>();
+
+            queue->start(CaptureSigInt);
+        });
+
+        int fd = connectClient(port);
+        REQUIRE(fd >= 0);
+
+        std::string_view upgrade = "GET / HTTP/1.1\r\nHost: 127.0.0.1\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+        sendAll(fd, std::span<uint8_t const>{reinterpret_cast<uint8_t const*>(upgrade.data()), upgrade.size()});
+
+        std::vector<uint8_t> buf;
+        std::string_view response;
+        while(true) {
+            REQUIRE(recvAtLeast(fd, buf, buf.size() + 1));
+            response = std::string_view{reinterpret_cast<char const*>(buf.data()), buf.size()};
+            if(auto end = response.find("\r\n\r\n"); end != std::string_view::npos) {
+                response = response.substr(0, end + 4);
+                break;
+            }
+        }
+        REQUIRE(response.starts_with("HTTP/1.1 101"));
+        REQUIRE(response.find("s3pPLMBiTxaQ9kYGzzhZRbK+xOo=") != std::string_view::npos);
+        buf.erase(buf.begin(), buf.begin() + static_cast<int64_t>(response.size()));
+
+        // one message in three fragments, sent in one go so they also arrive in a single read
+        auto frames = maskedFrame(WsOpcode::TEXT, false, "Hello ");
+        auto continuation = maskedFrame(WsOpcode::CONTINUATION, false, "web");
+        frames.insert(frames.end(), continuation.begin(), continuation.end());
+        continuation = maskedFrame(WsOpcode::CONTINUATION, true, "socket");
+        frames.insert(frames.end(), continuation.begin(), continuation.end());
+        sendAll(fd, frames);
+
+        auto [echoHeader, echo] = recvFrame(fd, buf);
+        REQUIRE(echoHeader.fin);
+        REQUIRE(!echoHeader.masked);
+        REQUIRE(std::string_view{reinterpret_cast<char const*>(echo.data()), echo.size()} == "Hello websocket");
+
+        // a frame split over two reads
+        auto splitFrame = maskedFrame(WsOpcode::BINARY, true, "split frame");
+        sendAll(fd, std::span<uint8_t const>{splitFrame}.subspan(0, 4));
+        std::this_thread::sleep_for(20ms);
+        sendAll(fd, std::span<uint8_t const>{splitFrame}.subspan(4));
+
+        auto [splitHeader, splitEcho] = recvFrame(fd, buf);
+        REQUIRE(std::string_view{reinterpret_cast<char const*>(splitEcho.data()), splitEcho.size()} == "split frame");
+
+        sendAll(fd, maskedFrame(WsOpcode::PING, true, "ping"));
+        auto [pongHeader, pong] = recvFrame(fd, buf);
+        REQUIRE(pongHeader.opcode == WsOpcode::PONG);
+        REQUIRE(std::string_view{reinterpret_cast<char const*>(pong.data()), pong.size()} == "ping");
+
+        // 1000, normal closure
+        sendAll(fd, maskedFrame(WsOpcode::CLOSE, true, std::string_view{"\x03\xE8", 2}));
+        auto [closeHeader, closePayload] = recvFrame(fd, buf);
+        REQUIRE(closeHeader.opcode == WsOpcode::CLOSE);
+        REQUIRE(closePayload.size() == 2);
+        REQUIRE(closePayload[0] == 0x03);
+        REQUIRE(closePayload[1] == 0xE8);
+
+        // the upgraded tcp connection is stopped after the closing handshake
+        REQUIRE(!recvAtLeast(fd, buf, buf.size() + 1));
+        ::close(fd);
+
+        queue->pushEvent<QuitEvent>(ServiceIdType{0});
+        t.join();
+    }
+}
+#endif